@@ -126,6 +126,11 @@ if [ -n "$JENKINS_RUN_TESTS" ]; then
         mpirun -np 2 -mca pml ob1 -mca btl sm,self $AFFINITY $ucx_inst/bin/ucx_perftest -d $mm_device $opt_perftest_common -x mm
     done
 
+    for copy_threads in 0 1 3; do
+        echo "Running large shared memory put with $copy_threads copy threads"
+        mpirun -np 2 -mca pml ob1 -mca btl sm,self -x UCX_MM_COPY_THREADS=$copy_threads $AFFINITY $ucx_inst/bin/ucx_perftest -d posix -x mm -t put_bw -D zcopy -s 16777216 -n 100 -w 10
+    done
+
     rm -f ./active_message
 
     echo "Running memory hook on MPI"
@@ -337,6 +337,13 @@ static ucs_status_t uct_perf_test_check_capabilities(ucx_perf_params_t *params,
         return status;
     }
 
+    if (params->wait_mode == UCX_PERF_WAIT_MODE_SLEEP) {
+        if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+            ucs_error("Sleep wait mode is not supported for UCT tests");
+        }
+        return UCS_ERR_UNSUPPORTED;
+    }
+
     if ((attr.cap.flags & required_flags) == 0) {
         if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
             ucs_error("Device does not support required operation");
@@ -617,6 +624,16 @@ static ucs_status_t ucp_perf_test_check_params(ucx_perf_params_t *params,
         return UCS_ERR_INVALID_PARAM;
     }
 
+    if (params->wait_mode == UCX_PERF_WAIT_MODE_SLEEP) {
+        if (params->command != UCX_PERF_CMD_TAG) {
+            if (params->flags & UCX_PERF_TEST_FLAG_VERBOSE) {
+                ucs_error("Sleep wait mode is supported only for tag tests");
+            }
+            return UCS_ERR_UNSUPPORTED;
+        }
+        *features |= UCP_FEATURE_WAKEUP;
+    }
+
     status = ucx_perf_test_check_params(params);
     if (status != UCS_OK) {
         return status;
@@ -78,7 +78,7 @@ struct perftest_context {
     sock_rte_group_t             sock_rte_group;
 };
 
-#define TEST_PARAMS_ARGS   "t:n:s:W:O:w:D:H:oqM:T:d:x:A:"
+#define TEST_PARAMS_ARGS   "t:n:s:W:O:w:D:H:oqM:T:d:x:A:E:"
 
 
 test_type_t tests[] = {
@@ -345,6 +345,9 @@ static void usage(struct perftest_context *ctx, const char *program)
     printf("     -A <mode>      Async progress mode. (thread)\n");
     printf("                        thread     : Use separate progress thread.\n");
     printf("                        signal     : Use signal based timer.\n"); 
+    printf("     -E <mode>      Wait mode for UCP tag tests. (poll)\n");
+    printf("                        poll       : Repeatedly call worker progress.\n");
+    printf("                        sleep      : Arm the worker and block in ucp_worker_wait().\n");
 #if HAVE_MPI
     printf("     -P <0|1>       Disable/enable MPI mode (%d)\n", ctx->mpi);
 #endif
@@ -477,6 +480,17 @@ static ucs_status_t parse_test_params(ucx_perf_params_t *params, char opt, const
             ucs_error("Invalid option argument for -A");
             return UCS_ERR_INVALID_PARAM;
         }
+    case 'E':
+        if (0 == strcmp(optarg, "poll")) {
+            params->wait_mode = UCX_PERF_WAIT_MODE_PROGRESS;
+            return UCS_OK;
+        } else if (0 == strcmp(optarg, "sleep")) {
+            params->wait_mode = UCX_PERF_WAIT_MODE_SLEEP;
+            return UCS_OK;
+        } else {
+            ucs_error("Invalid option argument for -E");
+            return UCS_ERR_INVALID_PARAM;
+        }
     default:
        return UCS_ERR_INVALID_PARAM;
     }
@@ -39,6 +39,14 @@ public:
         ucp_worker_progress(m_perf.ucp.worker);
     }
 
+    void wait_for_event()
+    {
+        /* If arming fails, there are events to process */
+        if (ucp_worker_arm(m_perf.ucp.worker) == UCS_OK) {
+            ucp_worker_wait(m_perf.ucp.worker);
+        }
+    }
+
     ucs_status_t UCS_F_ALWAYS_INLINE wait(void *request, bool is_requestor)
     {
         if (ucs_likely(!UCS_PTR_IS_PTR(request))) {
@@ -51,6 +59,12 @@ public:
             } else {
                 progress_responder();
             }
+
+            if ((m_perf.params.wait_mode == UCX_PERF_WAIT_MODE_SLEEP) &&
+                !ucp_request_is_completed(request))
+            {
+                wait_for_event();
+            }
         }
         ucp_request_release(request);
         return UCS_OK;
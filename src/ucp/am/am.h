@@ -0,0 +1,68 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCP_AM_H_
+#define UCP_AM_H_
+
+#include <ucp/api/ucp.h>
+#include <ucp/core/ucp_request.h>
+#include <ucp/proto/proto.h>
+#include <ucs/datastruct/list.h>
+
+
+/*
+ * AM_ONLY
+ */
+typedef union {
+    struct {
+        uint16_t              am_id;         /* User active message id */
+        uint16_t              reserved;
+        uint32_t              header_length; /* User header length */
+    };
+    uint64_t                  u64;           /* For am_short */
+} UCS_S_PACKED ucp_am_hdr_t;
+
+
+/*
+ * AM_FIRST
+ */
+typedef struct {
+    ucp_am_hdr_t              super;
+    ucp_request_hdr_t         req;           /* Identifies the message */
+    size_t                    total_len;     /* Total payload length */
+} UCS_S_PACKED ucp_am_first_hdr_t;
+
+
+/*
+ * AM_MIDDLE
+ */
+typedef struct {
+    ucp_request_hdr_t         req;           /* Identifies the message */
+} UCS_S_PACKED ucp_am_mid_hdr_t;
+
+
+/*
+ * Descriptor of a multi-fragment active message which is being reassembled.
+ * User header and payload follow the descriptor.
+ */
+typedef struct ucp_am_rx_desc {
+    ucs_list_link_t           list;          /* Entry in worker->am_rx_list */
+    ucp_request_hdr_t         req;           /* Identifies the message */
+    uint16_t                  am_id;         /* User active message id */
+    size_t                    header_length; /* User header length */
+    size_t                    total_len;     /* Total payload length */
+    size_t                    offset;        /* Payload received so far */
+    ucp_recv_desc_t           super;         /* Passed to the user handler */
+} ucp_am_rx_desc_t;
+
+
+/* Upper bound on zero-copy header size, which is assembled on the stack */
+#define UCP_AM_ZCOPY_MAX_HDR      256
+
+
+void ucp_am_cleanup(ucp_worker_h worker);
+
+#endif
@@ -0,0 +1,245 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "am.h"
+
+#include <ucp/core/ucp_context.h>
+#include <ucp/core/ucp_worker.h>
+#include <ucs/debug/memtrack.h>
+#include <string.h>
+
+
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_am_invoke(ucp_worker_h worker, uint16_t am_id, const void *header,
+              size_t header_length, void *data, size_t length,
+              ucp_recv_desc_t *rdesc)
+{
+    ucp_worker_am_entry_t *entry;
+    ucs_status_t status;
+
+    if (ucs_unlikely((am_id >= worker->am_cb_count) ||
+                     (worker->am_cbs[am_id].cb == NULL)))
+    {
+        ucs_warn("worker %p: no handler for active message id %u, dropping it",
+                 worker, am_id);
+        return UCS_OK;
+    }
+
+    entry  = &worker->am_cbs[am_id];
+    status = entry->cb(entry->arg, header, header_length, data, length, rdesc);
+    return (status == UCS_INPROGRESS) ? UCS_INPROGRESS : UCS_OK;
+}
+
+static ucs_status_t ucp_am_only_handler(void *arg, void *data, size_t length,
+                                        void *desc)
+{
+    ucp_worker_h worker = arg;
+    ucp_recv_desc_t *rdesc = desc;
+    ucp_am_hdr_t *hdr;
+
+    /* Make sure the message resides in the descriptor, so the user could
+     * keep it after the handler returns */
+    if (data != rdesc + 1) {
+        memcpy(rdesc + 1, data, length);
+    }
+
+    hdr            = (void*)(rdesc + 1);
+    rdesc->length  = length;
+    rdesc->hdr_len = sizeof(*hdr);
+    rdesc->flags   = 0;
+
+    ucs_assert(length >= sizeof(*hdr) + hdr->header_length);
+    return ucp_am_invoke(worker, hdr->am_id, hdr + 1, hdr->header_length,
+                         (void*)(hdr + 1) + hdr->header_length,
+                         length - sizeof(*hdr) - hdr->header_length, rdesc);
+}
+
+static ucs_status_t ucp_am_first_handler(void *arg, void *data, size_t length,
+                                         void *desc)
+{
+    ucp_worker_h worker = arg;
+    ucp_am_first_hdr_t *hdr = data;
+    ucp_am_rx_desc_t *rx_desc;
+    size_t header_length, recv_len;
+
+    header_length = hdr->super.header_length;
+    recv_len      = length - sizeof(*hdr) - header_length;
+    ucs_assert(length >= sizeof(*hdr) + header_length);
+    ucs_assert(recv_len < hdr->total_len);
+
+    rx_desc = ucs_malloc(sizeof(*rx_desc) + header_length + hdr->total_len,
+                         "ucp_am_rx_desc");
+    if (rx_desc == NULL) {
+        ucs_error("worker %p: failed to allocate %zu bytes for active message "
+                  "id %u, dropping it", worker, hdr->total_len, hdr->super.am_id);
+        return UCS_OK;
+    }
+
+    rx_desc->req           = hdr->req;
+    rx_desc->am_id         = hdr->super.am_id;
+    rx_desc->header_length = header_length;
+    rx_desc->total_len     = hdr->total_len;
+    rx_desc->offset        = recv_len;
+    rx_desc->super.length  = header_length + hdr->total_len;
+    rx_desc->super.hdr_len = 0;
+    rx_desc->super.flags   = UCP_RECV_DESC_FLAG_MALLOC;
+    memcpy(rx_desc + 1, hdr + 1, header_length + recv_len);
+
+    ucs_list_add_tail(&worker->am_rx_list, &rx_desc->list);
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_am_middle_handler(void *arg, void *data, size_t length,
+                                          void *desc)
+{
+    ucp_worker_h worker = arg;
+    ucp_am_mid_hdr_t *hdr = data;
+    ucp_am_rx_desc_t *rx_desc;
+    ucs_status_t status;
+    size_t recv_len;
+    void *payload;
+
+    ucs_list_for_each(rx_desc, &worker->am_rx_list, list) {
+        if ((rx_desc->req.sender_uuid != hdr->req.sender_uuid) ||
+            (rx_desc->req.reqptr != hdr->req.reqptr))
+        {
+            continue;
+        }
+
+        recv_len = length - sizeof(*hdr);
+        payload  = (void*)(rx_desc + 1) + rx_desc->header_length;
+        ucs_assert(rx_desc->offset + recv_len <= rx_desc->total_len);
+        memcpy(payload + rx_desc->offset, hdr + 1, recv_len);
+        rx_desc->offset += recv_len;
+
+        /* Last fragment delivers the message */
+        if (rx_desc->offset == rx_desc->total_len) {
+            ucs_list_del(&rx_desc->list);
+            status = ucp_am_invoke(worker, rx_desc->am_id, rx_desc + 1,
+                                   rx_desc->header_length, payload,
+                                   rx_desc->total_len, &rx_desc->super);
+            if (status != UCS_INPROGRESS) {
+                ucs_free(rx_desc);
+            }
+        }
+        return UCS_OK;
+    }
+
+    ucs_error("worker %p: no active message matches fragment from uuid 0x%"PRIx64
+              " request 0x%"PRIx64, worker, hdr->req.sender_uuid,
+              hdr->req.reqptr);
+    return UCS_OK;
+}
+
+ucs_status_t ucp_worker_set_am_handler(ucp_worker_h worker, uint16_t id,
+                                       ucp_am_callback_t cb, void *arg)
+{
+    ucp_worker_am_entry_t *am_cbs;
+    ucs_status_t status;
+    unsigned count;
+
+    if (!(worker->context->config.features & UCP_FEATURE_AM)) {
+        ucs_error("worker %p: active messages were not requested", worker);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    UCS_ASYNC_BLOCK(&worker->async);
+
+    if (id >= worker->am_cb_count) {
+        count  = id + 1;
+        am_cbs = ucs_realloc(worker->am_cbs, sizeof(*am_cbs) * count,
+                             "ucp_am_cbs");
+        if (am_cbs == NULL) {
+            status = UCS_ERR_NO_MEMORY;
+            goto out;
+        }
+
+        memset(am_cbs + worker->am_cb_count, 0,
+               sizeof(*am_cbs) * (count - worker->am_cb_count));
+        worker->am_cbs      = am_cbs;
+        worker->am_cb_count = count;
+    }
+
+    ucs_debug("worker %p: set active message handler id %u cb %p arg %p",
+              worker, id, cb, arg);
+    worker->am_cbs[id].cb  = cb;
+    worker->am_cbs[id].arg = arg;
+    status = UCS_OK;
+
+out:
+    UCS_ASYNC_UNBLOCK(&worker->async);
+    return status;
+}
+
+void ucp_am_desc_release(ucp_worker_h worker, void *desc)
+{
+    ucp_recv_desc_t *rdesc = desc;
+
+    ucs_trace_req("release active message descriptor %p", rdesc);
+    if (rdesc->flags & UCP_RECV_DESC_FLAG_MALLOC) {
+        ucs_free(ucs_container_of(rdesc, ucp_am_rx_desc_t, super));
+    } else {
+        uct_iface_release_am_desc(rdesc);
+    }
+}
+
+void ucp_am_cleanup(ucp_worker_h worker)
+{
+    ucp_am_rx_desc_t *rx_desc, *tmp;
+
+    ucs_list_for_each_safe(rx_desc, tmp, &worker->am_rx_list, list) {
+        ucs_debug("worker %p: drop incomplete active message id %u (%zu/%zu)",
+                  worker, rx_desc->am_id, rx_desc->offset, rx_desc->total_len);
+        ucs_list_del(&rx_desc->list);
+        ucs_free(rx_desc);
+    }
+
+    ucs_free(worker->am_cbs);
+}
+
+static void ucp_am_dump(ucp_worker_h worker, uct_am_trace_type_t type,
+                        uint8_t id, const void *data, size_t length,
+                        char *buffer, size_t max)
+{
+    const ucp_am_first_hdr_t *first_hdr = data;
+    const ucp_am_mid_hdr_t *mid_hdr     = data;
+    const ucp_am_hdr_t *hdr             = data;
+    size_t header_len;
+    char *p;
+
+    switch (id) {
+    case UCP_AM_ID_AM_ONLY:
+        snprintf(buffer, max, "AM id %u hdr_len %u", hdr->am_id,
+                 hdr->header_length);
+        header_len = sizeof(*hdr) + hdr->header_length;
+        break;
+    case UCP_AM_ID_AM_FIRST:
+        snprintf(buffer, max, "AM_F id %u hdr_len %u len %zu uuid %"PRIx64
+                 " request 0x%"PRIx64, first_hdr->super.am_id,
+                 first_hdr->super.header_length, first_hdr->total_len,
+                 first_hdr->req.sender_uuid, first_hdr->req.reqptr);
+        header_len = sizeof(*first_hdr) + first_hdr->super.header_length;
+        break;
+    case UCP_AM_ID_AM_MIDDLE:
+        snprintf(buffer, max, "AM_M uuid %"PRIx64" request 0x%"PRIx64,
+                 mid_hdr->req.sender_uuid, mid_hdr->req.reqptr);
+        header_len = sizeof(*mid_hdr);
+        break;
+    default:
+        return;
+    }
+
+    p = buffer + strlen(buffer);
+    ucp_dump_payload(worker->context, p, buffer + max - p, data + header_len,
+                     length - header_len);
+}
+
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_ONLY, ucp_am_only_handler,
+              ucp_am_dump, UCT_AM_CB_FLAG_SYNC);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_FIRST, ucp_am_first_handler,
+              ucp_am_dump, UCT_AM_CB_FLAG_SYNC);
+UCP_DEFINE_AM(UCP_FEATURE_AM, UCP_AM_ID_AM_MIDDLE, ucp_am_middle_handler,
+              ucp_am_dump, UCT_AM_CB_FLAG_SYNC);
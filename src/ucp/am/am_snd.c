@@ -0,0 +1,458 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "am.h"
+
+#include <ucp/core/ucp_ep.h>
+#include <ucp/core/ucp_worker.h>
+#include <ucp/core/ucp_request.inl>
+#include <ucp/dt/dt_contig.h>
+#include <ucp/dt/dt_generic.h>
+#include <ucp/proto/proto_am.inl>
+#include <ucs/datastruct/mpool.inl>
+#include <string.h>
+
+
+static UCS_F_ALWAYS_INLINE size_t ucp_am_only_hdr_size(ucp_request_t *req)
+{
+    return sizeof(ucp_am_hdr_t) + req->send.am.header_length;
+}
+
+static UCS_F_ALWAYS_INLINE size_t ucp_am_first_hdr_size(ucp_request_t *req)
+{
+    return sizeof(ucp_am_first_hdr_t) + req->send.am.header_length;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_am_fill_hdr(ucp_am_hdr_t *hdr, ucp_request_t *req)
+{
+    hdr->am_id         = req->send.am.am_id;
+    hdr->reserved      = 0;
+    hdr->header_length = req->send.am.header_length;
+}
+
+static UCS_F_ALWAYS_INLINE void *
+ucp_am_fill_first_hdr(ucp_am_first_hdr_t *hdr, ucp_request_t *req)
+{
+    ucp_am_fill_hdr(&hdr->super, req);
+    hdr->req.sender_uuid = req->send.ep->worker->uuid;
+    hdr->req.reqptr      = (uintptr_t)req;
+    hdr->total_len       = req->send.length;
+    memcpy(hdr + 1, req->send.am.header, req->send.am.header_length);
+    return (void*)(hdr + 1) + req->send.am.header_length;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_am_fill_mid_hdr(ucp_am_mid_hdr_t *hdr, ucp_request_t *req)
+{
+    hdr->req.sender_uuid = req->send.ep->worker->uuid;
+    hdr->req.reqptr      = (uintptr_t)req;
+}
+
+/* packing  start */
+
+static size_t ucp_am_pack_only_contig(void *dest, void *arg)
+{
+    ucp_am_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    void *payload;
+
+    ucp_am_fill_hdr(hdr, req);
+    memcpy(hdr + 1, req->send.am.header, req->send.am.header_length);
+    payload = (void*)(hdr + 1) + req->send.am.header_length;
+    memcpy(payload, req->send.buffer, req->send.length);
+    return ucp_am_only_hdr_size(req) + req->send.length;
+}
+
+static size_t ucp_am_pack_first_contig(void *dest, void *arg)
+{
+    ucp_am_first_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t length;
+    void *payload;
+
+    length  = ucp_ep_config(req->send.ep)->max_am_bcopy -
+              ucp_am_first_hdr_size(req);
+    payload = ucp_am_fill_first_hdr(hdr, req);
+
+    ucs_assert(req->send.state.offset == 0);
+    ucs_assert(req->send.length > length);
+    memcpy(payload, req->send.buffer, length);
+    return ucp_am_first_hdr_size(req) + length;
+}
+
+static size_t ucp_am_pack_middle_contig(void *dest, void *arg)
+{
+    ucp_am_mid_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t length;
+
+    length = ucp_ep_config(req->send.ep)->max_am_bcopy - sizeof(*hdr);
+    ucp_am_fill_mid_hdr(hdr, req);
+    memcpy(hdr + 1, req->send.buffer + req->send.state.offset, length);
+    return sizeof(*hdr) + length;
+}
+
+static size_t ucp_am_pack_last_contig(void *dest, void *arg)
+{
+    ucp_am_mid_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t length;
+
+    length = req->send.length - req->send.state.offset;
+    ucp_am_fill_mid_hdr(hdr, req);
+    memcpy(hdr + 1, req->send.buffer + req->send.state.offset, length);
+    return sizeof(*hdr) + length;
+}
+
+static size_t ucp_am_pack_only_generic(void *dest, void *arg)
+{
+    ucp_am_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t length;
+    void *payload;
+
+    ucs_assert(req->send.state.offset == 0);
+    ucp_am_fill_hdr(hdr, req);
+    memcpy(hdr + 1, req->send.am.header, req->send.am.header_length);
+    payload = (void*)(hdr + 1) + req->send.am.header_length;
+    length  = ucp_request_generic_dt_pack(req, payload, req->send.length);
+    ucs_assert(length == req->send.length);
+    return ucp_am_only_hdr_size(req) + length;
+}
+
+static size_t ucp_am_pack_first_generic(void *dest, void *arg)
+{
+    ucp_am_first_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t max_length;
+    void *payload;
+
+    ucs_assert(req->send.state.offset == 0);
+
+    max_length = ucp_ep_config(req->send.ep)->max_am_bcopy -
+                 ucp_am_first_hdr_size(req);
+    payload    = ucp_am_fill_first_hdr(hdr, req);
+
+    ucs_assert(req->send.length > max_length);
+    return ucp_am_first_hdr_size(req) +
+           ucp_request_generic_dt_pack(req, payload, max_length);
+}
+
+static size_t ucp_am_pack_middle_generic(void *dest, void *arg)
+{
+    ucp_am_mid_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t max_length;
+
+    max_length = ucp_ep_config(req->send.ep)->max_am_bcopy - sizeof(*hdr);
+    ucp_am_fill_mid_hdr(hdr, req);
+    return sizeof(*hdr) + ucp_request_generic_dt_pack(req, hdr + 1, max_length);
+}
+
+static size_t ucp_am_pack_last_generic(void *dest, void *arg)
+{
+    ucp_am_mid_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t max_length, length;
+
+    max_length = req->send.length - req->send.state.offset;
+    ucp_am_fill_mid_hdr(hdr, req);
+    length     = ucp_request_generic_dt_pack(req, hdr + 1, max_length);
+    ucs_assertv(length == max_length, "length=%zu, max_length=%zu",
+                length, max_length);
+    return sizeof(*hdr) + length;
+}
+
+/* progress */
+
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_am_send_short(ucp_ep_h ep, uint16_t am_id, const void *buffer, size_t length)
+{
+    ucp_am_hdr_t hdr;
+
+    UCS_STATIC_ASSERT(sizeof(ucp_am_hdr_t) == sizeof(uint64_t));
+    hdr.am_id         = am_id;
+    hdr.reserved      = 0;
+    hdr.header_length = 0;
+    return uct_ep_am_short(ep->uct_eps[UCP_EP_OP_AM], UCP_AM_ID_AM_ONLY,
+                           hdr.u64, buffer, length);
+}
+
+static ucs_status_t ucp_am_contig_short(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucs_status_t status;
+
+    status = ucp_am_send_short(req->send.ep, req->send.am.am_id,
+                               req->send.buffer, req->send.length);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_am_contig_bcopy_single(uct_pending_req_t *self)
+{
+    ucs_status_t status = ucp_do_am_bcopy_single(self, UCP_AM_ID_AM_ONLY,
+                                                 ucp_am_pack_only_contig);
+    if (status == UCS_OK) {
+        ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+        ucp_request_complete(req, req->cb.send, UCS_OK);
+    }
+    return status;
+}
+
+static ucs_status_t ucp_am_contig_bcopy_multi(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucs_status_t status;
+
+    status = ucp_do_am_bcopy_multi(self,
+                                   UCP_AM_ID_AM_FIRST,
+                                   UCP_AM_ID_AM_MIDDLE,
+                                   UCP_AM_ID_AM_MIDDLE,
+                                   ucp_am_first_hdr_size(req),
+                                   sizeof(ucp_am_mid_hdr_t),
+                                   ucp_am_pack_first_contig,
+                                   ucp_am_pack_middle_contig,
+                                   ucp_am_pack_last_contig);
+    if (status == UCS_OK) {
+        ucp_request_complete(req, req->cb.send, UCS_OK);
+    }
+    return status;
+}
+
+static void ucp_am_contig_zcopy_req_complete(ucp_request_t *req)
+{
+    ucp_request_send_buffer_dereg(req, UCP_EP_OP_AM);
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+}
+
+static ucs_status_t ucp_am_contig_zcopy_single(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    char hdr_buf[UCP_AM_ZCOPY_MAX_HDR];
+    ucp_am_hdr_t *hdr = (ucp_am_hdr_t*)hdr_buf;
+
+    ucp_am_fill_hdr(hdr, req);
+    memcpy(hdr + 1, req->send.am.header, req->send.am.header_length);
+    return ucp_do_am_zcopy_single(self, UCP_AM_ID_AM_ONLY, hdr,
+                                  ucp_am_only_hdr_size(req),
+                                  ucp_am_contig_zcopy_req_complete);
+}
+
+static ucs_status_t ucp_am_contig_zcopy_multi(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    char hdr_buf[UCP_AM_ZCOPY_MAX_HDR];
+    ucp_am_first_hdr_t *first_hdr = (ucp_am_first_hdr_t*)hdr_buf;
+    ucp_am_mid_hdr_t mid_hdr;
+
+    ucp_am_fill_first_hdr(first_hdr, req);
+    ucp_am_fill_mid_hdr(&mid_hdr, req);
+    return ucp_do_am_zcopy_multi(self,
+                                 UCP_AM_ID_AM_FIRST,
+                                 UCP_AM_ID_AM_MIDDLE,
+                                 UCP_AM_ID_AM_MIDDLE,
+                                 first_hdr, ucp_am_first_hdr_size(req),
+                                 &mid_hdr, sizeof(mid_hdr),
+                                 ucp_am_contig_zcopy_req_complete);
+}
+
+static void ucp_am_contig_zcopy_completion(uct_completion_t *self,
+                                           ucs_status_t status)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct_comp);
+    ucp_am_contig_zcopy_req_complete(req);
+}
+
+static void ucp_am_generic_complete(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_request_generic_dt_finish(req);
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+}
+
+static ucs_status_t ucp_am_generic_single(uct_pending_req_t *self)
+{
+    ucs_status_t status;
+
+    status = ucp_do_am_bcopy_single(self, UCP_AM_ID_AM_ONLY,
+                                    ucp_am_pack_only_generic);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_am_generic_complete(self);
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_am_generic_multi(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucs_status_t status;
+
+    status = ucp_do_am_bcopy_multi(self,
+                                   UCP_AM_ID_AM_FIRST,
+                                   UCP_AM_ID_AM_MIDDLE,
+                                   UCP_AM_ID_AM_MIDDLE,
+                                   ucp_am_first_hdr_size(req),
+                                   sizeof(ucp_am_mid_hdr_t),
+                                   ucp_am_pack_first_generic,
+                                   ucp_am_pack_middle_generic,
+                                   ucp_am_pack_last_generic);
+    if (status == UCS_OK) {
+        ucp_am_generic_complete(self);
+    }
+    return status;
+}
+
+/* protocol selection */
+
+static ucs_status_t ucp_am_req_start_contig(ucp_request_t *req, size_t count)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    size_t only_hdr_size    = ucp_am_only_hdr_size(req);
+    size_t first_hdr_size   = ucp_am_first_hdr_size(req);
+    size_t mid_hdr_size     = sizeof(ucp_am_mid_hdr_t);
+    ucs_status_t status;
+    size_t length;
+    int zcopy;
+
+    length           = ucp_contig_dt_length(req->send.datatype, count);
+    req->send.length = length;
+
+    /* The user header must be sent as part of a single zero-copy header */
+    zcopy = (length >= config->zcopy_thresh) &&
+            (first_hdr_size <= ucs_min(config->max_am_zcopy_hdr,
+                                       UCP_AM_ZCOPY_MAX_HDR)) &&
+            (first_hdr_size < config->max_am_zcopy);
+
+    if ((req->send.am.header_length == 0) && (length <= config->max_am_short)) {
+        /* short */
+        req->send.uct.func = ucp_am_contig_short;
+    } else if (!zcopy) {
+        /* bcopy */
+        if (only_hdr_size + length <= config->max_am_bcopy) {
+            req->send.uct.func = ucp_am_contig_bcopy_single;
+        } else if (first_hdr_size < config->max_am_bcopy) {
+            req->send.uct.func = ucp_am_contig_bcopy_multi;
+        } else {
+            return UCS_ERR_EXCEEDS_LIMIT;
+        }
+    } else {
+        /* zcopy */
+        status = ucp_request_send_buffer_reg(req, UCP_EP_OP_AM);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        req->send.uct_comp.func = ucp_am_contig_zcopy_completion;
+
+        if (only_hdr_size + length <= config->max_am_zcopy) {
+            req->send.uct_comp.count = 1;
+            req->send.uct.func       = ucp_am_contig_zcopy_single;
+        } else {
+            /* calculate number of zcopy fragments */
+            req->send.uct_comp.count = 1 +
+                    (length + first_hdr_size - mid_hdr_size - 1) /
+                    (config->max_am_zcopy - mid_hdr_size);
+            req->send.uct.func       = ucp_am_contig_zcopy_multi;
+        }
+    }
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_am_req_start_generic(ucp_request_t *req, size_t count)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    ucp_dt_generic_t *dt_gen;
+    size_t length;
+    void *state;
+
+    dt_gen = ucp_dt_generic(req->send.datatype);
+    state  = dt_gen->ops.start_pack(dt_gen->context, req->send.buffer, count);
+
+    req->send.state.dt.generic.state    = state;
+    req->send.state.dt.generic.pipeline = NULL;
+    req->send.length = length = dt_gen->ops.packed_size(state);
+
+    if (ucp_am_only_hdr_size(req) + length <= config->max_am_bcopy) {
+        req->send.uct.func = ucp_am_generic_single;
+    } else if (ucp_am_first_hdr_size(req) < config->max_am_bcopy) {
+        req->send.uct.func = ucp_am_generic_multi;
+    } else {
+        dt_gen->ops.finish(state);
+        return UCS_ERR_EXCEEDS_LIMIT;
+    }
+    return UCS_OK;
+}
+
+ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id, const void *header,
+                                size_t header_length, const void *buffer,
+                                size_t count, ucp_datatype_t datatype,
+                                ucp_send_callback_t cb)
+{
+    ucs_status_t status;
+    ucp_request_t *req;
+    size_t length;
+
+    ucs_trace_req("am_send_nb id %u header %p length %zu buffer %p count %zu "
+                  "to %s cb %p", id, header, header_length, buffer, count,
+                  ucp_ep_peer_name(ep), cb);
+
+    if (ucs_likely(((datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG) &&
+                   (header_length == 0)))
+    {
+        length = ucp_contig_dt_length(datatype, count);
+        if (ucs_likely(length <= ucp_ep_config(ep)->max_am_short)) {
+            status = ucp_am_send_short(ep, id, buffer, length);
+            if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+                return UCS_STATUS_PTR(status); /* UCS_OK also goes here */
+            }
+        }
+    }
+
+    req = ucs_mpool_get_inline(&ep->worker->req_mp);
+    if (req == NULL) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+    }
+
+    ucp_send_req_init(req, ep);
+    req->cb.send                = cb;
+    req->send.buffer            = buffer;
+    req->send.datatype          = datatype;
+    req->send.state.offset      = 0;
+    req->send.am.am_id          = id;
+    req->send.am.header         = header;
+    req->send.am.header_length  = header_length;
+
+    switch (datatype & UCP_DATATYPE_CLASS_MASK) {
+    case UCP_DATATYPE_CONTIG:
+        status = ucp_am_req_start_contig(req, count);
+        break;
+    case UCP_DATATYPE_GENERIC:
+        status = ucp_am_req_start_generic(req, count);
+        break;
+    default:
+        ucs_error("Invalid data type");
+        status = UCS_ERR_INVALID_PARAM;
+        break;
+    }
+
+    if (status != UCS_OK) {
+        ucs_mpool_put(req);
+        return UCS_STATUS_PTR(status);
+    }
+
+    ucp_ep_add_pending(ep, ep->uct_eps[UCP_EP_OP_AM], req, 1);
+    ucp_worker_progress(ep->worker);
+    ucs_trace_req("returning am send request %p", req);
+    return req + 1;
+}
@@ -118,8 +118,56 @@ enum ucp_feature {
                                            operations support */
     UCP_FEATURE_AMO64  = UCS_BIT(3),  /**< Request 64-bit atomic
                                            operations support */
-    UCP_FEATURE_WAKEUP = UCS_BIT(4)   /**< Request interrupt notification
+    UCP_FEATURE_WAKEUP = UCS_BIT(4),  /**< Request interrupt notification
                                            support */
+    UCP_FEATURE_AM     = UCS_BIT(5),  /**< Request active message support */
+    UCP_FEATURE_STREAM = UCS_BIT(6)   /**< Request ordered byte-stream
+                                           support */
+};
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Flags for stream receive operations.
+ *
+ * The enumeration list describes flags which control the completion of
+ * @ref ucp_stream_recv_nb "stream receive" operations.
+ */
+enum ucp_stream_recv_flags {
+    UCP_STREAM_RECV_FLAG_WAITALL = UCS_BIT(0)  /**< Complete the receive only
+                                                    when the whole buffer is
+                                                    filled */
+};
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Priority classes of send operations.
+ *
+ * The enumeration list describes the classes which can be passed to
+ * @ref ucp_tag_send_prio_nb "prioritized send" operations. When sends to an
+ * endpoint wait for transport resources, messages of a higher class are sent
+ * before queued messages of a lower class, also between the fragments of a
+ * large message which was partially sent. Messages of the same class are sent
+ * in order.
+ */
+enum ucp_send_prio {
+    UCP_SEND_PRIO_LATENCY,  /**< Small latency-sensitive messages */
+    UCP_SEND_PRIO_BULK      /**< Bulk data, the class of all other send
+                                 operations */
+};
+
+
+/**
+ * @ingroup UCP_MEM
+ * @brief UCP memory mapping flags.
+ *
+ * The enumeration list describes flags which can be passed to
+ * @ref ucp_mem_map "ucp_mem_map()".
+ */
+enum ucp_mem_map_flags {
+    UCP_MEM_MAP_SYMMETRIC = UCS_BIT(0)  /**< Allocate the memory from the
+                                             symmetric heap of the context */
 };
 
 
@@ -339,6 +387,25 @@ struct ucp_tag_recv_info {
 };
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief UCP completion entry
+ *
+ * The completion entry is filled by @ref ucp_worker_poll_completions
+ * "ucp_worker_poll_completions" for every operation which was posted with a
+ * completion-queue routine, such as @ref ucp_tag_send_cq_nb
+ * "ucp_tag_send_cq_nb" or @ref ucp_tag_recv_cq_nb "ucp_tag_recv_cq_nb".
+ */
+typedef struct ucp_completion {
+    /** User data which was passed when the operation was posted */
+    void                                   *user_data;
+    /** Completion status of the operation */
+    ucs_status_t                           status;
+    /** Receive information, valid only for a receive completed with UCS_OK */
+    ucp_tag_recv_info_t                    info;
+} ucp_completion_t;
+
+
 /**
  * @ingroup UCP_CONFIG
  * @brief Read UCP configuration descriptor
@@ -635,10 +702,58 @@ void ucp_worker_release_address(ucp_worker_h worker, ucp_address_t *address);
  * ucp_worker_progress "this routine" to progress any outstanding operations.
  * @li Transport layers, implementing asynchronous progress using threads,
  * require callbacks and other user code to be thread safe.
+ * @li Transports which had no events recently are polled less frequently,
+ * while transports with recent events are polled on every call.
  *
  * @param [in]  worker    Worker to progress.
+ *
+ * @return Number of events processed by the transports, 0 if no progress
+ *         was made.
+ */
+unsigned ucp_worker_progress(ucp_worker_h worker);
+
+
+/**
+ * @ingroup UCP_WORKER
+ * @brief Reap completed operations from the worker completion queue.
+ *
+ * This routine copies up to @a max entries from the completion queue of the
+ * worker to the @a completions array, and removes them from the queue. The
+ * queue holds an entry for every operation which was posted with a
+ * completion-queue routine and has completed. The routine does not progress
+ * communications, so typically it is called after @ref ucp_worker_progress
+ * "ucp_worker_progress()".
+ *
+ * @param [in]  worker       Worker to reap completions from.
+ * @param [out] completions  Array of at least @a max entries to fill.
+ * @param [in]  max          Maximal number of entries to reap.
+ *
+ * @return Number of entries which were filled in @a completions.
+ */
+unsigned ucp_worker_poll_completions(ucp_worker_h worker,
+                                     ucp_completion_t *completions,
+                                     unsigned max);
+
+
+/**
+ * @ingroup UCP_WORKER
+ * @brief Set a handler for incoming active messages.
+ *
+ * This routine installs a user-defined callback, which is invoked for every
+ * active message with identifier @a id that arrives to the @a worker. Setting
+ * a NULL callback removes the existing handler, and messages which arrive
+ * without a handler are dropped. The context must have been created with
+ * @ref UCP_FEATURE_AM "UCP_FEATURE_AM".
+ *
+ * @param [in]  worker    UCP worker on which to set the handler.
+ * @param [in]  id        Active message identifier.
+ * @param [in]  cb        Active message callback, or NULL to remove it.
+ * @param [in]  arg       User-defined argument for the callback.
+ *
+ * @return Error code as defined by @ref ucs_status_t
  */
-void ucp_worker_progress(ucp_worker_h worker);
+ucs_status_t ucp_worker_set_am_handler(ucp_worker_h worker, uint16_t id,
+                                       ucp_am_callback_t cb, void *arg);
 
 
 /**
@@ -682,6 +797,12 @@ ucs_status_t ucp_worker_get_efd(ucp_worker_h worker, int *fd_p);
  * file descriptor obtained per worker using @ref ucp_worker_get_efd and the
  * second is waiting on the next event internally (this function).
  *
+ * Before blocking, the routine may busy-poll the worker for a short time,
+ * calling @ref ucp_worker_progress, in order to reduce the latency of events
+ * which arrive shortly. The maximal busy-poll time is set by the
+ * UCX_WAKEUP_SPIN_TIME configuration variable, and the actual time adapts to
+ * the recent delay until an event arrives.
+ *
  * @note During the blocking call the wake-up mechanism relies on other means of
  * notification and may not progress some of the requests as it would when
  * calling @ref ucp_worker_progress (which is not invoked in that duration).
@@ -843,7 +964,8 @@ ucs_status_t ucp_ep_flush(ucp_ep_h ep);
  *                            mapped (registered) memory segment and returns its
  *                            address in this argument.
  * @param [in]     length     Length (in bytes) to allocate or map (register).
- * @param [in]     flags      Allocation flags (currently reserved - set to 0).
+ * @param [in]     flags      Allocation flags, as defined by
+ *                            @ref ucp_mem_map_flags.
  * @param [out]    memh_p     UCP @ref ucp_mem_h "handle" for the allocated
  *                            segment.
  *
@@ -883,6 +1005,38 @@ ucs_status_t ucp_mem_map(ucp_context_h context, void **address_p, size_t length,
 ucs_status_t ucp_mem_unmap(ucp_context_h context, ucp_mem_h memh);
 
 
+/**
+ * @ingroup UCP_MEM
+ * @brief Query the symmetric heap.
+ *
+ * This routine returns the address and the memory handle of the symmetric
+ * heap, which is reserved when the context is created if the UCX_SYM_HEAP_SIZE
+ * configuration parameter is set. Memory mapped with
+ * @ref UCP_MEM_MAP_SYMMETRIC is allocated from the heap, at the same offset on
+ * all processes which make the same sequence of @ref ucp_mem_map
+ * "ucp_mem_map()" and @ref ucp_mem_unmap "ucp_mem_unmap()" calls.
+ *
+ * A remote key @ref ucp_rkey_pack "packed" from the returned handle, or from
+ * any symmetric allocation, is valid for the whole heap. So it's enough to
+ * exchange the remote key and the heap address once per peer, and the remote
+ * address of an allocation is the peer's heap address plus the local offset of
+ * the allocation. If UCX_SYM_HEAP_ADDRESS is set to the same value on all
+ * processes, the heap address is the same everywhere.
+ *
+ * @note The returned handle belongs to the context and must not be unmapped.
+ *
+ * @param [in]  context     Application @ref ucp_context_h "context".
+ * @param [out] address_p   Filled with the start address of the heap.
+ * @param [out] length_p    Filled with the length of the heap.
+ * @param [out] memh_p      Filled with the @ref ucp_mem_h "handle" of the heap.
+ *
+ * @return UCS_ERR_UNSUPPORTED if the symmetric heap is disabled, otherwise
+ *         UCS_OK.
+ */
+ucs_status_t ucp_mem_sym_heap_query(ucp_context_h context, void **address_p,
+                                    size_t *length_p, ucp_mem_h *memh_p);
+
+
 /**
  * @ingroup UCP_MEM
  * @brief Pack memory region remote access key.
@@ -1045,6 +1199,75 @@ ucs_status_ptr_t ucp_tag_send_nb(ucp_ep_h ep, const void *buffer, size_t count,
                                  ucp_send_callback_t cb);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking tagged-send operation using user-provided request memory.
+ *
+ * Same as @ref ucp_tag_send_nb, except that if a request is needed it is
+ * placed in the memory provided by the application, instead of being allocated
+ * from the library. This allows the application to embed the requests in its
+ * own objects. The returned request handle points to the application request
+ * area, which resides at the end of @a req_storage.
+ * Once the request is completed, the application may reuse or free the
+ * memory, and it must not call @ref ucp_request_release
+ * "ucp_request_release()" for it.
+ *
+ * @note The request initialization callback, which is passed in
+ *       @ref ucp_params_t, is not invoked on @a req_storage.
+ *
+ * @param [in]  ep          Destination endpoint handle.
+ * @param [in]  buffer      Pointer to the message buffer (payload).
+ * @param [in]  count       Number of elements to send
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  tag         Message tag.
+ * @param [in]  cb          Callback function that is invoked whenever the
+ *                          send operation is completed.
+ * @param [in]  req_storage Memory for the request, of at least
+ *                          @ref ucp_request_size "ucp_request_size()" bytes.
+ *                          It must stay valid until the request is completed.
+ *
+ * @return UCS_OK           - The send operation was completed immediately,
+ *                            and @a req_storage was not used.
+ * @return UCS_PTR_IS_ERR(_ptr) - The send operation failed.
+ * @return otherwise        - Operation was scheduled for send. The request
+ *                            handle, which resides in @a req_storage, is
+ *                            returned in order to track progress of the
+ *                            message.
+ */
+ucs_status_ptr_t ucp_tag_send_nbr(ucp_ep_h ep, const void *buffer, size_t count,
+                                  ucp_datatype_t datatype, ucp_tag_t tag,
+                                  ucp_send_callback_t cb, void *req_storage);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking tagged-send operation with a priority class.
+ *
+ * Same as @ref ucp_tag_send_nb, except the message is sent in the given
+ * priority class. A message of @ref UCP_SEND_PRIO_LATENCY class may be sent
+ * before messages of @ref UCP_SEND_PRIO_BULK class, which were sent earlier to
+ * the same endpoint and still wait for resources. Therefore, the application
+ * should not rely on matching order between messages of different classes.
+ * Only messages which are sent in a single fragment may bypass other messages;
+ * larger messages are sent in @ref UCP_SEND_PRIO_BULK class.
+ *
+ * @param [in]  ep          Destination endpoint handle.
+ * @param [in]  buffer      Pointer to the message buffer (payload).
+ * @param [in]  count       Number of elements to send
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  tag         Message tag.
+ * @param [in]  prio        Priority class of the message.
+ * @param [in]  cb          Callback function that is invoked whenever the
+ *                          send operation is completed.
+ *
+ * @return Same as @ref ucp_tag_send_nb.
+ */
+ucs_status_ptr_t ucp_tag_send_prio_nb(ucp_ep_h ep, const void *buffer,
+                                      size_t count, ucp_datatype_t datatype,
+                                      ucp_tag_t tag, enum ucp_send_prio prio,
+                                      ucp_send_callback_t cb);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking synchronous tagged-send operation.
@@ -1119,6 +1342,44 @@ ucs_status_ptr_t ucp_tag_recv_nb(ucp_worker_h worker, void *buffer, size_t count
                                  ucp_tag_t tag_mask, ucp_tag_recv_callback_t cb);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking tagged-receive operation using user-provided request
+ * memory.
+ *
+ * Same as @ref ucp_tag_recv_nb, except that the request is placed in the
+ * memory provided by the application, instead of being allocated from the
+ * library. The returned request handle points to the application request
+ * area, which resides at the end of @a req_storage. Once the request is
+ * completed, the application may reuse or free the memory, and it must not
+ * call @ref ucp_request_release "ucp_request_release()" for it.
+ *
+ * @note The request initialization callback, which is passed in
+ *       @ref ucp_params_t, is not invoked on @a req_storage.
+ *
+ * @param [in]  worker      UCP worker that is used for the receive operation.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  tag         Message tag to expect.
+ * @param [in]  tag_mask    Bit mask that indicates the bits that are used for
+ *                          the matching of the incoming tag
+ *                          against the expected tag.
+ * @param [in]  cb          Callback function that is invoked whenever the
+ *                          receive operation is completed and the data is ready
+ *                          in the receive @a buffer.
+ * @param [in]  req_storage Memory for the request, of at least
+ *                          @ref ucp_request_size "ucp_request_size()" bytes.
+ *                          It must stay valid until the request is completed.
+ *
+ * @return Request handle, which resides in @a req_storage.
+ */
+ucs_status_ptr_t ucp_tag_recv_nbr(ucp_worker_h worker, void *buffer, size_t count,
+                                  ucp_datatype_t datatype, ucp_tag_t tag,
+                                  ucp_tag_t tag_mask, ucp_tag_recv_callback_t cb,
+                                  void *req_storage);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Non-blocking probe and return a message.
@@ -1196,6 +1457,194 @@ ucs_status_ptr_t ucp_tag_msg_recv_nb(ucp_worker_h worker, void *buffer,
                                      ucp_tag_recv_callback_t cb);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking tagged-send operation with completion-queue reporting.
+ *
+ * Same as @ref ucp_tag_send_nb, except that no request handle is returned to
+ * the application. Instead, when the operation completes an entry holding
+ * @a user_data is added to the completion queue of the endpoint's worker, to
+ * be reaped by @ref ucp_worker_poll_completions
+ * "ucp_worker_poll_completions()". The request resources are released by the
+ * library once the operation is completed.
+ *
+ * @param [in]  ep          Destination endpoint handle.
+ * @param [in]  buffer      Pointer to the message buffer (payload).
+ * @param [in]  count       Number of elements to send
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  tag         Message tag.
+ * @param [in]  user_data   Opaque value returned in the completion entry.
+ *
+ * @return UCS_OK           - The send operation was completed immediately, and
+ *                            no completion entry is generated.
+ * @return UCS_INPROGRESS   - The send operation was scheduled, and a
+ *                            completion entry is generated once it completes.
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_tag_send_cq_nb(ucp_ep_h ep, const void *buffer, size_t count,
+                                ucp_datatype_t datatype, ucp_tag_t tag,
+                                void *user_data);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking tagged-receive operation with completion-queue reporting.
+ *
+ * Same as @ref ucp_tag_recv_nb, except that no request handle is returned to
+ * the application. Instead, when the message is delivered to the @a buffer an
+ * entry holding @a user_data and the receive information is added to the
+ * completion queue of the @a worker, to be reaped by @ref
+ * ucp_worker_poll_completions "ucp_worker_poll_completions()". The entry may
+ * already be on the queue when this routine returns.
+ *
+ * @param [in]  worker      UCP worker that is used for the receive operation.
+ * @param [in]  buffer      Pointer to the buffer to receive the data to.
+ * @param [in]  count       Number of elements to receive
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  tag         Message tag to expect.
+ * @param [in]  tag_mask    Bit mask that indicates the bits that are used for
+ *                          the matching of the incoming tag
+ *                          against the expected tag.
+ * @param [in]  user_data   Opaque value returned in the completion entry.
+ *
+ * @return UCS_INPROGRESS   - The receive operation was scheduled, and a
+ *                            completion entry is generated once it completes.
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_tag_recv_cq_nb(ucp_worker_h worker, void *buffer, size_t count,
+                                ucp_datatype_t datatype, ucp_tag_t tag,
+                                ucp_tag_t tag_mask, void *user_data);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking active message send operation.
+ *
+ * This routine sends an active message, which consists of a user @a header
+ * and a payload described by @a buffer, @a count and @a datatype, to the
+ * destination endpoint @a ep. On the receiver side, the message is delivered
+ * to the callback which was @ref ucp_worker_set_am_handler "registered" for
+ * @a id, without tag matching. The message is sent using the same eager
+ * short, bcopy and zero-copy protocols as tagged messages, and may be split
+ * into several fragments. The user header is always sent in the first
+ * fragment, so it must fit into a single transport segment.
+ *
+ * @note Like the payload, the user header is not copied when the operation is
+ *       scheduled. If a request handle is returned, both @a header and
+ *       @a buffer must remain valid, and must not be modified, until the
+ *       request is completed.
+ *
+ * @param [in]  ep             Destination endpoint handle.
+ * @param [in]  id             Active message identifier.
+ * @param [in]  header         Pointer to the user header. It is referenced,
+ *                             not copied, until the request is completed.
+ * @param [in]  header_length  Length of the user header.
+ * @param [in]  buffer         Pointer to the message payload.
+ * @param [in]  count          Number of elements to send.
+ * @param [in]  datatype       Datatype descriptor for the elements in the buffer.
+ * @param [in]  cb             Callback function that is invoked whenever the
+ *                             send operation is completed. It is only invoked
+ *                             when the operation cannot be completed in place.
+ *
+ * @return UCS_OK               - The send operation was completed immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The send operation failed.
+ * @return otherwise            - Operation was scheduled for send. The request
+ *                                handle is returned to the application in
+ *                                order to track progress of the message. The
+ *                                application is responsible to release the
+ *                                handle using @ref ucp_request_release
+ *                                "ucp_request_release()" routine.
+ */
+ucs_status_ptr_t ucp_am_send_nb(ucp_ep_h ep, uint16_t id, const void *header,
+                                size_t header_length, const void *buffer,
+                                size_t count, ucp_datatype_t datatype,
+                                ucp_send_callback_t cb);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Release an active message descriptor.
+ *
+ * This routine releases a receive descriptor, which was kept by an @ref
+ * ucp_am_callback_t "active message callback" returning UCS_INPROGRESS. After
+ * this call, the header and the payload of the message are no longer valid.
+ *
+ * @param [in]  worker    UCP worker on which the message was received.
+ * @param [in]  desc      Descriptor passed to the active message callback.
+ */
+void ucp_am_desc_release(ucp_worker_h worker, void *desc);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking stream send operation.
+ *
+ * This routine sends the data described by @a buffer, @a count and
+ * @a datatype to the destination endpoint @a ep, as part of an ordered byte
+ * stream. Data sent on the same endpoint is delivered to the remote peer in
+ * the order it was sent, without message boundaries and without tag matching.
+ * The remote peer consumes the data by @ref ucp_stream_recv_nb
+ * "ucp_stream_recv_nb()" on its endpoint to the sender. The semantics of the
+ * returned request and of @a cb are the same as for @ref ucp_tag_send_nb
+ * "ucp_tag_send_nb()".
+ *
+ * @param [in]  ep          Destination endpoint handle.
+ * @param [in]  buffer      Pointer to the data to send.
+ * @param [in]  count       Number of elements to send.
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  cb          Callback function that is invoked whenever the
+ *                          send operation is completed.
+ *
+ * @return UCS_OK           - The send operation was completed immediately.
+ * @return UCS_PTR_IS_ERR(_ptr) - The send operation failed.
+ * @return otherwise        - Operation was scheduled for send and can be
+ *                          completed in any point in time. The request handle
+ *                          is returned to the application in order to track
+ *                          progress of the message.
+ */
+ucs_status_ptr_t ucp_stream_send_nb(ucp_ep_h ep, const void *buffer,
+                                    size_t count, ucp_datatype_t datatype,
+                                    ucp_send_callback_t cb);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Non-blocking stream receive operation.
+ *
+ * This routine receives data from the byte stream of endpoint @a ep into the
+ * buffer described by @a buffer, @a count and @a datatype. Data which already
+ * arrived is consumed immediately; otherwise the receive waits for more data.
+ * By default, the operation completes as soon as any amount of data was
+ * received. If @ref UCP_STREAM_RECV_FLAG_WAITALL is set in @a flags, it
+ * completes only once the whole buffer is filled.
+ *
+ * @param [in]  ep          Endpoint to receive the data from.
+ * @param [in]  buffer      Pointer to the receive buffer.
+ * @param [in]  count       Number of elements to receive.
+ * @param [in]  datatype    Datatype descriptor for the elements in the buffer.
+ * @param [in]  cb          Callback function that is invoked whenever the
+ *                          receive operation is completed, with the number of
+ *                          bytes received.
+ * @param [out] length      Number of bytes received, if the operation was
+ *                          completed immediately.
+ * @param [in]  flags       Receive flags, as defined by
+ *                          @ref ucp_stream_recv_flags.
+ *
+ * @return NULL             - The receive operation was completed immediately,
+ *                          and @a length holds the number of bytes received.
+ *                          In this case @a cb is not invoked.
+ * @return UCS_PTR_IS_ERR(_ptr) - The receive operation failed.
+ * @return otherwise        - Receive operation was initiated, and the request
+ *                          handle is returned to the application. It should
+ *                          be released by @ref ucp_request_release
+ *                          "ucp_request_release()".
+ */
+ucs_status_ptr_t ucp_stream_recv_nb(ucp_ep_h ep, void *buffer, size_t count,
+                                    ucp_datatype_t datatype,
+                                    ucp_stream_recv_callback_t cb,
+                                    size_t *length, unsigned flags);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Blocking remote memory put operation.
@@ -1562,6 +2011,24 @@ ucs_status_t ucp_atomic_cswap64(ucp_ep_h ep, uint64_t compare, uint64_t swap,
 int ucp_request_is_completed(void *request);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Get the size of request memory.
+ *
+ * This routine returns the amount of memory which the application has to
+ * provide for a single request when using the routines which accept
+ * user-provided request memory, such as @ref ucp_tag_send_nbr
+ * "ucp_tag_send_nbr()" and @ref ucp_tag_recv_nbr "ucp_tag_recv_nbr()". The
+ * size includes the application request area, as defined by
+ * @ref ucp_params_t::request_size "request_size".
+ *
+ * @param [in]  context      UCP context.
+ *
+ * @return Request memory size, in bytes.
+ */
+size_t ucp_request_size(ucp_context_h context);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Release a communications request.
@@ -1601,10 +2068,39 @@ void ucp_request_release(void *request);
  * important to note that in order to release the request back to the library
  * the application is responsible to call @ref ucp_request_release
  * "ucp_request_release()".
+ *
+ * Expected receive requests can always be canceled. Send requests can be
+ * canceled as long as they did not start transmission, for example when they
+ * wait for send resources or for the connection to be established. A send
+ * which already started transmission is completed normally.
  */
 void ucp_request_cancel(ucp_worker_h worker, void *request);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Set a deadline for an outstanding communications request.
+ *
+ * @param [in]  worker       UCP worker which progresses the request.
+ * @param [in]  request      Non-blocking request to set the deadline for.
+ * @param [in]  timeout      Time in seconds from now until the deadline.
+ *
+ * This routine arms a timer which cancels the @a request if it is not
+ * completed within @a timeout seconds, in the same way as @ref
+ * ucp_request_cancel "ucp_request_cancel()" does, except that the completion
+ * callback is called with the @a status argument set to UCS_ERR_TIMED_OUT.
+ * Calling this routine again for the same request moves the deadline. The
+ * deadline is checked by @ref ucp_worker_progress "ucp_worker_progress()" with
+ * a resolution of about a millisecond, so the worker has to be progressed for
+ * the request to expire. Requests which cannot be canceled by the time the
+ * deadline passes complete normally.
+ *
+ * @return Error code as defined by @ref ucs_status_t
+ */
+ucs_status_t ucp_request_set_timeout(ucp_worker_h worker, void *request,
+                                     double timeout);
+
+
 /**
  * @ingroup UCP_DATATYPE
  * @brief Create a generic datatype.
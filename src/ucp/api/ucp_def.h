@@ -200,6 +200,56 @@ typedef void (*ucp_request_cleanup_callback_t)(void *request);
 typedef void (*ucp_send_callback_t)(void *request, ucs_status_t status);
 
 
+/**
+ * @ingroup UCP_COMM
+ * @brief Callback for incoming active messages.
+ *
+ * This callback routine is invoked on the receiver side for every active
+ * message which was sent by @ref ucp_am_send_nb "ucp_am_send_nb()" with the
+ * identifier it was @ref ucp_worker_set_am_handler "registered" for. The
+ * callback is invoked from the context of @ref ucp_worker_progress
+ * "ucp_worker_progress()".
+ *
+ * @param [in]  arg            User-defined argument, passed during handler
+ *                             registration.
+ * @param [in]  header         Pointer to the user header of the message.
+ * @param [in]  header_length  Length of the user header.
+ * @param [in]  data           Pointer to the message payload.
+ * @param [in]  length         Length of the message payload.
+ * @param [in]  desc           Receive descriptor which holds the message. It
+ *                             should be passed to @ref ucp_am_desc_release
+ *                             "ucp_am_desc_release()" if the callback returns
+ *                             UCS_INPROGRESS.
+ *
+ * @return UCS_OK          - The message is no longer needed, and @a header and
+ *                           @a data are invalid after the callback returns.
+ * @return UCS_INPROGRESS  - The callback keeps the message, and @a header and
+ *                           @a data remain valid until @a desc is released.
+ */
+typedef ucs_status_t (*ucp_am_callback_t)(void *arg, const void *header,
+                                          size_t header_length, void *data,
+                                          size_t length, void *desc);
+
+
+/**
+ * @ingroup UCP_COMM
+ * @brief Completion callback for non-blocking stream receives.
+ *
+ * This callback routine is invoked whenever the @ref ucp_stream_recv_nb
+ * "stream receive operation" is completed and the data is ready in the receive
+ * buffer.
+ *
+ * @param [in]  request   The completed receive request.
+ * @param [in]  status    Completion status. If the receive operation was
+ *                        completed successfully UCS_OK is returned. If it was
+ *                        canceled because the endpoint was destroyed,
+ *                        UCS_ERR_CANCELED is returned.
+ * @param [in]  length    Number of bytes received into the buffer.
+ */
+typedef void (*ucp_stream_recv_callback_t)(void *request, ucs_status_t status,
+                                           size_t length);
+
+
 /**
  * @ingroup UCP_COMM
  * @brief Completion callback for non-blocking tag receives.
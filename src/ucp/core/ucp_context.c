@@ -5,7 +5,7 @@
  */
 
 #include "ucp_context.h"
-
+#include "ucp_mm.h"
 
 #include <ucs/config/parser.h>
 #include <ucs/datastruct/mpool.inl>
@@ -13,11 +13,24 @@
 #include <ucs/debug/log.h>
 #include <ucs/sys/compiler.h>
 #include <ucs/arch/bitops.h>
+#include <ucs/sys/sys.h>
+#include <ucs/time/time.h>
+#include <stdlib.h>
 #include <string.h>
 
 
 ucp_am_handler_t ucp_am_handlers[UCP_AM_ID_LAST] = {{0, NULL, NULL}};
 
+#if ENABLE_STATS
+static ucs_stats_class_t ucp_context_stats_class = {
+    .name           = "ucp_context",
+    .num_counters   = UCP_CONTEXT_STAT_LAST,
+    .counter_names  = {
+        [UCP_CONTEXT_STAT_RESOURCES_TIME] = "resources_time"
+    }
+};
+#endif
+
 
 static ucs_config_field_t ucp_config_table[] = {
   {"NET_DEVICES", "all",
@@ -39,7 +52,7 @@ static ucs_config_field_t ucp_config_table[] = {
    "Comma-separated list of transports to use. The order is not meaningful.\n"
    "In addition it's possible to use a combination of the following aliases:\n"
    " - all    : use all the available transports.\n"
-   " - sm/shm : all shared memory transports.\n"
+   " - sm/shm : all shared memory transports, and the loopback transport.\n"
    " - mm     : shared memory transports - only memory mappers.\n"
    " - ugni   : ugni_rdma and ugni_udt.\n"
    " - rc     : rc and ud.\n"
@@ -80,12 +93,70 @@ static ucs_config_field_t ucp_config_table[] = {
    "Maximal length of worker name. Affects the size of worker address.",
    ucs_offsetof(ucp_config_t, ctx.max_worker_name), UCS_CONFIG_TYPE_UINT},
 
+  {"WAKEUP_SPIN_TIME", "20us",
+   "Maximal time to progress the worker in ucp_worker_wait() before blocking.\n"
+   "The actual spin time adapts to the recent delay until an event arrives.\n"
+   "0 means always block immediately.",
+   ucs_offsetof(ucp_config_t, ctx.wakeup_spin_time), UCS_CONFIG_TYPE_TIME},
+
+  {"LAZY_IFACES", "n",
+   "Open the transport interfaces of a worker on first use, when an endpoint\n"
+   "selects them or when the worker address is requested, instead of opening\n"
+   "all of them when the worker is created.",
+   ucs_offsetof(ucp_config_t, ctx.lazy_ifaces), UCS_CONFIG_TYPE_BOOL},
+
+  {"GENERIC_PIPELINE_DEPTH", "4",
+   "Number of staging buffers used to send a generic datatype with zero copy.\n"
+   "Fragments are packed into the staging buffers while earlier fragments are\n"
+   "still being sent. 0 means generic datatypes are always sent with buffer copy.",
+   ucs_offsetof(ucp_config_t, ctx.generic_pipeline_depth), UCS_CONFIG_TYPE_UINT},
+
+  {"GENERIC_PIPELINE_FRAG_SIZE", "64k",
+   "Size of a staging buffer used to send a generic datatype with zero copy.\n"
+   "The staging buffers are registered once, and shared by all requests of the worker.",
+   ucs_offsetof(ucp_config_t, ctx.generic_pipeline_frag_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"BOUNCE_SIZE", "8k",
+   "Size of the pre-registered bounce buffers. A message up to this size, sent\n"
+   "with zero copy from a buffer which was not sent recently, is copied to a\n"
+   "bounce buffer instead of registering the user memory. 0 disables bounce buffers.",
+   ucs_offsetof(ucp_config_t, ctx.bounce_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"BOUNCE_MAX_BUFS", "256",
+   "Maximal number of bounce buffers per protection domain. When all of them\n"
+   "are in use, the user memory is registered.",
+   ucs_offsetof(ucp_config_t, ctx.bounce_max_bufs), UCS_CONFIG_TYPE_UINT},
+
+  {"BOUNCE_HUGETLB", "y",
+   "Try to allocate bounce buffers on huge pages.",
+   ucs_offsetof(ucp_config_t, ctx.bounce_hugetlb), UCS_CONFIG_TYPE_BOOL},
+
+  {"SYM_HEAP_SIZE", "0",
+   "Size of the symmetric heap, which is reserved when the context is created.\n"
+   "Memory mapped with UCP_MEM_MAP_SYMMETRIC is allocated from it at the same\n"
+   "offset on all processes which make the same sequence of calls, and one\n"
+   "remote key is valid for the whole heap. 0 disables the symmetric heap.",
+   ucs_offsetof(ucp_config_t, ctx.sym_heap_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+  {"SYM_HEAP_ADDRESS", "auto",
+   "Virtual address to reserve the symmetric heap at, in hexadecimal. If all\n"
+   "processes use the same address, symmetric allocations have the same address\n"
+   "everywhere. \"auto\" allocates the heap with the methods from ALLOC_PRIO,\n"
+   "at any address.",
+   ucs_offsetof(ucp_config_t, sym_heap_address), UCS_CONFIG_TYPE_STRING},
+
+  {"NUMA_REMOTE_FACTOR", "0.5",
+   "Factor to apply to the score of a transport whose device is attached to\n"
+   "another NUMA node than the CPU which created the worker. 1 disables NUMA-aware\n"
+   "transport selection.",
+   ucs_offsetof(ucp_config_t, ctx.numa_remote_factor), UCS_CONFIG_TYPE_DOUBLE},
+
   {NULL}
 };
 
 static ucp_tl_alias_t ucp_tl_aliases[] = {
-  { "sm",    { "mm", "knem", "sysv", "posix", "cma", "xpmem", NULL } },
-  { "shm",   { "mm", "knem", "sysv", "posix", "cma", "xpmem", NULL } },
+  { "sm",    { "mm", "knem", "sysv", "posix", "cma", "xpmem", "self", NULL } },
+  { "shm",   { "mm", "knem", "sysv", "posix", "cma", "xpmem", "self", NULL } },
   { "rc",    { "rc", "ud", NULL } },
   { "rc_x",  { "rc_mlx5", "ud_mlx5", NULL } },
   { "ud_x",  { "ud_mlx5", NULL } },
@@ -253,6 +324,42 @@ static int ucp_is_resource_enabled(uct_tl_resource_desc_t *resource,
     return device_enabled && tl_enabled;
 }
 
+/**
+ * Find the NUMA node of a network device in sysfs. Shared memory devices are
+ * not attached to a node.
+ */
+static int ucp_tl_resource_numa_node(const uct_tl_resource_desc_t *resource)
+{
+    static const char *sysfs_classes[] = {"infiniband", "net", NULL};
+    char dev_name[UCT_DEVICE_NAME_MAX];
+    char path[MAXPATHLEN];
+    const char **sysfs_class;
+    char *p;
+    int node;
+
+    if (resource->dev_type != UCT_DEVICE_TYPE_NET) {
+        return -1;
+    }
+
+    /* IB device names include the port number, e.g mlx5_0:1 */
+    ucs_snprintf_zero(dev_name, sizeof(dev_name), "%s", resource->dev_name);
+    p = strchr(dev_name, ':');
+    if (p != NULL) {
+        *p = '\0';
+    }
+
+    for (sysfs_class = sysfs_classes; *sysfs_class != NULL; ++sysfs_class) {
+        snprintf(path, sizeof(path), "/sys/class/%s/%s/device", *sysfs_class,
+                 dev_name);
+        node = ucs_numa_node_of_device(path);
+        if (node >= 0) {
+            return node;
+        }
+    }
+
+    return -1;
+}
+
 static ucs_status_t ucp_add_tl_resources(ucp_context_h context,
                                          uct_pd_h pd, ucp_rsc_index_t pd_index,
                                          const ucp_config_t *config,
@@ -299,6 +406,8 @@ static ucs_status_t ucp_add_tl_resources(ucp_context_h context,
         if (ucp_is_resource_enabled(&tl_resources[i], config, masks)) {
             context->tl_rscs[context->num_tls].tl_rsc   = tl_resources[i];
             context->tl_rscs[context->num_tls].pd_index = pd_index;
+            context->tl_rscs[context->num_tls].numa_node =
+                            ucp_tl_resource_numa_node(&tl_resources[i]);
             ++context->num_tls;
             ++(*num_resources_p);
         }
@@ -504,6 +613,7 @@ static ucs_status_t ucp_fill_config(ucp_context_h context,
     unsigned i, num_alloc_methods, method;
     const char *method_name;
     ucs_status_t status;
+    char *end;
 
     if (0 == params->features) {
         ucs_warn("empty features set passed to ucp context create");
@@ -515,6 +625,21 @@ static ucs_status_t ucp_fill_config(ucp_context_h context,
     context->config.request.cleanup = params->request_cleanup;
     context->config.ext             = config->ctx;
 
+    if (!strcasecmp(config->sym_heap_address, "auto")) {
+        context->config.sym_heap_address = 0;
+    } else {
+        context->config.sym_heap_address = strtoul(config->sym_heap_address,
+                                                   &end, 16);
+        if ((*end != '\0') || (context->config.sym_heap_address == 0) ||
+            (context->config.sym_heap_address % ucs_get_page_size()))
+        {
+            ucs_error("Invalid symmetric heap address: %s",
+                      config->sym_heap_address);
+            status = UCS_ERR_INVALID_PARAM;
+            goto err;
+        }
+    }
+
     /* Get allocation alignment from configuration, make sure it's valid */
     if (config->alloc_prio.count == 0) {
         ucs_error("No allocation methods specified - aborting");
@@ -587,6 +712,7 @@ ucs_status_t ucp_init_version(unsigned api_major_version, unsigned api_minor_ver
 {
     unsigned major_version, minor_version, release_number;
     ucp_context_t *context;
+    ucs_time_t start_time;
     ucs_status_t status;
 
     ucp_get_version(&major_version, &minor_version, &release_number);
@@ -611,19 +737,41 @@ ucs_status_t ucp_init_version(unsigned api_major_version, unsigned api_minor_ver
         goto err_free_ctx;
     }
 
-    /* fill resources we should use */
-    status = ucp_fill_resources(context, config);
+    status = UCS_STATS_NODE_ALLOC(&context->stats, &ucp_context_stats_class,
+                                  NULL, "-%p", context);
     if (status != UCS_OK) {
         goto err_free_config;
     }
 
+    /* fill resources we should use */
+    start_time = ucs_get_time();
+    status     = ucp_fill_resources(context, config);
+    if (status != UCS_OK) {
+        goto err_free_stats;
+    }
+
+    UCS_STATS_SET_TIME(context->stats, UCP_CONTEXT_STAT_RESOURCES_TIME,
+                       start_time);
+    ucs_debug("context %p: opened %d pds and %d transports in %.3f ms", context,
+              context->num_pds, context->num_tls,
+              ucs_time_to_msec(ucs_get_time() - start_time));
+
     /* initialize tag matching */
     ucs_queue_head_init(&context->tag.expected);
     ucs_queue_head_init(&context->tag.unexpected);
 
+    status = ucp_sym_heap_init(context);
+    if (status != UCS_OK) {
+        goto err_free_resources;
+    }
+
     *context_p = context;
     return UCS_OK;
 
+err_free_resources:
+    ucp_free_resources(context);
+err_free_stats:
+    UCS_STATS_NODE_FREE(context->stats);
 err_free_config:
     ucp_free_config(context);
 err_free_ctx:
@@ -634,7 +782,9 @@ err:
 
 void ucp_cleanup(ucp_context_h context)
 {
+    ucp_sym_heap_cleanup(context);
     ucp_free_resources(context);
+    UCS_STATS_NODE_FREE(context->stats);
     ucp_free_config(context);
     ucs_free(context);
 }
@@ -10,7 +10,9 @@
 
 #include <ucp/api/ucp.h>
 #include <uct/api/uct.h>
+#include <ucs/datastruct/list.h>
 #include <ucs/datastruct/queue_types.h>
+#include <ucs/stats/stats.h>
 #include <ucs/type/component.h>
 
 
@@ -19,6 +21,16 @@
 #define UCP_WORKER_NAME_MAX       32
 #define UCP_NULL_RESOURCE         ((ucp_rsc_index_t)-1)
 
+/**
+ * UCP context statistics counters
+ */
+enum {
+    UCP_CONTEXT_STAT_RESOURCES_TIME, /* Time spent opening PDs and querying
+                                        transport resources, in nsec */
+    UCP_CONTEXT_STAT_LAST
+};
+
+
 typedef uint8_t                   ucp_rsc_index_t;
 typedef struct ucp_request        ucp_request_t;
 typedef struct ucp_address_entry  ucp_address_entry_t;
@@ -40,6 +52,12 @@ enum {
     UCP_AM_ID_EAGER_SYNC_FIRST  =  7, /* First eager-sync fragment */
     UCP_AM_ID_EAGER_SYNC_ACK    =  8, /* Eager-sync acknowldge */
 
+    UCP_AM_ID_AM_ONLY           =  9, /* Single packet user active message */
+    UCP_AM_ID_AM_FIRST          = 10, /* First user active message fragment */
+    UCP_AM_ID_AM_MIDDLE         = 11, /* Middle or last user active message fragment */
+
+    UCP_AM_ID_STREAM_DATA       = 12, /* Stream data fragment */
+
     UCP_AM_ID_LAST
 };
 
@@ -57,6 +75,24 @@ typedef struct ucp_context_config {
     size_t                                 log_data_size;
     /** Maximal size of worker name for debugging */
     unsigned                               max_worker_name;
+    /** Maximal time to busy-poll in ucp_worker_wait() before blocking */
+    double                                 wakeup_spin_time;
+    /** Open worker interfaces on first use instead of in ucp_worker_create() */
+    int                                    lazy_ifaces;
+    /** Number of staging buffers for sending generic datatypes with zcopy */
+    unsigned                               generic_pipeline_depth;
+    /** Size of a staging buffer for sending generic datatypes with zcopy */
+    size_t                                 generic_pipeline_frag_size;
+    /** Maximal message size to copy to a bounce buffer instead of registering */
+    size_t                                 bounce_size;
+    /** Maximal number of bounce buffers per protection domain */
+    unsigned                               bounce_max_bufs;
+    /** Allocate bounce buffers on huge pages */
+    int                                    bounce_hugetlb;
+    /** Size of the symmetric heap, 0 if disabled */
+    size_t                                 sym_heap_size;
+    /** Score factor of transports on another NUMA node than the worker */
+    double                                 numa_remote_factor;
 } ucp_context_config_t;
 
 
@@ -69,6 +105,8 @@ struct ucp_config {
     str_names_array_t                      tls;
     /** Array of memory allocation methods */
     UCS_CONFIG_STRING_ARRAY_FIELD(methods) alloc_prio;
+    /** Virtual address of the symmetric heap */
+    char                                   *sym_heap_address;
     /** Configuration saved directly in the context */
     ucp_context_config_t                   ctx;
 };
@@ -88,6 +126,7 @@ typedef void (*ucp_am_tracer_t)(ucp_worker_h worker, uct_am_trace_type_t type,
 typedef struct ucp_tl_resource_desc {
     uct_tl_resource_desc_t        tl_rsc;   /* UCT resource descriptor */
     ucp_rsc_index_t               pd_index; /* Protection domain index (within the context) */
+    int                           numa_node; /* NUMA node of the device, -1 if unknown */
 } ucp_tl_resource_desc_t;
 
 
@@ -112,11 +151,18 @@ typedef struct ucp_context {
     ucp_tl_resource_desc_t        *tl_rscs;   /* Array of communication resources */
     ucp_rsc_index_t               num_tls;    /* Number of resources in the array*/
 
+    UCS_STATS_NODE_DECLARE(stats);
+
     struct {
         ucs_queue_head_t          expected;   /* Expected requests */
         ucs_queue_head_t          unexpected; /* Unexpected received descriptors */
     } tag;
 
+    struct {
+        ucp_mem_h                 memh;       /* Registration of the whole heap */
+        ucs_list_link_t           allocs;     /* Allocations, sorted by address */
+    } sym_heap;
+
     struct {
 
         /* Bitmap of features supported by the context */
@@ -138,6 +184,9 @@ typedef struct ucp_context {
         } *alloc_methods;
         unsigned                  num_alloc_methods;
 
+        /* Address to reserve the symmetric heap at, 0 - any address */
+        uintptr_t                 sym_heap_address;
+
         /* Configuration supplied by the user */
         ucp_context_config_t      ext;
 
@@ -8,8 +8,11 @@
 #include "ucp_request.h"
 #include "ucp_worker.h"
 
+#include <ucp/stream/stream.h>
+#include <ucp/tag/eager.h>
 #include <ucp/wireup/stub_ep.h>
 #include <ucp/wireup/wireup.h>
+#include <ucs/datastruct/queue.h>
 #include <ucs/debug/memtrack.h>
 #include <ucs/debug/log.h>
 #include <string.h>
@@ -33,6 +36,7 @@ static ucs_status_t ucp_ep_new(ucp_worker_h worker, uint64_t dest_uuid,
     ep->amo_dst_pdi          = UCP_NULL_RESOURCE;
     ep->cfg_index            = 0;
     ep->flags                = 0;
+    ucp_stream_ep_init(ep);
 #if ENABLE_DEBUG_DATA
     ucs_snprintf_zero(ep->peer_name, UCP_WORKER_NAME_MAX, "%s", peer_name);
 #endif
@@ -119,14 +123,165 @@ ucs_status_t ucp_ep_pending_req_release(uct_pending_req_t *self)
     return UCS_OK;
 }
 
+/*
+ * While a request is out of the transport pending queue, its private area holds
+ * the link in the worker queues and the transport endpoint to re-add it to.
+ */
+typedef struct ucp_ep_pending_priv {
+    ucs_queue_elem_t    queue;
+    uct_ep_h            uct_ep;
+} ucp_ep_pending_priv_t;
+
+static inline ucp_ep_pending_priv_t* ucp_ep_pending_req_priv(uct_pending_req_t *req)
+{
+    UCS_STATIC_ASSERT(sizeof(ucp_ep_pending_priv_t) <= UCT_PENDING_REQ_PRIV_LEN);
+    return (ucp_ep_pending_priv_t*)req->priv;
+}
+
+static ucs_status_t ucp_ep_pending_req_requeue(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+
+    ucs_queue_push(&req->send.ep->worker->requeue_q,
+                   &ucp_ep_pending_req_priv(self)->queue);
+    return UCS_OK;
+}
+
+static int ucp_ep_pending_remove_deferred(ucp_ep_h ep, ucp_request_t *req)
+{
+    ucs_queue_head_t *deferred_q = &ep->worker->deferred_q;
+    ucp_ep_pending_priv_t *priv;
+    ucs_queue_iter_t iter;
+
+    ucs_queue_for_each_safe(priv, iter, deferred_q, queue) {
+        if (priv == ucp_ep_pending_req_priv(&req->send.uct)) {
+            ucs_queue_del_iter(deferred_q, iter);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Put back a request taken out of the pending queue of uct_ep. If the transport
+ * has resources and refuses it, defer it to the worker progress instead of
+ * sending it here, so canceling a request does not complete other ones.
+ */
+static void ucp_ep_pending_readd(ucp_ep_h ep, uct_ep_h uct_ep,
+                                 uct_pending_req_t *uct_req, int *deferred)
+{
+    ucp_request_t *req = ucs_container_of(uct_req, ucp_request_t, send.uct);
+    ucp_ep_pending_priv_t *priv;
+    ucs_status_t status;
+
+    if (!*deferred) {
+        status = uct_ep_pending_add_prio(uct_ep, uct_req, req->send.prio);
+        if (status != UCS_ERR_BUSY) {
+            ucs_assert(status == UCS_OK);
+            return;
+        }
+        *deferred = 1; /* Keep the order of the following requests */
+    }
+
+    priv         = ucp_ep_pending_req_priv(uct_req);
+    priv->uct_ep = uct_ep;
+    ucs_queue_push(&ep->worker->deferred_q, &priv->queue);
+}
+
+unsigned ucp_ep_pending_dispatch_deferred(ucp_worker_h worker)
+{
+    ucp_ep_pending_priv_t *priv;
+    ucp_request_t *req;
+    unsigned count = 0;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    ucs_queue_for_each_extract(priv, &worker->deferred_q, queue, 1) {
+        req = ucs_container_of(priv, ucp_request_t, send.uct.priv);
+        ucp_ep_add_pending(req->send.ep, priv->uct_ep, req, 0);
+        ++count;
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+    return count;
+}
+
+static void ucp_ep_pending_release_deferred(ucp_ep_h ep)
+{
+    ucs_queue_head_t *deferred_q = &ep->worker->deferred_q;
+    ucp_ep_pending_priv_t *priv;
+    ucs_queue_iter_t iter;
+    ucp_request_t *req;
+
+    ucs_queue_for_each_safe(priv, iter, deferred_q, queue) {
+        req = ucs_container_of(priv, ucp_request_t, send.uct.priv);
+        if (req->send.ep == ep) {
+            ucs_queue_del_iter(deferred_q, iter);
+            ucp_ep_pending_req_release(&req->send.uct);
+        }
+    }
+}
+
+int ucp_ep_pending_remove(ucp_ep_h ep, ucp_request_t *req)
+{
+    ucs_queue_head_t *requeue_q = &ep->worker->requeue_q;
+    ucp_ep_op_t optype, prev_optype;
+    ucp_ep_pending_priv_t *priv;
+    uct_ep_h uct_ep;
+    int found, deferred;
+
+    found = ucp_ep_pending_remove_deferred(ep, req);
+    for (optype = 0; (optype < UCP_EP_OP_LAST) && !found; ++optype) {
+        uct_ep = ep->uct_eps[optype];
+        if (uct_ep == NULL) {
+            continue;
+        }
+
+        /* Several operation types may share the same transport endpoint */
+        for (prev_optype = 0; prev_optype < optype; ++prev_optype) {
+            if (ep->uct_eps[prev_optype] == uct_ep) {
+                break;
+            }
+        }
+        if (prev_optype < optype) {
+            continue;
+        }
+
+        if (ucp_stub_ep_test(uct_ep)) {
+            found = ucp_stub_ep_pending_remove(uct_ep, &req->send.uct);
+            continue;
+        }
+
+        /* Transports can only purge the whole pending queue, so take out all
+         * requests and add back all but the removed one, in the same order */
+        ucs_assert(ucs_queue_is_empty(requeue_q));
+        uct_ep_pending_purge(uct_ep, ucp_ep_pending_req_requeue);
+        deferred = 0;
+        ucs_queue_for_each_extract(priv, requeue_q, queue, 1) {
+            if (priv == ucp_ep_pending_req_priv(&req->send.uct)) {
+                found = 1;
+            } else {
+                ucp_ep_pending_readd(ep, uct_ep,
+                                     ucs_container_of(priv, uct_pending_req_t,
+                                                      priv),
+                                     &deferred);
+            }
+        }
+    }
+
+    if (found) {
+        ucs_trace_req("ep %p: removed request %p from pending queue", ep, req);
+    }
+    return found;
+}
+
 ucs_status_t ucp_ep_add_pending_uct(ucp_ep_h ep, uct_ep_h uct_ep,
                                     uct_pending_req_t *req)
 {
+    ucp_request_t *ucp_req = ucs_container_of(req, ucp_request_t, send.uct);
     ucs_status_t status;
 
     ucs_assertv(req->func != NULL, "req=%p", req);
 
-    status = uct_ep_pending_add(uct_ep, req);
+    status = uct_ep_pending_add_prio(uct_ep, req, ucp_req->send.prio);
     if (status != UCS_ERR_BUSY) {
         ucs_assert(status == UCS_OK);
         ucs_trace_data("ep %p: added pending uct request %p to uct_ep %p", ep,
@@ -238,6 +393,9 @@ void ucp_ep_destroy(ucp_ep_h ep)
 
     UCS_ASYNC_BLOCK(&worker->async);
     sglib_hashed_ucp_ep_t_delete(worker->ep_hash, ep);
+    ucp_stream_ep_cleanup(ep);
+    ucp_tag_eager_sync_ep_cleanup(ep);
+    ucp_ep_pending_release_deferred(ep);
     ucp_ep_destory_uct_eps(ep);
     UCS_ASYNC_UNBLOCK(&worker->async);
 
@@ -247,6 +405,9 @@ void ucp_ep_destroy(ucp_ep_h ep)
 void ucp_ep_send_reply(ucp_request_t *req, ucp_ep_op_t optype, int progress)
 {
     ucp_ep_h ep = req->send.ep;
+
+    /* Replies should not wait behind queued data */
+    req->send.prio = UCP_REQUEST_PRIO_CONTROL;
     ucp_ep_add_pending(ep, ep->uct_eps[optype], req, progress);
 }
 
@@ -11,6 +11,7 @@
 #include "ucp_context.h"
 
 #include <uct/api/uct.h>
+#include <ucs/datastruct/queue_types.h>
 #include <ucs/debug/log.h>
 #include <ucs/debug/log.h>
 #include <limits.h>
@@ -60,6 +61,7 @@ typedef struct ucp_ep_config {
     size_t                 max_am_zcopy;     /* Maximal total size of am_zcopy */
     size_t                 max_put_zcopy;    /* Maximal total size of put_zcopy */
     size_t                 max_get_zcopy;    /* Maximal total size of get_zcopy */
+    size_t                 max_am_zcopy_hdr; /* Maximal header size of am_zcopy */
 
     /* Threshold for switching from put_short to put_bcopy */
     size_t                 bcopy_thresh;
@@ -76,6 +78,9 @@ typedef struct ucp_ep_config {
     /* zero-copy threshold for operations which anyways have to wait for remote side */
     size_t                 sync_zcopy_thresh;
 
+    unsigned               index;            /* Index in the worker configuration table */
+    struct ucp_ep_config   *next;            /* Next in configuration hash bucket */
+
 } ucp_ep_config_t;
 
 
@@ -89,12 +94,20 @@ typedef struct ucp_ep {
 
     ucp_rsc_index_t               rma_dst_pdi;   /* Destination protection domain index for RMA */
     ucp_rsc_index_t               amo_dst_pdi;   /* Destination protection domain index for AMO */
-    uint8_t                       cfg_index;     /* Configuration index */
+    uint16_t                      cfg_index;     /* Configuration index */
     uint8_t                       flags;         /* Endpoint flags */
 
     uint64_t                      dest_uuid;     /* Destination worker uuid */
     ucp_ep_h                      next;          /* Next in hash table linked list */
 
+    struct {
+        ucs_queue_head_t          data;          /* Received data descriptors */
+        ucs_queue_head_t          reqs;          /* Posted receive requests */
+        size_t                    offset;        /* Consumed part of first descriptor */
+    } stream;
+
+    struct ucp_reply_batch        *sync_acks;    /* Eager-sync acks not sent yet */
+
 #if ENABLE_DEBUG_DATA
     char                          peer_name[UCP_WORKER_NAME_MAX];
 #endif
@@ -120,6 +133,10 @@ void ucp_ep_add_pending(ucp_ep_h ep, uct_ep_h uct_ep, ucp_request_t *req,
 
 ucs_status_t ucp_ep_pending_req_release(uct_pending_req_t *self);
 
+int ucp_ep_pending_remove(ucp_ep_h ep, ucp_request_t *req);
+
+unsigned ucp_ep_pending_dispatch_deferred(ucp_worker_h worker);
+
 void ucp_ep_send_reply(ucp_request_t *req, ucp_ep_op_t optype, int progress);
 
 int ucp_ep_is_op_primary(ucp_ep_h ep, ucp_ep_op_t optype);
@@ -5,19 +5,28 @@
 */
 
 #include "ucp_mm.h"
+#include "ucp_worker.h"
 
+#include <ucs/datastruct/mpool.inl>
 #include <ucs/debug/log.h>
 #include <ucs/debug/memtrack.h>
+#include <ucs/sys/sys.h>
 
+#include <sys/mman.h>
 #include <string.h>
 #include <inttypes.h>
 
 
+/* Alignment of allocations in the symmetric heap */
+#define UCP_SYM_HEAP_ALIGN  UCS_SYS_CACHE_LINE_SIZE
+
+
 static ucp_mem_t ucp_mem_dummy_handle = {
     .address      = NULL,
     .length       = 0,
     .alloc_method = UCT_ALLOC_METHOD_LAST,
     .alloc_pd     = NULL,
+    .flags        = 0,
     .pd_map       = 0
 };
 
@@ -173,6 +182,164 @@ out:
     return status;
 }
 
+/**
+ * Allocate a range from the symmetric heap. The first range which fits is
+ * used, so processes which make the same sequence of allocations and releases
+ * get the same offsets.
+ */
+static ucs_status_t ucp_sym_heap_alloc(ucp_context_h context, size_t length,
+                                       ucp_mem_h memh)
+{
+    ucp_mem_h heap_memh = context->sym_heap.memh;
+    ucs_list_link_t *insert_pos;
+    size_t alloc_length;
+    ucp_mem_h alloc;
+    void *address;
+
+    if (heap_memh == NULL) {
+        ucs_error("symmetric heap is disabled, set UCX_SYM_HEAP_SIZE to enable it");
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    alloc_length = ucs_align_up_pow2(length, UCP_SYM_HEAP_ALIGN);
+    address      = heap_memh->address;
+    insert_pos   = &context->sym_heap.allocs;
+    ucs_list_for_each(alloc, &context->sym_heap.allocs, list) {
+        if (alloc->address - address >= alloc_length) {
+            insert_pos = &alloc->list;
+            break;
+        }
+        address = alloc->address + ucs_align_up_pow2(alloc->length,
+                                                     UCP_SYM_HEAP_ALIGN);
+    }
+
+    if ((insert_pos == &context->sym_heap.allocs) &&
+        (heap_memh->address + heap_memh->length - address < alloc_length))
+    {
+        ucs_error("not enough space in the symmetric heap for %zu bytes", length);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* The heap is registered as a whole, share its memory handles */
+    memh->address      = address;
+    memh->length       = length;
+    memh->alloc_method = UCT_ALLOC_METHOD_LAST;
+    memh->alloc_pd     = NULL;
+    memh->flags        = UCP_MEM_FLAG_SYM_HEAP;
+    memh->pd_map       = heap_memh->pd_map;
+    memcpy(memh->uct, heap_memh->uct,
+           ucs_count_one_bits(heap_memh->pd_map) * sizeof(memh->uct[0]));
+    ucs_list_insert_before(insert_pos, &memh->list);
+    return UCS_OK;
+}
+
+/**
+ * Reserve the symmetric heap at the configured address and register it.
+ */
+static ucs_status_t ucp_sym_heap_reserve(ucp_context_h context, size_t length,
+                                         ucp_mem_h memh)
+{
+    void *address = (void*)context->config.sym_heap_address;
+    ucs_status_t status;
+    void *ptr;
+
+    /* Without MAP_FIXED the address is only a hint, so an existing mapping
+     * is never replaced */
+    length = ucs_align_up_pow2(length, ucs_get_page_size());
+    ptr    = ucs_mmap(address, length, PROT_READ|PROT_WRITE,
+                      MAP_PRIVATE|MAP_ANON|MAP_NORESERVE, -1, 0, "ucp_sym_heap");
+    if (ptr == MAP_FAILED) {
+        ucs_error("failed to reserve %zu bytes for symmetric heap: %m", length);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    if (ptr != address) {
+        ucs_error("failed to reserve symmetric heap at %p: the range is in use",
+                  address);
+        status = UCS_ERR_BUSY;
+        goto err_munmap;
+    }
+
+    memh->address      = ptr;
+    memh->length       = length;
+    memh->alloc_method = UCT_ALLOC_METHOD_MMAP;
+    memh->alloc_pd     = NULL;
+    status = ucp_memh_reg_pds(context, memh, UCT_INVALID_MEM_HANDLE);
+    if (status != UCS_OK) {
+        goto err_munmap;
+    }
+
+    return UCS_OK;
+
+err_munmap:
+    ucs_munmap(ptr, length);
+    return status;
+}
+
+ucs_status_t ucp_sym_heap_init(ucp_context_h context)
+{
+    size_t length = context->config.ext.sym_heap_size;
+    ucs_status_t status;
+    ucp_mem_h memh;
+
+    ucs_list_head_init(&context->sym_heap.allocs);
+    context->sym_heap.memh = NULL;
+
+    if (length == 0) {
+        return UCS_OK;
+    }
+
+    memh = ucs_malloc(sizeof(*memh) + context->num_pds * sizeof(memh->uct[0]),
+                      "ucp_sym_heap_memh");
+    if (memh == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    memh->flags = 0;
+    if (context->config.sym_heap_address == 0) {
+        status = ucp_mem_alloc(context, length, "symmetric heap", memh);
+    } else {
+        status = ucp_sym_heap_reserve(context, length, memh);
+    }
+    if (status != UCS_OK) {
+        ucs_free(memh);
+        return status;
+    }
+
+    ucs_debug("symmetric heap at %p length %zu pd_map 0x%"PRIx64,
+              memh->address, memh->length, memh->pd_map);
+    context->sym_heap.memh = memh;
+    return UCS_OK;
+}
+
+void ucp_sym_heap_cleanup(ucp_context_h context)
+{
+    if (context->sym_heap.memh == NULL) {
+        return;
+    }
+
+    if (!ucs_list_is_empty(&context->sym_heap.allocs)) {
+        ucs_warn("%lu symmetric heap allocations were not unmapped",
+                 ucs_list_length(&context->sym_heap.allocs));
+    }
+
+    ucp_mem_unmap(context, context->sym_heap.memh);
+    context->sym_heap.memh = NULL;
+}
+
+ucs_status_t ucp_mem_sym_heap_query(ucp_context_h context, void **address_p,
+                                    size_t *length_p, ucp_mem_h *memh_p)
+{
+    if (context->sym_heap.memh == NULL) {
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    *address_p = context->sym_heap.memh->address;
+    *length_p  = context->sym_heap.memh->length;
+    *memh_p    = context->sym_heap.memh;
+    return UCS_OK;
+}
+
 
 ucs_status_t ucp_mem_map(ucp_context_h context, void **address_p, size_t length,
                          unsigned flags, ucp_mem_h *memh_p)
@@ -195,7 +362,21 @@ ucs_status_t ucp_mem_map(ucp_context_h context, void **address_p, size_t length,
         goto err;
     }
 
-    if (*address_p == NULL) {
+    memh->flags = 0;
+    if (flags & UCP_MEM_MAP_SYMMETRIC) {
+        if (*address_p != NULL) {
+            ucs_error("symmetric memory must be allocated by ucp_mem_map");
+            status = UCS_ERR_INVALID_PARAM;
+            goto err_free_memh;
+        }
+
+        status = ucp_sym_heap_alloc(context, length, memh);
+        if (status != UCS_OK) {
+            goto err_free_memh;
+        }
+
+        *address_p = memh->address;
+    } else if (*address_p == NULL) {
         status = ucp_mem_alloc(context, length, "user allocation", memh);
         if (status != UCS_OK) {
             goto err_free_memh;
@@ -215,6 +396,7 @@ ucs_status_t ucp_mem_map(ucp_context_h context, void **address_p, size_t length,
     }
 
     ucs_debug("%s buffer %p length %zu memh %p pd_map 0x%"PRIx64,
+              (memh->flags & UCP_MEM_FLAG_SYM_HEAP) ? "symmetric" :
               (memh->alloc_method == UCT_ALLOC_METHOD_LAST) ? "mapped" : "allocated",
               memh->address, memh->length, memh, memh->pd_map);
     *memh_p = memh;
@@ -237,6 +419,13 @@ ucs_status_t ucp_mem_unmap(ucp_context_h context, ucp_mem_h memh)
         return UCS_OK;
     }
 
+    if (memh->flags & UCP_MEM_FLAG_SYM_HEAP) {
+        /* The heap stays registered, only release the range */
+        ucs_list_del(&memh->list);
+        ucs_free(memh);
+        return UCS_OK;
+    }
+
     /* Unregister from all protection domains */
     status = ucp_memh_dereg_pds(context, memh, &alloc_pd_memh);
     if (status != UCS_OK) {
@@ -260,3 +449,223 @@ ucs_status_t ucp_mem_unmap(ucp_context_h context, ucp_mem_h memh)
     ucs_free(memh);
     return UCS_OK;
 }
+
+
+/**
+ * Private data of a bounce buffers memory pool.
+ */
+typedef struct ucp_bounce_mp_priv {
+    uct_pd_h                      pd;       /* PD to register the buffers with */
+    int                           hugetlb;  /* Try to use huge pages */
+} ucp_bounce_mp_priv_t;
+
+
+/**
+ * Header of a bounce buffers chunk.
+ */
+typedef struct ucp_bounce_chunk_hdr {
+    uct_mem_h                     memh;     /* Registration of the whole chunk */
+} ucp_bounce_chunk_hdr_t;
+
+
+static ucs_status_t ucp_bounce_chunk_alloc(ucs_mpool_t *mp, size_t *size_p,
+                                           void **chunk_p)
+{
+    ucp_bounce_mp_priv_t *priv = ucs_mpool_priv(mp);
+    ucp_bounce_chunk_hdr_t *hdr;
+    ucs_status_t status;
+    size_t size;
+    void *ptr;
+
+    size = sizeof(*hdr) + *size_p;
+    if (priv->hugetlb) {
+        status = ucs_mpool_hugetlb_malloc(mp, &size, &ptr);
+    } else {
+        status = ucs_mpool_chunk_malloc(mp, &size, &ptr);
+    }
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    hdr    = ptr;
+    status = uct_pd_mem_reg(priv->pd, hdr + 1, size - sizeof(*hdr), &hdr->memh);
+    if (status != UCS_OK) {
+        ucs_error("failed to register bounce buffers: %s",
+                  ucs_status_string(status));
+        if (priv->hugetlb) {
+            ucs_mpool_hugetlb_free(mp, ptr);
+        } else {
+            ucs_mpool_chunk_free(mp, ptr);
+        }
+        return status;
+    }
+
+    *size_p  = size - sizeof(*hdr);
+    *chunk_p = hdr + 1;
+    return UCS_OK;
+}
+
+static void ucp_bounce_chunk_release(ucs_mpool_t *mp, void *chunk)
+{
+    ucp_bounce_mp_priv_t *priv = ucs_mpool_priv(mp);
+    ucp_bounce_chunk_hdr_t *hdr = chunk - sizeof(*hdr);
+
+    uct_pd_mem_dereg(priv->pd, hdr->memh);
+    if (priv->hugetlb) {
+        ucs_mpool_hugetlb_free(mp, hdr);
+    } else {
+        ucs_mpool_chunk_free(mp, hdr);
+    }
+}
+
+static void ucp_bounce_obj_init(ucs_mpool_t *mp, void *obj, void *chunk)
+{
+    ucp_bounce_chunk_hdr_t *hdr = chunk - sizeof(*hdr);
+    ucp_bounce_desc_t *desc = obj;
+
+    desc->memh = hdr->memh;
+}
+
+static ucs_mpool_ops_t ucp_bounce_mpool_ops = {
+    .chunk_alloc   = ucp_bounce_chunk_alloc,
+    .chunk_release = ucp_bounce_chunk_release,
+    .obj_init      = ucp_bounce_obj_init,
+    .obj_cleanup   = NULL
+};
+
+static ucs_status_t ucp_worker_reg_mpool_init(ucp_worker_h worker,
+                                              ucs_mpool_t *mp,
+                                              ucp_rsc_index_t pd_index,
+                                              size_t buf_size, unsigned grow,
+                                              unsigned max_bufs,
+                                              const char *name)
+{
+    ucp_context_h context = worker->context;
+    ucp_bounce_mp_priv_t *priv;
+    ucs_status_t status;
+
+    status = ucs_mpool_init(mp, sizeof(ucp_bounce_mp_priv_t),
+                            sizeof(ucp_bounce_desc_t) + buf_size,
+                            sizeof(ucp_bounce_desc_t), UCS_SYS_CACHE_LINE_SIZE,
+                            grow, max_bufs, &ucp_bounce_mpool_ops, name);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    priv          = ucs_mpool_priv(mp);
+    priv->pd      = context->pds[pd_index];
+    priv->hugetlb = context->config.ext.bounce_hugetlb;
+    return UCS_OK;
+}
+
+ucs_status_t ucp_worker_bounce_init(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+
+    /* The pools are created on first use, so a worker does not register
+     * buffers with PDs it never sends zcopy through */
+    worker->bounce_pd_map  = 0;
+    worker->staging_pd_map = 0;
+    worker->bounce_mps     = ucs_calloc(2 * context->num_pds,
+                                        sizeof(*worker->bounce_mps),
+                                        "ucp_bounce_mps");
+    if (worker->bounce_mps == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    worker->staging_mps = worker->bounce_mps + context->num_pds;
+    return UCS_OK;
+}
+
+void ucp_worker_bounce_cleanup(ucp_worker_h worker)
+{
+    ucp_rsc_index_t pd_index;
+
+    for (pd_index = 0; pd_index < worker->context->num_pds; ++pd_index) {
+        if (worker->bounce_pd_map & UCS_BIT(pd_index)) {
+            ucs_mpool_cleanup(&worker->bounce_mps[pd_index], 1);
+        }
+        if (worker->staging_pd_map & UCS_BIT(pd_index)) {
+            ucs_mpool_cleanup(&worker->staging_mps[pd_index], 1);
+        }
+    }
+    worker->bounce_pd_map  = 0;
+    worker->staging_pd_map = 0;
+    ucs_free(worker->bounce_mps);
+}
+
+ucp_bounce_desc_t *ucp_worker_staging_get(ucp_worker_h worker,
+                                          ucp_rsc_index_t pd_index)
+{
+    ucp_context_h context = worker->context;
+    ucs_status_t status;
+
+    if (ucs_unlikely(!(worker->staging_pd_map & UCS_BIT(pd_index)))) {
+        /* Every pipeline takes up to 'depth' buffers, so grow by that much */
+        status = ucp_worker_reg_mpool_init(worker,
+                                           &worker->staging_mps[pd_index],
+                                           pd_index,
+                                           context->config.ext.generic_pipeline_frag_size,
+                                           context->config.ext.generic_pipeline_depth,
+                                           UINT_MAX, "ucp_staging_bufs");
+        if (status != UCS_OK) {
+            return NULL;
+        }
+
+        worker->staging_pd_map |= UCS_BIT(pd_index);
+    }
+
+    return ucs_mpool_get(&worker->staging_mps[pd_index]);
+}
+
+ucp_bounce_desc_t *ucp_worker_bounce_get(ucp_worker_h worker,
+                                         ucp_rsc_index_t pd_index,
+                                         const void *buffer, size_t length)
+{
+    ucp_context_h context = worker->context;
+    uintptr_t *history;
+    ucp_bounce_desc_t *desc;
+    ucs_status_t status;
+
+    if ((length > context->config.ext.bounce_size) ||
+        (context->config.ext.bounce_max_bufs == 0))
+    {
+        return NULL;
+    }
+
+    /* A buffer which was sent recently is likely to be sent again, so it is
+     * worth registering it - the registration cache would hit next time. */
+    history = &worker->zcopy_history[((uintptr_t)buffer / UCS_SYS_CACHE_LINE_SIZE) %
+                                     UCP_WORKER_ZCOPY_HISTORY_SIZE];
+    if (*history == (uintptr_t)buffer) {
+        return NULL;
+    }
+    *history = (uintptr_t)buffer;
+
+    if (ucs_unlikely(!(worker->bounce_pd_map & UCS_BIT(pd_index)))) {
+        /* One pool per PD, shared by all endpoints which send through it */
+        status = ucp_worker_reg_mpool_init(worker,
+                                           &worker->bounce_mps[pd_index],
+                                           pd_index,
+                                           context->config.ext.bounce_size,
+                                           ucs_min(16, context->config.ext.bounce_max_bufs),
+                                           context->config.ext.bounce_max_bufs,
+                                           "ucp_bounce_bufs");
+        if (status != UCS_OK) {
+            return NULL;
+        }
+
+        worker->bounce_pd_map |= UCS_BIT(pd_index);
+    }
+
+    desc = ucs_mpool_get_inline(&worker->bounce_mps[pd_index]);
+    if (desc == NULL) {
+        /* All bounce buffers are in use */
+        return NULL;
+    }
+
+    ucs_trace_data("copy %zu bytes from %p to bounce buffer %p", length,
+                   buffer, desc + 1);
+    memcpy(desc + 1, buffer, length);
+    return desc;
+}
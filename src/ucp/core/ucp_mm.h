@@ -12,6 +12,7 @@
 #include <ucp/core/ucp_ep.h>
 #include <uct/api/uct.h>
 #include <ucs/arch/bitops.h>
+#include <ucs/datastruct/list.h>
 #include <ucs/debug/log.h>
 
 #include <inttypes.h>
@@ -29,6 +30,15 @@ typedef struct ucp_rkey {
 } ucp_rkey_t;
 
 
+/**
+ * Memory handle flags.
+ */
+enum {
+    UCP_MEM_FLAG_SYM_HEAP = UCS_BIT(0)  /* Allocated from the symmetric heap, the
+                                           UCT handles belong to the heap */
+};
+
+
 /**
  * Memory handle.
  * Contains general information, and a list of UCT handles.
@@ -40,11 +50,49 @@ typedef struct ucp_mem {
     size_t                        length;       /* Region length */
     uct_alloc_method_t            alloc_method; /* Method used to allocate the memory */
     uct_pd_h                      alloc_pd;     /* PD used to allocated the memory */
+    unsigned                      flags;        /* Memory handle flags */
+    ucs_list_link_t               list;         /* Entry in symmetric heap allocations */
     uint64_t                      pd_map;       /* Which PDs have valid memory handles */
     uct_mem_h                     uct[0];       /* Valid memory handles, as popcount(pd_map) */
 } ucp_mem_t;
 
 
+/**
+ * Registered bounce buffer, used to send unregistered user memory with zero
+ * copy. The data follows the descriptor.
+ */
+typedef struct ucp_bounce_desc {
+    uct_mem_h                     memh;         /* Registration of the buffer */
+} ucp_bounce_desc_t;
+
+
+ucs_status_t ucp_sym_heap_init(ucp_context_h context);
+
+void ucp_sym_heap_cleanup(ucp_context_h context);
+
+ucs_status_t ucp_worker_bounce_init(ucp_worker_h worker);
+
+void ucp_worker_bounce_cleanup(ucp_worker_h worker);
+
+/*
+ * Copy the buffer to a registered bounce buffer of the given PD, if this is
+ * expected to be cheaper than registering it. The pool of the PD is created on
+ * first use. Returns NULL if the buffer should be registered instead. The
+ * bounce buffer is released with ucs_mpool_put().
+ */
+ucp_bounce_desc_t *ucp_worker_bounce_get(ucp_worker_h worker,
+                                         ucp_rsc_index_t pd_index,
+                                         const void *buffer, size_t length);
+
+/*
+ * Get a registered staging buffer of the given PD, of GENERIC_PIPELINE_FRAG_SIZE
+ * bytes. The buffers are registered once, and shared by all requests of the
+ * worker. Returns NULL if there is no buffer. Released with ucs_mpool_put().
+ */
+ucp_bounce_desc_t *ucp_worker_staging_get(ucp_worker_h worker,
+                                          ucp_rsc_index_t pd_index);
+
+
 static inline uct_rkey_t ucp_lookup_uct_rkey(ucp_ep_h ep, ucp_rkey_h rkey,
                                              ucp_rsc_index_t dst_pd_index)
 {
@@ -4,10 +4,12 @@
  * See file LICENSE for terms.
  */
 
-#include "ucp_request.h"
+#include "ucp_request.inl"
 #include "ucp_context.h"
+#include "ucp_ep.h"
 #include "ucp_worker.h"
 
+#include <ucp/proto/proto.h>
 #include <ucp/tag/match.h>
 #include <ucs/datastruct/mpool.inl>
 #include <ucs/debug/log.h>
@@ -19,32 +21,216 @@ int ucp_request_is_completed(void *request)
     return !!(req->flags & UCP_REQUEST_FLAG_COMPLETED);
 }
 
+size_t ucp_request_size(ucp_context_h context)
+{
+    return sizeof(ucp_request_t) + context->config.request.size;
+}
+
 void ucp_request_release(void *request)
 {
     ucp_request_t *req = (ucp_request_t*)request - 1;
 
     ucs_trace_data("release request %p (%p) flags: 0x%x", req, req + 1, req->flags);
 
+    if (req->flags & UCP_REQUEST_FLAG_EXTERNAL) {
+        /* Memory is owned by the user, nothing to return to the pool */
+        return;
+    }
+
     if ((req->flags |= UCP_REQUEST_FLAG_RELEASED) & UCP_REQUEST_FLAG_COMPLETED) {
         ucs_trace_data("put %p to mpool", req);
         ucs_mpool_put_inline(req);
     }
 }
 
-void ucp_request_cancel(ucp_worker_h worker, void *request)
+/*
+ * Withdraw a send which is waiting in a pending queue and did not start
+ * transmission yet, and release the resources it acquired when it was started.
+ */
+static int ucp_request_send_cancel(ucp_request_t *req, ucs_status_t status)
 {
-    ucp_request_t *req = (ucp_request_t*)request - 1;
+    if (req->send.state.offset != 0) {
+        return 0; /* Some fragments were already sent */
+    }
 
+    if (!ucp_ep_pending_remove(req->send.ep, req)) {
+        return 0;
+    }
+
+    switch (req->send.datatype & UCP_DATATYPE_CLASS_MASK) {
+    case UCP_DATATYPE_CONTIG:
+        if (req->flags & UCP_REQUEST_FLAG_SEND_REG) {
+            /* Only active message protocols register the send buffer */
+            ucp_request_send_buffer_dereg(req, UCP_EP_OP_AM);
+        }
+        break;
+    case UCP_DATATYPE_GENERIC:
+        if (req->send.state.dt.generic.pipeline != NULL) {
+            ucp_proto_pipeline_cleanup(req);
+        }
+        ucp_request_generic_dt_finish(req);
+        break;
+    }
+
+    ucp_request_complete(req, req->cb.send, status);
+    return 1;
+}
+
+static int ucp_request_try_cancel(ucp_worker_h worker, ucp_request_t *req,
+                                  ucs_status_t status)
+{
     if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
-        return;
+        return 0;
     }
 
     if (req->flags & UCP_REQUEST_FLAG_EXPECTED) {
         ucp_tag_cancel_expected(worker->context, req);
-        ucp_request_complete(req, req->cb.tag_recv, UCS_ERR_CANCELED, NULL);
+        ucp_request_complete(req, req->cb.tag_recv, status, NULL);
+        return 1;
+    }
+
+    if (req->flags & UCP_REQUEST_FLAG_SEND) {
+        return ucp_request_send_cancel(req, status);
+    }
+
+    return 0;
+}
+
+void ucp_request_cancel(ucp_worker_h worker, void *request)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    if (!ucp_request_try_cancel(worker, req, UCS_ERR_CANCELED)) {
+        ucs_trace_req("request %p could not be canceled", req);
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+}
+
+ucs_status_t ucp_request_ext_get(ucp_worker_h worker, ucp_request_t *req,
+                                 uint16_t flag)
+{
+    ucp_request_ext_t *ext;
+
+    if (!(req->flags & UCP_REQUEST_EXT_FLAGS)) {
+        ext = ucs_mpool_get_inline(&worker->req_ext_mp);
+        if (ext == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        ext->req    = req;
+        ext->worker = worker;
+        req->ext    = ext;
+    }
+
+    req->flags |= flag;
+    return UCS_OK;
+}
+
+void ucp_request_ext_put(ucp_request_t *req, uint16_t flag)
+{
+    req->flags &= ~flag;
+    if (!(req->flags & UCP_REQUEST_EXT_FLAGS)) {
+        ucs_mpool_put_inline(req->ext);
     }
 }
 
+static void ucp_request_deadline_expired(ucs_wtimer_t *self)
+{
+    ucp_request_ext_t *ext = ucs_container_of(self, ucp_request_ext_t, timer);
+    ucp_request_t *req     = ext->req;
+    ucp_worker_h worker    = ext->worker;
+    ucs_twheel_t *twheel   = &worker->deadline.twheel;
+    ucs_time_t now         = ucs_twheel_get_time(twheel);
+
+    /* The timer wheel has a limited range, so a far deadline may need several
+     * rounds */
+    if (ext->deadline > now + twheel->res) {
+        ucs_wtimer_add(twheel, &ext->timer, ext->deadline - now);
+        return;
+    }
+
+    --worker->deadline.count;
+    ucp_request_ext_put(req, UCP_REQUEST_FLAG_DEADLINE);
+
+    ucs_trace_req("request %p: deadline expired", req);
+    if (!ucp_request_try_cancel(worker, req, UCS_ERR_TIMED_OUT)) {
+        ucs_debug("request %p: deadline expired during transmission", req);
+    }
+}
+
+ucs_status_t ucp_request_set_timeout(ucp_worker_h worker, void *request,
+                                     double timeout)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+    ucs_twheel_t *twheel = &worker->deadline.twheel;
+    ucs_time_t now, delta;
+    ucs_status_t status;
+
+    if (timeout < 0) {
+        ucs_error("invalid request timeout: %f", timeout);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    /* The request may complete, and the wheel be swept, from async progress */
+    UCS_ASYNC_BLOCK(&worker->async);
+
+    if (req->flags & UCP_REQUEST_FLAG_COMPLETED) {
+        status = UCS_OK;
+        goto out;
+    }
+
+    if (req->flags & UCP_REQUEST_FLAG_DEADLINE) {
+        ucs_wtimer_remove(&req->ext->timer);
+    } else {
+        status = ucp_request_ext_get(worker, req, UCP_REQUEST_FLAG_DEADLINE);
+        if (status != UCS_OK) {
+            goto out;
+        }
+
+        ucs_wtimer_init(&req->ext->timer, ucp_request_deadline_expired);
+        ++worker->deadline.count;
+    }
+
+    /* Bring the wheel up to date, it's not swept while there are no timers */
+    now   = ucs_get_time();
+    delta = ucs_time_from_sec(timeout);
+    ucs_twheel_sweep(twheel, now);
+
+    req->ext->deadline = now + delta;
+    ucs_wtimer_add(twheel, &req->ext->timer, ucs_max(delta, twheel->res));
+    ucs_trace_req("request %p: deadline in %.3f ms", req, timeout * 1e3);
+    status = UCS_OK;
+
+out:
+    UCS_ASYNC_UNBLOCK(&worker->async);
+    return status;
+}
+
+void ucp_request_deadline_remove(ucp_request_t *req)
+{
+    ucs_wtimer_remove(&req->ext->timer);
+    --req->ext->worker->deadline.count;
+    ucp_request_ext_put(req, UCP_REQUEST_FLAG_DEADLINE);
+}
+
+void ucp_request_cq_send_callback(void *request, ucs_status_t status)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+
+    ucp_worker_cq_push(req->ext->worker, req->ext->user_data, status, NULL);
+    ucp_request_ext_put(req, UCP_REQUEST_FLAG_CQ);
+}
+
+void ucp_request_cq_recv_callback(void *request, ucs_status_t status,
+                                  ucp_tag_recv_info_t *info)
+{
+    ucp_request_t *req = (ucp_request_t*)request - 1;
+
+    ucp_worker_cq_push(req->ext->worker, req->ext->user_data, status, info);
+    ucp_request_ext_put(req, UCP_REQUEST_FLAG_CQ);
+}
+
 static void ucp_worker_request_init_proxy(ucs_mpool_t *mp, void *obj, void *chunk)
 {
     ucp_worker_h worker = ucs_container_of(mp, ucp_worker_t, req_mp);
@@ -74,3 +260,9 @@ ucs_mpool_ops_t ucp_request_mpool_ops = {
     .obj_cleanup   = ucp_worker_request_fini_proxy
 };
 
+ucs_mpool_ops_t ucp_request_ext_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
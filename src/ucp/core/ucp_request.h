@@ -15,6 +15,7 @@
 #include <uct/api/uct.h>
 #include <ucs/datastruct/mpool.h>
 #include <ucs/datastruct/queue_types.h>
+#include <ucs/time/timer_wheel.h>
 #include <ucp/wireup/wireup.h>
 
 
@@ -28,6 +29,25 @@ enum {
     UCP_REQUEST_FLAG_EXPECTED             = UCS_BIT(3),
     UCP_REQUEST_FLAG_LOCAL_COMPLETED      = UCS_BIT(4),
     UCP_REQUEST_FLAG_REMOTE_COMPLETED     = UCS_BIT(5),
+    UCP_REQUEST_FLAG_EXTERNAL             = UCS_BIT(6),  /* Memory provided by the user */
+    UCP_REQUEST_FLAG_SEND                 = UCS_BIT(7),  /* Send request */
+    UCP_REQUEST_FLAG_SEND_REG             = UCS_BIT(8),  /* Send buffer is registered */
+    UCP_REQUEST_FLAG_DEADLINE             = UCS_BIT(9),  /* Deadline timer is set */
+    UCP_REQUEST_FLAG_CQ                   = UCS_BIT(10), /* Completes to the worker cq */
+};
+
+
+/* Flags which need the request extension */
+#define UCP_REQUEST_EXT_FLAGS  (UCP_REQUEST_FLAG_DEADLINE | UCP_REQUEST_FLAG_CQ)
+
+
+/**
+ * Send priority classes, mapped to transport pending queue priorities
+ */
+enum {
+    UCP_REQUEST_PRIO_CONTROL = UCT_PENDING_PRIO_HIGH,   /* Protocol messages: wireup, acks */
+    UCP_REQUEST_PRIO_LATENCY = UCT_PENDING_PRIO_MEDIUM, /* UCP_SEND_PRIO_LATENCY */
+    UCP_REQUEST_PRIO_BULK    = UCT_PENDING_PRIO_LOW     /* UCP_SEND_PRIO_BULK, the default */
 };
 
 
@@ -40,10 +60,12 @@ enum {
     UCP_RECV_DESC_FLAG_EAGER = UCS_BIT(2),
     UCP_RECV_DESC_FLAG_SYNC  = UCS_BIT(3),
     UCP_RECV_DESC_FLAG_RNDV  = UCS_BIT(4),
+    UCP_RECV_DESC_FLAG_MALLOC = UCS_BIT(5),  /* Allocated by UCP, not by UCT */
 };
 
 
 /*
+ * - Stop the deadline timer, if set.
  * - Mark the request as completed
  * - If it has a callback - call it.
  * - Otherwise - the request might be released - if so, return it to mpool.
@@ -52,6 +74,9 @@ enum {
     { \
         ucs_trace_data("completing request %p (%p) flags 0x%x", (_req), \
                        (_req) + 1, (_req)->flags); \
+        if (ucs_unlikely((_req)->flags & UCP_REQUEST_FLAG_DEADLINE)) { \
+            ucp_request_deadline_remove(_req); \
+        } \
         (_cb)((_req) + 1, ## __VA_ARGS__); \
         if (((_req)->flags |= UCP_REQUEST_FLAG_COMPLETED) & UCP_REQUEST_FLAG_RELEASED) { \
             ucs_mpool_put(_req); \
@@ -63,14 +88,30 @@ typedef struct ucp_send_state {
     union {
         struct {
             uct_mem_h             memh;
+            struct ucp_bounce_desc *bounce; /* Registered copy of the data */
         } contig;
         struct {
             void                  *state;
+            struct ucp_proto_pipeline *pipeline; /* Staging buffers for zcopy */
         } generic;
     } dt;
 } ucp_frag_state_t;
 
 
+/**
+ * Rarely used request state, taken from the worker only by requests which
+ * complete to the worker cq or have a deadline, so it does not grow every
+ * request. Released when the last of UCP_REQUEST_EXT_FLAGS is cleared.
+ */
+typedef struct ucp_request_ext {
+    ucp_request_t                 *req;      /* Request which owns the state */
+    ucp_worker_h                  worker;    /* Worker of the cq and the timer */
+    void                          *user_data; /* Returned in the completion entry */
+    ucs_wtimer_t                  timer;     /* Expires the request */
+    ucs_time_t                    deadline;  /* When the request expires */
+} ucp_request_ext_t;
+
+
 /**
  * Request in progress.
  */
@@ -80,17 +121,29 @@ struct ucp_request {
     union {
         ucp_send_callback_t       send;
         ucp_tag_recv_callback_t   tag_recv;
+        ucp_stream_recv_callback_t stream_recv;
     } cb;
 
+    ucp_request_ext_t             *ext;    /* Valid if one of
+                                              UCP_REQUEST_EXT_FLAGS is set */
+
     union {
         struct {
             ucp_ep_h              ep;
             const void            *buffer;  /* Send buffer */
             ucp_datatype_t        datatype; /* Send type */
+            uint8_t               prio;     /* Pending priority, UCP_REQUEST_PRIO_xx */
 
             union {
                 ucp_tag_t         tag;      /* Tagged send */
 
+                struct {
+                    uint16_t      am_id;          /* User active message id */
+                    const void    *header;        /* User header, owned by the
+                                                     caller until completion */
+                    size_t        header_length;  /* User header length */
+                } am;
+
                 ucp_wireup_msg_t  wireup;
 
                 struct {
@@ -99,7 +152,7 @@ struct ucp_request {
                 } rma;
 
                 struct {
-                    uintptr_t     remote_request;
+                    struct ucp_reply_batch *batch; /* Requests to reply to */
                     uint8_t       am_id;
                     ucs_status_t  status;
                 } proto;
@@ -121,10 +174,20 @@ struct ucp_request {
             void                  *buffer;  /* Buffer to receive data to */
             size_t                count;    /* Receive count */
             ucp_datatype_t        datatype; /* Receive type */
-            ucp_tag_t             tag;      /* Expected tag */
-            ucp_tag_t             tag_mask; /* Expected tag mask */
-            ucp_tag_recv_info_t   info;     /* Completion info to fill */
             ucp_frag_state_t      state;
+
+            union {
+                struct {
+                    ucp_tag_t             tag;      /* Expected tag */
+                    ucp_tag_t             tag_mask; /* Expected tag mask */
+                    ucp_tag_recv_info_t   info;     /* Completion info to fill */
+                };
+
+                struct {
+                    size_t                length;   /* Receive buffer size */
+                    unsigned              flags;    /* Stream receive flags */
+                } stream;
+            };
         } recv;
     };
 };
@@ -142,5 +205,24 @@ typedef struct ucp_recv_desc {
 
 
 extern ucs_mpool_ops_t ucp_request_mpool_ops;
+extern ucs_mpool_ops_t ucp_request_ext_mpool_ops;
+
+
+/*
+ * Set one of UCP_REQUEST_EXT_FLAGS on the request, and take the extension
+ * from the worker if it has none yet.
+ */
+ucs_status_t ucp_request_ext_get(ucp_worker_h worker, ucp_request_t *req,
+                                 uint16_t flag);
+
+void ucp_request_ext_put(ucp_request_t *req, uint16_t flag);
+
+
+void ucp_request_deadline_remove(ucp_request_t *req);
+
+void ucp_request_cq_send_callback(void *request, ucs_status_t status);
+
+void ucp_request_cq_recv_callback(void *request, ucs_status_t status,
+                                  ucp_tag_recv_info_t *info);
 
 #endif
@@ -7,6 +7,7 @@
 #include "ucp_request.h"
 
 #include <ucp/core/ucp_worker.h>
+#include <ucp/core/ucp_mm.h>
 #include <ucp/dt/dt_generic.h>
 
 
@@ -28,21 +29,44 @@ ucp_request_generic_dt_finish(ucp_request_t *req)
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_request_send_buffer_reg(ucp_request_t *req, ucp_ep_op_t optype)
 {
-    uct_pd_h uct_pd = ucp_ep_pd(req->send.ep, optype);
+    ucp_ep_h ep = req->send.ep;
+    ucp_bounce_desc_t *bounce;
     ucs_status_t status;
 
-    status = uct_pd_mem_reg(uct_pd, (void*)req->send.buffer, req->send.length,
-                            &req->send.state.dt.contig.memh);
+    /* Copying a one-shot buffer may be cheaper than registering it. The user
+     * buffer is kept in the request, zcopy sends from the bounce buffer. */
+    bounce = ucp_worker_bounce_get(ep->worker, ucp_ep_pd_index(ep, optype),
+                                   req->send.buffer, req->send.length);
+    req->send.state.dt.contig.bounce = bounce;
+    if (bounce != NULL) {
+        req->send.state.dt.contig.memh = bounce->memh;
+        req->flags                    |= UCP_REQUEST_FLAG_SEND_REG;
+        return UCS_OK;
+    }
+
+    status = uct_pd_mem_reg(ucp_ep_pd(ep, optype), (void*)req->send.buffer,
+                            req->send.length, &req->send.state.dt.contig.memh);
     if (status != UCS_OK) {
         ucs_error("failed to register user buffer: %s",
                   ucs_status_string(status));
+        return status;
     }
-    return status;
+
+    req->flags |= UCP_REQUEST_FLAG_SEND_REG;
+    return UCS_OK;
 }
 
 static UCS_F_ALWAYS_INLINE void
 ucp_request_send_buffer_dereg(ucp_request_t *req, ucp_ep_op_t optype)
 {
-    uct_pd_h uct_pd = ucp_ep_pd(req->send.ep, optype);
+    uct_pd_h uct_pd;
+
+    req->flags &= ~UCP_REQUEST_FLAG_SEND_REG;
+    if (req->send.state.dt.contig.bounce != NULL) {
+        ucs_mpool_put(req->send.state.dt.contig.bounce);
+        return;
+    }
+
+    uct_pd = ucp_ep_pd(req->send.ep, optype);
     (void)uct_pd_mem_dereg(uct_pd, req->send.state.dt.contig.memh);
 }
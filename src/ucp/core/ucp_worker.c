@@ -5,11 +5,35 @@
 */
 
 #include "ucp_worker.h"
+#include "ucp_mm.h"
 
 #include <ucp/wireup/address.h>
 #include <ucp/wireup/stub_ep.h>
 #include <ucp/tag/eager.h>
+#include <ucp/am/am.h>
 #include <ucs/datastruct/mpool.inl>
+#include <ucs/datastruct/queue.h>
+
+
+#if ENABLE_STATS
+static ucs_stats_class_t ucp_worker_stats_class = {
+    .name           = "ucp_worker",
+    .num_counters   = UCP_WORKER_STAT_LAST,
+    .counter_names  = {
+        [UCP_WORKER_STAT_WAIT_SPIN]  = "wait_spin",
+        [UCP_WORKER_STAT_WAIT_SLEEP] = "wait_sleep",
+        [UCP_WORKER_STAT_IFACE_OPEN] = "iface_open",
+        [UCP_WORKER_STAT_IFACE_TIME] = "iface_time"
+    }
+};
+#endif
+
+static ucs_mpool_ops_t ucp_reply_batch_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
 
 
 static void ucp_worker_close_ifaces(ucp_worker_h worker)
@@ -78,6 +102,10 @@ static void ucp_worker_remove_am_handlers(ucp_worker_h worker)
 
     ucs_debug("worker %p: remove active message handlers", worker);
     for (tl_id = 0; tl_id < context->num_tls; ++tl_id) {
+        if (worker->ifaces[tl_id] == NULL) {
+            continue;
+        }
+
         for (am_id = 0; am_id < UCP_AM_ID_LAST; ++am_id) {
             if (context->config.features & ucp_am_handlers[am_id].features) {
                 (void)uct_iface_set_am_handler(worker->ifaces[tl_id], am_id,
@@ -102,11 +130,12 @@ static void ucp_worker_am_tracer(void *arg, uct_am_trace_type_t type,
 }
 
 static ucs_status_t ucp_worker_wakeup_context_init(ucp_worker_wakeup_t *wakeup,
-                                                   ucp_rsc_index_t num_tls)
+                                                   ucp_context_h context)
 {
     ucs_status_t status;
 
-    wakeup->iface_wakeups = ucs_calloc(num_tls, sizeof(*wakeup->iface_wakeups),
+    wakeup->iface_wakeups = ucs_calloc(context->num_tls,
+                                       sizeof(*wakeup->iface_wakeups),
                                        "ucp iface_wakeups");
     if (wakeup->iface_wakeups == NULL) {
         return UCS_ERR_NO_MEMORY;
@@ -131,6 +160,9 @@ static ucs_status_t ucp_worker_wakeup_context_init(ucp_worker_wakeup_t *wakeup,
     }
 
     wakeup->wakeup_efd = -1;
+    wakeup->spin_max   = ucs_time_from_sec(context->config.ext.wakeup_spin_time);
+    wakeup->spin_time  = wakeup->spin_max;
+    wakeup->avg_wait   = 0;
     return UCS_OK;
 
 pipe_cleanup:
@@ -258,33 +290,168 @@ out:
     return status;
 }
 
-unsigned ucp_worker_get_ep_config(ucp_worker_h worker, const ucp_rsc_index_t *rscs)
+ucs_status_t ucp_worker_open_iface(ucp_worker_h worker, ucp_rsc_index_t tl_id)
+{
+    ucs_status_t status;
+    ucs_time_t start_time;
+
+    if (worker->ifaces[tl_id] != NULL) {
+        return UCS_OK;
+    }
+
+    start_time = ucs_get_time();
+    status     = ucp_worker_add_iface(worker, tl_id);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    UCS_STATS_UPDATE_COUNTER(worker->stats, UCP_WORKER_STAT_IFACE_OPEN, 1);
+    UCS_STATS_UPDATE_TIME(worker->stats, UCP_WORKER_STAT_IFACE_TIME, start_time);
+    ucs_debug("worker %p: opened interface " UCT_TL_RESOURCE_DESC_FMT
+              " in %.3f ms", worker,
+              UCT_TL_RESOURCE_DESC_ARG(&worker->context->tl_rscs[tl_id].tl_rsc),
+              ucs_time_to_msec(ucs_get_time() - start_time));
+    return UCS_OK;
+}
+
+ucs_status_t ucp_worker_open_ifaces(ucp_worker_h worker, uint64_t tl_bitmap)
+{
+    ucp_rsc_index_t tl_id;
+    ucs_status_t status;
+
+    for (tl_id = 0; tl_id < worker->context->num_tls; ++tl_id) {
+        if (!(tl_bitmap & UCS_BIT(tl_id))) {
+            continue;
+        }
+
+        status = ucp_worker_open_iface(worker, tl_id);
+        if (status != UCS_OK) {
+            return status;
+        }
+    }
+
+    return UCS_OK;
+}
+
+/*
+ * Select the resources whose interfaces are packed in the worker address, when
+ * interfaces are opened on demand: a single resource of every transport,
+ * preferably on the NUMA node of the worker. A peer connects to one interface
+ * of a transport anyway, so the other interfaces are never opened.
+ */
+static uint64_t ucp_worker_select_address_tls(ucp_worker_h worker)
 {
     ucp_context_h context = worker->context;
-    uct_iface_attr_t *iface_attr;
-    uct_pd_attr_t *pd_attr;
-    ucp_ep_config_t *config;
-    ucp_rsc_index_t rsc_index;
-    double zcopy_thresh;
-    ucp_ep_op_t optype, dup;
-    unsigned i;
+    ucp_rsc_index_t tl_id, prev_id;
+    uint64_t tl_bitmap;
+
+    if (!context->config.ext.lazy_ifaces) {
+        return -1;
+    }
+
+    tl_bitmap = 0;
+    for (tl_id = 0; tl_id < context->num_tls; ++tl_id) {
+        for (prev_id = 0; prev_id < tl_id; ++prev_id) {
+            if ((tl_bitmap & UCS_BIT(prev_id)) &&
+                !strcmp(context->tl_rscs[tl_id].tl_rsc.tl_name,
+                        context->tl_rscs[prev_id].tl_rsc.tl_name)) {
+                break;
+            }
+        }
+
+        if (prev_id == tl_id) {
+            tl_bitmap |= UCS_BIT(tl_id);
+        } else if (ucp_worker_is_numa_remote(worker, prev_id) &&
+                   !ucp_worker_is_numa_remote(worker, tl_id)) {
+            tl_bitmap &= ~UCS_BIT(prev_id);
+            tl_bitmap |= UCS_BIT(tl_id);
+        }
+    }
+
+    return tl_bitmap;
+}
+
+/*
+ * Allocate a new configuration entry. Entries are never moved once allocated,
+ * so the chunk array may grow while pointers to existing entries are in use.
+ */
+static ucs_status_t ucp_worker_ep_config_alloc(ucp_worker_h worker,
+                                               ucp_ep_config_t **config_p,
+                                               unsigned *cfg_index_p)
+{
+    unsigned cfg_index = worker->ep_config.count;
+    ucp_ep_config_t **chunks, *chunk;
+    unsigned chunk_index;
+
+    if (cfg_index >= UCP_WORKER_EP_CONFIG_MAX) {
+        ucs_error("worker %p: too many ep configurations (%u)", worker,
+                  cfg_index);
+        return UCS_ERR_EXCEEDS_LIMIT;
+    }
 
-    for (i = 0; i < worker->ep_config_count; ++i) {
-        if (!memcmp(rscs, &worker->ep_config[i].rscs, sizeof(worker->ep_config[i].rscs))) {
-            return i;
+    chunk_index = cfg_index >> UCP_WORKER_EP_CONFIG_CHUNK_SHIFT;
+    if (chunk_index >= worker->ep_config.num_chunks) {
+        chunks = ucs_realloc(worker->ep_config.chunks,
+                             sizeof(*chunks) * (chunk_index + 1),
+                             "ucp_ep_config_chunks");
+        if (chunks == NULL) {
+            return UCS_ERR_NO_MEMORY;
         }
+
+        worker->ep_config.chunks = chunks;
+
+        chunk = ucs_malloc(sizeof(*chunk) * UCP_WORKER_EP_CONFIG_CHUNK_SIZE,
+                           "ucp_ep_config");
+        if (chunk == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        chunks[chunk_index] = chunk;
+        ++worker->ep_config.num_chunks;
     }
 
-    if (worker->ep_config_count >= worker->ep_config_max) {
-        /* TODO support larger number of configurations */
-        ucs_fatal("too many ep configurations");
+    ++worker->ep_config.count;
+    *config_p    = ucp_worker_ep_config(worker, cfg_index);
+    *cfg_index_p = cfg_index;
+    return UCS_OK;
+}
+
+static void ucp_worker_ep_config_cleanup(ucp_worker_h worker)
+{
+    unsigned i;
+
+    for (i = 0; i < worker->ep_config.num_chunks; ++i) {
+        ucs_free(worker->ep_config.chunks[i]);
     }
+    ucs_free(worker->ep_config.chunks);
+    ucs_free(worker->ep_config.hash);
+}
 
-    config         = &worker->ep_config[worker->ep_config_count];
+/*
+ * Calculate the limits of an endpoint which uses the given resources, whose
+ * interfaces must be open. The configuration index is not set.
+ */
+static void ucp_worker_ep_config_init(ucp_worker_h worker,
+                                      ucp_ep_config_t *config,
+                                      const ucp_rsc_index_t *rscs)
+{
+    ucp_context_h context = worker->context;
+    uct_iface_attr_t *iface_attr;
+    uct_pd_attr_t *pd_attr;
+    ucp_rsc_index_t rsc_index;
+    double zcopy_thresh;
+    ucp_ep_op_t optype, dup;
 
     memset(config, 0, sizeof(*config));
     memcpy(config->rscs, rscs, sizeof(config->rscs));
 
+    for (optype = 0; optype < UCP_EP_OP_LAST; ++optype) {
+        /* the attributes of a closed interface are all zero */
+        ucs_assertv((rscs[optype] == UCP_NULL_RESOURCE) ||
+                    (worker->ifaces[rscs[optype]] != NULL),
+                    "optype=%d rsc_index=%d", optype, rscs[optype]);
+    }
+
     /* find duplicate resources */
     for (optype = 0; optype < UCP_EP_OP_LAST; ++optype) {
         config->dups[optype] = UCP_EP_OP_LAST;
@@ -322,6 +489,7 @@ unsigned ucp_worker_get_ep_config(ucp_worker_h worker, const ucp_rsc_index_t *rs
             (pd_attr->cap.flags & UCT_PD_FLAG_REG))
         {
             config->max_am_zcopy  = iface_attr->cap.am.max_zcopy;
+            config->max_am_zcopy_hdr = iface_attr->cap.am.max_hdr;
             config->max_put_zcopy = iface_attr->cap.put.max_zcopy;
             config->max_get_zcopy = iface_attr->cap.get.max_zcopy;
 
@@ -362,16 +530,52 @@ unsigned ucp_worker_get_ep_config(ucp_worker_h worker, const ucp_rsc_index_t *rs
             config->max_get_bcopy    = iface_attr->cap.get.max_bcopy;
         }
     }
+}
+
+ucs_status_t ucp_worker_get_ep_config(ucp_worker_h worker,
+                                      const ucp_rsc_index_t *rscs,
+                                      unsigned *cfg_index_p)
+{
+    ucp_ep_config_t *config, search;
+    ucs_status_t status;
+    unsigned cfg_index;
+
+    memcpy(search.rscs, rscs, sizeof(search.rscs));
+    config = sglib_hashed_ucp_ep_config_t_find_member(worker->ep_config.hash,
+                                                      &search);
+    if (config != NULL) {
+        *cfg_index_p = config->index;
+        return UCS_OK;
+    }
 
-    return worker->ep_config_count++;
+    status = ucp_worker_ep_config_alloc(worker, &config, &cfg_index);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_worker_ep_config_init(worker, config, rscs);
+    config->index = cfg_index;
+
+    sglib_hashed_ucp_ep_config_t_add(worker->ep_config.hash, config);
+    *cfg_index_p = cfg_index;
+    return UCS_OK;
 }
 
-static void ucp_worker_set_stub_config(ucp_worker_h worker)
+static ucs_status_t ucp_worker_set_stub_config(ucp_worker_h worker)
 {
-    ucp_ep_config_t *config = &worker->ep_config[0];
+    ucp_ep_config_t *config;
     ucp_ep_op_t optype;
+    ucs_status_t status;
+    unsigned cfg_index;
 
+    status = ucp_worker_ep_config_alloc(worker, &config, &cfg_index);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucs_assert(cfg_index == 0);
     memset(config, 0, sizeof(*config));
+    config->index = cfg_index;
 
     for (optype = 0; optype < UCP_EP_OP_LAST; ++optype) {
         config->rscs[optype] = UCP_NULL_RESOURCE;
@@ -382,22 +586,22 @@ static void ucp_worker_set_stub_config(ucp_worker_h worker)
     config->sync_zcopy_thresh = SIZE_MAX;
     config->rndv_thresh       = SIZE_MAX;
     config->sync_rndv_thresh  = SIZE_MAX;
+
+    sglib_hashed_ucp_ep_config_t_add(worker->ep_config.hash, config);
+    return UCS_OK;
 }
 
 ucs_status_t ucp_worker_create(ucp_context_h context, ucs_thread_mode_t thread_mode,
                                ucp_worker_h *worker_p)
 {
-    ucp_rsc_index_t tl_id;
+    ucs_time_t start_time;
     ucp_worker_h worker;
     ucs_status_t status;
-    unsigned config_count;
     unsigned name_length;
 
-    config_count = ucs_min((context->num_tls + 1) * context->num_tls, UINT8_MAX);
+    start_time = ucs_get_time();
 
-    worker = ucs_calloc(1, sizeof(*worker) +
-                           sizeof(*worker->ep_config) * config_count,
-                        "ucp worker");
+    worker = ucs_calloc(1, sizeof(*worker), "ucp worker");
     if (worker == NULL) {
         status = UCS_ERR_NO_MEMORY;
         goto err;
@@ -405,11 +609,25 @@ ucs_status_t ucp_worker_create(ucp_context_h context, ucs_thread_mode_t thread_m
 
     worker->context         = context;
     worker->uuid            = ucs_generate_uuid((uintptr_t)worker);
+    worker->numa_node       = ucs_numa_current_node();
     worker->stub_pend_count = 0;
     worker->inprogress      = 0;
-    worker->ep_config_max   = config_count;
-    worker->ep_config_count = 0;
+    worker->ep_config.chunks     = NULL;
+    worker->ep_config.num_chunks = 0;
+    worker->ep_config.count      = 0;
+    worker->cq.entries      = NULL;
+    worker->cq.size         = 0;
+    worker->cq.head         = 0;
+    worker->cq.tail         = 0;
+    worker->cq.reserved     = 0;
+    worker->am_cbs          = NULL;
+    worker->am_cb_count     = 0;
     ucs_list_head_init(&worker->stub_ep_list);
+    ucs_list_head_init(&worker->am_rx_list);
+    ucs_list_head_init(&worker->reply_list);
+    ucs_queue_head_init(&worker->requeue_q);
+    ucs_queue_head_init(&worker->deferred_q);
+    worker->deadline.count  = 0;
 
     name_length = ucs_min(UCP_WORKER_NAME_MAX,
                           context->config.ext.max_worker_name + 1);
@@ -425,11 +643,27 @@ ucs_status_t ucp_worker_create(ucp_context_h context, ucs_thread_mode_t thread_m
 
     sglib_hashed_ucp_ep_t_init(worker->ep_hash);
 
+    worker->ep_config.hash = ucs_malloc(sizeof(*worker->ep_config.hash) *
+                                        UCP_WORKER_EP_CONFIG_HASH_SIZE,
+                                        "ucp_ep_config_hash");
+    if (worker->ep_config.hash == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_ep_hash;
+    }
+
+    sglib_hashed_ucp_ep_config_t_init(worker->ep_config.hash);
+
+    /* configuration index 0 is for stub endpoints */
+    status = ucp_worker_set_stub_config(worker);
+    if (status != UCS_OK) {
+        goto err_free_ep_config;
+    }
+
     worker->ifaces = ucs_calloc(context->num_tls, sizeof(*worker->ifaces),
                                 "ucp iface");
     if (worker->ifaces == NULL) {
         status = UCS_ERR_NO_MEMORY;
-        goto err_free_ep_hash;
+        goto err_free_ep_config;
     }
 
     worker->iface_attrs = ucs_calloc(context->num_tls,
@@ -440,16 +674,22 @@ ucs_status_t ucp_worker_create(ucp_context_h context, ucs_thread_mode_t thread_m
         goto err_free_ifaces;
     }
 
-    status = ucp_worker_wakeup_context_init(&worker->wakeup, context->num_tls);
+    status = ucp_worker_wakeup_context_init(&worker->wakeup, context);
     if (status != UCS_OK) {
         goto err_free_attrs;
     }
 
-    status = ucs_async_context_init(&worker->async, UCS_ASYNC_MODE_THREAD);
+    status = UCS_STATS_NODE_ALLOC(&worker->stats, &ucp_worker_stats_class,
+                                  NULL, "-%p", worker);
     if (status != UCS_OK) {
         goto err_free_wakeup;
     }
 
+    status = ucs_async_context_init(&worker->async, UCS_ASYNC_MODE_THREAD);
+    if (status != UCS_OK) {
+        goto err_free_stats;
+    }
+
     /* Create the underlying UCT worker */
     status = uct_worker_create(&worker->async, thread_mode, &worker->uct);
     if (status != UCS_OK) {
@@ -465,34 +705,78 @@ ucs_status_t ucp_worker_create(ucp_context_h context, ucs_thread_mode_t thread_m
         goto err_destroy_uct_worker;
     }
 
-    /* Open all resources as interfaces on this worker */
-    for (tl_id = 0; tl_id < context->num_tls; ++tl_id) {
-        status = ucp_worker_add_iface(worker, tl_id);
+    /* Create memory pool for cq and deadline state of requests */
+    status = ucs_mpool_init(&worker->req_ext_mp, 0, sizeof(ucp_request_ext_t),
+                            0, UCS_SYS_CACHE_LINE_SIZE, 32, UINT_MAX,
+                            &ucp_request_ext_mpool_ops, "ucp_request_exts");
+    if (status != UCS_OK) {
+        goto err_req_mp_cleanup;
+    }
+
+    /* Create memory pool for batched acknowledgments */
+    status = ucs_mpool_init(&worker->reply_mp, 0, sizeof(ucp_reply_batch_t),
+                            0, UCS_SYS_CACHE_LINE_SIZE, 32, UINT_MAX,
+                            &ucp_reply_batch_mpool_ops, "ucp_replies");
+    if (status != UCS_OK) {
+        goto err_req_ext_mp_cleanup;
+    }
+
+    /* Set up the pools of registered bounce buffers, created on first use */
+    status = ucp_worker_bounce_init(worker);
+    if (status != UCS_OK) {
+        goto err_reply_mp_cleanup;
+    }
+
+    /* Create timer wheel for request deadlines */
+    status = ucs_twheel_init(&worker->deadline.twheel,
+                             ucs_time_from_usec(UCP_WORKER_DEADLINE_RES_USEC),
+                             ucs_get_time());
+    if (status != UCS_OK) {
+        goto err_bounce_cleanup;
+    }
+
+    /* Open all resources as interfaces on this worker, unless they should be
+     * opened on first use */
+    worker->address_tls = ucp_worker_select_address_tls(worker);
+    if (!context->config.ext.lazy_ifaces) {
+        status = ucp_worker_open_ifaces(worker, -1);
         if (status != UCS_OK) {
             goto err_close_ifaces;
         }
     }
 
-    /* configuration index 0 is for stub endpoints */
-    ucp_worker_set_stub_config(worker);
-    ++worker->ep_config_count;
-
+    ucs_debug("worker %p: created in %.3f ms%s", worker,
+              ucs_time_to_msec(ucs_get_time() - start_time),
+              context->config.ext.lazy_ifaces ?
+                              ", interfaces will be opened on demand" : "");
     *worker_p = worker;
     return UCS_OK;
 
 err_close_ifaces:
     ucp_worker_close_ifaces(worker);
+    ucs_twheel_cleanup(&worker->deadline.twheel);
+err_bounce_cleanup:
+    ucp_worker_bounce_cleanup(worker);
+err_reply_mp_cleanup:
+    ucs_mpool_cleanup(&worker->reply_mp, 1);
+err_req_ext_mp_cleanup:
+    ucs_mpool_cleanup(&worker->req_ext_mp, 1);
+err_req_mp_cleanup:
     ucs_mpool_cleanup(&worker->req_mp, 1);
 err_destroy_uct_worker:
     uct_worker_destroy(worker->uct);
 err_destroy_async:
     ucs_async_context_cleanup(&worker->async);
+err_free_stats:
+    UCS_STATS_NODE_FREE(worker->stats);
 err_free_wakeup:
     ucp_worker_wakeup_context_cleanup(&worker->wakeup);
 err_free_attrs:
     ucs_free(worker->iface_attrs);
 err_free_ifaces:
     ucs_free(worker->ifaces);
+err_free_ep_config:
+    ucp_worker_ep_config_cleanup(worker);
 err_free_ep_hash:
     ucs_free(worker->ep_hash);
 err_free:
@@ -520,27 +804,64 @@ void ucp_worker_destroy(ucp_worker_h worker)
     ucp_worker_remove_am_handlers(worker);
     ucp_worker_destroy_eps(worker);
     ucp_worker_close_ifaces(worker);
+    ucs_twheel_cleanup(&worker->deadline.twheel);
+    ucp_worker_bounce_cleanup(worker);
+    ucs_mpool_cleanup(&worker->reply_mp, 1);
+    ucs_mpool_cleanup(&worker->req_ext_mp, 1);
     ucs_mpool_cleanup(&worker->req_mp, 1);
     uct_worker_destroy(worker->uct);
     ucs_async_context_cleanup(&worker->async);
+    UCS_STATS_NODE_FREE(worker->stats);
     ucp_worker_wakeup_context_cleanup(&worker->wakeup);
+    if (worker->cq.tail != worker->cq.head) {
+        ucs_warn("worker %p: %u completions were not reaped", worker,
+                 worker->cq.tail - worker->cq.head);
+    }
+    ucs_free(worker->cq.entries);
+    ucp_am_cleanup(worker);
     ucs_free(worker->iface_attrs);
     ucs_free(worker->ifaces);
+    ucp_worker_ep_config_cleanup(worker);
     ucs_free(worker->ep_hash);
     ucs_free(worker);
 }
 
-void ucp_worker_progress(ucp_worker_h worker)
+unsigned ucp_worker_progress(ucp_worker_h worker)
 {
+    unsigned count, deadlines;
+
     /* worker->inprogress is used only for assertion check.
      * coverity[assert_side_effect]
      */
     ucs_assert(worker->inprogress++ == 0);
-    uct_worker_progress(worker->uct);
+    count = uct_worker_progress(worker->uct);
     ucs_async_check_miss(&worker->async);
 
+    /* Send the acknowledgments collected by this progress call, batched */
+    if (!ucs_list_is_empty(&worker->reply_list)) {
+        ucp_tag_eager_sync_flush_acks(worker);
+    }
+
+    /* Re-add requests which a pending queue refused during a cancel */
+    if (ucs_unlikely(!ucs_queue_is_empty(&worker->deferred_q))) {
+        count += ucp_ep_pending_dispatch_deferred(worker);
+    }
+
+    /* Expire requests whose deadline has passed, canceling them like
+     * ucp_request_cancel() does */
+    if (ucs_unlikely(worker->deadline.count > 0)) {
+        UCS_ASYNC_BLOCK(&worker->async);
+        deadlines = worker->deadline.count;
+        ucs_twheel_sweep(&worker->deadline.twheel, ucs_get_time());
+        if (worker->deadline.count < deadlines) {
+            count += deadlines - worker->deadline.count; /* Expired requests */
+        }
+        UCS_ASYNC_UNBLOCK(&worker->async);
+    }
+
     /* coverity[assert_side_effect] */
     ucs_assert(--worker->inprogress == 0);
+    return count;
 }
 
 ucs_status_t ucp_worker_get_efd(ucp_worker_h worker, int *fd)
@@ -622,35 +943,87 @@ ucs_status_t ucp_worker_arm(ucp_worker_h worker)
     return UCS_OK;
 }
 
-ucs_status_t ucp_worker_wait(ucp_worker_h worker)
+static int ucp_worker_wait_epoll(int epoll_fd, struct epoll_event *events,
+                                 int max_events, int timeout)
 {
     int res;
-    int epoll_fd;
-    ucs_status_t status;
-    struct epoll_event *events;
+
+    do {
+        res = epoll_wait(epoll_fd, events, max_events, timeout);
+    } while ((res == -1) && (errno == EINTR));
+
+    return res;
+}
+
+/*
+ * Adapt the busy-poll time to the recent delay until an event arrives: if
+ * events typically come within the spin limit, spin a bit longer than the
+ * average delay, otherwise spinning would only burn CPU, so block right away.
+ */
+static void ucp_worker_wait_adapt(ucp_worker_wakeup_t *wakeup, ucs_time_t elapsed)
+{
+    wakeup->avg_wait = (wakeup->avg_wait * 7 + elapsed) / 8;
+    if (wakeup->avg_wait <= wakeup->spin_max) {
+        wakeup->spin_time = ucs_min(wakeup->avg_wait * 2, wakeup->spin_max);
+    } else {
+        wakeup->spin_time = 0;
+    }
+}
+
+ucs_status_t ucp_worker_wait(ucp_worker_h worker)
+{
+    ucp_worker_wakeup_t *wakeup = &worker->wakeup;
     ucp_context_h context = worker->context;
+    struct epoll_event *events;
+    ucs_time_t start, deadline;
+    ucs_status_t status;
+    int epoll_fd;
+    int res;
 
     status = ucp_worker_get_efd(worker, &epoll_fd);
     if (status != UCS_OK) {
         return status;
     }
 
-    events = ucs_malloc(context->num_tls * sizeof(*events), "wakeup events");
+    /* One extra entry for the internal signaling pipe */
+    events = ucs_malloc((context->num_tls + 1) * sizeof(*events),
+                        "wakeup events");
     if (events == NULL) {
         return UCS_ERR_NO_MEMORY;
     }
 
-    do {
-        res = epoll_wait(epoll_fd, events, context->num_tls, -1);
-    } while ((res == -1) && (errno == EINTR));
+    start = ucs_get_time();
+    res   = 0;
 
-    free(events);
+    /* Events without a file descriptor, such as self messages or expired
+     * deadlines, are reported only by progress, so they end the wait too */
+    if (wakeup->spin_time > 0) {
+        deadline = start + wakeup->spin_time;
+        do {
+            if (ucp_worker_progress(worker) > 0) {
+                res = 1;
+                break;
+            }
+            res = ucp_worker_wait_epoll(epoll_fd, events, context->num_tls + 1,
+                                        0);
+        } while ((res == 0) && (ucs_get_time() < deadline));
+    }
+
+    if (res == 0) {
+        UCS_STATS_UPDATE_COUNTER(worker->stats, UCP_WORKER_STAT_WAIT_SLEEP, 1);
+        res = ucp_worker_wait_epoll(epoll_fd, events, context->num_tls + 1, -1);
+    } else if (res > 0) {
+        UCS_STATS_UPDATE_COUNTER(worker->stats, UCP_WORKER_STAT_WAIT_SPIN, 1);
+    }
+
+    ucs_free(events);
 
     if (res == -1) {
         ucs_error("Polling internally for events failed: %m");
         return UCS_ERR_IO_ERROR;
     }
 
+    ucp_worker_wait_adapt(wakeup, ucs_get_time() - start);
     return UCS_OK;
 }
 
@@ -670,8 +1043,19 @@ ucs_status_t ucp_worker_signal(ucp_worker_h worker)
 ucs_status_t ucp_worker_get_address(ucp_worker_h worker, ucp_address_t **address_p,
                                     size_t *address_length_p)
 {
-    return ucp_address_pack(worker, NULL, -1, NULL, address_length_p,
-                            (void**)address_p);
+    ucs_status_t status;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+
+    /* Open only the interfaces which are packed in the address */
+    status = ucp_worker_open_ifaces(worker, worker->address_tls);
+    if (status == UCS_OK) {
+        status = ucp_address_pack(worker, NULL, worker->address_tls, NULL,
+                                  address_length_p, (void**)address_p);
+    }
+
+    UCS_ASYNC_UNBLOCK(&worker->async);
+    return status;
 }
 
 void ucp_worker_release_address(ucp_worker_h worker, ucp_address_t *address)
@@ -704,29 +1088,19 @@ err:
     ucs_fatal("failed to create reply endpoint: %s", ucs_status_string(status));
 }
 
-ucp_request_t *ucp_worker_allocate_reply(ucp_worker_h worker, uint64_t dest_uuid)
-{
-    ucp_request_t *req;
-    ucp_ep_h ep;
-
-    req = ucs_mpool_get_inline(&worker->req_mp);
-    if (req == NULL) {
-        ucs_fatal("could not allocate request");
-    }
-
-    ep = ucp_worker_get_reply_ep(worker, dest_uuid);
-    ucp_send_req_init(req, ep);
-    return req;
-}
-
 SGLIB_DEFINE_LIST_FUNCTIONS(ucp_ep_t, ucp_worker_ep_compare, next);
 SGLIB_DEFINE_HASHED_CONTAINER_FUNCTIONS(ucp_ep_t, UCP_WORKER_EP_HASH_SIZE,
                                         ucp_worker_ep_hash);
 
-void ucp_worker_progress_stub_eps(void *arg)
+SGLIB_DEFINE_LIST_FUNCTIONS(ucp_ep_config_t, ucp_worker_ep_config_compare, next);
+SGLIB_DEFINE_HASHED_CONTAINER_FUNCTIONS(ucp_ep_config_t, UCP_WORKER_EP_CONFIG_HASH_SIZE,
+                                        ucp_worker_ep_config_hash);
+
+unsigned ucp_worker_progress_stub_eps(void *arg)
 {
     ucp_worker_h worker = arg;
     ucp_stub_ep_t *stub_ep, *tmp;
+    unsigned count = 0;
 
     /*
      * We switch the endpoint in this function (instead in wireup code) since
@@ -740,8 +1114,10 @@ void ucp_worker_progress_stub_eps(void *arg)
     UCS_ASYNC_BLOCK(&worker->async);
     ucs_list_for_each_safe(stub_ep, tmp, &worker->stub_ep_list, list) {
         ucp_stub_ep_progress(stub_ep);
+        ++count;
     }
     UCS_ASYNC_UNBLOCK(&worker->async);
+    return count;
 }
 
 void ucp_worker_stub_ep_add(ucp_worker_h worker, ucp_stub_ep_t *stub_ep)
@@ -762,6 +1138,69 @@ void ucp_worker_stub_ep_remove(ucp_worker_h worker, ucp_stub_ep_t *stub_ep)
     UCS_ASYNC_UNBLOCK(&worker->async);
 }
 
+static ucs_status_t ucp_worker_cq_grow(ucp_worker_h worker)
+{
+    ucp_worker_cq_t *cq = &worker->cq;
+    ucp_completion_t *entries;
+    unsigned new_size, i;
+
+    new_size = ucs_max(cq->size * 2, UCP_WORKER_CQ_INIT_SIZE);
+    entries  = ucs_malloc(sizeof(*entries) * new_size, "ucp_worker_cq");
+    if (entries == NULL) {
+        ucs_error("worker %p: failed to grow completion queue to %u entries",
+                  worker, new_size);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* Copy pending entries to the beginning of the new ring */
+    for (i = 0; i < cq->tail - cq->head; ++i) {
+        entries[i] = cq->entries[(cq->head + i) & (cq->size - 1)];
+    }
+
+    ucs_debug("worker %p: completion queue size %u->%u", worker, cq->size,
+              new_size);
+    ucs_free(cq->entries);
+    cq->entries = entries;
+    cq->size    = new_size;
+    cq->tail    = cq->tail - cq->head;
+    cq->head    = 0;
+    return UCS_OK;
+}
+
+ucs_status_t ucp_worker_cq_reserve(ucp_worker_h worker)
+{
+    ucp_worker_cq_t *cq = &worker->cq;
+    ucs_status_t status = UCS_OK;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    if (cq->tail - cq->head + cq->reserved == cq->size) {
+        status = ucp_worker_cq_grow(worker);
+    }
+    if (status == UCS_OK) {
+        ++cq->reserved;
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
+    return status;
+}
+
+unsigned ucp_worker_poll_completions(ucp_worker_h worker,
+                                     ucp_completion_t *completions,
+                                     unsigned max)
+{
+    ucp_worker_cq_t *cq = &worker->cq;
+    unsigned count;
+
+    UCS_ASYNC_BLOCK(&worker->async);
+    for (count = 0; (count < max) && (cq->head != cq->tail); ++count) {
+        completions[count] = cq->entries[cq->head & (cq->size - 1)];
+        ++cq->head;
+    }
+    UCS_ASYNC_UNBLOCK(&worker->async);
+
+    return count;
+}
+
 static void ucp_worker_print_config(FILE *stream, const char * const *names,
                                     const size_t *values, unsigned count,
                                     const char *rel)
@@ -785,8 +1224,10 @@ void ucp_worker_proto_print(ucp_worker_h worker, FILE *stream, const char *title
                             ucs_config_print_flags_t print_flags)
 {
     ucp_context_h context = worker->context;
-    ucp_ep_config_t *config;
+    ucp_rsc_index_t rscs[UCP_EP_OP_LAST];
+    ucp_ep_config_t config_buf, *config = &config_buf;
     ucp_rsc_index_t tl_id;
+    ucp_ep_op_t optype;
     char rsc_name[UCT_TL_NAME_MAX + UCT_DEVICE_NAME_MAX + 2];
     ucp_address_t *address;
     size_t address_length;
@@ -808,6 +1249,12 @@ void ucp_worker_proto_print(ucp_worker_h worker, FILE *stream, const char *title
         fprintf(stream, "# <failed to get address>\n");
     }
 
+    if (worker->numa_node >= 0) {
+        fprintf(stream, "# NUMA node:      %d\n", worker->numa_node);
+    } else {
+        fprintf(stream, "# NUMA node:      <unknown>\n");
+    }
+
     fprintf(stream, "#\n");
 
     fprintf(stream, "# Transports: \n");
@@ -818,10 +1265,28 @@ void ucp_worker_proto_print(ucp_worker_h worker, FILE *stream, const char *title
         snprintf(rsc_name, sizeof(rsc_name), UCT_TL_RESOURCE_DESC_FMT,
                  UCT_TL_RESOURCE_DESC_ARG(&context->tl_rscs[tl_id].tl_rsc));
 
-        fprintf(stream, "# %3d %-18s\n", tl_id, rsc_name);
+        if (context->tl_rscs[tl_id].numa_node >= 0) {
+            fprintf(stream, "# %3d %-18s numa node %d%s\n", tl_id, rsc_name,
+                    context->tl_rscs[tl_id].numa_node,
+                    ucp_worker_is_numa_remote(worker, tl_id) ? " (remote)" : "");
+        } else {
+            fprintf(stream, "# %3d %-18s\n", tl_id, rsc_name);
+        }
         fprintf(stream, "#\n");
 
-        config = &worker->ep_config[tl_id];
+        if (worker->ifaces[tl_id] == NULL) {
+            fprintf(stream, "# <not opened>\n");
+            fprintf(stream, "#\n");
+            fprintf(stream, "#\n");
+            continue;
+        }
+
+        /* limits of an endpoint which uses this transport for everything,
+         * calculated without adding a configuration to the worker */
+        for (optype = 0; optype < UCP_EP_OP_LAST; ++optype) {
+            rscs[optype] = tl_id;
+        }
+        ucp_worker_ep_config_init(worker, config, rscs);
         {
             const char *names[] = {"egr_short", "put_short", "am_short"};
             size_t     values[] = {config->max_eager_short, config->max_put_short,
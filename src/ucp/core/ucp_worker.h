@@ -13,6 +13,26 @@
 #include <ucs/datastruct/mpool.h>
 #include <ucs/datastruct/sglib_wrapper.h>
 #include <ucs/async/async.h>
+#include <ucs/stats/stats.h>
+#include <ucs/time/time.h>
+#include <ucs/time/timer_wheel.h>
+
+
+#define UCP_WORKER_ZCOPY_HISTORY_SIZE      64
+#define UCP_WORKER_DEADLINE_RES_USEC       1000 /* Request deadline resolution */
+
+
+/**
+ * UCP worker statistics counters
+ */
+enum {
+    UCP_WORKER_STAT_WAIT_SPIN,     /* ucp_worker_wait() got an event while spinning */
+    UCP_WORKER_STAT_WAIT_SLEEP,    /* ucp_worker_wait() had to block */
+    UCP_WORKER_STAT_IFACE_OPEN,    /* Number of opened interfaces */
+    UCP_WORKER_STAT_IFACE_TIME,    /* Time spent opening interfaces, in nsec */
+    UCP_WORKER_STAT_LAST
+};
+
 
 /**
  * UCP worker wake-up context.
@@ -21,8 +41,33 @@ typedef struct ucp_worker_wakeup {
     int                           wakeup_efd;     /* Allocated (on-demand) epoll fd for wakeup */
     int                           wakeup_pipe[2]; /* Pipe to support signal() calls */
     uct_wakeup_h                  *iface_wakeups; /* Array of interface wake-up handles */
+    ucs_time_t                    spin_max;       /* Maximal busy-poll time before blocking */
+    ucs_time_t                    spin_time;      /* Current busy-poll time, adapted to traffic */
+    ucs_time_t                    avg_wait;       /* Moving average of time until an event */
 } ucp_worker_wakeup_t;
 
+/**
+ * UCP worker completion queue.
+ * A ring of completion entries which is filled by requests posted with a
+ * completion-queue entry point, and reaped by ucp_worker_poll_completions().
+ */
+typedef struct ucp_worker_cq {
+    ucp_completion_t              *entries;      /* Ring buffer of entries */
+    unsigned                      size;          /* Ring size, power of 2 */
+    unsigned                      head;          /* Next entry to reap */
+    unsigned                      tail;          /* Next entry to fill */
+    unsigned                      reserved;      /* Entries reserved for requests
+                                                    in progress */
+} ucp_worker_cq_t;
+
+/**
+ * User active message handler.
+ */
+typedef struct ucp_worker_am_entry {
+    ucp_am_callback_t             cb;            /* Handler, NULL if not set */
+    void                          *arg;          /* User argument for the handler */
+} ucp_worker_am_entry_t;
+
 /**
  * UCP worker (thread context).
  */
@@ -30,45 +75,116 @@ typedef struct ucp_worker {
     ucs_async_context_t           async;         /* Async context for this worker */
     ucp_context_h                 context;       /* Back-reference to UCP context */
     uint64_t                      uuid;          /* Unique ID for wireup */
+    int                           numa_node;     /* NUMA node of the creating thread */
     uct_worker_h                  uct;           /* UCT worker handle */
     ucs_mpool_t                   req_mp;        /* Memory pool for requests */
+    ucs_mpool_t                   req_ext_mp;    /* Memory pool for request extensions */
     ucp_worker_wakeup_t           wakeup;        /* Wakeup-related context */
+    ucp_worker_cq_t               cq;            /* Completion queue */
+    ucp_worker_am_entry_t         *am_cbs;       /* User active message handlers */
+    unsigned                      am_cb_count;   /* Number of entries in am_cbs */
+    ucs_list_link_t               am_rx_list;    /* Partially received active messages */
+    ucs_mpool_t                   reply_mp;      /* Memory pool for reply batches */
+    ucs_list_link_t               reply_list;    /* Reply batches to send at the end of progress */
+    ucs_queue_head_t              requeue_q;     /* Pending requests being re-added */
+    ucs_queue_head_t              deferred_q;    /* Pending requests to re-add from progress */
+
+    struct {
+        ucs_twheel_t              twheel;        /* Request deadline timers */
+        unsigned                  count;         /* Number of requests with a deadline */
+    } deadline;
 
     int                           inprogress;
     char                          name[UCP_WORKER_NAME_MAX]; /* Worker name */
+    UCS_STATS_NODE_DECLARE(stats);
 
     unsigned                      stub_pend_count;/* Number of pending requests on stub endpoints*/
     ucs_list_link_t               stub_ep_list;  /* List of stub endpoints to progress */
 
+    uint64_t                      bounce_pd_map; /* PDs which have bounce buffers */
+    ucs_mpool_t                   *bounce_mps;   /* Registered bounce buffers, per PD */
+    uint64_t                      staging_pd_map;/* PDs which have staging buffers */
+    ucs_mpool_t                   *staging_mps;  /* Registered staging buffers of
+                                                    generic dt pipelines, per PD */
+    uintptr_t                     zcopy_history[UCP_WORKER_ZCOPY_HISTORY_SIZE];
+                                                 /* Recently sent zcopy buffers */
+
     ucp_ep_t                      **ep_hash;     /* Hash table of all endpoints */
     uct_iface_h                   *ifaces;       /* Array of interfaces, one for each resource */
     uct_iface_attr_t              *iface_attrs;  /* Array of interface attributes */
-    unsigned                      ep_config_max; /* Maximal number of configurations */
-    unsigned                      ep_config_count; /* Current number of configurations */
-    ucp_ep_config_t               ep_config[0];  /* Array of transport limits and thresholds */
+    uint64_t                      address_tls;   /* Resources whose interfaces are
+                                                    in the worker address */
+
+    struct {
+        ucp_ep_config_t           **chunks;      /* Arrays of transport limits and thresholds */
+        unsigned                  num_chunks;    /* Number of allocated chunks */
+        unsigned                  count;         /* Current number of configurations */
+        ucp_ep_config_t           **hash;        /* Hash table of configurations by resources */
+    } ep_config;
 } ucp_worker_t;
 
 
 #define UCP_WORKER_EP_HASH_SIZE            32767
+#define UCP_WORKER_CQ_INIT_SIZE            256
 #define ucp_worker_ep_compare(_ep1, _ep2)  ((int64_t)(_ep1)->dest_uuid - (int64_t)(_ep2)->dest_uuid)
 #define ucp_worker_ep_hash(_ep)            ((_ep)->dest_uuid)
 
+/* Endpoint configurations are allocated in chunks, so they never move */
+#define UCP_WORKER_EP_CONFIG_CHUNK_SHIFT   5
+#define UCP_WORKER_EP_CONFIG_CHUNK_SIZE    UCS_BIT(UCP_WORKER_EP_CONFIG_CHUNK_SHIFT)
+#define UCP_WORKER_EP_CONFIG_MAX           UINT16_MAX
+#define UCP_WORKER_EP_CONFIG_HASH_SIZE     1021
+#define ucp_worker_ep_config_compare(_c1, _c2) \
+    memcmp((_c1)->rscs, (_c2)->rscs, sizeof((_c1)->rscs))
+#define ucp_worker_ep_config_hash(_c) \
+    (((_c)->rscs[UCP_EP_OP_AM] << 16) ^ ((_c)->rscs[UCP_EP_OP_RMA] << 8) ^ \
+     (_c)->rscs[UCP_EP_OP_AMO])
+
 SGLIB_DEFINE_LIST_PROTOTYPES(ucp_ep_t, ucp_worker_ep_compare, next);
 SGLIB_DEFINE_HASHED_CONTAINER_PROTOTYPES(ucp_ep_t, UCP_WORKER_EP_HASH_SIZE, ucp_worker_ep_hash);
 
+SGLIB_DEFINE_LIST_PROTOTYPES(ucp_ep_config_t, ucp_worker_ep_config_compare, next);
+SGLIB_DEFINE_HASHED_CONTAINER_PROTOTYPES(ucp_ep_config_t, UCP_WORKER_EP_CONFIG_HASH_SIZE,
+                                         ucp_worker_ep_config_hash);
+
 
 ucp_ep_h ucp_worker_get_reply_ep(ucp_worker_h worker, uint64_t dest_uuid);
 
-ucp_request_t *ucp_worker_allocate_reply(ucp_worker_h worker, uint64_t dest_uuid);
 
-unsigned ucp_worker_get_ep_config(ucp_worker_h worker, const ucp_rsc_index_t *rscs);
+/**
+ * @return Whether the device of a resource is attached to another NUMA node
+ *         than the worker.
+ */
+static inline int ucp_worker_is_numa_remote(ucp_worker_h worker,
+                                            ucp_rsc_index_t rsc_index)
+{
+    int numa_node = worker->context->tl_rscs[rsc_index].numa_node;
 
-void ucp_worker_progress_stub_eps(void *arg);
+    return (numa_node >= 0) && (worker->numa_node >= 0) &&
+           (numa_node != worker->numa_node);
+}
+
+
+ucs_status_t ucp_worker_get_ep_config(ucp_worker_h worker,
+                                      const ucp_rsc_index_t *rscs,
+                                      unsigned *cfg_index_p);
+
+ucs_status_t ucp_worker_open_iface(ucp_worker_h worker, ucp_rsc_index_t tl_id);
+
+ucs_status_t ucp_worker_open_ifaces(ucp_worker_h worker, uint64_t tl_bitmap);
+
+unsigned ucp_worker_progress_stub_eps(void *arg);
 
 void ucp_worker_stub_ep_add(ucp_worker_h worker, ucp_stub_ep_t *stub_ep);
 
 void ucp_worker_stub_ep_remove(ucp_worker_h worker, ucp_stub_ep_t *stub_ep);
 
+/*
+ * Reserve a completion queue entry for a request which is about to be posted,
+ * so its completion is never lost because the queue could not grow.
+ */
+ucs_status_t ucp_worker_cq_reserve(ucp_worker_h worker);
+
 
 static inline const char* ucp_worker_get_name(ucp_worker_h worker)
 {
@@ -83,9 +199,48 @@ static inline ucp_ep_h ucp_worker_ep_find(ucp_worker_h worker, uint64_t dest_uui
     return sglib_hashed_ucp_ep_t_find_member(worker->ep_hash, &search);
 }
 
+static UCS_F_ALWAYS_INLINE void
+ucp_worker_cq_push(ucp_worker_h worker, void *user_data, ucs_status_t status,
+                   const ucp_tag_recv_info_t *info)
+{
+    ucp_worker_cq_t *cq = &worker->cq;
+    ucp_completion_t *entry;
+
+    /* The entry was reserved by ucp_worker_cq_reserve() */
+    ucs_assert(cq->reserved > 0);
+    ucs_assert(cq->tail - cq->head < cq->size);
+    --cq->reserved;
+
+    entry            = &cq->entries[cq->tail & (cq->size - 1)];
+    entry->user_data = user_data;
+    entry->status    = status;
+    if (info != NULL) {
+        entry->info  = *info;
+    }
+    ++cq->tail;
+}
+
+/*
+ * Release an entry reserved by ucp_worker_cq_reserve(), for a request which
+ * failed to post.
+ */
+static inline void ucp_worker_cq_unreserve(ucp_worker_h worker)
+{
+    ucs_assert(worker->cq.reserved > 0);
+    --worker->cq.reserved;
+}
+
+static inline ucp_ep_config_t *
+ucp_worker_ep_config(ucp_worker_h worker, unsigned cfg_index)
+{
+    ucs_assert(cfg_index < worker->ep_config.count);
+    return &worker->ep_config.chunks[cfg_index >> UCP_WORKER_EP_CONFIG_CHUNK_SHIFT]
+                                    [cfg_index & (UCP_WORKER_EP_CONFIG_CHUNK_SIZE - 1)];
+}
+
 static inline ucp_ep_config_t *ucp_ep_config(ucp_ep_h ep)
 {
-    return &ep->worker->ep_config[ep->cfg_index];
+    return ucp_worker_ep_config(ep->worker, ep->cfg_index);
 }
 
 static inline ucp_rsc_index_t ucp_ep_pd_index(ucp_ep_h ep, ucp_ep_op_t optype)
@@ -12,10 +12,15 @@
 #include <ucp/wireup/wireup.h>
 #include <ucp/core/ucp_context.h>
 #include <ucp/core/ucp_worker.h>
+#include <ucs/datastruct/list.h>
 #include <ucs/sys/compiler.h>
 #include <ucs/sys/sys.h>
 
 
+/* Maximal number of acknowledgments sent in one active message */
+#define UCP_REPLY_BATCH_MAX       16
+
+
 /**
  * Header segment for a transaction
  */
@@ -34,6 +39,24 @@ typedef struct {
 } UCS_S_PACKED ucp_reply_hdr_t;
 
 
+/**
+ * Requests to acknowledge with a single active message. The first request is
+ * sent in ucp_reply_hdr_t, and the rest of the request pointers follow it.
+ */
+typedef struct ucp_reply_batch {
+    ucs_list_link_t           list;     /* Entry in worker's list of batches */
+    ucp_ep_h                  ep;       /* Endpoint to send the replies on */
+    unsigned                  count;    /* Number of requests in the batch */
+    uintptr_t                 reqptrs[UCP_REPLY_BATCH_MAX];
+} ucp_reply_batch_t;
+
+
+/**
+ * Called when all fragments of a request were sent.
+ */
+typedef void (*ucp_req_complete_func_t)(ucp_request_t *req);
+
+
 /**
  * Defines functions for a protocol, on all possible data types.
  */
@@ -46,6 +69,7 @@ typedef struct ucp_proto {
     uct_completion_callback_t  contig_zcopy_completion;/* Callback for UCT zcopy completion */
     uct_pending_callback_t     generic_single;         /* Progress bcopy single fragment, generic dt */
     uct_pending_callback_t     generic_multi;          /* Progress bcopy multi-fragment, generic dt */
+    uct_pending_callback_t     generic_pipeline;       /* Progress zcopy from staging buffers, generic dt */
     size_t                     only_hdr_size;          /* Header size for single / short */
     size_t                     first_hdr_size;         /* Header size for first of multi */
     size_t                     mid_hdr_size;           /* Header size for rest of multi */
@@ -55,6 +79,40 @@ typedef struct ucp_proto {
 ucs_status_t ucp_proto_progress_am_bcopy_single(uct_pending_req_t *self);
 
 
+/*
+ * Take a ring of registered staging buffers from the worker for sending a
+ * generic datatype with zcopy. Data is packed into the staging buffers ahead of
+ * the transport, so packing overlaps with sending earlier fragments. Returns
+ * UCS_ERR_NO_RESOURCE if the worker has no staging buffers to spare.
+ */
+ucs_status_t ucp_proto_pipeline_init(ucp_request_t *req, size_t frag_size,
+                                     unsigned depth);
+
+
+/*
+ * Send the next fragment of a request which was set up by
+ * ucp_proto_pipeline_init(). Returns UCS_OK after the last fragment is posted;
+ * 'complete' is called once all fragments were completed by the transport. If
+ * a fragment fails, the rest are not sent, and the request is completed with
+ * the error instead.
+ */
+ucs_status_t ucp_proto_pipeline_progress(uct_pending_req_t *self,
+                                         uint8_t am_id_first,
+                                         uint8_t am_id_middle,
+                                         uint8_t am_id_last,
+                                         const void *hdr_first,
+                                         size_t hdr_size_first,
+                                         const void *hdr_middle,
+                                         size_t hdr_size_middle,
+                                         ucp_req_complete_func_t complete);
+
+
+/*
+ * Release the staging buffers of a request which did not start sending.
+ */
+void ucp_proto_pipeline_cleanup(ucp_request_t *req);
+
+
 /*
  * Make sure the remote worker would be able to send replies to our endpoint.
  * Should be used before a sending a message which requires a reply.
@@ -70,8 +128,9 @@ static inline void ucp_ep_connect_remote(ucp_ep_h ep)
 static inline void ucp_send_req_init(ucp_request_t* req, ucp_ep_h ep)
 {
     VALGRIND_MAKE_MEM_DEFINED(req + 1, ep->worker->context->config.request.size);
-    req->flags             = 0;
+    req->flags             = UCP_REQUEST_FLAG_SEND;
     req->send.ep           = ep;
+    req->send.prio         = UCP_REQUEST_PRIO_BULK;
 }
 
 
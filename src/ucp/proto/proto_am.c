@@ -7,16 +7,23 @@
 #include "proto.h"
 #include "proto_am.inl"
 
+#include <string.h>
+
 static size_t ucp_proto_pack(void *dest, void *arg)
 {
     ucp_reply_hdr_t *rep_hdr = dest;
     ucp_request_t *req = arg;
+    ucp_reply_batch_t *batch;
+    size_t length;
 
     switch (req->send.proto.am_id) {
     case UCP_AM_ID_EAGER_SYNC_ACK:
-        rep_hdr->reqptr = req->send.proto.remote_request;
-        rep_hdr->status  = req->send.proto.status;
-        return sizeof(*rep_hdr);
+        batch           = req->send.proto.batch;
+        length          = (batch->count - 1) * sizeof(*batch->reqptrs);
+        rep_hdr->reqptr = batch->reqptrs[0];
+        rep_hdr->status = req->send.proto.status;
+        memcpy(rep_hdr + 1, batch->reqptrs + 1, length);
+        return sizeof(*rep_hdr) + length;
     }
 
     ucs_bug("unexpected am_id");
@@ -30,6 +37,7 @@ ucs_status_t ucp_proto_progress_am_bcopy_single(uct_pending_req_t *self)
     ucs_status_t status = ucp_do_am_bcopy_single(self, req->send.proto.am_id,
                                                  ucp_proto_pack);
     if (status == UCS_OK) {
+        ucs_mpool_put(req->send.proto.batch);
         ucs_mpool_put(req);
     }
     return status;
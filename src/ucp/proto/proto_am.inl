@@ -4,11 +4,22 @@
  * See file LICENSE for terms.
  */
 
-#include <ucp/core/ucp_context.h>
+#include "proto.h"
 
+#include <ucp/core/ucp_mm.h>
 
-typedef void (*ucp_req_complete_func_t)(ucp_request_t *req);
 
+/*
+ * Data to send with zcopy from a contiguous buffer: the bounce buffer which it
+ * was copied to, or the user buffer itself, if it was registered.
+ */
+static UCS_F_ALWAYS_INLINE const void*
+ucp_do_am_zcopy_buffer(ucp_request_t *req)
+{
+    ucp_bounce_desc_t *bounce = req->send.state.dt.contig.bounce;
+
+    return (bounce != NULL) ? (const void*)(bounce + 1) : req->send.buffer;
+}
 
 static UCS_F_ALWAYS_INLINE ucs_status_t
 ucp_do_am_bcopy_single(uct_pending_req_t *self, uint8_t am_id,
@@ -86,7 +97,8 @@ ucp_do_am_zcopy_single(uct_pending_req_t *self, uint8_t am_id, const void *hdr,
 
     /* TODO fix UCT api to have header ptr as const */
     status = uct_ep_am_zcopy(ep->uct_eps[UCP_EP_OP_AM], am_id, (void*)hdr,
-                             hdr_size, req->send.buffer, req->send.length,
+                             hdr_size, ucp_do_am_zcopy_buffer(req),
+                             req->send.length,
                              req->send.state.dt.contig.memh, &req->send.uct_comp);
     if (status == UCS_OK) {
         complete(req);
@@ -118,7 +130,7 @@ ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
         length = max_middle - hdr_size_first + hdr_size_middle;
         status = uct_ep_am_zcopy(ep->uct_eps[UCP_EP_OP_AM], am_id_first,
                                  (void*)hdr_first, hdr_size_first,
-                                 req->send.buffer, length,
+                                 ucp_do_am_zcopy_buffer(req), length,
                                  req->send.state.dt.contig.memh,
                                  &req->send.uct_comp);
         if (status < 0) {
@@ -131,7 +143,8 @@ ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
         /* Middle */
         status = uct_ep_am_zcopy(ep->uct_eps[UCP_EP_OP_AM], am_id_middle,
                                  (void*)hdr_middle, hdr_size_middle,
-                                 req->send.buffer + offset, max_middle,
+                                 ucp_do_am_zcopy_buffer(req) + offset,
+                                 max_middle,
                                  req->send.state.dt.contig.memh,
                                  &req->send.uct_comp);
         if (status < 0) {
@@ -145,7 +158,7 @@ ucp_do_am_zcopy_multi(uct_pending_req_t *self, uint8_t am_id_first,
         length = req->send.length - offset;
         status = uct_ep_am_zcopy(ep->uct_eps[UCP_EP_OP_AM], am_id_last,
                                  (void*)hdr_middle, hdr_size_middle,
-                                 req->send.buffer + offset, length,
+                                 ucp_do_am_zcopy_buffer(req) + offset, length,
                                  req->send.state.dt.contig.memh,
                                  &req->send.uct_comp);
         if (status < 0) {
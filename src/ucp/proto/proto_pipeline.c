@@ -0,0 +1,283 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "proto.h"
+
+#include <ucp/core/ucp_mm.h>
+#include <ucp/core/ucp_request.inl>
+#include <ucs/debug/memtrack.h>
+
+
+enum {
+    UCP_PROTO_PIPELINE_FRAG_FREE,     /* Staging buffer can be packed */
+    UCP_PROTO_PIPELINE_FRAG_PACKED,   /* Holds data which was not sent yet */
+    UCP_PROTO_PIPELINE_FRAG_INFLIGHT  /* Being sent by the transport */
+};
+
+
+typedef struct ucp_proto_pipeline ucp_proto_pipeline_t;
+
+
+typedef struct ucp_proto_pipeline_frag {
+    uct_completion_t          comp;       /* Send completion */
+    ucp_proto_pipeline_t      *pipeline;  /* Pipeline this fragment belongs to */
+    ucp_bounce_desc_t         *buf;       /* Registered staging buffer */
+    size_t                    length;     /* Packed data length */
+    int                       state;      /* Staging buffer state */
+} ucp_proto_pipeline_frag_t;
+
+
+struct ucp_proto_pipeline {
+    ucp_request_t             *req;       /* Request being sent */
+    ucp_req_complete_func_t   complete;   /* Called when all data was sent */
+    ucs_status_t              status;     /* First send error */
+    int                       posted;     /* No more fragments will be posted */
+    size_t                    frag_size;  /* Size of a single staging buffer */
+    size_t                    sent;       /* Amount of data posted to transport */
+    unsigned                  depth;      /* Number of staging buffers */
+    unsigned                  pack_index; /* Next staging buffer to pack */
+    unsigned                  send_index; /* Next staging buffer to send */
+    unsigned                  inflight;   /* Number of fragments being sent */
+    ucp_proto_pipeline_frag_t frags[0];
+};
+
+
+static void ucp_proto_pipeline_destroy(ucp_proto_pipeline_t *pipeline)
+{
+    unsigned i;
+
+    for (i = 0; i < pipeline->depth; ++i) {
+        ucs_mpool_put(pipeline->frags[i].buf);
+    }
+    ucs_free(pipeline);
+}
+
+/*
+ * Called when the last fragment was posted and all fragments were completed.
+ * Completes the request with the first error, if a fragment failed.
+ */
+static void ucp_proto_pipeline_finish(ucp_proto_pipeline_t *pipeline)
+{
+    ucp_request_t *req               = pipeline->req;
+    ucp_req_complete_func_t complete = pipeline->complete;
+    ucs_status_t status              = pipeline->status;
+
+    req->send.state.dt.generic.pipeline = NULL;
+    ucp_proto_pipeline_destroy(pipeline);
+
+    if (status == UCS_OK) {
+        complete(req);
+    } else {
+        ucs_trace_req("req %p: send pipeline failed: %s", req,
+                      ucs_status_string(status));
+        ucp_request_generic_dt_finish(req);
+        ucp_request_complete(req, req->cb.send, status);
+    }
+}
+
+static void ucp_proto_pipeline_frag_completion(uct_completion_t *self,
+                                               ucs_status_t status)
+{
+    ucp_proto_pipeline_frag_t *frag = ucs_container_of(self,
+                                                       ucp_proto_pipeline_frag_t,
+                                                       comp);
+    ucp_proto_pipeline_t *pipeline = frag->pipeline;
+
+    ucs_assert(frag->state == UCP_PROTO_PIPELINE_FRAG_INFLIGHT);
+    frag->state = UCP_PROTO_PIPELINE_FRAG_FREE;
+    --pipeline->inflight;
+
+    if ((status != UCS_OK) && (pipeline->status == UCS_OK)) {
+        pipeline->status = status;
+    }
+
+    if ((pipeline->inflight == 0) && pipeline->posted) {
+        ucp_proto_pipeline_finish(pipeline);
+    }
+}
+
+/*
+ * Pack up to 'max_frags' fragments into free staging buffers, in ring order.
+ */
+static void ucp_proto_pipeline_pack(ucp_proto_pipeline_t *pipeline,
+                                    unsigned max_frags)
+{
+    ucp_request_t *req = pipeline->req;
+    ucp_proto_pipeline_frag_t *frag;
+    size_t length;
+
+    while ((max_frags > 0) && (req->send.state.offset < req->send.length)) {
+        frag = &pipeline->frags[pipeline->pack_index];
+        if (frag->state != UCP_PROTO_PIPELINE_FRAG_FREE) {
+            break;
+        }
+
+        length       = ucs_min(pipeline->frag_size,
+                               req->send.length - req->send.state.offset);
+        frag->length = ucp_request_generic_dt_pack(req, frag->buf + 1, length);
+        ucs_assertv(frag->length == length, "length=%zu, packed=%zu", length,
+                    frag->length);
+
+        req->send.state.offset += frag->length;
+        frag->state             = UCP_PROTO_PIPELINE_FRAG_PACKED;
+        pipeline->pack_index    = (pipeline->pack_index + 1) % pipeline->depth;
+        --max_frags;
+    }
+}
+
+ucs_status_t ucp_proto_pipeline_init(ucp_request_t *req, size_t frag_size,
+                                     unsigned depth)
+{
+    ucp_worker_h worker      = req->send.ep->worker;
+    ucp_rsc_index_t pd_index = ucp_ep_pd_index(req->send.ep, UCP_EP_OP_AM);
+    ucp_proto_pipeline_t *pipeline;
+    ucp_bounce_desc_t *buf;
+    unsigned i;
+
+    frag_size = ucs_min(frag_size,
+                        worker->context->config.ext.generic_pipeline_frag_size);
+
+    /* Don't take more staging buffers than fragments */
+    depth = ucs_min(depth, (req->send.length + frag_size - 1) / frag_size);
+
+    pipeline = ucs_malloc(sizeof(*pipeline) + depth * sizeof(*pipeline->frags),
+                          "ucp_proto_pipeline");
+    if (pipeline == NULL) {
+        ucs_error("failed to allocate send pipeline");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* Use as many staging buffers as available, up to 'depth' */
+    for (i = 0; i < depth; ++i) {
+        buf = ucp_worker_staging_get(worker, pd_index);
+        if (buf == NULL) {
+            break;
+        }
+
+        pipeline->frags[i].comp.func = ucp_proto_pipeline_frag_completion;
+        pipeline->frags[i].pipeline  = pipeline;
+        pipeline->frags[i].buf       = buf;
+        pipeline->frags[i].state     = UCP_PROTO_PIPELINE_FRAG_FREE;
+    }
+
+    if (i == 0) {
+        ucs_free(pipeline);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    pipeline->req        = req;
+    pipeline->complete   = NULL;
+    pipeline->status     = UCS_OK;
+    pipeline->posted     = 0;
+    pipeline->frag_size  = frag_size;
+    pipeline->sent       = 0;
+    pipeline->depth      = i;
+    pipeline->pack_index = 0;
+    pipeline->send_index = 0;
+    pipeline->inflight   = 0;
+
+    ucs_trace_req("req %p: send pipeline of %u x %zu bytes", req,
+                  pipeline->depth, frag_size);
+    req->send.state.dt.generic.pipeline = pipeline;
+    return UCS_OK;
+}
+
+void ucp_proto_pipeline_cleanup(ucp_request_t *req)
+{
+    ucp_proto_pipeline_t *pipeline = req->send.state.dt.generic.pipeline;
+
+    ucs_assert(pipeline->inflight == 0);
+    req->send.state.dt.generic.pipeline = NULL;
+    ucp_proto_pipeline_destroy(pipeline);
+}
+
+ucs_status_t ucp_proto_pipeline_progress(uct_pending_req_t *self,
+                                         uint8_t am_id_first,
+                                         uint8_t am_id_middle,
+                                         uint8_t am_id_last,
+                                         const void *hdr_first,
+                                         size_t hdr_size_first,
+                                         const void *hdr_middle,
+                                         size_t hdr_size_middle,
+                                         ucp_req_complete_func_t complete)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_proto_pipeline_t *pipeline = req->send.state.dt.generic.pipeline;
+    ucp_ep_t *ep = req->send.ep;
+    ucp_proto_pipeline_frag_t *frag;
+    const void *hdr;
+    ucs_status_t status;
+    size_t hdr_size;
+    uint8_t am_id;
+    int last;
+
+    pipeline->complete = complete;
+
+    if (pipeline->status != UCS_OK) {
+        /* A fragment failed, don't send the rest of the message */
+        goto out_posted;
+    }
+
+    /* Make sure the next fragment is ready, if it was not packed ahead */
+    ucp_proto_pipeline_pack(pipeline, 1);
+
+    frag = &pipeline->frags[pipeline->send_index];
+    if (frag->state != UCP_PROTO_PIPELINE_FRAG_PACKED) {
+        /* All staging buffers are being sent, wait for a completion */
+        return UCS_INPROGRESS;
+    }
+
+    last = (pipeline->sent + frag->length == req->send.length);
+    if (pipeline->sent == 0) {
+        am_id    = am_id_first;
+        hdr      = hdr_first;
+        hdr_size = hdr_size_first;
+    } else {
+        am_id    = last ? am_id_last : am_id_middle;
+        hdr      = hdr_middle;
+        hdr_size = hdr_size_middle;
+    }
+
+    frag->comp.count = 1;
+    status = uct_ep_am_zcopy(ep->uct_eps[UCP_EP_OP_AM], am_id, (void*)hdr,
+                             hdr_size, frag->buf + 1, frag->length,
+                             frag->buf->memh, &frag->comp);
+    if (status == UCS_ERR_NO_RESOURCE) {
+        /* Use the time until the transport has resources to pack ahead */
+        ucp_proto_pipeline_pack(pipeline, pipeline->depth);
+        return status;
+    } else if (status < 0) {
+        pipeline->status = status;
+        goto out_posted;
+    }
+
+    frag->state           = UCP_PROTO_PIPELINE_FRAG_INFLIGHT;
+    pipeline->sent       += frag->length;
+    pipeline->send_index  = (pipeline->send_index + 1) % pipeline->depth;
+    ++pipeline->inflight;
+
+    if (status == UCS_OK) {
+        /* Completed in place */
+        ucp_proto_pipeline_frag_completion(&frag->comp, UCS_OK);
+    } else {
+        ucs_assert(status == UCS_INPROGRESS);
+    }
+
+    if (!last) {
+        /* Pack the following fragments while this one is on the wire */
+        ucp_proto_pipeline_pack(pipeline, pipeline->depth);
+        return UCS_INPROGRESS;
+    }
+
+out_posted:
+    /* The request leaves the pending queue, and is completed by the last
+     * fragment completion, may be right here */
+    pipeline->posted = 1;
+    if (pipeline->inflight == 0) {
+        ucp_proto_pipeline_finish(pipeline);
+    }
+    return UCS_OK;
+}
@@ -137,6 +137,7 @@ void ucp_add_pending_rma(ucp_request_t *req, ucp_ep_h ep, const void *buffer,
                          uct_pending_callback_t cb)
 {
     req->send.ep = ep;
+    req->send.prio = UCP_REQUEST_PRIO_BULK;
     req->send.buffer = buffer;
     req->send.length = length;
     req->send.rma.remote_addr = remote_addr;
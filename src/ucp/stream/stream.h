@@ -0,0 +1,32 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCP_STREAM_H_
+#define UCP_STREAM_H_
+
+#include <ucp/api/ucp.h>
+#include <ucp/core/ucp_request.h>
+#include <ucp/proto/proto.h>
+
+
+/*
+ * STREAM_DATA
+ * Every fragment is self-contained and identifies the sending worker, so the
+ * receiver could append it to the byte stream of the matching endpoint.
+ */
+typedef union {
+    struct {
+        uint64_t              sender_uuid;   /* Sending worker uuid */
+    };
+    uint64_t                  u64;           /* For am_short */
+} UCS_S_PACKED ucp_stream_am_hdr_t;
+
+
+void ucp_stream_ep_init(ucp_ep_h ep);
+
+void ucp_stream_ep_cleanup(ucp_ep_h ep);
+
+#endif
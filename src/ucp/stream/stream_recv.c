@@ -0,0 +1,264 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "stream.h"
+
+#include <ucp/core/ucp_context.h>
+#include <ucp/core/ucp_ep.h>
+#include <ucp/core/ucp_worker.h>
+#include <ucp/dt/dt_contig.h>
+#include <ucp/dt/dt_generic.h>
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/datastruct/queue.h>
+#include <string.h>
+
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_stream_recv_unpack(ucp_request_t *req, const void *data, size_t length)
+{
+    size_t offset = req->recv.state.offset;
+    ucp_dt_generic_t *dt_gen;
+
+    length = ucs_min(length, req->recv.stream.length - offset);
+    if ((req->recv.datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG) {
+        memcpy(req->recv.buffer + offset, data, length);
+    } else {
+        dt_gen = ucp_dt_generic(req->recv.datatype);
+        dt_gen->ops.unpack(req->recv.state.dt.generic.state, offset, data,
+                           length);
+    }
+
+    req->recv.state.offset += length;
+    return length;
+}
+
+static UCS_F_ALWAYS_INLINE int ucp_stream_recv_is_done(ucp_request_t *req)
+{
+    if (req->recv.stream.flags & UCP_STREAM_RECV_FLAG_WAITALL) {
+        return req->recv.state.offset == req->recv.stream.length;
+    } else {
+        return (req->recv.state.offset > 0) ||
+               (req->recv.stream.length == 0);
+    }
+}
+
+static UCS_F_ALWAYS_INLINE void ucp_stream_recv_dt_finish(ucp_request_t *req)
+{
+    ucp_dt_generic_t *dt_gen;
+
+    if ((req->recv.datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_GENERIC) {
+        dt_gen = ucp_dt_generic(req->recv.datatype);
+        dt_gen->ops.finish(req->recv.state.dt.generic.state);
+    }
+}
+
+static void ucp_stream_recv_complete(ucp_request_t *req, ucs_status_t status)
+{
+    ucs_trace_req("completing stream receive request %p length %zu %s", req,
+                  req->recv.state.offset, ucs_status_string(status));
+    ucp_stream_recv_dt_finish(req);
+    ucp_request_complete(req, req->cb.stream_recv, status,
+                         req->recv.state.offset);
+}
+
+static void ucp_stream_rdesc_release(ucp_recv_desc_t *rdesc)
+{
+    ucs_trace_req("release stream descriptor %p", rdesc);
+    uct_iface_release_am_desc(rdesc);
+}
+
+/*
+ * Consume data which was already received on the endpoint into the request.
+ * The first descriptor in the queue may be partially consumed by previous
+ * receives, so ep->stream.offset tracks the position of its remaining data.
+ */
+static void ucp_stream_process_data(ucp_ep_h ep, ucp_request_t *req)
+{
+    ucp_recv_desc_t *rdesc;
+    size_t length;
+    void *data;
+
+    while (!ucs_queue_is_empty(&ep->stream.data) &&
+           (req->recv.state.offset < req->recv.stream.length))
+    {
+        rdesc  = ucs_queue_head_elem_non_empty(&ep->stream.data,
+                                               ucp_recv_desc_t, queue);
+        data   = (void*)(rdesc + 1) + rdesc->hdr_len + ep->stream.offset;
+        length = rdesc->length - rdesc->hdr_len - ep->stream.offset;
+
+        ep->stream.offset += ucp_stream_recv_unpack(req, data, length);
+        if (ep->stream.offset == rdesc->length - rdesc->hdr_len) {
+            ucs_queue_pull_non_empty(&ep->stream.data);
+            ep->stream.offset = 0;
+            ucp_stream_rdesc_release(rdesc);
+        }
+    }
+}
+
+ucs_status_ptr_t ucp_stream_recv_nb(ucp_ep_h ep, void *buffer, size_t count,
+                                    ucp_datatype_t datatype,
+                                    ucp_stream_recv_callback_t cb,
+                                    size_t *length, unsigned flags)
+{
+    ucp_worker_h worker = ep->worker;
+    ucp_dt_generic_t *dt_gen;
+    ucp_request_t *req;
+
+    ucs_trace_req("stream_recv_nb buffer %p count %zu from %s flags 0x%x",
+                  buffer, count, ucp_ep_peer_name(ep), flags);
+
+    req = ucs_mpool_get_inline(&worker->req_mp);
+    if (req == NULL) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+    }
+
+    VALGRIND_MAKE_MEM_DEFINED(req + 1,  worker->context->config.request.size);
+
+    req->flags              = 0;
+    req->cb.stream_recv     = cb;
+    req->recv.buffer        = buffer;
+    req->recv.count         = count;
+    req->recv.datatype      = datatype;
+    req->recv.state.offset  = 0;
+    req->recv.stream.flags  = flags;
+
+    switch (datatype & UCP_DATATYPE_CLASS_MASK) {
+    case UCP_DATATYPE_CONTIG:
+        req->recv.stream.length = ucp_contig_dt_length(datatype, count);
+        break;
+    case UCP_DATATYPE_GENERIC:
+        dt_gen = ucp_dt_generic(datatype);
+        req->recv.state.dt.generic.state = dt_gen->ops.start_unpack(dt_gen->context,
+                                                                    buffer, count);
+        req->recv.stream.length = dt_gen->ops.packed_size(req->recv.state.dt.generic.state);
+        break;
+    default:
+        ucs_error("Invalid data type");
+        ucs_mpool_put(req);
+        return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
+    }
+
+    /* Received data may be consumed only if no earlier receive is waiting for
+     * it, otherwise the byte order would break */
+    if (ucs_queue_is_empty(&ep->stream.reqs)) {
+        ucp_stream_process_data(ep, req);
+        if (ucp_stream_recv_is_done(req)) {
+            ucs_trace_req("stream_recv_nb completed immediately, length %zu",
+                          req->recv.state.offset);
+            *length = req->recv.state.offset;
+            ucp_stream_recv_dt_finish(req);
+            ucs_mpool_put(req);
+            return NULL;
+        }
+    }
+
+    ucs_assert(ucs_queue_is_empty(&ep->stream.data));
+    ucs_queue_push(&ep->stream.reqs, &req->recv.queue);
+    ucp_worker_progress(worker);
+    ucs_trace_req("stream_recv_nb returning request %p (%p)", req, req + 1);
+    return req + 1;
+}
+
+void ucp_stream_ep_init(ucp_ep_h ep)
+{
+    ucs_queue_head_init(&ep->stream.data);
+    ucs_queue_head_init(&ep->stream.reqs);
+    ep->stream.offset = 0;
+}
+
+void ucp_stream_ep_cleanup(ucp_ep_h ep)
+{
+    ucp_recv_desc_t *rdesc;
+    ucp_request_t *req;
+
+    while (!ucs_queue_is_empty(&ep->stream.data)) {
+        rdesc = ucs_queue_pull_elem_non_empty(&ep->stream.data,
+                                              ucp_recv_desc_t, queue);
+        ucp_stream_rdesc_release(rdesc);
+    }
+
+    while (!ucs_queue_is_empty(&ep->stream.reqs)) {
+        req = ucs_queue_pull_elem_non_empty(&ep->stream.reqs, ucp_request_t,
+                                            recv.queue);
+        ucp_stream_recv_complete(req, UCS_ERR_CANCELED);
+    }
+}
+
+static ucs_status_t ucp_stream_data_handler(void *arg, void *data,
+                                            size_t length, void *desc)
+{
+    ucp_worker_h worker = arg;
+    ucp_stream_am_hdr_t *hdr = data;
+    ucp_recv_desc_t *rdesc = desc;
+    size_t recv_len, consumed;
+    ucp_request_t *req;
+    ucp_ep_h ep;
+
+    ep = ucp_worker_ep_find(worker, hdr->sender_uuid);
+    if (ucs_unlikely(ep == NULL)) {
+        ucs_error("worker %p: no endpoint for stream data from uuid 0x%"PRIx64
+                  ", dropping it", worker, hdr->sender_uuid);
+        return UCS_OK;
+    }
+
+    ucs_assert(length >= sizeof(*hdr));
+    recv_len = length - sizeof(*hdr);
+    consumed = 0;
+
+    /* Pass the data to posted receives. There is no pending data in this case,
+     * because a posted receive would have consumed it. */
+    while ((consumed < recv_len) && !ucs_queue_is_empty(&ep->stream.reqs)) {
+        ucs_assert(ucs_queue_is_empty(&ep->stream.data));
+        req = ucs_queue_head_elem_non_empty(&ep->stream.reqs, ucp_request_t,
+                                            recv.queue);
+        consumed += ucp_stream_recv_unpack(req, (void*)(hdr + 1) + consumed,
+                                           recv_len - consumed);
+        if (ucp_stream_recv_is_done(req)) {
+            ucs_queue_pull_non_empty(&ep->stream.reqs);
+            ucp_stream_recv_complete(req, UCS_OK);
+        }
+    }
+
+    if (consumed == recv_len) {
+        return UCS_OK;
+    }
+
+    /* Keep the rest of the data in the descriptor, until it's received */
+    if (data != rdesc + 1) {
+        memcpy(rdesc + 1, data, length);
+    }
+
+    rdesc->length  = length;
+    rdesc->hdr_len = sizeof(*hdr);
+    rdesc->flags   = 0;
+
+    if (ucs_queue_is_empty(&ep->stream.data)) {
+        ep->stream.offset = consumed;
+    } else {
+        ucs_assert(consumed == 0);
+    }
+
+    ucs_trace_req("stream data %zu bytes from %s kept in desc %p",
+                  recv_len - consumed, ucp_ep_peer_name(ep), rdesc);
+    ucs_queue_push(&ep->stream.data, &rdesc->queue);
+    return UCS_INPROGRESS;
+}
+
+static void ucp_stream_dump(ucp_worker_h worker, uct_am_trace_type_t type,
+                            uint8_t id, const void *data, size_t length,
+                            char *buffer, size_t max)
+{
+    const ucp_stream_am_hdr_t *hdr = data;
+    char *p;
+
+    snprintf(buffer, max, "STREAM uuid 0x%"PRIx64, hdr->sender_uuid);
+    p = buffer + strlen(buffer);
+    ucp_dump_payload(worker->context, p, buffer + max - p, data + sizeof(*hdr),
+                     length - sizeof(*hdr));
+}
+
+UCP_DEFINE_AM(UCP_FEATURE_STREAM, UCP_AM_ID_STREAM_DATA, ucp_stream_data_handler,
+              ucp_stream_dump, UCT_AM_CB_FLAG_SYNC);
@@ -0,0 +1,318 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "stream.h"
+
+#include <ucp/core/ucp_ep.h>
+#include <ucp/core/ucp_worker.h>
+#include <ucp/core/ucp_request.inl>
+#include <ucp/dt/dt_contig.h>
+#include <ucp/dt/dt_generic.h>
+#include <ucp/proto/proto_am.inl>
+#include <ucs/datastruct/mpool.inl>
+#include <string.h>
+
+
+static UCS_F_ALWAYS_INLINE size_t
+ucp_stream_frag_length(ucp_request_t *req, size_t max_frag)
+{
+    return ucs_min(req->send.length - req->send.state.offset, max_frag);
+}
+
+/* packing  start */
+
+static size_t ucp_stream_pack_contig(void *dest, void *arg)
+{
+    ucp_stream_am_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t length;
+
+    length = ucp_stream_frag_length(req, ucp_ep_config(req->send.ep)->max_am_bcopy -
+                                         sizeof(*hdr));
+    hdr->sender_uuid = req->send.ep->worker->uuid;
+    memcpy(hdr + 1, req->send.buffer + req->send.state.offset, length);
+    return sizeof(*hdr) + length;
+}
+
+static size_t ucp_stream_pack_generic(void *dest, void *arg)
+{
+    ucp_stream_am_hdr_t *hdr = dest;
+    ucp_request_t *req = arg;
+    size_t max_length, length;
+
+    max_length = ucp_stream_frag_length(req, ucp_ep_config(req->send.ep)->max_am_bcopy -
+                                             sizeof(*hdr));
+    hdr->sender_uuid = req->send.ep->worker->uuid;
+    length = ucp_request_generic_dt_pack(req, hdr + 1, max_length);
+    ucs_assertv(length == max_length, "length=%zu, max_length=%zu",
+                length, max_length);
+    return sizeof(*hdr) + length;
+}
+
+/* progress */
+
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_stream_send_short(ucp_ep_h ep, const void *buffer, size_t length)
+{
+    ucp_stream_am_hdr_t hdr;
+
+    UCS_STATIC_ASSERT(sizeof(ucp_stream_am_hdr_t) == sizeof(uint64_t));
+    hdr.sender_uuid = ep->worker->uuid;
+    return uct_ep_am_short(ep->uct_eps[UCP_EP_OP_AM], UCP_AM_ID_STREAM_DATA,
+                           hdr.u64, buffer, length);
+}
+
+static ucs_status_t ucp_stream_contig_short(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucs_status_t status;
+
+    status = ucp_stream_send_short(req->send.ep, req->send.buffer,
+                                   req->send.length);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_stream_contig_bcopy_single(uct_pending_req_t *self)
+{
+    ucs_status_t status = ucp_do_am_bcopy_single(self, UCP_AM_ID_STREAM_DATA,
+                                                 ucp_stream_pack_contig);
+    if (status == UCS_OK) {
+        ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+        ucp_request_complete(req, req->cb.send, UCS_OK);
+    }
+    return status;
+}
+
+static ucs_status_t ucp_stream_contig_bcopy_multi(uct_pending_req_t *self)
+{
+    ucs_status_t status = ucp_do_am_bcopy_multi(self,
+                                                UCP_AM_ID_STREAM_DATA,
+                                                UCP_AM_ID_STREAM_DATA,
+                                                UCP_AM_ID_STREAM_DATA,
+                                                sizeof(ucp_stream_am_hdr_t),
+                                                sizeof(ucp_stream_am_hdr_t),
+                                                ucp_stream_pack_contig,
+                                                ucp_stream_pack_contig,
+                                                ucp_stream_pack_contig);
+    if (status == UCS_OK) {
+        ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+        ucp_request_complete(req, req->cb.send, UCS_OK);
+    }
+    return status;
+}
+
+static void ucp_stream_contig_zcopy_req_complete(ucp_request_t *req)
+{
+    ucp_request_send_buffer_dereg(req, UCP_EP_OP_AM);
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+}
+
+static ucs_status_t ucp_stream_contig_zcopy_single(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_stream_am_hdr_t hdr;
+
+    hdr.sender_uuid = req->send.ep->worker->uuid;
+    return ucp_do_am_zcopy_single(self, UCP_AM_ID_STREAM_DATA, &hdr, sizeof(hdr),
+                                  ucp_stream_contig_zcopy_req_complete);
+}
+
+static ucs_status_t ucp_stream_contig_zcopy_multi(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_stream_am_hdr_t hdr;
+
+    hdr.sender_uuid = req->send.ep->worker->uuid;
+    return ucp_do_am_zcopy_multi(self,
+                                 UCP_AM_ID_STREAM_DATA,
+                                 UCP_AM_ID_STREAM_DATA,
+                                 UCP_AM_ID_STREAM_DATA,
+                                 &hdr, sizeof(hdr),
+                                 &hdr, sizeof(hdr),
+                                 ucp_stream_contig_zcopy_req_complete);
+}
+
+static void ucp_stream_contig_zcopy_completion(uct_completion_t *self,
+                                               ucs_status_t status)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct_comp);
+    ucp_stream_contig_zcopy_req_complete(req);
+}
+
+static void ucp_stream_generic_complete(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_request_generic_dt_finish(req);
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+}
+
+static ucs_status_t ucp_stream_generic_single(uct_pending_req_t *self)
+{
+    ucs_status_t status;
+
+    status = ucp_do_am_bcopy_single(self, UCP_AM_ID_STREAM_DATA,
+                                    ucp_stream_pack_generic);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ucp_stream_generic_complete(self);
+    return UCS_OK;
+}
+
+static ucs_status_t ucp_stream_generic_multi(uct_pending_req_t *self)
+{
+    ucs_status_t status;
+
+    status = ucp_do_am_bcopy_multi(self,
+                                   UCP_AM_ID_STREAM_DATA,
+                                   UCP_AM_ID_STREAM_DATA,
+                                   UCP_AM_ID_STREAM_DATA,
+                                   sizeof(ucp_stream_am_hdr_t),
+                                   sizeof(ucp_stream_am_hdr_t),
+                                   ucp_stream_pack_generic,
+                                   ucp_stream_pack_generic,
+                                   ucp_stream_pack_generic);
+    if (status == UCS_OK) {
+        ucp_stream_generic_complete(self);
+    }
+    return status;
+}
+
+/* protocol selection */
+
+static ucs_status_t ucp_stream_req_start_contig(ucp_request_t *req, size_t count)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    size_t hdr_size         = sizeof(ucp_stream_am_hdr_t);
+    ucs_status_t status;
+    size_t length;
+
+    length           = ucp_contig_dt_length(req->send.datatype, count);
+    req->send.length = length;
+
+    if (length <= config->max_am_short) {
+        /* short */
+        req->send.uct.func = ucp_stream_contig_short;
+    } else if ((length < config->zcopy_thresh) ||
+               (hdr_size >= config->max_am_zcopy) ||
+               (hdr_size > config->max_am_zcopy_hdr))
+    {
+        /* bcopy */
+        if (hdr_size + length <= config->max_am_bcopy) {
+            req->send.uct.func = ucp_stream_contig_bcopy_single;
+        } else {
+            req->send.uct.func = ucp_stream_contig_bcopy_multi;
+        }
+    } else {
+        /* zcopy */
+        status = ucp_request_send_buffer_reg(req, UCP_EP_OP_AM);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        req->send.uct_comp.func = ucp_stream_contig_zcopy_completion;
+
+        if (hdr_size + length <= config->max_am_zcopy) {
+            req->send.uct_comp.count = 1;
+            req->send.uct.func       = ucp_stream_contig_zcopy_single;
+        } else {
+            /* calculate number of zcopy fragments */
+            req->send.uct_comp.count = (length + config->max_am_zcopy -
+                                        hdr_size - 1) /
+                                       (config->max_am_zcopy - hdr_size);
+            req->send.uct.func       = ucp_stream_contig_zcopy_multi;
+        }
+    }
+    return UCS_OK;
+}
+
+static void ucp_stream_req_start_generic(ucp_request_t *req, size_t count)
+{
+    ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    ucp_dt_generic_t *dt_gen;
+    size_t length;
+    void *state;
+
+    dt_gen = ucp_dt_generic(req->send.datatype);
+    state  = dt_gen->ops.start_pack(dt_gen->context, req->send.buffer, count);
+
+    req->send.state.dt.generic.state    = state;
+    req->send.state.dt.generic.pipeline = NULL;
+    req->send.length = length = dt_gen->ops.packed_size(state);
+
+    if (sizeof(ucp_stream_am_hdr_t) + length <= config->max_am_bcopy) {
+        req->send.uct.func = ucp_stream_generic_single;
+    } else {
+        req->send.uct.func = ucp_stream_generic_multi;
+    }
+}
+
+ucs_status_ptr_t ucp_stream_send_nb(ucp_ep_h ep, const void *buffer,
+                                    size_t count, ucp_datatype_t datatype,
+                                    ucp_send_callback_t cb)
+{
+    ucs_status_t status;
+    ucp_request_t *req;
+    size_t length;
+
+    ucs_trace_req("stream_send_nb buffer %p count %zu to %s cb %p", buffer,
+                  count, ucp_ep_peer_name(ep), cb);
+
+    if (ucs_likely((datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG)) {
+        length = ucp_contig_dt_length(datatype, count);
+        if (length == 0) {
+            return UCS_STATUS_PTR(UCS_OK);
+        }
+
+        if (ucs_likely(length <= ucp_ep_config(ep)->max_am_short)) {
+            status = ucp_stream_send_short(ep, buffer, length);
+            if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+                return UCS_STATUS_PTR(status); /* UCS_OK also goes here */
+            }
+        }
+    }
+
+    req = ucs_mpool_get_inline(&ep->worker->req_mp);
+    if (req == NULL) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+    }
+
+    ucp_send_req_init(req, ep);
+    req->cb.send           = cb;
+    req->send.buffer       = buffer;
+    req->send.datatype     = datatype;
+    req->send.state.offset = 0;
+
+    switch (datatype & UCP_DATATYPE_CLASS_MASK) {
+    case UCP_DATATYPE_CONTIG:
+        status = ucp_stream_req_start_contig(req, count);
+        break;
+    case UCP_DATATYPE_GENERIC:
+        ucp_stream_req_start_generic(req, count);
+        status = UCS_OK;
+        break;
+    default:
+        ucs_error("Invalid data type");
+        status = UCS_ERR_INVALID_PARAM;
+        break;
+    }
+
+    if (status != UCS_OK) {
+        ucs_mpool_put(req);
+        return UCS_STATUS_PTR(status);
+    }
+
+    ucp_ep_add_pending(ep, ep->uct_eps[UCP_EP_OP_AM], req, 1);
+    ucp_worker_progress(ep->worker);
+    ucs_trace_req("returning stream send request %p", req);
+    return req + 1;
+}
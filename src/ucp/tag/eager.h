@@ -57,6 +57,10 @@ extern const ucp_proto_t ucp_tag_eager_sync_proto;
 void ucp_tag_eager_sync_send_ack(ucp_worker_h worker, uint64_t sender_uuid,
                                  uintptr_t remote_request, int progress);
 
+void ucp_tag_eager_sync_flush_acks(ucp_worker_h worker);
+
+void ucp_tag_eager_sync_ep_cleanup(ucp_ep_h ep);
+
 void ucp_tag_eager_sync_completion(ucp_request_t *req, uint16_t flag);
 
 
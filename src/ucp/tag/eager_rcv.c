@@ -10,6 +10,7 @@
 #include <ucp/core/ucp_context.h>
 #include <ucp/core/ucp_worker.h>
 #include <ucs/datastruct/queue.h>
+#include <string.h>
 
 
 static UCS_F_ALWAYS_INLINE ucs_status_t
@@ -161,10 +162,19 @@ static ucs_status_t ucp_eager_sync_ack_handler(void *arg, void *data,
                                                size_t length, void *desc)
 {
     ucp_reply_hdr_t *rep_hdr = data;
-    ucp_request_t *req;
-
-    req = (ucp_request_t*)rep_hdr->reqptr;
-    ucp_tag_eager_sync_completion(req, UCP_REQUEST_FLAG_REMOTE_COMPLETED);
+    uint64_t reqptr;
+    void *p;
+
+    reqptr = rep_hdr->reqptr;
+    ucp_tag_eager_sync_completion((ucp_request_t*)reqptr,
+                                  UCP_REQUEST_FLAG_REMOTE_COMPLETED);
+
+    /* Acknowledgments which were batched with the first one */
+    for (p = rep_hdr + 1; p < data + length; p += sizeof(reqptr)) {
+        memcpy(&reqptr, p, sizeof(reqptr));
+        ucp_tag_eager_sync_completion((ucp_request_t*)reqptr,
+                                      UCP_REQUEST_FLAG_REMOTE_COMPLETED);
+    }
     return UCS_OK;
 }
 
@@ -213,10 +223,10 @@ static void ucp_eager_dump(ucp_worker_h worker, uct_am_trace_type_t type,
         header_len = sizeof(*eagers_first_hdr);
         break;
     case UCP_AM_ID_EAGER_SYNC_ACK:
-        snprintf(buffer, max, "EGRS_A request 0x%lx status '%s'", rep_hdr->reqptr,
-                 ucs_status_string(rep_hdr->status));
-        header_len = sizeof(*rep_hdr);
-        break;
+        snprintf(buffer, max, "EGRS_A request 0x%lx status '%s' count %zu",
+                 rep_hdr->reqptr, ucs_status_string(rep_hdr->status),
+                 1 + (length - sizeof(*rep_hdr)) / sizeof(uint64_t));
+        return;
     default:
         return;
     }
@@ -284,6 +284,12 @@ static void ucp_tag_eager_generic_complere(uct_pending_req_t *self)
     ucp_request_complete(req, req->cb.send, UCS_OK);
 }
 
+static void ucp_tag_eager_generic_pipeline_complete(ucp_request_t *req)
+{
+    ucp_request_generic_dt_finish(req);
+    ucp_request_complete(req, req->cb.send, UCS_OK);
+}
+
 static ucs_status_t ucp_tag_eager_generic_single(uct_pending_req_t *self)
 {
     ucs_status_t status;
@@ -315,6 +321,22 @@ static ucs_status_t ucp_tag_eager_generic_multi(uct_pending_req_t *self)
     return status;
 }
 
+static ucs_status_t ucp_tag_eager_generic_pipeline(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_eager_first_hdr_t first_hdr;
+
+    first_hdr.super.super.tag = req->send.tag;
+    first_hdr.total_len       = req->send.length;
+    return ucp_proto_pipeline_progress(self,
+                                       UCP_AM_ID_EAGER_FIRST,
+                                       UCP_AM_ID_EAGER_MIDDLE,
+                                       UCP_AM_ID_EAGER_LAST,
+                                       &first_hdr, sizeof(first_hdr),
+                                       &first_hdr.super, sizeof(first_hdr.super),
+                                       ucp_tag_eager_generic_pipeline_complete);
+}
+
 const ucp_proto_t ucp_tag_eager_proto = {
     .contig_short            = ucp_tag_eager_contig_short,
     .contig_bcopy_single     = ucp_tag_eager_contig_bcopy_single,
@@ -324,6 +346,7 @@ const ucp_proto_t ucp_tag_eager_proto = {
     .contig_zcopy_completion = ucp_tag_eager_contig_zcopy_completion,
     .generic_single          = ucp_tag_eager_generic_single,
     .generic_multi           = ucp_tag_eager_generic_multi,
+    .generic_pipeline        = ucp_tag_eager_generic_pipeline,
     .only_hdr_size           = sizeof(ucp_eager_hdr_t),
     .first_hdr_size          = sizeof(ucp_eager_first_hdr_t),
     .mid_hdr_size            = sizeof(ucp_eager_hdr_t)
@@ -453,6 +476,32 @@ static ucs_status_t ucp_tag_eager_sync_generic_multi(uct_pending_req_t *self)
     return status;
 }
 
+static void ucp_tag_eager_sync_generic_pipeline_complete(ucp_request_t *req)
+{
+    ucp_request_generic_dt_finish(req);
+    ucp_tag_eager_sync_completion(req, UCP_REQUEST_FLAG_LOCAL_COMPLETED);
+}
+
+static ucs_status_t ucp_tag_eager_sync_generic_pipeline(uct_pending_req_t *self)
+{
+    ucp_request_t *req = ucs_container_of(self, ucp_request_t, send.uct);
+    ucp_eager_sync_first_hdr_t first_hdr;
+
+    first_hdr.super.super.super.tag = req->send.tag;
+    first_hdr.super.total_len       = req->send.length;
+    first_hdr.req.sender_uuid       = req->send.ep->worker->uuid;
+    first_hdr.req.reqptr            = (uintptr_t)req;
+
+    return ucp_proto_pipeline_progress(self,
+                                       UCP_AM_ID_EAGER_SYNC_FIRST,
+                                       UCP_AM_ID_EAGER_MIDDLE,
+                                       UCP_AM_ID_EAGER_LAST,
+                                       &first_hdr, sizeof(first_hdr),
+                                       &first_hdr.super.super,
+                                       sizeof(first_hdr.super.super),
+                                       ucp_tag_eager_sync_generic_pipeline_complete);
+}
+
 const ucp_proto_t ucp_tag_eager_sync_proto = {
     .contig_short            = NULL,
     .contig_bcopy_single     = ucp_tag_eager_sync_contig_bcopy_single,
@@ -462,6 +511,7 @@ const ucp_proto_t ucp_tag_eager_sync_proto = {
     .contig_zcopy_completion = ucp_tag_eager_sync_contig_zcopy_completion,
     .generic_single          = ucp_tag_eager_sync_generic_single,
     .generic_multi           = ucp_tag_eager_sync_generic_multi,
+    .generic_pipeline        = ucp_tag_eager_sync_generic_pipeline,
     .only_hdr_size           = sizeof(ucp_eager_sync_hdr_t),
     .first_hdr_size          = sizeof(ucp_eager_sync_first_hdr_t),
     .mid_hdr_size            = sizeof(ucp_eager_hdr_t)
@@ -64,19 +64,11 @@ ucp_tag_search_unexp(ucp_worker_h worker, void *buffer, size_t count,
     return UCS_INPROGRESS;
 }
 
-static inline ucp_request_t*
-ucp_tag_recv_request_get(ucp_worker_h worker, void* buffer, size_t count,
-                         ucp_datatype_t datatype)
+static inline void
+ucp_tag_recv_request_init(ucp_request_t *req, ucp_worker_h worker, void* buffer,
+                          size_t count, ucp_datatype_t datatype)
 {
     ucp_dt_generic_t *dt_gen;
-    ucp_request_t *req;
-
-    req = ucs_mpool_get_inline(&worker->req_mp);
-    if (req == NULL) {
-        return NULL;
-    }
-
-    VALGRIND_MAKE_MEM_DEFINED(req + 1,  worker->context->config.request.size);
 
     req->flags             = UCP_REQUEST_FLAG_EXPECTED;
     req->recv.state.offset = 0;
@@ -90,25 +82,32 @@ ucp_tag_recv_request_get(ucp_worker_h worker, void* buffer, size_t count,
     if (ucs_log_enabled(UCS_LOG_LEVEL_TRACE_REQ)) {
         req->recv.info.sender_tag = 0;
     }
-
-    return req;
 }
 
-ucs_status_ptr_t ucp_tag_recv_nb(ucp_worker_h worker, void *buffer, size_t count,
-                                 uintptr_t datatype, ucp_tag_t tag, ucp_tag_t tag_mask,
-                                 ucp_tag_recv_callback_t cb)
+static inline ucp_request_t*
+ucp_tag_recv_request_get(ucp_worker_h worker, void* buffer, size_t count,
+                         ucp_datatype_t datatype)
 {
-    ucs_status_t status;
     ucp_request_t *req;
 
-    ucs_trace_req("recv_nb buffer %p count %zu tag %"PRIx64"/%"PRIx64, buffer,
-                  count, tag, tag_mask);
-
-    req = ucp_tag_recv_request_get(worker, buffer, count, datatype);
+    req = ucs_mpool_get_inline(&worker->req_mp);
     if (req == NULL) {
-        return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+        return NULL;
     }
 
+    VALGRIND_MAKE_MEM_DEFINED(req + 1,  worker->context->config.request.size);
+
+    ucp_tag_recv_request_init(req, worker, buffer, count, datatype);
+    return req;
+}
+
+static UCS_F_ALWAYS_INLINE void
+ucp_tag_recv_req_start(ucp_worker_h worker, ucp_request_t *req, void *buffer,
+                       size_t count, uintptr_t datatype, ucp_tag_t tag,
+                       ucp_tag_t tag_mask, ucp_tag_recv_callback_t cb)
+{
+    ucs_status_t status;
+
     /* First, search in unexpected list */
     status = ucp_tag_search_unexp(worker, buffer, count, datatype, tag,
                                   tag_mask, req, &req->recv.info);
@@ -127,10 +126,85 @@ ucs_status_ptr_t ucp_tag_recv_nb(ucp_worker_h worker, void *buffer, size_t count
         ucp_worker_progress(worker);
         ucs_trace_req("recv_nb returning expected request %p (%p)", req, req + 1);
     }
+}
 
+ucs_status_ptr_t ucp_tag_recv_nb(ucp_worker_h worker, void *buffer, size_t count,
+                                 uintptr_t datatype, ucp_tag_t tag, ucp_tag_t tag_mask,
+                                 ucp_tag_recv_callback_t cb)
+{
+    ucp_request_t *req;
+
+    ucs_trace_req("recv_nb buffer %p count %zu tag %"PRIx64"/%"PRIx64, buffer,
+                  count, tag, tag_mask);
+
+    req = ucp_tag_recv_request_get(worker, buffer, count, datatype);
+    if (req == NULL) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+    }
+
+    ucp_tag_recv_req_start(worker, req, buffer, count, datatype, tag, tag_mask,
+                           cb);
+    return req + 1;
+}
+
+ucs_status_ptr_t ucp_tag_recv_nbr(ucp_worker_h worker, void *buffer, size_t count,
+                                  uintptr_t datatype, ucp_tag_t tag,
+                                  ucp_tag_t tag_mask, ucp_tag_recv_callback_t cb,
+                                  void *req_storage)
+{
+    ucp_request_t *req = req_storage;
+
+    ucs_trace_req("recv_nbr buffer %p count %zu tag %"PRIx64"/%"PRIx64
+                  " storage %p", buffer, count, tag, tag_mask, req_storage);
+
+    ucp_tag_recv_request_init(req, worker, buffer, count, datatype);
+    req->flags |= UCP_REQUEST_FLAG_EXTERNAL;
+
+    ucp_tag_recv_req_start(worker, req, buffer, count, datatype, tag, tag_mask,
+                           cb);
     return req + 1;
 }
 
+ucs_status_t ucp_tag_recv_cq_nb(ucp_worker_h worker, void *buffer, size_t count,
+                                ucp_datatype_t datatype, ucp_tag_t tag,
+                                ucp_tag_t tag_mask, void *user_data)
+{
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    ucs_trace_req("recv_cq_nb buffer %p count %zu tag %"PRIx64"/%"PRIx64
+                  " user_data %p", buffer, count, tag, tag_mask, user_data);
+
+    req = ucp_tag_recv_request_get(worker, buffer, count, datatype);
+    if (req == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = ucp_worker_cq_reserve(worker);
+    if (status != UCS_OK) {
+        goto err_put_req;
+    }
+
+    status = ucp_request_ext_get(worker, req, UCP_REQUEST_FLAG_CQ);
+    if (status != UCS_OK) {
+        goto err_cq_unreserve;
+    }
+
+    /* The request is owned by the worker, and released once completed */
+    req->flags          |= UCP_REQUEST_FLAG_RELEASED;
+    req->ext->user_data  = user_data;
+
+    ucp_tag_recv_req_start(worker, req, buffer, count, datatype, tag, tag_mask,
+                           ucp_request_cq_recv_callback);
+    return UCS_INPROGRESS;
+
+err_cq_unreserve:
+    ucp_worker_cq_unreserve(worker);
+err_put_req:
+    ucs_mpool_put(req);
+    return status;
+}
+
 ucs_status_ptr_t ucp_tag_msg_recv_nb(ucp_worker_h worker, void *buffer,
                                      size_t count, ucp_datatype_t datatype,
                                      ucp_tag_message_h message,
@@ -37,7 +37,9 @@ static ucs_status_t ucp_tag_req_start_contig(ucp_request_t *req, size_t count,
     } else if (length >= rndv_thresh) {
         /* rendezvous */
         ucp_tag_send_start_rndv(req);
-    } else if (length < zcopy_thresh) {
+    } else if ((length < zcopy_thresh) ||
+               (proto->first_hdr_size > config->max_am_zcopy_hdr))
+    {
         /* bcopy */
         if (req->send.length <= config->max_am_bcopy - only_hdr_size) {
             req->send.uct.func = proto->contig_bcopy_single;
@@ -68,28 +70,65 @@ static ucs_status_t ucp_tag_req_start_contig(ucp_request_t *req, size_t count,
     return UCS_OK;
 }
 
-static void ucp_tag_req_start_generic(ucp_request_t *req, size_t count,
-                                      size_t rndv_thresh,
-                                      const ucp_proto_t *progress)
+static ucs_status_t ucp_tag_req_start_generic(ucp_request_t *req, size_t count,
+                                              size_t zcopy_thresh,
+                                              size_t rndv_thresh,
+                                              const ucp_proto_t *progress)
 {
+    ucp_context_h context   = req->send.ep->worker->context;
     ucp_ep_config_t *config = ucp_ep_config(req->send.ep);
+    unsigned depth          = context->config.ext.generic_pipeline_depth;
     ucp_dt_generic_t *dt_gen;
+    ucs_status_t status;
     size_t length;
     void *state;
 
     dt_gen = ucp_dt_generic(req->send.datatype);
     state = dt_gen->ops.start_pack(dt_gen->context, req->send.buffer, count);
 
-    req->send.state.dt.generic.state = state;
+    req->send.state.dt.generic.state    = state;
+    req->send.state.dt.generic.pipeline = NULL;
     req->send.length = length = dt_gen->ops.packed_size(state);
 
     if (length >= rndv_thresh) {
         ucp_tag_send_start_rndv(req);
     } else if (length <= config->max_am_bcopy - progress->only_hdr_size) {
         req->send.uct.func = progress->generic_single;
+    } else if ((length >= zcopy_thresh) && (depth > 0) &&
+               (context->config.ext.generic_pipeline_frag_size > 0) &&
+               (progress->first_hdr_size <= config->max_am_zcopy_hdr) &&
+               (length > config->max_am_zcopy - progress->first_hdr_size))
+    {
+        /* zcopy from staging buffers, packed ahead of the transport */
+        status = ucp_proto_pipeline_init(req, config->max_am_zcopy -
+                                              progress->first_hdr_size,
+                                         depth);
+        if (status == UCS_OK) {
+            req->send.uct.func = progress->generic_pipeline;
+        } else if (status == UCS_ERR_NO_RESOURCE) {
+            /* No staging buffers, send with bcopy */
+            req->send.uct.func = progress->generic_multi;
+        } else {
+            ucp_request_generic_dt_finish(req);
+            return status;
+        }
     } else {
         req->send.uct.func = progress->generic_multi;
     }
+    return UCS_OK;
+}
+
+/*
+ * Fragments of a message are matched by tag on the receiver, so a message may
+ * bypass the queued messages only if it is sent in a single fragment.
+ */
+static UCS_F_ALWAYS_INLINE int
+ucp_tag_send_is_single(ucp_request_t *req, const ucp_proto_t *proto)
+{
+    return (req->send.uct.func == proto->contig_short) ||
+           (req->send.uct.func == proto->contig_bcopy_single) ||
+           (req->send.uct.func == proto->contig_zcopy_single) ||
+           (req->send.uct.func == proto->generic_single);
 }
 
 static inline ucs_status_ptr_t
@@ -109,7 +148,11 @@ ucp_tag_send_req(ucp_request_t *req, size_t count, ssize_t max_short,
         break;
 
     case UCP_DATATYPE_GENERIC:
-        ucp_tag_req_start_generic(req, count, rndv_thresh, proto);
+        status = ucp_tag_req_start_generic(req, count, zcopy_thresh,
+                                           rndv_thresh, proto);
+        if (status != UCS_OK) {
+            return UCS_STATUS_PTR(status);
+        }
         break;
 
     default:
@@ -117,6 +160,11 @@ ucp_tag_send_req(ucp_request_t *req, size_t count, ssize_t max_short,
         return UCS_STATUS_PTR(UCS_ERR_INVALID_PARAM);
     }
 
+    if (ucs_unlikely(req->send.prio == UCP_REQUEST_PRIO_LATENCY) &&
+        !ucp_tag_send_is_single(req, proto)) {
+        req->send.prio = UCP_REQUEST_PRIO_BULK;
+    }
+
     ucp_ep_add_pending(ep, ep->uct_eps[UCP_EP_OP_AM], req, 1);
     ucp_worker_progress(ep->worker);
     ucs_trace_req("returning send request %p", req);
@@ -135,25 +183,36 @@ static void ucp_tag_send_req_init(ucp_request_t* req, ucp_ep_h ep,
     req->send.tag          = tag;
 }
 
+static UCS_F_ALWAYS_INLINE ucs_status_t
+ucp_tag_send_try_short(ucp_ep_h ep, const void *buffer, size_t count,
+                       uintptr_t datatype, ucp_tag_t tag)
+{
+    size_t length;
+
+    if (ucs_likely((datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG)) {
+        length = ucp_contig_dt_length(datatype, count);
+        if (ucs_likely(length <= ucp_ep_config(ep)->max_eager_short)) {
+            return ucp_tag_send_eager_short(ep, tag, buffer, length);
+        }
+    }
+
+    /* Need a request to send the message */
+    return UCS_ERR_NO_RESOURCE;
+}
+
 ucs_status_ptr_t ucp_tag_send_nb(ucp_ep_h ep, const void *buffer, size_t count,
                                  uintptr_t datatype, ucp_tag_t tag,
                                  ucp_send_callback_t cb)
 {
     ucs_status_t status;
     ucp_request_t *req;
-    size_t length;
 
     ucs_trace_req("send_nb buffer %p count %zu tag %"PRIx64" to %s cb %p",
                   buffer, count, tag, ucp_ep_peer_name(ep), cb);
 
-    if (ucs_likely((datatype & UCP_DATATYPE_CLASS_MASK) == UCP_DATATYPE_CONTIG)) {
-        length = ucp_contig_dt_length(datatype, count);
-        if (ucs_likely(length <= ucp_ep_config(ep)->max_eager_short)) {
-            status = ucp_tag_send_eager_short(ep, tag, buffer, length);
-            if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
-                return UCS_STATUS_PTR(status); /* UCS_OK also goes here */
-            }
-        }
+    status = ucp_tag_send_try_short(ep, buffer, count, datatype, tag);
+    if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+        return UCS_STATUS_PTR(status); /* UCS_OK also goes here */
     }
 
     req = ucs_mpool_get_inline(&ep->worker->req_mp);
@@ -170,6 +229,125 @@ ucs_status_ptr_t ucp_tag_send_nb(ucp_ep_h ep, const void *buffer, size_t count,
                             &ucp_tag_eager_proto);
 }
 
+ucs_status_ptr_t ucp_tag_send_prio_nb(ucp_ep_h ep, const void *buffer,
+                                      size_t count, uintptr_t datatype,
+                                      ucp_tag_t tag, enum ucp_send_prio prio,
+                                      ucp_send_callback_t cb)
+{
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    ucs_trace_req("send_prio_nb buffer %p count %zu tag %"PRIx64" prio %d to %s "
+                  "cb %p", buffer, count, tag, prio, ucp_ep_peer_name(ep), cb);
+
+    status = ucp_tag_send_try_short(ep, buffer, count, datatype, tag);
+    if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+        return UCS_STATUS_PTR(status); /* UCS_OK also goes here */
+    }
+
+    req = ucs_mpool_get_inline(&ep->worker->req_mp);
+    if (req == NULL) {
+        return UCS_STATUS_PTR(UCS_ERR_NO_MEMORY);
+    }
+
+    ucp_tag_send_req_init(req, ep, buffer, datatype, tag, cb);
+    if (prio == UCP_SEND_PRIO_LATENCY) {
+        req->send.prio = UCP_REQUEST_PRIO_LATENCY;
+    }
+
+    return ucp_tag_send_req(req, count,
+                            ucp_ep_config(ep)->max_eager_short,
+                            ucp_ep_config(ep)->zcopy_thresh,
+                            ucp_ep_config(ep)->rndv_thresh,
+                            &ucp_tag_eager_proto);
+}
+
+ucs_status_ptr_t ucp_tag_send_nbr(ucp_ep_h ep, const void *buffer, size_t count,
+                                  uintptr_t datatype, ucp_tag_t tag,
+                                  ucp_send_callback_t cb, void *req_storage)
+{
+    ucp_request_t *req = req_storage;
+    ucs_status_t status;
+
+    ucs_trace_req("send_nbr buffer %p count %zu tag %"PRIx64" to %s cb %p "
+                  "storage %p", buffer, count, tag, ucp_ep_peer_name(ep), cb,
+                  req_storage);
+
+    status = ucp_tag_send_try_short(ep, buffer, count, datatype, tag);
+    if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+        return UCS_STATUS_PTR(status); /* UCS_OK also goes here */
+    }
+
+    ucp_tag_send_req_init(req, ep, buffer, datatype, tag, cb);
+    req->flags |= UCP_REQUEST_FLAG_EXTERNAL;
+
+    return ucp_tag_send_req(req, count,
+                            ucp_ep_config(ep)->max_eager_short,
+                            ucp_ep_config(ep)->zcopy_thresh,
+                            ucp_ep_config(ep)->rndv_thresh,
+                            &ucp_tag_eager_proto);
+}
+
+ucs_status_t ucp_tag_send_cq_nb(ucp_ep_h ep, const void *buffer, size_t count,
+                                ucp_datatype_t datatype, ucp_tag_t tag,
+                                void *user_data)
+{
+    ucs_status_ptr_t status_ptr;
+    ucs_status_t status;
+    ucp_request_t *req;
+
+    ucs_trace_req("send_cq_nb buffer %p count %zu tag %"PRIx64" to %s "
+                  "user_data %p", buffer, count, tag, ucp_ep_peer_name(ep),
+                  user_data);
+
+    status = ucp_tag_send_try_short(ep, buffer, count, datatype, tag);
+    if (ucs_likely(status != UCS_ERR_NO_RESOURCE)) {
+        return status; /* UCS_OK also goes here */
+    }
+
+    req = ucs_mpool_get_inline(&ep->worker->req_mp);
+    if (req == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucp_tag_send_req_init(req, ep, buffer, datatype, tag,
+                          ucp_request_cq_send_callback);
+
+    status = ucp_worker_cq_reserve(ep->worker);
+    if (status != UCS_OK) {
+        goto err_put_req;
+    }
+
+    status = ucp_request_ext_get(ep->worker, req, UCP_REQUEST_FLAG_CQ);
+    if (status != UCS_OK) {
+        goto err_cq_unreserve;
+    }
+
+    /* The request is owned by the worker, and released once completed */
+    req->flags          |= UCP_REQUEST_FLAG_RELEASED;
+    req->ext->user_data  = user_data;
+
+    status_ptr = ucp_tag_send_req(req, count,
+                                  ucp_ep_config(ep)->max_eager_short,
+                                  ucp_ep_config(ep)->zcopy_thresh,
+                                  ucp_ep_config(ep)->rndv_thresh,
+                                  &ucp_tag_eager_proto);
+    if (UCS_PTR_IS_ERR(status_ptr)) {
+        status = UCS_PTR_STATUS(status_ptr);
+        goto err_ext_put;
+    }
+
+    return UCS_INPROGRESS;
+
+err_ext_put:
+    ucp_request_ext_put(req, UCP_REQUEST_FLAG_CQ);
+err_cq_unreserve:
+    ucp_worker_cq_unreserve(ep->worker);
+err_put_req:
+    ucs_mpool_put(req);
+    return status;
+}
+
 ucs_status_ptr_t ucp_tag_send_sync_nb(ucp_ep_h ep, const void *buffer, size_t count,
                                       ucp_datatype_t datatype, ucp_tag_t tag,
                                       ucp_send_callback_t cb)
@@ -197,18 +375,80 @@ ucs_status_ptr_t ucp_tag_send_sync_nb(ucp_ep_h ep, const void *buffer, size_t co
                             &ucp_tag_eager_sync_proto);
 }
 
+static void ucp_tag_eager_sync_send_batch(ucp_reply_batch_t *batch, int progress)
+{
+    ucp_ep_h ep = batch->ep;
+    ucp_request_t *req;
+
+    req = ucs_mpool_get_inline(&ep->worker->req_mp);
+    if (req == NULL) {
+        ucs_fatal("could not allocate request");
+    }
+
+    ucs_trace_req("ep %p: send %u eager-sync acks", ep, batch->count);
+    ucs_list_del(&batch->list);
+    ep->sync_acks = NULL;
+
+    ucp_send_req_init(req, ep);
+    req->send.uct.func     = ucp_proto_progress_am_bcopy_single;
+    req->send.proto.am_id  = UCP_AM_ID_EAGER_SYNC_ACK;
+    req->send.proto.batch  = batch;
+    req->send.proto.status = UCS_OK;
+    ucp_ep_send_reply(req, UCP_EP_OP_AM, progress);
+}
+
 void ucp_tag_eager_sync_send_ack(ucp_worker_h worker, uint64_t sender_uuid,
                                  uintptr_t remote_request, int progress)
 {
-    ucp_request_t *req;
+    ucp_reply_batch_t *batch;
+    ucp_ep_h ep;
 
     ucs_trace_req("send_sync_ack sender_uuid %"PRIx64" remote_request 0x%lx",
                   sender_uuid, remote_request);
 
-    req = ucp_worker_allocate_reply(worker, sender_uuid);
-    req->send.uct.func             = ucp_proto_progress_am_bcopy_single;
-    req->send.proto.am_id          = UCP_AM_ID_EAGER_SYNC_ACK;
-    req->send.proto.remote_request = remote_request;
-    req->send.proto.status         = UCS_OK;
-    ucp_ep_send_reply(req, UCP_EP_OP_AM, progress);
+    ep    = ucp_worker_get_reply_ep(worker, sender_uuid);
+    batch = ep->sync_acks;
+    if (batch == NULL) {
+        batch = ucs_mpool_get_inline(&worker->reply_mp);
+        if (batch == NULL) {
+            ucs_fatal("could not allocate reply batch");
+        }
+
+        batch->ep     = ep;
+        batch->count  = 0;
+        ep->sync_acks = batch;
+        ucs_list_add_tail(&worker->reply_list, &batch->list);
+    }
+
+    batch->reqptrs[batch->count++] = remote_request;
+
+    /* Acks from active message handlers wait for the end of the progress call,
+     * so all acks to the same sender are sent together. Otherwise, there may
+     * be no later progress call, so send right away. */
+    if (progress || (batch->count == UCP_REPLY_BATCH_MAX)) {
+        ucp_tag_eager_sync_send_batch(batch, progress);
+    }
+}
+
+void ucp_tag_eager_sync_flush_acks(ucp_worker_h worker)
+{
+    ucp_reply_batch_t *batch, *tmp;
+
+    ucs_list_for_each_safe(batch, tmp, &worker->reply_list, list) {
+        ucp_tag_eager_sync_send_batch(batch, 0);
+    }
+}
+
+void ucp_tag_eager_sync_ep_cleanup(ucp_ep_h ep)
+{
+    ucp_reply_batch_t *batch = ep->sync_acks;
+
+    if (batch == NULL) {
+        return;
+    }
+
+    ucs_debug("ep %p: drop %u eager-sync acks", ep, batch->count);
+    ucs_list_del(&batch->list);
+    ucs_mpool_put(batch);
+    ep->sync_acks = NULL;
 }
@@ -162,7 +162,8 @@ static ucs_status_t ucp_stub_pending_add(uct_ep_h uct_ep, uct_pending_req_t *req
         proxy_req->send.proxy.req     = req;
         proxy_req->send.proxy.stub_ep = stub_ep;
 
-        status = uct_ep_pending_add(wireup_msg_ep, &proxy_req->send.uct);
+        status = uct_ep_pending_add_prio(wireup_msg_ep, &proxy_req->send.uct,
+                                         UCP_REQUEST_PRIO_CONTROL);
         if (status == UCS_OK) {
             ucs_atomic_add32(&stub_ep->pending_count, +1);
         } else {
@@ -178,6 +179,15 @@ out:
     return status;
 }
 
+static ucs_status_t ucp_stub_pending_add_prio(uct_ep_h uct_ep,
+                                               uct_pending_req_t *req,
+                                               uct_pending_prio_t prio)
+{
+    /* Requests keep their priority, and are re-added to the real transport
+     * according to it when the stub endpoint is replaced */
+    return ucp_stub_pending_add(uct_ep, req);
+}
+
 static void ucp_stub_pending_purge(uct_ep_h uct_ep, uct_pending_callback_t cb)
 {
     ucp_stub_ep_t *stub_ep = ucs_derived_of(uct_ep, ucp_stub_ep_t);
@@ -210,6 +220,7 @@ static uct_iface_t ucp_stub_iface = {
         .ep_flush             = (void*)ucs_empty_function_return_inprogress,
         .ep_destroy           = UCS_CLASS_DELETE_FUNC_NAME(ucp_stub_ep_t),
         .ep_pending_add       = ucp_stub_pending_add,
+        .ep_pending_add_prio  = ucp_stub_pending_add_prio,
         .ep_pending_purge     = ucp_stub_pending_purge,
         .ep_put_short         = (void*)ucp_stub_ep_send_func,
         .ep_put_bcopy         = (void*)ucp_stub_ep_bcopy_send_func,
@@ -360,6 +371,31 @@ ucp_rsc_index_t ucp_stub_ep_get_aux_rsc_index(uct_ep_h uct_ep)
     return stub_ep->aux_rsc_index;
 }
 
+int ucp_stub_ep_test(uct_ep_h uct_ep)
+{
+    return uct_ep->iface == &ucp_stub_iface;
+}
+
+int ucp_stub_ep_pending_remove(uct_ep_h uct_ep, uct_pending_req_t *req)
+{
+    ucp_stub_ep_t *stub_ep = ucs_derived_of(uct_ep, ucp_stub_ep_t);
+    ucs_queue_iter_t iter;
+
+    ucs_assert(ucp_stub_ep_test(uct_ep));
+
+    for (iter = ucs_queue_iter_begin(&stub_ep->pending_q);
+         !ucs_queue_iter_end(&stub_ep->pending_q, iter);
+         iter = ucs_queue_iter_next(iter))
+    {
+        if (*iter == ucp_stub_ep_req_priv(req)) {
+            ucs_queue_del_iter(&stub_ep->pending_q, iter);
+            --stub_ep->ep->worker->stub_pend_count;
+            return 1;
+        }
+    }
+    return 0;
+}
+
 ucs_status_t ucp_stub_ep_connect(uct_ep_h uct_ep, unsigned address_count,
                                  const ucp_address_entry_t *address_list)
 {
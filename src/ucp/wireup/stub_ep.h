@@ -47,6 +47,18 @@ ucs_status_t ucp_stub_ep_create(ucp_ep_h ep, ucp_ep_op_t optype,
  */
 ucp_rsc_index_t ucp_stub_ep_get_aux_rsc_index(uct_ep_h uct_ep);
 
+/**
+ * @return Whether the transport endpoint is a stub endpoint.
+ */
+int ucp_stub_ep_test(uct_ep_h uct_ep);
+
+/**
+ * Remove a request which waits for wireup from the stub endpoint queue.
+ *
+ * @return Nonzero if the request was found and removed.
+ */
+int ucp_stub_ep_pending_remove(uct_ep_h uct_ep, uct_pending_req_t *req);
+
 /* create endpoint for the real transport, which we would eventually connect */
 ucs_status_t ucp_stub_ep_connect(uct_ep_h uct_ep, unsigned address_count,
                                  const ucp_address_entry_t *address_list);
@@ -140,6 +140,20 @@ static double ucp_wireup_amo_score_func(ucp_worker_h worker,
     return 1e-3 / (iface_attr->latency + (iface_attr->overhead * 2));
 }
 
+static int ucp_wireup_is_tl_in_address(const char *tl_name,
+                                       const ucp_address_entry_t *address_list,
+                                       unsigned address_count)
+{
+    const ucp_address_entry_t *ae;
+
+    for (ae = address_list; ae < address_list + address_count; ++ae) {
+        if (!strcmp(ae->tl_name, tl_name)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 /**
  * Select a local and remote transport
  */
@@ -172,7 +186,6 @@ ucs_status_t ucp_select_transport(ucp_ep_h ep,
 
     for (rsc_index = 0; rsc_index < context->num_tls; ++rsc_index) {
         resource   = &context->tl_rscs[rsc_index].tl_rsc;
-        iface      = worker->ifaces[rsc_index];
 
         /* Must use only the pd the remote side explicitly requested */
         if ((pd_index != UCP_NULL_RESOURCE) &&
@@ -187,6 +200,25 @@ ucs_status_t ucp_select_transport(ucp_ep_h ep,
             continue;
         }
 
+        /* Interfaces may be opened lazily, so open only those which are in
+         * the worker address and have a matching transport on the remote side */
+        if (worker->ifaces[rsc_index] == NULL) {
+            if (!(worker->address_tls & UCS_BIT(rsc_index)) ||
+                !ucp_wireup_is_tl_in_address(resource->tl_name, address_list,
+                                             address_count) ||
+                (ucp_worker_open_iface(worker, rsc_index) != UCS_OK))
+            {
+                ucs_trace(UCT_TL_RESOURCE_DESC_FMT " : not opened",
+                          UCT_TL_RESOURCE_DESC_ARG(resource));
+                snprintf(p, endp - p, ", "UCT_TL_RESOURCE_DESC_FMT" - unreachable",
+                         UCT_TL_RESOURCE_DESC_ARG(resource));
+                p += strlen(p);
+                continue;
+            }
+        }
+
+        iface = worker->ifaces[rsc_index];
+
         /* Get local device score */
         score = score_func(worker, &worker->iface_attrs[rsc_index], tl_reason,
                            sizeof(tl_reason));
@@ -199,6 +231,11 @@ ucs_status_t ucp_select_transport(ucp_ep_h ep,
             continue;
         }
 
+        /* Prefer devices which are attached to the NUMA node of the worker */
+        if (ucp_worker_is_numa_remote(worker, rsc_index)) {
+            score *= context->config.ext.numa_remote_factor;
+        }
+
         /* Check if remote peer is reachable using one of its devices */
         reachable = 0;
         for (ae = address_list; ae < address_list + address_count; ++ae) {
@@ -343,7 +380,7 @@ static ucs_status_t ucp_wireup_msg_send(ucp_ep_h ep, uint8_t type)
     ucp_request_t* req;
     void *address;
 
-    ucs_assert(ep->cfg_index != (uint8_t)-1);
+    ucs_assert(ep->cfg_index != (uint16_t)-1);
 
     req = ucs_mpool_get(&ep->worker->req_mp);
     if (req == NULL) {
@@ -353,6 +390,7 @@ static ucs_status_t ucp_wireup_msg_send(ucp_ep_h ep, uint8_t type)
     req->flags                   = UCP_REQUEST_FLAG_RELEASED;
     req->cb.send                 = ucp_wireup_msg_send_completion;
     req->send.uct.func           = ucp_wireup_msg_progress;
+    req->send.prio               = UCP_REQUEST_PRIO_CONTROL;
     req->send.wireup.type        = type;
 
     /* Make a bitmap of all addresses we are sending:
@@ -607,6 +645,7 @@ ucs_status_t ucp_ep_init_trasports(ucp_ep_h ep, unsigned address_count,
     ucp_rsc_index_t rsc_index;
     ucp_ep_op_t optype, dup;
     unsigned addr_index;
+    unsigned cfg_index;
     ucs_status_t status;
     uct_ep_h new_uct_ep;
     int has_p2p;
@@ -653,7 +692,12 @@ ucs_status_t ucp_ep_init_trasports(ucp_ep_h ep, unsigned address_count,
     }
 
     /* group eps by their configuration of transports */
-    ep->cfg_index   = ucp_worker_get_ep_config(worker, rscs);
+    status = ucp_worker_get_ep_config(worker, rscs, &cfg_index);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    ep->cfg_index = cfg_index;
 
     /* save remote protection domain index for rma and amo. this is used
      * to select the remote key for these operations.
@@ -793,7 +837,7 @@ UCP_DEFINE_AM(-1, UCP_AM_ID_WIREUP, ucp_wireup_msg_handler,
 ucp_wireup_ep_op_t ucp_wireup_ep_ops[] = {
     [UCP_EP_OP_AM]  = {
         .title      = "active messages",
-        .features   = UCP_FEATURE_TAG,
+        .features   = UCP_FEATURE_TAG | UCP_FEATURE_AM | UCP_FEATURE_STREAM,
         .score_func = ucp_wireup_am_score_func
     },
     [UCP_EP_OP_RMA] = {
@@ -51,4 +51,9 @@ static inline int ucs_arch_get_cpu_flag()
     return UCS_CPU_FLAG_UNKNOWN;
 }
 
+static inline void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+}
+
 #endif
@@ -8,7 +8,9 @@
 #ifndef UCS_ARCH_CPU_H
 #define UCS_ARCH_CPU_H
 
+#include <ucs/config/global_opts.h>
 #include <ucs/sys/math.h>
+#include <string.h>
 
 
 /* CPU models */
@@ -53,4 +55,25 @@ typedef enum ucs_cpu_flag {
 #  error "Unsupported architecture"
 #endif
 
+
+/**
+ * Copy memory which is consumed by another CPU, and is not expected to be read
+ * back by the calling CPU soon (e.g a shared memory FIFO or a peer's buffer).
+ * Copies of UCS_MEMCPY_NT_THRESH bytes or more use non-temporal stores, when
+ * supported, to avoid evicting the working set of the calling CPU from its
+ * cache. Smaller copies use regular memcpy().
+ *
+ * @param dst   Destination buffer.
+ * @param src   Source buffer, must not overlap with the destination.
+ * @param len   Number of bytes to copy.
+ */
+static inline void ucs_memcpy_relaxed(void *dst, const void *src, size_t len)
+{
+    if (ucs_likely(len < ucs_global_opts.memcpy_nt_thresh)) {
+        memcpy(dst, src, len);
+    } else {
+        ucs_arch_memcpy_nt(dst, src, len);
+    }
+}
+
 #endif
@@ -10,6 +10,7 @@
 #include <ucs/debug/log.h>
 #include <ucs/sys/math.h>
 #include <ucs/sys/sys.h>
+#include <immintrin.h>
 
 #define X86_CPUID_GET_MODEL       0x00000001u
 #define X86_CPUID_GET_BASE_VALUE  0x00000000u
@@ -17,6 +18,8 @@
 #define X86_CPUID_GET_MAX_VALUE   0x80000000u
 #define X86_CPUID_INVARIANT_TSC   0x80000007u
 
+#define X86_MEMCPY_NT_UNROLL      4
+
 
 static UCS_F_NOOPTIMIZE inline void ucs_x86_cpuid(uint32_t level,
                                                 uint32_t *a, uint32_t *b,
@@ -223,4 +226,73 @@ int ucs_arch_get_cpu_flag()
     return cpu_flag;
 }
 
+/*
+ * Copy the unaligned head of the destination with regular stores, so the
+ * streaming loop can use aligned non-temporal stores.
+ */
+static UCS_F_ALWAYS_INLINE void
+ucs_x86_memcpy_nt_head(void **dst, const void **src, size_t *len, size_t align)
+{
+    size_t head = ucs_min(ucs_padding((uintptr_t)*dst, align), *len);
+
+    memcpy(*dst, *src, head);
+    *dst  += head;
+    *src  += head;
+    *len  -= head;
+}
+
+static void ucs_x86_memcpy_nt_sse2(void *dst, const void *src, size_t len)
+{
+    const size_t block = X86_MEMCPY_NT_UNROLL * sizeof(__m128i);
+    __m128i *d;
+    const __m128i *s;
+    int i;
+
+    ucs_x86_memcpy_nt_head(&dst, &src, &len, sizeof(__m128i));
+
+    d = dst;
+    s = src;
+    for (; len >= block; len -= block) {
+        for (i = 0; i < X86_MEMCPY_NT_UNROLL; ++i) {
+            _mm_stream_si128(d++, _mm_loadu_si128(s++));
+        }
+    }
+
+    memcpy(d, s, len);
+}
+
+static void __attribute__((target("avx")))
+ucs_x86_memcpy_nt_avx(void *dst, const void *src, size_t len)
+{
+    const size_t block = X86_MEMCPY_NT_UNROLL * sizeof(__m256i);
+    __m256i *d;
+    const __m256i *s;
+    int i;
+
+    ucs_x86_memcpy_nt_head(&dst, &src, &len, sizeof(__m256i));
+
+    d = dst;
+    s = src;
+    for (; len >= block; len -= block) {
+        for (i = 0; i < X86_MEMCPY_NT_UNROLL; ++i) {
+            _mm256_stream_si256(d++, _mm256_loadu_si256(s++));
+        }
+    }
+
+    memcpy(d, s, len);
+}
+
+void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len)
+{
+    if (ucs_arch_get_cpu_flag() & UCS_CPU_FLAG_AVX) {
+        ucs_x86_memcpy_nt_avx(dst, src, len);
+    } else {
+        ucs_x86_memcpy_nt_sse2(dst, src, len);
+    }
+
+    /* Non-temporal stores are weakly ordered, so make them visible before any
+     * following store which may publish the data to another CPU */
+    ucs_memory_bus_store_fence();
+}
+
 #endif
@@ -43,6 +43,7 @@ double ucs_arch_get_clocks_per_sec();
 
 ucs_cpu_model_t ucs_arch_get_cpu_model() UCS_F_NOOPTIMIZE;
 ucs_cpu_flag_t ucs_arch_get_cpu_flag() UCS_F_NOOPTIMIZE;
+void ucs_arch_memcpy_nt(void *dst, const void *src, size_t len);
 
 
 #endif
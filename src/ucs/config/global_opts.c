@@ -24,6 +24,7 @@ ucs_global_opts_t ucs_global_opts = {
     .debug_signo           = SIGHUP,
     .async_max_events      = 64,
     .async_signo           = SIGALRM,
+    .progress_max_skip     = 16,
     .stats_dest            = "",
     .tuning_path           = "",
     .memtrack_dest         = "",
@@ -108,6 +109,18 @@ static ucs_config_field_t ucs_global_opts_table[] = {
   "Signal number used for async signaling.",
   ucs_offsetof(ucs_global_opts_t, async_signo), UCS_CONFIG_TYPE_SIGNO},
 
+ {"PROGRESS_MAX_SKIP", "16",
+  "Maximal number of consecutive progress calls which may skip polling an\n"
+  "interface which had no events recently. Interfaces with recent events are\n"
+  "polled on every progress call. 0 means always poll all interfaces.",
+  ucs_offsetof(ucs_global_opts_t, progress_max_skip), UCS_CONFIG_TYPE_UINT},
+
+ {"MEMCPY_NT_THRESH", "1m",
+  "Minimal size of a copy to a shared memory peer which uses non-temporal\n"
+  "stores, bypassing the local CPU cache. Smaller copies use regular memcpy().\n"
+  "\"inf\" disables non-temporal copies.",
+  ucs_offsetof(ucs_global_opts_t, memcpy_nt_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
 #if ENABLE_STATS
  {"STATS_DEST", "",
   "Destination to send statistics to. If the value is empty, statistics are\n"
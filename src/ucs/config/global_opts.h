@@ -77,6 +77,12 @@ typedef struct {
     /* Signal number used by async handler (for signal mode) */
     unsigned                 async_signo;
 
+    /* Maximal number of progress calls to skip polling an idle interface */
+    unsigned                 progress_max_skip;
+
+    /* Minimal size of ucs_memcpy_relaxed() which uses non-temporal stores */
+    size_t                   memcpy_nt_thresh;
+
     /* Destination for detailed memory tracking results: none / stdout / stderr
      */
     char                     *memtrack_dest;
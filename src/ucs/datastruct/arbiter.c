@@ -110,14 +110,16 @@ void ucs_arbiter_group_schedule_nonempty(ucs_arbiter_t *arbiter,
     }
 }
 
-void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
-                                   ucs_arbiter_callback_t cb, void *cb_arg)
+unsigned ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter,
+                                       unsigned per_group,
+                                       ucs_arbiter_callback_t cb, void *cb_arg)
 {
     ucs_arbiter_elem_t *group_head, *last_elem, *elem, *next_elem;
     ucs_arbiter_elem_t *next_group, *prev_group;
     ucs_arbiter_group_t *group;
     ucs_arbiter_cb_result_t result;
     unsigned group_dispatch_count;
+    unsigned count = 0;
     UCS_LIST_HEAD(resched_groups);
 
     next_group = arbiter->current;
@@ -147,6 +149,7 @@ void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
             ++group_dispatch_count;
 
             if (result == UCS_ARBITER_CB_RESULT_REMOVE_ELEM) {
+                ++count;
                if (elem == last_elem) {
                     /* Only element */
                     group->tail = NULL; /* Group is empty now */
@@ -208,6 +211,7 @@ out:
         ucs_trace_data("reschedule group %p", elem->group);
         ucs_arbiter_group_schedule_nonempty(arbiter, elem->group);
     }
+    return count;
 }
 
 void ucs_arbiter_dump(ucs_arbiter_t *arbiter, FILE *stream)
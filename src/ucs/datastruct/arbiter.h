@@ -208,8 +208,9 @@ void ucs_arbiter_group_schedule_nonempty(ucs_arbiter_t *arbiter,
                                          ucs_arbiter_group_t *group);
 
 /* Internal function */
-void ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter, unsigned per_group,
-                                   ucs_arbiter_callback_t cb, void *cb_arg);
+unsigned ucs_arbiter_dispatch_nonempty(ucs_arbiter_t *arbiter,
+                                       unsigned per_group,
+                                       ucs_arbiter_callback_t cb, void *cb_arg);
 
 /* Internal function */
 void ucs_arbiter_group_head_desched(ucs_arbiter_t *arbiter,
@@ -243,14 +244,17 @@ static inline void ucs_arbiter_group_schedule(ucs_arbiter_t *arbiter,
  * @param [in]  per_group  How many elements to dispatch from each group.
  * @param [in]  cb         User-defined callback to be called for each element.
  * @param [in]  cb_arg     Last argument for the callback.
+ *
+ * @return Number of elements which were removed by the callback.
  */
-static inline void
+static inline unsigned
 ucs_arbiter_dispatch(ucs_arbiter_t *arbiter, unsigned per_group,
                      ucs_arbiter_callback_t cb, void *cb_arg)
 {
     if (ucs_unlikely(arbiter->current != NULL)) {
-        ucs_arbiter_dispatch_nonempty(arbiter, per_group, cb, cb_arg);
+        return ucs_arbiter_dispatch_nonempty(arbiter, per_group, cb, cb_arg);
     }
+    return 0;
 }
 
 
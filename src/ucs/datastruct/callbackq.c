@@ -28,7 +28,10 @@ static inline ucs_callbackq_priv_t* ucs_callbackq_priv(ucs_callbackq_t *cbq)
 
 static void ucs_callbackq_service_enable(ucs_callbackq_t *cbq)
 {
-    cbq->start = cbq->ptr;
+    /* The service callback must run on the next dispatch, even if adaptive
+     * dispatch considers it idle */
+    cbq->ptr->skip = 0;
+    cbq->start     = cbq->ptr;
 }
 
 static void ucs_callbackq_service_disable(ucs_callbackq_t *cbq)
@@ -88,7 +91,7 @@ static void ucs_callbackq_remove_elem(ucs_callbackq_t *cbq, ucs_callbackq_elem_t
  * to the callback queue on behalf of other threads, since it is guaranteed to
  * run from the "main" thread.
  */
-static void ucs_callbackq_service_cb(void *arg)
+static unsigned ucs_callbackq_service_cb(void *arg)
 {
     ucs_callbackq_t *cbq = arg;
     ucs_callbackq_elem_t *elem;
@@ -104,6 +107,7 @@ static void ucs_callbackq_service_cb(void *arg)
     }
     ucs_callbackq_service_disable(cbq);
     ucs_callbackq_leave(cbq);
+    return 0;
 }
 
 ucs_status_t ucs_callbackq_init(ucs_callbackq_t *cbq, size_t size,
@@ -120,6 +124,8 @@ ucs_status_t ucs_callbackq_init(ucs_callbackq_t *cbq, size_t size,
     cbq->ptr->cb       = ucs_callbackq_service_cb;
     cbq->ptr->arg      = cbq;
     cbq->ptr->refcount = 1;
+    cbq->ptr->idle     = 0;
+    cbq->ptr->skip     = 0;
     cbq->size          = size;
     cbq->start         = cbq->ptr + 1;
     cbq->end           = cbq->start;
@@ -175,6 +181,8 @@ void ucs_callbackq_add(ucs_callbackq_t *cbq, ucs_callback_t cb, void *arg)
     elem->cb       = cb;
     elem->arg      = arg;
     elem->refcount = 1;
+    elem->idle     = 0;
+    elem->skip     = 0;
 
     /* Make sure a thread dispatching the callbacks would see 'end' only after
      * the new element is set.
@@ -9,6 +9,7 @@
 
 #include <ucs/arch/cpu.h> /* for memory load fence */
 #include <ucs/async/async_fwd.h>
+#include <ucs/sys/math.h>
 #include <stdint.h>
 
 /*
@@ -25,7 +26,14 @@
  */
 typedef struct ucs_callbackq         ucs_callbackq_t;
 typedef struct ucs_callbackq_elem    ucs_callbackq_elem_t;
-typedef void                         (*ucs_callback_t)(void *arg);
+typedef unsigned                     (*ucs_callback_t)(void *arg);
+
+
+/**
+ * Number of consecutive calls which did no work, after which a callback is
+ * considered idle by @ref ucs_callbackq_dispatch_adaptive.
+ */
+#define UCS_CALLBACKQ_IDLE_THRESH    16
 
 
 /**
@@ -35,6 +43,10 @@ struct ucs_callbackq_elem {
     ucs_callback_t                   cb;       /**< Callback function */
     void                             *arg;     /**< Function argument */
     volatile uint32_t                refcount; /**< Reference count */
+    uint16_t                         idle;     /**< Number of consecutive calls
+                                                    which did no work */
+    uint16_t                         skip;     /**< Number of dispatches to skip
+                                                    before calling it again */
 };
 
 
@@ -192,14 +204,61 @@ ucs_status_t ucs_callbackq_remove_safe(ucs_callbackq_t *cbq, ucs_callback_t cb,
  * Complexity: O(n)
  *
  * @param  [in] cbq      Callback queue whose elements to dispatch.
+ *
+ * @return Total number of events reported by the callbacks.
+ */
+static inline unsigned ucs_callbackq_dispatch(ucs_callbackq_t *cbq)
+{
+    ucs_callbackq_elem_t *elem;
+    unsigned count = 0;
+
+    ucs_callbackq_for_each(elem, cbq) {
+        count += elem->cb(elem->arg);
+    }
+    return count;
+}
+
+
+/**
+ * Call the callbacks on the queue, polling idle callbacks at a decaying
+ * frequency. A callback which did no work in @ref UCS_CALLBACKQ_IDLE_THRESH
+ * consecutive calls is skipped by some of the following dispatches; the number
+ * of skipped dispatches grows with the idle period, up to @a max_skip. A
+ * callback which reports work is called on every dispatch again.
+ * This should be done only from one thread at a time.
+ *
+ * Complexity: O(n)
+ *
+ * @param  [in] cbq      Callback queue whose elements to dispatch.
+ * @param  [in] max_skip Maximal number of consecutive dispatches to skip an
+ *                       idle callback. 0 means calling all callbacks always.
+ *
+ * @return Total number of events reported by the callbacks.
  */
-static inline void ucs_callbackq_dispatch(ucs_callbackq_t *cbq)
+static inline unsigned ucs_callbackq_dispatch_adaptive(ucs_callbackq_t *cbq,
+                                                       unsigned max_skip)
 {
     ucs_callbackq_elem_t *elem;
+    unsigned count, total;
 
+    total = 0;
     ucs_callbackq_for_each(elem, cbq) {
-        elem->cb(elem->arg);
+        if (elem->skip > 0) {
+            --elem->skip;
+            continue;
+        }
+
+        count = elem->cb(elem->arg);
+        if (count > 0) {
+            elem->idle = 0;
+            total     += count;
+        } else if (elem->idle < UINT16_MAX) {
+            ++elem->idle;
+            elem->skip = ucs_min((unsigned)elem->idle / UCS_CALLBACKQ_IDLE_THRESH,
+                                 max_skip);
+        }
     }
+    return total;
 }
 
 #endif
@@ -0,0 +1,269 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "copy_engine.h"
+
+#include <ucs/arch/cpu.h>
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/math.h>
+#include <ucs/sys/sys.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+
+
+struct ucs_copy_engine {
+    pthread_mutex_t          run_lock;    /* Serializes ucs_copy_engine_run() */
+    pthread_mutex_t          lock;        /* Protects the current job */
+    pthread_cond_t           job_cond;    /* Signaled when a job is posted */
+    pthread_cond_t           done_cond;   /* Signaled when a job is done */
+    int                      stop;        /* Helper threads should exit */
+    size_t                   min_part;    /* Minimal part size */
+    char                     name[32];
+
+    /* Current job */
+    unsigned                 generation;  /* Incremented for every job */
+    ucs_copy_engine_func_t   func;
+    void                     *arg;
+    size_t                   length;
+    size_t                   part_size;
+    unsigned                 num_parts;
+    unsigned                 next_part;   /* Next part to copy */
+    unsigned                 done_parts;  /* Number of copied parts */
+    ucs_status_t             status;      /* First error of the job */
+
+    unsigned                 num_threads;
+    pthread_t                threads[0];
+};
+
+
+/*
+ * Copy parts of the current job until all of them are taken. Called with the
+ * engine lock held, and returns with it held.
+ */
+static void ucs_copy_engine_work(ucs_copy_engine_t *engine)
+{
+    ucs_copy_engine_func_t func;
+    size_t offset, length;
+    ucs_status_t status;
+    void *arg;
+
+    while (engine->next_part < engine->num_parts) {
+        offset = engine->next_part * engine->part_size;
+        length = ucs_min(engine->part_size, engine->length - offset);
+        func   = engine->func;
+        arg    = engine->arg;
+        ++engine->next_part;
+
+        pthread_mutex_unlock(&engine->lock);
+        status = func(arg, offset, length);
+        pthread_mutex_lock(&engine->lock);
+
+        if ((status != UCS_OK) && (engine->status == UCS_OK)) {
+            engine->status = status;
+        }
+        if (++engine->done_parts == engine->num_parts) {
+            pthread_cond_signal(&engine->done_cond);
+        }
+    }
+}
+
+static void *ucs_copy_engine_thread_func(void *arg)
+{
+    ucs_copy_engine_t *engine = arg;
+    unsigned generation;
+
+    pthread_mutex_lock(&engine->lock);
+    generation = engine->generation;
+    for (;;) {
+        while (!engine->stop && (engine->generation == generation)) {
+            pthread_cond_wait(&engine->job_cond, &engine->lock);
+        }
+        if (engine->stop) {
+            break;
+        }
+
+        generation = engine->generation;
+        ucs_copy_engine_work(engine);
+    }
+    pthread_mutex_unlock(&engine->lock);
+    return NULL;
+}
+
+static void ucs_copy_engine_numa_cpus(int numa_node, cpu_set_t *cpuset)
+{
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    int cpu;
+
+    CPU_ZERO(cpuset);
+    for (cpu = 0; (cpu < num_cpus) && (cpu < CPU_SETSIZE); ++cpu) {
+        if (ucs_numa_node_of_cpu(cpu) == numa_node) {
+            CPU_SET(cpu, cpuset);
+        }
+    }
+}
+
+static void ucs_copy_engine_stop(ucs_copy_engine_t *engine, unsigned num_threads)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&engine->lock);
+    engine->stop = 1;
+    pthread_cond_broadcast(&engine->job_cond);
+    pthread_mutex_unlock(&engine->lock);
+
+    for (i = 0; i < num_threads; ++i) {
+        pthread_join(engine->threads[i], NULL);
+    }
+}
+
+ucs_status_t ucs_copy_engine_create(unsigned num_threads, size_t min_part,
+                                    int numa_node, const char *name,
+                                    ucs_copy_engine_t **engine_p)
+{
+    ucs_copy_engine_t *engine;
+    pthread_attr_t attr;
+    cpu_set_t cpuset;
+    ucs_status_t status;
+    unsigned i;
+    int ret;
+
+    engine = ucs_calloc(1, sizeof(*engine) +
+                        num_threads * sizeof(*engine->threads), "copy_engine");
+    if (engine == NULL) {
+        ucs_error("failed to allocate copy engine");
+        status = UCS_ERR_NO_MEMORY;
+        goto err;
+    }
+
+    pthread_mutex_init(&engine->run_lock, NULL);
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->job_cond, NULL);
+    pthread_cond_init(&engine->done_cond, NULL);
+    ucs_snprintf_zero(engine->name, sizeof(engine->name), "%s", name);
+    engine->min_part    = ucs_max(min_part, UCS_SYS_CACHE_LINE_SIZE);
+    engine->num_threads = 0;
+
+    pthread_attr_init(&attr);
+    if (numa_node >= 0) {
+        ucs_copy_engine_numa_cpus(numa_node, &cpuset);
+        if (CPU_COUNT(&cpuset) > 0) {
+            pthread_attr_setaffinity_np(&attr, sizeof(cpuset), &cpuset);
+        }
+    }
+
+    for (i = 0; i < num_threads; ++i) {
+        ret = pthread_create(&engine->threads[i], &attr,
+                             ucs_copy_engine_thread_func, engine);
+        if (ret != 0) {
+            ucs_error("pthread_create() returned %d: %m", ret);
+            status = UCS_ERR_IO_ERROR;
+            goto err_stop;
+        }
+        ++engine->num_threads;
+    }
+
+    pthread_attr_destroy(&attr);
+
+    ucs_debug("created copy engine '%s' with %u threads on numa node %d",
+              engine->name, num_threads, numa_node);
+    *engine_p = engine;
+    return UCS_OK;
+
+err_stop:
+    pthread_attr_destroy(&attr);
+    ucs_copy_engine_stop(engine, engine->num_threads);
+    ucs_free(engine);
+err:
+    return status;
+}
+
+void ucs_copy_engine_destroy(ucs_copy_engine_t *engine)
+{
+    ucs_copy_engine_stop(engine, engine->num_threads);
+    pthread_cond_destroy(&engine->done_cond);
+    pthread_cond_destroy(&engine->job_cond);
+    pthread_mutex_destroy(&engine->lock);
+    pthread_mutex_destroy(&engine->run_lock);
+    ucs_free(engine);
+}
+
+ucs_status_t ucs_copy_engine_run(ucs_copy_engine_t *engine, size_t length,
+                                 ucs_copy_engine_func_t func, void *arg)
+{
+    ucs_status_t status;
+    unsigned num_parts;
+
+    /* Every thread, including the caller, copies at most one part */
+    num_parts = ucs_min(length / engine->min_part, engine->num_threads + 1);
+    if (num_parts <= 1) {
+        return func(arg, 0, length);
+    }
+
+    pthread_mutex_lock(&engine->run_lock);
+    pthread_mutex_lock(&engine->lock);
+
+    engine->func       = func;
+    engine->arg        = arg;
+    engine->length     = length;
+    engine->part_size  = ucs_align_up(ucs_div_round_up(length, num_parts),
+                                      UCS_SYS_CACHE_LINE_SIZE);
+    engine->num_parts  = ucs_div_round_up(length, engine->part_size);
+    engine->next_part  = 0;
+    engine->done_parts = 0;
+    engine->status     = UCS_OK;
+    ++engine->generation;
+    pthread_cond_broadcast(&engine->job_cond);
+
+    ucs_copy_engine_work(engine);
+    while (engine->done_parts < engine->num_parts) {
+        pthread_cond_wait(&engine->done_cond, &engine->lock);
+    }
+
+    status = engine->status;
+    pthread_mutex_unlock(&engine->lock);
+    pthread_mutex_unlock(&engine->run_lock);
+    return status;
+}
+
+typedef struct {
+    void       *dst;
+    const void *src;
+    int        nt;      /* Use non-temporal stores */
+} ucs_copy_engine_memcpy_arg_t;
+
+static ucs_status_t ucs_copy_engine_memcpy_func(void *arg, size_t offset,
+                                                size_t length)
+{
+    ucs_copy_engine_memcpy_arg_t *mc = arg;
+
+    if (mc->nt) {
+        ucs_arch_memcpy_nt(mc->dst + offset, mc->src + offset, length);
+    } else {
+        memcpy(mc->dst + offset, mc->src + offset, length);
+    }
+    return UCS_OK;
+}
+
+void ucs_copy_engine_memcpy(ucs_copy_engine_t *engine, void *dst,
+                            const void *src, size_t length)
+{
+    ucs_copy_engine_memcpy_arg_t mc;
+
+    /* The parts are smaller than the threshold, but the whole copy evicts the
+     * caches of the copying CPUs as much as in ucs_memcpy_relaxed() */
+    mc.dst = dst;
+    mc.src = src;
+    mc.nt  = (length >= ucs_global_opts.memcpy_nt_thresh);
+
+    (void)ucs_copy_engine_run(engine, length, ucs_copy_engine_memcpy_func, &mc);
+}
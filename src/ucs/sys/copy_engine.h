@@ -0,0 +1,80 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCS_COPY_ENGINE_H_
+#define UCS_COPY_ENGINE_H_
+
+/*
+ * Parallel copy engine - splits a large copy to parts, which are copied
+ * concurrently by a set of helper threads and the calling thread. The helper
+ * threads sleep while there is nothing to copy.
+ * This data structure is thread safe, concurrent copies are serialized.
+ */
+#include <ucs/type/status.h>
+#include <stddef.h>
+
+
+typedef struct ucs_copy_engine ucs_copy_engine_t;
+
+
+/**
+ * Copy a part of a transfer. Called concurrently from several threads, for
+ * non-overlapping parts.
+ *
+ * @param [in]  arg     User argument, as passed to @ref ucs_copy_engine_run.
+ * @param [in]  offset  Offset of the part from the beginning of the transfer.
+ * @param [in]  length  Length of the part.
+ *
+ * @return UCS_OK if the part was copied, otherwise an error code.
+ */
+typedef ucs_status_t (*ucs_copy_engine_func_t)(void *arg, size_t offset,
+                                               size_t length);
+
+
+/**
+ * Create a copy engine.
+ *
+ * @param [in]  num_threads  Number of helper threads.
+ * @param [in]  min_part     Minimal size of a part copied by a single thread.
+ * @param [in]  numa_node    Run the helper threads on the CPUs of this NUMA
+ *                           node, or -1 to let them run on any CPU.
+ * @param [in]  name         Name of the engine, for debugging.
+ * @param [out] engine_p     Filled with a pointer to the copy engine.
+ */
+ucs_status_t ucs_copy_engine_create(unsigned num_threads, size_t min_part,
+                                    int numa_node, const char *name,
+                                    ucs_copy_engine_t **engine_p);
+
+
+/**
+ * Stop the helper threads and destroy the copy engine.
+ */
+void ucs_copy_engine_destroy(ucs_copy_engine_t *engine);
+
+
+/**
+ * Copy a transfer in parallel, and wait until all its parts are copied.
+ *
+ * @param [in]  engine   Copy engine.
+ * @param [in]  length   Total length of the transfer.
+ * @param [in]  func     Called to copy every part of the transfer.
+ * @param [in]  arg      User argument for @a func.
+ *
+ * @return UCS_OK if all parts were copied, otherwise the error returned by
+ *         one of the parts.
+ */
+ucs_status_t ucs_copy_engine_run(ucs_copy_engine_t *engine, size_t length,
+                                 ucs_copy_engine_func_t func, void *arg);
+
+
+/**
+ * Copy memory in parallel, like ucs_memcpy_relaxed().
+ */
+void ucs_copy_engine_memcpy(ucs_copy_engine_t *engine, void *dst,
+                            const void *src, size_t length);
+
+
+#endif
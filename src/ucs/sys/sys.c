@@ -14,6 +14,7 @@
 #include <ucs/debug/log.h>
 #include <ucs/time/time.h>
 
+#include <linux/mempolicy.h>
 #include <sys/ioctl.h>
 #include <sys/shm.h>
 #include <sys/mman.h>
@@ -25,6 +26,7 @@
 /* Default huge page size is 2 MBytes */
 #define UCS_DEFAULT_HUGEPAGE_SIZE  (2 * 1024 * 1024)
 #define UCS_PROCESS_MAPS_FILE      "/proc/self/maps"
+#define UCS_NUMA_MAX_NODES         1024
 
 
 const char *ucs_get_host_name()
@@ -432,6 +434,80 @@ size_t ucs_get_huge_page_size()
     return huge_page_size;
 }
 
+int ucs_numa_node_of_cpu(int cpu)
+{
+    char path[MAXPATHLEN];
+    struct dirent *entry;
+    int node;
+    DIR *dir;
+
+    /* The CPU directory has a link to the node it belongs to */
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+    dir = opendir(path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    node = -1;
+    while ((entry = readdir(dir)) != NULL) {
+        if (sscanf(entry->d_name, "node%d", &node) == 1) {
+            break;
+        }
+    }
+
+    closedir(dir);
+    return node;
+}
+
+int ucs_numa_current_node()
+{
+    int cpu = sched_getcpu();
+
+    return (cpu < 0) ? -1 : ucs_numa_node_of_cpu(cpu);
+}
+
+int ucs_numa_node_of_device(const char *dev_path)
+{
+    char buffer[16];
+    int node;
+
+    if ((ucs_read_file(buffer, sizeof(buffer), 1, "%s/numa_node", dev_path) < 0) ||
+        (sscanf(buffer, "%d", &node) != 1))
+    {
+        return -1;
+    }
+
+    /* -1 means the device is not attached to a specific node */
+    return node;
+}
+
+ucs_status_t ucs_numa_bind_memory(void *address, size_t length, int node)
+{
+    unsigned long nodemask[UCS_NUMA_MAX_NODES / (sizeof(unsigned long) * 8)];
+    uintptr_t start, end;
+    int ret;
+
+    if ((node < 0) || (node >= UCS_NUMA_MAX_NODES)) {
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    memset(nodemask, 0, sizeof(nodemask));
+    nodemask[node / (sizeof(unsigned long) * 8)] |=
+                    1ul << (node % (sizeof(unsigned long) * 8));
+
+    start = ucs_align_down_pow2((uintptr_t)address, ucs_get_page_size());
+    end   = ucs_align_up_pow2((uintptr_t)address + length, ucs_get_page_size());
+    ret   = syscall(__NR_mbind, start, end - start, MPOL_PREFERRED, nodemask,
+                    UCS_NUMA_MAX_NODES + 1, 0);
+    if (ret < 0) {
+        ucs_debug("mbind(address=%p, length=%zu, node=%d) failed: %m",
+                  (void*)start, end - start, node);
+        return UCS_ERR_UNSUPPORTED;
+    }
+
+    return UCS_OK;
+}
+
 size_t ucs_get_phys_mem_size()
 {
     static size_t phys_pages = 0;
@@ -281,6 +281,39 @@ const char* ucs_get_process_cmdline();
 pid_t ucs_get_tid(void);
 
 
+/**
+ * @return NUMA node of a CPU, or -1 if unknown.
+ */
+int ucs_numa_node_of_cpu(int cpu);
+
+
+/**
+ * @return NUMA node of the CPU the calling thread runs on, or -1 if unknown.
+ */
+int ucs_numa_current_node();
+
+
+/**
+ * Get the NUMA node of a device from sysfs.
+ *
+ * @param dev_path  Sysfs directory of the device, which contains "numa_node".
+ *
+ * @return NUMA node of the device, or -1 if unknown.
+ */
+int ucs_numa_node_of_device(const char *dev_path);
+
+
+/**
+ * Prefer to place the pages of a memory range on a NUMA node. Pages which
+ * were already touched are not moved.
+ *
+ * @param address  Start of the range, rounded down to a page boundary.
+ * @param length   Length of the range.
+ * @param node     NUMA node to place the pages on.
+ */
+ucs_status_t ucs_numa_bind_memory(void *address, size_t length, int node);
+
+
 /**
  * Get CPU frequency from /proc/cpuinfo. Return value is clocks-per-second.
  *
@@ -184,6 +184,8 @@ enum {
     UCT_IFACE_FLAG_CONNECT_TO_EP    = UCS_BIT(41), /**< Supports connecting to specific endpoint */
 
     /* Special transport flags */
+    UCT_IFACE_FLAG_PENDING_PRIO     = UCS_BIT(42), /**< Pending requests are dispatched according to
+                                                        their priority, see @ref uct_ep_pending_add_prio */
     UCT_IFACE_FLAG_AM_DUP           = UCS_BIT(43), /**< Active messages may be received with duplicates
                                                         This happens if the transport does not keep enough
                                                         information to detect retransmissions */
@@ -515,10 +517,15 @@ void uct_worker_destroy(uct_worker_h worker);
  *
  * @note @li In the current implementation, users @b MUST call this routine
  * to receive the active message requests.
+ * @note @li Interfaces which had no events recently are polled less
+ * frequently, according to UCX_PROGRESS_MAX_SKIP configuration.
  *
  * @param [in]  worker        Handle to worker.
+ *
+ * @return Number of events processed by the progress functions, 0 if no
+ *         progress was made.
  */
-void uct_worker_progress(uct_worker_h worker);
+unsigned uct_worker_progress(uct_worker_h worker);
 
 
 /**
@@ -526,6 +533,8 @@ void uct_worker_progress(uct_worker_h worker);
  * @brief Add a callback function to a worker progress.
  *
  * Add a function which will be called every time a progress is made on the worker.
+ * The function should return the number of events it has processed, which is
+ * used to poll idle functions less frequently.
  *
  * @param [in]  worker        Handle to worker.
  * @param [in]  func          Pointer to callback function.
@@ -1293,6 +1302,30 @@ UCT_INLINE_API ucs_status_t uct_ep_pending_add(uct_ep_h ep, uct_pending_req_t *r
 }
 
 
+/**
+ * @ingroup UCT_RESOURCE
+ * @brief Add a pending request to an endpoint, with a given priority.
+ *
+ *  Same as @ref uct_ep_pending_add, but the request is dispatched before any
+ * pending requests of a lower priority on the same endpoint. A request which
+ * was partially sent, and remains pending, may be bypassed between its
+ * fragments. Transports which do not support priorities dispatch all pending
+ * requests in the order they were added.
+ *
+ * @param [in]  ep    Endpoint to add the pending request to.
+ * @param [in]  req   Pending request, same as in @ref uct_ep_pending_add.
+ * @param [in]  prio  Request priority.
+ *
+ * @return Same as @ref uct_ep_pending_add.
+ */
+UCT_INLINE_API ucs_status_t uct_ep_pending_add_prio(uct_ep_h ep,
+                                                    uct_pending_req_t *req,
+                                                    uct_pending_prio_t prio)
+{
+    return ep->iface->ops.ep_pending_add_prio(ep, req, prio);
+}
+
+
 /**
  * @ingroup UCT_RESOURCE
  * @brief Remove all pending requests from an endpoint.
@@ -49,6 +49,22 @@ enum uct_am_trace_type {
     UCT_AM_TRACE_TYPE_LAST
 };
 
+
+/**
+ * @ingroup UCT_RESOURCE
+ * @brief Pending request priority.
+ *
+ * Pending requests of a higher priority are dispatched before requests of a
+ * lower priority, which are pending on the same endpoint. Requests of the same
+ * priority are dispatched in the order they were added.
+ */
+enum uct_pending_prio {
+    UCT_PENDING_PRIO_HIGH,    /**< Dispatched first, e.g control messages */
+    UCT_PENDING_PRIO_MEDIUM,  /**< Latency-sensitive requests */
+    UCT_PENDING_PRIO_LOW,     /**< Bulk data, the priority of @ref uct_ep_pending_add */
+    UCT_PENDING_PRIO_LAST
+};
+
 typedef struct uct_iface         *uct_iface_h;
 typedef struct uct_wakeup        *uct_wakeup_h;
 typedef struct uct_iface_config  uct_iface_config_t;
@@ -66,6 +82,7 @@ typedef struct uct_pending_req   uct_pending_req_t;
 typedef struct uct_worker        *uct_worker_h;
 typedef struct uct_pd            uct_pd_t;
 typedef enum uct_am_trace_type   uct_am_trace_type_t;
+typedef enum uct_pending_prio    uct_pending_prio_t;
 typedef struct uct_device_addr   uct_device_addr_t;
 typedef struct uct_iface_addr    uct_iface_addr_t;
 typedef struct uct_ep_addr       uct_ep_addr_t;
@@ -77,7 +94,11 @@ typedef struct uct_ep_addr       uct_ep_addr_t;
  * When the callback is called, `desc' does not necessarily contain the payload.
  * In this case, `data' would not point inside `desc', and user may want copy the
  * payload from `data' to `desc' before returning UCT_INPROGRESS (it's guaranteed
- * `desc' has enough room to hold the payload).
+ * `desc' has enough room to hold the payload, unless it was sent by
+ * @ref uct_ep_am_zcopy and is larger than the maximal bcopy size).
+ * A transport may pass the payload of @ref uct_ep_am_zcopy in the sender's
+ * buffer; in this case `data' stays valid until `desc' is released, and the
+ * sender's operation is completed only after that.
  *
  * @param [in]  arg      User-defined argument.
  * @param [in]  data     Points to the received data.
@@ -200,6 +200,14 @@ static ucs_status_t uct_base_ep_flush(uct_ep_h tl_ep)
     return UCS_OK;
 }
 
+static ucs_status_t uct_base_ep_pending_add_prio(uct_ep_h tl_ep,
+                                                 uct_pending_req_t *n,
+                                                 uct_pending_prio_t prio)
+{
+    /* Priorities are not supported, keep the order of all requests */
+    return uct_ep_pending_add(tl_ep, n);
+}
+
 UCS_CLASS_INIT_FUNC(uct_iface_t, uct_iface_ops_t *ops)
 {
 
@@ -211,6 +219,10 @@ UCS_CLASS_INIT_FUNC(uct_iface_t, uct_iface_ops_t *ops)
     if (ops->iface_flush == NULL) {
         self->ops.iface_flush = uct_base_iface_flush;
     }
+
+    if (ops->ep_pending_add_prio == NULL) {
+        self->ops.ep_pending_add_prio = uct_base_ep_pending_add_prio;
+    }
     return UCS_OK;
 }
 
@@ -0,0 +1,138 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "uct_netif.h"
+
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+#include <ucs/sys/sys.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <ifaddrs.h>
+#include <string.h>
+#include <unistd.h>
+
+
+int uct_netif_is_loopback(struct in_addr in_addr)
+{
+    return (ntohl(in_addr.s_addr) >> IN_CLASSA_NSHIFT) == IN_LOOPBACKNET;
+}
+
+ucs_status_t uct_netif_inaddr(const char *if_name, struct in_addr *in_addr,
+                              struct in_addr *netmask)
+{
+    struct ifreq ifr;
+    ucs_status_t status;
+    int fd;
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        ucs_error("socket() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    ucs_snprintf_zero(ifr.ifr_name, sizeof(ifr.ifr_name), "%s", if_name);
+    ifr.ifr_addr.sa_family = AF_INET;
+    if (ioctl(fd, SIOCGIFADDR, &ifr) < 0) {
+        ucs_error("failed to get the IPv4 address of %s: %m", if_name);
+        status = UCS_ERR_NO_DEVICE;
+        goto out;
+    }
+
+    *in_addr = ((struct sockaddr_in*)&ifr.ifr_addr)->sin_addr;
+
+    if (ioctl(fd, SIOCGIFNETMASK, &ifr) < 0) {
+        ucs_error("failed to get the netmask of %s: %m", if_name);
+        status = UCS_ERR_NO_DEVICE;
+        goto out;
+    }
+
+    *netmask = ((struct sockaddr_in*)&ifr.ifr_netmask)->sin_addr;
+    status   = UCS_OK;
+
+out:
+    close(fd);
+    return status;
+}
+
+int uct_netif_is_reachable(struct in_addr in_addr, struct in_addr netmask,
+                           uint64_t guid, struct in_addr remote_in_addr,
+                           uint64_t remote_guid)
+{
+    if (uct_netif_is_loopback(in_addr) || uct_netif_is_loopback(remote_in_addr)) {
+        return uct_netif_is_loopback(in_addr) &&
+               uct_netif_is_loopback(remote_in_addr) &&
+               (remote_guid == guid);
+    }
+
+    return (in_addr.s_addr & netmask.s_addr) ==
+           (remote_in_addr.s_addr & netmask.s_addr);
+}
+
+static int uct_netif_is_usable(const struct ifaddrs *ifa)
+{
+    return (ifa->ifa_addr != NULL) && (ifa->ifa_addr->sa_family == AF_INET) &&
+           (ifa->ifa_flags & IFF_UP) && (ifa->ifa_flags & IFF_RUNNING);
+}
+
+ucs_status_t uct_netif_query_tl_resources(const char *tl_name,
+                                          uct_tl_resource_desc_t **resource_p,
+                                          unsigned *num_resources_p)
+{
+    uct_tl_resource_desc_t *resources, *resource;
+    struct ifaddrs *ifaddrs, *ifa;
+    unsigned num_resources, i;
+
+    if (getifaddrs(&ifaddrs) < 0) {
+        ucs_error("getifaddrs() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    num_resources = 0;
+    for (ifa = ifaddrs; ifa != NULL; ifa = ifa->ifa_next) {
+        num_resources += uct_netif_is_usable(ifa);
+    }
+
+    resources = ucs_calloc(ucs_max(num_resources, 1), sizeof(*resources),
+                           "resource desc");
+    if (resources == NULL) {
+        ucs_error("Failed to allocate memory");
+        freeifaddrs(ifaddrs);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    /* a device is listed once even if it has several addresses */
+    num_resources = 0;
+    for (ifa = ifaddrs; ifa != NULL; ifa = ifa->ifa_next) {
+        if (!uct_netif_is_usable(ifa)) {
+            continue;
+        }
+
+        for (i = 0; i < num_resources; ++i) {
+            if (!strcmp(resources[i].dev_name, ifa->ifa_name)) {
+                break;
+            }
+        }
+        if (i < num_resources) {
+            continue;
+        }
+
+        resource = &resources[num_resources++];
+        ucs_snprintf_zero(resource->tl_name, sizeof(resource->tl_name), "%s",
+                          tl_name);
+        ucs_snprintf_zero(resource->dev_name, sizeof(resource->dev_name), "%s",
+                          ifa->ifa_name);
+        resource->dev_type = UCT_DEVICE_TYPE_NET;
+    }
+
+    freeifaddrs(ifaddrs);
+
+    *num_resources_p = num_resources;
+    *resource_p      = resources;
+    return UCS_OK;
+}
@@ -0,0 +1,39 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCT_NETIF_H_
+#define UCT_NETIF_H_
+
+#include <uct/api/uct.h>
+#include <netinet/in.h>
+
+
+/*
+ * IPv4 network interfaces, which are the devices of socket transports.
+ */
+
+int uct_netif_is_loopback(struct in_addr in_addr);
+
+ucs_status_t uct_netif_inaddr(const char *if_name, struct in_addr *in_addr,
+                              struct in_addr *netmask);
+
+/*
+ * Loopback addresses are reachable only from the loopback interface of the
+ * same host, and other addresses only from an interface on their subnet.
+ */
+int uct_netif_is_reachable(struct in_addr in_addr, struct in_addr netmask,
+                           uint64_t guid, struct in_addr remote_in_addr,
+                           uint64_t remote_guid);
+
+/*
+ * List the interfaces which are up and have an IPv4 address, as resources of
+ * the transport 'tl_name'.
+ */
+ucs_status_t uct_netif_query_tl_resources(const char *tl_name,
+                                          uct_tl_resource_desc_t **resource_p,
+                                          unsigned *num_resources_p);
+
+#endif
@@ -9,6 +9,7 @@
 #include "uct_iface.h"
 
 #include <uct/api/uct.h>
+#include <ucs/config/global_opts.h>
 #include <ucs/debug/log.h>
 #include <ucs/debug/memtrack.h>
 #include <ucs/type/class.h>
@@ -193,8 +194,9 @@ ucs_status_t uct_single_pd_resource(uct_pd_component_t *pdc,
 static UCS_CLASS_INIT_FUNC(uct_worker_t, ucs_async_context_t *async,
                            ucs_thread_mode_t thread_mode)
 {
-    self->async       = async;
-    self->thread_mode = thread_mode;
+    self->async             = async;
+    self->thread_mode       = thread_mode;
+    self->progress_max_skip = ucs_global_opts.progress_max_skip;
     ucs_callbackq_init(&self->progress_q, 64, async);
     ucs_list_head_init(&self->tl_data);
     return UCS_OK;
@@ -205,9 +207,10 @@ static UCS_CLASS_CLEANUP_FUNC(uct_worker_t)
     ucs_callbackq_cleanup(&self->progress_q);
 }
 
-void uct_worker_progress(uct_worker_h worker)
+unsigned uct_worker_progress(uct_worker_h worker)
 {
-    ucs_callbackq_dispatch(&worker->progress_q);
+    return ucs_callbackq_dispatch_adaptive(&worker->progress_q,
+                                           worker->progress_max_skip);
 }
 
 
@@ -0,0 +1,129 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "uct_sock_pd.h"
+
+#include <ucs/debug/log.h>
+#include <ucs/debug/memtrack.h>
+
+
+#define UCT_SOCK_RKEY_GEN_SHIFT  32
+
+
+ucs_status_t uct_sock_pd_open(uct_pd_component_t *component, uct_pd_ops_t *ops,
+                              uct_pd_h *pd_p)
+{
+    uct_sock_pd_t *pd;
+    ucs_status_t status;
+
+    pd = ucs_malloc(sizeof(*pd), "sock_pd");
+    if (pd == NULL) {
+        ucs_error("Failed to allocate memory for %s pd", component->name);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    status = ucs_spinlock_init(&pd->lock);
+    if (status != UCS_OK) {
+        ucs_free(pd);
+        return status;
+    }
+
+    pd->super.ops       = ops;
+    pd->super.component = component;
+    ucs_ptr_array_init(&pd->regions, 0, "sock_pd_regions");
+
+    *pd_p = &pd->super;
+    return UCS_OK;
+}
+
+void uct_sock_pd_close(uct_pd_h tl_pd)
+{
+    uct_sock_pd_t *pd = ucs_derived_of(tl_pd, uct_sock_pd_t);
+
+    ucs_ptr_array_cleanup(&pd->regions);
+    pthread_spin_destroy(&pd->lock.lock);
+    ucs_free(pd);
+}
+
+ucs_status_t uct_sock_mem_reg(uct_pd_h tl_pd, void *address, size_t length,
+                              uct_mem_h *memh_p)
+{
+    uct_sock_pd_t *pd = ucs_derived_of(tl_pd, uct_sock_pd_t);
+    uct_sock_memh_t *memh;
+    uint32_t gen;
+    unsigned index;
+
+    memh = ucs_malloc(sizeof(*memh), "sock_memh");
+    if (memh == NULL) {
+        ucs_error("Failed to allocate memory handle");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    memh->address = (uintptr_t)address;
+    memh->length  = length;
+
+    ucs_spin_lock(&pd->lock);
+    index      = ucs_ptr_array_insert(&pd->regions, memh, &gen);
+    memh->key  = ((uint64_t)gen << UCT_SOCK_RKEY_GEN_SHIFT) | index;
+    ucs_spin_unlock(&pd->lock);
+
+    ucs_trace("registered %p length %zu with key 0x%"PRIx64, address, length,
+              memh->key);
+    *memh_p = memh;
+    return UCS_OK;
+}
+
+ucs_status_t uct_sock_mem_dereg(uct_pd_h tl_pd, uct_mem_h tl_memh)
+{
+    uct_sock_pd_t *pd = ucs_derived_of(tl_pd, uct_sock_pd_t);
+    uct_sock_memh_t *memh = tl_memh;
+    uint32_t gen = memh->key >> UCT_SOCK_RKEY_GEN_SHIFT;
+
+    /* the next region in the slot gets a new generation */
+    ucs_spin_lock(&pd->lock);
+    ucs_ptr_array_remove(&pd->regions, (uint32_t)memh->key, gen + 1);
+    ucs_spin_unlock(&pd->lock);
+
+    ucs_free(memh);
+    return UCS_OK;
+}
+
+ucs_status_t uct_sock_mkey_pack(uct_pd_h pd, uct_mem_h tl_memh,
+                                void *rkey_buffer)
+{
+    uct_sock_memh_t *memh = tl_memh;
+
+    *(uint64_t*)rkey_buffer = memh->key;
+    return UCS_OK;
+}
+
+ucs_status_t uct_sock_rkey_unpack(uct_pd_component_t *pdc,
+                                  const void *rkey_buffer, uct_rkey_t *rkey_p,
+                                  void **handle_p)
+{
+    /* the key is sent to the peer, which looks up the region */
+    *rkey_p   = *(const uint64_t*)rkey_buffer;
+    *handle_p = NULL;
+    return UCS_OK;
+}
+
+int uct_sock_pd_is_accessible(uct_pd_h tl_pd, uint64_t rkey, uint64_t address,
+                              uint64_t length)
+{
+    uct_sock_pd_t *pd = ucs_derived_of(tl_pd, uct_sock_pd_t);
+    uct_sock_memh_t *memh;
+    int accessible;
+
+    ucs_spin_lock(&pd->lock);
+    accessible = ucs_ptr_array_lookup(&pd->regions, (uint32_t)rkey, memh) &&
+                 (memh->key == rkey) &&
+                 (address >= memh->address) &&
+                 (length <= memh->length) &&
+                 (address - memh->address <= memh->length - length);
+    ucs_spin_unlock(&pd->lock);
+
+    return accessible;
+}
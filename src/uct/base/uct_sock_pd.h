@@ -0,0 +1,67 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCT_SOCK_PD_H_
+#define UCT_SOCK_PD_H_
+
+#include "uct_pd.h"
+
+#include <ucs/datastruct/ptr_array.h>
+#include <ucs/type/spinlock.h>
+
+
+/*
+ * Protection domain of socket transports. The peer copies the data of remote
+ * memory accesses to and from its own address space, so it checks that the
+ * accessed range is inside a region which was registered with the remote key
+ * it received.
+ *
+ * The remote key is the index of the region in the registration table, and
+ * the generation of the table slot in the upper 32 bits, so a key of a region
+ * which was deregistered does not match a new region in the same slot.
+ */
+typedef struct uct_sock_pd {
+    uct_pd_t                super;
+    ucs_spinlock_t          lock;       /* Regions are looked up by async
+                                           progress */
+    ucs_ptr_array_t         regions;    /* Registered regions, by key index */
+} uct_sock_pd_t;
+
+
+typedef struct uct_sock_memh {
+    uintptr_t               address;
+    size_t                  length;
+    uint64_t                key;
+} uct_sock_memh_t;
+
+
+#define UCT_SOCK_RKEY_PACKED_SIZE  sizeof(uint64_t)
+
+
+ucs_status_t uct_sock_pd_open(uct_pd_component_t *component, uct_pd_ops_t *ops,
+                              uct_pd_h *pd_p);
+
+void uct_sock_pd_close(uct_pd_h pd);
+
+ucs_status_t uct_sock_mem_reg(uct_pd_h pd, void *address, size_t length,
+                              uct_mem_h *memh_p);
+
+ucs_status_t uct_sock_mem_dereg(uct_pd_h pd, uct_mem_h memh);
+
+ucs_status_t uct_sock_mkey_pack(uct_pd_h pd, uct_mem_h memh, void *rkey_buffer);
+
+ucs_status_t uct_sock_rkey_unpack(uct_pd_component_t *pdc,
+                                  const void *rkey_buffer, uct_rkey_t *rkey_p,
+                                  void **handle_p);
+
+/*
+ * Check that [address, address + length) is inside the region registered
+ * with the remote key 'rkey'.
+ */
+int uct_sock_pd_is_accessible(uct_pd_h pd, uint64_t rkey, uint64_t address,
+                              uint64_t length);
+
+#endif
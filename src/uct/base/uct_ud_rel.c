@@ -0,0 +1,194 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "uct_ud_rel.h"
+
+#include <ucs/debug/log.h>
+
+
+void uct_ud_rel_reset(uct_ud_rel_t *rel
+                      UCS_STATS_ARG(ucs_stats_node_t *stats_parent))
+{
+    rel->ctl_ops        = UCT_UD_REL_OP_NONE;
+    rel->tx.psn         = UCT_UD_INITIAL_PSN;
+    rel->ca.cwnd        = UCT_UD_CA_MIN_WINDOW;
+    rel->tx.max_psn     = rel->tx.psn + rel->ca.cwnd;
+    rel->tx.acked_psn   = UCT_UD_INITIAL_PSN - 1;
+    ucs_queue_head_init(&rel->tx.window);
+
+    rel->resend.pos       = ucs_queue_iter_begin(&rel->tx.window);
+    rel->resend.psn       = rel->tx.psn;
+    rel->resend.max_psn   = rel->tx.acked_psn;
+
+    rel->rx.acked_psn = UCT_UD_INITIAL_PSN - 1;
+    ucs_frag_list_init(rel->tx.psn-1, &rel->rx.ooo_pkts, 0 /*TODO: ooo support */
+                       UCS_STATS_ARG(stats_parent));
+}
+
+void uct_ud_rel_ca_drop(uct_ud_rel_t *rel)
+{
+    ucs_debug("rel: %p ca drop@cwnd = %d in flight: %d",
+              rel, rel->ca.cwnd, (int)rel->tx.psn-(int)rel->tx.acked_psn-1);
+    rel->ca.cwnd /= UCT_UD_CA_MD_FACTOR;
+    if (rel->ca.cwnd < UCT_UD_CA_MIN_WINDOW) {
+        rel->ca.cwnd = UCT_UD_CA_MIN_WINDOW;
+    }
+    rel->tx.max_psn    = rel->tx.acked_psn + rel->ca.cwnd;
+    if (UCT_UD_PSN_COMPARE(rel->tx.max_psn, >, rel->tx.psn)) {
+        /* do not send more until we get acks going */
+        rel->tx.max_psn = rel->tx.psn;
+    }
+}
+
+static void uct_ud_rel_resend_start(uct_ud_rel_t *rel)
+{
+    rel->resend.max_psn   = rel->tx.psn - 1;
+    rel->resend.psn       = rel->tx.acked_psn + 1;
+    rel->resend.pos       = ucs_queue_iter_begin(&rel->tx.window);
+    uct_ud_rel_ctl_op_add(rel, UCT_UD_REL_OP_RESEND);
+}
+
+static void uct_ud_rel_resend_ack(uct_ud_rel_t *rel)
+{
+    if (UCT_UD_PSN_COMPARE(rel->tx.acked_psn, <, rel->resend.max_psn)) {
+        /* new ack arrived that acked something in our resend window. */
+        if (UCT_UD_PSN_COMPARE(rel->resend.psn, <=, rel->tx.acked_psn)) {
+            ucs_debug("rel(%p): ack received during resend resend.psn=%d tx.acked_psn=%d",
+                      rel, rel->resend.psn, rel->tx.acked_psn);
+            rel->resend.pos = ucs_queue_iter_begin(&rel->tx.window);
+            rel->resend.psn = rel->tx.acked_psn + 1;
+        }
+        uct_ud_rel_ctl_op_add(rel, UCT_UD_REL_OP_RESEND);
+        return;
+    }
+
+    /* everything in resend window was acked - no need to resend anymore */
+    rel->resend.psn = rel->resend.max_psn + 1;
+    uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_RESEND);
+}
+
+void uct_ud_rel_release(uct_ud_rel_t *rel, int is_async)
+{
+    const uct_ud_rel_ops_t *ops = rel->ops;
+    ucs_queue_elem_t *elem;
+
+    /* Release acknowledged skb's */
+    while (!ucs_queue_is_empty(&rel->tx.window)) {
+        elem = rel->tx.window.head;
+        if (UCT_UD_PSN_COMPARE(ops->skb_neth(elem)->psn, >, rel->tx.acked_psn)) {
+            break;
+        }
+        ucs_queue_pull_non_empty(&rel->tx.window);
+        ops->skb_release(rel, elem, is_async);
+    }
+
+    if (ucs_unlikely(UCT_UD_PSN_COMPARE(rel->resend.psn, <=,
+                                        rel->resend.max_psn))) {
+        uct_ud_rel_resend_ack(rel);
+    }
+
+    ops->schedule(rel);
+    rel->tx.send_time = ops->get_time(rel);
+}
+
+/*
+ * Handling retransmits
+ *
+ * It is possible that the sender is slow. Try to flush the window twice
+ * before going into full resend mode. The 3x is needed to avoid false resends
+ * because of errors in timekeeping.
+ */
+int uct_ud_rel_timer(uct_ud_rel_t *rel, ucs_time_t now, ucs_time_t tick)
+{
+    if (ucs_queue_is_empty(&rel->tx.window)) {
+        return 0;
+    }
+
+    if ((now - rel->tx.send_time > tick) && rel->ops->is_connected(rel)) {
+        uct_ud_rel_ctl_op_add(rel, UCT_UD_REL_OP_ACK_REQ);
+    }
+
+    if (now - rel->tx.send_time > 3 * tick) {
+        ucs_trace("rel(%p): scheduling resend now: %llu send_time: %llu"
+                  " tick: %llu", rel, (unsigned long long)now,
+                  (unsigned long long)rel->tx.send_time,
+                  (unsigned long long)tick);
+        rel->tx.send_time = now;
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_ACK_REQ);
+        uct_ud_rel_ca_drop(rel);
+        uct_ud_rel_resend_start(rel);
+    }
+
+    return 1;
+}
+
+static void uct_ud_rel_resend(uct_ud_rel_t *rel)
+{
+    ucs_queue_elem_t *elem = *rel->resend.pos;
+    uct_ud_psn_t psn;
+    int ack_req;
+
+    /* check window */
+    psn = rel->ops->skb_neth(elem)->psn;
+    if (UCT_UD_PSN_COMPARE(psn, >=, rel->tx.max_psn)) {
+        ucs_debug("rel(%p): out of window(psn=%d/max_psn=%d) - can not resend more",
+                  rel, psn, rel->tx.max_psn);
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_RESEND);
+        return;
+    }
+
+    /* force ack request on every Nth packet or on first packet in resend window */
+    ack_req = ((psn % UCT_UD_RESENDS_PER_ACK) == 0) ||
+              UCT_UD_PSN_COMPARE(psn, ==, rel->tx.acked_psn + 1);
+
+    ucs_debug("rel(%p): resending rt_psn %u rt_max_psn %u acked_psn %u max_psn %u ack_req %d",
+              rel, psn, rel->resend.max_psn, rel->tx.acked_psn, rel->tx.max_psn,
+              ack_req);
+    rel->ops->skb_resend(rel, elem, ack_req);
+
+    rel->resend.pos = ucs_queue_iter_next(rel->resend.pos);
+    rel->resend.psn = psn;
+    if (UCT_UD_PSN_COMPARE(rel->resend.psn, ==, rel->resend.max_psn)) {
+        ucs_debug("rel(%p): resending completed", rel);
+        rel->resend.psn = rel->resend.max_psn + 1;
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_RESEND);
+    }
+}
+
+/**
+ * Control operations are sent according to priority:
+ * - connection request, which is put in the send window
+ * - connection reply
+ * - resends
+ * - ack replies/ack requests, which are also carried by the data packets.
+ *   They are sent to the endpoint of the peer, so they are dropped until it
+ *   is known, and the peer sends its packets again.
+ */
+void uct_ud_rel_do_pending_ctl(uct_ud_rel_t *rel)
+{
+    const uct_ud_rel_ops_t *ops = rel->ops;
+
+    if (uct_ud_rel_ctl_op_check(rel, UCT_UD_REL_OP_CREQ)) {
+        if (ops->send_creq(rel) == UCS_OK) {
+            uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_CREQ);
+        }
+    } else if (uct_ud_rel_ctl_op_check(rel, UCT_UD_REL_OP_CREP)) {
+        ops->send_crep(rel);
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_CREP);
+    } else if (uct_ud_rel_ctl_op_check(rel, UCT_UD_REL_OP_RESEND)) {
+        uct_ud_rel_resend(rel);
+    } else if (!ops->is_connected(rel)) {
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_CTL_LOW_PRIO);
+    } else if (uct_ud_rel_ctl_op_check(rel, UCT_UD_REL_OP_ACK)) {
+        ops->send_ack(rel, 0);
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_ACK);
+    } else if (uct_ud_rel_ctl_op_check(rel, UCT_UD_REL_OP_ACK_REQ)) {
+        ops->send_ack(rel, 1);
+        uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_ACK_REQ);
+    } else if (uct_ud_rel_ctl_op_isany(rel)) {
+        ucs_fatal("unsupported pending op mask: %x", rel->ctl_ops);
+    }
+}
@@ -0,0 +1,336 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#ifndef UCT_UD_REL_H_
+#define UCT_UD_REL_H_
+
+#include <ucs/datastruct/frag_list.h>
+#include <ucs/datastruct/queue.h>
+#include <ucs/sys/math.h>
+#include <ucs/time/time.h>
+#include <ucs/type/status.h>
+
+
+/*
+ * Reliability protocol of datagram transports: packet sequence numbers, acks,
+ * congestion avoidance and retransmits. The protocol does not depend on the
+ * datagram backend, which owns the packets in the send window and sends them.
+ */
+
+#define UCT_UD_INITIAL_PSN      1   /* initial packet serial number */
+/* congestion avoidance settings. See below for details */
+#define UCT_UD_CA_AI_VALUE      1   /* window += AI_VALUE */
+#define UCT_UD_CA_MD_FACTOR     2   /* window = window/factor */
+#define UCT_UD_CA_DUP_ACK_CNT   2   /* TODO: not implemented yet */
+#define UCT_UD_RESENDS_PER_ACK  4   /* request per every N resends */
+
+/* note that the ud tx window is [acked_psn+1, max_psn)
+ * and max_psn = acked_psn + cwnd
+ * so add 1 to the max/min window constants instead of doing this in the code
+ */
+#define UCT_UD_CA_MIN_WINDOW    2
+#define UCT_UD_CA_MAX_WINDOW    1025
+
+#define UCT_UD_EP_NULL_ID       ((1<<24)-1)
+#define UCT_UD_EP_ID_MAX        UCT_UD_EP_NULL_ID
+#define UCT_UD_EP_CONN_ID_MAX   UCT_UD_EP_ID_MAX
+
+
+typedef uint16_t                 uct_ud_psn_t;
+#define UCT_UD_PSN_COMPARE       UCS_CIRCULAR_COMPARE16
+
+enum {
+    UCT_UD_PACKET_ACK_REQ_SHIFT   = 25,
+    UCT_UD_PACKET_AM_ID_SHIFT     = 27,
+    UCT_UD_PACKET_DEST_ID_SHIFT   = 24,
+    UCT_UD_PACKET_PUT_SHIFT       = 28,
+};
+
+enum {
+    UCT_UD_PACKET_FLAG_AM      = UCS_BIT(24),
+    UCT_UD_PACKET_FLAG_ACK_REQ = UCS_BIT(25),
+    UCT_UD_PACKET_FLAG_ECN     = UCS_BIT(26),
+    UCT_UD_PACKET_FLAG_NAK     = UCS_BIT(27),
+    UCT_UD_PACKET_FLAG_PUT     = UCS_BIT(28),
+    UCT_UD_PACKET_FLAG_CTL     = UCS_BIT(29),
+
+    UCT_UD_PACKET_AM_ID_MASK     = UCS_MASK(UCT_UD_PACKET_AM_ID_SHIFT),
+    UCT_UD_PACKET_DEST_ID_MASK   = UCS_MASK(UCT_UD_PACKET_DEST_ID_SHIFT),
+};
+
+/*
+ * Network header of all packets: the destination endpoint and the type of the
+ * packet, and the sequence numbers of the reliability protocol.
+ */
+typedef struct uct_ud_neth {
+    uint32_t            packet_type;
+    uct_ud_psn_t        psn;
+    uct_ud_psn_t        ack_psn;
+} UCS_S_PACKED uct_ud_neth_t;
+
+/*
+ * Control operations of an endpoint. The operations are sent by the progress
+ * of the backend, along with the pending requests of the user.
+ */
+enum {
+    UCT_UD_REL_OP_NONE      = 0,
+    UCT_UD_REL_OP_ACK       = UCS_BIT(0),  /* ack data */
+    UCT_UD_REL_OP_ACK_REQ   = UCS_BIT(1),  /* request ack of sent packets */
+    UCT_UD_REL_OP_RESEND    = UCS_BIT(2),  /* resend un acked packets */
+    UCT_UD_REL_OP_CREP      = UCS_BIT(3),  /* send connection reply */
+    UCT_UD_REL_OP_CREQ      = UCS_BIT(4)   /* send connection request */
+};
+
+#define UCT_UD_REL_OP_CTL_LOW_PRIO (UCT_UD_REL_OP_ACK_REQ|UCT_UD_REL_OP_ACK)
+#define UCT_UD_REL_OP_CTL_HI_PRIO  (UCT_UD_REL_OP_CREQ|UCT_UD_REL_OP_CREP|UCT_UD_REL_OP_RESEND)
+
+
+/* Congestion avoidance and retransmits
+ *
+ * UD uses additive increase/multiplicative decrease algorightm
+ * See https://en.wikipedia.org/wiki/Additive_increase/multiplicative_decrease
+ *
+ * tx window is increased when ack is received and decreased when
+ * resend is scheduled. Ack must be a 'new' one that is it must
+ * acknowledge packets on window. Increasing window on ack does not casue
+ * exponential window increase because, unlike tcp, only two acks
+ * per window are sent.
+ *
+ * Todo:
+ *
+ * Consider trigering window decrease before resend timeout:
+ * - on ECN (explicit congestion notification) from receiever. ECN can
+ *   be based on some heuristic. For example on number of rx completions
+ *   that receiver picked from CQ.
+ * - upon receiving a 'duplicate ack' packet
+ *
+ * Consider using other algorithm (ex BIC/CUBIC)
+ */
+
+/*
+ * Handling retransmits
+ *
+ * On slow timer timeout schedule a retransmit operation for
+ * [acked_psn+1, psn-1]. These values are saved as 'resend window'
+ *
+ * Resend operation will resend no more then the current cwnd
+ * If ack arrives when resend window is active it means that
+ *  - something new in the resend window was acked. As a
+ *  resutlt a new resend operation will be scheduled.
+ *  - either resend window or something beyond it was
+ *  acked. It means that no more retransmisions are needed.
+ *  Current 'resend window' is deactivated
+ *
+ * When retransmitting, ack is requested if:
+ * psn == acked_psn + 1 or
+ * psn % UCT_UD_RESENDS_PER_ACK = 0
+ */
+
+typedef struct uct_ud_rel     uct_ud_rel_t;
+
+
+/*
+ * Operations of the datagram backend, which owns the packets in the send
+ * window and the connection of the endpoint.
+ */
+typedef struct uct_ud_rel_ops {
+    /* Whether the endpoint of the peer is known */
+    int            (*is_connected)(uct_ud_rel_t *rel);
+
+    /* Time of the retransmit timer */
+    ucs_time_t     (*get_time)(uct_ud_rel_t *rel);
+
+    /* Schedule the control operations and pending requests of the endpoint */
+    void           (*schedule)(uct_ud_rel_t *rel);
+
+    /* Network header of a packet in the send window */
+    uct_ud_neth_t* (*skb_neth)(ucs_queue_elem_t *elem);
+
+    /* Release a packet of the send window, which the peer acknowledged */
+    void           (*skb_release)(uct_ud_rel_t *rel, ucs_queue_elem_t *elem,
+                                  int is_async);
+
+    /* Send a packet of the send window again, with the ack of the received
+     * packets, and an ack request if 'ack_req' is set */
+    void           (*skb_resend)(uct_ud_rel_t *rel, ucs_queue_elem_t *elem,
+                                 int ack_req);
+
+    /* Send a connection request, and put it in the send window. Returns
+     * UCS_ERR_NO_RESOURCE if it should be sent later. */
+    ucs_status_t   (*send_creq)(uct_ud_rel_t *rel);
+
+    /* Send a connection reply */
+    void           (*send_crep)(uct_ud_rel_t *rel);
+
+    /* Send an ack without data, and an ack request if 'ack_req' is set */
+    void           (*send_ack)(uct_ud_rel_t *rel, int ack_req);
+} uct_ud_rel_ops_t;
+
+
+/*
+ * Reliability state of an endpoint. The send window is a queue of packets of
+ * the backend, in psn order.
+ */
+struct uct_ud_rel {
+    const uct_ud_rel_ops_t      *ops;
+    uint32_t                    ctl_ops;  /* bitmask of scheduled UCT_UD_REL_OP_xx */
+    struct {
+         uct_ud_psn_t           psn;          /* Next PSN to send */
+         uct_ud_psn_t           max_psn;      /* Largest PSN that can be sent */
+         uct_ud_psn_t           acked_psn;    /* last psn that was acked by remote side */
+         ucs_queue_head_t       window;       /* send window: [acked_psn+1, psn-1] */
+         ucs_time_t             send_time;    /* tx time of last packet */
+    } tx;
+    struct {
+         uct_ud_psn_t           psn;       /* last psn that was retransmitted */
+         uct_ud_psn_t           max_psn;   /* max psn that should be retransmitted */
+         ucs_queue_iter_t       pos;       /* points to the part of tx window that needs to be resent */
+    } resend;
+    struct {
+        uct_ud_psn_t  wmax;
+        uct_ud_psn_t  cwnd;
+    } ca;
+    struct {
+        uct_ud_psn_t        acked_psn;    /* Last psn we acked */
+        ucs_frag_list_t     ooo_pkts;     /* Out of order packets that can not be processed yet,
+                                            also keeps last psn we successfully received and processed */
+    } rx;
+};
+
+
+void uct_ud_rel_reset(uct_ud_rel_t *rel
+                      UCS_STATS_ARG(ucs_stats_node_t *stats_parent));
+
+void uct_ud_rel_ca_drop(uct_ud_rel_t *rel);
+
+void uct_ud_rel_release(uct_ud_rel_t *rel, int is_async);
+
+int uct_ud_rel_timer(uct_ud_rel_t *rel, ucs_time_t now, ucs_time_t tick);
+
+void uct_ud_rel_do_pending_ctl(uct_ud_rel_t *rel);
+
+
+static inline uint32_t uct_ud_neth_get_dest_id(uct_ud_neth_t *neth)
+{
+    return neth->packet_type & UCT_UD_PACKET_DEST_ID_MASK;
+}
+static inline void uct_ud_neth_set_dest_id(uct_ud_neth_t *neth, uint32_t id)
+{
+    neth->packet_type |= id;
+}
+
+static inline uint8_t uct_ud_neth_get_am_id(uct_ud_neth_t *neth)
+{
+    return neth->packet_type >> UCT_UD_PACKET_AM_ID_SHIFT;
+}
+static inline void uct_ud_neth_set_am_id(uct_ud_neth_t *neth, uint8_t id)
+{
+    neth->packet_type |= (id << UCT_UD_PACKET_AM_ID_SHIFT);
+}
+
+static UCS_F_ALWAYS_INLINE void
+uct_ud_rel_ctl_op_add(uct_ud_rel_t *rel, uint32_t ops)
+{
+    rel->ctl_ops |= ops;
+    rel->ops->schedule(rel);
+}
+
+static UCS_F_ALWAYS_INLINE void
+uct_ud_rel_ctl_op_del(uct_ud_rel_t *rel, uint32_t ops)
+{
+    rel->ctl_ops &= ~ops;
+}
+
+static UCS_F_ALWAYS_INLINE int
+uct_ud_rel_ctl_op_check(uct_ud_rel_t *rel, uint32_t ops)
+{
+    return rel->ctl_ops & ops;
+}
+
+static UCS_F_ALWAYS_INLINE int uct_ud_rel_ctl_op_isany(uct_ud_rel_t *rel)
+{
+    return rel->ctl_ops;
+}
+
+/* Whether only the given operations are scheduled */
+static UCS_F_ALWAYS_INLINE int
+uct_ud_rel_ctl_op_check_ex(uct_ud_rel_t *rel, uint32_t ops)
+{
+    return rel->ctl_ops == ops;
+}
+
+/* Fill the sequence numbers of a packet, and acknowledge received packets */
+static UCS_F_ALWAYS_INLINE void
+uct_ud_rel_neth_init(uct_ud_rel_t *rel, uct_ud_neth_t *neth)
+{
+    neth->psn     = rel->tx.psn;
+    neth->ack_psn = rel->rx.acked_psn = ucs_frag_list_sn(&rel->rx.ooo_pkts);
+}
+
+/* Account a packet which was sent and put in the send window */
+static UCS_F_ALWAYS_INLINE void
+uct_ud_rel_tx_skb(uct_ud_rel_t *rel, ucs_queue_elem_t *elem, ucs_time_t now)
+{
+    rel->tx.psn++;
+    ucs_queue_push(&rel->tx.window, elem);
+    rel->tx.send_time = now;
+}
+
+static UCS_F_ALWAYS_INLINE int uct_ud_rel_no_window(uct_ud_rel_t *rel)
+{
+    /* max_psn can be decreased by CA, so check >= */
+    return UCT_UD_PSN_COMPARE(rel->tx.psn, >=, rel->tx.max_psn);
+}
+
+/*
+ * Request ACK once we sent 1/4 of the window or once we got to the window end
+ * or there is a pending ack request operation
+ */
+static UCS_F_ALWAYS_INLINE int uct_ud_rel_req_ack(uct_ud_rel_t *rel)
+{
+    uct_ud_psn_t acked_psn, max_psn, psn;
+
+    max_psn   = rel->tx.max_psn;
+    acked_psn = rel->tx.acked_psn;
+    psn       = rel->tx.psn;
+
+    return UCT_UD_PSN_COMPARE(psn, ==, ((acked_psn * 3 + max_psn) >> 2)) ||
+           UCT_UD_PSN_COMPARE(psn + 1, ==, max_psn) ||
+           uct_ud_rel_ctl_op_check(rel, UCT_UD_REL_OP_ACK_REQ);
+}
+
+/*
+ * Set the ack request flag of a data packet, which also carries the ack of
+ * the received packets, so the scheduled ack operations are done.
+ */
+static UCS_F_ALWAYS_INLINE void
+uct_ud_rel_neth_ack_req(uct_ud_rel_t *rel, uct_ud_neth_t *neth)
+{
+    neth->packet_type |= uct_ud_rel_req_ack(rel) << UCT_UD_PACKET_ACK_REQ_SHIFT;
+    uct_ud_rel_ctl_op_del(rel, UCT_UD_REL_OP_ACK|UCT_UD_REL_OP_ACK_REQ);
+}
+
+/*
+ * Process the ack of a received packet: release the acknowledged packets of
+ * the send window, and restart the resend from the first packet which was
+ * not acknowledged.
+ */
+static UCS_F_ALWAYS_INLINE void
+uct_ud_rel_process_ack(uct_ud_rel_t *rel, uct_ud_psn_t ack_psn, int is_async)
+{
+    if (ucs_unlikely(UCT_UD_PSN_COMPARE(ack_psn, <=, rel->tx.acked_psn))) {
+        return;
+    }
+
+    rel->tx.acked_psn = ack_psn;
+    if (rel->ca.cwnd < UCT_UD_CA_MAX_WINDOW) {
+        rel->ca.cwnd += UCT_UD_CA_AI_VALUE;
+    }
+    rel->tx.max_psn = rel->tx.acked_psn + rel->ca.cwnd;
+    uct_ud_rel_release(rel, is_async);
+}
+
+#endif
@@ -38,7 +38,7 @@ static ucs_config_field_t uct_cm_iface_config_table[] = {
 static uct_ib_iface_ops_t uct_cm_iface_ops;
 
 
-static void uct_cm_iface_progress(void *arg)
+static unsigned uct_cm_iface_progress(void *arg)
 {
     uct_cm_pending_req_priv_t *priv;
     uct_cm_iface_t *iface = arg;
@@ -50,6 +50,7 @@ static void uct_cm_iface_progress(void *arg)
 
     ucs_callbackq_remove(&uct_cm_iface_worker(iface)->progress_q,
                          uct_cm_iface_progress, iface);
+    return 1;
 }
 
 ucs_status_t uct_cm_iface_flush_do(uct_iface_h tl_iface)
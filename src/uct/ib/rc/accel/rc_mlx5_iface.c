@@ -102,7 +102,7 @@ static UCS_F_NOINLINE unsigned uct_rc_mlx5_iface_post_recv(uct_rc_mlx5_iface_t *
     return count;
 }
 
-static UCS_F_ALWAYS_INLINE void 
+static UCS_F_ALWAYS_INLINE unsigned
 uct_rc_mlx5_iface_poll_tx(uct_rc_mlx5_iface_t *iface)
 {
     struct mlx5_cqe64 *cqe;
@@ -112,7 +112,7 @@ uct_rc_mlx5_iface_poll_tx(uct_rc_mlx5_iface_t *iface)
 
     cqe = uct_ib_mlx5_get_cqe(&iface->tx.cq, UCT_IB_MLX5_CQE64_SIZE_LOG);
     if (cqe == NULL) {
-        return;
+        return 0;
     }
 
     UCS_STATS_UPDATE_COUNTER(iface->super.stats, UCT_RC_IFACE_STAT_TX_COMPLETION, 1);
@@ -128,6 +128,7 @@ uct_rc_mlx5_iface_poll_tx(uct_rc_mlx5_iface_t *iface)
     ++iface->super.tx.cq_available;
 
     uct_rc_ep_process_tx_completion(&iface->super, &ep->super, hw_ci);
+    return 1;
 }
 
 static inline void uct_rc_mlx5_iface_rx_inline(uct_rc_mlx5_iface_t *iface,
@@ -231,15 +232,16 @@ done:
     return status;
 }
 
-void uct_rc_mlx5_iface_progress(void *arg)
+unsigned uct_rc_mlx5_iface_progress(void *arg)
 {
     uct_rc_mlx5_iface_t *iface = arg;
     ucs_status_t status;
 
     status = uct_rc_mlx5_iface_poll_rx(iface);
     if (status == UCS_ERR_NO_PROGRESS) {
-        uct_rc_mlx5_iface_poll_tx(iface);
+        return uct_rc_mlx5_iface_poll_tx(iface);
     }
+    return 1;
 }
 
 static ucs_status_t uct_rc_mlx5_iface_query(uct_iface_h tl_iface, uct_iface_attr_t *iface_attr)
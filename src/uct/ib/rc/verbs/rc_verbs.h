@@ -123,7 +123,7 @@ ucs_status_t uct_rc_verbs_ep_atomic_cswap32(uct_ep_h tl_ep, uint32_t compare, ui
 
 ucs_status_t uct_rc_verbs_ep_flush(uct_ep_h tl_ep);
 
-void uct_rc_verbs_iface_progress(void *arg);
+unsigned uct_rc_verbs_iface_progress(void *arg);
 
 ucs_status_t uct_rc_verbs_ep_fc_ctrl(uct_rc_ep_t *rc_ep);
 
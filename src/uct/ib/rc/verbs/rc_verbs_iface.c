@@ -76,7 +76,7 @@ static inline unsigned uct_rc_verbs_iface_post_recv(uct_rc_verbs_iface_t *iface,
     return uct_rc_verbs_iface_post_recv_always(iface, count);
 }
 
-static UCS_F_ALWAYS_INLINE void
+static UCS_F_ALWAYS_INLINE unsigned
 uct_rc_verbs_iface_poll_tx(uct_rc_verbs_iface_t *iface)
 {
     uct_rc_verbs_ep_t *ep;
@@ -90,7 +90,7 @@ uct_rc_verbs_iface_poll_tx(uct_rc_verbs_iface_t *iface)
         if (ucs_unlikely(ret < 0)) {
             ucs_fatal("Failed to poll send CQ");
         }
-        return;
+        return 0;
     }
 
     for (i = 0; i < ret; ++i) {
@@ -112,15 +112,18 @@ uct_rc_verbs_iface_poll_tx(uct_rc_verbs_iface_t *iface)
         uct_rc_ep_process_tx_completion(&iface->super, &ep->super,
                                         ep->tx.completion_count);
     }
+
+    return ret;
 }
 
-static UCS_F_ALWAYS_INLINE ucs_status_t
+static UCS_F_ALWAYS_INLINE unsigned
 uct_rc_verbs_iface_poll_rx(uct_rc_verbs_iface_t *iface)
 {
     uct_ib_iface_recv_desc_t *desc;
     void         *udesc;
     uct_rc_hdr_t *hdr;
     int i, ret;
+    unsigned count;
     ucs_status_t status;
     unsigned num_wcs = iface->super.super.config.rx_max_poll;
     struct ibv_wc wc[num_wcs];
@@ -160,25 +163,26 @@ uct_rc_verbs_iface_poll_rx(uct_rc_verbs_iface_t *iface)
             }
         }
         iface->super.rx.available += ret;
-        status = UCS_OK;
+        count = ret;
     } else if (ret == 0) {
-        status = UCS_ERR_NO_PROGRESS;
+        count = 0;
     } else {
         ucs_fatal("Failed to poll receive CQ");
     }
     uct_rc_verbs_iface_post_recv(iface, 0);
-    return status;
+    return count;
 }
 
-void uct_rc_verbs_iface_progress(void *arg)
+unsigned uct_rc_verbs_iface_progress(void *arg)
 {
     uct_rc_verbs_iface_t *iface = arg;
-    ucs_status_t status;
+    unsigned count;
 
-    status = uct_rc_verbs_iface_poll_rx(iface);
-    if (status == UCS_ERR_NO_PROGRESS) {
-        uct_rc_verbs_iface_poll_tx(iface);
+    count = uct_rc_verbs_iface_poll_rx(iface);
+    if (count == 0) {
+        count = uct_rc_verbs_iface_poll_tx(iface);
     }
+    return count;
 }
 
 static inline int
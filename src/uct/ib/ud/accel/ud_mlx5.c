@@ -401,38 +401,45 @@ out:
     return status;
 }
 
-static UCS_F_ALWAYS_INLINE void 
+static UCS_F_ALWAYS_INLINE unsigned
 uct_ud_mlx5_iface_poll_tx(uct_ud_mlx5_iface_t *iface)
 {
     struct mlx5_cqe64 *cqe;
 
     cqe = uct_ib_mlx5_get_cqe(&iface->tx.cq, UCT_IB_MLX5_CQE64_SIZE_LOG);
     if (cqe == NULL) {
-        return;
+        return 0;
     }
     uct_ib_mlx5_log_cqe(cqe);
     iface->super.tx.available = uct_ib_mlx5_txwq_update_bb(&iface->tx.wq, ntohs(cqe->wqe_counter));
+    return 1;
 }
 
-static void uct_ud_mlx5_iface_progress(void *arg)
+static unsigned uct_ud_mlx5_iface_progress(void *arg)
 {
     uct_ud_mlx5_iface_t *iface = arg;
     ucs_status_t status;
+    unsigned events;
     int count;
 
     uct_ud_enter(&iface->super);
-    uct_ud_iface_dispatch_zcopy_comps(&iface->super);
+    events = uct_ud_iface_dispatch_zcopy_comps(&iface->super);
     status = uct_ud_iface_dispatch_pending_rx(&iface->super);
     if (ucs_likely(status == UCS_OK)) {
         count = 0;
         do {
             status = uct_ud_mlx5_iface_poll_rx(iface, 0);
+            events += (status == UCS_OK);
             count++;
         } while ((status == UCS_OK) && (count < iface->super.super.config.rx_max_poll));
+    } else {
+        /* still has pending packets to dispatch */
+        events++;
     }
-    uct_ud_mlx5_iface_poll_tx(iface);
-    uct_ud_iface_progress_pending(&iface->super, 0);
+    events += uct_ud_mlx5_iface_poll_tx(iface);
+    events += uct_ud_iface_progress_pending(&iface->super, 0);
     uct_ud_leave(&iface->super);
+    return events;
 }
 
 static void uct_ud_mlx5_iface_async_progress(uct_ud_iface_t *ud_iface)
@@ -13,6 +13,7 @@
 #include <ucs/datastruct/queue.h>
 #include <ucs/datastruct/frag_list.h>
 #include <uct/ib/base/ib_iface.h>
+#include <uct/base/uct_ud_rel.h>
 
 #define UCT_UD_QP_HASH_SIZE     256    
 #define UCT_UD_MAX_SGE          2
@@ -21,23 +22,6 @@
 #define UCT_UD_HASH_SIZE        997
 #define UCT_UD_RX_BATCH_MIN     8
 
-#define UCT_UD_INITIAL_PSN      1   /* initial packet serial number */
-/* congestion avoidance settings. See ud_ep.h for details */
-#define UCT_UD_CA_AI_VALUE      1   /* window += AI_VALUE */
-#define UCT_UD_CA_MD_FACTOR     2   /* window = window/factor */
-#define UCT_UD_CA_DUP_ACK_CNT   2   /* TODO: not implemented yet */
-#define UCT_UD_RESENDS_PER_ACK  4   /* request per every N resends */
-
-/* note that the ud tx window is [acked_psn+1, max_psn)
- * and max_psn = acked_psn + cwnd
- * so add 1 to the max/min window constants instead of doing this in the code
- */
-#define UCT_UD_CA_MIN_WINDOW    2
-#define UCT_UD_CA_MAX_WINDOW    1025 
-
-
-typedef uint16_t                 uct_ud_psn_t;
-#define UCT_UD_PSN_COMPARE       UCS_CIRCULAR_COMPARE16
 typedef struct uct_ud_iface      uct_ud_iface_t;
 typedef struct uct_ud_ep         uct_ud_ep_t;
 typedef struct uct_ud_ctl_hdr    uct_ud_ctl_hdr_t;
@@ -45,25 +29,6 @@ typedef struct uct_ud_iface_addr uct_ud_iface_addr_t;
 typedef struct uct_ud_ep_addr    uct_ud_ep_addr_t;
 typedef struct uct_ud_iface_peer uct_ud_iface_peer_t;
 
-enum {
-    UCT_UD_PACKET_ACK_REQ_SHIFT   = 25,
-    UCT_UD_PACKET_AM_ID_SHIFT     = 27,
-    UCT_UD_PACKET_DEST_ID_SHIFT   = 24,
-    UCT_UD_PACKET_PUT_SHIFT       = 28,
-};
-
-enum {
-    UCT_UD_PACKET_FLAG_AM      = UCS_BIT(24),
-    UCT_UD_PACKET_FLAG_ACK_REQ = UCS_BIT(25),
-    UCT_UD_PACKET_FLAG_ECN     = UCS_BIT(26),
-    UCT_UD_PACKET_FLAG_NAK     = UCS_BIT(27),
-    UCT_UD_PACKET_FLAG_PUT     = UCS_BIT(28),
-    UCT_UD_PACKET_FLAG_CTL     = UCS_BIT(29),
-
-    UCT_UD_PACKET_AM_ID_MASK     = UCS_MASK(UCT_UD_PACKET_AM_ID_SHIFT),
-    UCT_UD_PACKET_DEST_ID_MASK   = UCS_MASK(UCT_UD_PACKET_DEST_ID_SHIFT),
-};
-
 enum {
     UCT_UD_PACKET_CREQ = 1,
     UCT_UD_PACKET_CREP = 2,
@@ -118,12 +83,6 @@ Control packet header
     };
 */
 
-typedef struct uct_ud_neth {
-    uint32_t            packet_type;
-    uct_ud_psn_t        psn;
-    uct_ud_psn_t        ack_psn;
-} UCS_S_PACKED uct_ud_neth_t;
-
 enum {
     UCT_UD_SEND_SKB_FLAG_ACK_REQ = UCS_BIT(1),
     UCT_UD_SEND_SKB_FLAG_ZCOPY   = UCS_BIT(2),
@@ -186,23 +145,5 @@ typedef struct uct_ud_put_hdr {
 
 
 
-static inline uint32_t uct_ud_neth_get_dest_id(uct_ud_neth_t *neth)
-{
-    return neth->packet_type & UCT_UD_PACKET_DEST_ID_MASK;
-}
-static inline void uct_ud_neth_set_dest_id(uct_ud_neth_t *neth, uint32_t id)
-{
-    neth->packet_type |= id;
-}
-
-static inline uint8_t uct_ud_neth_get_am_id(uct_ud_neth_t *neth)
-{
-    return neth->packet_type >> UCT_UD_PACKET_AM_ID_SHIFT;
-}
-static inline void uct_ud_neth_set_am_id(uct_ud_neth_t *neth, uint8_t id)
-{
-    neth->packet_type |= (id << UCT_UD_PACKET_AM_ID_SHIFT);
-}
-
 #endif
 
@@ -34,74 +34,12 @@ static void uct_ud_peer_copy(uct_ud_peer_name_t *dst, uct_ud_peer_name_t *src)
 #endif
 
 
-static void uct_ud_ep_resend_start(uct_ud_iface_t *iface, uct_ud_ep_t *ep)
-{
-    ep->resend.max_psn   = ep->tx.psn - 1;
-    ep->resend.psn       = ep->tx.acked_psn + 1;
-    ep->resend.pos       = ucs_queue_iter_begin(&ep->tx.window);
-    uct_ud_ep_ctl_op_add(iface, ep, UCT_UD_EP_OP_RESEND);
-}
-
-
-static void uct_ud_ep_resend_ack(uct_ud_iface_t *iface, uct_ud_ep_t *ep)
-{
-    if (UCT_UD_PSN_COMPARE(ep->tx.acked_psn, <, ep->resend.max_psn)) {
-        /* new ack arrived that acked something in our resend window. */
-        if (UCT_UD_PSN_COMPARE(ep->resend.psn, <=, ep->tx.acked_psn)) {
-            ucs_debug("ep(%p): ack received during resend resend.psn=%d tx.acked_psn=%d", 
-                      ep, ep->resend.psn, ep->tx.acked_psn);
-            ep->resend.pos = ucs_queue_iter_begin(&ep->tx.window);
-            ep->resend.psn = ep->tx.acked_psn + 1;
-        }
-        uct_ud_ep_ctl_op_add(iface, ep, UCT_UD_EP_OP_RESEND);
-    } else { 
-        /* everything in resend window was acked - no need to resend anymore */
-        ep->resend.psn = ep->resend.max_psn + 1;
-        uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_RESEND);
-    }
-}
-
-
-static void uct_ud_ep_ca_drop(uct_ud_ep_t *ep)
-{
-    ucs_debug("ep: %p ca drop@cwnd = %d in flight: %d",
-              ep, ep->ca.cwnd, (int)ep->tx.psn-(int)ep->tx.acked_psn-1);
-    ep->ca.cwnd /= UCT_UD_CA_MD_FACTOR;
-    if (ep->ca.cwnd < UCT_UD_CA_MIN_WINDOW) {
-        ep->ca.cwnd = UCT_UD_CA_MIN_WINDOW;
-    }
-    ep->tx.max_psn    = ep->tx.acked_psn + ep->ca.cwnd;
-    if (UCT_UD_PSN_COMPARE(ep->tx.max_psn, >, ep->tx.psn)) {
-        /* do not send more until we get acks going */
-        ep->tx.max_psn = ep->tx.psn;
-    }
-}
-
-static UCS_F_ALWAYS_INLINE void uct_ud_ep_ca_ack(uct_ud_ep_t *ep)
-{
-    if (ep->ca.cwnd < UCT_UD_CA_MAX_WINDOW) {
-        ep->ca.cwnd += UCT_UD_CA_AI_VALUE;
-    }
-    ep->tx.max_psn = ep->tx.acked_psn + ep->ca.cwnd;
-}
+static const uct_ud_rel_ops_t uct_ud_ep_rel_ops;
 
 
 static void uct_ud_ep_reset(uct_ud_ep_t *ep)
 {
-    ep->tx.psn         = UCT_UD_INITIAL_PSN;
-    ep->ca.cwnd        = UCT_UD_CA_MIN_WINDOW;
-    ep->tx.max_psn     = ep->tx.psn + ep->ca.cwnd;
-    ep->tx.acked_psn   = UCT_UD_INITIAL_PSN - 1;
-    ep->tx.pending.ops = UCT_UD_EP_OP_NONE;
-    ucs_queue_head_init(&ep->tx.window);
-
-    ep->resend.pos       = ucs_queue_iter_begin(&ep->tx.window);
-    ep->resend.psn       = ep->tx.psn;
-    ep->resend.max_psn   = ep->tx.acked_psn;
-
-    ep->rx.acked_psn = UCT_UD_INITIAL_PSN - 1;
-    ucs_frag_list_init(ep->tx.psn-1, &ep->rx.ooo_pkts, 0 /*TODO: ooo support */
-                       UCS_STATS_ARG(ep->rx.stats));
+    uct_ud_rel_reset(&ep->rel UCS_STATS_ARG(ep->rx.stats));
 }
 
 static void uct_ud_ep_slow_timer(ucs_wtimer_t *self)
@@ -114,30 +52,10 @@ static void uct_ud_ep_slow_timer(ucs_wtimer_t *self)
     UCT_UD_EP_HOOK_CALL_TIMER(ep);
     now = ucs_twheel_get_time(&iface->async.slow_timer);
 
-    if (ucs_queue_is_empty(&ep->tx.window)) {
-        return;
-    }
-
-    /* It is possible that the sender is slow.
-     * Try to flush the window twice before going into
-     * full resend mode.    
-     */
-    if (now - ep->tx.send_time > uct_ud_slow_tick() &&
-        uct_ud_ep_is_connected(ep)) {
-        uct_ud_ep_ctl_op_add(iface, ep, UCT_UD_EP_OP_ACK_REQ);
+    if (uct_ud_rel_timer(&ep->rel, now, uct_ud_slow_tick())) {
+        ucs_wtimer_add(&iface->async.slow_timer, &ep->slow_timer, 
+                       uct_ud_slow_tick());
     }
-
-    if (now - ep->tx.send_time > 3*uct_ud_slow_tick()) {
-        ucs_trace("sceduling resend now: %llu send_time: %llu diff: %llu tick: %llu",
-                   now, ep->tx.send_time, now - ep->tx.send_time, uct_ud_slow_tick()); 
-        ep->tx.send_time = ucs_twheel_get_time(&iface->async.slow_timer);
-        uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_ACK_REQ);
-        uct_ud_ep_ca_drop(ep);
-        uct_ud_ep_resend_start(iface, ep);
-    }
-
-    ucs_wtimer_add(&iface->async.slow_timer, &ep->slow_timer, 
-                   uct_ud_slow_tick());
 }
 
 UCS_CLASS_INIT_FUNC(uct_ud_ep_t, uct_ud_iface_t *iface)
@@ -148,6 +66,7 @@ UCS_CLASS_INIT_FUNC(uct_ud_ep_t, uct_ud_iface_t *iface)
     UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super.super);
 
     self->dest_ep_id = UCT_UD_EP_NULL_ID;
+    self->rel.ops    = &uct_ud_ep_rel_ops;
     uct_ud_ep_reset(self);
     ucs_list_head_init(&self->cep_list);
     uct_ud_iface_add_ep(iface, self);
@@ -201,15 +120,15 @@ static UCS_CLASS_CLEANUP_FUNC(uct_ud_ep_t)
     ucs_wtimer_remove(&self->slow_timer);
     uct_ud_iface_remove_ep(iface, self);
     uct_ud_iface_cep_remove(self);
-    ucs_frag_list_cleanup(&self->rx.ooo_pkts); 
+    ucs_frag_list_cleanup(&self->rel.rx.ooo_pkts); 
 
     ucs_arbiter_group_purge(&iface->tx.pending_q, &self->tx.pending.group,
                             uct_ud_ep_pending_cancel_cb, 0);
 
-    if (!ucs_queue_is_empty(&self->tx.window)) {
+    if (!ucs_queue_is_empty(&self->rel.tx.window)) {
         ucs_debug("ep=%p id=%d conn_id=%d has %d unacked packets", 
                    self, self->ep_id, self->conn_id, 
-                   (int)ucs_queue_length(&self->tx.window));
+                   (int)ucs_queue_length(&self->rel.tx.window));
     }
     ucs_arbiter_group_cleanup(&self->tx.pending.group);
 }
@@ -243,7 +162,7 @@ static ucs_status_t uct_ud_ep_connect_to_iface(uct_ud_ep_t *ep,
     uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
     uct_ib_device_t *dev = uct_ib_iface_device(&iface->super);
 
-    ucs_frag_list_cleanup(&ep->rx.ooo_pkts); 
+    ucs_frag_list_cleanup(&ep->rel.rx.ooo_pkts); 
     uct_ud_ep_reset(ep);
 
     ucs_debug("%s:%d lid %d qpn 0x%x ep_id %u ep %p connected to IFACE dlid %d qpn 0x%x",
@@ -261,7 +180,7 @@ static ucs_status_t uct_ud_ep_disconnect_from_iface(uct_ep_h tl_ep)
 {
     uct_ud_ep_t *ep = ucs_derived_of(tl_ep, uct_ud_ep_t);
 
-    ucs_frag_list_cleanup(&ep->rx.ooo_pkts); 
+    ucs_frag_list_cleanup(&ep->rel.rx.ooo_pkts); 
     uct_ud_ep_reset(ep);
     ep->dest_ep_id = UCT_UD_EP_NULL_ID;
 
@@ -336,7 +255,7 @@ ucs_status_t uct_ud_ep_connect_to_ep(uct_ud_ep_t *ep,
 
     ep->dest_ep_id = uct_ib_unpack_uint24(ep_addr->ep_id);
 
-    ucs_frag_list_cleanup(&ep->rx.ooo_pkts); 
+    ucs_frag_list_cleanup(&ep->rel.rx.ooo_pkts); 
     uct_ud_ep_reset(ep);
 
     ucs_debug("%s:%d slid=%d qpn=%d ep=%u connected to dlid=%d qpn=%d ep=%u", 
@@ -350,50 +269,6 @@ ucs_status_t uct_ud_ep_connect_to_ep(uct_ud_ep_t *ep,
     return UCS_OK;
 }
 
-static UCS_F_ALWAYS_INLINE void 
-uct_ud_ep_process_ack(uct_ud_iface_t *iface, uct_ud_ep_t *ep, 
-                      uct_ud_psn_t ack_psn, int is_async)
-{
-    uct_ud_send_skb_t *skb;
-
-    if (ucs_unlikely(UCT_UD_PSN_COMPARE(ack_psn, <=, ep->tx.acked_psn))) {
-        return;
-    }
-
-    ep->tx.acked_psn = ack_psn;
-    
-    /* Release acknowledged skb's */
-    ucs_queue_for_each_extract(skb, &ep->tx.window, queue,
-                               UCT_UD_PSN_COMPARE(skb->neth[0].psn, <=, ack_psn)) {
-        if (ucs_unlikely(skb->flags & UCT_UD_SEND_SKB_FLAG_ZCOPY)) {
-            uct_ud_zcopy_desc_t *zdesc;
-
-            zdesc = uct_ud_zcopy_desc(skb);
-            if (zdesc->comp) {
-                if (ucs_unlikely(is_async)) {
-                    ucs_queue_push(&iface->tx.zcopy_comp_q, &skb->queue);
-                    ep->flags |= UCT_UD_EP_FLAG_ZCOPY_ASYNC_COMPS;
-                    zdesc->payload = ep;
-                    continue;
-                }
-                uct_invoke_completion(zdesc->comp, UCS_OK);
-            }
-        }
-        skb->flags = 0; /* reset also ACK_REQ flag */
-        ucs_mpool_put(skb);
-    }
-
-    uct_ud_ep_ca_ack(ep);
-
-    if (ucs_unlikely(UCT_UD_PSN_COMPARE(ep->resend.psn, <=, ep->resend.max_psn))) {
-        uct_ud_ep_resend_ack(iface, ep);
-    }
-
-    ucs_arbiter_group_schedule(&iface->tx.pending_q, &ep->tx.pending.group);
-
-    ep->tx.send_time = uct_ud_iface_get_async_time(iface);
-}
-
 static inline void uct_ud_ep_rx_put(uct_ud_neth_t *neth, unsigned byte_len)
 {
     uct_ud_put_hdr_t *put_hdr;
@@ -440,24 +315,24 @@ static void uct_ud_ep_rx_creq(uct_ud_iface_t *iface, uct_ud_neth_t *neth)
     if (!ep) {
         ep = uct_ud_ep_create_passive(iface, ctl);
         ucs_assert_always(ep != NULL);
-        ep->rx.ooo_pkts.head_sn = neth->psn;
+        ep->rel.rx.ooo_pkts.head_sn = neth->psn;
         uct_ud_peer_copy(&ep->peer, &ctl->peer);
         uct_ud_ep_set_state(ep, UCT_UD_EP_FLAG_PRIVATE);
     } else {
         if (ep->dest_ep_id == UCT_UD_EP_NULL_ID) {
             /* simultanuous CREQ */
             ep->dest_ep_id = uct_ib_unpack_uint24(ctl->conn_req.ep_addr.ep_id);
-            ep->rx.ooo_pkts.head_sn = neth->psn;
+            ep->rel.rx.ooo_pkts.head_sn = neth->psn;
             uct_ud_peer_copy(&ep->peer, &ctl->peer);
             ucs_debug("simultanuous CREQ ep=%p"
                       "(iface=%p conn_id=%d ep_id=%d, dest_ep_id=%d rx_psn=%u)",
                       ep, iface, ep->conn_id, ep->ep_id, 
-                      ep->dest_ep_id, ep->rx.ooo_pkts.head_sn);
-            if (UCT_UD_PSN_COMPARE(ep->tx.psn, >, UCT_UD_INITIAL_PSN)) {
+                      ep->dest_ep_id, ep->rel.rx.ooo_pkts.head_sn);
+            if (UCT_UD_PSN_COMPARE(ep->rel.tx.psn, >, UCT_UD_INITIAL_PSN)) {
                 /* our own creq was sent, treat incoming creq as ack and remove our own
                  * from tx window
                  */
-                uct_ud_ep_process_ack(iface, ep, UCT_UD_INITIAL_PSN, 0);
+                uct_ud_rel_process_ack(&ep->rel, UCT_UD_INITIAL_PSN, 0);
             }
         }
     }
@@ -465,7 +340,7 @@ static void uct_ud_ep_rx_creq(uct_ud_iface_t *iface, uct_ud_neth_t *neth)
     ucs_assert_always(ctl->conn_req.conn_id == ep->conn_id);
     ucs_assert_always(uct_ib_unpack_uint24(ctl->conn_req.ep_addr.ep_id) == ep->dest_ep_id);
     /* creq must always have same psn */
-    ucs_assert_always(ep->rx.ooo_pkts.head_sn == neth->psn);
+    ucs_assert_always(ep->rel.rx.ooo_pkts.head_sn == neth->psn);
     /* scedule connection reply op */
     UCT_UD_EP_HOOK_CALL_RX(ep, neth, sizeof(*neth) + sizeof(*ctl));
     uct_ud_ep_ctl_op_add(iface, ep, UCT_UD_EP_OP_CREP);
@@ -569,12 +444,12 @@ void uct_ud_ep_process_rx(uct_ud_iface_t *iface, uct_ud_neth_t *neth, unsigned b
     UCT_UD_EP_HOOK_CALL_RX(ep, neth, byte_len);
     uct_ud_iface_log_rx(iface, ep, neth, byte_len);
     
-    uct_ud_ep_process_ack(iface, ep, neth->ack_psn, is_async);
+    uct_ud_rel_process_ack(&ep->rel, neth->ack_psn, is_async);
 
     if (ucs_unlikely(neth->packet_type & UCT_UD_PACKET_FLAG_ACK_REQ)) {
         uct_ud_ep_ctl_op_add(iface, ep, UCT_UD_EP_OP_ACK);
         ucs_trace_data("ACK_REQ - schedule ack, head_sn=%d sn=%d",
-                       ep->rx.ooo_pkts.head_sn, neth->psn);
+                       ep->rel.rx.ooo_pkts.head_sn, neth->psn);
     }
 
     if (ucs_unlikely(!is_am)) {
@@ -587,14 +462,14 @@ void uct_ud_ep_process_rx(uct_ud_iface_t *iface, uct_ud_neth_t *neth, unsigned b
         }
     }
 
-    ooo_type = ucs_frag_list_insert(&ep->rx.ooo_pkts, &skb->u.ooo.elem, neth->psn);
+    ooo_type = ucs_frag_list_insert(&ep->rel.rx.ooo_pkts, &skb->u.ooo.elem, neth->psn);
     if (ucs_unlikely(ooo_type != UCS_FRAG_LIST_INSERT_FAST)) {
         if (ooo_type != UCS_FRAG_LIST_INSERT_DUP &&
             ooo_type != UCS_FRAG_LIST_INSERT_FAIL) {
             ucs_fatal("Out of order is not implemented: got %d", ooo_type);
         }
         ucs_trace_data("DUP/OOB - schedule ack, head_sn=%d sn=%d", 
-                       ep->rx.ooo_pkts.head_sn, neth->psn);
+                       ep->rel.rx.ooo_pkts.head_sn, neth->psn);
         uct_ud_ep_ctl_op_add(iface, ep, UCT_UD_EP_OP_ACK);
         goto out;
     }
@@ -627,13 +502,13 @@ ucs_status_t uct_ud_ep_flush_nolock(uct_ud_iface_t *iface, uct_ud_ep_t *ep)
     if (ucs_unlikely(!uct_ud_ep_is_connected(ep))) {
         /* check for CREQ either being sceduled or sent and waiting for CREP ack */
         if (uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_CREQ) ||
-            !ucs_queue_is_empty(&ep->tx.window)) {
+            !ucs_queue_is_empty(&ep->rel.tx.window)) {
             return UCS_INPROGRESS;
         }
         return UCS_OK;
     }
 
-    if (ucs_queue_is_empty(&ep->tx.window)) {
+    if (ucs_queue_is_empty(&ep->rel.tx.window)) {
         uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_ACK_REQ);
         /* check that there are no pending requests.
          * The code also forces flush of pending controls.
@@ -650,7 +525,7 @@ ucs_status_t uct_ud_ep_flush_nolock(uct_ud_iface_t *iface, uct_ud_ep_t *ep)
         }
     }
     
-    skb = ucs_queue_tail_elem_non_empty(&ep->tx.window, uct_ud_send_skb_t, queue);
+    skb = ucs_queue_tail_elem_non_empty(&ep->rel.tx.window, uct_ud_send_skb_t, queue);
     if (skb->flags & UCT_UD_SEND_SKB_FLAG_ACK_REQ) {
         /* last packet was already sent with ack request. 
          * either by flush or 
@@ -713,19 +588,76 @@ static uct_ud_send_skb_t *uct_ud_ep_prepare_crep(uct_ud_ep_t *ep)
     return skb;
 }
 
-static uct_ud_send_skb_t *uct_ud_ep_resend(uct_ud_ep_t *ep)
+static void uct_ud_ep_tx_ctl_skb(uct_ud_iface_t *iface, uct_ud_ep_t *ep,
+                                 uct_ud_send_skb_t *skb)
 {
-    uct_ud_send_skb_t *skb, *sent_skb;
+    VALGRIND_MAKE_MEM_DEFINED(skb, sizeof *skb);
+    ucs_derived_of(iface->super.ops, uct_ud_iface_ops_t)->tx_skb(ep, skb, 0);
+    uct_ud_ep_log_tx(iface, ep, skb);
+    uct_ud_iface_res_skb_put(iface, skb);
+}
+
+static int uct_ud_ep_rel_is_connected(uct_ud_rel_t *rel)
+{
+    return uct_ud_ep_is_connected(ucs_container_of(rel, uct_ud_ep_t, rel));
+}
+
+static ucs_time_t uct_ud_ep_rel_get_time(uct_ud_rel_t *rel)
+{
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
+
+    return uct_ud_iface_get_async_time(ucs_derived_of(ep->super.super.iface,
+                                                      uct_ud_iface_t));
+}
+
+static void uct_ud_ep_rel_schedule(uct_ud_rel_t *rel)
+{
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
     uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
 
-    /* check window */
-    sent_skb = ucs_queue_iter_elem(sent_skb, ep->resend.pos, queue);
-    if (UCT_UD_PSN_COMPARE(sent_skb->neth->psn, >=, ep->tx.max_psn)) {
-        ucs_debug("ep(%p): out of window(psn=%d/max_psn=%d) - can not resend more", 
-                  ep, sent_skb->neth->psn, ep->tx.max_psn);
-        uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_RESEND);
-        return NULL;
+    if (uct_ud_ep_ctl_op_isany(ep)) {
+        ucs_arbiter_group_push_elem(&ep->tx.pending.group,
+                                    &ep->tx.pending.elem);
     }
+    ucs_arbiter_group_schedule(&iface->tx.pending_q, &ep->tx.pending.group);
+}
+
+static uct_ud_neth_t *uct_ud_ep_rel_skb_neth(ucs_queue_elem_t *elem)
+{
+    return ucs_container_of(elem, uct_ud_send_skb_t, queue)->neth;
+}
+
+static void uct_ud_ep_rel_skb_release(uct_ud_rel_t *rel, ucs_queue_elem_t *elem,
+                                      int is_async)
+{
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
+    uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
+    uct_ud_send_skb_t *skb = ucs_container_of(elem, uct_ud_send_skb_t, queue);
+    uct_ud_zcopy_desc_t *zdesc;
+
+    if (ucs_unlikely(skb->flags & UCT_UD_SEND_SKB_FLAG_ZCOPY)) {
+        zdesc = uct_ud_zcopy_desc(skb);
+        if (zdesc->comp) {
+            if (ucs_unlikely(is_async)) {
+                ucs_queue_push(&iface->tx.zcopy_comp_q, &skb->queue);
+                ep->flags |= UCT_UD_EP_FLAG_ZCOPY_ASYNC_COMPS;
+                zdesc->payload = ep;
+                return;
+            }
+            uct_invoke_completion(zdesc->comp, UCS_OK);
+        }
+    }
+    skb->flags = 0; /* reset also ACK_REQ flag */
+    ucs_mpool_put(skb);
+}
+
+static void uct_ud_ep_rel_skb_resend(uct_ud_rel_t *rel, ucs_queue_elem_t *elem,
+                                     int ack_req)
+{
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
+    uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
+    uct_ud_send_skb_t *sent_skb = ucs_container_of(elem, uct_ud_send_skb_t, queue);
+    uct_ud_send_skb_t *skb;
 
     /* creq or crep must remove creq packet from window */
     ucs_assertv_always(!(uct_ud_ep_is_connected(ep) &&
@@ -736,10 +668,8 @@ static uct_ud_send_skb_t *uct_ud_ep_resend(uct_ud_ep_t *ep)
     skb = uct_ud_iface_res_skb_get(iface);
     ucs_assert_always(skb != NULL);
 
-    ep->resend.pos = ucs_queue_iter_next(ep->resend.pos);
-    ep->resend.psn = sent_skb->neth->psn;
     memcpy(skb->neth, sent_skb->neth, sent_skb->len);
-    skb->neth->ack_psn = ep->rx.acked_psn;
+    skb->neth->ack_psn = ep->rel.rx.acked_psn;
     skb->len           = sent_skb->len;
     if (sent_skb->flags & UCT_UD_SEND_SKB_FLAG_ZCOPY) {
         uct_ud_zcopy_desc_t *zdesc;
@@ -748,73 +678,68 @@ static uct_ud_send_skb_t *uct_ud_ep_resend(uct_ud_ep_t *ep)
         memcpy((char *)skb->neth + skb->len, zdesc->payload, zdesc->len);
         skb->len += zdesc->len;
     }
-    /* force ack request on every Nth packet or on first packet in resend window */
-    if ((skb->neth->psn % UCT_UD_RESENDS_PER_ACK) == 0 || 
-        UCT_UD_PSN_COMPARE(skb->neth->psn, ==, ep->tx.acked_psn+1)) {
+    if (ack_req) {
         skb->neth->packet_type |= UCT_UD_PACKET_FLAG_ACK_REQ;
     } else {
         skb->neth->packet_type &= ~UCT_UD_PACKET_FLAG_ACK_REQ;
     }
 
-    ucs_debug("ep(%p): resending rt_psn %u rt_max_psn %u acked_psn %u max_psn %u ack_req %d", 
-              ep, ep->resend.psn, ep->resend.max_psn, 
-              ep->tx.acked_psn, ep->tx.max_psn, 
-              skb->neth->packet_type&UCT_UD_PACKET_FLAG_ACK_REQ ? 1 : 0);
+    uct_ud_ep_tx_ctl_skb(iface, ep, skb);
+}
+
+static ucs_status_t uct_ud_ep_rel_send_creq(uct_ud_rel_t *rel)
+{
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
+    uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
+    uct_ud_send_skb_t *skb;
 
-    if (UCT_UD_PSN_COMPARE(ep->resend.psn, ==, ep->resend.max_psn)) {
-        ucs_debug("ep(%p): resending completed", ep);
-        ep->resend.psn = ep->resend.max_psn + 1;
-        uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_RESEND);
+    skb = uct_ud_ep_prepare_creq(ep);
+    if (!skb) {
+        return UCS_ERR_NO_RESOURCE;
     }
 
-    return skb;
+    /* creq allocates real skb, it must be put on window like
+     * a regular packet to ensure a retransmission.
+     */
+    ucs_derived_of(iface->super.ops, uct_ud_iface_ops_t)->tx_skb(ep, skb, 1);
+    uct_ud_iface_complete_tx_skb(iface, ep, skb);
+    return UCS_OK;
 }
 
-static void uct_ud_ep_do_pending_ctl(uct_ud_ep_t *ep, uct_ud_iface_t *iface)
+static void uct_ud_ep_rel_send_crep(uct_ud_rel_t *rel)
 {
-    uct_ud_send_skb_t *skb;
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
+    uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
 
-    if (uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_CREQ)) {
-        skb = uct_ud_ep_prepare_creq(ep);
-        if (skb) {
-            /* creq allocates real skb, it must be put on window like
-             * a regular packet to ensure a retransmission.
-             */
-            ucs_derived_of(iface->super.ops, uct_ud_iface_ops_t)->tx_skb(ep, skb,
-                                                                         1);
-            uct_ud_iface_complete_tx_skb(iface, ep, skb);
-            uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_CREQ);
-        }
-        return;
-    } else if (uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_CREP)) {
-        skb = uct_ud_ep_prepare_crep(ep);
-    } else if (uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_RESEND)) {
-        skb =  uct_ud_ep_resend(ep);
-    } else if (uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_ACK)) {
-        skb = &iface->tx.skb_inl.super;
-        uct_ud_neth_ctl_ack(ep, skb->neth);
-        uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_ACK);
-    } else if (uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_ACK_REQ)) {
-        skb = &iface->tx.skb_inl.super;
+    uct_ud_ep_tx_ctl_skb(iface, ep, uct_ud_ep_prepare_crep(ep));
+}
+
+static void uct_ud_ep_rel_send_ack(uct_ud_rel_t *rel, int ack_req)
+{
+    uct_ud_ep_t *ep = ucs_container_of(rel, uct_ud_ep_t, rel);
+    uct_ud_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_ud_iface_t);
+    uct_ud_send_skb_t *skb = &iface->tx.skb_inl.super;
+
+    if (ack_req) {
         uct_ud_neth_ctl_ack_req(ep, skb->neth);
-        uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_ACK_REQ);
-    } else if (uct_ud_ep_ctl_op_isany(ep)) {
-        ucs_fatal("unsupported pending op mask: %x", ep->tx.pending.ops);
     } else {
-        skb = 0;
-    }
-
-    if (!skb) {
-        /* no pending - nothing to do */
-        return;
+        uct_ud_neth_ctl_ack(ep, skb->neth);
     }
-
-    VALGRIND_MAKE_MEM_DEFINED(skb, sizeof *skb);
-    ucs_derived_of(iface->super.ops, uct_ud_iface_ops_t)->tx_skb(ep, skb, 0);
-    uct_ud_ep_log_tx(iface, ep, skb);
-    uct_ud_iface_res_skb_put(iface, skb);
+    uct_ud_ep_tx_ctl_skb(iface, ep, skb);
 }
 
+static const uct_ud_rel_ops_t uct_ud_ep_rel_ops = {
+    .is_connected = uct_ud_ep_rel_is_connected,
+    .get_time     = uct_ud_ep_rel_get_time,
+    .schedule     = uct_ud_ep_rel_schedule,
+    .skb_neth     = uct_ud_ep_rel_skb_neth,
+    .skb_release  = uct_ud_ep_rel_skb_release,
+    .skb_resend   = uct_ud_ep_rel_skb_resend,
+    .send_creq    = uct_ud_ep_rel_send_creq,
+    .send_crep    = uct_ud_ep_rel_send_crep,
+    .send_ack     = uct_ud_ep_rel_send_ack
+};
+
 static inline ucs_arbiter_cb_result_t
 uct_ud_ep_ctl_op_next(uct_ud_ep_t *ep)
 {
@@ -883,7 +808,7 @@ uct_ud_ep_do_pending(ucs_arbiter_t *arbiter, ucs_arbiter_elem_t *elem,
     }
 
     if (&ep->tx.pending.elem == elem) { 
-        uct_ud_ep_do_pending_ctl(ep, iface);
+        uct_ud_rel_do_pending_ctl(&ep->rel);
         if (uct_ud_ep_ctl_op_isany(ep)) {
             /* there is still some ctl left. go to next group */
             return UCS_ARBITER_CB_RESULT_NEXT_GROUP;
@@ -913,14 +838,14 @@ uct_ud_ep_do_pending(ucs_arbiter_t *arbiter, ucs_arbiter_elem_t *elem,
              * no need to check for low prio here because we 
              * already checked above. 
              */
-            uct_ud_ep_do_pending_ctl(ep, iface);
+            uct_ud_rel_do_pending_ctl(&ep->rel);
             return uct_ud_ep_ctl_op_next(ep);
         } 
         iface->tx.pending_q_len--;
         return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
     }
     /* try to send ctl messages */
-    uct_ud_ep_do_pending_ctl(ep, iface);
+    uct_ud_rel_do_pending_ctl(&ep->rel);
     return uct_ud_ep_ctl_op_next(ep);
 }
 
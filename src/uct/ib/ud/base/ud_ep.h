@@ -16,10 +16,6 @@
 #include <ucs/datastruct/sglib.h>
 #include <ucs/time/timer_wheel.h>
 
-#define UCT_UD_EP_NULL_ID     ((1<<24)-1)
-#define UCT_UD_EP_ID_MAX      UCT_UD_EP_NULL_ID
-#define UCT_UD_EP_CONN_ID_MAX UCT_UD_EP_ID_MAX 
-
 #ifdef UCT_UD_EP_DEBUG_HOOKS
 /*
    Hooks that allow packet header inspection and rewriting. UCT user can
@@ -119,46 +115,7 @@ do { \
  * many to one traffic pattern. 
  */
 
-/* Congestion avoidance and retransmits
- *
- * UD uses additive increase/multiplicative decrease algorightm
- * See https://en.wikipedia.org/wiki/Additive_increase/multiplicative_decrease
- *
- * tx window is increased when ack is received and decreased when
- * resend is scheduled. Ack must be a 'new' one that is it must
- * acknowledge packets on window. Increasing window on ack does not casue 
- * exponential window increase because, unlike tcp, only two acks 
- * per window are sent.
- *
- * Todo: 
- *
- * Consider trigering window decrease before resend timeout:
- * - on ECN (explicit congestion notification) from receiever. ECN can
- *   be based on some heuristic. For example on number of rx completions
- *   that receiver picked from CQ.
- * - upon receiving a 'duplicate ack' packet
- *
- * Consider using other algorithm (ex BIC/CUBIC)
- */
-
-/*
- * Handling retransmits
- *
- * On slow timer timeout schedule a retransmit operation for
- * [acked_psn+1, psn-1]. These values are saved as 'resend window'
- *
- * Resend operation will resend no more then the current cwnd
- * If ack arrives when resend window is active it means that 
- *  - something new in the resend window was acked. As a
- *  resutlt a new resend operation will be scheduled.
- *  - either resend window or something beyond it was 
- *  acked. It means that no more retransmisions are needed.
- *  Current 'resend window' is deactivated
- * 
- * When retransmitting, ack is requested if:
- * psn == acked_psn + 1 or
- * psn % UCT_UD_RESENDS_PER_ACK = 0
- */
+/* Congestion avoidance and retransmits are described in uct_ud_rel.h */
 
 struct uct_ud_ep_addr {
     uct_ib_uint24_t qp_num;
@@ -168,15 +125,16 @@ struct uct_ud_ep_addr {
 /* 
  * Endpoint pending control operations. The operations
  * are executed in time of progress along with
- * pending requests added by uct user. 
+ * pending requests added by uct user. The bitmask of
+ * scheduled operations is kept by the reliability engine.
  */
 enum {
-    UCT_UD_EP_OP_NONE       = 0,
-    UCT_UD_EP_OP_ACK        = UCS_BIT(0),  /* ack data */
-    UCT_UD_EP_OP_ACK_REQ    = UCS_BIT(1),  /* request ack of sent packets */
-    UCT_UD_EP_OP_RESEND     = UCS_BIT(2),  /* resend un acked packets */
-    UCT_UD_EP_OP_CREP       = UCS_BIT(3),  /* send connection reply */
-    UCT_UD_EP_OP_CREQ       = UCS_BIT(4)   /* send connection request */
+    UCT_UD_EP_OP_NONE       = UCT_UD_REL_OP_NONE,
+    UCT_UD_EP_OP_ACK        = UCT_UD_REL_OP_ACK,      /* ack data */
+    UCT_UD_EP_OP_ACK_REQ    = UCT_UD_REL_OP_ACK_REQ,  /* request ack of sent packets */
+    UCT_UD_EP_OP_RESEND     = UCT_UD_REL_OP_RESEND,   /* resend un acked packets */
+    UCT_UD_EP_OP_CREP       = UCT_UD_REL_OP_CREP,     /* send connection reply */
+    UCT_UD_EP_OP_CREQ       = UCT_UD_REL_OP_CREQ      /* send connection request */
 };
 
 #define UCT_UD_EP_OP_CTL_LOW_PRIO (UCT_UD_EP_OP_ACK_REQ|UCT_UD_EP_OP_ACK)
@@ -184,7 +142,6 @@ enum {
 
 typedef struct uct_ud_ep_pending_op {
     ucs_arbiter_group_t   group;  
-    uint32_t              ops;    /* bitmask that describes what control ops are sceduled */
     ucs_arbiter_elem_t    elem;
 } uct_ud_ep_pending_op_t;
 
@@ -211,29 +168,13 @@ struct uct_ud_ep {
     uct_base_ep_t           super;
     uint32_t                ep_id;
     uint32_t                dest_ep_id;
+    uct_ud_rel_t            rel;          /* Reliability state */
     struct {
-         uct_ud_psn_t           psn;          /* Next PSN to send */
-         uct_ud_psn_t           max_psn;      /* Largest PSN that can be sent */
-         uct_ud_psn_t           acked_psn;    /* last psn that was acked by remote side */
-         ucs_queue_head_t       window;       /* send window: [acked_psn+1, psn-1] */
          uct_ud_ep_pending_op_t pending;      /* pending ops */
-         ucs_time_t             send_time;    /* tx time of last packet */
          UCS_STATS_NODE_DECLARE(stats);
          UCT_UD_EP_HOOK_DECLARE(tx_hook);
     } tx;
     struct {
-         uct_ud_psn_t           psn;       /* last psn that was retransmitted */
-         uct_ud_psn_t           max_psn;   /* max psn that should be retransmitted */
-         ucs_queue_iter_t       pos;       /* points to the part of tx window that needs to be resent */
-    } resend;
-    struct {
-        uct_ud_psn_t  wmax;
-        uct_ud_psn_t  cwnd;
-    } ca;
-    struct {
-        uct_ud_psn_t        acked_psn;    /* Last psn we acked */
-        ucs_frag_list_t     ooo_pkts;     /* Out of order packets that can not be processed yet,
-                                            also keeps last psn we successfully received and processed */
         UCS_STATS_NODE_DECLARE(stats);
         UCT_UD_EP_HOOK_DECLARE(rx_hook);
     } rx;
@@ -308,24 +249,21 @@ void uct_ud_ep_process_rx(uct_ud_iface_t *iface,
 static UCS_F_ALWAYS_INLINE void
 uct_ud_neth_ctl_ack(uct_ud_ep_t *ep, uct_ud_neth_t *neth)
 {
-    neth->psn         = ep->tx.psn;
-    neth->ack_psn     = ep->rx.acked_psn = ucs_frag_list_sn(&ep->rx.ooo_pkts);
+    uct_ud_rel_neth_init(&ep->rel, neth);
     neth->packet_type = ep->dest_ep_id;
 }
 
 static UCS_F_ALWAYS_INLINE void
 uct_ud_neth_ctl_ack_req(uct_ud_ep_t *ep, uct_ud_neth_t *neth)
 {
-    neth->psn         = ep->tx.psn;
-    neth->ack_psn     = ep->rx.acked_psn = ucs_frag_list_sn(&ep->rx.ooo_pkts);
+    uct_ud_rel_neth_init(&ep->rel, neth);
     neth->packet_type = ep->dest_ep_id|UCT_UD_PACKET_FLAG_ACK_REQ;
 }
 
 static UCS_F_ALWAYS_INLINE void 
 uct_ud_neth_init_data(uct_ud_ep_t *ep, uct_ud_neth_t *neth)
 {
-    neth->psn = ep->tx.psn;
-    neth->ack_psn = ep->rx.acked_psn = ucs_frag_list_sn(&ep->rx.ooo_pkts);
+    uct_ud_rel_neth_init(&ep->rel, neth);
 }
 
 
@@ -347,25 +285,25 @@ SGLIB_DEFINE_HASHED_CONTAINER_PROTOTYPES(uct_ud_ep_t, UCT_UD_HASH_SIZE, uct_ud_e
 static UCS_F_ALWAYS_INLINE void
 uct_ud_ep_ctl_op_del(uct_ud_ep_t *ep, uint32_t ops)
 {
-    ep->tx.pending.ops &= ~ops;
+    uct_ud_rel_ctl_op_del(&ep->rel, ops);
 }
 
 static UCS_F_ALWAYS_INLINE int
 uct_ud_ep_ctl_op_check(uct_ud_ep_t *ep, uint32_t op)
 {
-    return ep->tx.pending.ops & op;
+    return uct_ud_rel_ctl_op_check(&ep->rel, op);
 }
 
 static UCS_F_ALWAYS_INLINE int
 uct_ud_ep_ctl_op_isany(uct_ud_ep_t *ep)
 {
-    return ep->tx.pending.ops; 
+    return uct_ud_rel_ctl_op_isany(&ep->rel);
 }
 
 static UCS_F_ALWAYS_INLINE int
 uct_ud_ep_ctl_op_check_ex(uct_ud_ep_t *ep, uint32_t ops)
 {
-    return ep->tx.pending.ops == ops;
+    return uct_ud_rel_ctl_op_check_ex(&ep->rel, ops);
 }
 
 
@@ -377,34 +315,13 @@ static UCS_F_ALWAYS_INLINE int uct_ud_ep_is_connected(uct_ud_ep_t *ep)
 
 static UCS_F_ALWAYS_INLINE int uct_ud_ep_no_window(uct_ud_ep_t *ep)
 {
-    /* max_psn can be decreased by CA, so check >= */
-    return UCT_UD_PSN_COMPARE(ep->tx.psn, >=, ep->tx.max_psn);
+    return uct_ud_rel_no_window(&ep->rel);
 }
 
-/*
- * Request ACK once we sent 1/4 of the window or once we got to the window end
- * or there is a pending ack request operation
- */
-static UCS_F_ALWAYS_INLINE int uct_ud_ep_req_ack(uct_ud_ep_t *ep)
-{
-    uct_ud_psn_t acked_psn, max_psn, psn;
-
-    max_psn   = ep->tx.max_psn;
-    acked_psn = ep->tx.acked_psn;
-    psn       = ep->tx.psn;
-
-    return UCT_UD_PSN_COMPARE(psn, ==, ((acked_psn * 3 + max_psn) >> 2)) ||
-           UCT_UD_PSN_COMPARE(psn + 1, ==, max_psn) ||
-           uct_ud_ep_ctl_op_check(ep, UCT_UD_EP_OP_ACK_REQ);
-
-}
-
-
 static UCS_F_ALWAYS_INLINE void 
 uct_ud_neth_ack_req(uct_ud_ep_t *ep, uct_ud_neth_t *neth)
 {
-    neth->packet_type |= uct_ud_ep_req_ack(ep) << UCT_UD_PACKET_ACK_REQ_SHIFT;
-    uct_ud_ep_ctl_op_del(ep, UCT_UD_EP_OP_ACK|UCT_UD_EP_OP_ACK_REQ);
+    uct_ud_rel_neth_ack_req(&ep->rel, neth);
 }
 
 #endif 
@@ -617,11 +617,12 @@ static void uct_ud_iface_free_res_skbs(uct_ud_iface_t *iface)
     }
 }
 
-void uct_ud_iface_dispatch_zcopy_comps_do(uct_ud_iface_t *iface)
+unsigned uct_ud_iface_dispatch_zcopy_comps_do(uct_ud_iface_t *iface)
 {
     uct_ud_send_skb_t *skb;
     uct_ud_zcopy_desc_t *zdesc;
     uct_ud_ep_t *ep;
+    unsigned count = 0;
 
     do {
         skb = ucs_queue_pull_elem_non_empty(&iface->tx.zcopy_comp_q, uct_ud_send_skb_t, queue);
@@ -632,7 +633,9 @@ void uct_ud_iface_dispatch_zcopy_comps_do(uct_ud_iface_t *iface)
         ep->flags &= ~UCT_UD_EP_FLAG_ZCOPY_ASYNC_COMPS;
         skb->flags = 0;
         ucs_mpool_put(skb);
+        ++count;
     } while (!ucs_queue_is_empty(&iface->tx.zcopy_comp_q));
+    return count;
 }
 
 static void uct_ud_iface_free_zcopy_comps(uct_ud_iface_t *iface)
@@ -279,18 +279,20 @@ uct_ud_iface_get_async_time(uct_ud_iface_t *iface)
     return iface->super.super.worker->async->last_wakeup;
 }
 
-static UCS_F_ALWAYS_INLINE void
+static UCS_F_ALWAYS_INLINE unsigned
 uct_ud_iface_progress_pending(uct_ud_iface_t *iface, const uintptr_t is_async)
 {
+    unsigned count;
 
     if (!uct_ud_iface_can_tx(iface)) {
-        return;
+        return 0;
     }
 
     iface->tx.in_pending = 1;
-    ucs_arbiter_dispatch(&iface->tx.pending_q, 1,
-             uct_ud_ep_do_pending, (void *)is_async);
+    count = ucs_arbiter_dispatch(&iface->tx.pending_q, 1,
+                                 uct_ud_ep_do_pending, (void *)is_async);
     iface->tx.in_pending = 0;
+    return count;
 }
 
 static UCS_F_ALWAYS_INLINE void
@@ -328,15 +330,15 @@ uct_ud_iface_dispatch_pending_rx(uct_ud_iface_t *iface)
     return uct_ud_iface_dispatch_pending_rx_do(iface);
 }
 
-void uct_ud_iface_dispatch_zcopy_comps_do(uct_ud_iface_t *iface);
+unsigned uct_ud_iface_dispatch_zcopy_comps_do(uct_ud_iface_t *iface);
 
-static UCS_F_ALWAYS_INLINE void
+static UCS_F_ALWAYS_INLINE unsigned
 uct_ud_iface_dispatch_zcopy_comps(uct_ud_iface_t *iface)
 {
     if (ucs_likely(ucs_queue_is_empty(&iface->tx.zcopy_comp_q))) {
-        return;
+        return 0;
     }
-    uct_ud_iface_dispatch_zcopy_comps_do(iface);
+    return uct_ud_iface_dispatch_zcopy_comps_do(iface);
 }
 
 #if ENABLE_PARAMS_CHECK
@@ -8,7 +8,7 @@ uct_ud_ep_ctl_op_add(uct_ud_iface_t *iface, uct_ud_ep_t *ep, int op)
 {
     ucs_arbiter_group_push_elem(&ep->tx.pending.group, 
                                 &ep->tx.pending.elem);
-    ep->tx.pending.ops |= op;
+    ep->rel.ctl_ops |= op;
     ucs_arbiter_group_schedule(&iface->tx.pending_q, &ep->tx.pending.group);
 }
 
@@ -46,8 +46,8 @@ uct_ud_ep_get_tx_skb(uct_ud_iface_t *iface, uct_ud_ep_t *ep)
                      uct_ud_ep_no_window(ep))) {
         ucs_trace_data("iface=%p ep=%p (%d->%d) no ep resources (psn=%u max_psn=%u)",
                        iface, ep, ep->ep_id, ep->dest_ep_id,
-                       (unsigned)ep->tx.psn,
-                       (unsigned)ep->tx.max_psn);
+                       (unsigned)ep->rel.tx.psn,
+                       (unsigned)ep->rel.tx.max_psn);
         UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super.super);
         return NULL;
     }
@@ -85,15 +85,14 @@ uct_ud_iface_complete_tx_inl_nolog(uct_ud_iface_t *iface, uct_ud_ep_t *ep,
                                    const void *buffer, unsigned length)
 {
     iface->tx.skb = ucs_mpool_get(&iface->tx.mp);
-    ep->tx.psn++;
     skb->len += length;
     memcpy(data, buffer, length);
-    ucs_queue_push(&ep->tx.window, &skb->queue);
+    uct_ud_rel_tx_skb(&ep->rel, &skb->queue,
+                      uct_ud_iface_get_async_time(iface));
     ucs_wtimer_add(&iface->async.slow_timer, &ep->slow_timer,
                    uct_ud_iface_get_async_time(iface) - 
                    ucs_twheel_get_time(&iface->async.slow_timer) +
                    uct_ud_slow_tick());
-    ep->tx.send_time = uct_ud_iface_get_async_time(iface);
 }
 
 #define uct_ud_iface_complete_tx_inl(iface, ep, skb, data, buffer, length) \
@@ -106,13 +105,12 @@ uct_ud_iface_complete_tx_skb_nolog(uct_ud_iface_t *iface, uct_ud_ep_t *ep,
                                    uct_ud_send_skb_t *skb)
 {
     iface->tx.skb = ucs_mpool_get(&iface->tx.mp);
-    ep->tx.psn++;
-    ucs_queue_push(&ep->tx.window, &skb->queue);
+    uct_ud_rel_tx_skb(&ep->rel, &skb->queue,
+                      uct_ud_iface_get_async_time(iface));
     ucs_wtimer_add(&iface->async.slow_timer, &ep->slow_timer,
                    uct_ud_iface_get_async_time(iface) - 
                    ucs_twheel_get_time(&iface->async.slow_timer) +
                    uct_ud_slow_tick());
-    ep->tx.send_time = uct_ud_iface_get_async_time(iface);
 }
 
 #define uct_ud_iface_complete_tx_skb(iface, ep, skb) \
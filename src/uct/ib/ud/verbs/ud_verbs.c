@@ -282,7 +282,7 @@ ucs_status_t uct_ud_verbs_ep_put_short(uct_ep_h tl_ep,
 }
 
 
-static UCS_F_ALWAYS_INLINE void 
+static UCS_F_ALWAYS_INLINE unsigned
 uct_ud_verbs_iface_poll_tx(uct_ud_verbs_iface_t *iface)
 {
     struct ibv_wc wc;
@@ -291,23 +291,24 @@ uct_ud_verbs_iface_poll_tx(uct_ud_verbs_iface_t *iface)
     ret = ibv_poll_cq(iface->super.super.send_cq, 1, &wc);
     if (ucs_unlikely(ret < 0)) {
         ucs_fatal("Failed to poll send CQ");
-        return;
+        return 0;
     }
 
     if (ret == 0) {
-        return;
+        return 0;
     }
 
     if (ucs_unlikely(wc.status != IBV_WC_SUCCESS)) {
         ucs_fatal("Send completion (wr_id=0x%0X with error: %s ",
                   (unsigned)wc.wr_id, ibv_wc_status_str(wc.status));
-        return;
+        return 0;
     }
 
     iface->super.tx.available += UCT_UD_TX_MODERATION + 1;
     UCS_INSTRUMENT_RECORD(UCS_INSTRUMENT_TYPE_IB_TX,
                           "uct_ud_verbs_iface_poll_tx",
                           wc.wr_id, wc.status);
+    return 1;
 }
 
 static UCS_F_ALWAYS_INLINE ucs_status_t
@@ -368,22 +369,26 @@ static void uct_ud_verbs_iface_async_progress(uct_ud_iface_t *ud_iface)
     uct_ud_iface_progress_pending(&iface->super, 1);
 }
 
-static void uct_ud_verbs_iface_progress(void *arg)
+static unsigned uct_ud_verbs_iface_progress(void *arg)
 {
     uct_ud_verbs_iface_t *iface = arg;
     ucs_status_t status;
+    unsigned count;
 
     uct_ud_enter(&iface->super);
-    uct_ud_iface_dispatch_zcopy_comps(&iface->super);
+    count  = uct_ud_iface_dispatch_zcopy_comps(&iface->super);
     status = uct_ud_iface_dispatch_pending_rx(&iface->super);
     if (status == UCS_OK) {
         status = uct_ud_verbs_iface_poll_rx(iface, 0);
         if (status == UCS_ERR_NO_PROGRESS) {
-            uct_ud_verbs_iface_poll_tx(iface);
+            count += uct_ud_verbs_iface_poll_tx(iface);
         }
     }
-    uct_ud_iface_progress_pending(&iface->super, 0);
+    count += uct_ud_iface_progress_pending(&iface->super, 0);
     uct_ud_leave(&iface->super);
+
+    /* Either received new packets, or still has pending ones to dispatch */
+    return count + ((status == UCS_ERR_NO_PROGRESS) ? 0 : 1);
 }
 
 static ucs_status_t 
@@ -11,9 +11,34 @@
 #include <sys/uio.h>
 
 #include "cma_ep.h"
+#include <ucs/datastruct/mpool.inl>
 #include <ucs/debug/log.h>
 
 
+typedef ssize_t (*uct_cma_copy_func_t)(pid_t pid,
+                                       const struct iovec *local_iov,
+                                       unsigned long liovcnt,
+                                       const struct iovec *remote_iov,
+                                       unsigned long riovcnt,
+                                       unsigned long flags);
+
+static const struct {
+    uct_cma_copy_func_t func;
+    const char          *name;
+} uct_cma_copy_funcs[] = {
+    [UCT_CMA_OP_WRITE] = {process_vm_writev, "process_vm_writev"},
+    [UCT_CMA_OP_READ]  = {process_vm_readv,  "process_vm_readv"}
+};
+
+
+typedef struct {
+    pid_t               pid;
+    uct_cma_op_type_t   type;
+    void                *local_addr;
+    uint64_t            remote_addr;
+} uct_cma_copy_arg_t;
+
+
 static UCS_CLASS_INIT_FUNC(uct_cma_ep_t, uct_iface_t *tl_iface,
                            const uct_device_addr_t *dev_addr,
                            const uct_iface_addr_t *iface_addr)
@@ -22,12 +47,39 @@ static UCS_CLASS_INIT_FUNC(uct_cma_ep_t, uct_iface_t *tl_iface,
 
     UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super);
     self->remote_pid = *(const pid_t*)iface_addr;
+    ucs_queue_head_init(&self->ops);
+    ucs_arbiter_group_init(&self->arb_group);
+
+    /* Register for progress of the queued operations */
+    uct_worker_progress_register(iface->super.worker, uct_cma_iface_progress,
+                                 iface);
     return UCS_OK;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_cma_ep_t)
 {
-    /* No op */
+    uct_cma_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                            uct_cma_iface_t);
+    uct_cma_op_t *op;
+
+    uct_worker_progress_unregister(iface->super.worker, uct_cma_iface_progress,
+                                   iface);
+
+    if (!ucs_queue_is_empty(&self->ops)) {
+        ucs_list_del(&self->list);
+    }
+
+    /* Drop the operations which were not copied yet */
+    while (!ucs_queue_is_empty(&self->ops)) {
+        op = ucs_queue_pull_elem_non_empty(&self->ops, uct_cma_op_t, queue);
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, UCS_ERR_CANCELED);
+        }
+        ucs_mpool_put(op);
+        --iface->outstanding;
+    }
+
+    ucs_arbiter_group_cleanup(&self->arb_group);
 }
 
 UCS_CLASS_DEFINE(uct_cma_ep_t, uct_base_ep_t)
@@ -40,77 +92,292 @@ UCS_CLASS_DEFINE_DELETE_FUNC(uct_cma_ep_t, uct_ep_t);
      ucs_trace_data(_fmt " to %"PRIx64"(%+ld)", ## __VA_ARGS__, (_remote_addr), \
                     (_rkey))
 
-static inline ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
-                                                   const void *buffer,
-                                                   size_t length,
-                                                   uct_mem_h memh,
-                                                   uint64_t remote_addr,
-                                                   uct_rkey_t rkey,
-                                                   uct_completion_t *comp,
-                                                   ssize_t (*fn_p)(pid_t,
-                                                                   const struct iovec *,
-                                                                   unsigned long,
-                                                                   const struct iovec *,
-                                                                   unsigned long,
-                                                                   unsigned long),
-                                                   char *fn_name)
+/* Copy a contiguous range, called directly or by the copy engine threads */
+static ucs_status_t uct_cma_ep_copy(void *arg, size_t offset, size_t length)
 {
-    ssize_t ret;
-    ssize_t delivered = 0;
+    uct_cma_copy_arg_t *copy = arg;
+    size_t delivered = 0;
     struct iovec local_iov;
     struct iovec remote_iov;
-    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
+    ssize_t ret;
 
-    do {
-        local_iov.iov_base  = (void *)((char *)buffer + delivered);
-        remote_iov.iov_base = (void *)(remote_addr + delivered);
-        local_iov.iov_len   = remote_iov.iov_len  = length - delivered;
-        ret = fn_p(ep->remote_pid, &local_iov, 1, &remote_iov, 1, 0);
+    while (delivered < length) {
+        local_iov.iov_base  = copy->local_addr + offset + delivered;
+        remote_iov.iov_base = (void *)(copy->remote_addr + offset + delivered);
+        local_iov.iov_len   = remote_iov.iov_len = length - delivered;
+        ret = uct_cma_copy_funcs[copy->type].func(copy->pid, &local_iov, 1,
+                                                  &remote_iov, 1, 0);
         if (ret < 0) {
             ucs_error("%s delivered %zu instead of %zu, error message %s",
-                      fn_name, delivered, length, strerror(errno));
+                      uct_cma_copy_funcs[copy->type].name, delivered, length,
+                      strerror(errno));
             return UCS_ERR_IO_ERROR;
         }
         delivered += ret;
-    } while (delivered < length);
+    }
 
     return UCS_OK;
 }
 
+static ucs_status_t uct_cma_ep_copy_parallel(uct_cma_iface_t *iface,
+                                             uct_cma_ep_t *ep,
+                                             uct_cma_op_type_t type,
+                                             void *local_addr,
+                                             uint64_t remote_addr,
+                                             size_t length)
+{
+    uct_cma_copy_arg_t copy = {ep->remote_pid, type, local_addr, remote_addr};
+
+    if (iface->copy_engine != NULL) {
+        return ucs_copy_engine_run(iface->copy_engine, length, uct_cma_ep_copy,
+                                   &copy);
+    }
+
+    return uct_cma_ep_copy(&copy, 0, length);
+}
+
+static void uct_cma_ep_complete_op(uct_cma_iface_t *iface, uct_cma_ep_t *ep,
+                                   ucs_status_t status)
+{
+    uct_cma_op_t *op = ucs_queue_pull_elem_non_empty(&ep->ops, uct_cma_op_t,
+                                                     queue);
+
+    if (op->comp != NULL) {
+        uct_invoke_completion(op->comp, status);
+    }
+    ucs_mpool_put(op);
+    --iface->outstanding;
+}
+
+/*
+ * Copy the next chunk of the queued operations. Consecutive operations in the
+ * same direction are coalesced to a single system call, one iovec entry each.
+ */
+unsigned uct_cma_ep_progress(uct_cma_ep_t *ep)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_cma_iface_t);
+    struct iovec local_iov[UCT_CMA_MAX_IOV];
+    struct iovec remote_iov[UCT_CMA_MAX_IOV];
+    uct_cma_op_type_t type;
+    size_t total, length;
+    unsigned iovcnt, count;
+    ucs_status_t status;
+    uct_cma_op_t *op;
+    ssize_t ret;
+
+    type   = ucs_queue_head_elem_non_empty(&ep->ops, uct_cma_op_t, queue)->type;
+    iovcnt = 0;
+    total  = 0;
+    ucs_queue_for_each(op, &ep->ops, queue) {
+        if ((op->type != type) || (iovcnt == iface->config.max_iov) ||
+            (total == iface->config.chunk_size)) {
+            break;
+        }
+
+        length                      = ucs_min(op->length,
+                                              iface->config.chunk_size - total);
+        local_iov[iovcnt].iov_base  = op->local_addr;
+        local_iov[iovcnt].iov_len   = length;
+        remote_iov[iovcnt].iov_base = (void*)op->remote_addr;
+        remote_iov[iovcnt].iov_len  = length;
+        total                      += length;
+        ++iovcnt;
+    }
+
+    if ((iovcnt == 1) && (iface->copy_engine != NULL)) {
+        /* A single chunk can be split between the copy engine threads */
+        status = uct_cma_ep_copy_parallel(iface, ep, type, local_iov[0].iov_base,
+                                          (uintptr_t)remote_iov[0].iov_base,
+                                          total);
+        if (status != UCS_OK) {
+            uct_cma_ep_complete_op(iface, ep, status);
+            count = 1;
+            goto out;
+        }
+        ret = total;
+    } else {
+        ret = uct_cma_copy_funcs[type].func(ep->remote_pid, local_iov, iovcnt,
+                                            remote_iov, iovcnt, 0);
+        if (ucs_unlikely(ret < 0)) {
+            if ((errno == EINTR) || (errno == EAGAIN)) {
+                return 0;
+            }
+
+            ucs_error("%s(pid=%d) failed to copy %zu bytes: %s",
+                      uct_cma_copy_funcs[type].name, ep->remote_pid, total,
+                      strerror(errno));
+            uct_cma_ep_complete_op(iface, ep, UCS_ERR_IO_ERROR);
+            count = 1;
+            goto out;
+        }
+    }
+
+    /* The data is copied in iovec order, so complete the operations which
+     * were fully covered, and advance the one which was copied partially */
+    count = 0;
+    while (!ucs_queue_is_empty(&ep->ops)) {
+        op = ucs_queue_head_elem_non_empty(&ep->ops, uct_cma_op_t, queue);
+        if ((op->type != type) || (op->length > ret)) {
+            op->local_addr  += ret;
+            op->remote_addr += ret;
+            op->length      -= ret;
+            break;
+        }
+
+        ret -= op->length;
+        uct_cma_ep_complete_op(iface, ep, UCS_OK);
+        ++count;
+    }
+
+out:
+    if (ucs_queue_is_empty(&ep->ops)) {
+        ucs_list_del(&ep->list);
+    }
+    return count;
+}
+
+static inline ucs_status_t uct_cma_ep_common_zcopy(uct_ep_h tl_ep,
+                                                   void *buffer,
+                                                   size_t length,
+                                                   uint64_t remote_addr,
+                                                   uct_completion_t *comp,
+                                                   uct_cma_op_type_t type)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_cma_iface_t);
+    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
+    uct_cma_op_t *op;
+
+    if (ucs_queue_is_empty(&ep->ops) && (length <= iface->config.chunk_size)) {
+        /* Nothing to order with, and small enough to copy right away */
+        return uct_cma_ep_copy_parallel(iface, ep, type, buffer, remote_addr,
+                                        length);
+    }
+
+    if (iface->outstanding >= iface->config.tx_queue_len) {
+        UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    op = ucs_mpool_get_inline(&iface->op_mp);
+    if (op == NULL) {
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    op->type        = type;
+    op->local_addr  = buffer;
+    op->remote_addr = remote_addr;
+    op->length      = length;
+    op->comp        = comp;
+
+    if (ucs_queue_is_empty(&ep->ops)) {
+        ucs_list_add_tail(&iface->active_eps, &ep->list);
+    }
+    ucs_queue_push(&ep->ops, &op->queue);
+    ++iface->outstanding;
+    return UCS_INPROGRESS;
+}
+
 ucs_status_t uct_cma_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer, size_t length,
                                   uct_mem_h memh, uint64_t remote_addr,
                                   uct_rkey_t rkey, uct_completion_t *comp)
 {
-    int ret = uct_cma_ep_common_zcopy(tl_ep,
-                                      buffer,
-                                      length,
-                                      memh,
-                                      remote_addr,
-                                      rkey,
-                                      comp,
-                                      process_vm_writev,
-                                      "process_vm_writev");
+    ucs_status_t status = uct_cma_ep_common_zcopy(tl_ep, (void*)buffer, length,
+                                                  remote_addr, comp,
+                                                  UCT_CMA_OP_WRITE);
+    if (status < 0) {
+        return status;
+    }
 
     UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), PUT, ZCOPY, length);
     uct_cma_trace_data(remote_addr, rkey, "PUT_ZCOPY [length %zu]", length);
-    return ret;
+    return status;
 }
 
-ucs_status_t uct_cma_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length, 
-                                   uct_mem_h memh, uint64_t remote_addr,        
-                                   uct_rkey_t rkey, uct_completion_t *comp)
+ucs_status_t uct_cma_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                  uct_mem_h memh, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
 {
-    int ret = uct_cma_ep_common_zcopy(tl_ep,
-                                      buffer,
-                                      length,
-                                      memh,
-                                      remote_addr,
-                                      rkey,
-                                      comp,
-                                      process_vm_readv,
-                                      "process_vm_readv");
+    ucs_status_t status = uct_cma_ep_common_zcopy(tl_ep, buffer, length,
+                                                  remote_addr, comp,
+                                                  UCT_CMA_OP_READ);
+    if (status < 0) {
+        return status;
+    }
 
     UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), GET, ZCOPY, length);
     uct_cma_trace_data(remote_addr, rkey, "GET_ZCOPY [length %zu]", length);
-    return ret;
+    return status;
+}
+
+ucs_status_t uct_cma_ep_flush(uct_ep_h tl_ep)
+{
+    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
+
+    if (!ucs_queue_is_empty(&ep->ops)) {
+        UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+        return UCS_INPROGRESS;
+    }
+
+    UCT_TL_EP_STAT_FLUSH(&ep->super);
+    return UCS_OK;
+}
+
+ucs_status_t uct_cma_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_cma_iface_t);
+    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
+
+    /* check if resources became available */
+    if (iface->outstanding < iface->config.tx_queue_len) {
+        return UCS_ERR_BUSY;
+    }
+
+    UCS_STATIC_ASSERT(sizeof(ucs_arbiter_elem_t) <= UCT_PENDING_REQ_PRIV_LEN);
+
+    ucs_arbiter_elem_init((ucs_arbiter_elem_t *)n->priv);
+    ucs_arbiter_group_push_elem(&ep->arb_group, (ucs_arbiter_elem_t*)n->priv);
+    ucs_arbiter_group_schedule(&iface->arbiter, &ep->arb_group);
+    return UCS_OK;
+}
+
+ucs_arbiter_cb_result_t uct_cma_ep_process_pending(ucs_arbiter_t *arbiter,
+                                                   ucs_arbiter_elem_t *elem,
+                                                   void *arg)
+{
+    uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    ucs_status_t status;
+
+    status = req->func(req);
+    ucs_trace_data("progress pending request %p returned %s", req,
+                   ucs_status_string(status));
+
+    if (status == UCS_OK) {
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    } else if (status == UCS_INPROGRESS) {
+        return UCS_ARBITER_CB_RESULT_NEXT_GROUP;
+    } else {
+        /* no resources, retry after the next operation completes */
+        return UCS_ARBITER_CB_RESULT_STOP;
+    }
+}
+
+static ucs_arbiter_cb_result_t uct_cma_ep_arbiter_purge_cb(ucs_arbiter_t *arbiter,
+                                                           ucs_arbiter_elem_t *elem,
+                                                           void *arg)
+{
+    uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    uct_pending_callback_t cb = arg;
+
+    cb(req);
+    return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+}
+
+void uct_cma_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_cma_iface_t);
+    uct_cma_ep_t *ep = ucs_derived_of(tl_ep, uct_cma_ep_t);
+
+    ucs_arbiter_group_purge(&iface->arbiter, &ep->arb_group,
+                            uct_cma_ep_arbiter_purge_cb, cb);
 }
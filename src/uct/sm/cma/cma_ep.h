@@ -12,9 +12,33 @@
 #include <uct/base/uct_log.h>
 
 
+typedef enum {
+    UCT_CMA_OP_WRITE,
+    UCT_CMA_OP_READ,
+    UCT_CMA_OP_LAST
+} uct_cma_op_type_t;
+
+
+/**
+ * Zcopy operation which is copied by the progress, in chunks of up to
+ * config.chunk_size bytes.
+ */
+typedef struct uct_cma_op {
+    ucs_queue_elem_t    queue;        /* Element in the endpoint queue */
+    uct_cma_op_type_t   type;         /* Copy direction */
+    void                *local_addr;  /* Local data which was not copied yet */
+    uint64_t            remote_addr;  /* Remote data which was not copied yet */
+    size_t              length;       /* Remaining length */
+    uct_completion_t    *comp;        /* User completion callback */
+} uct_cma_op_t;
+
+
 typedef struct uct_cma_ep {
-    uct_base_ep_t super;
-    pid_t         remote_pid;
+    uct_base_ep_t       super;
+    pid_t               remote_pid;
+    ucs_queue_head_t    ops;          /* Queued operations, in posting order */
+    ucs_list_link_t     list;         /* Entry in iface->active_eps */
+    ucs_arbiter_group_t arb_group;    /* Pending requests */
 } uct_cma_ep_t;
 
 UCS_CLASS_DECLARE_NEW_FUNC(uct_cma_ep_t, uct_ep_t, uct_iface_t*,
@@ -26,4 +50,11 @@ ucs_status_t uct_cma_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer, size_t len
 ucs_status_t uct_cma_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
                                    uct_mem_h memh, uint64_t remote_addr,
                                    uct_rkey_t rkey, uct_completion_t *comp);
+ucs_status_t uct_cma_ep_flush(uct_ep_h tl_ep);
+ucs_status_t uct_cma_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n);
+void uct_cma_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb);
+ucs_arbiter_cb_result_t uct_cma_ep_process_pending(ucs_arbiter_t *arbiter,
+                                                   ucs_arbiter_elem_t *elem,
+                                                   void *arg);
+unsigned uct_cma_ep_progress(uct_cma_ep_t *ep);
 #endif
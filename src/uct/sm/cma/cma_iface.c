@@ -18,6 +18,32 @@ static ucs_config_field_t uct_cma_iface_config_table[] = {
     {"", "ALLOC=huge,mmap,heap", NULL,
     ucs_offsetof(uct_cma_iface_config_t, super),
     UCS_CONFIG_TYPE_TABLE(uct_iface_config_table)},
+
+    {"CHUNK_SIZE", "1m",
+     "Maximal amount of data copied by a single system call. Larger operations\n"
+     "are completed asynchronously, one chunk per progress call, so they do not\n"
+     "block the progress of other transports.",
+     ucs_offsetof(uct_cma_iface_config_t, chunk_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"MAX_IOV", "16",
+     "Maximal number of queued operations to the same peer which are coalesced\n"
+     "into a single system call.",
+     ucs_offsetof(uct_cma_iface_config_t, max_iov), UCS_CONFIG_TYPE_UINT},
+
+    {"TX_QUEUE_LEN", "256",
+     "Maximal number of operations which may be queued on the interface.",
+     ucs_offsetof(uct_cma_iface_config_t, tx_queue_len), UCS_CONFIG_TYPE_UINT},
+
+    {"COPY_THREADS", "0",
+     "Number of helper threads which copy a large chunk in parallel with the\n"
+     "calling thread, each with its own system call. The threads run on the\n"
+     "NUMA node of the CPU which creates the interface. 0 disables parallel copy.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_threads), UCS_CONFIG_TYPE_UINT},
+
+    {"COPY_MIN_PART", "256k",
+     "Minimal amount of data copied by each thread in a parallel copy.",
+     ucs_offsetof(uct_cma_iface_config_t, copy_min_part), UCS_CONFIG_TYPE_MEMUNITS},
+
     {NULL}
 };
 
@@ -41,6 +67,7 @@ static ucs_status_t uct_cma_iface_query(uct_iface_h tl_iface,
     iface_attr->ep_addr_len            = 0;
     iface_attr->cap.flags              = UCT_IFACE_FLAG_GET_ZCOPY |
                                          UCT_IFACE_FLAG_PUT_ZCOPY |
+                                         UCT_IFACE_FLAG_PENDING   |
                                          UCT_IFACE_FLAG_CONNECT_TO_IFACE;
 
     iface_attr->latency                = 80e-9; /* 80 ns */
@@ -49,31 +76,116 @@ static ucs_status_t uct_cma_iface_query(uct_iface_h tl_iface,
     return UCS_OK;
 }
 
+unsigned uct_cma_iface_progress(void *arg)
+{
+    uct_cma_iface_t *iface = arg;
+    uct_cma_ep_t *ep, *tmp;
+    unsigned count = 0;
+
+    ucs_list_for_each_safe(ep, tmp, &iface->active_eps, list) {
+        count += uct_cma_ep_progress(ep);
+    }
+
+    /* pending requests can make progress only if a queued operation is done */
+    if (iface->outstanding < iface->config.tx_queue_len) {
+        count += ucs_arbiter_dispatch(&iface->arbiter, 1,
+                                      uct_cma_ep_process_pending, NULL);
+    }
+    return count;
+}
+
+static ucs_status_t uct_cma_iface_flush(uct_iface_h tl_iface)
+{
+    uct_cma_iface_t *iface = ucs_derived_of(tl_iface, uct_cma_iface_t);
+
+    if (!ucs_list_is_empty(&iface->active_eps)) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return UCS_INPROGRESS;
+    }
+
+    UCT_TL_IFACE_STAT_FLUSH(&iface->super);
+    return UCS_OK;
+}
+
 static UCS_CLASS_DECLARE_DELETE_FUNC(uct_cma_iface_t, uct_iface_t);
 
 static uct_iface_ops_t uct_cma_iface_ops = {
     .iface_close         = UCS_CLASS_DELETE_FUNC_NAME(uct_cma_iface_t),
     .iface_query         = uct_cma_iface_query,
+    .iface_flush         = uct_cma_iface_flush,
     .iface_get_address   = uct_cma_iface_get_address,
     .iface_get_device_address = uct_sm_iface_get_device_address,
     .iface_is_reachable  = uct_sm_iface_is_reachable,
     .ep_put_zcopy        = uct_cma_ep_put_zcopy,
     .ep_get_zcopy        = uct_cma_ep_get_zcopy,
+    .ep_flush            = uct_cma_ep_flush,
+    .ep_pending_add      = uct_cma_ep_pending_add,
+    .ep_pending_purge    = uct_cma_ep_pending_purge,
     .ep_create_connected = UCS_CLASS_NEW_FUNC_NAME(uct_cma_ep_t),
     .ep_destroy          = UCS_CLASS_DELETE_FUNC_NAME(uct_cma_ep_t),
 };
 
+static ucs_mpool_ops_t uct_cma_op_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
 static UCS_CLASS_INIT_FUNC(uct_cma_iface_t, uct_pd_h pd, uct_worker_h worker,
                            const char *dev_name, size_t rx_headroom,
                            const uct_iface_config_t *tl_config)
 {
+    uct_cma_iface_config_t *config = ucs_derived_of(tl_config,
+                                                    uct_cma_iface_config_t);
+    ucs_status_t status;
+
     UCS_CLASS_CALL_SUPER_INIT(uct_base_iface_t, &uct_cma_iface_ops, pd, worker,
                               tl_config UCS_STATS_ARG(NULL));
+
+    if ((config->chunk_size == 0) || (config->max_iov == 0) ||
+        (config->tx_queue_len == 0)) {
+        ucs_error("CMA chunk size, max. iov and tx queue length must be non-zero");
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    self->config.chunk_size   = config->chunk_size;
+    self->config.max_iov      = ucs_min(config->max_iov, UCT_CMA_MAX_IOV);
+    self->config.tx_queue_len = config->tx_queue_len;
+    self->outstanding         = 0;
+
+    status = ucs_mpool_init(&self->op_mp, 0, sizeof(uct_cma_op_t), 0,
+                            UCS_SYS_CACHE_LINE_SIZE, 128, UINT_MAX,
+                            &uct_cma_op_mpool_ops, "cma_ops");
+    if (status != UCS_OK) {
+        ucs_error("Failed to create a memory pool for CMA operations");
+        return status;
+    }
+
+    self->copy_engine = NULL;
+    if (config->copy_threads > 0) {
+        status = ucs_copy_engine_create(config->copy_threads,
+                                        config->copy_min_part,
+                                        ucs_numa_current_node(), "cma",
+                                        &self->copy_engine);
+        if (status != UCS_OK) {
+            ucs_mpool_cleanup(&self->op_mp, 1);
+            return status;
+        }
+    }
+
+    ucs_list_head_init(&self->active_eps);
+    ucs_arbiter_init(&self->arbiter);
     return UCS_OK;
 }
 
 static UCS_CLASS_CLEANUP_FUNC(uct_cma_iface_t)
 {
+    ucs_arbiter_cleanup(&self->arbiter);
+    if (self->copy_engine != NULL) {
+        ucs_copy_engine_destroy(self->copy_engine);
+    }
+    ucs_mpool_cleanup(&self->op_mp, 1);
 }
 
 UCS_CLASS_DEFINE(uct_cma_iface_t, uct_base_iface_t);
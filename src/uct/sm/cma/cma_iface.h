@@ -8,20 +8,42 @@
 #define UCT_CMA_IFACE_H
 
 #include <uct/base/uct_iface.h>
+#include <ucs/datastruct/arbiter.h>
+#include <ucs/datastruct/list.h>
+#include <ucs/datastruct/mpool.h>
+#include <ucs/sys/copy_engine.h>
 
 #define UCT_CMA_TL_NAME "cma"
+#define UCT_CMA_MAX_IOV 64
 
 
 typedef struct uct_cma_iface_config {
     uct_iface_config_t      super;
+    size_t                  chunk_size;
+    unsigned                max_iov;
+    unsigned                tx_queue_len;
+    unsigned                copy_threads;
+    size_t                  copy_min_part;
 } uct_cma_iface_config_t;
 
 
 typedef struct uct_cma_iface {
     uct_base_iface_t        super;
+    ucs_mpool_t             op_mp;        /* Queued zcopy operations */
+    ucs_list_link_t         active_eps;   /* Endpoints with queued operations */
+    ucs_arbiter_t           arbiter;      /* Pending requests */
+    unsigned                outstanding;  /* Number of queued operations */
+    ucs_copy_engine_t       *copy_engine; /* Parallel copy, or NULL */
+    struct {
+        size_t              chunk_size;   /* Max. bytes per system call */
+        unsigned            max_iov;      /* Max. operations per system call */
+        unsigned            tx_queue_len; /* Max. queued operations */
+    } config;
 } uct_cma_iface_t;
 
 
 extern uct_tl_component_t uct_cma_tl;
 
+unsigned uct_cma_iface_progress(void *arg);
+
 #endif
@@ -16,6 +16,8 @@ typedef struct uct_mm_ep                uct_mm_ep_t;
 typedef struct uct_mm_iface             uct_mm_iface_t;
 typedef struct uct_mm_fifo_ctl          uct_mm_fifo_ctl_t;
 typedef struct uct_mm_fifo_element      uct_mm_fifo_element_t;
+typedef struct uct_mm_fifo_lane         uct_mm_fifo_lane_t;
+typedef struct uct_mm_zcopy_hdr         uct_mm_zcopy_hdr_t;
 typedef struct uct_mm_recv_desc         uct_mm_recv_desc_t;
 typedef struct uct_mm_remote_seg        uct_mm_remote_seg_t;
 
@@ -24,6 +26,7 @@ typedef struct uct_mm_remote_seg        uct_mm_remote_seg_t;
 enum {
     UCT_MM_FIFO_ELEM_FLAG_OWNER  = UCS_BIT(0), /* new/old info */
     UCT_MM_FIFO_ELEM_FLAG_INLINE = UCS_BIT(1), /* if inline or not */
+    UCT_MM_FIFO_ELEM_FLAG_ZCOPY  = UCS_BIT(2), /* payload is in the sender's segment */
 };
 
 enum {
@@ -8,6 +8,7 @@
 #include "mm_ep.h"
 
 #include <ucs/arch/atomic.h>
+#include <ucs/arch/bitops.h>
 
 
 SGLIB_DEFINE_LIST_FUNCTIONS(uct_mm_remote_seg_t, uct_mm_remote_seg_compare, next)
@@ -21,6 +22,7 @@ static ucs_status_t
 uct_mm_ep_signal_remote(uct_mm_ep_t *ep, uct_mm_iface_conn_signal_t sig)
 {
     uct_mm_iface_t *iface = ucs_derived_of(ep->super.super.iface, uct_mm_iface_t);
+    uct_mm_fifo_ctl_t *fifo_ctl = ep->shared_ctl;
     int ret;
 
     /**
@@ -28,8 +30,8 @@ uct_mm_ep_signal_remote(uct_mm_ep_t *ep, uct_mm_iface_conn_signal_t sig)
      */
     for (;;) {
         ret = sendto(iface->signal_fd, &sig, sizeof(sig), 0,
-                     (const struct sockaddr*)&ep->fifo_ctl->signal_sockaddr,
-                     ep->fifo_ctl->signal_addrlen);
+                     (const struct sockaddr*)&fifo_ctl->signal_sockaddr,
+                     fifo_ctl->signal_addrlen);
         if (ret >= 0) {
             ucs_assert(ret == sizeof(sig));
             return UCS_OK;
@@ -47,12 +49,62 @@ uct_mm_ep_signal_remote(uct_mm_ep_t *ep, uct_mm_iface_conn_signal_t sig)
     }
 }
 
+/*
+ * Try to take ownership of a free lane on the destination, so the ep would be
+ * its only producer. If all lanes are taken, the ep sends to the shared fifo.
+ */
+static void uct_mm_ep_acquire_lane(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_ctl_t *fifo_ctl = ep->fifo_ctl;
+    unsigned num_lanes;
+    uint64_t busy, free_lanes;
+
+    ep->lane  = -1;
+    num_lanes = ucs_min(fifo_ctl->num_lanes, iface->config.fifo_lanes);
+    if (num_lanes == 0) {
+        return;
+    }
+
+    do {
+        busy = fifo_ctl->lanes_busy;
+        free_lanes = ~busy & UCS_MASK_SAFE(num_lanes);
+        if (free_lanes == 0) {
+            ucs_debug("mm: ep %p: all %u lanes are busy, using the shared fifo",
+                      ep, num_lanes);
+            return;
+        }
+        ep->lane = ucs_ffs64(free_lanes);
+    } while (ucs_atomic_cswap64(&fifo_ctl->lanes_busy, busy,
+                                busy | UCS_BIT(ep->lane)) != busy);
+
+    uct_mm_set_fifo_ptrs(uct_mm_fifo_lane_ctl(iface, fifo_ctl, ep->lane),
+                         &ep->fifo_ctl, &ep->fifo);
+}
+
+static void uct_mm_ep_release_lane(uct_mm_ep_t *ep)
+{
+    uct_mm_fifo_ctl_t *fifo_ctl = ep->shared_ctl;
+    uint64_t busy;
+
+    if (ep->lane < 0) {
+        return;
+    }
+
+    /* the receiver keeps polling the lane until it's drained */
+    ucs_memory_cpu_store_fence();
+    do {
+        busy = fifo_ctl->lanes_busy;
+    } while (ucs_atomic_cswap64(&fifo_ctl->lanes_busy, busy,
+                                busy & ~UCS_BIT(ep->lane)) != busy);
+}
+
 static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, uct_iface_t *tl_iface,
                            const uct_device_addr_t *dev_addr,
                            const uct_iface_addr_t *iface_addr)
 {
     uct_mm_iface_t *iface = ucs_derived_of(tl_iface, uct_mm_iface_t);
     const uct_mm_iface_addr_t *addr = (const void*)iface_addr;
+    uct_pending_prio_t prio;
     ucs_status_t status;
     size_t size_to_attach;
 
@@ -77,11 +129,14 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, uct_iface_t *tl_iface,
     self->mapped_desc.length = size_to_attach;
     self->mapped_desc.mmid   = addr->id;
     uct_mm_set_fifo_ptrs(self->mapped_desc.address, &self->fifo_ctl, &self->fifo);
+    self->shared_ctl         = self->fifo_ctl;
+    uct_mm_ep_acquire_lane(self, iface);
     self->cached_tail        = self->fifo_ctl->tail;
 
     /* Send connect message to remote side so it will start polling */
     status = uct_mm_ep_signal_remote(self, UCT_MM_IFACE_SIGNAL_CONNECT);
     if (status != UCS_OK) {
+        uct_mm_ep_release_lane(self);
         uct_mm_pd_mapper_ops(iface->super.pd)->detach(&self->mapped_desc);
         return status;
     }
@@ -90,24 +145,53 @@ static UCS_CLASS_INIT_FUNC(uct_mm_ep_t, uct_iface_t *tl_iface,
      * chunks that hold the descriptors for bcopy. */
     sglib_hashed_uct_mm_remote_seg_t_init(self->remote_segments_hash);
 
-    ucs_arbiter_group_init(&self->arb_group);
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        ucs_arbiter_group_init(&self->arb_group[prio]);
+    }
+    ucs_queue_head_init(&self->zcopy_ops);
 
     /* Register for send side progress */
     uct_worker_progress_register(iface->super.worker, uct_mm_iface_progress,
                                  iface);
 
-    ucs_debug("mm: ep connected: %p, to remote_shmid: %zu", self, addr->id);
+    ucs_debug("mm: ep connected: %p, to remote_shmid: %zu lane: %d", self,
+              addr->id, self->lane);
 
     return UCS_OK;
 }
 
+/*
+ * Cancel the zcopy sends of a destroyed endpoint. The receiver may still hold
+ * their payload and write their status later, so the operations are returned
+ * to the pool only after that.
+ */
+static void uct_mm_ep_zcopy_purge(uct_mm_ep_t *ep, uct_mm_iface_t *iface)
+{
+    uct_mm_zcopy_op_t *op;
+
+    if (ucs_queue_is_empty(&ep->zcopy_ops)) {
+        return;
+    }
+
+    ucs_list_del(&ep->zcopy_list);
+    ucs_queue_for_each_extract(op, &ep->zcopy_ops, queue, 1) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, UCS_ERR_CANCELED);
+        }
+        ucs_queue_push(&iface->zcopy_orphans, &op->queue);
+    }
+}
+
 static UCS_CLASS_CLEANUP_FUNC(uct_mm_ep_t)
 {
     uct_mm_iface_t *iface = ucs_derived_of(self->super.super.iface, uct_mm_iface_t);
     ucs_status_t status;
     uct_mm_remote_seg_t *remote_seg;
     struct sglib_hashed_uct_mm_remote_seg_t_iterator iter;
+    uct_pending_prio_t prio;
 
+    uct_mm_ep_zcopy_purge(self, iface);
+    uct_mm_ep_release_lane(self);
     uct_mm_ep_signal_remote(self, UCT_MM_IFACE_SIGNAL_DISCONNECT);
 
     uct_worker_progress_unregister(iface->super.worker, uct_mm_iface_progress,
@@ -131,7 +215,9 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_ep_t)
         ucs_error("error detaching from remote FIFO");
     }
 
-    ucs_arbiter_group_cleanup(&self->arb_group);
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        ucs_arbiter_group_cleanup(&self->arb_group[prio]);
+    }
 }
 
 UCS_CLASS_DEFINE(uct_mm_ep_t, uct_base_ep_t)
@@ -159,6 +245,26 @@ ucs_status_t uct_mm_ep_put_short(uct_ep_h tl_ep, const void *buffer,
     return UCS_OK;
 }
 
+ucs_status_t uct_mm_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer, size_t length,
+                                 uct_mem_h memh, uint64_t remote_addr,
+                                 uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
+
+    /* the remote segment is attached when unpacking the rkey, so this is a
+     * single copy from the local buffer */
+    if (iface->copy_engine != NULL) {
+        ucs_copy_engine_memcpy(iface->copy_engine, (void *)(rkey + remote_addr),
+                               buffer, length);
+    } else {
+        ucs_memcpy_relaxed((void *)(rkey + remote_addr), buffer, length);
+    }
+    uct_mm_trace_data(remote_addr, rkey, "PUT_ZCOPY [buffer %p size %zu]",
+                      buffer, length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), PUT, ZCOPY, length);
+    return UCS_OK;
+}
+
 ssize_t uct_mm_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
                             void *arg, uint64_t remote_addr, uct_rkey_t rkey)
 {
@@ -219,9 +325,15 @@ static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t h
                                /* must be smaller than fifo size */
     uint64_t returned_val;
 
-    elem_index = ep->fifo_ctl->head & iface->fifo_mask;
+    elem_index = head & iface->fifo_mask;
     *elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, ep->fifo, elem_index);
 
+    if (ep->lane >= 0) {
+        /* the ep is the only producer of its lane */
+        ep->fifo_ctl->head = head + 1;
+        return UCS_OK;
+    }
+
     /* try to get ownership of the head element */
     returned_val = ucs_atomic_cswap64(&ep->fifo_ctl->head, head, head+1);
     if (returned_val != head) {
@@ -231,27 +343,18 @@ static inline ucs_status_t uct_mm_ep_get_remote_elem(uct_mm_ep_t *ep, uint64_t h
     return UCS_OK;
 }
 
-/* A common mm active message sending function.
- * The first parameter indicates the origin of the call.
- * is_short = 1 - perform AM short sending
- * is_short = 0 - perform AM bcopy sending
- */
-static UCS_F_ALWAYS_INLINE ssize_t
-uct_mm_ep_am_common_send(const unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_t *iface,
-                         uint8_t am_id, size_t length, uint64_t header,
-                         const void *payload, uct_pack_callback_t pack_cb, void *arg)
+/* Reserve the head element of the remote FIFO, if there is room in it */
+static UCS_F_ALWAYS_INLINE ucs_status_t
+uct_mm_ep_reserve_elem(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                       uct_mm_fifo_element_t **elem_p, uint64_t *head_p)
 {
-    uct_mm_fifo_element_t *elem;
     ucs_status_t status;
-    void *base_address;
     uint64_t head;
 
-    UCT_CHECK_AM_ID(am_id);
-
     head = ep->fifo_ctl->head;
     /* check if there is room in the remote process's receive FIFO to write */
     if (!UCT_MM_EP_IS_ABLE_TO_SEND(head, ep->cached_tail, iface->config.fifo_size)) {
-        if (!ucs_arbiter_group_is_empty(&ep->arb_group)) {
+        if (uct_mm_ep_has_pending(ep)) {
             /* pending isn't empty. don't send now to prevent out-of-order sending */
             UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super);
             return UCS_ERR_NO_RESOURCE;
@@ -267,19 +370,94 @@ uct_mm_ep_am_common_send(const unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_
         }
     }
 
-    status = uct_mm_ep_get_remote_elem(ep, head, &elem);
+    status = uct_mm_ep_get_remote_elem(ep, head, elem_p);
     if (status != UCS_OK) {
         ucs_trace_poll("couldn't get an available FIFO element");
         UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super);
         return status;
     }
 
+    *head_p = head;
+    return UCS_OK;
+}
+
+/* Wake up a receiver which waits for messages on its wakeup socket */
+static UCS_F_NOINLINE void uct_mm_ep_signal_wakeup(uct_mm_ep_t *ep,
+                                                  uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_ctl_t *fifo_ctl = ep->shared_ctl;
+    uint8_t sig = 0;
+    int ret;
+
+    /* only one sender signals every arm of the receiver */
+    if (ucs_atomic_cswap32(&fifo_ctl->wakeup_armed, 1, 0) != 1) {
+        return;
+    }
+
+    ret = sendto(iface->signal_fd, &sig, sizeof(sig), 0,
+                 (const struct sockaddr*)&fifo_ctl->wakeup_sockaddr,
+                 fifo_ctl->wakeup_addrlen);
+    if ((ret < 0) && (errno != EAGAIN)) {
+        /* EAGAIN means there are already signals the receiver did not read */
+        ucs_error("failed to send wakeup signal: %m");
+    }
+}
+
+/* Hand over a written FIFO element to the receiver */
+static UCS_F_ALWAYS_INLINE void
+uct_mm_ep_post_elem(uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                    uct_mm_fifo_element_t *elem, uint8_t am_id, uint64_t head)
+{
+    elem->am_id = am_id;
+
+    /* memory barrier - make sure that the memory is flushed before setting the
+     * 'writing is complete' flag which the reader checks */
+    ucs_memory_cpu_store_fence();
+
+    /* change the owner bit to indicate that the writing is complete.
+     * the owner bit flips after every FIFO wraparound */
+    if (head & iface->config.fifo_size) {
+        elem->flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    } else {
+        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_OWNER;
+    }
+
+    /* the flag is set only while the receiver sleeps, so there is no system
+     * call on the fast path */
+    if (ucs_unlikely(ep->shared_ctl->wakeup_armed)) {
+        uct_mm_ep_signal_wakeup(ep, iface);
+    }
+}
+
+/* A common mm active message sending function.
+ * The first parameter indicates the origin of the call.
+ * is_short = 1 - perform AM short sending
+ * is_short = 0 - perform AM bcopy sending
+ */
+static UCS_F_ALWAYS_INLINE ssize_t
+uct_mm_ep_am_common_send(const unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_t *iface,
+                         uint8_t am_id, size_t length, uint64_t header,
+                         const void *payload, uct_pack_callback_t pack_cb, void *arg)
+{
+    uct_mm_fifo_element_t *elem;
+    ucs_status_t status;
+    void *base_address;
+    uint64_t head;
+
+    UCT_CHECK_AM_ID(am_id);
+
+    status = uct_mm_ep_reserve_elem(ep, iface, &elem, &head);
+    if (status != UCS_OK) {
+        return status;
+    }
+
     if (is_short) {
         /* AM_SHORT */
         /* write to the remote FIFO */
         *(uint64_t*) (elem + 1) = header;
         memcpy((void*) (elem + 1) + sizeof(header), payload, length);
 
+        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_ZCOPY;
         elem->flags |= UCT_MM_FIFO_ELEM_FLAG_INLINE;
         elem->length = length + sizeof(header);
 
@@ -293,7 +471,7 @@ uct_mm_ep_am_common_send(const unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_
         base_address = uct_mm_ep_attach_remote_seg(ep, iface, elem);
         length = pack_cb(base_address + elem->desc_offset, arg);
 
-        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_INLINE;
+        elem->flags &= ~(UCT_MM_FIFO_ELEM_FLAG_INLINE | UCT_MM_FIFO_ELEM_FLAG_ZCOPY);
         elem->length = length;
 
         uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, am_id,
@@ -302,19 +480,7 @@ uct_mm_ep_am_common_send(const unsigned is_short, uct_mm_ep_t *ep, uct_mm_iface_
         UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
     }
 
-    elem->am_id = am_id;
-
-    /* memory barrier - make sure that the memory is flushed before setting the
-     * 'writing is complete' flag which the reader checks */
-    ucs_memory_cpu_store_fence();
-
-    /* change the owner bit to indicate that the writing is complete.
-     * the owner bit flips after every FIFO wraparound */
-    if (head & iface->config.fifo_size) {
-        elem->flags |= UCT_MM_FIFO_ELEM_FLAG_OWNER;
-    } else {
-        elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_OWNER;
-    }
+    uct_mm_ep_post_elem(ep, iface, elem, am_id, head);
 
     if (is_short) {
         return UCS_OK;
@@ -347,7 +513,144 @@ ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_
                                     pack_cb, arg);
 }
 
+/*
+ * The payload stays in the sender's segment, and the receiver passes it to the
+ * user from there. The send is completed when the receiver releases the
+ * payload, by writing the status of the operation.
+ */
+ucs_status_t uct_mm_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                unsigned header_length, const void *payload,
+                                size_t length, uct_mem_h memh,
+                                uct_completion_t *comp)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
+    uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
+    uct_mm_seg_t *seg = memh;
+    uct_mm_fifo_element_t *elem;
+    uct_mm_zcopy_hdr_t *zhdr;
+    uct_mm_zcopy_op_t *op;
+    ucs_status_t status;
+    uint64_t head;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_CHECK_LENGTH(header_length, 0, "am_zcopy header");
+    UCT_CHECK_LENGTH(length, iface->config.max_am_zcopy, "am_zcopy");
+    UCT_CHECK_PARAM((length == 0) ||
+                    ((seg != UCT_INVALID_MEM_HANDLE) &&
+                     (payload >= seg->address) &&
+                     (payload + length <= seg->address + seg->length)),
+                    "am_zcopy payload %p..%p is not in the segment of memh %p",
+                    payload, payload + length, memh);
+
+    op = ucs_mpool_get(&iface->zcopy_op_mp);
+    if (op == NULL) {
+        UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    status = uct_mm_ep_reserve_elem(ep, iface, &elem, &head);
+    if (status != UCS_OK) {
+        ucs_mpool_put(op);
+        return status;
+    }
+
+    zhdr              = (void*)(elem + 1);
+    zhdr->payload     = (uintptr_t)payload;
+    zhdr->length      = length;
+    if (length > 0) {
+        zhdr->mmid        = seg->mmid;
+        zhdr->seg_address = (uintptr_t)seg->address;
+        zhdr->seg_length  = seg->length;
+    }
+    zhdr->op_mmid        = op->seg_mmid;
+    zhdr->op_seg_address = (uintptr_t)op->seg_address;
+    zhdr->op_seg_length  = op->seg_length;
+    zhdr->op_status      = (uintptr_t)&op->status;
+
+    elem->flags &= ~UCT_MM_FIFO_ELEM_FLAG_INLINE;
+    elem->flags |= UCT_MM_FIFO_ELEM_FLAG_ZCOPY;
+    elem->length = 0;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, payload,
+                       length, "TX: AM_ZCOPY");
+    UCT_TL_EP_STAT_OP(&ep->super, AM, ZCOPY, length);
+
+    /* the receiver may release the payload as soon as the element is posted */
+    op->comp   = comp;
+    op->status = UCS_INPROGRESS;
+    if (ucs_queue_is_empty(&ep->zcopy_ops)) {
+        ucs_list_add_tail(&iface->zcopy_eps, &ep->zcopy_list);
+    }
+    ucs_queue_push(&ep->zcopy_ops, &op->queue);
+
+    uct_mm_ep_post_elem(ep, iface, elem, id, head);
+    return UCS_INPROGRESS;
+}
+
+/*
+ * Complete the zcopy sends of an endpoint whose payload was released by the
+ * receiver. The receiver may hold some payloads longer than others, so the
+ * sends are completed in the order they are released. The endpoint leaves the
+ * iface list before the completions are called, since they may send again.
+ */
+static unsigned uct_mm_ep_progress_zcopy(uct_mm_ep_t *ep)
+{
+    ucs_queue_head_t done;
+    uct_mm_zcopy_op_t *op;
+    ucs_queue_iter_t iter;
+    unsigned count = 0;
+
+    ucs_queue_head_init(&done);
+    ucs_queue_for_each_safe(op, iter, &ep->zcopy_ops, queue) {
+        if (op->status != UCS_INPROGRESS) {
+            ucs_queue_del_iter(&ep->zcopy_ops, iter);
+            ucs_queue_push(&done, &op->queue);
+        }
+    }
+
+    if (ucs_queue_is_empty(&ep->zcopy_ops)) {
+        ucs_list_del(&ep->zcopy_list);
+    }
+
+    ucs_queue_for_each_extract(op, &done, queue, 1) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, (ucs_status_t)op->status);
+        }
+        ucs_mpool_put(op);
+        ++count;
+    }
+    return count;
+}
+
+unsigned uct_mm_iface_progress_zcopy(uct_mm_iface_t *iface)
+{
+    uct_mm_zcopy_op_t *op;
+    uct_mm_ep_t *ep, *tmp;
+    ucs_queue_iter_t iter;
+    unsigned count = 0;
+
+    ucs_memory_cpu_load_fence();
+
+    ucs_list_for_each_safe(ep, tmp, &iface->zcopy_eps, zcopy_list) {
+        count += uct_mm_ep_progress_zcopy(ep);
+    }
+
+    ucs_queue_for_each_safe(op, iter, &iface->zcopy_orphans, queue) {
+        if (op->status != UCS_INPROGRESS) {
+            ucs_queue_del_iter(&iface->zcopy_orphans, iter);
+            ucs_mpool_put(op);
+        }
+    }
+    return count;
+}
+
 ucs_status_t uct_mm_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n)
+{
+    return uct_mm_ep_pending_add_prio(tl_ep, n, UCT_PENDING_PRIO_LOW);
+}
+
+ucs_status_t uct_mm_ep_pending_add_prio(uct_ep_h tl_ep, uct_pending_req_t *n,
+                                        uct_pending_prio_t prio)
 {
     uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
     uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
@@ -361,9 +664,9 @@ ucs_status_t uct_mm_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n)
 
     ucs_arbiter_elem_init((ucs_arbiter_elem_t *)n->priv);
     /* add the request to the ep's arbiter_group (pending queue) */
-    ucs_arbiter_group_push_elem(&ep->arb_group, (ucs_arbiter_elem_t*) n->priv);
+    ucs_arbiter_group_push_elem(&ep->arb_group[prio], (ucs_arbiter_elem_t*) n->priv);
     /* add the ep's group to the arbiter */
-    ucs_arbiter_group_schedule(&iface->arbiter, &ep->arb_group);
+    ucs_arbiter_group_schedule(&iface->arbiter[prio], &ep->arb_group[prio]);
 
     return UCS_OK;
 }
@@ -373,8 +676,10 @@ ucs_arbiter_cb_result_t uct_mm_ep_process_pending(ucs_arbiter_t *arbiter,
                                                   void *arg)
 {
     uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    uct_pending_prio_t prio = (uintptr_t)arg;
     ucs_status_t status;
-    uct_mm_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem), uct_mm_ep_t, arb_group);
+    uct_mm_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem) - prio,
+                                       uct_mm_ep_t, arb_group);
 
     /* update the local tail with its actual value from the remote peer
      * making sure that the pending sends would use the real tail value */
@@ -413,9 +718,12 @@ void uct_mm_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb)
 {
     uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
     uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
+    uct_pending_prio_t prio;
 
-    ucs_arbiter_group_purge(&iface->arbiter, &ep->arb_group,
-                            uct_mm_ep_abriter_purge_cb, cb);
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        ucs_arbiter_group_purge(&iface->arbiter[prio], &ep->arb_group[prio],
+                                uct_mm_ep_abriter_purge_cb, cb);
+    }
 }
 
 ucs_status_t uct_mm_ep_atomic_add64(uct_ep_h tl_ep, uint64_t add,
@@ -533,10 +841,36 @@ ucs_status_t uct_mm_ep_get_bcopy(uct_ep_h tl_ep, uct_unpack_callback_t unpack_cb
     return UCS_OK;
 }
 
+ucs_status_t uct_mm_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                 uct_mem_h memh, uint64_t remote_addr,
+                                 uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_mm_iface_t);
+
+    if (iface->copy_engine != NULL) {
+        ucs_copy_engine_memcpy(iface->copy_engine, buffer,
+                               (void *)(rkey + remote_addr), length);
+    } else {
+        memcpy(buffer, (void *)(rkey + remote_addr), length);
+    }
+    uct_mm_trace_data(remote_addr, rkey, "GET_ZCOPY [buffer %p size %zu]",
+                      buffer, length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), GET, ZCOPY, length);
+    return UCS_OK;
+}
+
 ucs_status_t uct_mm_ep_flush(uct_ep_h tl_ep)
 {
+    uct_mm_ep_t *ep = ucs_derived_of(tl_ep, uct_mm_ep_t);
+
+    if (!ucs_queue_is_empty(&ep->zcopy_ops)) {
+        /* wait for the receiver to release the zcopy payloads */
+        UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+        return UCS_INPROGRESS;
+    }
+
     ucs_memory_cpu_store_fence();
-    UCT_TL_EP_STAT_FLUSH(ucs_derived_of(tl_ep, uct_base_ep_t));
+    UCT_TL_EP_STAT_FLUSH(&ep->super);
     return UCS_OK;
 }
 
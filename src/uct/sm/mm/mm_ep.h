@@ -18,8 +18,12 @@ struct uct_mm_ep {
 
     /* Remote peer */
     uct_mm_remote_seg_t  mapped_desc; /* pointer to the descriptor of the destination's shared_mem (FIFO) */
+    uct_mm_fifo_ctl_t    *shared_ctl; /* destination's shared fifo ctl, holds the
+                                         signaling and wakeup state */
     uct_mm_fifo_ctl_t    *fifo_ctl;   /* pointer to the destination's ctl struct in the receive fifo */
     void                 *fifo;       /* fifo elements (destination's receive fifo) */
+    int                  lane;        /* destination's lane owned by this ep, or -1 if
+                                         sending to the shared fifo */
 
     uint64_t             cached_tail; /* the sender's own copy of the remote FIFO's tail.
                                          it is not always updated with the actual remote tail value */
@@ -28,9 +32,25 @@ struct uct_mm_ep {
      * (after attaching to them) */
     uct_mm_remote_seg_t  *remote_segments_hash[UCT_MM_BASE_ADDRESS_HASH_SIZE];
 
-    ucs_arbiter_group_t  arb_group;   /* the group that holds this ep's pending operations */
+    ucs_arbiter_group_t  arb_group[UCT_PENDING_PRIO_LAST]; /* the groups that hold this ep's
+                                                               pending operations, per priority */
+
+    ucs_queue_head_t     zcopy_ops;   /* zcopy sends whose payload is held by the receiver */
+    ucs_list_link_t      zcopy_list;  /* entry in the iface list of endpoints with zcopy sends */
 };
 
+
+/* A zcopy send, waiting for the receiver to release the payload. It is kept
+ * in shared memory, so the receiver can write its status. */
+typedef struct uct_mm_zcopy_op {
+    ucs_queue_elem_t     queue;       /* element in the ep queue of zcopy sends */
+    uct_completion_t     *comp;       /* user completion, may be NULL */
+    uct_mm_id_t          seg_mmid;    /* the shared segment which holds the operation */
+    void                 *seg_address;
+    size_t               seg_length;
+    volatile int32_t     status;      /* UCS_INPROGRESS until the receiver releases the payload */
+} uct_mm_zcopy_op_t;
+
 UCS_CLASS_DECLARE_NEW_FUNC(uct_mm_ep_t, uct_ep_t, uct_iface_t*,
                            const uct_device_addr_t *, const uct_iface_addr_t *);
 UCS_CLASS_DECLARE_DELETE_FUNC(uct_mm_ep_t, uct_ep_t);
@@ -41,10 +61,17 @@ ucs_status_t uct_mm_ep_put_short(uct_ep_h tl_ep, const void *buffer,
                                  uct_rkey_t rkey);
 ssize_t uct_mm_ep_put_bcopy(uct_ep_h ep, uct_pack_callback_t pack_cb,
                             void *arg, uint64_t remote_addr, uct_rkey_t rkey);
+ucs_status_t uct_mm_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer, size_t length,
+                                 uct_mem_h memh, uint64_t remote_addr,
+                                 uct_rkey_t rkey, uct_completion_t *comp);
 ucs_status_t uct_mm_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
                                 const void *payload, unsigned length);
 ssize_t uct_mm_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id, uct_pack_callback_t pack_cb,
                            void *arg);
+ucs_status_t uct_mm_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                unsigned header_length, const void *payload,
+                                size_t length, uct_mem_h memh,
+                                uct_completion_t *comp);
 ucs_status_t uct_mm_ep_atomic_add64(uct_ep_h tl_ep, uint64_t add,
                                     uint64_t remote_addr, uct_rkey_t rkey);
 ucs_status_t uct_mm_ep_atomic_fadd64(uct_ep_h tl_ep, uint64_t add,
@@ -74,16 +101,37 @@ ucs_status_t uct_mm_ep_get_bcopy(uct_ep_h ep, uct_unpack_callback_t unpack_cb,
                                  uint64_t remote_addr, uct_rkey_t rkey,
                                  uct_completion_t *comp);
 
+ucs_status_t uct_mm_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                 uct_mem_h memh, uint64_t remote_addr,
+                                 uct_rkey_t rkey, uct_completion_t *comp);
+
 ucs_status_t uct_mm_ep_flush(uct_ep_h tl_ep);
 
+unsigned uct_mm_iface_progress_zcopy(uct_mm_iface_t *iface);
+
 ucs_status_t uct_mm_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *n);
 
+ucs_status_t uct_mm_ep_pending_add_prio(uct_ep_h tl_ep, uct_pending_req_t *n,
+                                        uct_pending_prio_t prio);
+
 void uct_mm_ep_pending_purge(uct_ep_h ep, uct_pending_callback_t cb);
 
 ucs_arbiter_cb_result_t uct_mm_ep_process_pending(ucs_arbiter_t *arbiter,
                                                   ucs_arbiter_elem_t *elem,
                                                   void *arg);
 
+static inline int uct_mm_ep_has_pending(uct_mm_ep_t *ep)
+{
+    uct_pending_prio_t prio;
+
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        if (!ucs_arbiter_group_is_empty(&ep->arb_group[prio])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
 static inline uint64_t uct_mm_remote_seg_hash(uct_mm_remote_seg_t *seg)
 {
     return seg->mmid % UCT_MM_BASE_ADDRESS_HASH_SIZE;
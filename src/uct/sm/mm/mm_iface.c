@@ -28,6 +28,18 @@ static ucs_config_field_t uct_mm_iface_config_table[] = {
      "This value refers to the percentage of the FIFO size. (must be >= 0 and < 1)",
      ucs_offsetof(uct_mm_iface_config_t, release_fifo_factor), UCS_CONFIG_TYPE_DOUBLE},
 
+    {"FIFO_POLL_BATCH", "16",
+     "Maximal number of FIFO elements to receive in a single progress call.",
+     ucs_offsetof(uct_mm_iface_config_t, poll_batch), UCS_CONFIG_TYPE_UINT},
+
+    {"FIFO_LANES", "0",
+     "Number of single-producer receive lanes, each the size of the receive FIFO.\n"
+     "A sender which acquires a lane writes to it without atomic operations, which\n"
+     "reduces contention when many processes send to the same receiver. Senders\n"
+     "beyond the number of lanes use the shared FIFO. Every lane element holds a\n"
+     "receive descriptor. Maximal value: 64.",
+     ucs_offsetof(uct_mm_iface_config_t, fifo_lanes), UCS_CONFIG_TYPE_UINT},
+
     UCT_IFACE_MPOOL_CONFIG_FIELDS("RX_", 16384, 256, "receive",
                                   ucs_offsetof(uct_mm_iface_config_t, mp), ""),
 
@@ -39,6 +51,26 @@ static ucs_config_field_t uct_mm_iface_config_table[] = {
      " try - Try to allocate memory using huge pages and if it fails, allocate regular pages.\n",
      ucs_offsetof(uct_mm_iface_config_t, hugetlb_mode), UCS_CONFIG_TYPE_TERNARY},
 
+    {"NUMA_BIND", "y",
+     "Place the receive FIFO and receive descriptors on the NUMA node of the CPU\n"
+     "which creates the interface.",
+     ucs_offsetof(uct_mm_iface_config_t, numa_bind), UCS_CONFIG_TYPE_BOOL},
+
+    {"COPY_THREADS", "0",
+     "Number of helper threads which copy large put_zcopy/get_zcopy operations\n"
+     "in parallel with the calling thread. The threads run on the NUMA node of\n"
+     "the CPU which creates the interface. 0 disables parallel copy.",
+     ucs_offsetof(uct_mm_iface_config_t, copy_threads), UCS_CONFIG_TYPE_UINT},
+
+    {"COPY_MIN_PART", "256k",
+     "Minimal amount of data copied by each thread in a parallel copy.",
+     ucs_offsetof(uct_mm_iface_config_t, copy_min_part), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"MAX_AM_ZCOPY", "64m",
+     "Maximal size of a zero-copy active message. The receiver gets the payload\n"
+     "in the sender's buffer, so it is not limited by the receive descriptor size.",
+     ucs_offsetof(uct_mm_iface_config_t, max_am_zcopy), UCS_CONFIG_TYPE_MEMUNITS},
+
     {NULL}
 };
 
@@ -53,21 +85,175 @@ static ucs_status_t uct_mm_iface_get_address(uct_iface_t *tl_iface,
     return UCS_OK;
 }
 
+/* Let the sender complete the zcopy send whose payload is held by the desc */
+static UCS_F_ALWAYS_INLINE void
+uct_mm_iface_zcopy_release(uct_mm_recv_desc_t *mm_desc, ucs_status_t status)
+{
+    /* the payload must be read before the sender may reuse it */
+    ucs_memory_cpu_fence();
+    *mm_desc->zcopy_status = status;
+    mm_desc->zcopy_status  = NULL;
+}
+
 void uct_mm_iface_release_am_desc(uct_iface_t *tl_iface, void *desc)
 {
-    void *mm_desc;
+    uct_mm_recv_desc_t *mm_desc;
 
     mm_desc = desc - sizeof(uct_mm_recv_desc_t);
+    if (mm_desc->zcopy_status != NULL) {
+        uct_mm_iface_zcopy_release(mm_desc, UCS_OK);
+    }
     ucs_mpool_put(mm_desc);
 }
 
 ucs_status_t uct_mm_iface_flush(uct_iface_h tl_iface)
 {
+    uct_mm_iface_t *iface = ucs_derived_of(tl_iface, uct_mm_iface_t);
+
+    if (!ucs_list_is_empty(&iface->zcopy_eps)) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return UCS_INPROGRESS;
+    }
+
     ucs_memory_cpu_store_fence();
-    UCT_TL_IFACE_STAT_FLUSH(ucs_derived_of(tl_iface, uct_base_iface_t));
+    UCT_TL_IFACE_STAT_FLUSH(&iface->super);
+    return UCS_OK;
+}
+
+static ucs_status_t uct_mm_iface_wakeup_open(uct_iface_h tl_iface,
+                                             unsigned events,
+                                             uct_wakeup_h wakeup)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(tl_iface, uct_mm_iface_t);
+    uct_mm_fifo_ctl_t *fifo_ctl = iface->recv_fifo_ctl;
+    sa_family_t bind_addr;
+    ucs_status_t status;
+    socklen_t addrlen;
+    int ret;
+
+    if (iface->wakeup_fd != -1) {
+        ucs_error("mm_iface %p already has a wakeup handle", iface);
+        return UCS_ERR_ALREADY_EXISTS;
+    }
+
+    /* Senders write to this socket when they find the wakeup armed */
+    iface->wakeup_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (iface->wakeup_fd < 0) {
+        ucs_error("Failed to create unix domain socket for wakeup: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err;
+    }
+
+    status = ucs_sys_fcntl_modfl(iface->wakeup_fd, O_NONBLOCK, 0);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    bind_addr = AF_UNIX;
+    ret = bind(iface->wakeup_fd, (struct sockaddr*)&bind_addr, sizeof(sa_family_t));
+    if (ret < 0) {
+        ucs_error("Failed to auto-bind unix domain socket: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_close;
+    }
+
+    addrlen = sizeof(struct sockaddr_un);
+    memset(&fifo_ctl->wakeup_sockaddr, 0, addrlen);
+    ret = getsockname(iface->wakeup_fd,
+                      (struct sockaddr *)&fifo_ctl->wakeup_sockaddr, &addrlen);
+    if (ret < 0) {
+        ucs_error("Failed to retrieve unix domain socket address: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_close;
+    }
+
+    fifo_ctl->wakeup_addrlen = addrlen;
+    wakeup->fd               = iface->wakeup_fd;
+    return UCS_OK;
+
+err_close:
+    close(iface->wakeup_fd);
+    iface->wakeup_fd = -1;
+err:
+    return status;
+}
+
+static ucs_status_t uct_mm_iface_wakeup_get_fd(uct_wakeup_h wakeup, int *fd_p)
+{
+    *fd_p = wakeup->fd;
+    return UCS_OK;
+}
+
+/*
+ * Request a signal for the next message a sender posts. Like a completion
+ * queue notification, messages which were posted before are not signaled.
+ */
+static ucs_status_t uct_mm_iface_wakeup_arm(uct_wakeup_h wakeup)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(wakeup->iface, uct_mm_iface_t);
+    uint8_t sig;
+    int ret;
+
+    /* consume the signals of previous arms */
+    do {
+        ret = recv(wakeup->fd, &sig, sizeof(sig), 0);
+    } while (ret > 0);
+
+    if (errno != EAGAIN) {
+        ucs_error("failed to read from wakeup socket: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    iface->recv_fifo_ctl->wakeup_armed = 1;
+    ucs_memory_bus_fence();
+    return UCS_OK;
+}
+
+static ucs_status_t uct_mm_iface_wakeup_wait(uct_wakeup_h wakeup)
+{
+    struct pollfd polled = { .fd = wakeup->fd, .events = POLLIN };
+    int res;
+
+    do {
+        res = poll(&polled, 1, -1);
+    } while ((res == -1) && (errno == EINTR));
+
+    if ((res != 1) || (polled.revents != POLLIN)) {
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return uct_mm_iface_wakeup_arm(wakeup);
+}
+
+static ucs_status_t uct_mm_iface_wakeup_signal(uct_wakeup_h wakeup)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(wakeup->iface, uct_mm_iface_t);
+    uct_mm_fifo_ctl_t *fifo_ctl = iface->recv_fifo_ctl;
+    uint8_t sig = 0;
+    int ret;
+
+    ret = sendto(iface->signal_fd, &sig, sizeof(sig), 0,
+                 (const struct sockaddr*)&fifo_ctl->wakeup_sockaddr,
+                 fifo_ctl->wakeup_addrlen);
+    if ((ret < 0) && (errno != EAGAIN)) {
+        ucs_error("failed to send wakeup signal: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
     return UCS_OK;
 }
 
+static void uct_mm_iface_wakeup_close(uct_wakeup_h wakeup)
+{
+    uct_mm_iface_t *iface = ucs_derived_of(wakeup->iface, uct_mm_iface_t);
+
+    /* stop the senders from signaling the closed socket */
+    iface->recv_fifo_ctl->wakeup_armed   = 0;
+    iface->recv_fifo_ctl->wakeup_addrlen = 0;
+    close(iface->wakeup_fd);
+    iface->wakeup_fd = -1;
+}
+
 static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
                                        uct_iface_attr_t *iface_attr)
 {
@@ -83,12 +269,15 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
     iface_attr->cap.am.max_short       = iface->config.fifo_elem_size -
                                          sizeof(uct_mm_fifo_element_t);
     iface_attr->cap.am.max_bcopy       = iface->config.seg_size;
-    iface_attr->cap.am.max_zcopy       = 0;
+    iface_attr->cap.am.max_zcopy       = iface->config.max_am_zcopy;
+    iface_attr->cap.am.max_hdr         = 0; /* the payload is not copied, so
+                                               there is no room for a header */
     iface_attr->iface_addr_len         = sizeof(uct_mm_iface_addr_t);
     iface_attr->device_addr_len        = UCT_SM_IFACE_DEVICE_ADDR_LEN;
     iface_attr->ep_addr_len            = 0;
     iface_attr->cap.flags              = UCT_IFACE_FLAG_PUT_SHORT        |
                                          UCT_IFACE_FLAG_PUT_BCOPY        |
+                                         UCT_IFACE_FLAG_PUT_ZCOPY        |
                                          UCT_IFACE_FLAG_ATOMIC_ADD32     |
                                          UCT_IFACE_FLAG_ATOMIC_ADD64     |
                                          UCT_IFACE_FLAG_ATOMIC_FADD64    |
@@ -98,11 +287,21 @@ static ucs_status_t uct_mm_iface_query(uct_iface_h tl_iface,
                                          UCT_IFACE_FLAG_ATOMIC_CSWAP64   |
                                          UCT_IFACE_FLAG_ATOMIC_CSWAP32   |
                                          UCT_IFACE_FLAG_GET_BCOPY        |
+                                         UCT_IFACE_FLAG_GET_ZCOPY        |
                                          UCT_IFACE_FLAG_AM_SHORT         |
                                          UCT_IFACE_FLAG_AM_BCOPY         |
                                          UCT_IFACE_FLAG_PENDING          |
+                                         UCT_IFACE_FLAG_PENDING_PRIO     |
                                          UCT_IFACE_FLAG_AM_CB_SYNC       |
+                                         UCT_IFACE_FLAG_WAKEUP           |
                                          UCT_IFACE_FLAG_CONNECT_TO_IFACE;
+    if (iface->config.fifo_elem_size >= sizeof(uct_mm_fifo_element_t) +
+                                        sizeof(uct_mm_zcopy_hdr_t)) {
+        /* the zcopy descriptor must fit in the FIFO element */
+        iface_attr->cap.flags         |= UCT_IFACE_FLAG_AM_ZCOPY;
+    } else {
+        iface_attr->cap.am.max_zcopy   = 0;
+    }
 
     iface_attr->latency                = 80e-9; /* 80 ns */
     iface_attr->bandwidth              = 6911 * 1024.0 * 1024.0;
@@ -120,11 +319,20 @@ static uct_iface_ops_t uct_mm_iface_ops = {
     .iface_is_reachable  = uct_sm_iface_is_reachable,
     .iface_release_am_desc = uct_mm_iface_release_am_desc,
     .iface_flush         = uct_mm_iface_flush,
+    .iface_wakeup_open   = uct_mm_iface_wakeup_open,
+    .iface_wakeup_get_fd = uct_mm_iface_wakeup_get_fd,
+    .iface_wakeup_arm    = uct_mm_iface_wakeup_arm,
+    .iface_wakeup_wait   = uct_mm_iface_wakeup_wait,
+    .iface_wakeup_signal = uct_mm_iface_wakeup_signal,
+    .iface_wakeup_close  = uct_mm_iface_wakeup_close,
     .ep_put_short        = uct_mm_ep_put_short,
     .ep_put_bcopy        = uct_mm_ep_put_bcopy,
+    .ep_put_zcopy        = uct_mm_ep_put_zcopy,
     .ep_get_bcopy        = uct_mm_ep_get_bcopy,
+    .ep_get_zcopy        = uct_mm_ep_get_zcopy,
     .ep_am_short         = uct_mm_ep_am_short,
     .ep_am_bcopy         = uct_mm_ep_am_bcopy,
+    .ep_am_zcopy         = uct_mm_ep_am_zcopy,
     .ep_atomic_add64     = uct_mm_ep_atomic_add64,
     .ep_atomic_fadd64    = uct_mm_ep_atomic_fadd64,
     .ep_atomic_cswap64   = uct_mm_ep_atomic_cswap64,
@@ -134,20 +342,25 @@ static uct_iface_ops_t uct_mm_iface_ops = {
     .ep_atomic_cswap32   = uct_mm_ep_atomic_cswap32,
     .ep_atomic_swap32    = uct_mm_ep_atomic_swap32,
     .ep_pending_add      = uct_mm_ep_pending_add,
+    .ep_pending_add_prio = uct_mm_ep_pending_add_prio,
     .ep_pending_purge    = uct_mm_ep_pending_purge,
     .ep_flush            = uct_mm_ep_flush,
     .ep_create_connected = UCS_CLASS_NEW_FUNC_NAME(uct_mm_ep_t),
     .ep_destroy          = UCS_CLASS_DELETE_FUNC_NAME(uct_mm_ep_t),
 };
 
-static inline void uct_mm_progress_fifo_tail(uct_mm_iface_t *iface)
+static inline void uct_mm_progress_fifo_tail(uct_mm_iface_t *iface,
+                                             uct_mm_fifo_ctl_t *fifo_ctl,
+                                             uint64_t read_index)
 {
-    /* don't progress the tail every time - release in batches. improves performance */
-    if (iface->read_index & iface->fifo_release_factor_mask) {
+    /* don't progress the tail every time - release in batches. improves performance.
+     * the tail is moved once read_index enters a new release block, since a
+     * poll batch may step over the first element of a block. */
+    if (!((read_index ^ fifo_ctl->tail) & ~iface->fifo_release_factor_mask)) {
         return;
     }
 
-    iface->recv_fifo_ctl->tail = iface->read_index;
+    fifo_ctl->tail = read_index;
 }
 
 ucs_status_t uct_mm_assign_desc_to_fifo_elem(uct_mm_iface_t *iface,
@@ -172,6 +385,129 @@ ucs_status_t uct_mm_assign_desc_to_fifo_elem(uct_mm_iface_t *iface,
     return UCS_OK;
 }
 
+/*
+ * Get a local address of a sender's segment which holds a zcopy payload or
+ * operation. The attached segments are cached by their mmid, and an mmid which
+ * was reused for a segment of another size is attached again.
+ */
+static ucs_status_t uct_mm_iface_zcopy_seg(uct_mm_iface_t *iface,
+                                           uct_mm_id_t mmid,
+                                           uintptr_t seg_address,
+                                           size_t seg_length, void **address_p)
+{
+    uct_mm_remote_seg_t *remote_seg, search;
+    ucs_status_t status;
+
+    search.mmid = mmid;
+    remote_seg  = sglib_hashed_uct_mm_remote_seg_t_find_member(iface->zcopy_segs_hash,
+                                                               &search);
+    if ((remote_seg != NULL) && (remote_seg->length != seg_length)) {
+        sglib_hashed_uct_mm_remote_seg_t_delete(iface->zcopy_segs_hash,
+                                                remote_seg);
+        uct_mm_pd_mapper_ops(iface->super.pd)->detach(remote_seg);
+        ucs_free(remote_seg);
+        remote_seg = NULL;
+    }
+
+    if (remote_seg == NULL) {
+        remote_seg = ucs_malloc(sizeof(*remote_seg), "mm_zcopy_seg");
+        if (remote_seg == NULL) {
+            ucs_error("Failed to allocate memory for a remote segment identifier");
+            return UCS_ERR_NO_MEMORY;
+        }
+
+        status = uct_mm_pd_mapper_ops(iface->super.pd)->attach(mmid, seg_length,
+                                                               (void*)seg_address,
+                                                               &remote_seg->address,
+                                                               &remote_seg->cookie,
+                                                               iface->path);
+        if (status != UCS_OK) {
+            ucs_error("Failed to attach to remote mmid:%zu. %s ", mmid,
+                      ucs_status_string(status));
+            ucs_free(remote_seg);
+            return status;
+        }
+
+        remote_seg->mmid   = mmid;
+        remote_seg->length = seg_length;
+        sglib_hashed_uct_mm_remote_seg_t_add(iface->zcopy_segs_hash, remote_seg);
+    }
+
+    *address_p = remote_seg->address;
+    return UCS_OK;
+}
+
+static void uct_mm_iface_detach_zcopy_segs(uct_mm_iface_t *iface)
+{
+    struct sglib_hashed_uct_mm_remote_seg_t_iterator iter;
+    uct_mm_remote_seg_t *remote_seg;
+    ucs_status_t status;
+
+    for (remote_seg = sglib_hashed_uct_mm_remote_seg_t_it_init(&iter, iface->zcopy_segs_hash);
+         remote_seg != NULL; remote_seg = sglib_hashed_uct_mm_remote_seg_t_it_next(&iter)) {
+        sglib_hashed_uct_mm_remote_seg_t_delete(iface->zcopy_segs_hash, remote_seg);
+        status = uct_mm_pd_mapper_ops(iface->super.pd)->detach(remote_seg);
+        if (status != UCS_OK) {
+            ucs_warn("Unable to detach shared memory segment of zcopy sends: %s",
+                     ucs_status_string(status));
+        }
+        ucs_free(remote_seg);
+    }
+}
+
+/*
+ * Pass a zcopy payload to the user in the sender's segment. The descriptor of
+ * the FIFO element stands for the payload, and the sender completes the send
+ * when the descriptor is released. A message whose segments can not be
+ * attached is dropped, and its send is failed if possible.
+ */
+static UCS_F_NOINLINE ucs_status_t
+uct_mm_iface_process_zcopy(uct_mm_iface_t *iface, uct_mm_fifo_element_t *elem)
+{
+    uct_mm_zcopy_hdr_t *zhdr = (void*)(elem + 1);
+    uct_mm_recv_desc_t *desc = UCT_MM_IFACE_GET_DESC_START(iface, elem);
+    ucs_status_t status;
+    void *address;
+    void *data;
+
+    status = uct_mm_iface_zcopy_seg(iface, zhdr->op_mmid, zhdr->op_seg_address,
+                                    zhdr->op_seg_length, &address);
+    if (status != UCS_OK) {
+        ucs_error("Dropping zcopy active message %d: the sender's send status "
+                  "is not accessible", elem->am_id);
+        return UCS_OK;
+    }
+
+    desc->zcopy_status = address + (zhdr->op_status - zhdr->op_seg_address);
+
+    if (zhdr->length > 0) {
+        status = uct_mm_iface_zcopy_seg(iface, zhdr->mmid, zhdr->seg_address,
+                                        zhdr->seg_length, &address);
+        if (status != UCS_OK) {
+            ucs_error("Dropping zcopy active message %d: the payload is not "
+                      "accessible", elem->am_id);
+            uct_mm_iface_zcopy_release(desc, status);
+            return UCS_OK;
+        }
+        data = address + (zhdr->payload - zhdr->seg_address);
+    } else {
+        data = elem->desc_chunk_base_addr + elem->desc_offset;
+    }
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, elem->am_id,
+                       data, zhdr->length, "RX: AM_ZCOPY");
+
+    status = uct_mm_iface_invoke_am(iface, elem->am_id, data, zhdr->length,
+                                    desc);
+    if (status == UCS_OK) {
+        uct_mm_iface_zcopy_release(desc, UCS_OK);
+    } else {
+        /* the desc holds the payload until the user releases it */
+        uct_mm_assign_desc_to_fifo_elem(iface, elem, 0);
+    }
+    return status;
+}
+
 static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
                                                      uct_mm_fifo_element_t* elem)
 {
@@ -185,6 +521,8 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
                            elem + 1, elem->length, "RX: AM_SHORT");
         status = uct_mm_iface_invoke_am(iface, elem->am_id, elem + 1, elem->length,
                                         iface->last_recv_desc);
+    } else if (elem->flags & UCT_MM_FIFO_ELEM_FLAG_ZCOPY) {
+        status = uct_mm_iface_process_zcopy(iface, elem);
     } else {
         /* read bcopy messages from the receive descriptors */
         VALGRIND_MAKE_MEM_DEFINED(elem->desc_chunk_base_addr + elem->desc_offset,
@@ -206,67 +544,193 @@ static inline ucs_status_t uct_mm_iface_process_recv(uct_mm_iface_t *iface,
     return status;
 }
 
-static inline void uct_mm_iface_poll_fifo(uct_mm_iface_t *iface)
+static UCS_F_ALWAYS_INLINE uct_mm_fifo_element_t*
+uct_mm_iface_fifo_elem(uct_mm_iface_t *iface, void *fifo_elems, uint64_t index)
+{
+    return UCT_MM_IFACE_GET_FIFO_ELEM(iface, fifo_elems,
+                                      index & iface->fifo_mask);
+}
+
+static UCS_F_ALWAYS_INLINE int
+uct_mm_iface_fifo_elem_ready(uct_mm_iface_t *iface, uint64_t index,
+                             uct_mm_fifo_element_t *elem)
 {
-    uint64_t read_index_loc, read_index;
-    uct_mm_fifo_element_t* read_index_elem;
+    /* the element is ready if its owner bit matches the read_index lap */
+    return ((index >> iface->fifo_shift) & 1) == (elem->flags & 1);
+}
+
+/*
+ * Receive up to a batch of messages from a receive ring - either the shared
+ * FIFO or a single-producer lane.
+ */
+static UCS_F_ALWAYS_INLINE unsigned
+uct_mm_iface_poll_fifo(uct_mm_iface_t *iface, uct_mm_fifo_ctl_t *fifo_ctl,
+                       void *fifo_elems, uint64_t *read_index_p)
+{
+    uint64_t read_index = *read_index_p;
+    uct_mm_fifo_element_t *read_index_elem, *next_elem;
     ucs_status_t status;
+    unsigned count;
 
     /* check the memory pool to make sure that there is a new descriptor available */
     if (ucs_unlikely(iface->last_recv_desc == NULL)) {
         UCT_TL_IFACE_GET_RX_DESC(&iface->super, &iface->recv_desc_mp,
-                                 iface->last_recv_desc, return);
+                                 iface->last_recv_desc, return 0);
     }
 
-    read_index = iface->read_index;
-    read_index_loc = (read_index & iface->fifo_mask);
     /* the fifo_element which the read_index points to */
-    read_index_elem = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elements ,read_index_loc);
-
-    /* check the read_index to see if there is a new item to read (checking the owner bit) */
-    if (((read_index >> iface->fifo_shift) & 1) == ((read_index_elem->flags) & 1)) {
+    read_index_elem = uct_mm_iface_fifo_elem(iface, fifo_elems, read_index);
 
+    count = 0;
+    while ((count < iface->config.poll_batch) &&
+           uct_mm_iface_fifo_elem_ready(iface, read_index, read_index_elem))
+    {
         /* read from read_index_elem */
         ucs_memory_cpu_load_fence();
-        ucs_assert(iface->read_index <= iface->recv_fifo_ctl->head);
+        ucs_assert(read_index <= fifo_ctl->head);
+
+        /* bring in the next element while handling this one */
+        next_elem = uct_mm_iface_fifo_elem(iface, fifo_elems, read_index + 1);
+        ucs_prefetch(next_elem);
 
         status = uct_mm_iface_process_recv(iface, read_index_elem);
+
+        /* raise the read_index. */
+        read_index++;
+        read_index_elem = next_elem;
+        ++count;
+
         if (status != UCS_OK) {
-            /* the last_recv_desc is in use. get a new descriptor for it */
+            /* the last_recv_desc is in use. get a new descriptor for it, and
+             * stop receiving if there is none */
             UCT_TL_IFACE_GET_RX_DESC(&iface->super, &iface->recv_desc_mp,
-                                     iface->last_recv_desc, ucs_debug("recv mpool is empty"));
+                                     iface->last_recv_desc,
+                                     ucs_debug("recv mpool is empty"); break);
         }
+    }
 
-        /* raise the read_index. */
-        iface->read_index++;
-    } else {
-       /* progress the tail when there is nothing to read
-        * to improve latency of receiving a message */
-       uct_mm_progress_fifo_tail(iface);
+    *read_index_p = read_index;
+
+    /* release the consumed elements to the senders once per batch. when
+     * there is nothing to read, this also improves the latency of senders
+     * waiting for FIFO space. */
+    uct_mm_progress_fifo_tail(iface, fifo_ctl, read_index);
+    return count;
+}
+
+/*
+ * Poll the lanes which are owned by senders, or were released with unread
+ * messages. The first lane to poll rotates on every call, so a busy lane
+ * would not starve the others.
+ */
+static unsigned uct_mm_iface_poll_lanes(uct_mm_iface_t *iface)
+{
+    uint64_t lanes_busy = iface->recv_fifo_ctl->lanes_busy;
+    uint64_t lanes      = iface->lanes_active | lanes_busy;
+    unsigned start      = iface->lanes_rr;
+    uct_mm_fifo_lane_t *lane;
+    unsigned count, index;
+    uint64_t pending;
+
+    if (lanes == 0) {
+        return 0;
+    }
+
+    /* visit the lanes starting from 'start', in a cyclic order */
+    pending = (start == 0) ? lanes : ((lanes >> start) | (lanes << (64 - start)));
+    count   = 0;
+    while (pending != 0) {
+        index    = (start + ucs_ffs64(pending)) % UCT_MM_FIFO_MAX_LANES;
+        pending &= pending - 1;
+        lane     = &iface->lanes[index];
+
+        count += uct_mm_iface_poll_fifo(iface, lane->ctl, lane->elems,
+                                        &lane->read_index);
+
+        /* stop polling a released lane once it was drained */
+        if (!(lanes_busy & UCS_BIT(index)) &&
+            (lane->read_index == lane->ctl->head)) {
+            lanes &= ~UCS_BIT(index);
+        }
     }
+
+    iface->lanes_active = lanes;
+    iface->lanes_rr     = (start + 1) % iface->config.fifo_lanes;
+    return count;
 }
 
-void uct_mm_iface_progress(void *arg)
+unsigned uct_mm_iface_progress(void *arg)
 {
     uct_mm_iface_t *iface = arg;
+    uct_pending_prio_t prio;
+    unsigned count;
 
     /* progress receive */
-    uct_mm_iface_poll_fifo(iface);
+    count = uct_mm_iface_poll_fifo(iface, iface->recv_fifo_ctl,
+                                   iface->recv_fifo_elements,
+                                   &iface->read_index);
+    if (iface->config.fifo_lanes > 0) {
+        count += uct_mm_iface_poll_lanes(iface);
+    }
 
-    /* progress the pending sends (if there are any) */
-    ucs_arbiter_dispatch(&iface->arbiter, 1, uct_mm_ep_process_pending, NULL);
+    /* complete the zcopy sends which were released by their receivers */
+    if (!ucs_list_is_empty(&iface->zcopy_eps) ||
+        !ucs_queue_is_empty(&iface->zcopy_orphans)) {
+        count += uct_mm_iface_progress_zcopy(iface);
+    }
+
+    /* progress the pending sends (if there are any), higher priority first */
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        count += ucs_arbiter_dispatch(&iface->arbiter[prio], 1,
+                                      uct_mm_ep_process_pending,
+                                      (void*)(uintptr_t)prio);
+    }
+    return count;
 }
 
 void uct_mm_iface_recv_desc_init(uct_iface_h tl_iface, void *obj, uct_mem_h memh)
 {
+    uct_mm_iface_t *iface = ucs_derived_of(tl_iface, uct_mm_iface_t);
     uct_mm_recv_desc_t *desc = obj;
     uct_mm_seg_t *seg = memh;
 
+    /* descriptors are initialized in order, so bind every segment once */
+    if ((iface->numa_node >= 0) && (seg->address != iface->numa_last_seg)) {
+        ucs_numa_bind_memory(seg->address, seg->length, iface->numa_node);
+        iface->numa_last_seg = seg->address;
+    }
+
     /* every desc in the memory pool, holds the mm_id(key) and address of the
      * mem pool it belongs to */
     desc->key          = seg->mmid;
     desc->base_address = seg->address;
     desc->mpool_length = seg->length;
+    desc->zcopy_status = NULL;
+}
+
+static void uct_mm_iface_zcopy_op_init(uct_iface_h tl_iface, void *obj,
+                                       uct_mem_h memh)
+{
+    uct_mm_zcopy_op_t *op = obj;
+    uct_mm_seg_t *seg = memh;
+
+    /* the receiver attaches the segment to write the status of the send */
+    op->seg_mmid    = seg->mmid;
+    op->seg_address = seg->address;
+    op->seg_length  = seg->length;
+}
+
+/* Get a receive element by its index over the shared FIFO and all lanes */
+static uct_mm_fifo_element_t *uct_mm_iface_rx_elem(uct_mm_iface_t *iface,
+                                                   unsigned index)
+{
+    unsigned ring = index / iface->config.fifo_size;
+    void *fifo_elems;
+
+    fifo_elems = (ring == 0) ? iface->recv_fifo_elements :
+                 iface->lanes[ring - 1].elems;
+    return UCT_MM_IFACE_GET_FIFO_ELEM(iface, fifo_elems,
+                                      index % iface->config.fifo_size);
 }
 
 static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, unsigned num_elems)
@@ -276,7 +740,7 @@ static void uct_mm_iface_free_rx_descs(uct_mm_iface_t *iface, unsigned num_elems
     unsigned i;
 
     for (i = 0; i < num_elems; i++) {
-        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(iface, iface->recv_fifo_elements, i);
+        fifo_elem_p = uct_mm_iface_rx_elem(iface, i);
         desc = UCT_MM_IFACE_GET_DESC_START(iface, fifo_elem_p);
         ucs_mpool_put(desc);
     }
@@ -301,6 +765,10 @@ ucs_status_t uct_mm_allocate_fifo_mem(uct_mm_iface_t *iface,
         return status;
     }
 
+    if (iface->numa_node >= 0) {
+        ucs_numa_bind_memory(iface->shared_mem, size_to_alloc, iface->numa_node);
+    }
+
     uct_mm_set_fifo_ptrs(iface->shared_mem, &ctl, &iface->recv_fifo_elements);
 
     /* Make sure head and tail are cahe-aligned, and not on same cacheline, to
@@ -316,6 +784,39 @@ ucs_status_t uct_mm_allocate_fifo_mem(uct_mm_iface_t *iface,
     return UCS_OK;
 }
 
+static ucs_status_t uct_mm_iface_init_lanes(uct_mm_iface_t *iface)
+{
+    uct_mm_fifo_lane_t *lane;
+    unsigned i;
+
+    iface->recv_fifo_ctl->lanes_busy = 0;
+    iface->recv_fifo_ctl->num_lanes  = iface->config.fifo_lanes;
+    iface->lanes_active              = 0;
+    iface->lanes_rr                  = 0;
+
+    if (iface->config.fifo_lanes == 0) {
+        iface->lanes = NULL;
+        return UCS_OK;
+    }
+
+    iface->lanes = ucs_calloc(iface->config.fifo_lanes, sizeof(*iface->lanes),
+                              "mm_fifo_lanes");
+    if (iface->lanes == NULL) {
+        ucs_error("Failed to allocate %u MM FIFO lanes", iface->config.fifo_lanes);
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    for (i = 0; i < iface->config.fifo_lanes; ++i) {
+        lane = &iface->lanes[i];
+        uct_mm_set_fifo_ptrs(uct_mm_fifo_lane_ctl(iface, iface->recv_fifo_ctl, i),
+                             &lane->ctl, &lane->elems);
+        lane->ctl->head  = 0;
+        lane->ctl->tail  = 0;
+        lane->read_index = 0;
+    }
+    return UCS_OK;
+}
+
 static ucs_status_t uct_mm_iface_create_signal_fd(uct_mm_iface_t *iface)
 {
     ucs_status_t status;
@@ -410,7 +911,9 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
                            const uct_iface_config_t *tl_config)
 {
     uct_mm_iface_config_t *mm_config = ucs_derived_of(tl_config, uct_mm_iface_config_t);
+    uct_iface_mpool_config_t zcopy_mp_config = {UINT_MAX, 128};
     uct_mm_fifo_element_t* fifo_elem_p;
+    uct_pending_prio_t prio;
     ucs_status_t status;
     unsigned i;
 
@@ -419,6 +922,10 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
 
     ucs_trace_func("Creating an MM iface=%p worker=%p", self, worker);
 
+    /* the receiver's tail must not share a cache line with the senders' head */
+    UCS_STATIC_ASSERT((ucs_offsetof(uct_mm_fifo_ctl_t, tail) %
+                       UCS_SYS_CACHE_LINE_SIZE) == 0);
+
     /* check that the fifo size, from the user, is a power of two and bigger than 1 */
     if ((mm_config->fifo_size <= 1) || ucs_is_pow2(mm_config->fifo_size) != 1) {
         ucs_error("The MM FIFO size must be a power of two and bigger than 1.");
@@ -433,6 +940,13 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
         goto err;
     }
 
+    if (mm_config->fifo_lanes > UCT_MM_FIFO_MAX_LANES) {
+        ucs_error("The number of MM FIFO lanes must be at most %d.",
+                  UCT_MM_FIFO_MAX_LANES);
+        status = UCS_ERR_INVALID_PARAM;
+        goto err;
+    }
+
     /* check the value defining the size of the FIFO element */
     if (mm_config->super.max_short <= sizeof(uct_mm_fifo_element_t)) {
         ucs_error("The UCT_MM_MAX_SHORT parameter must be larger than the FIFO "
@@ -448,9 +962,14 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
     self->fifo_release_factor_mask = UCS_MASK(ucs_ilog2(ucs_max((int)
                                      (mm_config->fifo_size * mm_config->release_fifo_factor),
                                      1)));
+    self->config.poll_batch        = ucs_max(mm_config->poll_batch, 1);
+    self->config.fifo_lanes        = mm_config->fifo_lanes;
+    self->config.max_am_zcopy      = mm_config->max_am_zcopy;
     self->fifo_mask                = mm_config->fifo_size - 1;
     self->fifo_shift               = ucs_count_zero_bits(mm_config->fifo_size);
     self->rx_headroom              = rx_headroom;
+    self->numa_node                = mm_config->numa_bind ? ucs_numa_current_node() : -1;
+    self->numa_last_seg            = NULL;
 
     /* create the receive FIFO */
     /* use specific allocator to allocate and attach memory and check the
@@ -460,15 +979,23 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
         goto err;
     }
 
-    self->recv_fifo_ctl->head   = 0;
-    self->recv_fifo_ctl->tail   = 0;
-    self->read_index            = 0;
+    self->recv_fifo_ctl->head           = 0;
+    self->recv_fifo_ctl->tail           = 0;
+    self->recv_fifo_ctl->wakeup_armed   = 0;
+    self->recv_fifo_ctl->wakeup_addrlen = 0;
+    self->read_index                    = 0;
+    self->wakeup_fd                     = -1;
 
-    status = uct_mm_iface_create_signal_fd(self);
+    status = uct_mm_iface_init_lanes(self);
     if (status != UCS_OK) {
         goto err_free_fifo;
     }
 
+    status = uct_mm_iface_create_signal_fd(self);
+    if (status != UCS_OK) {
+        goto err_free_lanes;
+    }
+
     /* create a memory pool for receive descriptors */
     status = uct_iface_mpool_init(&self->super,
                                   &self->recv_desc_mp,
@@ -494,10 +1021,10 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
         goto destroy_recv_mpool;
     }
 
-    /* initiate the owner bit in all the FIFO elements and assign a receive descriptor
-     * per every FIFO element */
-    for (i = 0; i < mm_config->fifo_size; i++) {
-        fifo_elem_p = UCT_MM_IFACE_GET_FIFO_ELEM(self, self->recv_fifo_elements, i);
+    /* initiate the owner bit in all the FIFO and lane elements and assign a
+     * receive descriptor per every element */
+    for (i = 0; i < (1 + self->config.fifo_lanes) * self->config.fifo_size; i++) {
+        fifo_elem_p = uct_mm_iface_rx_elem(self, i);
         fifo_elem_p->flags = UCT_MM_FIFO_ELEM_FLAG_OWNER;
 
         status = uct_mm_assign_desc_to_fifo_elem(self, fifo_elem_p, 1);
@@ -507,7 +1034,36 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
         }
     }
 
-    ucs_arbiter_init(&self->arbiter);
+    /* create a memory pool for the outstanding zcopy sends, in shared memory
+     * which their receivers attach */
+    status = uct_iface_mpool_init(&self->super, &self->zcopy_op_mp,
+                                  sizeof(uct_mm_zcopy_op_t), 0,
+                                  UCS_SYS_CACHE_LINE_SIZE, &zcopy_mp_config,
+                                  zcopy_mp_config.bufs_grow,
+                                  uct_mm_iface_zcopy_op_init, "mm_zcopy_ops");
+    if (status != UCS_OK) {
+        ucs_error("Failed to create a zcopy operations memory pool for the MM transport");
+        goto destroy_descs_all;
+    }
+
+    ucs_list_head_init(&self->zcopy_eps);
+    ucs_queue_head_init(&self->zcopy_orphans);
+    sglib_hashed_uct_mm_remote_seg_t_init(self->zcopy_segs_hash);
+
+    self->copy_engine = NULL;
+    if (mm_config->copy_threads > 0) {
+        status = ucs_copy_engine_create(mm_config->copy_threads,
+                                        mm_config->copy_min_part,
+                                        ucs_numa_current_node(), "mm",
+                                        &self->copy_engine);
+        if (status != UCS_OK) {
+            goto destroy_zcopy_mpool;
+        }
+    }
+
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        ucs_arbiter_init(&self->arbiter[prio]);
+    }
 
     ucs_async_set_event_handler((worker->async != NULL) ? worker->async->mode : UCS_ASYNC_MODE_THREAD,
                                 self->signal_fd, POLLIN, uct_mm_iface_singal_handler,
@@ -515,9 +1071,14 @@ static UCS_CLASS_INIT_FUNC(uct_mm_iface_t, uct_pd_h pd, uct_worker_h worker,
 
     uct_worker_progress_register(worker, uct_mm_iface_progress, self);
 
-    ucs_debug("Created an MM iface. FIFO mm id: %zu", self->fifo_mm_id);
+    ucs_debug("Created an MM iface. FIFO mm id: %zu, lanes: %u, numa node: %d",
+              self->fifo_mm_id, self->config.fifo_lanes, self->numa_node);
     return UCS_OK;
 
+destroy_zcopy_mpool:
+    ucs_mpool_cleanup(&self->zcopy_op_mp, 1);
+destroy_descs_all:
+    i = (1 + self->config.fifo_lanes) * self->config.fifo_size;
 destroy_descs:
     uct_mm_iface_free_rx_descs(self, i);
     ucs_mpool_put(self->last_recv_desc);
@@ -525,6 +1086,8 @@ destroy_recv_mpool:
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
 err_close_signal_fd:
     close(self->signal_fd);
+err_free_lanes:
+    ucs_free(self->lanes);
 err_free_fifo:
     uct_mm_pd_mapper_ops(pd)->free(self->shared_mem, self->fifo_mm_id,
                                    UCT_MM_GET_FIFO_SIZE(self), self->path);
@@ -534,6 +1097,8 @@ err:
 
 static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
 {
+    uct_mm_zcopy_op_t *op;
+    uct_pending_prio_t prio;
     ucs_status_t status;
     size_t size_to_free;
 
@@ -544,11 +1109,21 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
 
     /* return all the descriptors that are now 'assigned' to the FIFO,
      * to their mpool */
-    uct_mm_iface_free_rx_descs(self, self->config.fifo_size);
+    uct_mm_iface_free_rx_descs(self, (1 + self->config.fifo_lanes) *
+                                     self->config.fifo_size);
 
     ucs_mpool_put(self->last_recv_desc);
     ucs_mpool_cleanup(&self->recv_desc_mp, 1);
+    uct_mm_iface_detach_zcopy_segs(self);
+    ucs_queue_for_each_extract(op, &self->zcopy_orphans, queue, 1) {
+        ucs_mpool_put(op);
+    }
+    ucs_mpool_cleanup(&self->zcopy_op_mp, 1);
+    if (self->copy_engine != NULL) {
+        ucs_copy_engine_destroy(self->copy_engine);
+    }
     close(self->signal_fd);
+    ucs_free(self->lanes);
 
     size_to_free = UCT_MM_GET_FIFO_SIZE(self);
 
@@ -560,7 +1135,9 @@ static UCS_CLASS_CLEANUP_FUNC(uct_mm_iface_t)
         ucs_warn("Unable to release shared memory segment: %m");
     }
 
-    ucs_arbiter_cleanup(&self->arbiter);
+    for (prio = 0; prio < UCT_PENDING_PRIO_LAST; ++prio) {
+        ucs_arbiter_cleanup(&self->arbiter[prio]);
+    }
 }
 
 UCS_CLASS_DEFINE(uct_mm_iface_t, uct_base_iface_t);
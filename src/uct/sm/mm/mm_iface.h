@@ -15,7 +15,9 @@
 #include <ucs/arch/cpu.h>
 #include <ucs/debug/memtrack.h>
 #include <ucs/datastruct/arbiter.h>
+#include <ucs/datastruct/list.h>
 #include <ucs/sys/compiler.h>
+#include <ucs/sys/copy_engine.h>
 #include <ucs/sys/sys.h>
 #include <sys/shm.h>
 #include <sys/un.h>
@@ -24,10 +26,18 @@
 #define UCT_MM_TL_NAME "mm"
 #define UCT_MM_FIFO_CTL_SIZE_ALIGNED  ucs_align_up(sizeof(uct_mm_fifo_ctl_t),UCS_SYS_CACHE_LINE_SIZE)
 
+#define UCT_MM_FIFO_MAX_LANES  64
+
+/* Size of a receive ring: control area followed by FIFO elements. The shared
+ * FIFO is the first ring, and per-sender lanes (if any) follow it. */
+#define UCT_MM_GET_RING_SIZE(iface)  ucs_align_up(UCT_MM_FIFO_CTL_SIZE_ALIGNED + \
+                                                 ((iface)->config.fifo_size *   \
+                                                  (iface)->config.fifo_elem_size), \
+                                                 UCS_SYS_CACHE_LINE_SIZE)
+
 #define UCT_MM_GET_FIFO_SIZE(iface)  (UCS_SYS_CACHE_LINE_SIZE - 1 +  \
-                                      UCT_MM_FIFO_CTL_SIZE_ALIGNED + \
-                                     ((iface)->config.fifo_size *    \
-                                     (iface)->config.fifo_elem_size))
+                                     ((1 + (iface)->config.fifo_lanes) * \
+                                      UCT_MM_GET_RING_SIZE(iface)))
 
 
 typedef enum {
@@ -40,8 +50,15 @@ typedef struct uct_mm_iface_config {
     uct_iface_config_t       super;
     unsigned                 fifo_size;            /* Size of the receive FIFO */
     double                   release_fifo_factor;
+    unsigned                 poll_batch;           /* Max. FIFO elements per progress */
+    unsigned                 fifo_lanes;           /* Number of per-sender lanes */
     ucs_ternary_value_t      hugetlb_mode;         /* Enable using huge pages for */
                                                    /* shared memory buffers */
+    int                      numa_bind;            /* Place receive memory on the */
+                                                   /* local NUMA node */
+    unsigned                 copy_threads;         /* Helper threads for zcopy RMA */
+    size_t                   copy_min_part;        /* Min. bytes per helper thread */
+    size_t                   max_am_zcopy;         /* Max. zcopy active message */
     uct_iface_mpool_config_t mp;
 } uct_mm_iface_config_t;
 
@@ -72,15 +89,37 @@ struct uct_mm_iface {
     uct_mm_recv_desc_t      *last_recv_desc;    /* next receive descriptor to use */
 
     int                     signal_fd;        /* Unix socket for receiving remote signal */
+    int                     wakeup_fd;        /* Unix socket for wakeup signals, or -1 */
 
     size_t                  rx_headroom;
-    ucs_arbiter_t           arbiter;
+    ucs_arbiter_t           arbiter[UCT_PENDING_PRIO_LAST]; /* Pending sends, per priority */
     const char              *path;            /* path to the backing file (for 'posix') */
 
+    /* Zero-copy active messages */
+    ucs_mpool_t             zcopy_op_mp;      /* outstanding zcopy sends, in
+                                               * shared memory */
+    ucs_list_link_t         zcopy_eps;        /* endpoints with outstanding
+                                               * zcopy sends */
+    ucs_queue_head_t        zcopy_orphans;    /* zcopy sends of destroyed
+                                               * endpoints, still held by
+                                               * their receivers */
+    uct_mm_remote_seg_t     *zcopy_segs_hash[UCT_MM_BASE_ADDRESS_HASH_SIZE];
+                                              /* senders' segments attached to
+                                               * receive zcopy payload */
+    uct_mm_fifo_lane_t      *lanes;           /* per-sender receive lanes */
+    uint64_t                lanes_active;     /* lanes which may hold messages */
+    unsigned                lanes_rr;         /* lane to poll first, round-robin */
+    int                     numa_node;        /* NUMA node of receive memory, -1 - any */
+    void                    *numa_last_seg;   /* last receive segment placed on numa_node */
+    ucs_copy_engine_t       *copy_engine;     /* parallel copy of zcopy RMA, or NULL */
+
     struct {
         unsigned fifo_size;
         unsigned fifo_elem_size;
         unsigned seg_size;                    /* size of the receive descriptor (for payload)*/
+        unsigned poll_batch;                  /* max. FIFO elements to receive per progress */
+        unsigned fifo_lanes;                  /* number of single-producer lanes */
+        size_t   max_am_zcopy;                /* max. zcopy active message */
     } config;
 };
 
@@ -102,22 +141,61 @@ struct uct_mm_fifo_element {
 } UCS_S_PACKED;
 
 
+/* Placed in the FIFO element by zcopy sends. The receiver passes the payload
+ * to the user in the sender's segment, and writes the status of the send to
+ * the sender's operation when the payload is released. */
+struct uct_mm_zcopy_hdr {
+    uct_mm_id_t     mmid;           /* mmid of the sender's segment */
+    uintptr_t       seg_address;    /* segment address in the sender */
+    size_t          seg_length;     /* segment length */
+    uintptr_t       payload;        /* payload address in the sender */
+    size_t          length;         /* payload length */
+    uct_mm_id_t     op_mmid;        /* mmid of the segment of the operation */
+    uintptr_t       op_seg_address; /* its address in the sender */
+    size_t          op_seg_length;  /* its length */
+    uintptr_t       op_status;      /* address of the operation status in the
+                                       sender */
+} UCS_S_PACKED;
+
+
+/*
+ * Not packed, since the counters are accessed atomically. The fields are
+ * ordered so the compiler adds no padding, and the layout is the same as if it
+ * was packed.
+ */
 struct uct_mm_fifo_ctl {
     /* 1st cacheline */
     volatile uint64_t  head;       /* where to write next */
+    volatile uint32_t  wakeup_armed;     /* receiver waits for a wakeup signal */
     socklen_t          signal_addrlen;   /* address length of signaling socket */
     struct sockaddr_un signal_sockaddr;  /* address of signaling socket */
-    UCS_CACHELINE_PADDING(uint64_t, socklen_t, struct sockaddr_un);
+    UCS_CACHELINE_PADDING(uint64_t, uint32_t, socklen_t, struct sockaddr_un);
 
     /* 2nd cacheline */
     volatile uint64_t  tail;       /* how much was read */
-} UCS_S_PACKED;
+    volatile uint64_t  lanes_busy; /* bitmap of lanes owned by senders */
+    uint32_t           num_lanes;  /* number of lanes following the FIFO */
+    socklen_t          wakeup_addrlen;   /* address length of wakeup socket,
+                                            0 if there is none */
+    struct sockaddr_un wakeup_sockaddr;  /* address of wakeup socket */
+};
+
+
+/* Receiver state of a single-producer lane */
+struct uct_mm_fifo_lane {
+    uct_mm_fifo_ctl_t  *ctl;       /* lane head and tail */
+    void               *elems;     /* lane FIFO elements */
+    uint64_t           read_index; /* next element to read */
+};
 
 
 struct uct_mm_recv_desc {
     uct_mm_id_t         key;
     void                *base_address;
     size_t              mpool_length;
+    volatile int32_t    *zcopy_status; /* status of the zcopy send whose
+                                          payload is held by this desc, or
+                                          NULL */
     uct_am_recv_desc_t  am_recv;   /* has to be in the end */
 };
 
@@ -156,10 +234,24 @@ static inline void uct_mm_set_fifo_ptrs(void *mem_region, uct_mm_fifo_ctl_t **fi
    *fifo_elems = (void*) *fifo_ctl + UCT_MM_FIFO_CTL_SIZE_ALIGNED;
 }
 
+/**
+ * Get the control area of a per-sender lane.
+ *
+ * @param [in] iface     interface, defining the ring size.
+ * @param [in] fifo_ctl  control area of the shared FIFO.
+ * @param [in] lane      lane index.
+ */
+static inline uct_mm_fifo_ctl_t*
+uct_mm_fifo_lane_ctl(uct_mm_iface_t *iface, uct_mm_fifo_ctl_t *fifo_ctl,
+                     unsigned lane)
+{
+    return (void*)fifo_ctl + ((lane + 1) * UCT_MM_GET_RING_SIZE(iface));
+}
+
 void uct_mm_iface_release_am_desc(uct_iface_t *tl_iface, void *desc);
 ucs_status_t uct_mm_flush();
 
-void uct_mm_iface_progress(void *arg);
+unsigned uct_mm_iface_progress(void *arg);
 
 void uct_mm_iface_recv_messages(uct_mm_iface_t *iface);
 
@@ -0,0 +1,335 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "self_ep.h"
+
+#include <ucs/arch/atomic.h>
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/debug/log.h>
+
+
+static UCS_CLASS_INIT_FUNC(uct_self_ep_t, uct_iface_t *tl_iface,
+                           const uct_device_addr_t *dev_addr,
+                           const uct_iface_addr_t *iface_addr)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_iface, uct_self_iface_t);
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super);
+
+    /* the only reachable peer is the interface itself */
+    ucs_assert(*(const uint64_t*)iface_addr == iface->id);
+
+    ucs_arbiter_group_init(&self->arb_group);
+
+    /* Register for progress of the sent active messages */
+    uct_worker_progress_register(iface->super.worker, uct_self_iface_progress,
+                                 iface);
+    return UCS_OK;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_self_ep_t)
+{
+    uct_self_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                             uct_self_iface_t);
+
+    uct_worker_progress_unregister(iface->super.worker, uct_self_iface_progress,
+                                   iface);
+    ucs_arbiter_group_cleanup(&self->arb_group);
+}
+
+UCS_CLASS_DEFINE(uct_self_ep_t, uct_base_ep_t)
+UCS_CLASS_DEFINE_NEW_FUNC(uct_self_ep_t, uct_ep_t, uct_iface_t*,
+                          const uct_device_addr_t *, const uct_iface_addr_t *);
+UCS_CLASS_DEFINE_DELETE_FUNC(uct_self_ep_t, uct_ep_t);
+
+
+#define uct_self_trace_data(_remote_addr, _rkey, _fmt, ...) \
+     ucs_trace_data(_fmt " to 0x%"PRIx64"(%+ld)", ## __VA_ARGS__, (_remote_addr), \
+                    (_rkey))
+
+ucs_status_t uct_self_ep_put_short(uct_ep_h tl_ep, const void *buffer,
+                                   unsigned length, uint64_t remote_addr,
+                                   uct_rkey_t rkey)
+{
+    memcpy((void *)(rkey + remote_addr), buffer, length);
+    uct_self_trace_data(remote_addr, rkey, "PUT_SHORT [buffer %p size %u]",
+                        buffer, length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), PUT, SHORT, length);
+    return UCS_OK;
+}
+
+ssize_t uct_self_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
+                              void *arg, uint64_t remote_addr, uct_rkey_t rkey)
+{
+    size_t length;
+
+    length = pack_cb((void *)(rkey + remote_addr), arg);
+    uct_self_trace_data(remote_addr, rkey, "PUT_BCOPY [arg %p size %zu]", arg,
+                        length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), PUT, BCOPY, length);
+    return length;
+}
+
+ucs_status_t uct_self_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer,
+                                   size_t length, uct_mem_h memh,
+                                   uint64_t remote_addr, uct_rkey_t rkey,
+                                   uct_completion_t *comp)
+{
+    memcpy((void *)(rkey + remote_addr), buffer, length);
+    uct_self_trace_data(remote_addr, rkey, "PUT_ZCOPY [buffer %p size %zu]",
+                        buffer, length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), PUT, ZCOPY, length);
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_get_bcopy(uct_ep_h tl_ep, uct_unpack_callback_t unpack_cb,
+                                   void *arg, size_t length,
+                                   uint64_t remote_addr, uct_rkey_t rkey,
+                                   uct_completion_t *comp)
+{
+    unpack_cb(arg, (void *)(rkey + remote_addr), length);
+    uct_self_trace_data(remote_addr, rkey, "GET_BCOPY [length %zu]", length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), GET, BCOPY, length);
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                   uct_mem_h memh, uint64_t remote_addr,
+                                   uct_rkey_t rkey, uct_completion_t *comp)
+{
+    memcpy(buffer, (void *)(rkey + remote_addr), length);
+    uct_self_trace_data(remote_addr, rkey, "GET_ZCOPY [buffer %p size %zu]",
+                        buffer, length);
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), GET, ZCOPY, length);
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
+                                  const void *payload, unsigned length)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_self_iface_t);
+    uct_self_recv_desc_t *desc;
+    void *data;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_CHECK_LENGTH(length + sizeof(header), iface->config.seg_size,
+                     "am_short");
+    UCT_TL_IFACE_GET_TX_DESC(&iface->super, &iface->msg_desc_mp, desc,
+                             return UCS_ERR_NO_RESOURCE);
+
+    /* the handler may keep the descriptor, so the message is copied to it */
+    data = uct_self_recv_desc_data(iface, desc);
+    *(uint64_t*)data = header;
+    memcpy(data + sizeof(header), payload, length);
+    desc->am_id  = id;
+    desc->length = length + sizeof(header);
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, data,
+                       desc->length, "TX: AM_SHORT");
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), AM, SHORT,
+                      desc->length);
+
+    ucs_queue_push(&iface->msg_queue, &desc->queue);
+    return UCS_OK;
+}
+
+ssize_t uct_self_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id,
+                             uct_pack_callback_t pack_cb, void *arg)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_self_iface_t);
+    uct_self_recv_desc_t *desc;
+    size_t length;
+    void *data;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_TL_IFACE_GET_TX_DESC(&iface->super, &iface->msg_desc_mp, desc,
+                             return UCS_ERR_NO_RESOURCE);
+
+    data         = uct_self_recv_desc_data(iface, desc);
+    length       = pack_cb(data, arg);
+    desc->am_id  = id;
+    desc->length = length;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, data, length,
+                       "TX: AM_BCOPY");
+    UCT_TL_EP_STAT_OP(ucs_derived_of(tl_ep, uct_base_ep_t), AM, BCOPY, length);
+
+    ucs_queue_push(&iface->msg_queue, &desc->queue);
+    return length;
+}
+
+ucs_status_t uct_self_ep_atomic_add64(uct_ep_h tl_ep, uint64_t add,
+                                      uint64_t remote_addr, uct_rkey_t rkey)
+{
+    uint64_t *ptr = (uint64_t *)(rkey + remote_addr);
+    ucs_atomic_add64(ptr, add);
+    uct_self_trace_data(remote_addr, rkey, "ATOMIC_ADD64 [add %"PRIu64"]", add);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_fadd64(uct_ep_h tl_ep, uint64_t add,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint64_t *result, uct_completion_t *comp)
+{
+    uint64_t *ptr = (uint64_t *)(rkey + remote_addr);
+    *result = ucs_atomic_fadd64(ptr, add);
+    uct_self_trace_data(remote_addr, rkey,
+                        "ATOMIC_FADD64 [add %"PRIu64" result %"PRIu64"]",
+                        add, *result);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_swap64(uct_ep_h tl_ep, uint64_t swap,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint64_t *result, uct_completion_t *comp)
+{
+    uint64_t *ptr = (uint64_t *)(rkey + remote_addr);
+    *result = ucs_atomic_swap64(ptr, swap);
+    uct_self_trace_data(remote_addr, rkey,
+                        "ATOMIC_SWAP64 [swap %"PRIu64" result %"PRIu64"]",
+                        swap, *result);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_cswap64(uct_ep_h tl_ep, uint64_t compare,
+                                        uint64_t swap, uint64_t remote_addr,
+                                        uct_rkey_t rkey, uint64_t *result,
+                                        uct_completion_t *comp)
+{
+    uint64_t *ptr = (uint64_t *)(rkey + remote_addr);
+    *result = ucs_atomic_cswap64(ptr, compare, swap);
+    uct_self_trace_data(remote_addr, rkey,
+                        "ATOMIC_CSWAP64 [compare %"PRIu64" swap %"PRIu64" result %"PRIu64"]",
+                        compare, swap, *result);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_add32(uct_ep_h tl_ep, uint32_t add,
+                                      uint64_t remote_addr, uct_rkey_t rkey)
+{
+    uint32_t *ptr = (uint32_t *)(rkey + remote_addr);
+    ucs_atomic_add32(ptr, add);
+    uct_self_trace_data(remote_addr, rkey, "ATOMIC_ADD32 [add %"PRIu32"]", add);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_fadd32(uct_ep_h tl_ep, uint32_t add,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint32_t *result, uct_completion_t *comp)
+{
+    uint32_t *ptr = (uint32_t *)(rkey + remote_addr);
+    *result = ucs_atomic_fadd32(ptr, add);
+    uct_self_trace_data(remote_addr, rkey,
+                        "ATOMIC_FADD32 [add %"PRIu32" result %"PRIu32"]",
+                        add, *result);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_swap32(uct_ep_h tl_ep, uint32_t swap,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint32_t *result, uct_completion_t *comp)
+{
+    uint32_t *ptr = (uint32_t *)(rkey + remote_addr);
+    *result = ucs_atomic_swap32(ptr, swap);
+    uct_self_trace_data(remote_addr, rkey,
+                        "ATOMIC_SWAP32 [swap %"PRIu32" result %"PRIu32"]",
+                        swap, *result);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_atomic_cswap32(uct_ep_h tl_ep, uint32_t compare,
+                                        uint32_t swap, uint64_t remote_addr,
+                                        uct_rkey_t rkey, uint32_t *result,
+                                        uct_completion_t *comp)
+{
+    uint32_t *ptr = (uint32_t *)(rkey + remote_addr);
+    *result = ucs_atomic_cswap32(ptr, compare, swap);
+    uct_self_trace_data(remote_addr, rkey,
+                        "ATOMIC_CSWAP32 [compare %"PRIu32" swap %"PRIu32" result %"PRIu32"]",
+                        compare, swap, *result);
+    UCT_TL_EP_STAT_ATOMIC(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
+
+ucs_status_t uct_self_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_self_iface_t);
+    uct_self_ep_t *ep = ucs_derived_of(tl_ep, uct_self_ep_t);
+
+    /* only active messages run out of resources, when all the descriptors
+     * are held by undelivered messages or by the user */
+    if (!ucs_mpool_is_empty(&iface->msg_desc_mp)) {
+        return UCS_ERR_BUSY;
+    }
+
+    UCS_STATIC_ASSERT(sizeof(ucs_arbiter_elem_t) <= UCT_PENDING_REQ_PRIV_LEN);
+    ucs_arbiter_elem_init((ucs_arbiter_elem_t*)req->priv);
+    ucs_arbiter_group_push_elem(&ep->arb_group, (ucs_arbiter_elem_t*)req->priv);
+    ucs_arbiter_group_schedule(&iface->arbiter, &ep->arb_group);
+    return UCS_OK;
+}
+
+ucs_arbiter_cb_result_t uct_self_ep_process_pending(ucs_arbiter_t *arbiter,
+                                                    ucs_arbiter_elem_t *elem,
+                                                    void *arg)
+{
+    uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    ucs_status_t status;
+
+    status = req->func(req);
+    ucs_trace_data("progress pending request %p returned %s", req,
+                   ucs_status_string(status));
+
+    if (status == UCS_OK) {
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    } else if (status == UCS_INPROGRESS) {
+        return UCS_ARBITER_CB_RESULT_NEXT_GROUP;
+    }
+
+    /* all the endpoints share the descriptors, so the others can't send too */
+    return UCS_ARBITER_CB_RESULT_STOP;
+}
+
+static ucs_arbiter_cb_result_t uct_self_ep_arbiter_purge_cb(ucs_arbiter_t *arbiter,
+                                                            ucs_arbiter_elem_t *elem,
+                                                            void *arg)
+{
+    uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    uct_pending_callback_t cb = arg;
+
+    cb(req);
+    return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+}
+
+void uct_self_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_self_iface_t);
+    uct_self_ep_t *ep = ucs_derived_of(tl_ep, uct_self_ep_t);
+
+    ucs_arbiter_group_purge(&iface->arbiter, &ep->arb_group,
+                            uct_self_ep_arbiter_purge_cb, cb);
+}
+
+ucs_status_t uct_self_ep_flush(uct_ep_h tl_ep)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_self_iface_t);
+
+    /* wait until the sent active messages are delivered */
+    if (!ucs_queue_is_empty(&iface->msg_queue)) {
+        UCT_TL_EP_STAT_FLUSH_WAIT(ucs_derived_of(tl_ep, uct_base_ep_t));
+        return UCS_INPROGRESS;
+    }
+
+    UCT_TL_EP_STAT_FLUSH(ucs_derived_of(tl_ep, uct_base_ep_t));
+    return UCS_OK;
+}
@@ -0,0 +1,78 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_SELF_EP_H
+#define UCT_SELF_EP_H
+
+#include "self_iface.h"
+
+
+typedef struct uct_self_ep {
+    uct_base_ep_t           super;
+    ucs_arbiter_group_t     arb_group;    /* Pending requests of the endpoint */
+} uct_self_ep_t;
+
+
+UCS_CLASS_DECLARE_NEW_FUNC(uct_self_ep_t, uct_ep_t, uct_iface_t*,
+                           const uct_device_addr_t *, const uct_iface_addr_t*);
+UCS_CLASS_DECLARE_DELETE_FUNC(uct_self_ep_t, uct_ep_t);
+
+ucs_status_t uct_self_ep_put_short(uct_ep_h tl_ep, const void *buffer,
+                                   unsigned length, uint64_t remote_addr,
+                                   uct_rkey_t rkey);
+ssize_t uct_self_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
+                              void *arg, uint64_t remote_addr, uct_rkey_t rkey);
+ucs_status_t uct_self_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer,
+                                   size_t length, uct_mem_h memh,
+                                   uint64_t remote_addr, uct_rkey_t rkey,
+                                   uct_completion_t *comp);
+ucs_status_t uct_self_ep_get_bcopy(uct_ep_h tl_ep, uct_unpack_callback_t unpack_cb,
+                                   void *arg, size_t length,
+                                   uint64_t remote_addr, uct_rkey_t rkey,
+                                   uct_completion_t *comp);
+ucs_status_t uct_self_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                   uct_mem_h memh, uint64_t remote_addr,
+                                   uct_rkey_t rkey, uct_completion_t *comp);
+
+ucs_status_t uct_self_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
+                                  const void *payload, unsigned length);
+ssize_t uct_self_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id,
+                             uct_pack_callback_t pack_cb, void *arg);
+
+ucs_status_t uct_self_ep_atomic_add64(uct_ep_h tl_ep, uint64_t add,
+                                      uint64_t remote_addr, uct_rkey_t rkey);
+ucs_status_t uct_self_ep_atomic_fadd64(uct_ep_h tl_ep, uint64_t add,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint64_t *result, uct_completion_t *comp);
+ucs_status_t uct_self_ep_atomic_swap64(uct_ep_h tl_ep, uint64_t swap,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint64_t *result, uct_completion_t *comp);
+ucs_status_t uct_self_ep_atomic_cswap64(uct_ep_h tl_ep, uint64_t compare,
+                                        uint64_t swap, uint64_t remote_addr,
+                                        uct_rkey_t rkey, uint64_t *result,
+                                        uct_completion_t *comp);
+ucs_status_t uct_self_ep_atomic_add32(uct_ep_h tl_ep, uint32_t add,
+                                      uint64_t remote_addr, uct_rkey_t rkey);
+ucs_status_t uct_self_ep_atomic_fadd32(uct_ep_h tl_ep, uint32_t add,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint32_t *result, uct_completion_t *comp);
+ucs_status_t uct_self_ep_atomic_swap32(uct_ep_h tl_ep, uint32_t swap,
+                                       uint64_t remote_addr, uct_rkey_t rkey,
+                                       uint32_t *result, uct_completion_t *comp);
+ucs_status_t uct_self_ep_atomic_cswap32(uct_ep_h tl_ep, uint32_t compare,
+                                        uint32_t swap, uint64_t remote_addr,
+                                        uct_rkey_t rkey, uint32_t *result,
+                                        uct_completion_t *comp);
+
+ucs_status_t uct_self_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req);
+void uct_self_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb);
+ucs_arbiter_cb_result_t uct_self_ep_process_pending(ucs_arbiter_t *arbiter,
+                                                    ucs_arbiter_elem_t *elem,
+                                                    void *arg);
+
+ucs_status_t uct_self_ep_flush(uct_ep_h tl_ep);
+
+#endif
@@ -0,0 +1,278 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "self_pd.h"
+#include "self_iface.h"
+#include "self_ep.h"
+
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/sys/sys.h>
+
+
+UCT_PD_REGISTER_TL(&uct_self_pd_component, &uct_self_tl);
+
+static ucs_config_field_t uct_self_iface_config_table[] = {
+    {"", "ALLOC=huge,mmap,heap", NULL,
+    ucs_offsetof(uct_self_iface_config_t, super),
+    UCS_CONFIG_TYPE_TABLE(uct_iface_config_table)},
+
+    UCT_IFACE_MPOOL_CONFIG_FIELDS("", -1, 16, "active message",
+                                  ucs_offsetof(uct_self_iface_config_t, mp), ""),
+
+    {NULL}
+};
+
+static ucs_status_t uct_self_iface_get_device_address(uct_iface_t *tl_iface,
+                                                      uct_device_addr_t *addr)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_iface, uct_self_iface_t);
+
+    *(uint64_t*)addr = iface->id;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_self_iface_get_address(uct_iface_t *tl_iface,
+                                               uct_iface_addr_t *addr)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_iface, uct_self_iface_t);
+
+    *(uint64_t*)addr = iface->id;
+    return UCS_OK;
+}
+
+static int uct_self_iface_is_reachable(uct_iface_t *tl_iface,
+                                       const uct_device_addr_t *addr)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_iface, uct_self_iface_t);
+
+    return iface->id == *(const uint64_t*)addr;
+}
+
+static ucs_status_t uct_self_iface_query(uct_iface_h tl_iface,
+                                         uct_iface_attr_t *iface_attr)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_iface, uct_self_iface_t);
+
+    memset(iface_attr, 0, sizeof(uct_iface_attr_t));
+
+    iface_attr->cap.put.max_short      = UINT_MAX;
+    iface_attr->cap.put.max_bcopy      = SIZE_MAX;
+    iface_attr->cap.put.max_zcopy      = SIZE_MAX;
+    iface_attr->cap.get.max_bcopy      = SIZE_MAX;
+    iface_attr->cap.get.max_zcopy      = SIZE_MAX;
+    iface_attr->cap.am.max_short       = iface->config.seg_size - sizeof(uint64_t);
+    iface_attr->cap.am.max_bcopy       = iface->config.seg_size;
+    iface_attr->iface_addr_len         = sizeof(uint64_t);
+    iface_attr->device_addr_len        = sizeof(uint64_t);
+    iface_attr->ep_addr_len            = 0;
+    iface_attr->cap.flags              = UCT_IFACE_FLAG_PUT_SHORT        |
+                                         UCT_IFACE_FLAG_PUT_BCOPY        |
+                                         UCT_IFACE_FLAG_PUT_ZCOPY        |
+                                         UCT_IFACE_FLAG_ATOMIC_ADD32     |
+                                         UCT_IFACE_FLAG_ATOMIC_ADD64     |
+                                         UCT_IFACE_FLAG_ATOMIC_FADD64    |
+                                         UCT_IFACE_FLAG_ATOMIC_FADD32    |
+                                         UCT_IFACE_FLAG_ATOMIC_SWAP64    |
+                                         UCT_IFACE_FLAG_ATOMIC_SWAP32    |
+                                         UCT_IFACE_FLAG_ATOMIC_CSWAP64   |
+                                         UCT_IFACE_FLAG_ATOMIC_CSWAP32   |
+                                         UCT_IFACE_FLAG_GET_BCOPY        |
+                                         UCT_IFACE_FLAG_GET_ZCOPY        |
+                                         UCT_IFACE_FLAG_AM_SHORT         |
+                                         UCT_IFACE_FLAG_AM_BCOPY         |
+                                         UCT_IFACE_FLAG_PENDING          |
+                                         UCT_IFACE_FLAG_AM_CB_SYNC       |
+                                         UCT_IFACE_FLAG_CONNECT_TO_IFACE;
+
+    /* no data crosses the memory bus to another process, so the transport is
+     * preferred over any other one which can reach the same interface */
+    iface_attr->latency                = 0;
+    iface_attr->bandwidth              = 6911 * 1024.0 * 1024.0;
+    iface_attr->overhead               = 1e-9; /* 1 ns */
+    return UCS_OK;
+}
+
+static void uct_self_iface_release_am_desc(uct_iface_t *tl_iface, void *desc)
+{
+    ucs_mpool_put((uct_self_recv_desc_t*)desc - 1);
+}
+
+static void uct_self_iface_invoke_am(uct_self_iface_t *iface,
+                                     uct_self_recv_desc_t *desc)
+{
+    void *data = uct_self_recv_desc_data(iface, desc);
+    void *rx_desc = desc + 1; /* point the desc to the user's headroom */
+    ucs_status_t status;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, desc->am_id,
+                       data, desc->length, "RX: AM");
+
+    status = uct_iface_invoke_am(&iface->super, desc->am_id, data,
+                                 desc->length, rx_desc);
+    if (status == UCS_OK) {
+        ucs_mpool_put(desc);
+    } else {
+        /* save the iface of this desc for its later release */
+        uct_recv_desc_iface(rx_desc) = &iface->super.super;
+    }
+}
+
+/*
+ * Deliver the messages which were sent before this call. Messages which are
+ * sent from a handler are delivered by the next call, so handlers are not
+ * called recursively, and a handler which always replies does not block the
+ * progress of other transports.
+ */
+unsigned uct_self_iface_progress(void *arg)
+{
+    uct_self_iface_t *iface = arg;
+    uct_self_recv_desc_t *desc;
+    ucs_queue_head_t queue;
+    unsigned count = 0;
+
+    ucs_queue_head_init(&queue);
+    ucs_queue_splice(&queue, &iface->msg_queue);
+
+    while (!ucs_queue_is_empty(&queue)) {
+        desc = ucs_queue_pull_elem_non_empty(&queue, uct_self_recv_desc_t,
+                                             queue);
+        uct_self_iface_invoke_am(iface, desc);
+        ++count;
+    }
+
+    /* send the pending requests with the released descriptors */
+    count += ucs_arbiter_dispatch(&iface->arbiter, 1,
+                                  uct_self_ep_process_pending, NULL);
+    return count;
+}
+
+static ucs_status_t uct_self_iface_flush(uct_iface_h tl_iface)
+{
+    uct_self_iface_t *iface = ucs_derived_of(tl_iface, uct_self_iface_t);
+
+    if (!ucs_queue_is_empty(&iface->msg_queue)) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return UCS_INPROGRESS;
+    }
+
+    UCT_TL_IFACE_STAT_FLUSH(&iface->super);
+    return UCS_OK;
+}
+
+static UCS_CLASS_DECLARE_DELETE_FUNC(uct_self_iface_t, uct_iface_t);
+
+static uct_iface_ops_t uct_self_iface_ops = {
+    .iface_close         = UCS_CLASS_DELETE_FUNC_NAME(uct_self_iface_t),
+    .iface_query         = uct_self_iface_query,
+    .iface_flush         = uct_self_iface_flush,
+    .iface_get_address   = uct_self_iface_get_address,
+    .iface_get_device_address = uct_self_iface_get_device_address,
+    .iface_is_reachable  = uct_self_iface_is_reachable,
+    .iface_release_am_desc = uct_self_iface_release_am_desc,
+    .ep_put_short        = uct_self_ep_put_short,
+    .ep_put_bcopy        = uct_self_ep_put_bcopy,
+    .ep_put_zcopy        = uct_self_ep_put_zcopy,
+    .ep_get_bcopy        = uct_self_ep_get_bcopy,
+    .ep_get_zcopy        = uct_self_ep_get_zcopy,
+    .ep_am_short         = uct_self_ep_am_short,
+    .ep_am_bcopy         = uct_self_ep_am_bcopy,
+    .ep_atomic_add64     = uct_self_ep_atomic_add64,
+    .ep_atomic_fadd64    = uct_self_ep_atomic_fadd64,
+    .ep_atomic_cswap64   = uct_self_ep_atomic_cswap64,
+    .ep_atomic_swap64    = uct_self_ep_atomic_swap64,
+    .ep_atomic_add32     = uct_self_ep_atomic_add32,
+    .ep_atomic_fadd32    = uct_self_ep_atomic_fadd32,
+    .ep_atomic_cswap32   = uct_self_ep_atomic_cswap32,
+    .ep_atomic_swap32    = uct_self_ep_atomic_swap32,
+    .ep_pending_add      = uct_self_ep_pending_add,
+    .ep_pending_purge    = uct_self_ep_pending_purge,
+    .ep_flush            = uct_self_ep_flush,
+    .ep_create_connected = UCS_CLASS_NEW_FUNC_NAME(uct_self_ep_t),
+    .ep_destroy          = UCS_CLASS_DELETE_FUNC_NAME(uct_self_ep_t),
+};
+
+static UCS_CLASS_INIT_FUNC(uct_self_iface_t, uct_pd_h pd, uct_worker_h worker,
+                           const char *dev_name, size_t rx_headroom,
+                           const uct_iface_config_t *tl_config)
+{
+    uct_self_iface_config_t *config = ucs_derived_of(tl_config,
+                                                     uct_self_iface_config_t);
+    ucs_status_t status;
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_iface_t, &uct_self_iface_ops, pd, worker,
+                              tl_config UCS_STATS_ARG(NULL));
+
+    self->id              = ucs_generate_uuid((uintptr_t)self);
+    self->rx_headroom     = rx_headroom;
+    self->config.seg_size = config->super.max_bcopy;
+    ucs_queue_head_init(&self->msg_queue);
+    ucs_arbiter_init(&self->arbiter);
+
+    status = uct_iface_mpool_init(&self->super, &self->msg_desc_mp,
+                                  sizeof(uct_self_recv_desc_t) + rx_headroom +
+                                  self->config.seg_size,
+                                  sizeof(uct_self_recv_desc_t),
+                                  UCS_SYS_CACHE_LINE_SIZE, &config->mp, 16,
+                                  ucs_empty_function, "self_msg_desc");
+    if (status != UCS_OK) {
+        ucs_error("Failed to create a memory pool for the self transport");
+        return status;
+    }
+
+    return UCS_OK;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_self_iface_t)
+{
+    uct_self_recv_desc_t *desc;
+
+    /* Drop the messages which were not delivered */
+    while (!ucs_queue_is_empty(&self->msg_queue)) {
+        desc = ucs_queue_pull_elem_non_empty(&self->msg_queue,
+                                             uct_self_recv_desc_t, queue);
+        ucs_mpool_put(desc);
+    }
+    ucs_mpool_cleanup(&self->msg_desc_mp, 1);
+    ucs_arbiter_cleanup(&self->arbiter);
+}
+
+UCS_CLASS_DEFINE(uct_self_iface_t, uct_base_iface_t);
+
+static UCS_CLASS_DEFINE_NEW_FUNC(uct_self_iface_t, uct_iface_t, uct_pd_h,
+                                 uct_worker_h, const char *, size_t,
+                                 const uct_iface_config_t *);
+static UCS_CLASS_DEFINE_DELETE_FUNC(uct_self_iface_t, uct_iface_t);
+
+static ucs_status_t uct_self_query_tl_resources(uct_pd_h pd,
+                                                uct_tl_resource_desc_t **resource_p,
+                                                unsigned *num_resources_p)
+{
+    uct_tl_resource_desc_t *resource;
+
+    resource = ucs_calloc(1, sizeof(uct_tl_resource_desc_t), "resource desc");
+    if (NULL == resource) {
+        ucs_error("Failed to allocate memory");
+        return UCS_ERR_NO_MEMORY;
+    }
+
+    ucs_snprintf_zero(resource->tl_name, sizeof(resource->tl_name), "%s",
+                      UCT_SELF_NAME);
+    ucs_snprintf_zero(resource->dev_name, sizeof(resource->dev_name), "%s",
+                      UCT_SELF_NAME);
+    resource->dev_type = UCT_DEVICE_TYPE_SHM;
+
+    *num_resources_p = 1;
+    *resource_p      = resource;
+    return UCS_OK;
+}
+
+UCT_TL_COMPONENT_DEFINE(uct_self_tl,
+                        uct_self_query_tl_resources,
+                        uct_self_iface_t,
+                        UCT_SELF_NAME,
+                        "SELF_",
+                        uct_self_iface_config_table,
+                        uct_self_iface_config_t);
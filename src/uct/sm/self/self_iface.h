@@ -0,0 +1,59 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_SELF_IFACE_H
+#define UCT_SELF_IFACE_H
+
+#include <uct/base/uct_iface.h>
+#include <ucs/datastruct/arbiter.h>
+#include <ucs/datastruct/mpool.h>
+#include <ucs/datastruct/queue.h>
+
+
+typedef struct uct_self_iface_config {
+    uct_iface_config_t       super;
+    uct_iface_mpool_config_t mp;
+} uct_self_iface_config_t;
+
+
+/*
+ * Active message descriptor. The user's receive headroom and the message
+ * payload follow it.
+ */
+typedef struct uct_self_recv_desc {
+    ucs_queue_elem_t        queue;        /* Element in the message queue */
+    uint8_t                 am_id;
+    unsigned                length;
+    uct_am_recv_desc_t      am_recv;      /* has to be in the end */
+} uct_self_recv_desc_t;
+
+
+typedef struct uct_self_iface {
+    uct_base_iface_t        super;
+    uint64_t                id;           /* Unique id, used as device address */
+    size_t                  rx_headroom;
+    ucs_mpool_t             msg_desc_mp;  /* Active message descriptors */
+    ucs_queue_head_t        msg_queue;    /* Messages to deliver on progress */
+    ucs_arbiter_t           arbiter;      /* Sends waiting for a descriptor */
+    struct {
+        size_t              seg_size;     /* Max. active message size */
+    } config;
+} uct_self_iface_t;
+
+
+extern uct_tl_component_t uct_self_tl;
+
+
+unsigned uct_self_iface_progress(void *arg);
+
+
+static inline void *uct_self_recv_desc_data(uct_self_iface_t *iface,
+                                            uct_self_recv_desc_t *desc)
+{
+    return (void*)(desc + 1) + iface->rx_headroom;
+}
+
+#endif
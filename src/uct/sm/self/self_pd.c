@@ -0,0 +1,77 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "self_pd.h"
+
+
+static ucs_status_t uct_self_pd_query(uct_pd_h pd, uct_pd_attr_t *pd_attr)
+{
+    /* memory is accessed directly by its virtual address, so a registration
+     * does not do anything, and the remote key is empty */
+    pd_attr->rkey_packed_size  = 0;
+    pd_attr->cap.flags         = UCT_PD_FLAG_REG;
+    pd_attr->cap.max_alloc     = 0;
+    pd_attr->cap.max_reg       = ULONG_MAX;
+    pd_attr->reg_cost.overhead = 0;
+    pd_attr->reg_cost.growth   = 0;
+
+    memset(&pd_attr->local_cpus, 0xff, sizeof(pd_attr->local_cpus));
+    return UCS_OK;
+}
+
+static ucs_status_t uct_self_query_pd_resources(uct_pd_resource_desc_t **resources_p,
+                                                unsigned *num_resources_p)
+{
+    return uct_single_pd_resource(&uct_self_pd_component, resources_p,
+                                  num_resources_p);
+}
+
+static ucs_status_t uct_self_mem_reg(uct_pd_h pd, void *address, size_t length,
+                                     uct_mem_h *memh_p)
+{
+    /* The memory handle must not be UCT_INVALID_MEM_HANDLE */
+    UCS_STATIC_ASSERT((uint64_t)0xdeadbeef != (uint64_t)UCT_INVALID_MEM_HANDLE);
+    *memh_p = (void *)0xdeadbeef;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_self_pd_open(const char *pd_name,
+                                     const uct_pd_config_t *pd_config,
+                                     uct_pd_h *pd_p)
+{
+    static uct_pd_ops_t pd_ops = {
+        .close        = (void*)ucs_empty_function,
+        .query        = uct_self_pd_query,
+        .mem_alloc    = (void*)ucs_empty_function_return_success,
+        .mem_free     = (void*)ucs_empty_function_return_success,
+        .mkey_pack    = (void*)ucs_empty_function_return_success,
+        .mem_reg      = uct_self_mem_reg,
+        .mem_dereg    = (void*)ucs_empty_function_return_success
+    };
+    static uct_pd_t pd = {
+        .ops          = &pd_ops,
+        .component    = &uct_self_pd_component
+    };
+
+    *pd_p = &pd;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_self_rkey_unpack(uct_pd_component_t *pdc,
+                                         const void *rkey_buffer,
+                                         uct_rkey_t *rkey_p, void **handle_p)
+{
+    /* the remote address is the local virtual address, with no offset */
+    *rkey_p   = 0;
+    *handle_p = NULL;
+    return UCS_OK;
+}
+
+UCT_PD_COMPONENT_DEFINE(uct_self_pd_component, UCT_SELF_NAME,
+                        uct_self_query_pd_resources, uct_self_pd_open, NULL,
+                        uct_self_rkey_unpack,
+                        ucs_empty_function_return_success, "SELF_",
+                        uct_pd_config_table, uct_pd_config_t)
@@ -0,0 +1,18 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_SELF_PD_H_
+#define UCT_SELF_PD_H_
+
+#include <uct/base/uct_pd.h>
+
+
+#define UCT_SELF_NAME "self"
+
+
+extern uct_pd_component_t uct_self_pd_component;
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_TCP_H
+#define UCT_TCP_H
+
+#include <uct/base/uct_iface.h>
+#include <uct/base/uct_pd.h>
+#include <ucs/datastruct/arbiter.h>
+#include <ucs/datastruct/list.h>
+#include <ucs/datastruct/mpool.h>
+#include <ucs/datastruct/queue.h>
+#include <netinet/in.h>
+#include <sys/uio.h>
+
+
+#define UCT_TCP_NAME           "tcp"
+#define UCT_TCP_MAX_EVENTS     16   /* Max. socket events per progress call */
+
+
+/*
+ * Message types which are not active messages. Their ids follow the range
+ * of the user's active message ids.
+ */
+enum {
+    UCT_TCP_MSG_PUT       = UCT_AM_ID_MAX, /* Write to remote memory */
+    UCT_TCP_MSG_GET_REQ,                   /* Read from remote memory */
+    UCT_TCP_MSG_GET_REP,                   /* Data of a read request */
+    UCT_TCP_MSG_FLUSH_REQ,                 /* Request to acknowledge all
+                                              previous messages */
+    UCT_TCP_MSG_FLUSH_REP                  /* Flush acknowledgment */
+};
+
+
+/*
+ * Header of every message on the stream, followed by 'length' bytes.
+ */
+typedef struct uct_tcp_hdr {
+    uint8_t                 am_id;        /* Active message id or message type */
+    uint32_t                length;       /* Payload length */
+} UCS_S_PACKED uct_tcp_hdr_t;
+
+
+/*
+ * Header of remote memory access messages.
+ */
+typedef struct uct_tcp_rma_hdr {
+    uint64_t                address;      /* Remote address */
+    uint64_t                length;       /* Length of GET_REQ, 0 for PUT */
+    uint64_t                rkey;         /* Key of the remote region */
+} UCS_S_PACKED uct_tcp_rma_hdr_t;
+
+
+/*
+ * Device address: the IPv4 address of the interface, and the machine of the
+ * host, to tell whether loopback addresses are reachable.
+ */
+typedef struct uct_tcp_device_addr {
+    uint64_t                guid;
+    struct in_addr          in_addr;
+} UCS_S_PACKED uct_tcp_device_addr_t;
+
+
+typedef struct uct_tcp_iface_config {
+    uct_iface_config_t       super;
+    size_t                   seg_size;
+    size_t                   zcopy_thresh;
+    size_t                   sndbuf;
+    size_t                   rcvbuf;
+    int                      nodelay;
+    uct_iface_mpool_config_t mp;
+} uct_tcp_iface_config_t;
+
+
+/*
+ * Byte stream buffer. Data in the range [offset, length) was not sent yet,
+ * or was not processed yet.
+ */
+typedef struct uct_tcp_buf {
+    void                    *data;
+    size_t                  offset;
+    size_t                  length;
+} uct_tcp_buf_t;
+
+
+/*
+ * A stream socket. Endpoints own the sockets they connect, and the interface
+ * owns the sockets it accepts. Active messages and remote memory access
+ * requests are received on accepted sockets, and their replies are received
+ * on endpoint sockets.
+ */
+typedef struct uct_tcp_conn {
+    int                     fd;
+    struct uct_tcp_ep       *ep;          /* Owner endpoint, NULL if accepted */
+    uint32_t                events;       /* Events the socket is polled for */
+    int                     connecting;   /* Non-blocking connect in progress */
+    int                     rx_blocked;   /* Waiting for tx to send a reply */
+    int                     zcopy_enabled;/* SO_ZEROCOPY is set */
+    ucs_status_t            status;       /* Error which closed the socket */
+    uct_tcp_buf_t           tx;
+    uct_tcp_buf_t           rx;
+    ucs_queue_head_t        zcopy_ops;    /* Sends waiting for MSG_ZEROCOPY
+                                             completion */
+    uint32_t                zcopy_sn;     /* Number of MSG_ZEROCOPY sends */
+    ucs_list_link_t         list;         /* Entry in the interface list */
+} uct_tcp_conn_t;
+
+
+/*
+ * Operation waiting for a reply or for a zero-copy completion.
+ */
+typedef struct uct_tcp_op {
+    ucs_queue_elem_t        queue;
+    uct_completion_t        *comp;
+    uint32_t                sn;           /* MSG_ZEROCOPY send number */
+    size_t                  length;       /* GET length */
+    uct_unpack_callback_t   unpack_cb;    /* GET_BCOPY unpack callback */
+    void                    *arg;         /* GET_BCOPY callback argument, or
+                                             GET_ZCOPY buffer */
+} uct_tcp_op_t;
+
+
+typedef struct uct_tcp_iface {
+    uct_base_iface_t        super;
+    int                     listen_fd;
+    int                     epfd;         /* Polls all sockets */
+    int                     wakeup_efd;   /* Signals uct_wakeup_signal() */
+    struct sockaddr_in      addr;         /* Address of the listen socket */
+    struct in_addr          netmask;      /* Netmask of the interface */
+    uint64_t                guid;
+    size_t                  rx_headroom;
+    ucs_mpool_t             rx_desc_mp;   /* Active message descriptors */
+    ucs_mpool_t             op_mp;        /* Outstanding operations */
+    ucs_arbiter_t           arbiter;      /* Pending requests of endpoints */
+    ucs_list_link_t         ep_list;      /* Endpoints, for flush */
+    ucs_list_link_t         conn_list;    /* Accepted sockets */
+    int                     rx_stalled;   /* Received messages wait for
+                                             receive descriptors */
+    struct {
+        size_t              seg_size;     /* Max. message payload */
+        size_t              buf_size;     /* Size of socket buffers */
+        size_t              zcopy_thresh; /* Min. MSG_ZEROCOPY length */
+        size_t              sndbuf;
+        size_t              rcvbuf;
+        int                 nodelay;
+    } config;
+} uct_tcp_iface_t;
+
+
+typedef struct uct_tcp_ep {
+    uct_base_ep_t           super;
+    uct_tcp_conn_t          conn;
+    ucs_arbiter_group_t     arb_group;    /* Pending requests */
+    ucs_queue_head_t        get_ops;      /* GET requests waiting for data */
+    int                     unacked;      /* Sent since the last flush request */
+    unsigned                flush_reqs;   /* Outstanding flush requests */
+    ucs_list_link_t         list;         /* Entry in the interface list */
+} uct_tcp_ep_t;
+
+
+extern uct_pd_component_t uct_tcp_pd_component;
+extern uct_tl_component_t uct_tcp_tl;
+
+
+unsigned uct_tcp_iface_progress(void *arg);
+
+ucs_status_t uct_tcp_conn_init(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                               int fd, uct_tcp_ep_t *ep, int connecting);
+
+void uct_tcp_conn_cleanup(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn);
+
+ucs_status_t uct_tcp_socket_setopt(uct_tcp_iface_t *iface, int fd);
+
+ucs_status_t uct_tcp_conn_send(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                               const struct iovec *iov, int iovcnt,
+                               size_t length, int zcopy,
+                               uct_completion_t *comp);
+
+void *uct_tcp_conn_tx_get(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                          size_t max_length);
+
+ucs_status_t uct_tcp_conn_tx_commit(uct_tcp_iface_t *iface,
+                                    uct_tcp_conn_t *conn, size_t length);
+
+ucs_status_t uct_tcp_conn_progress_tx(uct_tcp_iface_t *iface,
+                                      uct_tcp_conn_t *conn);
+
+ucs_status_t uct_tcp_conn_progress_rx(uct_tcp_iface_t *iface,
+                                      uct_tcp_conn_t *conn, unsigned *count_p);
+
+ucs_status_t uct_tcp_conn_process_rx(uct_tcp_iface_t *iface,
+                                     uct_tcp_conn_t *conn, unsigned *count_p);
+
+void uct_tcp_conn_set_failed(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                             ucs_status_t status);
+
+void uct_tcp_conn_progress_errqueue(uct_tcp_iface_t *iface,
+                                    uct_tcp_conn_t *conn);
+
+void uct_tcp_ep_tx_resumed(uct_tcp_ep_t *ep);
+
+ucs_status_t uct_tcp_ep_handle_reply(uct_tcp_ep_t *ep, uint8_t am_id,
+                                     void *data, size_t length);
+
+void uct_tcp_ep_set_failed(uct_tcp_ep_t *ep, ucs_status_t status);
+
+UCS_CLASS_DECLARE_NEW_FUNC(uct_tcp_ep_t, uct_ep_t, uct_iface_t*,
+                           const uct_device_addr_t *, const uct_iface_addr_t*);
+UCS_CLASS_DECLARE_DELETE_FUNC(uct_tcp_ep_t, uct_ep_t);
+
+ucs_status_t uct_tcp_ep_put_short(uct_ep_h tl_ep, const void *buffer,
+                                  unsigned length, uint64_t remote_addr,
+                                  uct_rkey_t rkey);
+ssize_t uct_tcp_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
+                             void *arg, uint64_t remote_addr, uct_rkey_t rkey);
+ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer,
+                                  size_t length, uct_mem_h memh,
+                                  uint64_t remote_addr, uct_rkey_t rkey,
+                                  uct_completion_t *comp);
+ucs_status_t uct_tcp_ep_get_bcopy(uct_ep_h tl_ep, uct_unpack_callback_t unpack_cb,
+                                  void *arg, size_t length,
+                                  uint64_t remote_addr, uct_rkey_t rkey,
+                                  uct_completion_t *comp);
+ucs_status_t uct_tcp_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                  uct_mem_h memh, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
+                                 const void *payload, unsigned length);
+ssize_t uct_tcp_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id,
+                            uct_pack_callback_t pack_cb, void *arg);
+ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                 unsigned header_length, const void *payload,
+                                 size_t length, uct_mem_h memh,
+                                 uct_completion_t *comp);
+
+ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req);
+void uct_tcp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb);
+ucs_arbiter_cb_result_t uct_tcp_ep_process_pending(ucs_arbiter_t *arbiter,
+                                                   ucs_arbiter_elem_t *elem,
+                                                   void *arg);
+
+ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep);
+
+
+static inline int uct_tcp_conn_tx_busy(uct_tcp_conn_t *conn)
+{
+    return conn->tx.length > 0;
+}
+
+#endif
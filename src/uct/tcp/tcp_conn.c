@@ -0,0 +1,756 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tcp.h"
+
+#include <uct/base/uct_sock_pd.h>
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/debug/log.h>
+#include <ucs/sys/sys.h>
+#include <linux/errqueue.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+#define UCT_TCP_SEND_FLAGS (MSG_NOSIGNAL | MSG_DONTWAIT)
+
+
+static int uct_tcp_conn_would_block(uct_tcp_conn_t *conn)
+{
+    /* sending on a socket which is not connected yet fails with EAGAIN, or
+     * with ENOTCONN on some kernels */
+    return (errno == EAGAIN) || (errno == EWOULDBLOCK) ||
+           (conn->connecting && (errno == ENOTCONN));
+}
+
+static ucs_status_t uct_tcp_conn_update_events(uct_tcp_iface_t *iface,
+                                               uct_tcp_conn_t *conn)
+{
+    struct epoll_event event;
+    uint32_t events;
+
+    events = EPOLLIN;
+    if (uct_tcp_conn_tx_busy(conn) || conn->connecting) {
+        events |= EPOLLOUT;
+    }
+
+    if ((conn->events == events) || (conn->events == 0)) {
+        return UCS_OK;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events   = events;
+    event.data.ptr = conn;
+    if (epoll_ctl(iface->epfd, EPOLL_CTL_MOD, conn->fd, &event) < 0) {
+        ucs_error("epoll_ctl(MOD, fd=%d) failed: %m", conn->fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    conn->events = events;
+    return UCS_OK;
+}
+
+/* Stop polling a socket which was closed by the peer */
+static void uct_tcp_conn_remove_events(uct_tcp_iface_t *iface,
+                                       uct_tcp_conn_t *conn)
+{
+    if (conn->events == 0) {
+        return;
+    }
+
+    if (epoll_ctl(iface->epfd, EPOLL_CTL_DEL, conn->fd, NULL) < 0) {
+        ucs_warn("epoll_ctl(DEL, fd=%d) failed: %m", conn->fd);
+    }
+    conn->events = 0;
+}
+
+ucs_status_t uct_tcp_socket_setopt(uct_tcp_iface_t *iface, int fd)
+{
+    int value;
+
+    value = iface->config.nodelay;
+    if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value)) < 0) {
+        ucs_error("setsockopt(TCP_NODELAY) failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    if (iface->config.sndbuf != UCS_CONFIG_MEMUNITS_AUTO) {
+        value = iface->config.sndbuf;
+        if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &value, sizeof(value)) < 0) {
+            ucs_error("setsockopt(SO_SNDBUF) failed: %m");
+            return UCS_ERR_IO_ERROR;
+        }
+    }
+
+    if (iface->config.rcvbuf != UCS_CONFIG_MEMUNITS_AUTO) {
+        value = iface->config.rcvbuf;
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, sizeof(value)) < 0) {
+            ucs_error("setsockopt(SO_RCVBUF) failed: %m");
+            return UCS_ERR_IO_ERROR;
+        }
+    }
+
+    return UCS_OK;
+}
+
+static void uct_tcp_conn_enable_zcopy(uct_tcp_iface_t *iface,
+                                      uct_tcp_conn_t *conn)
+{
+#ifdef SO_ZEROCOPY
+    int one = 1;
+
+    if (iface->config.zcopy_thresh == UCS_CONFIG_MEMUNITS_INF) {
+        return;
+    }
+
+    /* older kernels do not support MSG_ZEROCOPY, and all sends copy */
+    if (setsockopt(conn->fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) < 0) {
+        ucs_debug("setsockopt(SO_ZEROCOPY) failed: %m, zero-copy sends disabled");
+        return;
+    }
+
+    conn->zcopy_enabled = 1;
+#endif
+}
+
+ucs_status_t uct_tcp_conn_init(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                               int fd, uct_tcp_ep_t *ep, int connecting)
+{
+    struct epoll_event event;
+    ucs_status_t status;
+
+    conn->fd            = fd;
+    conn->ep            = ep;
+    conn->connecting    = connecting;
+    conn->rx_blocked    = 0;
+    conn->zcopy_enabled = 0;
+    conn->zcopy_sn      = 0;
+    conn->status        = UCS_OK;
+    conn->tx.offset     = 0;
+    conn->tx.length     = 0;
+    conn->rx.offset     = 0;
+    conn->rx.length     = 0;
+    ucs_queue_head_init(&conn->zcopy_ops);
+
+    status = uct_tcp_socket_setopt(iface, fd);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    /* only endpoints send large messages */
+    if (ep != NULL) {
+        uct_tcp_conn_enable_zcopy(iface, conn);
+    }
+
+    conn->tx.data = ucs_malloc(iface->config.buf_size, "tcp_tx_buf");
+    if (conn->tx.data == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err;
+    }
+
+    conn->rx.data = ucs_malloc(iface->config.buf_size, "tcp_rx_buf");
+    if (conn->rx.data == NULL) {
+        status = UCS_ERR_NO_MEMORY;
+        goto err_free_tx;
+    }
+
+    conn->events = EPOLLIN | (connecting ? EPOLLOUT : 0);
+    memset(&event, 0, sizeof(event));
+    event.events   = conn->events;
+    event.data.ptr = conn;
+    if (epoll_ctl(iface->epfd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        ucs_error("epoll_ctl(ADD, fd=%d) failed: %m", fd);
+        status = UCS_ERR_IO_ERROR;
+        goto err_free_rx;
+    }
+
+    return UCS_OK;
+
+err_free_rx:
+    ucs_free(conn->rx.data);
+err_free_tx:
+    ucs_free(conn->tx.data);
+err:
+    return status;
+}
+
+static void uct_tcp_conn_cancel_zcopy(uct_tcp_conn_t *conn, ucs_status_t status)
+{
+    uct_tcp_op_t *op;
+
+    ucs_queue_for_each_extract(op, &conn->zcopy_ops, queue, 1) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, status);
+        }
+        ucs_mpool_put(op);
+    }
+}
+
+void uct_tcp_conn_set_failed(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                             ucs_status_t status)
+{
+    if (conn->status != UCS_OK) {
+        return;
+    }
+
+    ucs_debug("tcp socket %d failed: %s", conn->fd, ucs_status_string(status));
+
+    /* the socket is closed when its owner is destroyed, and nothing is sent
+     * or received on it until then */
+    conn->status = status;
+    uct_tcp_conn_remove_events(iface, conn);
+    shutdown(conn->fd, SHUT_RDWR);
+    uct_tcp_conn_cancel_zcopy(conn, status);
+    conn->rx_blocked = 0;
+    conn->tx.offset  = 0;
+    conn->tx.length  = 0;
+    conn->rx.offset  = 0;
+    conn->rx.length  = 0;
+}
+
+void uct_tcp_conn_cleanup(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn)
+{
+    if (uct_tcp_conn_tx_busy(conn)) {
+        ucs_debug("tcp socket %d closed with %zu unsent bytes", conn->fd,
+                  conn->tx.length - conn->tx.offset);
+    }
+
+    uct_tcp_conn_cancel_zcopy(conn, UCS_ERR_CANCELED);
+
+    uct_tcp_conn_remove_events(iface, conn);
+    close(conn->fd);
+    ucs_free(conn->rx.data);
+    ucs_free(conn->tx.data);
+}
+
+/* Copy 'length' bytes of an iov, starting at 'offset' */
+static void uct_tcp_iov_copy(void *dst, const struct iovec *iov, int iovcnt,
+                             size_t offset, size_t length)
+{
+    size_t copy;
+    int i;
+
+    for (i = 0; (i < iovcnt) && (length > 0); ++i) {
+        if (offset >= iov[i].iov_len) {
+            offset -= iov[i].iov_len;
+            continue;
+        }
+
+        copy = ucs_min(iov[i].iov_len - offset, length);
+        memcpy(dst, iov[i].iov_base + offset, copy);
+        dst    += copy;
+        length -= copy;
+        offset  = 0;
+    }
+}
+
+void *uct_tcp_conn_tx_get(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                          size_t max_length)
+{
+    uct_tcp_buf_t *tx = &conn->tx;
+
+    if (tx->length + max_length > iface->config.buf_size) {
+        /* move the unsent data to the beginning of the buffer */
+        memmove(tx->data, tx->data + tx->offset, tx->length - tx->offset);
+        tx->length -= tx->offset;
+        tx->offset  = 0;
+        if (tx->length + max_length > iface->config.buf_size) {
+            return NULL;
+        }
+    }
+
+    return tx->data + tx->length;
+}
+
+static ucs_status_t uct_tcp_conn_flush_tx(uct_tcp_iface_t *iface,
+                                          uct_tcp_conn_t *conn)
+{
+    uct_tcp_buf_t *tx = &conn->tx;
+    ssize_t ret;
+
+    ret = send(conn->fd, tx->data + tx->offset, tx->length - tx->offset,
+               UCT_TCP_SEND_FLAGS);
+    if (ret < 0) {
+        if (!uct_tcp_conn_would_block(conn)) {
+            ucs_error("send(fd=%d) failed: %m", conn->fd);
+            return UCS_ERR_IO_ERROR;
+        }
+        ret = 0;
+    }
+
+    tx->offset += ret;
+    if (tx->offset == tx->length) {
+        tx->offset = 0;
+        tx->length = 0;
+    }
+
+    return uct_tcp_conn_update_events(iface, conn);
+}
+
+ucs_status_t uct_tcp_conn_tx_commit(uct_tcp_iface_t *iface,
+                                    uct_tcp_conn_t *conn, size_t length)
+{
+    int busy = uct_tcp_conn_tx_busy(conn);
+
+    conn->tx.length += length;
+    if (busy) {
+        /* sent together with the data before it, when the socket is ready */
+        return UCS_OK;
+    }
+
+    return uct_tcp_conn_flush_tx(iface, conn);
+}
+
+/* Returns the number of bytes sent, or an error */
+static ssize_t uct_tcp_conn_sendv(uct_tcp_conn_t *conn, const struct iovec *iov,
+                                  int iovcnt, int flags)
+{
+    struct msghdr msg;
+    ssize_t ret;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = (struct iovec*)iov;
+    msg.msg_iovlen = iovcnt;
+
+    ret = sendmsg(conn->fd, &msg, UCT_TCP_SEND_FLAGS | flags);
+    if (ret < 0) {
+        if (!uct_tcp_conn_would_block(conn)) {
+            ucs_error("sendmsg(fd=%d) failed: %m", conn->fd);
+            return UCS_ERR_IO_ERROR;
+        }
+        return 0;
+    }
+
+    return ret;
+}
+
+ucs_status_t uct_tcp_conn_send(uct_tcp_iface_t *iface, uct_tcp_conn_t *conn,
+                               const struct iovec *iov, int iovcnt,
+                               size_t length, int zcopy,
+                               uct_completion_t *comp)
+{
+    size_t hdr_length, sent;
+    ssize_t ret, zcopy_ret;
+    uct_tcp_op_t *op;
+    void *ptr;
+
+    if (ucs_unlikely(conn->status != UCS_OK)) {
+        return conn->status;
+    }
+
+    /* zero-copy sends complete in order: a send which is copied while previous
+     * ones wait for the kernel completes together with them */
+    op = NULL;
+    if (zcopy && (!ucs_queue_is_empty(&conn->zcopy_ops) ||
+                  (conn->zcopy_enabled &&
+                   (length >= iface->config.zcopy_thresh)))) {
+        op = ucs_mpool_get(&iface->op_mp);
+        if (op == NULL) {
+            return UCS_ERR_NO_RESOURCE;
+        }
+    }
+
+    zcopy_ret = 0;
+    if (uct_tcp_conn_tx_busy(conn)) {
+        /* keep the order of the stream: the message is batched with the
+         * unsent data, and the buffers can be reused */
+        ptr = uct_tcp_conn_tx_get(iface, conn, length);
+        if (ptr == NULL) {
+            ret = UCS_ERR_NO_RESOURCE;
+            goto err_put_op;
+        }
+
+        uct_tcp_iov_copy(ptr, iov, iovcnt, 0, length);
+        conn->tx.length += length;
+        goto out;
+    }
+
+#ifdef MSG_ZEROCOPY
+    if ((op != NULL) && conn->zcopy_enabled &&
+        (length >= iface->config.zcopy_thresh)) {
+        /* the kernel reads the pages of a zero-copy send until the data is
+         * transmitted, so only the payload, which is the last entry, is not
+         * copied: the headers may be on the stack of the caller */
+        hdr_length = length - iov[iovcnt - 1].iov_len;
+        ret        = uct_tcp_conn_sendv(conn, iov, iovcnt - 1, 0);
+        if (ret == hdr_length) {
+            zcopy_ret = uct_tcp_conn_sendv(conn, &iov[iovcnt - 1], 1,
+                                           MSG_ZEROCOPY);
+            ret       = (zcopy_ret < 0) ? zcopy_ret : (ret + zcopy_ret);
+        }
+    } else
+#endif
+    {
+        ret = uct_tcp_conn_sendv(conn, iov, iovcnt, 0);
+    }
+
+    if (ret < 0) {
+        goto err_put_op;
+    }
+
+    sent = ret;
+    if (sent < length) {
+        /* the rest of the message is sent when the socket is ready */
+        uct_tcp_iov_copy(conn->tx.data, iov, iovcnt, sent, length - sent);
+        conn->tx.length = length - sent;
+        uct_tcp_conn_update_events(iface, conn);
+    }
+
+out:
+    if (op == NULL) {
+        return UCS_OK;
+    }
+
+    if (zcopy_ret > 0) {
+        /* the kernel notifies when it does not use the buffer anymore */
+        op->sn = conn->zcopy_sn++;
+    } else if (!ucs_queue_is_empty(&conn->zcopy_ops)) {
+        /* nothing was sent from the user buffer, but a previous send was */
+        op->sn = conn->zcopy_sn - 1;
+    } else {
+        ucs_mpool_put(op);
+        return UCS_OK;
+    }
+
+    op->comp = comp;
+    ucs_queue_push(&conn->zcopy_ops, &op->queue);
+    return UCS_INPROGRESS;
+
+err_put_op:
+    if (op != NULL) {
+        ucs_mpool_put(op);
+    }
+    return ret;
+}
+
+ucs_status_t uct_tcp_conn_progress_tx(uct_tcp_iface_t *iface,
+                                      uct_tcp_conn_t *conn)
+{
+    ucs_status_t status;
+    unsigned count;
+    socklen_t optlen;
+    int error;
+
+    if (conn->connecting) {
+        optlen = sizeof(error);
+        if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &error, &optlen) < 0) {
+            ucs_error("getsockopt(SO_ERROR) failed: %m");
+            return UCS_ERR_IO_ERROR;
+        }
+
+        if (error != 0) {
+            ucs_error("failed to connect tcp socket %d: %s", conn->fd,
+                      strerror(error));
+            return UCS_ERR_UNREACHABLE;
+        }
+
+        conn->connecting = 0;
+    }
+
+    if (uct_tcp_conn_tx_busy(conn)) {
+        status = uct_tcp_conn_flush_tx(iface, conn);
+    } else {
+        status = uct_tcp_conn_update_events(iface, conn);
+    }
+    if ((status != UCS_OK) || uct_tcp_conn_tx_busy(conn)) {
+        return status;
+    }
+
+    /* there is room for new messages */
+    if (conn->ep != NULL) {
+        uct_tcp_ep_tx_resumed(conn->ep);
+    }
+    if (conn->rx_blocked) {
+        conn->rx_blocked = 0;
+        return uct_tcp_conn_process_rx(iface, conn, &count);
+    }
+    return UCS_OK;
+}
+
+static void uct_tcp_conn_zcopy_completed(uct_tcp_iface_t *iface,
+                                         uct_tcp_conn_t *conn, uint32_t last_sn)
+{
+    uct_tcp_op_t *op;
+
+    /* notifications cover ranges of sends, which complete in order */
+    ucs_queue_for_each_extract(op, &conn->zcopy_ops, queue,
+                               (int32_t)(op->sn - last_sn) <= 0) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, UCS_OK);
+        }
+        ucs_mpool_put(op);
+    }
+}
+
+void uct_tcp_conn_progress_errqueue(uct_tcp_iface_t *iface,
+                                    uct_tcp_conn_t *conn)
+{
+    char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+    struct sock_extended_err *serr;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(conn->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno != EAGAIN) {
+                ucs_debug("recvmsg(fd=%d, MSG_ERRQUEUE) failed: %m", conn->fd);
+            }
+            return;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if ((cmsg->cmsg_level != SOL_IP) ||
+                (cmsg->cmsg_type != IP_RECVERR)) {
+                continue;
+            }
+
+            serr = (struct sock_extended_err*)CMSG_DATA(cmsg);
+            if ((serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) ||
+                (serr->ee_errno != 0)) {
+                continue;
+            }
+
+            uct_tcp_conn_zcopy_completed(iface, conn, serr->ee_data);
+#ifdef SO_EE_CODE_ZEROCOPY_COPIED
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                /* the kernel copied the data anyway (e.g on loopback), so
+                 * waiting for notifications only adds overhead */
+                ucs_debug("tcp socket %d: zero-copy sends are copied, "
+                          "disabling them", conn->fd);
+                conn->zcopy_enabled = 0;
+            }
+#endif
+        }
+    }
+}
+
+static ucs_status_t uct_tcp_conn_invoke_am(uct_tcp_iface_t *iface,
+                                           uint8_t am_id, void *payload,
+                                           size_t length)
+{
+    uct_am_recv_desc_t *desc;
+    ucs_status_t status;
+    void *rx_desc, *data;
+
+    desc = ucs_mpool_get(&iface->rx_desc_mp);
+    if (desc == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    /* the handler may keep the descriptor, so the message is copied to it */
+    rx_desc = desc + 1;
+    data    = rx_desc + iface->rx_headroom;
+    memcpy(data, payload, length);
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, am_id, data,
+                       length, "RX: AM");
+
+    status = uct_iface_invoke_am(&iface->super, am_id, data, length, rx_desc);
+    if (status == UCS_OK) {
+        ucs_mpool_put(desc);
+    } else {
+        uct_recv_desc_iface(rx_desc) = &iface->super.super;
+    }
+    return UCS_OK;
+}
+
+/* Check that a remote memory access is inside a region registered with the
+ * key in the request */
+static ucs_status_t uct_tcp_conn_check_access(uct_tcp_iface_t *iface,
+                                              uct_tcp_conn_t *conn,
+                                              const uct_tcp_rma_hdr_t *rma,
+                                              uint64_t length)
+{
+    /* zero-length accesses do not touch memory, and have no key */
+    if ((length > 0) &&
+        !uct_sock_pd_is_accessible(iface->super.pd, rma->rkey, rma->address,
+                                   length)) {
+        ucs_error("tcp socket %d: access to 0x%"PRIx64" length %"PRIu64
+                  " with rkey 0x%"PRIx64" is outside of registered memory",
+                  conn->fd, rma->address, length, rma->rkey);
+        return UCS_ERR_INVALID_ADDR;
+    }
+
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_conn_handle_msg(uct_tcp_iface_t *iface,
+                                            uct_tcp_conn_t *conn,
+                                            uct_tcp_hdr_t *hdr)
+{
+    uct_tcp_rma_hdr_t *rma = (uct_tcp_rma_hdr_t*)(hdr + 1);
+    struct iovec iov[2];
+    uct_tcp_hdr_t reply;
+    ucs_status_t status;
+
+    switch (hdr->am_id) {
+    case UCT_TCP_MSG_PUT:
+        if (hdr->length < sizeof(*rma)) {
+            goto err_length;
+        }
+
+        status = uct_tcp_conn_check_access(iface, conn, rma,
+                                           hdr->length - sizeof(*rma));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        memcpy((void*)rma->address, rma + 1, hdr->length - sizeof(*rma));
+        return UCS_OK;
+    case UCT_TCP_MSG_GET_REQ:
+        if ((hdr->length != sizeof(*rma)) ||
+            (rma->length > iface->config.seg_size)) {
+            goto err_length;
+        }
+
+        status = uct_tcp_conn_check_access(iface, conn, rma, rma->length);
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        /* the data is sent from the requested memory */
+        reply.am_id     = UCT_TCP_MSG_GET_REP;
+        reply.length    = rma->length;
+        iov[0].iov_base = &reply;
+        iov[0].iov_len  = sizeof(reply);
+        iov[1].iov_base = (void*)rma->address;
+        iov[1].iov_len  = rma->length;
+        return uct_tcp_conn_send(iface, conn, iov, 2,
+                                 sizeof(reply) + rma->length, 0, NULL);
+    case UCT_TCP_MSG_FLUSH_REQ:
+        /* all messages before the request were handled */
+        reply.am_id     = UCT_TCP_MSG_FLUSH_REP;
+        reply.length    = 0;
+        iov[0].iov_base = &reply;
+        iov[0].iov_len  = sizeof(reply);
+        return uct_tcp_conn_send(iface, conn, iov, 1, sizeof(reply), 0,
+                                 NULL);
+    case UCT_TCP_MSG_GET_REP:
+    case UCT_TCP_MSG_FLUSH_REP:
+        /* replies are sent only to the sockets of endpoints */
+        if (conn->ep == NULL) {
+            ucs_error("tcp socket %d: unexpected reply type %d", conn->fd,
+                      hdr->am_id);
+            return UCS_ERR_IO_ERROR;
+        }
+        return uct_tcp_ep_handle_reply(conn->ep, hdr->am_id, hdr + 1,
+                                       hdr->length);
+    default:
+        if (hdr->am_id >= UCT_AM_ID_MAX) {
+            ucs_error("tcp socket %d: invalid message type %d", conn->fd,
+                      hdr->am_id);
+            return UCS_ERR_IO_ERROR;
+        }
+        if (hdr->length > iface->config.seg_size) {
+            goto err_length;
+        }
+        return uct_tcp_conn_invoke_am(iface, hdr->am_id, hdr + 1, hdr->length);
+    }
+
+err_length:
+    ucs_error("tcp socket %d: invalid length %u of message type %d", conn->fd,
+              hdr->length, hdr->am_id);
+    return UCS_ERR_IO_ERROR;
+}
+
+ucs_status_t uct_tcp_conn_process_rx(uct_tcp_iface_t *iface,
+                                     uct_tcp_conn_t *conn, unsigned *count_p)
+{
+    uct_tcp_buf_t *rx = &conn->rx;
+    ucs_status_t status;
+    uct_tcp_hdr_t *hdr;
+    unsigned count;
+    size_t length;
+
+    count  = 0;
+    status = UCS_OK;
+    while (rx->length - rx->offset >= sizeof(*hdr)) {
+        hdr = rx->data + rx->offset;
+        if (hdr->length > sizeof(uct_tcp_rma_hdr_t) + iface->config.seg_size) {
+            /* the message would never fit in the receive buffer */
+            ucs_error("tcp socket %d: message length %u is too large", conn->fd,
+                      hdr->length);
+            status = UCS_ERR_IO_ERROR;
+            break;
+        }
+
+        length = sizeof(*hdr) + hdr->length;
+        if (rx->length - rx->offset < length) {
+            break;
+        }
+
+        status = uct_tcp_conn_handle_msg(iface, conn, hdr);
+        if (status == UCS_ERR_NO_RESOURCE) {
+            /* a reply could not be sent, or there is no receive descriptor,
+             * so the next messages wait and the peer is throttled by the
+             * stream */
+            if (uct_tcp_conn_tx_busy(conn)) {
+                conn->rx_blocked = 1;
+            } else {
+                iface->rx_stalled = 1;
+            }
+            status = UCS_OK;
+            break;
+        } else if (status != UCS_OK) {
+            break;
+        }
+
+        rx->offset += length;
+        ++count;
+    }
+
+    *count_p = count;
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    /* move the partial message to the beginning of the buffer */
+    if (rx->offset == rx->length) {
+        rx->offset = 0;
+        rx->length = 0;
+    } else if (rx->offset > 0) {
+        memmove(rx->data, rx->data + rx->offset, rx->length - rx->offset);
+        rx->length -= rx->offset;
+        rx->offset  = 0;
+    }
+
+    return UCS_OK;
+}
+
+ucs_status_t uct_tcp_conn_progress_rx(uct_tcp_iface_t *iface,
+                                      uct_tcp_conn_t *conn, unsigned *count_p)
+{
+    uct_tcp_buf_t *rx = &conn->rx;
+    ssize_t ret;
+
+    *count_p = 0;
+    if (conn->rx_blocked || (rx->length == iface->config.buf_size)) {
+        return UCS_OK;
+    }
+
+    ret = recv(conn->fd, rx->data + rx->length,
+               iface->config.buf_size - rx->length, MSG_DONTWAIT);
+    if (ret == 0) {
+        ucs_debug("tcp socket %d was closed by the peer", conn->fd);
+        return UCS_ERR_CANCELED;
+    } else if (ret < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            return UCS_OK;
+        }
+        ucs_debug("recv(fd=%d) failed: %m", conn->fd);
+        return UCS_ERR_IO_ERROR;
+    }
+
+    rx->length += ret;
+    return uct_tcp_conn_process_rx(iface, conn, count_p);
+}
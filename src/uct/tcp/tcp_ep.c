@@ -0,0 +1,572 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tcp.h"
+
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/debug/log.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <unistd.h>
+
+
+static UCS_CLASS_INIT_FUNC(uct_tcp_ep_t, uct_iface_t *tl_iface,
+                           const uct_device_addr_t *dev_addr,
+                           const uct_iface_addr_t *iface_addr)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    const uct_tcp_device_addr_t *tcp_addr = (const void*)dev_addr;
+    struct sockaddr_in dest_addr;
+    ucs_status_t status;
+    int connecting;
+    int fd;
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super);
+
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_addr   = tcp_addr->in_addr;
+    dest_addr.sin_port   = *(const in_port_t*)iface_addr;
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ucs_error("socket() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    /* the connection is completed by progress, and messages which are sent
+     * before it is established are buffered */
+    connecting = 0;
+    if (connect(fd, (struct sockaddr*)&dest_addr, sizeof(dest_addr)) < 0) {
+        if (errno != EINPROGRESS) {
+            ucs_error("connect(%s:%d) failed: %m",
+                      inet_ntoa(dest_addr.sin_addr), ntohs(dest_addr.sin_port));
+            status = UCS_ERR_UNREACHABLE;
+            goto err_close;
+        }
+        connecting = 1;
+    }
+
+    status = uct_tcp_conn_init(iface, &self->conn, fd, self, connecting);
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    ucs_arbiter_group_init(&self->arb_group);
+    ucs_queue_head_init(&self->get_ops);
+    self->unacked    = 0;
+    self->flush_reqs = 0;
+    ucs_list_add_tail(&iface->ep_list, &self->list);
+
+    ucs_debug("tcp ep %p: socket %d to %s:%d", self, fd,
+              inet_ntoa(dest_addr.sin_addr), ntohs(dest_addr.sin_port));
+    return UCS_OK;
+
+err_close:
+    close(fd);
+    return status;
+}
+
+static void uct_tcp_ep_cancel_get_ops(uct_tcp_ep_t *ep, ucs_status_t status)
+{
+    uct_tcp_op_t *op;
+
+    ucs_queue_for_each_extract(op, &ep->get_ops, queue, 1) {
+        if (op->comp != NULL) {
+            uct_invoke_completion(op->comp, status);
+        }
+        ucs_mpool_put(op);
+    }
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_tcp_ep_t)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    uct_tcp_ep_cancel_get_ops(self, UCS_ERR_CANCELED);
+    ucs_list_del(&self->list);
+    uct_tcp_conn_cleanup(iface, &self->conn);
+    ucs_arbiter_group_cleanup(&self->arb_group);
+}
+
+UCS_CLASS_DEFINE(uct_tcp_ep_t, uct_base_ep_t)
+UCS_CLASS_DEFINE_NEW_FUNC(uct_tcp_ep_t, uct_ep_t, uct_iface_t*,
+                          const uct_device_addr_t *, const uct_iface_addr_t *);
+UCS_CLASS_DEFINE_DELETE_FUNC(uct_tcp_ep_t, uct_ep_t);
+
+
+#define uct_tcp_trace_data(_remote_addr, _fmt, ...) \
+     ucs_trace_data(_fmt " to 0x%"PRIx64, ## __VA_ARGS__, (_remote_addr))
+
+void uct_tcp_ep_tx_resumed(uct_tcp_ep_t *ep)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    ucs_arbiter_group_schedule(&iface->arbiter, &ep->arb_group);
+}
+
+void uct_tcp_ep_set_failed(uct_tcp_ep_t *ep, ucs_status_t status)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+
+    /* the peer does not reply anymore, and new operations fail */
+    uct_tcp_conn_set_failed(iface, &ep->conn, status);
+    uct_tcp_ep_cancel_get_ops(ep, status);
+    ep->unacked    = 0;
+    ep->flush_reqs = 0;
+}
+
+ucs_status_t uct_tcp_ep_handle_reply(uct_tcp_ep_t *ep, uint8_t am_id,
+                                     void *data, size_t length)
+{
+    uct_tcp_op_t *op;
+
+    if (am_id == UCT_TCP_MSG_FLUSH_REP) {
+        if ((ep->flush_reqs == 0) || (length != 0)) {
+            goto err;
+        }
+        --ep->flush_reqs;
+        return UCS_OK;
+    }
+
+    /* replies arrive in the order of the requests */
+    if (ucs_queue_is_empty(&ep->get_ops)) {
+        goto err;
+    }
+
+    op = ucs_queue_head_elem_non_empty(&ep->get_ops, uct_tcp_op_t, queue);
+    if (length != op->length) {
+        goto err;
+    }
+
+    ucs_queue_pull_non_empty(&ep->get_ops);
+    if (op->unpack_cb != NULL) {
+        op->unpack_cb(op->arg, data, length);
+    } else {
+        memcpy(op->arg, data, length);
+    }
+
+    if (op->comp != NULL) {
+        uct_invoke_completion(op->comp, UCS_OK);
+    }
+    ucs_mpool_put(op);
+    return UCS_OK;
+
+err:
+    ucs_error("tcp ep %p: unexpected reply type %d length %zu", ep, am_id,
+              length);
+    return UCS_ERR_IO_ERROR;
+}
+
+static ucs_status_t uct_tcp_ep_put(uct_tcp_ep_t *ep, const void *buffer,
+                                   size_t length, uint64_t remote_addr,
+                                   uct_rkey_t rkey, int zcopy,
+                                   uct_completion_t *comp)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_rma_hdr_t rma;
+    struct iovec iov[3];
+    ucs_status_t status;
+    uct_tcp_hdr_t hdr;
+
+    UCT_CHECK_LENGTH(length, iface->config.seg_size, "put");
+
+    hdr.am_id       = UCT_TCP_MSG_PUT;
+    hdr.length      = sizeof(rma) + length;
+    rma.address     = remote_addr;
+    rma.length      = 0;
+    rma.rkey        = rkey;
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len  = sizeof(hdr);
+    iov[1].iov_base = &rma;
+    iov[1].iov_len  = sizeof(rma);
+    iov[2].iov_base = (void*)buffer;
+    iov[2].iov_len  = length;
+
+    status = uct_tcp_conn_send(iface, &ep->conn, iov, 3,
+                               sizeof(hdr) + hdr.length, zcopy, comp);
+    if (status >= 0) {
+        /* the data is written by the peer, so flush waits for it */
+        ep->unacked = 1;
+    }
+    return status;
+}
+
+ucs_status_t uct_tcp_ep_put_short(uct_ep_h tl_ep, const void *buffer,
+                                  unsigned length, uint64_t remote_addr,
+                                  uct_rkey_t rkey)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    ucs_status_t status;
+
+    status = uct_tcp_ep_put(ep, buffer, length, remote_addr, rkey, 0, NULL);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uct_tcp_trace_data(remote_addr, "PUT_SHORT [buffer %p size %u]", buffer,
+                       length);
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, SHORT, length);
+    return UCS_OK;
+}
+
+ssize_t uct_tcp_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
+                             void *arg, uint64_t remote_addr, uct_rkey_t rkey)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    uct_tcp_rma_hdr_t *rma;
+    ucs_status_t status;
+    uct_tcp_hdr_t *hdr;
+    size_t length;
+
+    if (ucs_unlikely(ep->conn.status != UCS_OK)) {
+        return ep->conn.status;
+    }
+
+    /* the data is packed directly to the socket buffer */
+    hdr = uct_tcp_conn_tx_get(iface, &ep->conn, sizeof(*hdr) + sizeof(*rma) +
+                              iface->config.seg_size);
+    if (hdr == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    rma          = (uct_tcp_rma_hdr_t*)(hdr + 1);
+    length       = pack_cb(rma + 1, arg);
+    hdr->am_id   = UCT_TCP_MSG_PUT;
+    hdr->length  = sizeof(*rma) + length;
+    rma->address = remote_addr;
+    rma->length  = 0;
+    rma->rkey    = rkey;
+
+    status = uct_tcp_conn_tx_commit(iface, &ep->conn, sizeof(*hdr) + hdr->length);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    ep->unacked = 1;
+    uct_tcp_trace_data(remote_addr, "PUT_BCOPY [arg %p size %zu]", arg, length);
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, BCOPY, length);
+    return length;
+}
+
+ucs_status_t uct_tcp_ep_put_zcopy(uct_ep_h tl_ep, const void *buffer,
+                                  size_t length, uct_mem_h memh,
+                                  uint64_t remote_addr, uct_rkey_t rkey,
+                                  uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    ucs_status_t status;
+
+    status = uct_tcp_ep_put(ep, buffer, length, remote_addr, rkey, 1, comp);
+    if (status < 0) {
+        return status;
+    }
+
+    uct_tcp_trace_data(remote_addr, "PUT_ZCOPY [buffer %p size %zu]", buffer,
+                       length);
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, ZCOPY, length);
+    return status;
+}
+
+static ucs_status_t uct_tcp_ep_get(uct_tcp_ep_t *ep,
+                                   uct_unpack_callback_t unpack_cb, void *arg,
+                                   size_t length, uint64_t remote_addr,
+                                   uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_tcp_iface_t);
+    uct_tcp_rma_hdr_t rma;
+    struct iovec iov[2];
+    ucs_status_t status;
+    uct_tcp_hdr_t hdr;
+    uct_tcp_op_t *op;
+
+    UCT_CHECK_LENGTH(length, iface->config.seg_size, "get");
+
+    op = ucs_mpool_get(&iface->op_mp);
+    if (op == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    /* the peer replies with the data */
+    hdr.am_id       = UCT_TCP_MSG_GET_REQ;
+    hdr.length      = sizeof(rma);
+    rma.address     = remote_addr;
+    rma.length      = length;
+    rma.rkey        = rkey;
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len  = sizeof(hdr);
+    iov[1].iov_base = &rma;
+    iov[1].iov_len  = sizeof(rma);
+
+    status = uct_tcp_conn_send(iface, &ep->conn, iov, 2,
+                               sizeof(hdr) + sizeof(rma), 0, NULL);
+    if (status != UCS_OK) {
+        ucs_mpool_put(op);
+        return status;
+    }
+
+    op->comp      = comp;
+    op->length    = length;
+    op->unpack_cb = unpack_cb;
+    op->arg       = arg;
+    ucs_queue_push(&ep->get_ops, &op->queue);
+    return UCS_INPROGRESS;
+}
+
+ucs_status_t uct_tcp_ep_get_bcopy(uct_ep_h tl_ep, uct_unpack_callback_t unpack_cb,
+                                  void *arg, size_t length,
+                                  uint64_t remote_addr, uct_rkey_t rkey,
+                                  uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    ucs_status_t status;
+
+    status = uct_tcp_ep_get(ep, unpack_cb, arg, length, remote_addr, rkey,
+                            comp);
+    if (status < 0) {
+        return status;
+    }
+
+    uct_tcp_trace_data(remote_addr, "GET_BCOPY [length %zu]", length);
+    UCT_TL_EP_STAT_OP(&ep->super, GET, BCOPY, length);
+    return status;
+}
+
+ucs_status_t uct_tcp_ep_get_zcopy(uct_ep_h tl_ep, void *buffer, size_t length,
+                                  uct_mem_h memh, uint64_t remote_addr,
+                                  uct_rkey_t rkey, uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    ucs_status_t status;
+
+    status = uct_tcp_ep_get(ep, NULL, buffer, length, remote_addr, rkey,
+                            comp);
+    if (status < 0) {
+        return status;
+    }
+
+    uct_tcp_trace_data(remote_addr, "GET_ZCOPY [buffer %p size %zu]", buffer,
+                       length);
+    UCT_TL_EP_STAT_OP(&ep->super, GET, ZCOPY, length);
+    return status;
+}
+
+ucs_status_t uct_tcp_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
+                                 const void *payload, unsigned length)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    struct iovec iov[3];
+    ucs_status_t status;
+    uct_tcp_hdr_t hdr;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_CHECK_LENGTH(length + sizeof(header), iface->config.seg_size,
+                     "am_short");
+
+    hdr.am_id       = id;
+    hdr.length      = sizeof(header) + length;
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len  = sizeof(hdr);
+    iov[1].iov_base = &header;
+    iov[1].iov_len  = sizeof(header);
+    iov[2].iov_base = (void*)payload;
+    iov[2].iov_len  = length;
+
+    status = uct_tcp_conn_send(iface, &ep->conn, iov, 3,
+                               sizeof(hdr) + hdr.length, 0, NULL);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, &header,
+                       sizeof(header), "TX: AM_SHORT [payload %p length %u]",
+                       payload, length);
+    UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, hdr.length);
+    return UCS_OK;
+}
+
+ssize_t uct_tcp_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id,
+                            uct_pack_callback_t pack_cb, void *arg)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    ucs_status_t status;
+    uct_tcp_hdr_t *hdr;
+    size_t length;
+
+    UCT_CHECK_AM_ID(id);
+
+    if (ucs_unlikely(ep->conn.status != UCS_OK)) {
+        return ep->conn.status;
+    }
+
+    /* the message is packed directly to the socket buffer */
+    hdr = uct_tcp_conn_tx_get(iface, &ep->conn,
+                              sizeof(*hdr) + iface->config.seg_size);
+    if (hdr == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    length      = pack_cb(hdr + 1, arg);
+    hdr->am_id  = id;
+    hdr->length = length;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, hdr + 1,
+                       length, "TX: AM_BCOPY");
+
+    status = uct_tcp_conn_tx_commit(iface, &ep->conn, sizeof(*hdr) + length);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
+    return length;
+}
+
+ucs_status_t uct_tcp_ep_am_zcopy(uct_ep_h tl_ep, uint8_t id, const void *header,
+                                 unsigned header_length, const void *payload,
+                                 size_t length, uct_mem_h memh,
+                                 uct_completion_t *comp)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    struct iovec iov[3];
+    ucs_status_t status;
+    uct_tcp_hdr_t hdr;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_CHECK_LENGTH(header_length + length, iface->config.seg_size,
+                     "am_zcopy");
+
+    /* the header and the payload are gathered by the socket */
+    hdr.am_id       = id;
+    hdr.length      = header_length + length;
+    iov[0].iov_base = &hdr;
+    iov[0].iov_len  = sizeof(hdr);
+    iov[1].iov_base = (void*)header;
+    iov[1].iov_len  = header_length;
+    iov[2].iov_base = (void*)payload;
+    iov[2].iov_len  = length;
+
+    status = uct_tcp_conn_send(iface, &ep->conn, iov, 3,
+                               sizeof(hdr) + hdr.length, 1, comp);
+    if (status < 0) {
+        return status;
+    }
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, header,
+                       header_length, "TX: AM_ZCOPY [%p size %zu]", payload,
+                       length);
+    UCT_TL_EP_STAT_OP(&ep->super, AM, ZCOPY, header_length + length);
+    return status;
+}
+
+ucs_status_t uct_tcp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+
+    /* the request is dispatched when the socket buffer is sent */
+    if (!uct_tcp_conn_tx_busy(&ep->conn)) {
+        return UCS_ERR_BUSY;
+    }
+
+    UCS_STATIC_ASSERT(sizeof(ucs_arbiter_elem_t) <= UCT_PENDING_REQ_PRIV_LEN);
+
+    ucs_arbiter_elem_init((ucs_arbiter_elem_t *)req->priv);
+    ucs_arbiter_group_push_elem(&ep->arb_group, (ucs_arbiter_elem_t*)req->priv);
+    return UCS_OK;
+}
+
+ucs_arbiter_cb_result_t uct_tcp_ep_process_pending(ucs_arbiter_t *arbiter,
+                                                   ucs_arbiter_elem_t *elem,
+                                                   void *arg)
+{
+    uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    uct_tcp_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem),
+                                        uct_tcp_ep_t, arb_group);
+    ucs_status_t status;
+
+    status = req->func(req);
+    ucs_trace_data("progress pending request %p returned %s", req,
+                   ucs_status_string(status));
+
+    if (status == UCS_OK) {
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    } else if (status == UCS_INPROGRESS) {
+        return UCS_ARBITER_CB_RESULT_NEXT_GROUP;
+    } else if (uct_tcp_conn_tx_busy(&ep->conn)) {
+        /* scheduled again when the socket buffer is sent */
+        return UCS_ARBITER_CB_RESULT_DESCHED_GROUP;
+    } else {
+        return UCS_ARBITER_CB_RESULT_RESCHED_GROUP;
+    }
+}
+
+static ucs_arbiter_cb_result_t uct_tcp_ep_arbiter_purge_cb(ucs_arbiter_t *arbiter,
+                                                           ucs_arbiter_elem_t *elem,
+                                                           void *arg)
+{
+    uct_pending_req_t *req = ucs_container_of(elem, uct_pending_req_t, priv);
+    uct_pending_callback_t cb = arg;
+
+    cb(req);
+    return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+}
+
+void uct_tcp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+
+    ucs_arbiter_group_purge(&iface->arbiter, &ep->arb_group,
+                            uct_tcp_ep_arbiter_purge_cb, cb);
+}
+
+ucs_status_t uct_tcp_ep_flush(uct_ep_h tl_ep)
+{
+    uct_tcp_ep_t *ep = ucs_derived_of(tl_ep, uct_tcp_ep_t);
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_tcp_iface_t);
+    struct iovec iov;
+    uct_tcp_hdr_t hdr;
+
+    if (ucs_unlikely(ep->conn.status != UCS_OK)) {
+        return ep->conn.status;
+    }
+
+    /* the peer acknowledges the request after it wrote the data of all
+     * previous puts */
+    if (ep->unacked) {
+        hdr.am_id    = UCT_TCP_MSG_FLUSH_REQ;
+        hdr.length   = 0;
+        iov.iov_base = &hdr;
+        iov.iov_len  = sizeof(hdr);
+        if (uct_tcp_conn_send(iface, &ep->conn, &iov, 1, sizeof(hdr), 0,
+                              NULL) == UCS_OK) {
+            ep->unacked = 0;
+            ++ep->flush_reqs;
+        }
+    }
+
+    if (ep->unacked || (ep->flush_reqs > 0) ||
+        uct_tcp_conn_tx_busy(&ep->conn) ||
+        !ucs_queue_is_empty(&ep->conn.zcopy_ops) ||
+        !ucs_queue_is_empty(&ep->get_ops))
+    {
+        UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+        return UCS_INPROGRESS;
+    }
+
+    UCT_TL_EP_STAT_FLUSH(&ep->super);
+    return UCS_OK;
+}
@@ -0,0 +1,617 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#define _GNU_SOURCE
+#include "tcp.h"
+
+#include <uct/base/uct_netif.h>
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/debug/log.h>
+#include <ucs/sys/sys.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+
+
+UCT_PD_REGISTER_TL(&uct_tcp_pd_component, &uct_tcp_tl);
+
+static ucs_config_field_t uct_tcp_iface_config_table[] = {
+    {"", "ALLOC=huge,mmap,heap", NULL,
+    ucs_offsetof(uct_tcp_iface_config_t, super),
+    UCS_CONFIG_TYPE_TABLE(uct_iface_config_table)},
+
+    {"SEG_SIZE", "64k",
+     "Maximal size of a message. Larger transfers are split to messages of this\n"
+     "size, and every socket buffers up to two of them.",
+     ucs_offsetof(uct_tcp_iface_config_t, seg_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"ZCOPY_THRESH", "32k",
+     "Minimal size of a zero-copy send to use MSG_ZEROCOPY, if the kernel supports\n"
+     "it. The kernel does not copy the data, but it pins the pages and notifies when\n"
+     "the send is complete, which is slower than a copy for small messages.\n"
+     "\"inf\" disables MSG_ZEROCOPY.",
+     ucs_offsetof(uct_tcp_iface_config_t, zcopy_thresh), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"SNDBUF", "auto",
+     "Socket send buffer size. \"auto\" keeps the system default.",
+     ucs_offsetof(uct_tcp_iface_config_t, sndbuf), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"RCVBUF", "auto",
+     "Socket receive buffer size. \"auto\" keeps the system default.",
+     ucs_offsetof(uct_tcp_iface_config_t, rcvbuf), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"NODELAY", "y",
+     "Set TCP_NODELAY on the sockets, so small messages are sent immediately\n"
+     "instead of being delayed by the kernel. Messages which are posted while\n"
+     "the socket is busy are batched to a single send regardless.",
+     ucs_offsetof(uct_tcp_iface_config_t, nodelay), UCS_CONFIG_TYPE_BOOL},
+
+    UCT_IFACE_MPOOL_CONFIG_FIELDS("RX_", -1, 16, "receive",
+                                  ucs_offsetof(uct_tcp_iface_config_t, mp), ""),
+
+    {NULL}
+};
+
+static ucs_mpool_ops_t uct_tcp_op_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
+static ucs_status_t uct_tcp_iface_get_device_address(uct_iface_t *tl_iface,
+                                                     uct_device_addr_t *addr)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    uct_tcp_device_addr_t *tcp_addr = (uct_tcp_device_addr_t*)addr;
+
+    tcp_addr->guid    = iface->guid;
+    tcp_addr->in_addr = iface->addr.sin_addr;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_iface_get_address(uct_iface_t *tl_iface,
+                                              uct_iface_addr_t *addr)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+
+    *(in_port_t*)addr = iface->addr.sin_port;
+    return UCS_OK;
+}
+
+static int uct_tcp_iface_is_reachable(uct_iface_t *tl_iface,
+                                      const uct_device_addr_t *addr)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    const uct_tcp_device_addr_t *tcp_addr = (const void*)addr;
+
+    return uct_netif_is_reachable(iface->addr.sin_addr, iface->netmask,
+                                  iface->guid, tcp_addr->in_addr,
+                                  tcp_addr->guid);
+}
+
+static ucs_status_t uct_tcp_iface_query(uct_iface_h tl_iface,
+                                        uct_iface_attr_t *iface_attr)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    size_t seg_size = iface->config.seg_size;
+
+    memset(iface_attr, 0, sizeof(uct_iface_attr_t));
+
+    iface_attr->cap.put.max_short      = seg_size;
+    iface_attr->cap.put.max_bcopy      = seg_size;
+    iface_attr->cap.put.max_zcopy      = seg_size;
+    iface_attr->cap.get.max_bcopy      = seg_size;
+    iface_attr->cap.get.max_zcopy      = seg_size;
+    iface_attr->cap.am.max_short       = seg_size;
+    iface_attr->cap.am.max_bcopy       = seg_size;
+    iface_attr->cap.am.max_zcopy       = seg_size;
+    iface_attr->cap.am.max_hdr         = seg_size;
+    iface_attr->iface_addr_len         = sizeof(in_port_t);
+    iface_attr->device_addr_len        = sizeof(uct_tcp_device_addr_t);
+    iface_attr->ep_addr_len            = 0;
+    iface_attr->cap.flags              = UCT_IFACE_FLAG_PUT_SHORT        |
+                                         UCT_IFACE_FLAG_PUT_BCOPY        |
+                                         UCT_IFACE_FLAG_PUT_ZCOPY        |
+                                         UCT_IFACE_FLAG_GET_BCOPY        |
+                                         UCT_IFACE_FLAG_GET_ZCOPY        |
+                                         UCT_IFACE_FLAG_AM_SHORT         |
+                                         UCT_IFACE_FLAG_AM_BCOPY         |
+                                         UCT_IFACE_FLAG_AM_ZCOPY         |
+                                         UCT_IFACE_FLAG_PENDING          |
+                                         UCT_IFACE_FLAG_AM_CB_SYNC       |
+                                         UCT_IFACE_FLAG_CONNECT_TO_IFACE |
+                                         UCT_IFACE_FLAG_WAKEUP;
+
+    /* every message costs a system call on both sides */
+    iface_attr->latency                = 10e-6;
+    iface_attr->bandwidth              = 100 * 1024.0 * 1024.0;
+    iface_attr->overhead               = 10e-6;
+    return UCS_OK;
+}
+
+static void uct_tcp_iface_release_am_desc(uct_iface_t *tl_iface, void *desc)
+{
+    ucs_mpool_put((uct_am_recv_desc_t*)desc - 1);
+}
+
+static void uct_tcp_iface_conn_close(uct_tcp_iface_t *iface,
+                                     uct_tcp_conn_t *conn)
+{
+    ucs_list_del(&conn->list);
+    uct_tcp_conn_cleanup(iface, conn);
+    ucs_free(conn);
+}
+
+/* Close a socket which failed, or which was closed by the peer */
+static void uct_tcp_iface_conn_failed(uct_tcp_iface_t *iface,
+                                      uct_tcp_conn_t *conn, ucs_status_t status)
+{
+    if (conn->ep == NULL) {
+        uct_tcp_iface_conn_close(iface, conn);
+    } else {
+        /* the endpoint fails its outstanding operations, and the socket is
+         * closed when it is destroyed */
+        uct_tcp_ep_set_failed(conn->ep, status);
+    }
+}
+
+static void uct_tcp_iface_accept(uct_tcp_iface_t *iface)
+{
+    uct_tcp_conn_t *conn;
+    ucs_status_t status;
+    int fd;
+
+    for (;;) {
+        fd = accept4(iface->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+                ucs_error("accept() failed: %m");
+            }
+            return;
+        }
+
+        conn = ucs_malloc(sizeof(*conn), "tcp_conn");
+        if (conn == NULL) {
+            ucs_error("failed to allocate tcp connection");
+            close(fd);
+            return;
+        }
+
+        status = uct_tcp_conn_init(iface, conn, fd, NULL, 0);
+        if (status != UCS_OK) {
+            ucs_free(conn);
+            close(fd);
+            return;
+        }
+
+        ucs_list_add_tail(&iface->conn_list, &conn->list);
+        ucs_debug("tcp iface %p: accepted socket %d", iface, fd);
+    }
+}
+
+unsigned uct_tcp_iface_progress(void *arg)
+{
+    uct_tcp_iface_t *iface = arg;
+    struct epoll_event events[UCT_TCP_MAX_EVENTS];
+    unsigned count, rx_count;
+    uct_tcp_conn_t *conn, *tmp;
+    ucs_status_t status;
+    int i, nevents;
+
+    nevents = epoll_wait(iface->epfd, events, UCT_TCP_MAX_EVENTS, 0);
+    if (nevents < 0) {
+        if (errno != EINTR) {
+            ucs_error("epoll_wait() failed: %m");
+        }
+        nevents = 0;
+    }
+
+    count = 0;
+    for (i = 0; i < nevents; ++i) {
+        conn = events[i].data.ptr;
+        if (conn == NULL) {
+            uct_tcp_iface_accept(iface);
+            continue;
+        }
+
+        if (events[i].events & EPOLLERR) {
+            uct_tcp_conn_progress_errqueue(iface, conn);
+        }
+
+        if (events[i].events & EPOLLOUT) {
+            status = uct_tcp_conn_progress_tx(iface, conn);
+            if (status != UCS_OK) {
+                uct_tcp_iface_conn_failed(iface, conn, status);
+                continue;
+            }
+        }
+
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+            status = uct_tcp_conn_progress_rx(iface, conn, &rx_count);
+            count += rx_count;
+            if (status != UCS_OK) {
+                uct_tcp_iface_conn_failed(iface, conn, status);
+            }
+        }
+    }
+
+    if (iface->rx_stalled) {
+        /* retry the messages which were received before descriptors were
+         * released */
+        iface->rx_stalled = 0;
+        ucs_list_for_each_safe(conn, tmp, &iface->conn_list, list) {
+            if (conn->rx_blocked || (conn->rx.length == conn->rx.offset)) {
+                continue;
+            }
+
+            status = uct_tcp_conn_process_rx(iface, conn, &rx_count);
+            count += rx_count;
+            if (status != UCS_OK) {
+                uct_tcp_iface_conn_close(iface, conn);
+            }
+        }
+    }
+
+    count += ucs_arbiter_dispatch(&iface->arbiter, 1,
+                                  uct_tcp_ep_process_pending, NULL);
+    return count;
+}
+
+static ucs_status_t uct_tcp_iface_flush(uct_iface_h tl_iface)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    ucs_status_t status = UCS_OK;
+    uct_tcp_ep_t *ep;
+
+    ucs_list_for_each(ep, &iface->ep_list, list) {
+        if (uct_tcp_ep_flush(&ep->super.super) != UCS_OK) {
+            status = UCS_INPROGRESS;
+        }
+    }
+
+    if (status != UCS_OK) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return status;
+    }
+
+    UCT_TL_IFACE_STAT_FLUSH(&iface->super);
+    return UCS_OK;
+}
+
+/*
+ * The wakeup file descriptor is an epoll set which polls the socket epoll set
+ * of the interface in edge-triggered mode, so it is signaled by every new
+ * socket event, and not by events which were seen before the last arm.
+ */
+static ucs_status_t uct_tcp_iface_wakeup_open(uct_iface_h tl_iface,
+                                              unsigned events,
+                                              uct_wakeup_h wakeup)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(tl_iface, uct_tcp_iface_t);
+    struct epoll_event event;
+    struct epoll_event dummy;
+    ucs_status_t status;
+
+    if (iface->wakeup_efd != -1) {
+        ucs_error("tcp_iface %p already has a wakeup handle", iface);
+        return UCS_ERR_ALREADY_EXISTS;
+    }
+
+    iface->wakeup_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (iface->wakeup_efd < 0) {
+        ucs_error("eventfd() failed: %m");
+        iface->wakeup_efd = -1;
+        return UCS_ERR_IO_ERROR;
+    }
+
+    wakeup->fd = epoll_create1(EPOLL_CLOEXEC);
+    if (wakeup->fd < 0) {
+        ucs_error("epoll_create() failed: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_close_efd;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN | EPOLLET;
+    if ((epoll_ctl(wakeup->fd, EPOLL_CTL_ADD, iface->epfd, &event) < 0) ||
+        (epoll_ctl(wakeup->fd, EPOLL_CTL_ADD, iface->wakeup_efd, &event) < 0)) {
+        ucs_error("epoll_ctl(ADD) failed: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err_close_epfd;
+    }
+
+    /* events before the open are not signaled */
+    while (epoll_wait(wakeup->fd, &dummy, 1, 0) > 0);
+    return UCS_OK;
+
+err_close_epfd:
+    close(wakeup->fd);
+err_close_efd:
+    close(iface->wakeup_efd);
+    iface->wakeup_efd = -1;
+    return status;
+}
+
+static ucs_status_t uct_tcp_iface_wakeup_get_fd(uct_wakeup_h wakeup, int *fd_p)
+{
+    *fd_p = wakeup->fd;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_iface_wakeup_arm(uct_wakeup_h wakeup)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(wakeup->iface, uct_tcp_iface_t);
+    struct epoll_event dummy;
+    uint64_t value;
+
+    /* data on connections which were not accepted yet would not be signaled */
+    uct_tcp_iface_accept(iface);
+
+    /* consume the signals of previous arms */
+    if ((read(iface->wakeup_efd, &value, sizeof(value)) < 0) &&
+        (errno != EAGAIN)) {
+        ucs_error("failed to read from wakeup eventfd: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    while (epoll_wait(wakeup->fd, &dummy, 1, 0) > 0);
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_iface_wakeup_wait(uct_wakeup_h wakeup)
+{
+    struct pollfd polled = { .fd = wakeup->fd, .events = POLLIN };
+    int res;
+
+    do {
+        res = poll(&polled, 1, -1);
+    } while ((res == -1) && (errno == EINTR));
+
+    if ((res != 1) || (polled.revents != POLLIN)) {
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return uct_tcp_iface_wakeup_arm(wakeup);
+}
+
+static ucs_status_t uct_tcp_iface_wakeup_signal(uct_wakeup_h wakeup)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(wakeup->iface, uct_tcp_iface_t);
+    uint64_t value = 1;
+
+    if (write(iface->wakeup_efd, &value, sizeof(value)) < 0) {
+        ucs_error("failed to send wakeup signal: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    return UCS_OK;
+}
+
+static void uct_tcp_iface_wakeup_close(uct_wakeup_h wakeup)
+{
+    uct_tcp_iface_t *iface = ucs_derived_of(wakeup->iface, uct_tcp_iface_t);
+
+    close(wakeup->fd);
+    close(iface->wakeup_efd);
+    iface->wakeup_efd = -1;
+}
+
+static UCS_CLASS_DECLARE_DELETE_FUNC(uct_tcp_iface_t, uct_iface_t);
+
+static uct_iface_ops_t uct_tcp_iface_ops = {
+    .iface_close         = UCS_CLASS_DELETE_FUNC_NAME(uct_tcp_iface_t),
+    .iface_query         = uct_tcp_iface_query,
+    .iface_flush         = uct_tcp_iface_flush,
+    .iface_get_address   = uct_tcp_iface_get_address,
+    .iface_get_device_address = uct_tcp_iface_get_device_address,
+    .iface_is_reachable  = uct_tcp_iface_is_reachable,
+    .iface_release_am_desc = uct_tcp_iface_release_am_desc,
+    .iface_wakeup_open   = uct_tcp_iface_wakeup_open,
+    .iface_wakeup_get_fd = uct_tcp_iface_wakeup_get_fd,
+    .iface_wakeup_arm    = uct_tcp_iface_wakeup_arm,
+    .iface_wakeup_wait   = uct_tcp_iface_wakeup_wait,
+    .iface_wakeup_signal = uct_tcp_iface_wakeup_signal,
+    .iface_wakeup_close  = uct_tcp_iface_wakeup_close,
+    .ep_put_short        = uct_tcp_ep_put_short,
+    .ep_put_bcopy        = uct_tcp_ep_put_bcopy,
+    .ep_put_zcopy        = uct_tcp_ep_put_zcopy,
+    .ep_get_bcopy        = uct_tcp_ep_get_bcopy,
+    .ep_get_zcopy        = uct_tcp_ep_get_zcopy,
+    .ep_am_short         = uct_tcp_ep_am_short,
+    .ep_am_bcopy         = uct_tcp_ep_am_bcopy,
+    .ep_am_zcopy         = uct_tcp_ep_am_zcopy,
+    .ep_pending_add      = uct_tcp_ep_pending_add,
+    .ep_pending_purge    = uct_tcp_ep_pending_purge,
+    .ep_flush            = uct_tcp_ep_flush,
+    .ep_create_connected = UCS_CLASS_NEW_FUNC_NAME(uct_tcp_ep_t),
+    .ep_destroy          = UCS_CLASS_DELETE_FUNC_NAME(uct_tcp_ep_t),
+};
+
+static ucs_status_t uct_tcp_iface_listen(uct_tcp_iface_t *iface)
+{
+    struct epoll_event event;
+    socklen_t addrlen;
+
+    iface->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                              0);
+    if (iface->listen_fd < 0) {
+        ucs_error("socket() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    /* listen on an ephemeral port of the interface address */
+    iface->addr.sin_port = 0;
+    if (bind(iface->listen_fd, (struct sockaddr*)&iface->addr,
+             sizeof(iface->addr)) < 0) {
+        ucs_error("bind(%s) failed: %m", inet_ntoa(iface->addr.sin_addr));
+        goto err_close;
+    }
+
+    addrlen = sizeof(iface->addr);
+    if (getsockname(iface->listen_fd, (struct sockaddr*)&iface->addr,
+                    &addrlen) < 0) {
+        ucs_error("getsockname() failed: %m");
+        goto err_close;
+    }
+
+    if (listen(iface->listen_fd, SOMAXCONN) < 0) {
+        ucs_error("listen() failed: %m");
+        goto err_close;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events   = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(iface->epfd, EPOLL_CTL_ADD, iface->listen_fd, &event) < 0) {
+        ucs_error("epoll_ctl(ADD) failed: %m");
+        goto err_close;
+    }
+
+    return UCS_OK;
+
+err_close:
+    close(iface->listen_fd);
+    return UCS_ERR_IO_ERROR;
+}
+
+static UCS_CLASS_INIT_FUNC(uct_tcp_iface_t, uct_pd_h pd, uct_worker_h worker,
+                           const char *dev_name, size_t rx_headroom,
+                           const uct_iface_config_t *tl_config)
+{
+    uct_tcp_iface_config_t *config = ucs_derived_of(tl_config,
+                                                    uct_tcp_iface_config_t);
+    ucs_status_t status;
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_iface_t, &uct_tcp_iface_ops, pd, worker,
+                              tl_config UCS_STATS_ARG(NULL));
+
+    if ((config->seg_size < sizeof(uint64_t)) ||
+        (config->seg_size > UINT32_MAX / 2)) {
+        ucs_error("Invalid tcp segment size: %zu", config->seg_size);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    self->rx_headroom         = rx_headroom;
+    self->guid                = ucs_machine_guid();
+    self->wakeup_efd          = -1;
+    self->rx_stalled          = 0;
+    self->config.seg_size     = config->seg_size;
+    self->config.buf_size     = 2 * (sizeof(uct_tcp_hdr_t) +
+                                     sizeof(uct_tcp_rma_hdr_t) +
+                                     config->seg_size);
+    self->config.zcopy_thresh = config->zcopy_thresh;
+    self->config.sndbuf       = config->sndbuf;
+    self->config.rcvbuf       = config->rcvbuf;
+    self->config.nodelay      = config->nodelay;
+    ucs_list_head_init(&self->ep_list);
+    ucs_list_head_init(&self->conn_list);
+    ucs_arbiter_init(&self->arbiter);
+
+    memset(&self->addr, 0, sizeof(self->addr));
+    self->addr.sin_family = AF_INET;
+    status = uct_netif_inaddr(dev_name, &self->addr.sin_addr,
+                              &self->netmask);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    self->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (self->epfd < 0) {
+        ucs_error("epoll_create() failed: %m");
+        status = UCS_ERR_IO_ERROR;
+        goto err;
+    }
+
+    status = uct_tcp_iface_listen(self);
+    if (status != UCS_OK) {
+        goto err_close_epfd;
+    }
+
+    status = uct_iface_mpool_init(&self->super, &self->rx_desc_mp,
+                                  sizeof(uct_am_recv_desc_t) + rx_headroom +
+                                  self->config.seg_size,
+                                  sizeof(uct_am_recv_desc_t),
+                                  UCS_SYS_CACHE_LINE_SIZE, &config->mp, 16,
+                                  ucs_empty_function, "tcp_rx_desc");
+    if (status != UCS_OK) {
+        goto err_close_listen;
+    }
+
+    status = ucs_mpool_init(&self->op_mp, 0, sizeof(uct_tcp_op_t), 0,
+                            UCS_SYS_CACHE_LINE_SIZE, 32, UINT_MAX,
+                            &uct_tcp_op_mpool_ops, "tcp_ops");
+    if (status != UCS_OK) {
+        goto err_cleanup_rx_mp;
+    }
+
+    /* accept connections and receive messages even without endpoints */
+    uct_worker_progress_register(worker, uct_tcp_iface_progress, self);
+
+    ucs_debug("tcp iface %p: listening on %s:%d", self,
+              inet_ntoa(self->addr.sin_addr), ntohs(self->addr.sin_port));
+    return UCS_OK;
+
+err_cleanup_rx_mp:
+    ucs_mpool_cleanup(&self->rx_desc_mp, 1);
+err_close_listen:
+    close(self->listen_fd);
+err_close_epfd:
+    close(self->epfd);
+err:
+    ucs_arbiter_cleanup(&self->arbiter);
+    return status;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_tcp_iface_t)
+{
+    uct_tcp_conn_t *conn, *tmp;
+
+    uct_worker_progress_unregister(self->super.worker, uct_tcp_iface_progress,
+                                   self);
+
+    if (!ucs_list_is_empty(&self->ep_list)) {
+        ucs_warn("tcp iface %p: %lu endpoints were not destroyed", self,
+                 ucs_list_length(&self->ep_list));
+    }
+
+    ucs_list_for_each_safe(conn, tmp, &self->conn_list, list) {
+        uct_tcp_iface_conn_close(self, conn);
+    }
+
+    ucs_mpool_cleanup(&self->op_mp, 1);
+    ucs_mpool_cleanup(&self->rx_desc_mp, 1);
+    ucs_arbiter_cleanup(&self->arbiter);
+    close(self->listen_fd);
+    close(self->epfd);
+}
+
+UCS_CLASS_DEFINE(uct_tcp_iface_t, uct_base_iface_t);
+
+static UCS_CLASS_DEFINE_NEW_FUNC(uct_tcp_iface_t, uct_iface_t, uct_pd_h,
+                                 uct_worker_h, const char *, size_t,
+                                 const uct_iface_config_t *);
+static UCS_CLASS_DEFINE_DELETE_FUNC(uct_tcp_iface_t, uct_iface_t);
+
+static ucs_status_t uct_tcp_query_tl_resources(uct_pd_h pd,
+                                               uct_tl_resource_desc_t **resource_p,
+                                               unsigned *num_resources_p)
+{
+    return uct_netif_query_tl_resources(UCT_TCP_NAME, resource_p,
+                                        num_resources_p);
+}
+
+UCT_TL_COMPONENT_DEFINE(uct_tcp_tl,
+                        uct_tcp_query_tl_resources,
+                        uct_tcp_iface_t,
+                        UCT_TCP_NAME,
+                        "TCP_",
+                        uct_tcp_iface_config_table,
+                        uct_tcp_iface_config_t);
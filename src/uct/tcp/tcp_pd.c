@@ -0,0 +1,56 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "tcp.h"
+
+#include <uct/base/uct_sock_pd.h>
+
+
+static ucs_status_t uct_tcp_pd_query(uct_pd_h pd, uct_pd_attr_t *pd_attr)
+{
+    /* the peer copies the data to and from its virtual address space, after
+     * it checks the remote key. the cost is of the kernel pinning the pages of
+     * a zero-copy send, and notifying its completion */
+    pd_attr->rkey_packed_size  = UCT_SOCK_RKEY_PACKED_SIZE;
+    pd_attr->cap.flags         = UCT_PD_FLAG_REG;
+    pd_attr->cap.max_alloc     = 0;
+    pd_attr->cap.max_reg       = ULONG_MAX;
+    pd_attr->reg_cost.overhead = 1000.0e-9;
+    pd_attr->reg_cost.growth   = 0;
+
+    memset(&pd_attr->local_cpus, 0xff, sizeof(pd_attr->local_cpus));
+    return UCS_OK;
+}
+
+static ucs_status_t uct_tcp_query_pd_resources(uct_pd_resource_desc_t **resources_p,
+                                               unsigned *num_resources_p)
+{
+    return uct_single_pd_resource(&uct_tcp_pd_component, resources_p,
+                                  num_resources_p);
+}
+
+static ucs_status_t uct_tcp_pd_open(const char *pd_name,
+                                    const uct_pd_config_t *pd_config,
+                                    uct_pd_h *pd_p)
+{
+    static uct_pd_ops_t pd_ops = {
+        .close        = uct_sock_pd_close,
+        .query        = uct_tcp_pd_query,
+        .mem_alloc    = (void*)ucs_empty_function_return_success,
+        .mem_free     = (void*)ucs_empty_function_return_success,
+        .mkey_pack    = uct_sock_mkey_pack,
+        .mem_reg      = uct_sock_mem_reg,
+        .mem_dereg    = uct_sock_mem_dereg
+    };
+
+    return uct_sock_pd_open(&uct_tcp_pd_component, &pd_ops, pd_p);
+}
+
+UCT_PD_COMPONENT_DEFINE(uct_tcp_pd_component, UCT_TCP_NAME,
+                        uct_tcp_query_pd_resources, uct_tcp_pd_open, NULL,
+                        uct_sock_rkey_unpack,
+                        ucs_empty_function_return_success, "TCP_",
+                        uct_pd_config_table, uct_pd_config_t)
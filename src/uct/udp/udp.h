@@ -0,0 +1,311 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#ifndef UCT_UDP_H
+#define UCT_UDP_H
+
+#include <uct/base/uct_iface.h>
+#include <uct/base/uct_pd.h>
+#include <uct/base/uct_ud_rel.h>
+#include <ucs/async/async.h>
+#include <ucs/datastruct/arbiter.h>
+#include <ucs/datastruct/list.h>
+#include <ucs/datastruct/mpool.h>
+#include <ucs/datastruct/ptr_array.h>
+#include <ucs/datastruct/sglib_wrapper.h>
+#include <ucs/time/timer_wheel.h>
+#include <netinet/in.h>
+
+
+#define UCT_UDP_NAME           "udp"
+#define UCT_UDP_MAX_DGRAM      65507 /* Max. UDP payload over IPv4 */
+#define UCT_UDP_MAX_RX         16    /* Max. datagrams per progress call */
+#define UCT_UDP_HASH_SIZE      997
+
+
+enum {
+    UCT_UDP_PACKET_CREQ = 1,
+    UCT_UDP_PACKET_CREP = 2
+};
+
+
+/*
+ * The packets are datagrams with the network header of the UD transport,
+ * followed by the payload. Connection requests and replies are sent on the
+ * socket of the interface like all other packets, so they carry the endpoint
+ * ids, and the address of the peer is the source of the datagram.
+ */
+typedef struct uct_udp_ctl_hdr {
+    uint8_t                 type;         /* UCT_UDP_PACKET_CREQ/CREP */
+    union {
+        struct {
+            uint32_t        conn_id;      /* Connection id at the peer */
+            uint32_t        ep_id;        /* Id of the requesting endpoint */
+        } conn_req;
+        struct {
+            uint32_t        src_ep_id;    /* Id of the replying endpoint */
+        } conn_rep;
+    };
+} UCS_S_PACKED uct_udp_ctl_hdr_t;
+
+
+/*
+ * Header of put packets. The peer writes the data only inside the region which
+ * was registered with the remote key.
+ */
+typedef struct uct_udp_put_hdr {
+    uint64_t                rva;          /* Remote address */
+    uint64_t                rkey;         /* Key of the remote region */
+} UCS_S_PACKED uct_udp_put_hdr_t;
+
+
+/*
+ * Device address: the IPv4 address of the interface, and the machine of the
+ * host, to tell whether loopback addresses are reachable.
+ */
+typedef struct uct_udp_device_addr {
+    uint64_t                guid;
+    struct in_addr          in_addr;
+} UCS_S_PACKED uct_udp_device_addr_t;
+
+
+/*
+ * Endpoint address: the port of the interface, and the endpoint to send the
+ * packets to, for a connection without a request.
+ */
+typedef struct uct_udp_ep_addr {
+    in_port_t               port;
+    uint32_t                ep_id;
+} UCS_S_PACKED uct_udp_ep_addr_t;
+
+
+typedef struct uct_udp_iface_config {
+    uct_iface_config_t       super;
+    size_t                   seg_size;
+    size_t                   sndbuf;
+    size_t                   rcvbuf;
+    double                   timer_tick;
+    double                   loss_rate;
+    unsigned                 max_passive_eps;
+    uct_iface_mpool_config_t mp;
+} uct_udp_iface_config_t;
+
+
+enum {
+    UCT_UDP_SEND_SKB_FLAG_ACK_REQ = UCS_BIT(0) /* The ack of the packet was
+                                                  requested by flush */
+};
+
+
+/*
+ * Packet in the send window of an endpoint, which is sent again until it is
+ * acknowledged.
+ */
+typedef struct uct_udp_send_skb {
+    ucs_queue_elem_t        queue;        /* Entry in the send window */
+    uint16_t                len;          /* Length of the packet */
+    uint16_t                flags;
+    uct_ud_neth_t           neth[0];
+} uct_udp_send_skb_t;
+
+
+/*
+ * Receive descriptor. Active messages which arrive in async progress wait in a
+ * queue until the next progress, if their handlers are synchronous.
+ */
+typedef struct uct_udp_recv_desc {
+    ucs_queue_elem_t        queue;        /* Entry in the pending receive queue */
+    uint32_t                length;
+    uint8_t                 am_id;
+    uct_am_recv_desc_t      super;
+} uct_udp_recv_desc_t;
+
+
+/*
+ * Remote interface, and its endpoints which were connected by connection
+ * requests, ordered by connection id. See ud_iface.h for the details.
+ */
+typedef struct uct_udp_iface_peer uct_udp_iface_peer_t;
+struct uct_udp_iface_peer {
+    uct_udp_iface_peer_t    *next;
+    struct sockaddr_in      addr;
+    uint32_t                conn_id_last;
+    ucs_list_link_t         ep_list;
+};
+
+static inline int uct_udp_sockaddr_is_equal(const struct sockaddr_in *a,
+                                            const struct sockaddr_in *b)
+{
+    return (a->sin_addr.s_addr == b->sin_addr.s_addr) &&
+           (a->sin_port == b->sin_port);
+}
+
+static inline int uct_udp_iface_peer_cmp(uct_udp_iface_peer_t *a,
+                                         uct_udp_iface_peer_t *b)
+{
+    return !uct_udp_sockaddr_is_equal(&a->addr, &b->addr);
+}
+
+static inline int uct_udp_iface_peer_hash(uct_udp_iface_peer_t *a)
+{
+    return (a->addr.sin_addr.s_addr ^ a->addr.sin_port) % UCT_UDP_HASH_SIZE;
+}
+
+SGLIB_DEFINE_LIST_PROTOTYPES(uct_udp_iface_peer_t, uct_udp_iface_peer_cmp, next)
+SGLIB_DEFINE_HASHED_CONTAINER_PROTOTYPES(uct_udp_iface_peer_t, UCT_UDP_HASH_SIZE,
+                                         uct_udp_iface_peer_hash)
+
+
+typedef struct uct_udp_iface {
+    uct_base_iface_t        super;
+    int                     fd;
+    struct sockaddr_in      addr;         /* Address of the socket */
+    struct in_addr          netmask;      /* Netmask of the interface */
+    uint64_t                guid;
+    size_t                  rx_headroom;
+    ucs_mpool_t             rx_desc_mp;   /* Active message descriptors */
+    ucs_queue_head_t        rx_pending_q; /* Active messages received in async
+                                             progress */
+    ucs_mpool_t             tx_mp;        /* Packets in send windows */
+    ucs_arbiter_t           arbiter;      /* Control operations and pending
+                                             requests of endpoints */
+    int                     pending_q_len; /* Pending requests of the user */
+    int                     in_pending;   /* Dispatching the arbiter */
+    ucs_ptr_array_t         eps;          /* Endpoints by id */
+    uct_udp_iface_peer_t    *peers[UCT_UDP_HASH_SIZE];
+    ucs_twheel_t            slow_timer;   /* Retransmit timers */
+    int                     timer_id;     /* Async timer which sweeps them */
+    unsigned                loss_seed;
+    struct {
+        size_t              seg_size;     /* Max. packet payload */
+        ucs_time_t          timer_tick;
+        double              loss_rate;
+        unsigned            max_passive_eps;
+    } config;
+} uct_udp_iface_t;
+
+
+typedef struct uct_udp_ep {
+    uct_base_ep_t           super;
+    uint32_t                ep_id;
+    uint32_t                dest_ep_id;   /* UCT_UD_EP_NULL_ID until the peer
+                                             replies to the connection */
+    uint32_t                conn_id;
+    struct sockaddr_in      dest_addr;
+    uct_ud_rel_t            rel;
+    struct {
+        ucs_arbiter_group_t group;        /* Control and pending requests */
+        ucs_arbiter_elem_t  elem;         /* Element of control operations */
+    } pending;
+    ucs_wtimer_t            slow_timer;
+    ucs_list_link_t         cep_list;     /* Entry in the list of the peer */
+} uct_udp_ep_t;
+
+
+extern uct_pd_component_t uct_udp_pd_component;
+extern uct_tl_component_t uct_udp_tl;
+
+
+unsigned uct_udp_iface_progress(void *arg);
+
+void uct_udp_iface_send(uct_udp_iface_t *iface, uct_udp_ep_t *ep,
+                        uct_ud_neth_t *neth, size_t length);
+
+uct_udp_ep_t *uct_udp_iface_cep_lookup(uct_udp_iface_t *iface,
+                                       const struct sockaddr_in *addr,
+                                       uint32_t conn_id);
+
+ucs_status_t uct_udp_iface_cep_insert(uct_udp_iface_t *iface,
+                                      const struct sockaddr_in *addr,
+                                      uct_udp_ep_t *ep, uint32_t conn_id);
+
+void uct_udp_iface_cep_remove(uct_udp_ep_t *ep);
+
+void uct_udp_iface_cep_cleanup(uct_udp_iface_t *iface);
+
+void uct_udp_ep_process_rx(uct_udp_iface_t *iface,
+                           const struct sockaddr_in *src_addr,
+                           uct_ud_neth_t *neth, uct_udp_recv_desc_t *desc,
+                           size_t length, int is_async);
+
+UCS_CLASS_DECLARE_DELETE_FUNC(uct_udp_ep_t, uct_ep_t);
+
+ucs_status_t uct_udp_ep_create(uct_iface_h tl_iface, uct_ep_h *ep_p);
+
+ucs_status_t uct_udp_ep_get_address(uct_ep_h tl_ep, uct_ep_addr_t *addr);
+
+ucs_status_t uct_udp_ep_connect_to_ep(uct_ep_h tl_ep,
+                                      const uct_device_addr_t *dev_addr,
+                                      const uct_ep_addr_t *ep_addr);
+
+ucs_status_t uct_udp_ep_create_connected(uct_iface_h tl_iface,
+                                         const uct_device_addr_t *dev_addr,
+                                         const uct_iface_addr_t *iface_addr,
+                                         uct_ep_h *ep_p);
+
+ucs_status_t uct_udp_ep_put_short(uct_ep_h tl_ep, const void *buffer,
+                                  unsigned length, uint64_t remote_addr,
+                                  uct_rkey_t rkey);
+ssize_t uct_udp_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
+                             void *arg, uint64_t remote_addr, uct_rkey_t rkey);
+
+ucs_status_t uct_udp_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
+                                 const void *payload, unsigned length);
+ssize_t uct_udp_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id,
+                            uct_pack_callback_t pack_cb, void *arg);
+
+ucs_status_t uct_udp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req);
+void uct_udp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb);
+ucs_arbiter_cb_result_t uct_udp_ep_do_pending(ucs_arbiter_t *arbiter,
+                                              ucs_arbiter_elem_t *elem,
+                                              void *arg);
+
+ucs_status_t uct_udp_ep_flush_nolock(uct_udp_iface_t *iface, uct_udp_ep_t *ep);
+ucs_status_t uct_udp_ep_flush(uct_ep_h tl_ep);
+
+
+static inline int uct_udp_ep_is_connected(uct_udp_ep_t *ep)
+{
+    return ep->dest_ep_id != UCT_UD_EP_NULL_ID;
+}
+
+/*
+ * Like UD, the socket is also read, and the packets are sent again, from the
+ * async context, so the interface is locked by all operations.
+ */
+static UCS_F_ALWAYS_INLINE void uct_udp_enter(uct_udp_iface_t *iface)
+{
+    UCS_ASYNC_BLOCK(iface->super.worker->async);
+}
+
+static UCS_F_ALWAYS_INLINE void uct_udp_leave(uct_udp_iface_t *iface)
+{
+    UCS_ASYNC_UNBLOCK(iface->super.worker->async);
+}
+
+static UCS_F_ALWAYS_INLINE unsigned
+uct_udp_iface_progress_pending(uct_udp_iface_t *iface, const uintptr_t is_async)
+{
+    unsigned count;
+
+    iface->in_pending = 1;
+    count = ucs_arbiter_dispatch(&iface->arbiter, 1, uct_udp_ep_do_pending,
+                                 (void*)is_async);
+    iface->in_pending = 0;
+    return count;
+}
+
+/* The window may be opened by async progress, so the requests which are
+ * pending go before a new send */
+static UCS_F_ALWAYS_INLINE void
+uct_udp_iface_progress_pending_tx(uct_udp_iface_t *iface)
+{
+    if (ucs_unlikely((iface->pending_q_len > 0) && !iface->in_pending)) {
+        uct_udp_iface_progress_pending(iface, 0);
+    }
+}
+
+#endif
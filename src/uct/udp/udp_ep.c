@@ -0,0 +1,841 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "udp.h"
+
+#include <uct/base/uct_sock_pd.h>
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/debug/log.h>
+#include <arpa/inet.h>
+
+
+static const uct_ud_rel_ops_t uct_udp_ep_rel_ops;
+
+
+static void uct_udp_ep_slow_timer(ucs_wtimer_t *self)
+{
+    uct_udp_ep_t *ep = ucs_container_of(self, uct_udp_ep_t, slow_timer);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+
+    if (uct_ud_rel_timer(&ep->rel, ucs_twheel_get_time(&iface->slow_timer),
+                         iface->config.timer_tick)) {
+        ucs_wtimer_add(&iface->slow_timer, &ep->slow_timer,
+                       iface->config.timer_tick);
+    }
+}
+
+static UCS_CLASS_INIT_FUNC(uct_udp_ep_t, uct_udp_iface_t *iface,
+                           const struct sockaddr_in *dest_addr)
+{
+    uint32_t prev_gen;
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_ep_t, &iface->super);
+
+    self->ep_id = ucs_ptr_array_insert(&iface->eps, self, &prev_gen);
+    if (self->ep_id >= UCT_UD_EP_ID_MAX) {
+        ucs_error("udp iface %p: too many endpoints", iface);
+        ucs_ptr_array_remove(&iface->eps, self->ep_id, 0);
+        return UCS_ERR_EXCEEDS_LIMIT;
+    }
+
+    self->dest_ep_id  = UCT_UD_EP_NULL_ID;
+    self->conn_id     = 0;
+    self->dest_addr   = *dest_addr;
+    self->rel.ops     = &uct_udp_ep_rel_ops;
+    uct_ud_rel_reset(&self->rel UCS_STATS_ARG(self->super.stats));
+    self->rel.tx.send_time = ucs_twheel_get_time(&iface->slow_timer);
+    ucs_arbiter_group_init(&self->pending.group);
+    ucs_arbiter_elem_init(&self->pending.elem);
+    ucs_wtimer_init(&self->slow_timer, uct_udp_ep_slow_timer);
+    ucs_list_head_init(&self->cep_list);
+
+    ucs_debug("udp ep %p: id %u to %s:%d", self, self->ep_id,
+              inet_ntoa(dest_addr->sin_addr), ntohs(dest_addr->sin_port));
+    return UCS_OK;
+}
+
+static ucs_arbiter_cb_result_t uct_udp_ep_pending_purge_cb(ucs_arbiter_t *arbiter,
+                                                           ucs_arbiter_elem_t *elem,
+                                                           void *arg)
+{
+    uct_udp_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem),
+                                        uct_udp_ep_t, pending.group);
+    uct_udp_iface_t *iface = ucs_container_of(arbiter, uct_udp_iface_t,
+                                              arbiter);
+    uct_pending_callback_t cb = arg;
+    uct_pending_req_t *req;
+
+    if (&ep->pending.elem == elem) {
+        return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    }
+
+    req = ucs_container_of(elem, uct_pending_req_t, priv);
+    iface->pending_q_len--;
+    if (cb != NULL) {
+        cb(req);
+    } else {
+        ucs_warn("udp ep %p: removing user pending request %p", ep, req);
+    }
+    return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_udp_ep_t)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(self->super.super.iface,
+                                            uct_udp_iface_t);
+    uct_udp_send_skb_t *skb;
+
+    uct_udp_enter(iface);
+    uct_udp_iface_cep_remove(self);
+    ucs_wtimer_remove(&self->slow_timer);
+    ucs_arbiter_group_purge(&iface->arbiter, &self->pending.group,
+                            uct_udp_ep_pending_purge_cb, NULL);
+
+    if (!ucs_queue_is_empty(&self->rel.tx.window)) {
+        ucs_debug("udp ep %p: id %u has %zu unacked packets", self, self->ep_id,
+                  ucs_queue_length(&self->rel.tx.window));
+    }
+    ucs_queue_for_each_extract(skb, &self->rel.tx.window, queue, 1) {
+        ucs_mpool_put(skb);
+    }
+
+    ucs_frag_list_cleanup(&self->rel.rx.ooo_pkts);
+    ucs_ptr_array_remove(&iface->eps, self->ep_id, 0);
+    ucs_arbiter_group_cleanup(&self->pending.group);
+    uct_udp_leave(iface);
+}
+
+UCS_CLASS_DEFINE(uct_udp_ep_t, uct_base_ep_t)
+UCS_CLASS_DEFINE_DELETE_FUNC(uct_udp_ep_t, uct_ep_t);
+
+
+/* Put a packet in the send window, and send it */
+static UCS_F_ALWAYS_INLINE void
+uct_udp_ep_tx_skb(uct_udp_iface_t *iface, uct_udp_ep_t *ep,
+                  uct_udp_send_skb_t *skb)
+{
+    uct_udp_iface_send(iface, ep, skb->neth, skb->len);
+    uct_ud_rel_tx_skb(&ep->rel, &skb->queue,
+                      ucs_twheel_get_time(&iface->slow_timer));
+    ucs_wtimer_add(&iface->slow_timer, &ep->slow_timer,
+                   iface->config.timer_tick);
+}
+
+static UCS_F_ALWAYS_INLINE uct_udp_send_skb_t *
+uct_udp_ep_get_tx_skb(uct_udp_iface_t *iface, uct_udp_ep_t *ep)
+{
+    uct_udp_send_skb_t *skb;
+
+    if (ucs_unlikely(!uct_udp_ep_is_connected(ep) ||
+                     uct_ud_rel_no_window(&ep->rel))) {
+        ucs_trace_data("udp ep %p: no resources (psn=%u max_psn=%u)", ep,
+                       ep->rel.tx.psn, ep->rel.tx.max_psn);
+        UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super);
+        return NULL;
+    }
+
+    skb = ucs_mpool_get(&iface->tx_mp);
+    if (ucs_unlikely(skb == NULL)) {
+        UCT_TL_IFACE_STAT_TX_NO_RES(&iface->super);
+        return NULL;
+    }
+
+    skb->flags = 0;
+    return skb;
+}
+
+/* Data packets acknowledge the received packets, and request an ack once in
+ * a while */
+static UCS_F_ALWAYS_INLINE void
+uct_udp_ep_set_neth(uct_udp_ep_t *ep, uct_ud_neth_t *neth, uint32_t packet_type)
+{
+    uct_ud_rel_neth_init(&ep->rel, neth);
+    neth->packet_type = ep->dest_ep_id | packet_type;
+    uct_ud_rel_neth_ack_req(&ep->rel, neth);
+}
+
+ucs_status_t uct_udp_ep_am_short(uct_ep_h tl_ep, uint8_t id, uint64_t header,
+                                 const void *payload, unsigned length)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    uct_udp_send_skb_t *skb;
+    uint64_t *hdr;
+
+    UCT_CHECK_AM_ID(id);
+    UCT_CHECK_LENGTH(sizeof(header) + length, iface->config.seg_size,
+                     "am_short");
+
+    uct_udp_enter(iface);
+    uct_udp_iface_progress_pending_tx(iface);
+    skb = uct_udp_ep_get_tx_skb(iface, ep);
+    if (skb == NULL) {
+        uct_udp_leave(iface);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    uct_udp_ep_set_neth(ep, skb->neth, UCT_UD_PACKET_FLAG_AM |
+                                       (id << UCT_UD_PACKET_AM_ID_SHIFT));
+    hdr  = (uint64_t*)(skb->neth + 1);
+    *hdr = header;
+    memcpy(hdr + 1, payload, length);
+    skb->len = sizeof(uct_ud_neth_t) + sizeof(header) + length;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id, hdr,
+                       sizeof(header) + length, "TX: AM_SHORT");
+    UCT_TL_EP_STAT_OP(&ep->super, AM, SHORT, sizeof(header) + length);
+    uct_udp_ep_tx_skb(iface, ep, skb);
+    uct_udp_leave(iface);
+    return UCS_OK;
+}
+
+ssize_t uct_udp_ep_am_bcopy(uct_ep_h tl_ep, uint8_t id,
+                            uct_pack_callback_t pack_cb, void *arg)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    uct_udp_send_skb_t *skb;
+    size_t length;
+
+    UCT_CHECK_AM_ID(id);
+
+    uct_udp_enter(iface);
+    uct_udp_iface_progress_pending_tx(iface);
+    skb = uct_udp_ep_get_tx_skb(iface, ep);
+    if (skb == NULL) {
+        uct_udp_leave(iface);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    uct_udp_ep_set_neth(ep, skb->neth, UCT_UD_PACKET_FLAG_AM |
+                                       (id << UCT_UD_PACKET_AM_ID_SHIFT));
+    length   = pack_cb(skb->neth + 1, arg);
+    skb->len = sizeof(uct_ud_neth_t) + length;
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_SEND, id,
+                       skb->neth + 1, length, "TX: AM_BCOPY");
+    UCT_TL_EP_STAT_OP(&ep->super, AM, BCOPY, length);
+    uct_udp_ep_tx_skb(iface, ep, skb);
+    uct_udp_leave(iface);
+    return length;
+}
+
+ucs_status_t uct_udp_ep_put_short(uct_ep_h tl_ep, const void *buffer,
+                                  unsigned length, uint64_t remote_addr,
+                                  uct_rkey_t rkey)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    uct_udp_send_skb_t *skb;
+    uct_udp_put_hdr_t *put_hdr;
+
+    UCT_CHECK_LENGTH(sizeof(*put_hdr) + length, iface->config.seg_size,
+                     "put_short");
+
+    uct_udp_enter(iface);
+    uct_udp_iface_progress_pending_tx(iface);
+    skb = uct_udp_ep_get_tx_skb(iface, ep);
+    if (skb == NULL) {
+        uct_udp_leave(iface);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    uct_udp_ep_set_neth(ep, skb->neth, UCT_UD_PACKET_FLAG_PUT);
+    put_hdr       = (uct_udp_put_hdr_t*)(skb->neth + 1);
+    put_hdr->rva  = remote_addr;
+    put_hdr->rkey = rkey;
+    memcpy(put_hdr + 1, buffer, length);
+    skb->len = sizeof(uct_ud_neth_t) + sizeof(*put_hdr) + length;
+
+    ucs_trace_data("TX: PUT_SHORT [%p size %u] to 0x%"PRIx64, buffer, length,
+                   remote_addr);
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, SHORT, length);
+    uct_udp_ep_tx_skb(iface, ep, skb);
+    uct_udp_leave(iface);
+    return UCS_OK;
+}
+
+ssize_t uct_udp_ep_put_bcopy(uct_ep_h tl_ep, uct_pack_callback_t pack_cb,
+                             void *arg, uint64_t remote_addr, uct_rkey_t rkey)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    uct_udp_send_skb_t *skb;
+    uct_udp_put_hdr_t *put_hdr;
+    size_t length;
+
+    uct_udp_enter(iface);
+    uct_udp_iface_progress_pending_tx(iface);
+    skb = uct_udp_ep_get_tx_skb(iface, ep);
+    if (skb == NULL) {
+        uct_udp_leave(iface);
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    uct_udp_ep_set_neth(ep, skb->neth, UCT_UD_PACKET_FLAG_PUT);
+    put_hdr       = (uct_udp_put_hdr_t*)(skb->neth + 1);
+    put_hdr->rva  = remote_addr;
+    put_hdr->rkey = rkey;
+    length        = pack_cb(put_hdr + 1, arg);
+    skb->len      = sizeof(uct_ud_neth_t) + sizeof(*put_hdr) + length;
+
+    ucs_trace_data("TX: PUT_BCOPY [size %zu] to 0x%"PRIx64, length,
+                   remote_addr);
+    UCT_TL_EP_STAT_OP(&ep->super, PUT, BCOPY, length);
+    uct_udp_ep_tx_skb(iface, ep, skb);
+    uct_udp_leave(iface);
+    return length;
+}
+
+static int uct_udp_ep_rel_is_connected(uct_ud_rel_t *rel)
+{
+    return uct_udp_ep_is_connected(ucs_container_of(rel, uct_udp_ep_t, rel));
+}
+
+static ucs_time_t uct_udp_ep_rel_get_time(uct_ud_rel_t *rel)
+{
+    uct_udp_ep_t *ep = ucs_container_of(rel, uct_udp_ep_t, rel);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+
+    return ucs_twheel_get_time(&iface->slow_timer);
+}
+
+static void uct_udp_ep_rel_schedule(uct_ud_rel_t *rel)
+{
+    uct_udp_ep_t *ep = ucs_container_of(rel, uct_udp_ep_t, rel);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+
+    if (uct_ud_rel_ctl_op_isany(rel)) {
+        ucs_arbiter_group_push_elem(&ep->pending.group, &ep->pending.elem);
+    }
+    ucs_arbiter_group_schedule(&iface->arbiter, &ep->pending.group);
+}
+
+static uct_ud_neth_t *uct_udp_ep_rel_skb_neth(ucs_queue_elem_t *elem)
+{
+    return ucs_container_of(elem, uct_udp_send_skb_t, queue)->neth;
+}
+
+static void uct_udp_ep_rel_skb_release(uct_ud_rel_t *rel, ucs_queue_elem_t *elem,
+                                       int is_async)
+{
+    ucs_mpool_put(ucs_container_of(elem, uct_udp_send_skb_t, queue));
+}
+
+/* The socket copies the packet, so it is updated in place */
+static void uct_udp_ep_rel_skb_resend(uct_ud_rel_t *rel, ucs_queue_elem_t *elem,
+                                      int ack_req)
+{
+    uct_udp_ep_t *ep = ucs_container_of(rel, uct_udp_ep_t, rel);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+    uct_udp_send_skb_t *skb = ucs_container_of(elem, uct_udp_send_skb_t, queue);
+
+    skb->neth->ack_psn = rel->rx.acked_psn = ucs_frag_list_sn(&rel->rx.ooo_pkts);
+    if (ack_req) {
+        skb->neth->packet_type |= UCT_UD_PACKET_FLAG_ACK_REQ;
+    } else {
+        skb->neth->packet_type &= ~UCT_UD_PACKET_FLAG_ACK_REQ;
+    }
+    uct_udp_iface_send(iface, ep, skb->neth, skb->len);
+}
+
+/*
+ * The connection request is the first packet in the send window, so it is
+ * sent again until the peer acknowledges it.
+ */
+static ucs_status_t uct_udp_ep_rel_send_creq(uct_ud_rel_t *rel)
+{
+    uct_udp_ep_t *ep = ucs_container_of(rel, uct_udp_ep_t, rel);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+    uct_udp_send_skb_t *skb;
+    uct_udp_ctl_hdr_t *creq;
+
+    skb = ucs_mpool_get(&iface->tx_mp);
+    if (skb == NULL) {
+        return UCS_ERR_NO_RESOURCE;
+    }
+
+    skb->flags = 0;
+    uct_ud_rel_neth_init(rel, skb->neth);
+    skb->neth->packet_type = UCT_UD_EP_NULL_ID | UCT_UD_PACKET_FLAG_CTL;
+
+    creq                   = (uct_udp_ctl_hdr_t*)(skb->neth + 1);
+    creq->type             = UCT_UDP_PACKET_CREQ;
+    creq->conn_req.conn_id = ep->conn_id;
+    creq->conn_req.ep_id   = ep->ep_id;
+    skb->len               = sizeof(uct_ud_neth_t) + sizeof(*creq);
+
+    uct_udp_ep_tx_skb(iface, ep, skb);
+    return UCS_OK;
+}
+
+static void uct_udp_ep_rel_send_crep(uct_ud_rel_t *rel)
+{
+    uct_udp_ep_t *ep = ucs_container_of(rel, uct_udp_ep_t, rel);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+    char packet[sizeof(uct_ud_neth_t) + sizeof(uct_udp_ctl_hdr_t)];
+    uct_ud_neth_t *neth = (uct_ud_neth_t*)packet;
+    uct_udp_ctl_hdr_t *crep = (uct_udp_ctl_hdr_t*)(neth + 1);
+
+    uct_ud_rel_neth_init(rel, neth);
+    neth->packet_type = ep->dest_ep_id | UCT_UD_PACKET_FLAG_ACK_REQ |
+                        UCT_UD_PACKET_FLAG_CTL;
+    crep->type               = UCT_UDP_PACKET_CREP;
+    crep->conn_rep.src_ep_id = ep->ep_id;
+
+    uct_udp_iface_send(iface, ep, neth, sizeof(packet));
+}
+
+static void uct_udp_ep_rel_send_ack(uct_ud_rel_t *rel, int ack_req)
+{
+    uct_udp_ep_t *ep = ucs_container_of(rel, uct_udp_ep_t, rel);
+    uct_udp_iface_t *iface = ucs_derived_of(ep->super.super.iface,
+                                            uct_udp_iface_t);
+    uct_ud_neth_t neth;
+
+    uct_ud_rel_neth_init(rel, &neth);
+    neth.packet_type = ep->dest_ep_id |
+                       (ack_req ? UCT_UD_PACKET_FLAG_ACK_REQ : 0);
+    uct_udp_iface_send(iface, ep, &neth, sizeof(neth));
+}
+
+static const uct_ud_rel_ops_t uct_udp_ep_rel_ops = {
+    .is_connected = uct_udp_ep_rel_is_connected,
+    .get_time     = uct_udp_ep_rel_get_time,
+    .schedule     = uct_udp_ep_rel_schedule,
+    .skb_neth     = uct_udp_ep_rel_skb_neth,
+    .skb_release  = uct_udp_ep_rel_skb_release,
+    .skb_resend   = uct_udp_ep_rel_skb_resend,
+    .send_creq    = uct_udp_ep_rel_send_creq,
+    .send_crep    = uct_udp_ep_rel_send_crep,
+    .send_ack     = uct_udp_ep_rel_send_ack
+};
+
+static UCS_F_ALWAYS_INLINE ucs_arbiter_cb_result_t
+uct_udp_ep_ctl_op_next(uct_udp_ep_t *ep)
+{
+    return uct_ud_rel_ctl_op_isany(&ep->rel) ?
+           UCS_ARBITER_CB_RESULT_NEXT_GROUP :
+           UCS_ARBITER_CB_RESULT_RESCHED_GROUP;
+}
+
+/*
+ * Same priorities as UD: connection and resend operations are sent before
+ * pending requests of the user, and acks after them, since the requests
+ * carry the acks.
+ */
+ucs_arbiter_cb_result_t uct_udp_ep_do_pending(ucs_arbiter_t *arbiter,
+                                              ucs_arbiter_elem_t *elem,
+                                              void *arg)
+{
+    uct_udp_ep_t *ep = ucs_container_of(ucs_arbiter_elem_group(elem),
+                                        uct_udp_ep_t, pending.group);
+    uct_udp_iface_t *iface = ucs_container_of(arbiter, uct_udp_iface_t,
+                                              arbiter);
+    uintptr_t in_async_progress = (uintptr_t)arg;
+    uct_pending_req_t *req;
+    ucs_status_t status;
+
+    if (!uct_ud_rel_ctl_op_isany(&ep->rel) &&
+        (!uct_udp_ep_is_connected(ep) || uct_ud_rel_no_window(&ep->rel))) {
+        return UCS_ARBITER_CB_RESULT_DESCHED_GROUP;
+    }
+
+    if (&ep->pending.elem == elem) {
+        uct_ud_rel_do_pending_ctl(&ep->rel);
+        return uct_ud_rel_ctl_op_isany(&ep->rel) ?
+               UCS_ARBITER_CB_RESULT_NEXT_GROUP :
+               UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+    }
+
+    /* requests of the user are not called from async progress */
+    if (!in_async_progress &&
+        (!uct_ud_rel_ctl_op_isany(&ep->rel) ||
+         !uct_ud_rel_ctl_op_check(&ep->rel, UCT_UD_REL_OP_CTL_HI_PRIO))) {
+        req    = ucs_container_of(elem, uct_pending_req_t, priv);
+        status = req->func(req);
+        ucs_trace_data("progress pending request %p returned %s", req,
+                       ucs_status_string(status));
+
+        if (status == UCS_OK) {
+            iface->pending_q_len--;
+            return UCS_ARBITER_CB_RESULT_REMOVE_ELEM;
+        } else if (status == UCS_INPROGRESS) {
+            return UCS_ARBITER_CB_RESULT_NEXT_GROUP;
+        }
+    }
+
+    uct_ud_rel_do_pending_ctl(&ep->rel);
+    return uct_udp_ep_ctl_op_next(ep);
+}
+
+ucs_status_t uct_udp_ep_pending_add(uct_ep_h tl_ep, uct_pending_req_t *req)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+
+    uct_udp_enter(iface);
+
+    /* requests which were added before go first */
+    uct_udp_iface_progress_pending(iface, 0);
+
+    if (uct_udp_ep_is_connected(ep) && !uct_ud_rel_no_window(&ep->rel)) {
+        uct_udp_leave(iface);
+        return UCS_ERR_BUSY;
+    }
+
+    UCS_STATIC_ASSERT(sizeof(ucs_arbiter_elem_t) <= UCT_PENDING_REQ_PRIV_LEN);
+
+    ucs_arbiter_elem_init((ucs_arbiter_elem_t *)req->priv);
+    ucs_arbiter_group_push_elem(&ep->pending.group,
+                                (ucs_arbiter_elem_t*)req->priv);
+    ucs_arbiter_group_schedule(&iface->arbiter, &ep->pending.group);
+    iface->pending_q_len++;
+    uct_udp_leave(iface);
+    return UCS_OK;
+}
+
+void uct_udp_ep_pending_purge(uct_ep_h tl_ep, uct_pending_callback_t cb)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+
+    uct_udp_enter(iface);
+    ucs_arbiter_group_purge(&iface->arbiter, &ep->pending.group,
+                            uct_udp_ep_pending_purge_cb, cb);
+
+    /* control operations are not purged */
+    uct_udp_ep_rel_schedule(&ep->rel);
+    uct_udp_leave(iface);
+}
+
+ucs_status_t uct_udp_ep_flush_nolock(uct_udp_iface_t *iface, uct_udp_ep_t *ep)
+{
+    uct_udp_send_skb_t *skb;
+
+    if (ucs_queue_is_empty(&ep->rel.tx.window)) {
+        uct_ud_rel_ctl_op_del(&ep->rel, UCT_UD_REL_OP_ACK_REQ);
+        if (!uct_ud_rel_ctl_op_check(&ep->rel, UCT_UD_REL_OP_CREQ) &&
+            ucs_arbiter_group_is_empty(&ep->pending.group)) {
+            UCT_TL_EP_STAT_FLUSH(&ep->super);
+            return UCS_OK;
+        }
+        UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+        return UCS_INPROGRESS;
+    }
+
+    /* request an ack of the last packet once, and let the retransmit timer
+     * handle the rest */
+    skb = ucs_queue_tail_elem_non_empty(&ep->rel.tx.window, uct_udp_send_skb_t,
+                                        queue);
+    if (!(skb->flags & UCT_UDP_SEND_SKB_FLAG_ACK_REQ) &&
+        uct_udp_ep_is_connected(ep)) {
+        skb->flags |= UCT_UDP_SEND_SKB_FLAG_ACK_REQ;
+        uct_ud_rel_ctl_op_add(&ep->rel, UCT_UD_REL_OP_ACK_REQ);
+    }
+
+    UCT_TL_EP_STAT_FLUSH_WAIT(&ep->super);
+    return UCS_INPROGRESS;
+}
+
+ucs_status_t uct_udp_ep_flush(uct_ep_h tl_ep)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    ucs_status_t status;
+
+    uct_udp_enter(iface);
+    status = uct_udp_ep_flush_nolock(iface, ep);
+    uct_udp_leave(iface);
+    return status;
+}
+
+/*
+ * The request is the first packet of the peer in the sequence of the
+ * connection. Unlike UD, a request which crosses the request of this side is
+ * not taken as an ack of it, since the request of this side may be lost.
+ */
+static void uct_udp_ep_rx_creq(uct_udp_iface_t *iface,
+                               const struct sockaddr_in *src_addr,
+                               uct_ud_neth_t *neth, uct_udp_ctl_hdr_t *creq)
+{
+    ucs_frag_list_elem_t elem; /* packets are never kept out of order */
+    uct_udp_ep_t *ep;
+    ucs_status_t status;
+
+    ep = uct_udp_iface_cep_lookup(iface, src_addr, creq->conn_req.conn_id);
+    if (ep == NULL) {
+        status = UCS_CLASS_NEW(uct_udp_ep_t, &ep, iface, src_addr);
+        if (status != UCS_OK) {
+            return;
+        }
+
+        status = uct_udp_iface_cep_insert(iface, src_addr, ep,
+                                          creq->conn_req.conn_id);
+        if (status != UCS_OK) {
+            UCS_CLASS_DELETE(uct_udp_ep_t, ep);
+            return;
+        }
+    }
+
+    if (!uct_udp_ep_is_connected(ep)) {
+        ep->dest_ep_id = creq->conn_req.ep_id;
+        ucs_arbiter_group_schedule(&iface->arbiter, &ep->pending.group);
+    } else if (ep->dest_ep_id != creq->conn_req.ep_id) {
+        ucs_debug("udp ep %p: dropped request of ep %u, connected to ep %u",
+                  ep, creq->conn_req.ep_id, ep->dest_ep_id);
+        return;
+    }
+
+    ucs_frag_list_insert(&ep->rel.rx.ooo_pkts, &elem, neth->psn);
+    ucs_debug("udp ep %p: connection request of ep %u conn_id %u", ep,
+              ep->dest_ep_id, ep->conn_id);
+
+    /* the reply is sent again to a duplicate request, in case it was lost */
+    uct_ud_rel_ctl_op_del(&ep->rel, UCT_UD_REL_OP_CREQ);
+    uct_ud_rel_ctl_op_add(&ep->rel, UCT_UD_REL_OP_CREP);
+}
+
+static void uct_udp_ep_rx_crep(uct_udp_iface_t *iface, uct_udp_ep_t *ep,
+                               uct_udp_ctl_hdr_t *crep)
+{
+    if (!uct_udp_ep_is_connected(ep)) {
+        ep->dest_ep_id = crep->conn_rep.src_ep_id;
+        ucs_arbiter_group_schedule(&iface->arbiter, &ep->pending.group);
+        ucs_debug("udp ep %p: connected to ep %u", ep, ep->dest_ep_id);
+    }
+}
+
+/*
+ * The packet is acknowledged also when the put is dropped, since sending it
+ * again would not make the region accessible.
+ */
+static void uct_udp_ep_rx_put(uct_udp_iface_t *iface, uct_udp_ep_t *ep,
+                              uct_udp_put_hdr_t *put_hdr, size_t length)
+{
+    if ((length > 0) &&
+        !uct_sock_pd_is_accessible(iface->super.pd, put_hdr->rkey,
+                                   put_hdr->rva, length)) {
+        ucs_error("udp ep %p: dropped put of %zu bytes to 0x%"PRIx64
+                  " outside of the region of rkey 0x%"PRIx64, ep, length,
+                  put_hdr->rva, put_hdr->rkey);
+        return;
+    }
+
+    memcpy((void*)put_hdr->rva, put_hdr + 1, length);
+}
+
+void uct_udp_ep_process_rx(uct_udp_iface_t *iface,
+                           const struct sockaddr_in *src_addr,
+                           uct_ud_neth_t *neth, uct_udp_recv_desc_t *desc,
+                           size_t length, int is_async)
+{
+    void *rx_desc = &desc->super + 1;
+    void *data    = rx_desc + iface->rx_headroom;
+    ucs_frag_list_ooo_type_t ooo_type;
+    ucs_frag_list_elem_t elem;
+    uct_udp_put_hdr_t *put_hdr;
+    uint32_t dest_id, is_am;
+    ucs_status_t status;
+    uct_udp_ep_t *ep;
+    uint8_t am_id;
+
+    dest_id = uct_ud_neth_get_dest_id(neth);
+    am_id   = uct_ud_neth_get_am_id(neth);
+    is_am   = neth->packet_type & UCT_UD_PACKET_FLAG_AM;
+
+    if (ucs_unlikely(dest_id == UCT_UD_EP_NULL_ID)) {
+        if ((neth->packet_type & UCT_UD_PACKET_FLAG_CTL) &&
+            (length == sizeof(uct_udp_ctl_hdr_t)) &&
+            (((uct_udp_ctl_hdr_t*)data)->type == UCT_UDP_PACKET_CREQ)) {
+            uct_udp_ep_rx_creq(iface, src_addr, neth, data);
+        }
+        goto out;
+    } else if (ucs_unlikely(!ucs_ptr_array_lookup(&iface->eps, dest_id, ep) ||
+                            (ep->ep_id != dest_id))) {
+        /* the endpoint may be destroyed without a flush of the peer */
+        ucs_debug("udp iface %p: dropped packet to unknown ep %u", iface,
+                  dest_id);
+        goto out;
+    } else if (ucs_unlikely(!uct_udp_sockaddr_is_equal(src_addr,
+                                                       &ep->dest_addr))) {
+        ucs_debug("udp ep %p: dropped packet from %s:%d", ep,
+                  inet_ntoa(src_addr->sin_addr), ntohs(src_addr->sin_port));
+        goto out;
+    }
+
+    uct_ud_rel_process_ack(&ep->rel, neth->ack_psn, is_async);
+
+    if (ucs_unlikely(neth->packet_type & UCT_UD_PACKET_FLAG_ACK_REQ)) {
+        uct_ud_rel_ctl_op_add(&ep->rel, UCT_UD_REL_OP_ACK);
+    }
+
+    if (ucs_unlikely(!is_am)) {
+        if (length == 0) {
+            goto out;
+        }
+        if (neth->packet_type & UCT_UD_PACKET_FLAG_CTL) {
+            if ((length == sizeof(uct_udp_ctl_hdr_t)) &&
+                (((uct_udp_ctl_hdr_t*)data)->type == UCT_UDP_PACKET_CREP)) {
+                uct_udp_ep_rx_crep(iface, ep, data);
+            }
+            goto out;
+        }
+    }
+
+    ooo_type = ucs_frag_list_insert(&ep->rel.rx.ooo_pkts, &elem, neth->psn);
+    if (ucs_unlikely(ooo_type != UCS_FRAG_LIST_INSERT_FAST)) {
+        /* go-back-N: a packet which follows a lost packet is dropped, and the
+         * ack tells the peer where to resend from */
+        ucs_trace_data("udp ep %p: dropped packet psn %u (head_sn %u)", ep,
+                       neth->psn, ep->rel.rx.ooo_pkts.head_sn);
+        uct_ud_rel_ctl_op_add(&ep->rel, UCT_UD_REL_OP_ACK);
+        goto out;
+    }
+
+    if (ucs_unlikely(!is_am)) {
+        if ((neth->packet_type & UCT_UD_PACKET_FLAG_PUT) &&
+            (length >= sizeof(*put_hdr))) {
+            uct_udp_ep_rx_put(iface, ep, data, length - sizeof(*put_hdr));
+        }
+        goto out;
+    }
+
+    uct_iface_trace_am(&iface->super, UCT_AM_TRACE_TYPE_RECV, am_id, data,
+                       length, "RX: AM");
+    if (ucs_unlikely(is_async &&
+                     (iface->super.am[am_id].flags & UCT_AM_CB_FLAG_SYNC))) {
+        desc->length = length;
+        desc->am_id  = am_id;
+        ucs_queue_push(&iface->rx_pending_q, &desc->queue);
+        return;
+    }
+
+    status = uct_iface_invoke_am(&iface->super, am_id, data, length, rx_desc);
+    if (status != UCS_OK) {
+        uct_recv_desc_iface(rx_desc) = &iface->super.super;
+        return;
+    }
+
+out:
+    ucs_mpool_put(desc);
+}
+
+ucs_status_t uct_udp_ep_create_connected(uct_iface_h tl_iface,
+                                         const uct_device_addr_t *dev_addr,
+                                         const uct_iface_addr_t *iface_addr,
+                                         uct_ep_h *ep_p)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+    const uct_udp_device_addr_t *udp_addr = (const void*)dev_addr;
+    struct sockaddr_in dest_addr;
+    ucs_status_t status;
+    uct_udp_ep_t *ep;
+
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_addr   = udp_addr->in_addr;
+    dest_addr.sin_port   = *(const in_port_t*)iface_addr;
+
+    uct_udp_enter(iface);
+
+    /* the peer may have connected first, and its request created the
+     * endpoint */
+    ep = uct_udp_iface_cep_lookup(iface, &dest_addr, UCT_UD_EP_CONN_ID_MAX);
+    if (ep != NULL) {
+        status = UCS_OK;
+        goto out;
+    }
+
+    status = UCS_CLASS_NEW(uct_udp_ep_t, &ep, iface, &dest_addr);
+    if (status != UCS_OK) {
+        goto out;
+    }
+
+    status = uct_udp_iface_cep_insert(iface, &dest_addr, ep,
+                                      UCT_UD_EP_CONN_ID_MAX);
+    if (status != UCS_OK) {
+        UCS_CLASS_DELETE(uct_udp_ep_t, ep);
+        goto out;
+    }
+
+    if (uct_udp_ep_rel_send_creq(&ep->rel) != UCS_OK) {
+        uct_ud_rel_ctl_op_add(&ep->rel, UCT_UD_REL_OP_CREQ);
+    }
+
+out:
+    if (status == UCS_OK) {
+        *ep_p = &ep->super.super;
+    }
+    uct_udp_leave(iface);
+    return status;
+}
+
+ucs_status_t uct_udp_ep_create(uct_iface_h tl_iface, uct_ep_h *ep_p)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+    struct sockaddr_in dest_addr;
+    ucs_status_t status;
+    uct_udp_ep_t *ep;
+
+    /* the address of the peer is set by connect_to_ep */
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+
+    uct_udp_enter(iface);
+    status = UCS_CLASS_NEW(uct_udp_ep_t, &ep, iface, &dest_addr);
+    uct_udp_leave(iface);
+    if (status != UCS_OK) {
+        return status;
+    }
+
+    *ep_p = &ep->super.super;
+    return UCS_OK;
+}
+
+ucs_status_t uct_udp_ep_get_address(uct_ep_h tl_ep, uct_ep_addr_t *addr)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    uct_udp_ep_addr_t *ep_addr = (uct_udp_ep_addr_t*)addr;
+
+    ep_addr->port  = iface->addr.sin_port;
+    ep_addr->ep_id = ep->ep_id;
+    return UCS_OK;
+}
+
+/*
+ * Both endpoints start their sequences from the same number, so there is no
+ * request and reply, and the endpoint can send right away.
+ */
+ucs_status_t uct_udp_ep_connect_to_ep(uct_ep_h tl_ep,
+                                      const uct_device_addr_t *dev_addr,
+                                      const uct_ep_addr_t *ep_addr)
+{
+    uct_udp_ep_t *ep = ucs_derived_of(tl_ep, uct_udp_ep_t);
+    uct_udp_iface_t *iface = ucs_derived_of(tl_ep->iface, uct_udp_iface_t);
+    const uct_udp_device_addr_t *udp_addr = (const void*)dev_addr;
+    const uct_udp_ep_addr_t *udp_ep_addr = (const void*)ep_addr;
+
+    ucs_assert_always(!uct_udp_ep_is_connected(ep));
+
+    uct_udp_enter(iface);
+    ep->dest_addr.sin_addr = udp_addr->in_addr;
+    ep->dest_addr.sin_port = udp_ep_addr->port;
+    ep->dest_ep_id         = udp_ep_addr->ep_id;
+    uct_udp_leave(iface);
+
+    ucs_debug("udp ep %p: id %u connected to %s:%d ep %u", ep, ep->ep_id,
+              inet_ntoa(ep->dest_addr.sin_addr), ntohs(ep->dest_addr.sin_port),
+              ep->dest_ep_id);
+    return UCS_OK;
+}
@@ -0,0 +1,679 @@
+/**
+ * Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+ *
+ * See file LICENSE for terms.
+ */
+
+#include "udp.h"
+
+#include <uct/base/uct_netif.h>
+#include <ucs/datastruct/mpool.inl>
+#include <ucs/debug/log.h>
+#include <ucs/sys/sys.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+SGLIB_DEFINE_LIST_FUNCTIONS(uct_udp_iface_peer_t, uct_udp_iface_peer_cmp, next)
+SGLIB_DEFINE_HASHED_CONTAINER_FUNCTIONS(uct_udp_iface_peer_t,
+                                        UCT_UDP_HASH_SIZE,
+                                        uct_udp_iface_peer_hash)
+
+UCT_PD_REGISTER_TL(&uct_udp_pd_component, &uct_udp_tl);
+
+static ucs_config_field_t uct_udp_iface_config_table[] = {
+    {"", "ALLOC=huge,mmap,heap", NULL,
+    ucs_offsetof(uct_udp_iface_config_t, super),
+    UCS_CONFIG_TYPE_TABLE(uct_iface_config_table)},
+
+    {"SEG_SIZE", "8k",
+     "Maximal payload of a packet. Larger transfers are split to packets of this\n"
+     "size, and the packet with the network header must fit in a datagram.",
+     ucs_offsetof(uct_udp_iface_config_t, seg_size), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"SNDBUF", "auto",
+     "Socket send buffer size. \"auto\" keeps the system default.",
+     ucs_offsetof(uct_udp_iface_config_t, sndbuf), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"RCVBUF", "auto",
+     "Socket receive buffer size. \"auto\" keeps the system default. Packets which\n"
+     "overflow the buffer are dropped, and sent again by the reliability protocol.",
+     ucs_offsetof(uct_udp_iface_config_t, rcvbuf), UCS_CONFIG_TYPE_MEMUNITS},
+
+    {"TIMER_TICK", "10ms",
+     "Resolution of the retransmit timer. An acknowledgment of the sent packets is\n"
+     "requested if it does not arrive within one tick, and the packets are sent\n"
+     "again if it does not arrive within three ticks.",
+     ucs_offsetof(uct_udp_iface_config_t, timer_tick), UCS_CONFIG_TYPE_TIME},
+
+    {"MAX_PASSIVE_EPS", "256",
+     "Maximal number of endpoints which connection requests of a remote interface\n"
+     "create before the user connects to it. Further requests of the remote\n"
+     "interface are dropped, and accepted when it sends them again.",
+     ucs_offsetof(uct_udp_iface_config_t, max_passive_eps), UCS_CONFIG_TYPE_UINT},
+
+    {"LOSS_RATE", "0",
+     "Probability of dropping a sent packet, to test the reliability protocol.",
+     ucs_offsetof(uct_udp_iface_config_t, loss_rate), UCS_CONFIG_TYPE_DOUBLE},
+
+    UCT_IFACE_MPOOL_CONFIG_FIELDS("RX_", -1, 16, "receive",
+                                  ucs_offsetof(uct_udp_iface_config_t, mp), ""),
+
+    {NULL}
+};
+
+static ucs_mpool_ops_t uct_udp_tx_mpool_ops = {
+    .chunk_alloc   = ucs_mpool_chunk_malloc,
+    .chunk_release = ucs_mpool_chunk_free,
+    .obj_init      = NULL,
+    .obj_cleanup   = NULL
+};
+
+static uct_udp_iface_peer_t *
+uct_udp_iface_cep_lookup_peer(uct_udp_iface_t *iface,
+                              const struct sockaddr_in *addr)
+{
+    uct_udp_iface_peer_t key;
+
+    key.addr = *addr;
+    return sglib_hashed_uct_udp_iface_peer_t_find_member(iface->peers, &key);
+}
+
+static uct_udp_ep_t *
+uct_udp_iface_cep_lookup_ep(uct_udp_iface_peer_t *peer, uint32_t conn_id)
+{
+    uct_udp_ep_t *ep;
+    uint32_t id;
+
+    id = (conn_id != UCT_UD_EP_CONN_ID_MAX) ? conn_id : peer->conn_id_last;
+    ucs_list_for_each(ep, &peer->ep_list, cep_list) {
+        if (ep->conn_id == id) {
+            return ep;
+        }
+        if (ep->conn_id < id) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+uct_udp_ep_t *uct_udp_iface_cep_lookup(uct_udp_iface_t *iface,
+                                       const struct sockaddr_in *addr,
+                                       uint32_t conn_id)
+{
+    uct_udp_iface_peer_t *peer;
+    uct_udp_ep_t *ep;
+
+    peer = uct_udp_iface_cep_lookup_peer(iface, addr);
+    if (peer == NULL) {
+        return NULL;
+    }
+
+    /* a new connection claims the endpoint of the peer's request */
+    ep = uct_udp_iface_cep_lookup_ep(peer, conn_id);
+    if ((ep != NULL) && (conn_id == UCT_UD_EP_CONN_ID_MAX)) {
+        ++peer->conn_id_last;
+    }
+    return ep;
+}
+
+ucs_status_t uct_udp_iface_cep_insert(uct_udp_iface_t *iface,
+                                      const struct sockaddr_in *addr,
+                                      uct_udp_ep_t *ep, uint32_t conn_id)
+{
+    uct_udp_iface_peer_t *peer;
+    uct_udp_ep_t *cep;
+
+    peer = uct_udp_iface_cep_lookup_peer(iface, addr);
+    if (peer == NULL) {
+        peer = ucs_malloc(sizeof(*peer), "udp_peer");
+        if (peer == NULL) {
+            return UCS_ERR_NO_MEMORY;
+        }
+        peer->addr         = *addr;
+        peer->conn_id_last = 0;
+        ucs_list_head_init(&peer->ep_list);
+        sglib_hashed_uct_udp_iface_peer_t_add(iface->peers, peer);
+    }
+
+    if (conn_id == UCT_UD_EP_CONN_ID_MAX) {
+        conn_id = peer->conn_id_last++;
+        if (conn_id == UCT_UD_EP_CONN_ID_MAX) {
+            return UCS_ERR_NO_RESOURCE;
+        }
+    } else if ((conn_id < peer->conn_id_last) ||
+               (conn_id - peer->conn_id_last >= iface->config.max_passive_eps)) {
+        /* the request is of a connection which the user has already claimed,
+         * or too far ahead of the connections of the user */
+        return UCS_ERR_EXCEEDS_LIMIT;
+    }
+    ep->conn_id = conn_id;
+
+    /* the list is ordered by descending connection id */
+    ucs_list_for_each(cep, &peer->ep_list, cep_list) {
+        ucs_assert_always(cep->conn_id != ep->conn_id);
+        if (cep->conn_id < ep->conn_id) {
+            ucs_list_insert_before(&cep->cep_list, &ep->cep_list);
+            return UCS_OK;
+        }
+    }
+    ucs_list_add_tail(&peer->ep_list, &ep->cep_list);
+    return UCS_OK;
+}
+
+void uct_udp_iface_cep_remove(uct_udp_ep_t *ep)
+{
+    if (ucs_list_is_empty(&ep->cep_list)) {
+        return;
+    }
+    ucs_list_del(&ep->cep_list);
+    ucs_list_head_init(&ep->cep_list);
+}
+
+void uct_udp_iface_cep_cleanup(uct_udp_iface_t *iface)
+{
+    struct sglib_hashed_uct_udp_iface_peer_t_iterator it_peer;
+    uct_udp_iface_peer_t *peer;
+    uct_udp_ep_t *ep, *tmp;
+
+    for (peer = sglib_hashed_uct_udp_iface_peer_t_it_init(&it_peer,
+                                                          iface->peers);
+         peer != NULL;
+         peer = sglib_hashed_uct_udp_iface_peer_t_it_next(&it_peer)) {
+
+        /* endpoints which were created by requests of the peer, and were not
+         * claimed by a connection of the user, are owned by the interface */
+        ucs_list_for_each_safe(ep, tmp, &peer->ep_list, cep_list) {
+            if (ep->conn_id >= peer->conn_id_last) {
+                uct_ep_destroy(&ep->super.super);
+            }
+        }
+        ucs_free(peer);
+    }
+}
+
+static ucs_status_t uct_udp_iface_get_device_address(uct_iface_t *tl_iface,
+                                                     uct_device_addr_t *addr)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+    uct_udp_device_addr_t *udp_addr = (uct_udp_device_addr_t*)addr;
+
+    udp_addr->guid    = iface->guid;
+    udp_addr->in_addr = iface->addr.sin_addr;
+    return UCS_OK;
+}
+
+static ucs_status_t uct_udp_iface_get_address(uct_iface_t *tl_iface,
+                                              uct_iface_addr_t *addr)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+
+    *(in_port_t*)addr = iface->addr.sin_port;
+    return UCS_OK;
+}
+
+static int uct_udp_iface_is_reachable(uct_iface_t *tl_iface,
+                                      const uct_device_addr_t *addr)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+    const uct_udp_device_addr_t *udp_addr = (const void*)addr;
+
+    return uct_netif_is_reachable(iface->addr.sin_addr, iface->netmask,
+                                  iface->guid, udp_addr->in_addr,
+                                  udp_addr->guid);
+}
+
+static ucs_status_t uct_udp_iface_query(uct_iface_h tl_iface,
+                                        uct_iface_attr_t *iface_attr)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+    size_t seg_size = iface->config.seg_size;
+
+    memset(iface_attr, 0, sizeof(uct_iface_attr_t));
+
+    iface_attr->cap.put.max_short      = seg_size - sizeof(uct_udp_put_hdr_t);
+    iface_attr->cap.put.max_bcopy      = seg_size - sizeof(uct_udp_put_hdr_t);
+    iface_attr->cap.am.max_short       = seg_size;
+    iface_attr->cap.am.max_bcopy       = seg_size;
+    iface_attr->iface_addr_len         = sizeof(in_port_t);
+    iface_attr->device_addr_len        = sizeof(uct_udp_device_addr_t);
+    iface_attr->ep_addr_len            = sizeof(uct_udp_ep_addr_t);
+    iface_attr->cap.flags              = UCT_IFACE_FLAG_PUT_SHORT        |
+                                         UCT_IFACE_FLAG_PUT_BCOPY        |
+                                         UCT_IFACE_FLAG_AM_SHORT         |
+                                         UCT_IFACE_FLAG_AM_BCOPY         |
+                                         UCT_IFACE_FLAG_PENDING          |
+                                         UCT_IFACE_FLAG_AM_CB_SYNC       |
+                                         UCT_IFACE_FLAG_AM_CB_ASYNC      |
+                                         UCT_IFACE_FLAG_CONNECT_TO_IFACE |
+                                         UCT_IFACE_FLAG_CONNECT_TO_EP;
+
+    /* every packet costs a system call on both sides */
+    iface_attr->latency                = 10e-6;
+    iface_attr->bandwidth              = 100 * 1024.0 * 1024.0;
+    iface_attr->overhead               = 10e-6;
+    return UCS_OK;
+}
+
+static void uct_udp_iface_release_am_desc(uct_iface_t *tl_iface, void *desc)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+
+    uct_udp_enter(iface);
+    ucs_mpool_put(ucs_container_of((uct_am_recv_desc_t*)desc - 1,
+                                   uct_udp_recv_desc_t, super));
+    uct_udp_leave(iface);
+}
+
+void uct_udp_iface_send(uct_udp_iface_t *iface, uct_udp_ep_t *ep,
+                        uct_ud_neth_t *neth, size_t length)
+{
+    if (ucs_unlikely(iface->config.loss_rate > 0) &&
+        (rand_r(&iface->loss_seed) < iface->config.loss_rate * RAND_MAX)) {
+        ucs_trace_data("udp ep %p: dropped packet psn %u", ep, neth->psn);
+        return;
+    }
+
+    /* a packet which is not sent is lost, and sent again by the reliability
+     * protocol if it is in the send window */
+    if (sendto(iface->fd, neth, length, MSG_DONTWAIT,
+               (struct sockaddr*)&ep->dest_addr, sizeof(ep->dest_addr)) < 0) {
+        ucs_debug("udp ep %p: sendto(%s:%d) failed: %m", ep,
+                  inet_ntoa(ep->dest_addr.sin_addr),
+                  ntohs(ep->dest_addr.sin_port));
+    }
+}
+
+static unsigned uct_udp_iface_progress_rx(uct_udp_iface_t *iface, int is_async)
+{
+    struct sockaddr_in src_addr;
+    uct_udp_recv_desc_t *desc;
+    struct iovec iov[2];
+    struct msghdr msg;
+    uct_ud_neth_t neth;
+    unsigned count;
+    ssize_t ret;
+
+    for (count = 0; count < UCT_UDP_MAX_RX; ++count) {
+        /* the datagrams wait in the socket until descriptors are released */
+        desc = ucs_mpool_get(&iface->rx_desc_mp);
+        if (desc == NULL) {
+            break;
+        }
+
+        /* the payload is received after the headroom of the user, and the
+         * network header is not passed to the user */
+        iov[0].iov_base = &neth;
+        iov[0].iov_len  = sizeof(neth);
+        iov[1].iov_base = (void*)(&desc->super + 1) + iface->rx_headroom;
+        iov[1].iov_len  = iface->config.seg_size;
+
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name    = &src_addr;
+        msg.msg_namelen = sizeof(src_addr);
+        msg.msg_iov     = iov;
+        msg.msg_iovlen  = 2;
+
+        ret = recvmsg(iface->fd, &msg, MSG_DONTWAIT);
+        if (ret < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                ucs_error("recvmsg() failed: %m");
+            }
+            ucs_mpool_put(desc);
+            break;
+        }
+
+        if ((ret < sizeof(neth)) || (msg.msg_flags & MSG_TRUNC)) {
+            ucs_debug("udp iface %p: dropped invalid datagram of %zd bytes from"
+                      " %s:%d", iface, ret, inet_ntoa(src_addr.sin_addr),
+                      ntohs(src_addr.sin_port));
+            ucs_mpool_put(desc);
+            continue;
+        }
+
+        uct_udp_ep_process_rx(iface, &src_addr, &neth, desc, ret - sizeof(neth),
+                              is_async);
+    }
+
+    return count;
+}
+
+/* Active messages which were received in async progress go first */
+static unsigned uct_udp_iface_dispatch_pending_rx(uct_udp_iface_t *iface)
+{
+    uct_udp_recv_desc_t *desc;
+    void *rx_desc;
+    ucs_status_t status;
+    unsigned count;
+
+    count = 0;
+    while (!ucs_queue_is_empty(&iface->rx_pending_q)) {
+        desc    = ucs_queue_pull_elem_non_empty(&iface->rx_pending_q,
+                                                uct_udp_recv_desc_t, queue);
+        rx_desc = &desc->super + 1;
+        status  = uct_iface_invoke_am(&iface->super, desc->am_id,
+                                      rx_desc + iface->rx_headroom,
+                                      desc->length, rx_desc);
+        if (status == UCS_OK) {
+            ucs_mpool_put(desc);
+        } else {
+            uct_recv_desc_iface(rx_desc) = &iface->super.super;
+        }
+        ++count;
+    }
+    return count;
+}
+
+static void uct_udp_iface_free_pending_rx(uct_udp_iface_t *iface)
+{
+    uct_udp_recv_desc_t *desc;
+
+    ucs_queue_for_each_extract(desc, &iface->rx_pending_q, queue, 1) {
+        ucs_mpool_put(desc);
+    }
+}
+
+unsigned uct_udp_iface_progress(void *arg)
+{
+    uct_udp_iface_t *iface = arg;
+    unsigned count;
+
+    uct_udp_enter(iface);
+    count  = uct_udp_iface_dispatch_pending_rx(iface);
+    count += uct_udp_iface_progress_rx(iface, 0);
+    ucs_twheel_sweep(&iface->slow_timer, ucs_get_time());
+    count += uct_udp_iface_progress_pending(iface, 0);
+    uct_udp_leave(iface);
+    return count;
+}
+
+/*
+ * Acks and resends do not wait for the user to progress, so a peer which
+ * sends without progress gets its send window back.
+ */
+static void uct_udp_iface_async_progress(uct_udp_iface_t *iface)
+{
+    while (uct_udp_iface_progress_rx(iface, 1) == UCT_UDP_MAX_RX);
+    ucs_twheel_sweep(&iface->slow_timer, ucs_get_time());
+    uct_udp_iface_progress_pending(iface, 1);
+}
+
+static void uct_udp_iface_event(void *arg)
+{
+    uct_udp_iface_t *iface = arg;
+
+    uct_udp_enter(iface);
+    uct_udp_iface_async_progress(iface);
+    uct_udp_leave(iface);
+}
+
+static void uct_udp_iface_timer(void *arg)
+{
+    uct_udp_iface_t *iface = arg;
+
+    uct_udp_enter(iface);
+    ucs_trace_async("udp iface %p: slow timer sweep", iface);
+    uct_udp_iface_async_progress(iface);
+    uct_udp_leave(iface);
+}
+
+static ucs_status_t uct_udp_iface_flush(uct_iface_h tl_iface)
+{
+    uct_udp_iface_t *iface = ucs_derived_of(tl_iface, uct_udp_iface_t);
+    ucs_status_t status = UCS_OK;
+    uct_udp_ep_t *ep;
+    int i;
+
+    uct_udp_enter(iface);
+    ucs_ptr_array_for_each(ep, i, &iface->eps) {
+        if (uct_udp_ep_flush_nolock(iface, ep) != UCS_OK) {
+            status = UCS_INPROGRESS;
+        }
+    }
+    uct_udp_leave(iface);
+
+    if (status != UCS_OK) {
+        UCT_TL_IFACE_STAT_FLUSH_WAIT(&iface->super);
+        return status;
+    }
+
+    UCT_TL_IFACE_STAT_FLUSH(&iface->super);
+    return UCS_OK;
+}
+
+static UCS_CLASS_DECLARE_DELETE_FUNC(uct_udp_iface_t, uct_iface_t);
+
+static uct_iface_ops_t uct_udp_iface_ops = {
+    .iface_close         = UCS_CLASS_DELETE_FUNC_NAME(uct_udp_iface_t),
+    .iface_query         = uct_udp_iface_query,
+    .iface_flush         = uct_udp_iface_flush,
+    .iface_get_address   = uct_udp_iface_get_address,
+    .iface_get_device_address = uct_udp_iface_get_device_address,
+    .iface_is_reachable  = uct_udp_iface_is_reachable,
+    .iface_release_am_desc = uct_udp_iface_release_am_desc,
+    .ep_put_short        = uct_udp_ep_put_short,
+    .ep_put_bcopy        = uct_udp_ep_put_bcopy,
+    .ep_am_short         = uct_udp_ep_am_short,
+    .ep_am_bcopy         = uct_udp_ep_am_bcopy,
+    .ep_pending_add      = uct_udp_ep_pending_add,
+    .ep_pending_purge    = uct_udp_ep_pending_purge,
+    .ep_flush            = uct_udp_ep_flush,
+    .ep_create           = uct_udp_ep_create,
+    .ep_create_connected = uct_udp_ep_create_connected,
+    .ep_get_address      = uct_udp_ep_get_address,
+    .ep_connect_to_ep    = uct_udp_ep_connect_to_ep,
+    .ep_destroy          = UCS_CLASS_DELETE_FUNC_NAME(uct_udp_ep_t),
+};
+
+static ucs_status_t uct_udp_iface_socket_init(uct_udp_iface_t *iface,
+                                              uct_udp_iface_config_t *config)
+{
+    socklen_t addrlen;
+    int value;
+
+    iface->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (iface->fd < 0) {
+        ucs_error("socket() failed: %m");
+        return UCS_ERR_IO_ERROR;
+    }
+
+    if (config->sndbuf != UCS_CONFIG_MEMUNITS_AUTO) {
+        value = config->sndbuf;
+        if (setsockopt(iface->fd, SOL_SOCKET, SO_SNDBUF, &value,
+                       sizeof(value)) < 0) {
+            ucs_error("setsockopt(SO_SNDBUF) failed: %m");
+            goto err_close;
+        }
+    }
+
+    if (config->rcvbuf != UCS_CONFIG_MEMUNITS_AUTO) {
+        value = config->rcvbuf;
+        if (setsockopt(iface->fd, SOL_SOCKET, SO_RCVBUF, &value,
+                       sizeof(value)) < 0) {
+            ucs_error("setsockopt(SO_RCVBUF) failed: %m");
+            goto err_close;
+        }
+    }
+
+    /* bind to an ephemeral port of the interface address */
+    iface->addr.sin_port = 0;
+    if (bind(iface->fd, (struct sockaddr*)&iface->addr,
+             sizeof(iface->addr)) < 0) {
+        ucs_error("bind(%s) failed: %m", inet_ntoa(iface->addr.sin_addr));
+        goto err_close;
+    }
+
+    addrlen = sizeof(iface->addr);
+    if (getsockname(iface->fd, (struct sockaddr*)&iface->addr, &addrlen) < 0) {
+        ucs_error("getsockname() failed: %m");
+        goto err_close;
+    }
+
+    return UCS_OK;
+
+err_close:
+    close(iface->fd);
+    return UCS_ERR_IO_ERROR;
+}
+
+static UCS_CLASS_INIT_FUNC(uct_udp_iface_t, uct_pd_h pd, uct_worker_h worker,
+                           const char *dev_name, size_t rx_headroom,
+                           const uct_iface_config_t *tl_config)
+{
+    uct_udp_iface_config_t *config = ucs_derived_of(tl_config,
+                                                    uct_udp_iface_config_t);
+    ucs_async_context_t *async = worker->async;
+    ucs_status_t status;
+
+    UCS_CLASS_CALL_SUPER_INIT(uct_base_iface_t, &uct_udp_iface_ops, pd, worker,
+                              tl_config UCS_STATS_ARG(NULL));
+
+    if (async == NULL) {
+        ucs_error("%s udp iface must have valid async context", dev_name);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if ((config->seg_size < sizeof(uct_udp_put_hdr_t) + sizeof(uint64_t)) ||
+        (config->seg_size > UCT_UDP_MAX_DGRAM - sizeof(uct_ud_neth_t))) {
+        ucs_error("Invalid udp segment size: %zu", config->seg_size);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    if ((config->loss_rate < 0) || (config->loss_rate >= 1)) {
+        ucs_error("Invalid udp loss rate: %f", config->loss_rate);
+        return UCS_ERR_INVALID_PARAM;
+    }
+
+    self->rx_headroom       = rx_headroom;
+    self->guid              = ucs_machine_guid();
+    self->loss_seed         = ucs_generate_uuid(0);
+    self->config.seg_size   = config->seg_size;
+    self->config.timer_tick = ucs_time_from_sec(config->timer_tick);
+    self->config.loss_rate  = config->loss_rate;
+    self->config.max_passive_eps = config->max_passive_eps;
+    ucs_queue_head_init(&self->rx_pending_q);
+    ucs_arbiter_init(&self->arbiter);
+    self->pending_q_len     = 0;
+    self->in_pending        = 0;
+    ucs_ptr_array_init(&self->eps, 0, "udp_eps");
+    sglib_hashed_uct_udp_iface_peer_t_init(self->peers);
+
+    memset(&self->addr, 0, sizeof(self->addr));
+    self->addr.sin_family = AF_INET;
+    status = uct_netif_inaddr(dev_name, &self->addr.sin_addr,
+                              &self->netmask);
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    status = ucs_twheel_init(&self->slow_timer, self->config.timer_tick / 4,
+                             ucs_get_time());
+    if (status != UCS_OK) {
+        goto err;
+    }
+
+    status = uct_udp_iface_socket_init(self, config);
+    if (status != UCS_OK) {
+        goto err_cleanup_twheel;
+    }
+
+    status = uct_iface_mpool_init(&self->super, &self->rx_desc_mp,
+                                  sizeof(uct_udp_recv_desc_t) + rx_headroom +
+                                  self->config.seg_size,
+                                  sizeof(uct_udp_recv_desc_t),
+                                  UCS_SYS_CACHE_LINE_SIZE, &config->mp, 16,
+                                  ucs_empty_function, "udp_rx_desc");
+    if (status != UCS_OK) {
+        goto err_close;
+    }
+
+    status = ucs_mpool_init(&self->tx_mp, 0,
+                            sizeof(uct_udp_send_skb_t) + sizeof(uct_ud_neth_t) +
+                            self->config.seg_size,
+                            0, UCS_SYS_CACHE_LINE_SIZE, 128, UINT_MAX,
+                            &uct_udp_tx_mpool_ops, "udp_tx_skb");
+    if (status != UCS_OK) {
+        goto err_cleanup_rx_mp;
+    }
+
+    status = ucs_async_add_timer(async->mode, self->config.timer_tick,
+                                 uct_udp_iface_timer, self, async,
+                                 &self->timer_id);
+    if (status != UCS_OK) {
+        goto err_cleanup_tx_mp;
+    }
+
+    status = ucs_async_set_event_handler(async->mode, self->fd, POLLIN,
+                                         uct_udp_iface_event, self, async);
+    if (status != UCS_OK) {
+        goto err_remove_timer;
+    }
+
+    /* receive connection requests even without endpoints */
+    uct_worker_progress_register(worker, uct_udp_iface_progress, self);
+
+    ucs_debug("udp iface %p: bound to %s:%d", self,
+              inet_ntoa(self->addr.sin_addr), ntohs(self->addr.sin_port));
+    return UCS_OK;
+
+err_remove_timer:
+    ucs_async_remove_timer(self->timer_id);
+err_cleanup_tx_mp:
+    ucs_mpool_cleanup(&self->tx_mp, 1);
+err_cleanup_rx_mp:
+    ucs_mpool_cleanup(&self->rx_desc_mp, 1);
+err_close:
+    close(self->fd);
+err_cleanup_twheel:
+    ucs_twheel_cleanup(&self->slow_timer);
+err:
+    ucs_ptr_array_cleanup(&self->eps);
+    ucs_arbiter_cleanup(&self->arbiter);
+    return status;
+}
+
+static UCS_CLASS_CLEANUP_FUNC(uct_udp_iface_t)
+{
+    ucs_async_unset_event_handler(self->fd);
+    ucs_async_remove_timer(self->timer_id);
+    uct_worker_progress_unregister(self->super.worker, uct_udp_iface_progress,
+                                   self);
+
+    uct_udp_enter(self);
+    uct_udp_iface_cep_cleanup(self);
+    uct_udp_iface_free_pending_rx(self);
+    uct_udp_leave(self);
+    ucs_mpool_cleanup(&self->tx_mp, 1);
+    ucs_mpool_cleanup(&self->rx_desc_mp, 1);
+    ucs_twheel_cleanup(&self->slow_timer);
+    ucs_ptr_array_cleanup(&self->eps);
+    ucs_arbiter_cleanup(&self->arbiter);
+    close(self->fd);
+}
+
+UCS_CLASS_DEFINE(uct_udp_iface_t, uct_base_iface_t);
+
+static UCS_CLASS_DEFINE_NEW_FUNC(uct_udp_iface_t, uct_iface_t, uct_pd_h,
+                                 uct_worker_h, const char *, size_t,
+                                 const uct_iface_config_t *);
+static UCS_CLASS_DEFINE_DELETE_FUNC(uct_udp_iface_t, uct_iface_t);
+
+static ucs_status_t uct_udp_query_tl_resources(uct_pd_h pd,
+                                               uct_tl_resource_desc_t **resource_p,
+                                               unsigned *num_resources_p)
+{
+    return uct_netif_query_tl_resources(UCT_UDP_NAME, resource_p,
+                                        num_resources_p);
+}
+
+UCT_TL_COMPONENT_DEFINE(uct_udp_tl,
+                        uct_udp_query_tl_resources,
+                        uct_udp_iface_t,
+                        UCT_UDP_NAME,
+                        "UDP_",
+                        uct_udp_iface_config_table,
+                        uct_udp_iface_config_t);
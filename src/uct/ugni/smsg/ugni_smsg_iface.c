@@ -168,22 +168,27 @@ static ucs_status_t progress_remote_cq(uct_ugni_smsg_iface_t *iface){
 
 UCS_CLASS_DEFINE_DELETE_FUNC(uct_ugni_smsg_iface_t, uct_iface_t);
 
-static void uct_ugni_smsg_progress(void *arg)
+static unsigned uct_ugni_smsg_progress(void *arg)
 {
     uct_ugni_smsg_iface_t *iface = (uct_ugni_smsg_iface_t *)arg;
     ucs_status_t status;
+    unsigned count = 0;
 
     do {
         status = progress_local_cq(iface);
+        count += (status == UCS_INPROGRESS);
     } while(status == UCS_INPROGRESS);
     do {
          status = progress_remote_cq(iface);
+         count += (status == UCS_INPROGRESS);
     } while(status == UCS_INPROGRESS);
 
     /* have a go a processing the pending queue */
 
-    ucs_arbiter_dispatch(&iface->super.arbiter, iface->config.smsg_max_credit,
-                         uct_ugni_ep_process_pending, NULL);
+    count += ucs_arbiter_dispatch(&iface->super.arbiter,
+                                  iface->config.smsg_max_credit,
+                                  uct_ugni_ep_process_pending, NULL);
+    return count;
 }
 
 static void uct_ugni_smsg_iface_release_am_desc(uct_iface_t *tl_iface, void *desc)
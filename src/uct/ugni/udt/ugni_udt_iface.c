@@ -28,7 +28,7 @@ static ucs_config_field_t uct_ugni_udt_iface_config_table[] = {
     {NULL}
 };
 
-static void uct_ugni_udt_progress(void *arg)
+static unsigned uct_ugni_udt_progress(void *arg)
 {
     uint32_t rem_addr,
              rem_id;
@@ -46,6 +46,7 @@ static void uct_ugni_udt_progress(void *arg)
     gni_ep_handle_t ugni_ep;
     gni_post_state_t post_state;
     gni_return_t ugni_rc;
+    unsigned count = 0;
 
     pthread_mutex_lock(&uct_ugni_global_lock);
     ugni_rc = GNI_PostDataProbeById(iface->super.nic_handle, &id);
@@ -134,11 +135,14 @@ static void uct_ugni_udt_progress(void *arg)
         --ep->super.outstanding;
         ep->posted_desc = NULL;
     }
+    count = 1;
 
 exit:
     pthread_mutex_unlock(&uct_ugni_global_lock);
     /* have a go a processing the pending queue */
-    ucs_arbiter_dispatch(&iface->super.arbiter, 1, uct_ugni_ep_process_pending, NULL);
+    count += ucs_arbiter_dispatch(&iface->super.arbiter, 1,
+                                  uct_ugni_ep_process_pending, NULL);
+    return count;
 }
 
 static void uct_ugni_udt_iface_release_am_desc(uct_iface_t *tl_iface, void *desc)
@@ -0,0 +1,136 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "test_ucp_tag.h"
+
+#include <common/test_helpers.h>
+extern "C" {
+#include <ucs/time/time.h>
+}
+
+#include <string>
+
+
+class test_ucp_am : public test_ucp_tag {
+public:
+    static ucp_params_t get_ctx_params() {
+        ucp_params_t params = test_ucp_tag::get_ctx_params();
+        params.features    |= UCP_FEATURE_AM;
+        return params;
+    }
+
+protected:
+    static const uint16_t AM_ID = 7;
+
+    struct am_message {
+        std::string         header;
+        std::string         data;
+        const void          *data_ptr;
+        void                *desc;
+    };
+
+    virtual void init() {
+        test_ucp_tag::init();
+        m_keep    = false;
+        m_counter = 0;
+        ASSERT_UCS_OK(ucp_worker_set_am_handler(receiver->worker(), AM_ID,
+                                                am_handler, this));
+    }
+
+    static ucs_status_t am_handler(void *arg, const void *header,
+                                   size_t header_length, void *data,
+                                   size_t length, void *desc) {
+        test_ucp_am *self = reinterpret_cast<test_ucp_am*>(arg);
+        am_message msg;
+
+        msg.header.assign((const char*)header, header_length);
+        msg.data.assign((const char*)data, length);
+        msg.data_ptr = data;
+        msg.desc     = self->m_keep ? desc : NULL;
+        self->m_messages.push_back(msg);
+        ++self->m_counter;
+        return self->m_keep ? UCS_INPROGRESS : UCS_OK;
+    }
+
+    void am_send(const std::string& header, const std::string& data) {
+        request *req;
+
+        req = (request*)ucp_am_send_nb(sender->ep(), AM_ID, header.data(),
+                                       header.size(), data.data(), data.size(),
+                                       DATATYPE, send_callback);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(req));
+        if (req != NULL) {
+            wait(req);
+            request_release(req);
+        }
+    }
+
+    void wait_for_messages(unsigned count) {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+        while ((m_counter < count) && (ucs_get_time() < deadline)) {
+            progress();
+        }
+        ASSERT_EQ(count, m_counter);
+    }
+
+    void test_xfer(size_t header_size, size_t data_size) {
+        std::string header(header_size, 0), data(data_size, 0);
+
+        ucs::fill_random(header.begin(), header.end());
+        ucs::fill_random(data.begin(), data.end());
+        am_send(header, data);
+        wait_for_messages(1);
+
+        EXPECT_EQ(header, m_messages[0].header);
+        EXPECT_EQ(data,   m_messages[0].data);
+    }
+
+    bool                    m_keep;
+    unsigned                m_counter;
+    std::vector<am_message> m_messages;
+};
+
+UCS_TEST_P(test_ucp_am, short_no_header) {
+    test_xfer(0, 8);
+}
+
+UCS_TEST_P(test_ucp_am, header_only) {
+    test_xfer(16, 0);
+}
+
+UCS_TEST_P(test_ucp_am, medium) {
+    test_xfer(32, 200);
+}
+
+UCS_TEST_P(test_ucp_am, large) {
+    test_xfer(32, 50000);
+}
+
+UCS_TEST_P(test_ucp_am, keep_desc) {
+    static const size_t sizes[] = { 8, 500, 50000 };
+    static const unsigned num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    std::vector<std::string> datas;
+    unsigned i;
+
+    m_keep = true;
+    for (i = 0; i < num_sizes; ++i) {
+        datas.push_back(std::string(sizes[i], 0));
+        ucs::fill_random(datas.back().begin(), datas.back().end());
+        am_send("hdr", datas.back());
+    }
+    wait_for_messages(num_sizes);
+
+    /* Message contents must stay valid until the descriptor is released */
+    short_progress_loop();
+    for (i = 0; i < num_sizes; ++i) {
+        ASSERT_TRUE(m_messages[i].desc != NULL);
+        EXPECT_EQ(datas[i], std::string((const char*)m_messages[i].data_ptr,
+                                        sizes[i]));
+        ucp_am_desc_release(receiver->worker(), m_messages[i].desc);
+    }
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_am)
@@ -6,6 +6,13 @@
 
 #include "test_ucp_memheap.h"
 
+extern "C" {
+#include <ucp/core/ucp_mm.h>
+#include <ucp/core/ucp_worker.h>
+}
+
+#include <sys/mman.h>
+
 
 class test_ucp_mmap : public test_ucp_memheap {
 public:
@@ -120,4 +127,184 @@ UCS_TEST_P(test_ucp_mmap, dummy_mem) {
     }
 }
 
+UCS_TEST_P(test_ucp_mmap, bounce, "BOUNCE_SIZE=4k", "BOUNCE_MAX_BUFS=2") {
+    static const size_t size = 4096;
+    entity *e = create_entity();
+    ucp_context_h context = e->ucph();
+    ucp_worker_h worker = e->worker();
+    ucp_bounce_desc_t *desc1, *desc2;
+    ucp_rsc_index_t pd_index;
+
+    for (pd_index = 0; pd_index < context->num_pds; ++pd_index) {
+        if (context->pd_attrs[pd_index].cap.flags & UCT_PD_FLAG_REG) {
+            break;
+        }
+    }
+    if (pd_index == context->num_pds) {
+        UCS_TEST_SKIP_R("no memory registration support");
+    }
+
+    std::vector<char> buf1(size), buf2(size), buf3(size), large(size + 1);
+    ucs::fill_random(buf1.begin(), buf1.end());
+
+    desc1 = ucp_worker_bounce_get(worker, pd_index, &buf1[0], buf1.size());
+    ASSERT_TRUE(desc1 != NULL);
+    EXPECT_EQ(0, memcmp(desc1 + 1, &buf1[0], buf1.size()));
+
+    /* A buffer which is sent again should be registered */
+    EXPECT_TRUE(ucp_worker_bounce_get(worker, pd_index, &buf1[0],
+                                      buf1.size()) == NULL);
+
+    /* Larger than a bounce buffer */
+    EXPECT_TRUE(ucp_worker_bounce_get(worker, pd_index, &large[0],
+                                      large.size()) == NULL);
+
+    /* Pool is limited to 2 buffers */
+    desc2 = ucp_worker_bounce_get(worker, pd_index, &buf2[0], buf2.size());
+    ASSERT_TRUE(desc2 != NULL);
+    EXPECT_TRUE(ucp_worker_bounce_get(worker, pd_index, &buf3[0],
+                                      buf3.size()) == NULL);
+
+    ucs_mpool_put(desc1);
+    ucs_mpool_put(desc2);
+}
+
+UCS_TEST_P(test_ucp_mmap, sym_heap, "SYM_HEAP_SIZE=1m") {
+    static const size_t sizes[] = { 100, 4096, 10000, 64 };
+    static const size_t num_allocs = sizeof(sizes) / sizeof(sizes[0]);
+    entity *pe0 = create_entity();
+    entity *pe1 = create_entity();
+    ucp_mem_h heap0, heap1, memh0[num_allocs], memh1[num_allocs], memh;
+    void *base0, *base1, *ptr0[num_allocs], *ptr1[num_allocs], *ptr;
+    size_t length0, length1, i;
+    ucs_status_t status;
+
+    status = ucp_mem_sym_heap_query(pe0->ucph(), &base0, &length0, &heap0);
+    ASSERT_UCS_OK(status);
+    status = ucp_mem_sym_heap_query(pe1->ucph(), &base1, &length1, &heap1);
+    ASSERT_UCS_OK(status);
+    EXPECT_GE(length0, 1024ul * 1024ul);
+
+    /* The same sequence of calls allocates at the same offsets */
+    for (i = 0; i < num_allocs; ++i) {
+        ptr0[i] = ptr1[i] = NULL;
+        status = ucp_mem_map(pe0->ucph(), &ptr0[i], sizes[i],
+                             UCP_MEM_MAP_SYMMETRIC, &memh0[i]);
+        ASSERT_UCS_OK(status);
+        status = ucp_mem_map(pe1->ucph(), &ptr1[i], sizes[i],
+                             UCP_MEM_MAP_SYMMETRIC, &memh1[i]);
+        ASSERT_UCS_OK(status);
+
+        EXPECT_EQ((char*)ptr0[i] - (char*)base0, (char*)ptr1[i] - (char*)base1);
+        EXPECT_LE((char*)ptr0[i] + sizes[i], (char*)base0 + length0);
+        if (i > 0) {
+            EXPECT_GE((char*)ptr0[i], (char*)ptr0[i - 1] + sizes[i - 1]);
+        }
+    }
+
+    /* A released range is reused */
+    status = ucp_mem_unmap(pe0->ucph(), memh0[1]);
+    ASSERT_UCS_OK(status);
+    status = ucp_mem_unmap(pe1->ucph(), memh1[1]);
+    ASSERT_UCS_OK(status);
+
+    ptr = ptr0[1];
+    ptr0[1] = ptr1[1] = NULL;
+    status = ucp_mem_map(pe0->ucph(), &ptr0[1], sizes[1],
+                         UCP_MEM_MAP_SYMMETRIC, &memh0[1]);
+    ASSERT_UCS_OK(status);
+    status = ucp_mem_map(pe1->ucph(), &ptr1[1], sizes[1],
+                         UCP_MEM_MAP_SYMMETRIC, &memh1[1]);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(ptr, ptr0[1]);
+    EXPECT_EQ((char*)ptr0[1] - (char*)base0, (char*)ptr1[1] - (char*)base1);
+
+    /* Larger than the heap */
+    ptr = NULL;
+    status = ucp_mem_map(pe0->ucph(), &ptr, length0 + 1, UCP_MEM_MAP_SYMMETRIC,
+                         &memh);
+    EXPECT_EQ(UCS_ERR_NO_MEMORY, status);
+
+    /* One remote key of the heap is valid for all allocations */
+    pe0->connect(pe1);
+
+    void *rkey_buffer;
+    size_t rkey_size;
+    status = ucp_rkey_pack(pe1->ucph(), heap1, &rkey_buffer, &rkey_size);
+    if (status == UCS_OK) {
+        ucp_rkey_h rkey;
+        status = ucp_ep_rkey_unpack(pe0->ep(), rkey_buffer, &rkey);
+        ucp_rkey_buffer_release(rkey_buffer);
+        if (status == UCS_OK) {
+            for (i = 0; i < num_allocs; ++i) {
+                std::string data(sizes[i], 0);
+                ucs::fill_random(data.begin(), data.end());
+
+                status = ucp_put(pe0->ep(), &data[0], data.length(),
+                                 (uintptr_t)base1 +
+                                 ((char*)ptr0[i] - (char*)base0), rkey);
+                ASSERT_UCS_OK(status);
+                pe0->flush_worker();
+                EXPECT_EQ(data, std::string((char*)ptr1[i], data.length()));
+            }
+            ucp_rkey_destroy(rkey);
+        } else {
+            EXPECT_EQ(UCS_ERR_UNREACHABLE, status);
+        }
+    } else {
+        EXPECT_EQ(UCS_ERR_UNSUPPORTED, status);
+    }
+
+    for (i = 0; i < num_allocs; ++i) {
+        status = ucp_mem_unmap(pe0->ucph(), memh0[i]);
+        ASSERT_UCS_OK(status);
+        status = ucp_mem_unmap(pe1->ucph(), memh1[i]);
+        ASSERT_UCS_OK(status);
+    }
+}
+
+UCS_TEST_P(test_ucp_mmap, sym_heap_fixed_address) {
+    static const size_t length = 1024 * 1024;
+    void *address, *base, *ptr;
+    ucs_status_t status;
+    size_t heap_length;
+    ucp_mem_h heap, memh;
+
+    /* Find an unused range for the heap */
+    address = mmap(NULL, length, PROT_NONE, MAP_PRIVATE|MAP_ANON, -1, 0);
+    ASSERT_TRUE(address != MAP_FAILED);
+    munmap(address, length);
+
+    modify_config("SYM_HEAP_SIZE", "1m");
+    modify_config("SYM_HEAP_ADDRESS", ucs::to_string(address));
+    entity *e = create_entity();
+
+    status = ucp_mem_sym_heap_query(e->ucph(), &base, &heap_length, &heap);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(address, base);
+    EXPECT_EQ(length, heap_length);
+
+    ptr    = NULL;
+    status = ucp_mem_map(e->ucph(), &ptr, 100, UCP_MEM_MAP_SYMMETRIC, &memh);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(address, ptr);
+
+    status = ucp_mem_unmap(e->ucph(), memh);
+    ASSERT_UCS_OK(status);
+}
+
+UCS_TEST_P(test_ucp_mmap, sym_heap_disabled) {
+    entity *e = create_entity();
+    void *base, *ptr = NULL;
+    ucs_status_t status;
+    ucp_mem_h memh;
+    size_t length;
+
+    status = ucp_mem_sym_heap_query(e->ucph(), &base, &length, &memh);
+    EXPECT_EQ(UCS_ERR_UNSUPPORTED, status);
+
+    status = ucp_mem_map(e->ucph(), &ptr, 100, UCP_MEM_MAP_SYMMETRIC, &memh);
+    EXPECT_EQ(UCS_ERR_UNSUPPORTED, status);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_mmap)
@@ -0,0 +1,174 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "test_ucp_tag.h"
+
+#include <common/test_helpers.h>
+
+
+class test_ucp_stream : public test_ucp_tag {
+public:
+    static ucp_params_t get_ctx_params() {
+        ucp_params_t params = test_ucp_tag::get_ctx_params();
+        params.features    |= UCP_FEATURE_STREAM;
+        return params;
+    }
+
+protected:
+    virtual void init() {
+        test_ucp_tag::init();
+        receiver->connect(sender);
+    }
+
+    virtual void cleanup() {
+        receiver->disconnect();
+        test_ucp_tag::cleanup();
+    }
+
+    static void stream_recv_callback(void *request, ucs_status_t status,
+                                     size_t length) {
+        struct request *req = (struct request *)request;
+        ucs_assert(req->completed == false);
+        req->status      = status;
+        req->completed   = true;
+        req->info.length = length;
+    }
+
+    void stream_send(const void *buffer, size_t length) {
+        request *req;
+
+        req = (request*)ucp_stream_send_nb(sender->ep(), buffer, length,
+                                           DATATYPE, send_callback);
+        ASSERT_TRUE(!UCS_PTR_IS_ERR(req));
+        if (req != NULL) {
+            wait(req);
+            request_release(req);
+        }
+    }
+
+    request* stream_recv_nb(void *buffer, size_t length, unsigned flags,
+                            size_t *recv_length) {
+        request *req;
+
+        req = (request*)ucp_stream_recv_nb(receiver->ep(), buffer, length,
+                                           DATATYPE, stream_recv_callback,
+                                           recv_length, flags);
+        EXPECT_FALSE(UCS_PTR_IS_ERR(req));
+        return req;
+    }
+
+    size_t stream_recv(void *buffer, size_t length, unsigned flags) {
+        size_t recv_length = 0;
+        request *req;
+
+        req = stream_recv_nb(buffer, length, flags, &recv_length);
+        if (req != NULL) {
+            wait(req);
+            EXPECT_UCS_OK(req->status);
+            recv_length = req->info.length;
+            request_release(req);
+        }
+        return recv_length;
+    }
+};
+
+UCS_TEST_P(test_ucp_stream, send_recv_exp) {
+    std::string send_data(100, 0), recv_data(1000, 0);
+    size_t recv_length = 0;
+    request *req;
+
+    ucs::fill_random(send_data.begin(), send_data.end());
+
+    req = stream_recv_nb(&recv_data[0], recv_data.size(), 0, &recv_length);
+    ASSERT_TRUE(req != NULL);
+
+    stream_send(&send_data[0], send_data.size());
+    wait(req);
+    EXPECT_UCS_OK(req->status);
+    EXPECT_EQ(send_data.size(), req->info.length);
+    request_release(req);
+
+    recv_data.resize(send_data.size());
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_stream, send_recv_unexp_partial) {
+    static const size_t chunk = 7;
+    std::string send_data(1000, 0), recv_data;
+    std::vector<char> buf(chunk);
+    size_t length;
+
+    ucs::fill_random(send_data.begin(), send_data.end());
+    stream_send(&send_data[0], send_data.size());
+    short_progress_loop(); /* Receive data as unexpected */
+
+    /* Consume the data in small pieces, which cross fragment boundaries */
+    while (recv_data.size() < send_data.size()) {
+        length = stream_recv(&buf[0], buf.size(), 0);
+        ASSERT_LE(length, chunk);
+        recv_data.append(&buf[0], length);
+    }
+
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_stream, waitall_ordered) {
+    static const size_t sizes[] = { 8, 300, 50000, 1, 5000 };
+    static const unsigned num_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    std::string send_data, recv_data;
+    size_t total, offset, length;
+    unsigned i;
+
+    total = 0;
+    for (i = 0; i < num_sizes; ++i) {
+        total += sizes[i];
+    }
+    send_data.resize(total);
+    ucs::fill_random(send_data.begin(), send_data.end());
+
+    offset = 0;
+    for (i = 0; i < num_sizes; ++i) {
+        stream_send(&send_data[offset], sizes[i]);
+        offset += sizes[i];
+    }
+
+    /* Message boundaries are not preserved */
+    recv_data.resize(total);
+    length = stream_recv(&recv_data[0], total, UCP_STREAM_RECV_FLAG_WAITALL);
+    EXPECT_EQ(total, length);
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_stream, many_recvs_posted) {
+    static const unsigned count = 10;
+    static const size_t size    = 3000;
+    std::string send_data(count * size, 0), recv_data(count * size, 0);
+    std::vector<request*> reqs;
+    size_t recv_length;
+    unsigned i;
+
+    ucs::fill_random(send_data.begin(), send_data.end());
+
+    for (i = 0; i < count; ++i) {
+        reqs.push_back(stream_recv_nb(&recv_data[i * size], size,
+                                      UCP_STREAM_RECV_FLAG_WAITALL,
+                                      &recv_length));
+        ASSERT_TRUE(reqs.back() != NULL);
+    }
+
+    stream_send(&send_data[0], send_data.size());
+
+    for (i = 0; i < count; ++i) {
+        wait(reqs[i]);
+        EXPECT_UCS_OK(reqs[i]->status);
+        EXPECT_EQ(size, reqs[i]->info.length);
+        request_release(reqs[i]);
+    }
+
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_stream)
@@ -13,6 +13,46 @@
 class test_ucp_tag_cancel : public test_ucp_tag {
 public:
     using test_ucp_tag::get_ctx_params;
+
+protected:
+    /* Send until a request has to wait for resources, since the receiver
+     * does not progress. Returns the number of requests. */
+    size_t fill_pending(std::vector<request*>& reqs, uint64_t *send_data) {
+        static const size_t max_sends = 10000;
+
+        for (size_t i = 0; i < max_sends; ++i) {
+            request *req = send_nb(send_data, sizeof(*send_data), DATATYPE, i);
+            reqs.push_back(req);
+            if ((req != NULL) && !req->completed) {
+                return reqs.size();
+            }
+        }
+        return 0;
+    }
+
+    void recv_all(const std::vector<request*>& reqs) {
+        uint64_t recv_data;
+        ucp_tag_recv_info_t info;
+        ucs_status_t status;
+
+        for (size_t i = 0; i < reqs.size(); ++i) {
+            if ((reqs[i] != NULL) && reqs[i]->completed &&
+                (reqs[i]->status != UCS_OK)) {
+                continue; /* Canceled */
+            }
+
+            status = recv_b(&recv_data, sizeof(recv_data), DATATYPE, i,
+                            (ucp_tag_t)-1, &info);
+            ASSERT_UCS_OK(status);
+        }
+
+        for (size_t i = 0; i < reqs.size(); ++i) {
+            if (reqs[i] != NULL) {
+                wait(reqs[i]);
+                request_release(reqs[i]);
+            }
+        }
+    }
 };
 
 UCS_TEST_P(test_ucp_tag_cancel, cancel_exp) {
@@ -34,4 +74,73 @@ UCS_TEST_P(test_ucp_tag_cancel, cancel_exp) {
     request_release(req);
 }
 
+UCS_TEST_P(test_ucp_tag_cancel, timeout_exp) {
+    uint64_t recv_data = 0;
+    ucs_status_t status;
+    request *req;
+
+    req = recv_nb(&recv_data, sizeof(recv_data), DATATYPE, 1, 1);
+    if (UCS_PTR_IS_ERR(req)) {
+        ASSERT_UCS_OK(UCS_PTR_STATUS(req));
+    } else if (req == NULL) {
+        UCS_TEST_ABORT("ucp_tag_recv_nb returned NULL");
+    }
+
+    status = ucp_request_set_timeout(receiver->worker(), req, 0.01);
+    ASSERT_UCS_OK(status);
+    wait(req);
+
+    EXPECT_EQ(UCS_ERR_TIMED_OUT, req->status);
+    EXPECT_EQ(0ul, recv_data);
+    request_release(req);
+}
+
+UCS_TEST_P(test_ucp_tag_cancel, cancel_send_pending) {
+    uint64_t send_data = 0x0102030405060708;
+    std::vector<request*> reqs;
+
+    if (fill_pending(reqs, &send_data) == 0) {
+        UCS_TEST_SKIP_R("sends do not wait for resources");
+    }
+
+    /* A request which waits for resources is removed from the pending queue,
+     * while the requests before and after it are still sent */
+    reqs.push_back(send_nb(&send_data, sizeof(send_data), DATATYPE,
+                           reqs.size()));
+    request *req  = reqs[reqs.size() - 2];
+    request *next = reqs.back();
+    bool next_completed = (next == NULL) || next->completed;
+    ucp_request_cancel(sender->worker(), req);
+
+    EXPECT_TRUE(req->completed);
+    EXPECT_EQ(UCS_ERR_CANCELED, req->status);
+
+    /* Canceling must not send the other pending requests */
+    EXPECT_EQ(next_completed, (next == NULL) || next->completed);
+
+    recv_all(reqs);
+}
+
+UCS_TEST_P(test_ucp_tag_cancel, timeout_send_pending) {
+    uint64_t send_data = 0x0102030405060708;
+    std::vector<request*> reqs;
+    ucs_status_t status;
+
+    if (fill_pending(reqs, &send_data) == 0) {
+        UCS_TEST_SKIP_R("sends do not wait for resources");
+    }
+
+    request *req = reqs.back();
+    status = ucp_request_set_timeout(sender->worker(), req, 0.01);
+    ASSERT_UCS_OK(status);
+
+    /* The receiver does not progress, so the request stays pending */
+    while (!req->completed) {
+        ucp_worker_progress(sender->worker());
+    }
+    EXPECT_EQ(UCS_ERR_TIMED_OUT, req->status);
+
+    recv_all(reqs);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_cancel)
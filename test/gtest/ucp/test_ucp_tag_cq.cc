@@ -0,0 +1,126 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2016.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include "test_ucp_tag.h"
+
+#include <common/test_helpers.h>
+
+#include <map>
+
+
+class test_ucp_tag_cq : public test_ucp_tag {
+public:
+    using test_ucp_tag::get_ctx_params;
+
+protected:
+    typedef std::map<void*, ucp_completion_t> completion_map_t;
+
+    /* Progress both sides until the given number of completions is reaped
+     * from the worker */
+    void reap(ucp_worker_h worker, unsigned count, completion_map_t& result) {
+        ucp_completion_t comps[4];
+        unsigned i, n;
+
+        while (result.size() < count) {
+            progress();
+            n = ucp_worker_poll_completions(worker, comps,
+                                            sizeof(comps) / sizeof(comps[0]));
+            for (i = 0; i < n; ++i) {
+                EXPECT_TRUE(result.find(comps[i].user_data) == result.end());
+                result[comps[i].user_data] = comps[i];
+            }
+        }
+    }
+};
+
+UCS_TEST_P(test_ucp_tag_cq, recv_exp) {
+    uint64_t send_data = 0xdeadbeefdeadbeef;
+    uint64_t recv_data = 0;
+    completion_map_t comps;
+    ucs_status_t status;
+
+    status = ucp_tag_recv_cq_nb(receiver->worker(), &recv_data,
+                                sizeof(recv_data), DATATYPE, 0x1337, 0xffff,
+                                (void*)0x1);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    send_b(&send_data, sizeof(send_data), DATATYPE, 0x111337);
+
+    reap(receiver->worker(), 1, comps);
+    ASSERT_EQ(1ul, comps.count((void*)0x1));
+    EXPECT_EQ(UCS_OK, comps[(void*)0x1].status);
+    EXPECT_EQ(sizeof(send_data),   comps[(void*)0x1].info.length);
+    EXPECT_EQ((ucp_tag_t)0x111337, comps[(void*)0x1].info.sender_tag);
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_tag_cq, recv_unexp) {
+    uint64_t send_data = 0xdeadbeefdeadbeef;
+    uint64_t recv_data = 0;
+    completion_map_t comps;
+    ucs_status_t status;
+
+    send_b(&send_data, sizeof(send_data), DATATYPE, 0x111337);
+    short_progress_loop(); /* Receive messages as unexpected */
+
+    status = ucp_tag_recv_cq_nb(receiver->worker(), &recv_data,
+                                sizeof(recv_data), DATATYPE, 0x1337, 0xffff,
+                                (void*)0x2);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    reap(receiver->worker(), 1, comps);
+    EXPECT_EQ(UCS_OK, comps[(void*)0x2].status);
+    EXPECT_EQ(sizeof(send_data), comps[(void*)0x2].info.length);
+    EXPECT_EQ(send_data, recv_data);
+}
+
+UCS_TEST_P(test_ucp_tag_cq, send_recv_many) {
+    static const unsigned count = 1000; /* more than initial queue size */
+    static const size_t size    = 20000;
+    std::vector<std::vector<char> > sendbufs(count), recvbufs(count);
+    completion_map_t send_comps, recv_comps;
+    unsigned num_sends = 0;
+    ucs_status_t status;
+    unsigned i;
+
+    for (i = 0; i < count; ++i) {
+        recvbufs[i].resize(size, 0);
+        status = ucp_tag_recv_cq_nb(receiver->worker(), &recvbufs[i][0], size,
+                                    DATATYPE, i, (ucp_tag_t)-1,
+                                    &recvbufs[i]);
+        ASSERT_EQ(UCS_INPROGRESS, status);
+    }
+
+    for (i = 0; i < count; ++i) {
+        sendbufs[i].resize(size);
+        ucs::fill_random(sendbufs[i].begin(), sendbufs[i].end());
+        status = ucp_tag_send_cq_nb(sender->ep(), &sendbufs[i][0], size,
+                                    DATATYPE, i, &sendbufs[i]);
+        if (status == UCS_INPROGRESS) {
+            ++num_sends;
+        } else {
+            ASSERT_UCS_OK(status);
+        }
+    }
+
+    reap(receiver->worker(), count, recv_comps);
+    reap(sender->worker(), num_sends, send_comps);
+
+    for (i = 0; i < count; ++i) {
+        ASSERT_EQ(1ul, recv_comps.count(&recvbufs[i]));
+        EXPECT_EQ(UCS_OK, recv_comps[&recvbufs[i]].status);
+        EXPECT_EQ(size, recv_comps[&recvbufs[i]].info.length);
+        EXPECT_EQ((ucp_tag_t)i, recv_comps[&recvbufs[i]].info.sender_tag);
+        EXPECT_EQ(sendbufs[i], recvbufs[i]);
+    }
+    for (completion_map_t::iterator iter = send_comps.begin();
+         iter != send_comps.end(); ++iter)
+    {
+        EXPECT_EQ(UCS_OK, iter->second.status);
+    }
+}
+
+UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_cq)
@@ -9,14 +9,41 @@
 
 #include <common/test_helpers.h>
 
+extern "C" {
+#include <ucp/core/ucp_worker.h>
+}
+
 using namespace ucs; /* For vector<char> serialization */
 
 
 class test_ucp_tag_match : public test_ucp_tag {
 public:
     using test_ucp_tag::get_ctx_params;
+
+protected:
+    static void ordered_recv_callback(void *req, ucs_status_t status,
+                                      ucp_tag_recv_info_t *info)
+    {
+        recv_callback(req, status, info);
+        m_recv_order.push_back((request*)req);
+    }
+
+    request *ordered_recv_nb(void *buffer, size_t count, ucp_datatype_t dt,
+                             ucp_tag_t tag)
+    {
+        request *req = (request*)ucp_tag_recv_nb(receiver->worker(), buffer,
+                                                 count, dt, tag, (ucp_tag_t)-1,
+                                                 ordered_recv_callback);
+        EXPECT_FALSE(UCS_PTR_IS_ERR(req));
+        EXPECT_TRUE(req != NULL);
+        return req;
+    }
+
+    static std::vector<request*> m_recv_order;
 };
 
+std::vector<test_ucp_tag::request*> test_ucp_tag_match::m_recv_order;
+
 UCS_TEST_P(test_ucp_tag_match, send_recv_exp) {
     ucp_tag_recv_info_t info;
     ucs_status_t status;
@@ -369,4 +396,228 @@ UCS_TEST_P(test_ucp_tag_match, sync_send_unexp) {
     request_release(my_send_req);
 }
 
+UCS_TEST_P(test_ucp_tag_match, sync_send_many_exp) {
+    /* More than one batch of acknowledgments */
+    static const unsigned num_requests = 40;
+    std::vector<request*> send_reqs(num_requests), recv_reqs(num_requests);
+    std::vector<uint64_t> send_data(num_requests), recv_data(num_requests, 0);
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        recv_reqs[i] = recv_nb(&recv_data[i], sizeof(recv_data[i]), DATATYPE,
+                               0x1337, 0xffff);
+    }
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        send_data[i] = i * 0x0102030405060708ul;
+        send_reqs[i] = send_sync_nb(&send_data[i], sizeof(send_data[i]),
+                                    DATATYPE, 0x111337);
+        ASSERT_TRUE(send_reqs[i] != NULL);
+    }
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        wait(recv_reqs[i]);
+        EXPECT_EQ(UCS_OK, recv_reqs[i]->status);
+        EXPECT_EQ(send_data[i], recv_data[i]);
+        request_release(recv_reqs[i]);
+    }
+
+    for (unsigned i = 0; i < num_requests; ++i) {
+        wait(send_reqs[i]);
+        EXPECT_EQ(UCS_OK, send_reqs[i]->status);
+        request_release(send_reqs[i]);
+    }
+}
+
+UCS_TEST_P(test_ucp_tag_match, send_recv_user_req) {
+    static const size_t size = 50000;
+    const size_t req_size    = ucp_request_size(receiver->ucph());
+    request *send_req, *recv_req, *my_recv_req;
+
+    std::vector<char> sendbuf(size, 0);
+    std::vector<char> recvbuf(size, 0);
+    std::vector<char> send_storage(req_size), recv_storage(req_size);
+
+    ucs::fill_random(sendbuf.begin(), sendbuf.end());
+
+    /* The application area is at the end of the request memory */
+    recv_req = (request*)&recv_storage[req_size - sizeof(request)];
+    request_init(recv_req);
+    my_recv_req = (request*)ucp_tag_recv_nbr(receiver->worker(), &recvbuf[0],
+                                             recvbuf.size(), DATATYPE, 0x1337,
+                                             0xffff, recv_callback,
+                                             &recv_storage[0]);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(my_recv_req));
+    EXPECT_EQ(recv_req, my_recv_req);
+
+    send_req = (request*)&send_storage[req_size - sizeof(request)];
+    request_init(send_req);
+    request *my_send_req = (request*)ucp_tag_send_nbr(sender->ep(), &sendbuf[0],
+                                                      sendbuf.size(), DATATYPE,
+                                                      0x111337, send_callback,
+                                                      &send_storage[0]);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(my_send_req));
+    if (my_send_req != NULL) {
+        EXPECT_EQ(send_req, my_send_req);
+        wait(my_send_req);
+        EXPECT_UCS_OK(my_send_req->status);
+        EXPECT_TRUE(ucp_request_is_completed(my_send_req));
+    }
+
+    wait(recv_req);
+    EXPECT_UCS_OK(recv_req->status);
+    EXPECT_TRUE(ucp_request_is_completed(recv_req));
+    EXPECT_EQ(sendbuf.size(),      recv_req->info.length);
+    EXPECT_EQ((ucp_tag_t)0x111337, recv_req->info.sender_tag);
+    EXPECT_EQ(sendbuf, recvbuf);
+}
+
+UCS_TEST_P(test_ucp_tag_match, send_prio_latency_bypass) {
+    static const size_t max_sends   = 10000;
+    static const ucp_tag_t lat_tag  = 0xfeed0000ul;
+    uint64_t send_data              = 0x0102030405060708;
+    uint64_t lat_data               = 0x1112131415161718;
+    uint64_t recv_data, bulk_recv_data = 0, lat_recv_data = 0;
+    std::vector<request*> reqs;
+    request *lat_sreq, *lat_rreq, *bulk_rreq;
+    ucp_rsc_index_t am_rsc;
+    ucp_tag_recv_info_t info;
+    ucs_status_t status;
+    size_t i;
+
+    am_rsc = ucp_ep_config(sender->ep())->rscs[UCP_EP_OP_AM];
+    if (!(sender->worker()->iface_attrs[am_rsc].cap.flags &
+          UCT_IFACE_FLAG_PENDING_PRIO)) {
+        UCS_TEST_SKIP_R("transport does not support pending priorities");
+    }
+
+    /* Send until a request has to wait for resources */
+    for (i = 0; i < max_sends; ++i) {
+        reqs.push_back(send_nb(&send_data, sizeof(send_data), DATATYPE, i));
+        if ((reqs.back() != NULL) && !reqs.back()->completed) {
+            break;
+        }
+    }
+    if (i == max_sends) {
+        UCS_TEST_SKIP_R("sends do not wait for resources");
+    }
+
+    lat_sreq = (request*)ucp_tag_send_prio_nb(sender->ep(), &lat_data,
+                                              sizeof(lat_data), DATATYPE,
+                                              lat_tag, UCP_SEND_PRIO_LATENCY,
+                                              send_callback);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(lat_sreq));
+
+    /* The latency message must arrive before the bulk send queued before it.
+     * Both may be received by the same progress call, so check the order in
+     * which the receives were matched. */
+    m_recv_order.clear();
+    lat_rreq  = ordered_recv_nb(&lat_recv_data, sizeof(lat_recv_data),
+                                DATATYPE, lat_tag);
+    bulk_rreq = ordered_recv_nb(&bulk_recv_data, sizeof(bulk_recv_data),
+                                DATATYPE, reqs.size() - 1);
+    wait(lat_rreq);
+    wait(bulk_rreq);
+    ASSERT_EQ(2u, m_recv_order.size());
+    EXPECT_EQ(lat_rreq, m_recv_order[0]);
+    EXPECT_EQ(lat_data, lat_recv_data);
+    EXPECT_EQ(send_data, bulk_recv_data);
+
+    for (i = 0; i < reqs.size() - 1; ++i) {
+        status = recv_b(&recv_data, sizeof(recv_data), DATATYPE, i,
+                        (ucp_tag_t)-1, &info);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(send_data, recv_data);
+    }
+
+    for (i = 0; i < reqs.size(); ++i) {
+        if (reqs[i] != NULL) {
+            wait(reqs[i]);
+            request_release(reqs[i]);
+        }
+    }
+    if (lat_sreq != NULL) {
+        wait(lat_sreq);
+        request_release(lat_sreq);
+    }
+    request_release(lat_rreq);
+    request_release(bulk_rreq);
+}
+
+UCS_TEST_P(test_ucp_tag_match, send_prio_multi_frag_same_tag) {
+    static const size_t max_sends  = 10000;
+    static const ucp_tag_t tag     = 0xfeed0000ul;
+    uint64_t send_data             = 0x0102030405060708;
+    uint64_t recv_data;
+    std::vector<request*> reqs;
+    request *bulk_sreq, *lat_sreq;
+    ucp_rsc_index_t am_rsc;
+    ucp_tag_recv_info_t info;
+    ucs_status_t status;
+    size_t i, length;
+
+    am_rsc = ucp_ep_config(sender->ep())->rscs[UCP_EP_OP_AM];
+    if (!(sender->worker()->iface_attrs[am_rsc].cap.flags &
+          UCT_IFACE_FLAG_PENDING_PRIO)) {
+        UCS_TEST_SKIP_R("transport does not support pending priorities");
+    }
+
+    length = 3 * ucp_ep_config(sender->ep())->max_am_bcopy;
+    if (length >= ucp_ep_config(sender->ep())->rndv_thresh) {
+        UCS_TEST_SKIP_R("messages of several fragments use rendezvous");
+    }
+
+    std::vector<char> bulk_sendbuf(length), lat_sendbuf(length);
+    std::vector<char> bulk_recvbuf(length, 0), lat_recvbuf(length, 0);
+    ucs::fill_random(bulk_sendbuf.begin(), bulk_sendbuf.end());
+    ucs::fill_random(lat_sendbuf.begin(), lat_sendbuf.end());
+
+    /* Send until a request has to wait for resources */
+    for (i = 0; i < max_sends; ++i) {
+        reqs.push_back(send_nb(&send_data, sizeof(send_data), DATATYPE, i));
+        if ((reqs.back() != NULL) && !reqs.back()->completed) {
+            break;
+        }
+    }
+    if (i == max_sends) {
+        UCS_TEST_SKIP_R("sends do not wait for resources");
+    }
+
+    /* The fragments of the two messages must not be interleaved, so the
+     * latency message is sent after the bulk message */
+    bulk_sreq = send_nb(&bulk_sendbuf[0], length, DATATYPE, tag);
+    lat_sreq  = (request*)ucp_tag_send_prio_nb(sender->ep(), &lat_sendbuf[0],
+                                               length, DATATYPE, tag,
+                                               UCP_SEND_PRIO_LATENCY,
+                                               send_callback);
+    ASSERT_FALSE(UCS_PTR_IS_ERR(lat_sreq));
+
+    status = recv_b(&bulk_recvbuf[0], length, DATATYPE, tag, (ucp_tag_t)-1,
+                    &info);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(length, info.length);
+    status = recv_b(&lat_recvbuf[0], length, DATATYPE, tag, (ucp_tag_t)-1,
+                    &info);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(length, info.length);
+    EXPECT_TRUE(bulk_sendbuf == bulk_recvbuf);
+    EXPECT_TRUE(lat_sendbuf == lat_recvbuf);
+
+    for (i = 0; i < reqs.size(); ++i) {
+        status = recv_b(&recv_data, sizeof(recv_data), DATATYPE, i,
+                        (ucp_tag_t)-1, &info);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(send_data, recv_data);
+    }
+
+    reqs.push_back(bulk_sreq);
+    reqs.push_back(lat_sreq);
+    for (i = 0; i < reqs.size(); ++i) {
+        if (reqs[i] != NULL) {
+            wait(reqs[i]);
+            request_release(reqs[i]);
+        }
+    }
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_match)
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_tag_match, tcp, "\\tcp")
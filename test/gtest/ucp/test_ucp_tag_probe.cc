@@ -117,3 +117,4 @@ UCS_TEST_P(test_ucp_tag_probe, send_medium_msg_probe_truncated) {
 }
 
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_probe)
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_tag_probe, tcp, "\\tcp")
@@ -167,4 +167,26 @@ UCS_TEST_P(test_ucp_tag_xfer, generic_unexp_sync) {
     test_xfer(&test_ucp_tag_xfer::test_xfer_generic, false, true);
 }
 
+UCS_TEST_P(test_ucp_tag_xfer, contig_exp_bounce, "ZCOPY_THRESH=1k",
+           "BOUNCE_SIZE=64k") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_contig, true, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, generic_exp_pipeline, "ZCOPY_THRESH=1k",
+           "GENERIC_PIPELINE_DEPTH=2") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_generic, true, false);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, generic_unexp_sync_pipeline, "ZCOPY_THRESH=1k",
+           "GENERIC_PIPELINE_DEPTH=2") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_generic, false, true);
+}
+
+UCS_TEST_P(test_ucp_tag_xfer, generic_exp_pipeline_small_frags,
+           "ZCOPY_THRESH=1k", "GENERIC_PIPELINE_DEPTH=3",
+           "GENERIC_PIPELINE_FRAG_SIZE=4k") {
+    test_xfer(&test_ucp_tag_xfer::test_xfer_generic, true, false);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_tag_xfer)
+UCP_INSTANTIATE_TEST_CASE_TLS(test_ucp_tag_xfer, tcp, "\\tcp")
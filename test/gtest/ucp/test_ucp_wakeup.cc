@@ -7,6 +7,11 @@
 #include "ucp_test.h"
 #include "poll.h"
 
+extern "C" {
+#include <ucs/time/time.h>
+}
+#include <pthread.h>
+
 class test_ucp_wakeup : public ucp_test {
 public:
     static ucp_params_t get_ctx_params() {
@@ -23,6 +28,31 @@ protected:
                                 ucp_tag_recv_info_t *info) {
     }
 
+    static void* signal_thread(void *arg) {
+        ucp_worker_h worker = (ucp_worker_h)arg;
+        usleep(10000);
+        ucp_worker_signal(worker);
+        return NULL;
+    }
+
+    /* Releases the worker if the wait misses the event being tested */
+    static void* late_signal_thread(void *arg) {
+        ucp_worker_h worker = (ucp_worker_h)arg;
+        sleep(3);
+        ucp_worker_signal(worker);
+        return NULL;
+    }
+
+    /* Signal the worker from another thread while it's waiting */
+    void test_wait_signal(ucp_worker_h worker) {
+        pthread_t thread;
+
+        ASSERT_UCS_OK(ucp_worker_arm(worker));
+        ASSERT_EQ(0, pthread_create(&thread, NULL, signal_thread, worker));
+        EXPECT_UCS_OK(ucp_worker_wait(worker));
+        pthread_join(thread, NULL);
+    }
+
     void wait(void *req) {
         do {
             progress();
@@ -103,4 +133,51 @@ UCS_TEST_P(test_ucp_wakeup, signal)
     close(efd);
 }
 
+UCS_TEST_P(test_ucp_wakeup, wait_spin)
+{
+    ucp_worker_h worker = create_entity()->worker();
+
+    /* The event is pending already, so it should be found while spinning */
+    ASSERT_UCS_OK(ucp_worker_arm(worker));
+    ASSERT_UCS_OK(ucp_worker_signal(worker));
+    EXPECT_UCS_OK(ucp_worker_wait(worker));
+
+    test_wait_signal(worker);
+    test_wait_signal(worker);
+}
+
+UCS_TEST_P(test_ucp_wakeup, wait_progress, "WAKEUP_SPIN_TIME=1s")
+{
+    const ucp_datatype_t DATATYPE = ucp_dt_make_contig(1);
+    ucp_worker_h worker = create_entity()->worker();
+    uint64_t recv_data = 0;
+    pthread_t thread;
+    ucs_time_t start;
+    void *req;
+
+    /* An expired deadline has no file descriptor, only progress reports it */
+    req = ucp_tag_recv_nb(worker, &recv_data, sizeof(recv_data), DATATYPE, 1,
+                          (ucp_tag_t)-1, recv_completion);
+    ASSERT_TRUE(UCS_PTR_IS_PTR(req));
+    ASSERT_UCS_OK(ucp_request_set_timeout(worker, req, 0.01));
+
+    ASSERT_UCS_OK(ucp_worker_arm(worker));
+    ASSERT_EQ(0, pthread_create(&thread, NULL, late_signal_thread, worker));
+    start = ucs_get_time();
+    EXPECT_UCS_OK(ucp_worker_wait(worker));
+    EXPECT_LT(ucs_time_to_sec(ucs_get_time() - start), 1.0);
+    pthread_cancel(thread);
+    pthread_join(thread, NULL);
+
+    EXPECT_TRUE(ucp_request_is_completed(req));
+    ucp_request_release(req);
+}
+
+UCS_TEST_P(test_ucp_wakeup, wait_block, "WAKEUP_SPIN_TIME=0")
+{
+    ucp_worker_h worker = create_entity()->worker();
+
+    test_wait_signal(worker);
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_wakeup)
@@ -34,6 +34,8 @@ protected:
     static void recv_completion(void *request, ucs_status_t status,
                                 ucp_tag_recv_info_t *info);
     void wait(void *req);
+
+    void check_lazy_ifaces(ucp_worker_h worker);
 };
 
 void test_ucp_wireup::tag_send(ucp_ep_h from, ucp_worker_h to, int count)
@@ -70,6 +72,27 @@ void test_ucp_wireup::tag_send(ucp_ep_h from, ucp_worker_h to, int count)
     }
 }
 
+/* Only interfaces in the worker address are opened, at most one per transport */
+void test_ucp_wireup::check_lazy_ifaces(ucp_worker_h worker)
+{
+    ucp_context_h context = worker->context;
+
+    for (ucp_rsc_index_t i = 0; i < context->num_tls; ++i) {
+        const char *tl_name = context->tl_rscs[i].tl_rsc.tl_name;
+
+        if (worker->ifaces[i] == NULL) {
+            continue;
+        }
+
+        EXPECT_TRUE(worker->address_tls & UCS_BIT(i)) << tl_name;
+        for (ucp_rsc_index_t j = 0; j < i; ++j) {
+            if (worker->ifaces[j] != NULL) {
+                EXPECT_STRNE(context->tl_rscs[j].tl_rsc.tl_name, tl_name);
+            }
+        }
+    }
+}
+
 void test_ucp_wireup::send_completion(void *request, ucs_status_t status)
 {
 }
@@ -168,6 +191,88 @@ UCS_TEST_P(test_ucp_wireup, two_sided_wireup) {
     ent2->flush_worker();
 }
 
+UCS_TEST_P(test_ucp_wireup, loopback) {
+    entity *ent1 = create_entity();
+    ucp_rsc_index_t am_rsc;
+    bool has_self = false;
+
+    ent1->connect(ent1);
+    tag_send(ent1->ep(), ent1->worker(), 100);
+    ent1->flush_worker();
+
+    for (ucp_rsc_index_t i = 0; i < ent1->ucph()->num_tls; ++i) {
+        has_self = has_self || !strcmp(ent1->ucph()->tl_rscs[i].tl_rsc.tl_name,
+                                       "self");
+    }
+    if (!has_self) {
+        UCS_TEST_SKIP_R("no self transport");
+    }
+
+    /* an endpoint to the same worker should prefer the loopback transport */
+    am_rsc = ucp_ep_config(ent1->ep())->rscs[UCP_EP_OP_AM];
+    EXPECT_EQ(std::string("self"),
+              std::string(ent1->ucph()->tl_rscs[am_rsc].tl_rsc.tl_name));
+}
+
+UCS_TEST_P(test_ucp_wireup, lazy_ifaces, "LAZY_IFACES=y") {
+    entity *ent1 = create_entity();
+    entity *ent2 = create_entity();
+
+    for (ucp_rsc_index_t i = 0; i < ent1->ucph()->num_tls; ++i) {
+        EXPECT_TRUE(ent1->worker()->ifaces[i] == NULL);
+    }
+
+    ent1->connect(ent2);
+    tag_send(ent1->ep(), ent2->worker());
+    ent1->flush_worker();
+
+    ent2->connect(ent1);
+    tag_send(ent2->ep(), ent1->worker());
+    ent2->flush_worker();
+}
+
+UCS_TEST_P(test_ucp_wireup, lazy_ifaces_address, "LAZY_IFACES=y") {
+    entity *ent1 = create_entity();
+    entity *ent2 = create_entity();
+    ucp_address_t *address;
+    size_t address_length;
+
+    ASSERT_UCS_OK(ucp_worker_get_address(ent1->worker(), &address,
+                                         &address_length));
+    ucp_worker_release_address(ent1->worker(), address);
+    check_lazy_ifaces(ent1->worker());
+
+    ent1->connect(ent2);
+    tag_send(ent1->ep(), ent2->worker());
+    ent1->flush_worker();
+
+    ent2->connect(ent1);
+    tag_send(ent2->ep(), ent1->worker());
+    ent2->flush_worker();
+
+    check_lazy_ifaces(ent1->worker());
+    check_lazy_ifaces(ent2->worker());
+}
+
+UCS_TEST_P(test_ucp_wireup, lazy_ifaces_proto_print, "LAZY_IFACES=y") {
+    entity *ent1 = create_entity();
+    unsigned count = ent1->worker()->ep_config.count;
+    char *buf = NULL;
+    size_t size = 0;
+    FILE *stream;
+
+    stream = open_memstream(&buf, &size);
+    ASSERT_TRUE(stream != NULL);
+    ucp_worker_proto_print(ent1->worker(), stream, "test",
+                           UCS_CONFIG_PRINT_HEADER);
+    fclose(stream);
+    free(buf);
+
+    /* printing the limits doesn't add configurations, or open interfaces */
+    EXPECT_EQ(count, ent1->worker()->ep_config.count);
+    check_lazy_ifaces(ent1->worker());
+}
+
 UCS_TEST_P(test_ucp_wireup, reply_ep_send_before) {
     entity *ent1 = create_entity();
     entity *ent2 = create_entity();
@@ -230,4 +335,91 @@ UCS_TEST_P(test_ucp_wireup, stress_connect2) {
     }
 }
 
+UCS_TEST_P(test_ucp_wireup, ep_config_table) {
+    entity *ent1 = create_entity();
+    entity *ent2 = create_entity();
+    ucp_worker_h worker = ent1->worker();
+    unsigned num_rscs = ent1->ucph()->num_tls + 1; /* including NULL resource */
+    std::vector<unsigned> indices;
+    std::vector<ucp_ep_config_t*> configs;
+    ucp_rsc_index_t rscs[UCP_EP_OP_LAST];
+    ucs_status_t status;
+    unsigned cfg_index;
+
+    /* Create a configuration for every combination of transports, which is
+     * more than fits in a single chunk of the table */
+    for (unsigned i = 0; i < num_rscs * num_rscs * num_rscs; ++i) {
+        rscs[UCP_EP_OP_AM]  = ((i % num_rscs) == 0) ? UCP_NULL_RESOURCE :
+                              (i % num_rscs) - 1;
+        rscs[UCP_EP_OP_RMA] = (((i / num_rscs) % num_rscs) == 0) ? UCP_NULL_RESOURCE :
+                              ((i / num_rscs) % num_rscs) - 1;
+        rscs[UCP_EP_OP_AMO] = ((i / num_rscs / num_rscs) == 0) ? UCP_NULL_RESOURCE :
+                              (i / num_rscs / num_rscs) - 1;
+        status = ucp_worker_get_ep_config(worker, rscs, &cfg_index);
+        ASSERT_UCS_OK(status);
+        indices.push_back(cfg_index);
+        configs.push_back(ucp_worker_ep_config(worker, cfg_index));
+        EXPECT_EQ(0, memcmp(rscs, configs.back()->rscs, sizeof(rscs)));
+    }
+
+    /* All combinations are distinct, except the stub configuration */
+    std::vector<unsigned> sorted(indices);
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_TRUE(std::unique(sorted.begin(), sorted.end()) == sorted.end());
+    EXPECT_EQ(0u, indices[0]);
+    EXPECT_EQ(indices.size(), worker->ep_config.count);
+
+    /* Repeated lookups return the same entries, which did not move */
+    for (unsigned i = 0; i < indices.size(); ++i) {
+        memcpy(rscs, configs[i]->rscs, sizeof(rscs));
+        status = ucp_worker_get_ep_config(worker, rscs, &cfg_index);
+        ASSERT_UCS_OK(status);
+        EXPECT_EQ(indices[i], cfg_index);
+        EXPECT_EQ(configs[i], ucp_worker_ep_config(worker, cfg_index));
+    }
+
+    /* Endpoints created after the table grew use existing configurations */
+    ent1->connect(ent2);
+    EXPECT_EQ(indices.size(), worker->ep_config.count);
+    tag_send(ent1->ep(), ent2->worker());
+    ent1->flush_worker();
+}
+
+UCS_TEST_P(test_ucp_wireup, numa_remote_device) {
+    entity *ent1 = create_entity();
+    entity *ent2 = create_entity();
+    entity *ent3 = create_entity();
+    ucp_worker_h worker = ent3->worker();
+    ucp_rsc_index_t am_rsc, new_am_rsc;
+    char *buffer;
+    size_t size;
+    FILE *stream;
+
+    if (worker->numa_node < 0) {
+        UCS_TEST_SKIP_R("NUMA topology is not available");
+    }
+
+    ent1->connect(ent2);
+    am_rsc = ucp_ep_config(ent1->ep())->rscs[UCP_EP_OP_AM];
+
+    /* Pretend the selected device is on another node */
+    ent3->ucph()->tl_rscs[am_rsc].numa_node = worker->numa_node + 1;
+    ent3->connect(ent2);
+    new_am_rsc = ucp_ep_config(ent3->ep())->rscs[UCP_EP_OP_AM];
+
+    stream = open_memstream(&buffer, &size);
+    ucp_worker_proto_print(worker, stream, "", UCS_CONFIG_PRINT_CONFIG);
+    fclose(stream);
+    EXPECT_TRUE(strstr(buffer, "(remote)") != NULL) << buffer;
+    free(buffer);
+
+    tag_send(ent3->ep(), ent2->worker());
+    ent3->flush_worker();
+
+    if (new_am_rsc == am_rsc) {
+        UCS_TEST_SKIP_R("no other transport for active messages");
+    }
+    EXPECT_FALSE(ucp_worker_is_numa_remote(worker, new_am_rsc));
+}
+
 UCP_INSTANTIATE_TEST_CASE(test_ucp_wireup)
@@ -152,9 +152,11 @@ UCS_TEST_F(test_arbiter, add_purge) {
     ucs_arbiter_group_schedule(&arbiter, &group2);
 
     int count = 3;
-    ucs_arbiter_dispatch_nonempty(&arbiter, 3, count_elems, &count);
+    unsigned removed = ucs_arbiter_dispatch_nonempty(&arbiter, 3, count_elems,
+                                                     &count);
 
     EXPECT_EQ(0, count);
+    EXPECT_EQ(3u, removed);
 
     ucs_arbiter_group_cleanup(&group2);
     ucs_arbiter_group_cleanup(&group1);
@@ -233,18 +235,22 @@ UCS_TEST_F(test_arbiter, resched) {
     ucs_arbiter_group_schedule(&arbiter, &group2);
 
     int count = 2;
-    ucs_arbiter_dispatch_nonempty(&arbiter, 1, resched_groups, &count);
+    unsigned removed;
+    removed = ucs_arbiter_dispatch_nonempty(&arbiter, 1, resched_groups, &count);
 
     EXPECT_EQ(0, count);
+    EXPECT_EQ(0u, removed);
 
     count = 1;
-    ucs_arbiter_dispatch_nonempty(&arbiter, 1, resched_groups, &count);
+    removed = ucs_arbiter_dispatch_nonempty(&arbiter, 1, resched_groups, &count);
     EXPECT_EQ(0, count);
+    EXPECT_EQ(1u, removed);
 
     /* one group with one elem should be there */
     count = 1;
-    ucs_arbiter_dispatch_nonempty(&arbiter, 3, count_elems, &count);
+    removed = ucs_arbiter_dispatch_nonempty(&arbiter, 3, count_elems, &count);
     EXPECT_EQ(0, count);
+    EXPECT_EQ(1u, removed);
     ASSERT_TRUE(arbiter.current == NULL);
 
     ucs_arbiter_group_cleanup(&group2);
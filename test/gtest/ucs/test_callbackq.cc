@@ -25,6 +25,7 @@ protected:
         uint32_t            count;
         int                 command;
         callback_ctx        *to_add;
+        unsigned            events;
     };
 
     test_callbackq_base() : m_async_ptr(NULL) {
@@ -42,10 +43,11 @@ protected:
         ucs::test_base::cleanup();
     }
 
-    static void callback_proxy(void *arg)
+    static unsigned callback_proxy(void *arg)
     {
         callback_ctx *ctx = reinterpret_cast<callback_ctx*>(arg);
         ctx->test->callback(ctx);
+        return ctx->events;
     }
 
     void callback(callback_ctx *ctx)
@@ -70,6 +72,7 @@ protected:
         ctx->test    = this;
         ctx->count   = 0;
         ctx->command = COMMAND_NONE;
+        ctx->events  = 0;
     }
 
     void add(callback_ctx *ctx)
@@ -105,11 +108,22 @@ protected:
         ASSERT_UCS_OK(status);
      }
 
-    void dispatch(unsigned count = 1)
+    unsigned dispatch(unsigned count = 1)
     {
+        unsigned events = 0;
         for (unsigned i = 0; i < count; ++i) {
-            ucs_callbackq_dispatch(&m_cbq);
+            events += ucs_callbackq_dispatch(&m_cbq);
         }
+        return events;
+    }
+
+    unsigned dispatch_adaptive(unsigned max_skip, unsigned count = 1)
+    {
+        unsigned events = 0;
+        for (unsigned i = 0; i < count; ++i) {
+            events += ucs_callbackq_dispatch_adaptive(&m_cbq, max_skip);
+        }
+        return events;
     }
 
     ucs_callbackq_t     m_cbq;
@@ -211,6 +225,57 @@ UCS_TEST_F(test_callbackq, add_another) {
     EXPECT_EQ(count + 2, ctx2.count);
 }
 
+UCS_TEST_F(test_callbackq, events) {
+    callback_ctx ctx, ctx2;
+
+    init_ctx(&ctx);
+    init_ctx(&ctx2);
+    ctx.events  = 2;
+    ctx2.events = 3;
+    add(&ctx);
+    add(&ctx2);
+
+    EXPECT_EQ(5u, dispatch());
+    EXPECT_EQ(10u, dispatch(2));
+
+    remove(&ctx);
+    remove(&ctx2);
+}
+
+UCS_TEST_F(test_callbackq, adaptive) {
+    static const unsigned MAX_SKIP = 4;
+    static const unsigned COUNT    = 1000;
+    callback_ctx busy, idle;
+
+    init_ctx(&busy);
+    init_ctx(&idle);
+    busy.events = 1;
+    add(&busy);
+    add(&idle);
+
+    /* busy callback is called every time, idle one is skipped */
+    EXPECT_EQ(COUNT, dispatch_adaptive(MAX_SKIP, COUNT));
+    EXPECT_EQ(COUNT, busy.count);
+    EXPECT_LT(idle.count, COUNT / 2);
+    EXPECT_GE(idle.count, COUNT / (MAX_SKIP + 1));
+
+    /* once the idle callback reports work, it's called every time again */
+    idle.events = 1;
+    dispatch_adaptive(MAX_SKIP, MAX_SKIP + 1);
+    unsigned count = idle.count;
+    EXPECT_EQ(2 * COUNT, dispatch_adaptive(MAX_SKIP, COUNT));
+    EXPECT_EQ(count + COUNT, idle.count);
+
+    /* max_skip == 0 disables skipping */
+    idle.events = 0;
+    count       = idle.count;
+    dispatch_adaptive(0, COUNT);
+    EXPECT_EQ(count + COUNT, idle.count);
+
+    remove(&busy);
+    remove(&idle);
+}
+
 UCS_MT_TEST_F(test_callbackq, threads, 10) {
 
     static unsigned COUNT = 2000;
@@ -0,0 +1,161 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include <common/test.h>
+extern "C" {
+#include <ucs/sys/copy_engine.h>
+#include <ucs/sys/math.h>
+#include <ucs/sys/sys.h>
+#include <ucs/time/time.h>
+}
+
+#include <vector>
+
+
+class test_copy_engine : public ucs::test {
+protected:
+    static const size_t MIN_PART = 4096;
+
+    typedef struct {
+        size_t         fail_offset;
+        volatile int   calls;
+    } fail_arg_t;
+
+    static ucs_status_t fail_part(void *arg, size_t offset, size_t length) {
+        fail_arg_t *fail = (fail_arg_t*)arg;
+
+        __sync_fetch_and_add(&fail->calls, 1);
+        if ((fail->fail_offset >= offset) &&
+            (fail->fail_offset < offset + length)) {
+            return UCS_ERR_IO_ERROR;
+        }
+        return UCS_OK;
+    }
+
+    void check_memcpy(ucs_copy_engine_t *engine, size_t length) {
+        std::vector<uint8_t> src(length + 1), dst(length + 1, 0);
+
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = (uint8_t)(i * 13) | 1;
+        }
+
+        ucs_copy_engine_memcpy(engine, &dst[0], &src[0], length);
+        ASSERT_TRUE(std::equal(src.begin(), src.begin() + length, dst.begin()))
+            << "length " << length;
+        EXPECT_EQ(0, dst[length]) << "length " << length;
+    }
+
+    double measure_bw(unsigned num_threads, size_t length, unsigned count) {
+        std::vector<uint8_t> src(length, 1), dst(length, 0);
+        ucs_copy_engine_t *engine;
+        ucs_time_t start_time;
+        double bw;
+
+        ucs_status_t status = ucs_copy_engine_create(num_threads, 1024 * 1024,
+                                                     ucs_numa_current_node(),
+                                                     "perf", &engine);
+        EXPECT_UCS_OK(status);
+        if (status != UCS_OK) {
+            return 0;
+        }
+
+        ucs_copy_engine_memcpy(engine, &dst[0], &src[0], length); /* warmup */
+
+        start_time = ucs_get_time();
+        for (unsigned i = 0; i < count; ++i) {
+            ucs_copy_engine_memcpy(engine, &dst[0], &src[0], length);
+        }
+        bw = (length * (double)count) /
+             ucs_time_to_sec(ucs_get_time() - start_time) / UCS_MBYTE;
+
+        ucs_copy_engine_destroy(engine);
+        return bw;
+    }
+
+    void check_memcpy_lengths() {
+        static const size_t lengths[] = { 0, 1, MIN_PART - 1, MIN_PART,
+                                          2 * MIN_PART + 1, 3 * MIN_PART + 17,
+                                          4 * MIN_PART, 100 * MIN_PART + 3 };
+        static const unsigned threads[] = { 0, 1, 3 };
+        ucs_copy_engine_t *engine;
+
+        for (unsigned t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+            ASSERT_UCS_OK(ucs_copy_engine_create(threads[t], MIN_PART, -1,
+                                                 "test", &engine));
+            for (unsigned i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+                check_memcpy(engine, lengths[i]);
+            }
+            ucs_copy_engine_destroy(engine);
+        }
+    }
+};
+
+UCS_TEST_F(test_copy_engine, memcpy) {
+    check_memcpy_lengths();
+}
+
+UCS_TEST_F(test_copy_engine, memcpy_nt) {
+    /* every part is copied with non-temporal stores */
+    modify_config("MEMCPY_NT_THRESH", "0");
+    check_memcpy_lengths();
+}
+
+UCS_TEST_F(test_copy_engine, error) {
+    const size_t length = 4 * MIN_PART;
+    ucs_copy_engine_t *engine;
+    fail_arg_t fail;
+
+    ASSERT_UCS_OK(ucs_copy_engine_create(3, MIN_PART, -1, "test", &engine));
+
+    /* every part is copied, and the error of the failed one is returned */
+    fail.fail_offset = length - 1;
+    fail.calls       = 0;
+    EXPECT_EQ(UCS_ERR_IO_ERROR,
+              ucs_copy_engine_run(engine, length, fail_part, &fail));
+    EXPECT_EQ(4, fail.calls);
+
+    fail.fail_offset = length;
+    fail.calls       = 0;
+    EXPECT_UCS_OK(ucs_copy_engine_run(engine, length, fail_part, &fail));
+    EXPECT_EQ(4, fail.calls);
+
+    ucs_copy_engine_destroy(engine);
+}
+
+UCS_MT_TEST_F(test_copy_engine, concurrent, 4) {
+    static ucs_copy_engine_t *engine = NULL;
+
+    if (barrier()) {
+        ASSERT_UCS_OK(ucs_copy_engine_create(2, MIN_PART, -1, "test", &engine));
+    }
+    barrier();
+
+    for (int i = 0; i < 100 / ucs::test_time_multiplier(); ++i) {
+        check_memcpy(engine, 16 * MIN_PART + i);
+    }
+
+    barrier();
+    if (barrier()) {
+        ucs_copy_engine_destroy(engine);
+        engine = NULL;
+    }
+}
+
+UCS_TEST_F(test_copy_engine, perf) {
+    const size_t length  = 64 * UCS_MBYTE;
+    const unsigned count = 20;
+    static const unsigned threads[] = { 0, 1, 3, 7 };
+
+    if (ucs::test_time_multiplier() > 1) {
+        UCS_TEST_SKIP;
+    }
+
+    for (unsigned t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+        UCS_TEST_MESSAGE << "copy " << length / UCS_MBYTE << "MB with "
+                         << threads[t] << " helper threads: "
+                         << measure_bw(threads[t], length, count) << " MB/s";
+    }
+}
@@ -0,0 +1,112 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+#include <common/test.h>
+extern "C" {
+#include <ucs/arch/cpu.h>
+#include <ucs/time/time.h>
+}
+
+#include <vector>
+
+
+static const size_t  MAX_ALIGN = 64;
+static const uint8_t GUARD     = 0xcc;
+
+class test_memcpy : public ucs::test {
+protected:
+
+    void fill(std::vector<uint8_t>& buf, unsigned seed) {
+        for (size_t i = 0; i < buf.size(); ++i) {
+            buf[i] = (uint8_t)(seed + i * 7) | 1;
+        }
+    }
+
+    void check_copy(size_t length, size_t src_offset, size_t dst_offset) {
+        std::vector<uint8_t> src(length + MAX_ALIGN), dst(length + 2 * MAX_ALIGN);
+
+        fill(src, length + src_offset);
+        std::fill(dst.begin(), dst.end(), GUARD);
+
+        ucs_memcpy_relaxed(&dst[dst_offset], &src[src_offset], length);
+
+        for (size_t i = 0; i < dst.size(); ++i) {
+            if ((i >= dst_offset) && (i < dst_offset + length)) {
+                ASSERT_EQ(src[src_offset + i - dst_offset], dst[i])
+                    << "length " << length << " src_offset " << src_offset
+                    << " dst_offset " << dst_offset << " index " << i;
+            } else {
+                ASSERT_EQ(GUARD, dst[i])
+                    << "length " << length << " src_offset " << src_offset
+                    << " dst_offset " << dst_offset << " index " << i;
+            }
+        }
+    }
+
+    void check_sizes() {
+        static const size_t lengths[] = { 0, 1, 15, 16, 31, 32, 63, 64, 65, 127,
+                                          128, 129, 255, 256, 1000, 4096, 65537 };
+
+        for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i) {
+            for (size_t src_offset = 0; src_offset < MAX_ALIGN; src_offset += 3) {
+                for (size_t dst_offset = 0; dst_offset < MAX_ALIGN;
+                     dst_offset += 5) {
+                    check_copy(lengths[i], src_offset, dst_offset);
+                }
+            }
+        }
+    }
+
+    double measure_bw(size_t length, unsigned count) {
+        std::vector<uint8_t> src(length), dst(length);
+        ucs_time_t start_time, end_time;
+
+        fill(src, 0);
+        ucs_memcpy_relaxed(&dst[0], &src[0], length); /* warmup */
+
+        start_time = ucs_get_time();
+        for (unsigned i = 0; i < count; ++i) {
+            ucs_memcpy_relaxed(&dst[0], &src[0], length);
+        }
+        end_time = ucs_get_time();
+
+        EXPECT_EQ(src, dst);
+        return (length * (double)count) /
+               ucs_time_to_sec(end_time - start_time) / UCS_MBYTE;
+    }
+};
+
+UCS_TEST_F(test_memcpy, regular) {
+    modify_config("MEMCPY_NT_THRESH", "inf");
+    check_sizes();
+}
+
+UCS_TEST_F(test_memcpy, non_temporal) {
+    /* Force all copies to use the non-temporal path */
+    modify_config("MEMCPY_NT_THRESH", "0");
+    check_sizes();
+}
+
+UCS_TEST_F(test_memcpy, perf) {
+    const size_t length  = 16 * UCS_MBYTE;
+    const unsigned count = 100 / ucs::test_time_multiplier();
+    double bw_regular, bw_nt;
+
+    if (ucs::test_time_multiplier() > 1) {
+        UCS_TEST_SKIP;
+    }
+
+    modify_config("MEMCPY_NT_THRESH", "inf");
+    bw_regular = measure_bw(length, count);
+
+    modify_config("MEMCPY_NT_THRESH", "0");
+    bw_nt      = measure_bw(length, count);
+
+    UCS_TEST_MESSAGE << "copy " << length / UCS_MBYTE << "MB: memcpy "
+                     << bw_regular << " MB/s, non-temporal " << bw_nt
+                     << " MB/s, cpu flags 0x" << std::hex
+                     << ucs_arch_get_cpu_flag();
+}
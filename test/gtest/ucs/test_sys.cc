@@ -103,3 +103,31 @@ UCS_TEST_F(test_sys, memory) {
     UCS_TEST_MESSAGE << "Physical memory size: " << ucs::size_value(phys_size);
     EXPECT_GT(phys_size, 1ul * 1024 * 1024);
 }
+
+UCS_TEST_F(test_sys, numa) {
+    size_t size = 4 * ucs_get_page_size();
+    ucs_status_t status;
+    int node;
+    void *ptr;
+
+    EXPECT_EQ(-1, ucs_numa_node_of_cpu(-1));
+    EXPECT_EQ(-1, ucs_numa_node_of_device("/sys/class/no_such_class/dev"));
+
+    node = ucs_numa_current_node();
+    UCS_TEST_MESSAGE << "Current NUMA node: " << node;
+    if (node < 0) {
+        UCS_TEST_SKIP_R("NUMA topology is not available");
+    }
+    EXPECT_GE(ucs_numa_node_of_cpu(ucs_get_first_cpu()), 0);
+
+    ptr = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON, -1, 0);
+    ASSERT_TRUE(ptr != MAP_FAILED);
+
+    /* mbind() may be blocked in containers */
+    status = ucs_numa_bind_memory((char*)ptr + 1, size - 1, node);
+    EXPECT_TRUE((status == UCS_OK) || (status == UCS_ERR_UNSUPPORTED));
+    EXPECT_EQ(UCS_ERR_INVALID_PARAM, ucs_numa_bind_memory(ptr, size, -1));
+    memset(ptr, 0, size);
+
+    munmap(ptr, size);
+}
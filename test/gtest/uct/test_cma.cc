@@ -0,0 +1,218 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+extern "C" {
+#include <uct/api/uct.h>
+}
+#include <common/test.h>
+#include "uct_test.h"
+
+class test_uct_cma : public uct_test {
+public:
+    static const size_t CHUNK_SIZE = 4096;
+
+    void init() {
+        set_config("CHUNK_SIZE=4096");
+        uct_test::init();
+
+        m_e1 = uct_test::create_entity(0);
+        m_entities.push_back(m_e1);
+
+        m_e2 = uct_test::create_entity(0);
+        m_entities.push_back(m_e2);
+
+        m_e1->connect(0, *m_e2, 0);
+        m_e2->connect(0, *m_e1, 0);
+    }
+
+    typedef struct {
+        uct_completion_t uct;
+        unsigned         *order;
+        unsigned         index;
+        ucs_status_t     status;
+    } comp_t;
+
+    static void completion(uct_completion_t *self, ucs_status_t status) {
+        comp_t *comp = ucs_container_of(self, comp_t, uct);
+        comp->index  = (*comp->order)++;
+        comp->status = status;
+    }
+
+    void comp_init(comp_t *comp, unsigned *order) {
+        comp->uct.func  = completion;
+        comp->uct.count = 1;
+        comp->order     = order;
+        comp->index     = UINT_MAX;
+        comp->status    = UCS_ERR_NO_MESSAGE;
+    }
+
+    typedef struct {
+        uct_pending_req_t uct;
+        test_uct_cma      *test;
+        mapped_buffer     *sendbuf;
+        mapped_buffer     *recvbuf;
+        comp_t            comp;
+        unsigned          count;
+    } pending_put_t;
+
+    static ucs_status_t pending_put(uct_pending_req_t *self) {
+        pending_put_t *req = ucs_container_of(self, pending_put_t, uct);
+        ucs_status_t status;
+
+        status = uct_ep_put_zcopy(req->test->m_e1->ep(0), req->sendbuf->ptr(),
+                                  req->sendbuf->length(), req->sendbuf->memh(),
+                                  req->recvbuf->addr(), req->recvbuf->rkey(),
+                                  &req->comp.uct);
+        ++req->count;
+        return (status == UCS_INPROGRESS) ? UCS_OK : status;
+    }
+
+protected:
+    entity *m_e1, *m_e2;
+};
+
+UCS_TEST_P(test_uct_cma, get_zcopy_chunked) {
+    const size_t length = 16 * CHUNK_SIZE;
+    unsigned order = 0;
+    unsigned progress_count;
+    ucs_status_t status;
+    comp_t comp;
+
+    mapped_buffer sendbuf(length, 1, *m_e2);
+    mapped_buffer recvbuf(length, 0, *m_e1);
+
+    comp_init(&comp, &order);
+    status = uct_ep_get_zcopy(m_e1->ep(0), recvbuf.ptr(), length, recvbuf.memh(),
+                              sendbuf.addr(), sendbuf.rkey(), &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+    EXPECT_EQ(UCS_INPROGRESS, uct_iface_flush(m_e1->iface()));
+
+    /* every progress call copies a single chunk */
+    progress_count = 0;
+    while (order == 0) {
+        m_e1->progress();
+        ++progress_count;
+    }
+
+    EXPECT_EQ(length / CHUNK_SIZE, progress_count);
+    EXPECT_EQ(UCS_OK, comp.status);
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+    EXPECT_EQ(UCS_OK, uct_iface_flush(m_e1->iface()));
+    recvbuf.pattern_check(1);
+}
+
+UCS_TEST_P(test_uct_cma, put_zcopy_coalesce, "MAX_IOV=8") {
+    static const unsigned num_small = 4;
+    const size_t large_length = 2 * CHUNK_SIZE;
+    const size_t small_length = CHUNK_SIZE / num_small;
+    unsigned order = 0;
+    unsigned progress_count;
+    comp_t comps[num_small + 1];
+    ucs::ptr_vector<mapped_buffer> sendbufs, recvbufs;
+    ucs_status_t status;
+    size_t length;
+
+    for (unsigned i = 0; i <= num_small; ++i) {
+        length = (i == 0) ? large_length : small_length;
+        sendbufs.push_back(new mapped_buffer(length, i + 1, *m_e1));
+        recvbufs.push_back(new mapped_buffer(length, 0, *m_e2));
+
+        /* the large put is queued, so the small ones are queued behind it */
+        comp_init(&comps[i], &order);
+        status = uct_ep_put_zcopy(m_e1->ep(0), sendbufs.at(i).ptr(), length,
+                                  sendbufs.at(i).memh(), recvbufs.at(i).addr(),
+                                  recvbufs.at(i).rkey(), &comps[i].uct);
+        ASSERT_EQ(UCS_INPROGRESS, status);
+    }
+
+    /* two chunks for the large put, and a single coalesced copy for the rest */
+    progress_count = 0;
+    while (order < num_small + 1) {
+        m_e1->progress();
+        ++progress_count;
+    }
+    EXPECT_EQ(3u, progress_count);
+
+    for (unsigned i = 0; i <= num_small; ++i) {
+        EXPECT_EQ(i, comps[i].index);
+        EXPECT_EQ(UCS_OK, comps[i].status);
+        recvbufs.at(i).pattern_check(i + 1);
+    }
+}
+
+UCS_TEST_P(test_uct_cma, pending, "TX_QUEUE_LEN=1") {
+    const size_t length = 4 * CHUNK_SIZE;
+    unsigned order = 0;
+    ucs_status_t status;
+    pending_put_t req;
+    comp_t comp;
+
+    check_caps(UCT_IFACE_FLAG_PENDING);
+
+    mapped_buffer sendbuf1(length, 1, *m_e1);
+    mapped_buffer recvbuf1(length, 0, *m_e2);
+    mapped_buffer sendbuf2(length, 2, *m_e1);
+    mapped_buffer recvbuf2(length, 0, *m_e2);
+
+    comp_init(&comp, &order);
+    status = uct_ep_put_zcopy(m_e1->ep(0), sendbuf1.ptr(), length,
+                              sendbuf1.memh(), recvbuf1.addr(), recvbuf1.rkey(),
+                              &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    req.uct.func = pending_put;
+    req.test     = this;
+    req.sendbuf  = &sendbuf2;
+    req.recvbuf  = &recvbuf2;
+    req.count    = 0;
+    comp_init(&req.comp, &order);
+
+    status = pending_put(&req.uct);
+    ASSERT_EQ(UCS_ERR_NO_RESOURCE, status);
+    ASSERT_UCS_OK(uct_ep_pending_add(m_e1->ep(0), &req.uct));
+
+    while (order < 2) {
+        m_e1->progress();
+    }
+
+    EXPECT_EQ(2u, req.count);
+    EXPECT_EQ(0u, comp.index);
+    EXPECT_EQ(1u, req.comp.index);
+    recvbuf1.pattern_check(1);
+    recvbuf2.pattern_check(2);
+}
+
+UCS_TEST_P(test_uct_cma, copy_threads, "COPY_THREADS=3", "COPY_MIN_PART=1024") {
+    const size_t length = 3 * CHUNK_SIZE + 100;
+    unsigned order = 0;
+    ucs_status_t status;
+    comp_t comp;
+
+    mapped_buffer sendbuf(length, 1, *m_e1);
+    mapped_buffer recvbuf(length, 0, *m_e2);
+
+    /* copied in place, split between the threads */
+    status = uct_ep_put_zcopy(m_e1->ep(0), sendbuf.ptr(), CHUNK_SIZE,
+                              sendbuf.memh(), recvbuf.addr(), recvbuf.rkey(),
+                              NULL);
+    ASSERT_UCS_OK(status);
+    mapped_buffer::pattern_check(recvbuf.ptr(), CHUNK_SIZE, 1);
+
+    /* every chunk is split between the threads */
+    comp_init(&comp, &order);
+    status = uct_ep_get_zcopy(m_e2->ep(0), recvbuf.ptr(), length,
+                              recvbuf.memh(), sendbuf.addr(), sendbuf.rkey(),
+                              &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+    while (order == 0) {
+        m_e2->progress();
+    }
+    EXPECT_EQ(UCS_OK, comp.status);
+    recvbuf.pattern_check(1);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_cma, cma)
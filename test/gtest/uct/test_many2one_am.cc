@@ -112,8 +112,12 @@ UCS_TEST_P(test_many2one_am, am_bcopy, "MAX_BCOPY=16384")
         }
     }
 
+    /* senders may have to progress to push the rest of their messages */
     while (m_am_count < num_sends) {
         receiver->progress();
+        for (unsigned i = 0; i < NUM_SENDERS; ++i) {
+            senders.at(i).progress();
+        }
     }
 
     status = uct_iface_set_am_handler(receiver->iface(), AM_ID, NULL, NULL, UCT_AM_CB_FLAG_SYNC);
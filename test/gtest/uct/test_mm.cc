@@ -8,6 +8,8 @@ extern "C" {
 #include <uct/api/uct.h>
 #include <ucs/time/time.h>
 }
+#include <poll.h>
+#include <sys/socket.h>
 #include "uct_p2p_test.h"
 #include <common/test.h>
 #include "uct_test.h"
@@ -51,6 +53,83 @@ public:
         return UCS_OK;
     }
 
+    static ucs_status_t count_am_handler(void *arg, void *data, size_t length,
+                                         void *desc) {
+        ++(*(unsigned*)arg);
+        return UCS_OK;
+    }
+
+    static ucs_status_t lanes_am_handler(void *arg, void *data, size_t length,
+                                         void *desc) {
+        std::vector<uint64_t> *recvd = (std::vector<uint64_t>*)arg;
+        recvd->push_back(*(uint64_t*)data);
+        return UCS_OK;
+    }
+
+    static ucs_status_t copy_am_handler(void *arg, void *data, size_t length,
+                                        void *desc) {
+        std::string *recvd = (std::string*)arg;
+        recvd->assign((const char*)data, length);
+        return UCS_OK;
+    }
+
+    typedef struct {
+        void             *data;
+        size_t           length;
+        void             *desc;
+    } held_am_t;
+
+    static ucs_status_t hold_am_handler(void *arg, void *data, size_t length,
+                                        void *desc) {
+        std::vector<held_am_t> *held = (std::vector<held_am_t>*)arg;
+        held_am_t am = { data, length, desc };
+        held->push_back(am);
+        return UCS_INPROGRESS;
+    }
+
+    typedef struct {
+        uct_completion_t uct;
+        unsigned         count;
+        ucs_status_t     status;
+    } zcopy_comp_t;
+
+    static void zcopy_completion(uct_completion_t *self, ucs_status_t status) {
+        zcopy_comp_t *comp = ucs_container_of(self, zcopy_comp_t, uct);
+        ++comp->count;
+        comp->status = status;
+    }
+
+    void send_seq(unsigned ep_index, unsigned first, unsigned count) {
+        ucs_status_t status;
+        uint64_t hdr;
+
+        for (unsigned seq = first; seq < first + count; ++seq) {
+            hdr = ((uint64_t)ep_index << 32) | seq;
+            do {
+                status = uct_ep_am_short(m_e1->ep(ep_index), 0, hdr, NULL, 0);
+                if (status == UCS_ERR_NO_RESOURCE) {
+                    progress();
+                }
+            } while (status == UCS_ERR_NO_RESOURCE);
+            ASSERT_UCS_OK(status);
+        }
+    }
+
+    /* check every ep's messages arrived in order, and return their number */
+    static std::vector<unsigned> count_seq(const std::vector<uint64_t>& recvd,
+                                           unsigned num_eps) {
+        std::vector<unsigned> next(num_eps, 0);
+
+        for (std::vector<uint64_t>::const_iterator iter = recvd.begin();
+             iter != recvd.end(); ++iter) {
+            unsigned ep_index = *iter >> 32;
+            EXPECT_LT(ep_index, num_eps);
+            EXPECT_EQ(next[ep_index], (unsigned)(*iter & UINT32_MAX));
+            ++next[ep_index];
+        }
+        return next;
+    }
+
     void cleanup() {
         uct_test::cleanup();
     }
@@ -84,4 +163,254 @@ UCS_TEST_P(test_uct_mm, open_for_posix) {
     free(recv_buffer);
 }
 
+UCS_TEST_P(test_uct_mm, poll_batch, "FIFO_POLL_BATCH=4") {
+    static const unsigned num_sends = 10;
+    uint64_t send_data = 0xdeadbeef;
+    unsigned recv_count, count, i;
+    ucs_status_t status;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    recv_count = 0;
+    uct_iface_set_am_handler(m_e2->iface(), 0, count_am_handler, &recv_count,
+                             UCT_AM_CB_FLAG_SYNC);
+
+    for (i = 0; i < num_sends; ++i) {
+        status = uct_ep_am_short(m_e1->ep(0), 0, 0, &send_data,
+                                 sizeof(send_data));
+        ASSERT_UCS_OK(status);
+    }
+
+    /* every progress call receives up to a batch of ready messages */
+    count = uct_worker_progress(m_e2->worker());
+    EXPECT_EQ(4u, count);
+    EXPECT_EQ(4u, recv_count);
+
+    count = uct_worker_progress(m_e2->worker());
+    EXPECT_EQ(4u, count);
+
+    count = uct_worker_progress(m_e2->worker());
+    EXPECT_EQ(2u, count);
+    EXPECT_EQ(num_sends, recv_count);
+}
+
+UCS_TEST_P(test_uct_mm, fifo_lanes, "FIFO_LANES=2") {
+    static const unsigned num_eps = 4;
+    static const unsigned count   = 40;
+    std::vector<uint64_t> recvd;
+    std::vector<unsigned> nrecvd;
+    unsigned i;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT);
+
+    uct_iface_set_am_handler(m_e2->iface(), 0, lanes_am_handler, &recvd,
+                             UCT_AM_CB_FLAG_SYNC);
+
+    /* the first two eps own lanes, the others share the FIFO */
+    for (i = 1; i < num_eps; ++i) {
+        m_e1->connect_to_iface(i, *m_e2);
+    }
+
+    for (i = 0; i < num_eps; ++i) {
+        send_seq(i, 0, count);
+    }
+    while (recvd.size() < num_eps * count) {
+        progress();
+    }
+
+    nrecvd = count_seq(recvd, num_eps);
+    for (i = 0; i < num_eps; ++i) {
+        EXPECT_EQ(count, nrecvd[i]) << "ep " << i;
+    }
+
+    /* messages sent to a lane before its ep is destroyed are still received,
+     * and a new ep can take over the lane */
+    send_seq(1, count, count / 2);
+    m_e1->destroy_ep(1);
+    m_e1->connect_to_iface(1, *m_e2);
+    send_seq(1, count + count / 2, count / 2);
+
+    while (recvd.size() < (num_eps + 1) * count) {
+        progress();
+    }
+    short_progress_loop();
+
+    nrecvd = count_seq(recvd, num_eps);
+    EXPECT_EQ(2 * count, nrecvd[1]);
+    EXPECT_EQ((num_eps + 1) * count, recvd.size());
+}
+
+UCS_TEST_P(test_uct_mm, am_zcopy_completion) {
+    zcopy_comp_t comp;
+    ucs_status_t status;
+    std::string recvd;
+    size_t length;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY);
+
+    /* the payload is not limited by the receive descriptor size */
+    length = ucs_min(4 * m_e1->iface_attr().cap.am.max_bcopy,
+                     m_e1->iface_attr().cap.am.max_zcopy);
+
+    uct_iface_set_am_handler(m_e2->iface(), 0, copy_am_handler, &recvd,
+                             UCT_AM_CB_FLAG_SYNC);
+
+    mapped_buffer sendbuf(length, 1, *m_e1);
+
+    comp.uct.func  = zcopy_completion;
+    comp.uct.count = 1;
+    comp.count     = 0;
+    comp.status    = UCS_ERR_NO_MESSAGE;
+    status = uct_ep_am_zcopy(m_e1->ep(0), 0, NULL, 0, sendbuf.ptr(), length,
+                             sendbuf.memh(), &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    /* the payload is still in the sender's buffer until the receiver reads it */
+    m_e1->progress();
+    EXPECT_EQ(0u, comp.count);
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+
+    m_e2->progress();
+    ASSERT_EQ(length, recvd.size());
+    mapped_buffer::pattern_check(recvd.data(), length, 1);
+
+    m_e1->progress();
+    EXPECT_EQ(1u, comp.count);
+    EXPECT_EQ(UCS_OK, comp.status);
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+}
+
+UCS_TEST_P(test_uct_mm, am_zcopy_hold_desc) {
+    static const unsigned count = 2;
+    zcopy_comp_t comp[count];
+    std::vector<held_am_t> held;
+    ucs_status_t status;
+    size_t length;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_ZCOPY);
+
+    length = ucs_min(4 * m_e1->iface_attr().cap.am.max_bcopy,
+                     m_e1->iface_attr().cap.am.max_zcopy);
+
+    uct_iface_set_am_handler(m_e2->iface(), 0, hold_am_handler, &held,
+                             UCT_AM_CB_FLAG_SYNC);
+
+    mapped_buffer sendbuf(length * count, 1, *m_e1);
+
+    for (unsigned i = 0; i < count; ++i) {
+        comp[i].uct.func  = zcopy_completion;
+        comp[i].uct.count = 1;
+        comp[i].count     = 0;
+        comp[i].status    = UCS_ERR_NO_MESSAGE;
+        status = uct_ep_am_zcopy(m_e1->ep(0), 0, NULL, 0,
+                                 (char*)sendbuf.ptr() + i * length, length,
+                                 sendbuf.memh(), &comp[i].uct);
+        ASSERT_EQ(UCS_INPROGRESS, status);
+    }
+
+    m_e2->progress();
+    ASSERT_EQ(count, held.size());
+
+    /* the payloads are passed in the mapping of the sender's buffer, and
+     * their sends are not completed while they are held */
+    m_e1->progress();
+    for (unsigned i = 0; i < count; ++i) {
+        EXPECT_EQ(length, held[i].length);
+        EXPECT_EQ(i * length,
+                  (size_t)((char*)held[i].data - (char*)held[0].data));
+        mapped_buffer::pattern_check(held[i].data, length);
+        EXPECT_EQ(0u, comp[i].count);
+    }
+
+    /* the sends are completed in the order their payloads are released */
+    uct_iface_release_am_desc(held[1].desc);
+    m_e1->progress();
+    EXPECT_EQ(0u, comp[0].count);
+    EXPECT_EQ(1u, comp[1].count);
+    EXPECT_EQ(UCS_OK, comp[1].status);
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+
+    uct_iface_release_am_desc(held[0].desc);
+    m_e1->progress();
+    EXPECT_EQ(1u, comp[0].count);
+    EXPECT_EQ(UCS_OK, comp[0].status);
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+}
+
+UCS_TEST_P(test_uct_mm, wakeup_armed, "FIFO_LANES=1") {
+    static const unsigned count = 3;
+    std::vector<uint64_t> recvd;
+    uct_wakeup_h wakeup;
+    struct pollfd pfd;
+    unsigned nsignals;
+    uint8_t sig;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_WAKEUP | UCT_IFACE_FLAG_AM_SHORT);
+
+    uct_iface_set_am_handler(m_e2->iface(), 0, lanes_am_handler, &recvd,
+                             UCT_AM_CB_FLAG_SYNC);
+
+    /* ep 0 owns the lane, ep 1 sends to the shared FIFO */
+    m_e1->connect_to_iface(1, *m_e2);
+
+    ASSERT_UCS_OK(uct_wakeup_open(m_e2->iface(), UCT_WAKEUP_RX_AM, &wakeup));
+    ASSERT_UCS_OK(uct_wakeup_efd_get(wakeup, &pfd.fd));
+    pfd.events = POLLIN;
+
+    /* no signals are sent while the wakeup is not armed */
+    send_seq(0, 0, count);
+    send_seq(1, 0, count);
+    EXPECT_EQ(0, poll(&pfd, 1, 0));
+
+    /* a single signal for all the messages sent after arming */
+    ASSERT_UCS_OK(uct_wakeup_efd_arm(wakeup));
+    send_seq(0, count, count);
+    send_seq(1, count, count);
+    ASSERT_EQ(1, poll(&pfd, 1, 1000));
+
+    nsignals = 0;
+    while (recv(pfd.fd, &sig, sizeof(sig), MSG_DONTWAIT) > 0) {
+        ++nsignals;
+    }
+    EXPECT_EQ(1u, nsignals);
+
+    while (recvd.size() < 4 * count) {
+        progress();
+    }
+    count_seq(recvd, 2);
+
+    uct_wakeup_close(wakeup);
+}
+
+UCS_TEST_P(test_uct_mm, zcopy_copy_threads, "COPY_THREADS=3",
+           "COPY_MIN_PART=4096") {
+    const size_t length = 64 * 1024 + 11;
+    ucs_status_t status;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_PUT_ZCOPY | UCT_IFACE_FLAG_GET_ZCOPY);
+
+    mapped_buffer sendbuf(length, 1, *m_e1);
+    mapped_buffer recvbuf(length, 0, *m_e2);
+    mapped_buffer getbuf(length, 0, *m_e1);
+
+    /* both copies are split between the helper threads and the caller */
+    status = uct_ep_put_zcopy(m_e1->ep(0), sendbuf.ptr(), length,
+                              sendbuf.memh(), recvbuf.addr(), recvbuf.rkey(),
+                              NULL);
+    ASSERT_UCS_OK(status);
+    recvbuf.pattern_check(1);
+
+    status = uct_ep_get_zcopy(m_e1->ep(0), getbuf.ptr(), length,
+                              getbuf.memh(), recvbuf.addr(), recvbuf.rkey(),
+                              NULL);
+    ASSERT_UCS_OK(status);
+    getbuf.pattern_check(1);
+}
+
 _UCT_INSTANTIATE_TEST_CASE(test_uct_mm, mm)
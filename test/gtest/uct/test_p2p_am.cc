@@ -454,4 +454,6 @@ UCS_TEST_P(uct_p2p_am_misc, no_rx_buffs) {
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_test)
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_test, self)
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_misc)
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_am_misc, self)
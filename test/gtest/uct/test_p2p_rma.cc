@@ -115,3 +115,4 @@ UCS_TEST_P(uct_p2p_rma_test, get_zcopy) {
 }
 
 UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test)
+_UCT_INSTANTIATE_TEST_CASE(uct_p2p_rma_test, self)
@@ -210,6 +210,9 @@ UCS_TEST_P(test_pd, reg_perf) {
                    posix, \
                    sysv, \
                    xpmem, \
+                   self, \
+                   tcp, \
+                   udp, \
                    cuda, \
                    ib, \
                    ugni \
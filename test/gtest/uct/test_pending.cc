@@ -11,6 +11,8 @@ extern "C" {
 #include <common/test.h>
 #include "uct_test.h"
 
+#include <algorithm>
+
 class test_uct_pending : public uct_test {
 public:
     void initialize() {
@@ -67,6 +69,54 @@ public:
         return status;
     }
 
+    typedef struct prio_send_request {
+        uct_ep_h          ep;
+        uint64_t          data;       /* Next value to send */
+        unsigned          count;      /* How many values are left to send */
+        uct_pending_req_t uct;
+    } prio_send_request_t;
+
+    static ucs_status_t am_record_handler(void *arg, void *data, size_t length,
+                                          void *desc) {
+        std::vector<uint64_t> *received = (std::vector<uint64_t>*)arg;
+        received->push_back(*(uint64_t*)((char*)data + sizeof(uint64_t)));
+        return UCS_OK;
+    }
+
+    /* Send one value on every call, like a request sent in fragments */
+    static ucs_status_t prio_send_op(uct_pending_req_t *self) {
+        prio_send_request_t *req = ucs_container_of(self, prio_send_request_t,
+                                                    uct);
+        ucs_status_t status;
+
+        status = uct_ep_am_short(req->ep, 0, test_pending_hdr, &req->data,
+                                 sizeof(req->data));
+        if (status != UCS_OK) {
+            return status;
+        }
+
+        ++req->data;
+        return (--req->count == 0) ? UCS_OK : UCS_INPROGRESS;
+    }
+
+    void prio_init(prio_send_request_t *req, uint64_t data, unsigned count) {
+        req->ep       = m_e1->ep(0);
+        req->data     = data;
+        req->count    = count;
+        req->uct.func = prio_send_op;
+    }
+
+    void fill_resources() {
+        uint64_t fill_data = 0;
+        ucs_status_t status;
+
+        do {
+            status = uct_ep_am_short(m_e1->ep(0), 0, test_pending_hdr,
+                                     &fill_data, sizeof(fill_data));
+        } while (status == UCS_OK);
+        ASSERT_EQ(UCS_ERR_NO_RESOURCE, status);
+    }
+
     pending_send_request_t* pending_alloc(uint64_t send_data) {
         pending_send_request_t *req =  new pending_send_request_t();
         req->ep        = m_e1->ep(0);
@@ -210,4 +260,54 @@ UCS_TEST_P(test_uct_pending, send_ooo_with_pending)
     EXPECT_EQ(send_data, 0xdeadbeef + counter - 1);
 }
 
+UCS_TEST_P(test_uct_pending, pending_prio)
+{
+    const unsigned num_frags = 1024; /* more than the send queue can hold */
+    std::vector<uint64_t> received;
+    std::vector<uint64_t>::iterator first, last, ctrl_pos;
+    prio_send_request_t bulk, ctrl;
+    ucs_status_t status;
+
+    initialize();
+    check_caps(UCT_IFACE_FLAG_AM_SHORT | UCT_IFACE_FLAG_PENDING |
+               UCT_IFACE_FLAG_PENDING_PRIO);
+
+    install_handler_sync_or_async(m_e2->iface(), 0, am_record_handler,
+                                  &received);
+
+    /* queue a low priority request and let it send some of its fragments */
+    fill_resources();
+    prio_init(&bulk, 100, num_frags);
+    status = uct_ep_pending_add_prio(m_e1->ep(0), &bulk.uct,
+                                     UCT_PENDING_PRIO_LOW);
+    ASSERT_UCS_OK(status);
+
+    while (bulk.count == num_frags) {
+        m_e2->progress();
+        m_e1->progress();
+    }
+    ASSERT_GT(bulk.count, 0u);
+
+    /* a high priority request should bypass the rest of the fragments */
+    fill_resources();
+    prio_init(&ctrl, 1, 1);
+    status = uct_ep_pending_add_prio(m_e1->ep(0), &ctrl.uct,
+                                     UCT_PENDING_PRIO_HIGH);
+    ASSERT_UCS_OK(status);
+
+    while ((bulk.count > 0) || (ctrl.count > 0) ||
+           (std::find(received.begin(), received.end(),
+                      100 + num_frags - 1) == received.end()))
+    {
+        progress();
+    }
+
+    first    = std::find(received.begin(), received.end(), 100);
+    last     = std::find(received.begin(), received.end(), 100 + num_frags - 1);
+    ctrl_pos = std::find(received.begin(), received.end(), 1);
+    ASSERT_TRUE(ctrl_pos != received.end());
+    EXPECT_LT(first - received.begin(), ctrl_pos - received.begin());
+    EXPECT_LT(ctrl_pos - received.begin(), last - received.begin());
+}
+
 UCT_INSTANTIATE_TEST_CASE(test_uct_pending);
@@ -0,0 +1,180 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+extern "C" {
+#include <uct/api/uct.h>
+}
+#include <common/test.h>
+#include "uct_test.h"
+
+class test_uct_self : public uct_test {
+public:
+    static const uint8_t AM_ID = 5;
+
+    void init() {
+        uct_test::init();
+
+        m_e1 = uct_test::create_entity(0);
+        m_entities.push_back(m_e1);
+
+        m_e2 = uct_test::create_entity(0);
+        m_entities.push_back(m_e2);
+
+        m_e1->connect(0, *m_e1, 0);
+        m_depth     = 0;
+        m_max_depth = 0;
+        m_resend    = 0;
+    }
+
+    /* Records the messages, and sends a new one for every message it gets,
+     * until m_resend messages were sent */
+    static ucs_status_t resend_am_handler(void *arg, void *data, size_t length,
+                                          void *desc) {
+        test_uct_self *self = reinterpret_cast<test_uct_self*>(arg);
+        uint64_t seq = *(uint64_t*)data;
+        ucs_status_t status;
+
+        ++self->m_depth;
+        self->m_max_depth = ucs_max(self->m_max_depth, self->m_depth);
+        self->m_recvd.push_back(seq);
+
+        if (self->m_resend > 0) {
+            --self->m_resend;
+            status = uct_ep_am_short(self->m_e1->ep(0), AM_ID, seq + 1, NULL, 0);
+            EXPECT_UCS_OK(status);
+        }
+
+        --self->m_depth;
+        return UCS_OK;
+    }
+
+    struct pending_send {
+        uct_pending_req_t uct;
+        uct_ep_h          ep;
+        uint64_t          seq;
+        bool              sent;
+    };
+
+    static ucs_status_t pending_send_op(uct_pending_req_t *self) {
+        pending_send *req = ucs_container_of(self, pending_send, uct);
+        ucs_status_t status;
+
+        status = uct_ep_am_short(req->ep, AM_ID, req->seq, NULL, 0);
+        req->sent = (status == UCS_OK);
+        return status;
+    }
+
+protected:
+    entity                *m_e1, *m_e2;
+    unsigned              m_depth;
+    unsigned              m_max_depth;
+    unsigned              m_resend;
+    std::vector<uint64_t> m_recvd;
+};
+
+UCS_TEST_P(test_uct_self, reachable) {
+    std::vector<char> dev_addr1(m_e1->iface_attr().device_addr_len);
+    std::vector<char> dev_addr2(m_e2->iface_attr().device_addr_len);
+    ucs_status_t status;
+
+    status = uct_iface_get_device_address(m_e1->iface(),
+                                          (uct_device_addr_t*)&dev_addr1[0]);
+    ASSERT_UCS_OK(status);
+    status = uct_iface_get_device_address(m_e2->iface(),
+                                          (uct_device_addr_t*)&dev_addr2[0]);
+    ASSERT_UCS_OK(status);
+
+    /* every interface can reach only itself */
+    EXPECT_TRUE(uct_iface_is_reachable(m_e1->iface(),
+                                       (uct_device_addr_t*)&dev_addr1[0]));
+    EXPECT_TRUE(uct_iface_is_reachable(m_e2->iface(),
+                                       (uct_device_addr_t*)&dev_addr2[0]));
+    EXPECT_FALSE(uct_iface_is_reachable(m_e1->iface(),
+                                        (uct_device_addr_t*)&dev_addr2[0]));
+    EXPECT_FALSE(uct_iface_is_reachable(m_e2->iface(),
+                                        (uct_device_addr_t*)&dev_addr1[0]));
+}
+
+UCS_TEST_P(test_uct_self, am_from_handler) {
+    static const unsigned count = 10;
+    ucs_status_t status;
+
+    status = uct_iface_set_am_handler(m_e1->iface(), AM_ID, resend_am_handler,
+                                      this, UCT_AM_CB_FLAG_SYNC);
+    ASSERT_UCS_OK(status);
+
+    /* the message is delivered only by progress */
+    m_resend = count - 1;
+    status   = uct_ep_am_short(m_e1->ep(0), AM_ID, 0, NULL, 0);
+    ASSERT_UCS_OK(status);
+    EXPECT_TRUE(m_recvd.empty());
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+
+    /* every progress call delivers the message sent by the previous one,
+     * without calling the handler recursively */
+    for (unsigned i = 0; i < count; ++i) {
+        m_e1->progress();
+        ASSERT_EQ(i + 1, m_recvd.size());
+        EXPECT_EQ(i, m_recvd.back());
+    }
+    EXPECT_EQ(1u, m_max_depth);
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+}
+
+UCS_TEST_P(test_uct_self, pending_am, "MAX_BUFS=8", "BUFS_GROW=8") {
+    static const uint64_t max_sends = 1000;
+    pending_send req;
+    ucs_status_t status;
+    uint64_t seq;
+
+    status = uct_iface_set_am_handler(m_e1->iface(), AM_ID, resend_am_handler,
+                                      this, UCT_AM_CB_FLAG_SYNC);
+    ASSERT_UCS_OK(status);
+
+    /* the descriptors are held until the messages are delivered */
+    for (seq = 0; seq < max_sends; ++seq) {
+        status = uct_ep_am_short(m_e1->ep(0), AM_ID, seq, NULL, 0);
+        if (status != UCS_OK) {
+            break;
+        }
+    }
+    ASSERT_EQ(UCS_ERR_NO_RESOURCE, status);
+
+    req.uct.func = pending_send_op;
+    req.ep       = m_e1->ep(0);
+    req.seq      = seq;
+    req.sent     = false;
+    status = uct_ep_pending_add(m_e1->ep(0), &req.uct);
+    ASSERT_UCS_OK(status);
+
+    /* the request is sent once progress releases the descriptors */
+    while (m_recvd.size() <= seq) {
+        m_e1->progress();
+    }
+    EXPECT_TRUE(req.sent);
+    for (uint64_t i = 0; i <= seq; ++i) {
+        EXPECT_EQ(i, m_recvd[i]);
+    }
+
+    /* resources are available again */
+    EXPECT_EQ(UCS_ERR_BUSY, uct_ep_pending_add(m_e1->ep(0), &req.uct));
+}
+
+UCS_TEST_P(test_uct_self, atomic_fadd) {
+    uint64_t result;
+    ucs_status_t status;
+
+    mapped_buffer buffer(sizeof(uint64_t), 0, *m_e1);
+    *(uint64_t*)buffer.ptr() = 5;
+
+    status = uct_ep_atomic_fadd64(m_e1->ep(0), 3, buffer.addr(), buffer.rkey(),
+                                  &result, NULL);
+    ASSERT_UCS_OK(status);
+    EXPECT_EQ(5u, result);
+    EXPECT_EQ(8u, *(uint64_t*)buffer.ptr());
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_self, self)
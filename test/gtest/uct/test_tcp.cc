@@ -0,0 +1,331 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+extern "C" {
+#include <uct/api/uct.h>
+#include <uct/tcp/tcp.h>
+#include <ucs/time/time.h>
+}
+#include <common/test.h>
+#include "uct_test.h"
+
+class test_uct_tcp : public uct_test {
+public:
+    static const uint8_t  AM_ID    = 4;
+    static const size_t   MSG_SIZE = 1024;
+
+    void init() {
+        uct_test::init();
+
+        m_e1 = uct_test::create_entity(0);
+        m_entities.push_back(m_e1);
+
+        m_e2 = uct_test::create_entity(0);
+        m_entities.push_back(m_e2);
+
+        m_e1->connect(0, *m_e2, 0);
+        m_e2->connect(0, *m_e1, 0);
+    }
+
+    typedef struct {
+        uct_completion_t uct;
+        unsigned         count;
+        ucs_status_t     status;
+    } comp_t;
+
+    typedef struct {
+        uct_pending_req_t uct;
+        test_uct_tcp      *test;
+        uint64_t          seq;
+    } pending_send_t;
+
+    static void completion(uct_completion_t *self, ucs_status_t status) {
+        comp_t *comp = ucs_container_of(self, comp_t, uct);
+        ++comp->count;
+        comp->status = status;
+    }
+
+    void comp_init(comp_t *comp) {
+        comp->uct.func  = completion;
+        comp->uct.count = 1;
+        comp->count     = 0;
+        comp->status    = UCS_ERR_NO_MESSAGE;
+    }
+
+    /* Records the sequence number at the beginning of the message */
+    static ucs_status_t seq_am_handler(void *arg, void *data, size_t length,
+                                       void *desc) {
+        test_uct_tcp *self = reinterpret_cast<test_uct_tcp*>(arg);
+        self->m_recvd.push_back(*(uint64_t*)data);
+        self->m_recvd_length += length;
+        return UCS_OK;
+    }
+
+    static size_t pack_seq(void *dest, void *arg) {
+        memset(dest, 0, MSG_SIZE);
+        *(uint64_t*)dest = *(uint64_t*)arg;
+        return MSG_SIZE;
+    }
+
+    ssize_t send_seq(uint64_t seq) {
+        return uct_ep_am_bcopy(m_e1->ep(0), AM_ID, pack_seq, &seq);
+    }
+
+    static ucs_status_t pending_send(uct_pending_req_t *self) {
+        pending_send_t *req = ucs_container_of(self, pending_send_t, uct);
+        ssize_t ret;
+
+        ret = req->test->send_seq(req->seq);
+        return (ret < 0) ? (ucs_status_t)ret : UCS_OK;
+    }
+
+    template <typename T>
+    void progress_until(const T& value, T expected) {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+
+        while ((value < expected) && (ucs_get_time() < deadline)) {
+            progress();
+        }
+    }
+
+    uct_tcp_device_addr_t device_addr(entity *e) {
+        uct_tcp_device_addr_t addr;
+        ucs_status_t status;
+
+        EXPECT_EQ(sizeof(addr), e->iface_attr().device_addr_len);
+        status = uct_iface_get_device_address(e->iface(),
+                                              (uct_device_addr_t*)&addr);
+        EXPECT_UCS_OK(status);
+        return addr;
+    }
+
+    bool reachable(entity *e, const uct_tcp_device_addr_t& addr) {
+        return uct_iface_is_reachable(e->iface(),
+                                      (const uct_device_addr_t*)&addr);
+    }
+
+    ucs_status_t flush_ep(entity *e) {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+        ucs_status_t status;
+
+        do {
+            progress();
+            status = uct_ep_flush(e->ep(0));
+        } while ((status == UCS_INPROGRESS) && (ucs_get_time() < deadline));
+        return status;
+    }
+
+    /* The errors of the rejected remote accesses are expected */
+    static ucs_log_func_rc_t
+    hide_errors(const char *file, unsigned line, const char *function,
+                ucs_log_level_t level, const char *prefix, const char *message,
+                va_list ap) {
+        return (level == UCS_LOG_LEVEL_ERROR) ? UCS_LOG_FUNC_RC_STOP :
+                                                UCS_LOG_FUNC_RC_CONTINUE;
+    }
+
+protected:
+    entity                *m_e1, *m_e2;
+    std::vector<uint64_t> m_recvd;
+    size_t                m_recvd_length;
+};
+
+UCS_TEST_P(test_uct_tcp, reachable) {
+    uct_tcp_device_addr_t addr = device_addr(m_e1);
+    bool is_loopback = (ntohl(addr.in_addr.s_addr) >> IN_CLASSA_NSHIFT) ==
+                       IN_LOOPBACKNET;
+
+    EXPECT_TRUE(reachable(m_e1, addr));
+    EXPECT_TRUE(reachable(m_e2, addr));
+
+    /* loopback addresses are reachable only on the same host */
+    addr.guid ^= 1;
+    EXPECT_EQ(!is_loopback, reachable(m_e1, addr));
+
+    /* other addresses are reachable only from an interface on their
+     * subnet */
+    addr.in_addr.s_addr ^= htonl(0x80000000);
+    EXPECT_FALSE(reachable(m_e1, addr));
+}
+
+UCS_TEST_P(test_uct_tcp, pending_in_order, "SNDBUF=4k", "RCVBUF=4k",
+           "SEG_SIZE=2k") {
+    static const unsigned num_pending = 8;
+    pending_send_t reqs[num_pending];
+    uint64_t seq;
+    ssize_t ret;
+    ucs_status_t status;
+
+    status = uct_iface_set_am_handler(m_e2->iface(), AM_ID, seq_am_handler,
+                                      this, UCT_AM_CB_FLAG_SYNC);
+    ASSERT_UCS_OK(status);
+    m_recvd_length = 0;
+
+    /* nothing to wait for while the socket accepts data */
+    reqs[0].uct.func = pending_send;
+    EXPECT_EQ(UCS_ERR_BUSY, uct_ep_pending_add(m_e1->ep(0), &reqs[0].uct));
+
+    /* fill the socket buffers and the endpoint buffer */
+    seq = 0;
+    do {
+        ret = send_seq(seq);
+        if (ret >= 0) {
+            ++seq;
+        }
+    } while ((ret >= 0) && (seq < 10000));
+    ASSERT_EQ(UCS_ERR_NO_RESOURCE, ret);
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+
+    for (unsigned i = 0; i < num_pending; ++i) {
+        reqs[i].uct.func = pending_send;
+        reqs[i].test     = this;
+        reqs[i].seq      = seq++;
+        status = uct_ep_pending_add(m_e1->ep(0), &reqs[i].uct);
+        ASSERT_UCS_OK(status);
+    }
+
+    /* the stream delivers the messages in the order they were sent */
+    progress_until(m_recvd_length, size_t(seq * MSG_SIZE));
+    ASSERT_EQ(seq, m_recvd.size());
+    for (uint64_t i = 0; i < seq; ++i) {
+        EXPECT_EQ(i, m_recvd[i]);
+    }
+
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+}
+
+UCS_TEST_P(test_uct_tcp, am_zcopy_complete, "ZCOPY_THRESH=4k") {
+    static const unsigned num_sends = 16;
+    const size_t length = 32 * 1024;
+    unsigned num_inprogress;
+    ucs_status_t status;
+    comp_t comp;
+
+    mapped_buffer sendbuf(length, 0, *m_e1);
+
+    status = uct_iface_set_am_handler(m_e2->iface(), AM_ID, seq_am_handler,
+                                      this, UCT_AM_CB_FLAG_SYNC);
+    ASSERT_UCS_OK(status);
+    m_recvd_length = 0;
+
+    /* a send is either copied by the socket, or completed when the kernel
+     * releases the buffer. the sends are posted without waiting for the
+     * receiver, and their headers are on the stack. */
+    comp_init(&comp);
+    num_inprogress = 0;
+    for (uint64_t seq = 0; seq < num_sends; ++seq) {
+        do {
+            status = uct_ep_am_zcopy(m_e1->ep(0), AM_ID, &seq, sizeof(seq),
+                                     sendbuf.ptr(), length, sendbuf.memh(),
+                                     &comp.uct);
+            if (status == UCS_ERR_NO_RESOURCE) {
+                progress();
+            }
+        } while (status == UCS_ERR_NO_RESOURCE);
+
+        if (status == UCS_INPROGRESS) {
+            ++num_inprogress;
+            ++comp.uct.count;
+        } else {
+            ASSERT_UCS_OK(status);
+        }
+    }
+
+    progress_until(m_recvd_length, num_sends * (sizeof(uint64_t) + length));
+    ASSERT_EQ(num_sends, m_recvd.size());
+    for (uint64_t i = 0; i < num_sends; ++i) {
+        EXPECT_EQ(i, m_recvd[i]);
+    }
+
+    /* every zero-copy send decrements the counter once */
+    ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(10.0);
+    while ((comp.uct.count > 1) && (ucs_get_time() < deadline)) {
+        progress();
+    }
+    EXPECT_EQ(1, comp.uct.count);
+    UCS_TEST_MESSAGE << num_inprogress << " of " << num_sends
+                     << " sends were zero-copy";
+}
+
+UCS_TEST_P(test_uct_tcp, put_flush) {
+    ucs_status_t status;
+
+    mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e1);
+    mapped_buffer recvbuf(sizeof(uint64_t), 0, *m_e2);
+
+    status = uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(), sendbuf.length(),
+                              recvbuf.addr(), recvbuf.rkey());
+    ASSERT_UCS_OK(status);
+
+    /* the put is written by the peer, which acknowledges the flush */
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+    m_e1->progress();
+    EXPECT_EQ(UCS_INPROGRESS, uct_ep_flush(m_e1->ep(0)));
+
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+    recvbuf.pattern_check(1);
+}
+
+UCS_TEST_P(test_uct_tcp, put_outside_region) {
+    ucs_status_t status;
+
+    mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e1);
+    mapped_buffer recvbuf(sizeof(uint64_t), 0, *m_e2);
+
+    ucs_log_push_handler(hide_errors);
+    UCS_TEST_SCOPE_EXIT() { ucs_log_pop_handler(); } UCS_TEST_SCOPE_EXIT_END
+
+    status = uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(), sendbuf.length(),
+                              recvbuf.addr() - sendbuf.length(),
+                              recvbuf.rkey());
+    ASSERT_UCS_OK(status);
+
+    /* the peer closes the connection instead of writing the data, and the
+     * endpoint fails */
+    status = flush_ep(m_e1);
+    EXPECT_NE(UCS_INPROGRESS, status);
+    EXPECT_NE(UCS_OK, status);
+    EXPECT_EQ(status, uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(),
+                                       sendbuf.length(), recvbuf.addr(),
+                                       recvbuf.rkey()));
+    recvbuf.pattern_check(0);
+}
+
+UCS_TEST_P(test_uct_tcp, get_stale_rkey) {
+    uint64_t remote_addr;
+    ucs_status_t status;
+    uct_rkey_t rkey;
+    comp_t comp;
+
+    mapped_buffer recvbuf(sizeof(uint64_t), 0, *m_e1);
+
+    ucs_log_push_handler(hide_errors);
+    UCS_TEST_SCOPE_EXIT() { ucs_log_pop_handler(); } UCS_TEST_SCOPE_EXIT_END
+
+    /* the key of a region which was deregistered is not accepted, even if
+     * another region is registered in its place */
+    {
+        mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e2);
+        remote_addr = sendbuf.addr();
+        rkey        = sendbuf.rkey();
+    }
+    mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e2);
+
+    comp_init(&comp);
+    status = uct_ep_get_zcopy(m_e1->ep(0), recvbuf.ptr(), recvbuf.length(),
+                              recvbuf.memh(), remote_addr, rkey, &comp.uct);
+    ASSERT_EQ(UCS_INPROGRESS, status);
+
+    /* the request fails when the peer closes the connection */
+    progress_until(comp.count, 1u);
+    EXPECT_EQ(1u, comp.count);
+    EXPECT_NE(UCS_OK, comp.status);
+    recvbuf.pattern_check(0);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_tcp, tcp)
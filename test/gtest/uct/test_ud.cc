@@ -33,7 +33,7 @@ public:
 
     static ucs_status_t count_rx_acks(uct_ud_ep_t *ep, uct_ud_neth_t *neth)
     {
-        if (UCT_UD_PSN_COMPARE(neth->ack_psn, >, ep->tx.acked_psn)) {
+        if (UCT_UD_PSN_COMPARE(neth->ack_psn, >, ep->rel.tx.acked_psn)) {
             rx_ack_count++;
         }
         return UCS_OK;
@@ -74,16 +74,16 @@ public:
 
     void validate_flush() {
         /* 1 packets transmitted, 1 packets received */
-        EXPECT_EQ(2, ep(m_e1)->tx.psn);
-        EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+        EXPECT_EQ(2, ep(m_e1)->rel.tx.psn);
+        EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 
         /* no data transmitted back */
-        EXPECT_EQ(1, ep(m_e2)->tx.psn);
+        EXPECT_EQ(1, ep(m_e2)->rel.tx.psn);
 
         /* one packet was acked */
-        EXPECT_EQ(0U, ucs_queue_length(&ep(m_e1)->tx.window));
-        EXPECT_EQ(1, ep(m_e1)->tx.acked_psn);
-        EXPECT_EQ(1, ep(m_e2)->rx.acked_psn);
+        EXPECT_EQ(0U, ucs_queue_length(&ep(m_e1)->rel.tx.window));
+        EXPECT_EQ(1, ep(m_e1)->rel.tx.acked_psn);
+        EXPECT_EQ(1, ep(m_e2)->rel.rx.acked_psn);
     }
 
     void check_connection() {
@@ -91,8 +91,8 @@ public:
         EXPECT_UCS_OK(tx(m_e1));
         EXPECT_UCS_OK(tx(m_e1));
         flush();
-        EXPECT_EQ(4, ep(m_e1, 0)->tx.psn);
-        EXPECT_EQ(3, ep(m_e1)->tx.acked_psn);
+        EXPECT_EQ(4, ep(m_e1, 0)->rel.tx.psn);
+        EXPECT_EQ(3, ep(m_e1)->rel.tx.acked_psn);
     }
 };
 
@@ -116,16 +116,16 @@ UCS_TEST_P(test_ud, basic_tx) {
     short_progress_loop();
 
     /* N packets transmitted, N packets received */
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 
     /* no data transmitted back */
-    EXPECT_EQ(1, ep(m_e2)->tx.psn);
+    EXPECT_EQ(1, ep(m_e2)->rel.tx.psn);
 
     /* nothing was acked */
-    EXPECT_EQ(N, ucs_queue_length(&ep(m_e1)->tx.window));
-    EXPECT_EQ(0, ep(m_e1)->tx.acked_psn);
-    EXPECT_EQ(0, ep(m_e2)->rx.acked_psn);
+    EXPECT_EQ(N, ucs_queue_length(&ep(m_e1)->rel.tx.window));
+    EXPECT_EQ(0, ep(m_e1)->rel.tx.acked_psn);
+    EXPECT_EQ(0, ep(m_e2)->rel.rx.acked_psn);
 }
 
 UCS_TEST_P(test_ud, duplex_tx) {
@@ -144,18 +144,18 @@ UCS_TEST_P(test_ud, duplex_tx) {
     }
 
     /* N packets transmitted, N packets received */
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
-    EXPECT_EQ(N+1, ep(m_e2)->tx.psn);
-    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e1)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e2)->rel.tx.psn);
+    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e1)->rel.rx.ooo_pkts));
 
     /* everything but last packet from e2 is acked */
-    EXPECT_EQ(N, ep(m_e1)->tx.acked_psn);
-    EXPECT_EQ(N-1, ep(m_e2)->tx.acked_psn);
-    EXPECT_EQ(N-1, ep(m_e1)->rx.acked_psn);
-    EXPECT_EQ(N, ep(m_e2)->rx.acked_psn);
-    EXPECT_EQ(1U, ucs_queue_length(&ep(m_e2)->tx.window));
-    EXPECT_TRUE(ucs_queue_is_empty(&ep(m_e1)->tx.window));
+    EXPECT_EQ(N, ep(m_e1)->rel.tx.acked_psn);
+    EXPECT_EQ(N-1, ep(m_e2)->rel.tx.acked_psn);
+    EXPECT_EQ(N-1, ep(m_e1)->rel.rx.acked_psn);
+    EXPECT_EQ(N, ep(m_e2)->rel.rx.acked_psn);
+    EXPECT_EQ(1U, ucs_queue_length(&ep(m_e2)->rel.tx.window));
+    EXPECT_TRUE(ucs_queue_is_empty(&ep(m_e1)->rel.tx.window));
 }
 
 /* send full window, rcv ack after progreess, send some more */
@@ -220,7 +220,7 @@ UCS_TEST_P(test_ud, tx_window2) {
     EXPECT_EQ(UCS_ERR_NO_RESOURCE, tx(m_e1));
     EXPECT_EQ(UCS_ERR_NO_RESOURCE, tx(m_e1));
     EXPECT_EQ(UCS_ERR_NO_RESOURCE, tx(m_e1));
-    EXPECT_EQ(N, ucs_queue_length(&ep(m_e1)->tx.window));
+    EXPECT_EQ(N, ucs_queue_length(&ep(m_e1)->rel.tx.window));
 }
 
 
@@ -242,7 +242,7 @@ UCS_TEST_P(test_ud, ack_req_single) {
     short_progress_loop();
     EXPECT_EQ(2, ack_req_tx_cnt);
     EXPECT_EQ(1, tx_ack_psn);
-    EXPECT_TRUE(ucs_queue_is_empty(&ep(m_e1)->tx.window));
+    EXPECT_TRUE(ucs_queue_is_empty(&ep(m_e1)->rel.tx.window));
 }
 
 /* test that ack request is sent on 1/4 of window */
@@ -266,7 +266,7 @@ UCS_TEST_P(test_ud, ack_req_window) {
     short_progress_loop();
     EXPECT_EQ(2, ack_req_tx_cnt);
     EXPECT_EQ(N/4, tx_ack_psn);
-    EXPECT_TRUE(ucs_queue_is_empty(&ep(m_e1)->tx.window));
+    EXPECT_TRUE(ucs_queue_is_empty(&ep(m_e1)->rel.tx.window));
 }
 
 /* simulate retransmission of the CREQ packet */
@@ -283,8 +283,8 @@ UCS_TEST_P(test_ud, crep_drop1) {
     EXPECT_EQ(0U, ep(m_e1, 0)->dest_ep_id);
     EXPECT_EQ(0U, ep(m_e1, 0)->conn_id);
 
-    EXPECT_EQ(2, ep(m_e1, 0)->tx.psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 0)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1, 0)->rel.tx.psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 0)->rel.rx.ooo_pkts));
     
     check_connection();
 }
@@ -302,10 +302,10 @@ UCS_TEST_P(test_ud, crep_drop2) {
     short_progress_loop();
 
     /* expect creq sent and empty window */
-    EXPECT_EQ(1, ep(m_e1, 0)->tx.acked_psn);
-    EXPECT_EQ(2, ep(m_e1, 0)->tx.psn);
-    EXPECT_EQ(1, ep(m_e2, 0)->tx.acked_psn);
-    EXPECT_EQ(2, ep(m_e2, 0)->tx.psn);
+    EXPECT_EQ(1, ep(m_e1, 0)->rel.tx.acked_psn);
+    EXPECT_EQ(2, ep(m_e1, 0)->rel.tx.psn);
+    EXPECT_EQ(1, ep(m_e2, 0)->rel.tx.acked_psn);
+    EXPECT_EQ(2, ep(m_e2, 0)->rel.tx.psn);
 }
 
 UCS_TEST_P(test_ud, creq_flush) {
@@ -333,16 +333,16 @@ UCS_TEST_P(test_ud, ca_ai) {
      */
     max_window = RUNNING_ON_VALGRIND ? 128 : UCT_UD_CA_MAX_WINDOW;
     connect();
-    EXPECT_EQ(UCT_UD_CA_MIN_WINDOW, ep(m_e1)->ca.cwnd);
-    EXPECT_EQ(UCT_UD_CA_MIN_WINDOW, ep(m_e2)->ca.cwnd);
+    EXPECT_EQ(UCT_UD_CA_MIN_WINDOW, ep(m_e1)->rel.ca.cwnd);
+    EXPECT_EQ(UCT_UD_CA_MIN_WINDOW, ep(m_e2)->rel.ca.cwnd);
     
     ep(m_e1, 0)->rx.rx_hook = count_rx_acks;
-    prev_cwnd = ep(m_e1)->ca.cwnd;
+    prev_cwnd = ep(m_e1)->rel.ca.cwnd;
     rx_ack_count = 0;
 
     /* window increase upto max window should 
      * happen when we receive acks */
-    while(ep(m_e1)->ca.cwnd < max_window) {
+    while(ep(m_e1)->rel.ca.cwnd < max_window) {
        status = tx(m_e1);
        if (status != UCS_OK) {
            progress();
@@ -354,8 +354,8 @@ UCS_TEST_P(test_ud, ca_ai) {
             */
            EXPECT_LE(rx_ack_count, 2); 
            EXPECT_EQ(rx_ack_count, 
-                     UCT_UD_CA_AI_VALUE * (ep(m_e1)->ca.cwnd - prev_cwnd));
-           prev_cwnd = ep(m_e1)->ca.cwnd;
+                     UCT_UD_CA_AI_VALUE * (ep(m_e1)->rel.ca.cwnd - prev_cwnd));
+           prev_cwnd = ep(m_e1)->rel.ca.cwnd;
            rx_ack_count = 0;
        }
     }
@@ -394,19 +394,19 @@ UCS_TEST_P(test_ud, ca_md) {
 
     ep(m_e1)->tx.tx_hook = count_tx;
     do {
-        new_cwnd = ep(m_e1, 0)->ca.cwnd / UCT_UD_CA_MD_FACTOR;
+        new_cwnd = ep(m_e1, 0)->rel.ca.cwnd / UCT_UD_CA_MD_FACTOR;
         tx_count = 0;
         do {
             progress();
-        } while (ep(m_e1, 0)->ca.cwnd != new_cwnd);
+        } while (ep(m_e1, 0)->rel.ca.cwnd != new_cwnd);
         short_progress_loop();
 
         /* up to 2 additional ack_reqs per each resend */
         EXPECT_LE(new_cwnd-1, tx_count);
         EXPECT_GE(new_cwnd-1+2, tx_count);
-        EXPECT_EQ(ep(m_e1, 0)->ca.cwnd, new_cwnd);
+        EXPECT_EQ(ep(m_e1, 0)->rel.ca.cwnd, new_cwnd);
 
-    } while (iters && ep(m_e1, 0)->ca.cwnd > UCT_UD_CA_MIN_WINDOW);
+    } while (iters && ep(m_e1, 0)->rel.ca.cwnd > UCT_UD_CA_MIN_WINDOW);
 }
 
 UCS_TEST_P(test_ud, ca_resend) {
@@ -431,7 +431,7 @@ UCS_TEST_P(test_ud, ca_resend) {
     ack_req_tx_cnt = 0;
     do {
         progress();
-    } while(ep(m_e1)->ca.cwnd != max_window/2);
+    } while(ep(m_e1)->rel.ca.cwnd != max_window/2);
     /* expect that:
      * 4 packets will be retransmitted
      * first packet will have ack_req,
@@ -457,9 +457,9 @@ UCS_TEST_P(test_ud, connect_iface_single) {
     EXPECT_EQ(0U, ep(m_e1, 0)->dest_ep_id);
     EXPECT_EQ(0U, ep(m_e1, 0)->conn_id);
 
-    EXPECT_EQ(2, ep(m_e1, 0)->tx.psn);
-    EXPECT_EQ(1, ep(m_e1, 0)->tx.acked_psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 0)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1, 0)->rel.tx.psn);
+    EXPECT_EQ(1, ep(m_e1, 0)->rel.tx.acked_psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 0)->rel.rx.ooo_pkts));
 
     check_connection();
 }
@@ -472,13 +472,13 @@ UCS_TEST_P(test_ud, connect_iface_2to1) {
 
     EXPECT_EQ(0U, ep(m_e1,0)->dest_ep_id);
     EXPECT_EQ(0U, ep(m_e1,0)->conn_id);
-    EXPECT_EQ(2, ep(m_e1,0)->tx.psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 0)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1,0)->rel.tx.psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 0)->rel.rx.ooo_pkts));
 
     EXPECT_EQ(1U, ep(m_e1,1)->dest_ep_id);
     EXPECT_EQ(1U, ep(m_e1,1)->conn_id);
-    EXPECT_EQ(2, ep(m_e1,1)->tx.psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 1)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1,1)->rel.tx.psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1, 1)->rel.rx.ooo_pkts));
 }
 
 UCS_TEST_P(test_ud, connect_iface_seq) {
@@ -487,8 +487,8 @@ UCS_TEST_P(test_ud, connect_iface_seq) {
     short_progress_loop(50);
     EXPECT_EQ(0U, ep(m_e1)->dest_ep_id);
     EXPECT_EQ(0U, ep(m_e1)->conn_id);
-    EXPECT_EQ(2, ep(m_e1)->tx.psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e1)->rel.rx.ooo_pkts));
 
     /* now side two connects. existing ep will be reused */
     m_e2->connect_to_iface(0, *m_e1);
@@ -496,9 +496,9 @@ UCS_TEST_P(test_ud, connect_iface_seq) {
     EXPECT_EQ(0U, ep(m_e2)->dest_ep_id);
     EXPECT_EQ(0U, ep(m_e2)->ep_id);
     EXPECT_EQ(0U, ep(m_e2)->conn_id);
-    EXPECT_EQ(1, ep(m_e2)->tx.psn);
+    EXPECT_EQ(1, ep(m_e2)->rel.tx.psn);
     /* one becase creq sets initial psn */
-    EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 
     check_connection();
 }
@@ -36,7 +36,7 @@ public:
                 uct_ud_iface_t);
 
         /* hack to disable retransmit */
-        ep->tx.send_time = ucs_twheel_get_time(&iface->async.slow_timer);
+        ep->rel.tx.send_time = ucs_twheel_get_time(&iface->async.slow_timer);
         tick_count++;
         return UCS_OK;
     }
@@ -57,8 +57,8 @@ UCS_TEST_P(test_ud_slow_timer, tx1) {
     connect();
     EXPECT_UCS_OK(tx(m_e1));
     twait(200);
-    EXPECT_EQ(2, ep(m_e1)->tx.psn);
-    EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 }
 
 /* multiple packets received without progress */
@@ -70,8 +70,8 @@ UCS_TEST_P(test_ud_slow_timer, txn) {
         EXPECT_UCS_OK(tx(m_e1));
     }
     twait(200);
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 }
 
 #ifdef UCT_UD_EP_DEBUG_HOOKS
@@ -103,11 +103,11 @@ UCS_TEST_P(test_ud_slow_timer, retransmit1) {
     EXPECT_UCS_OK(tx(m_e1));
     short_progress_loop();
     ep(m_e2)->rx.rx_hook = uct_ud_ep_null_hook;
-    EXPECT_EQ(2, ep(m_e1)->tx.psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
     twait(500);
-    EXPECT_EQ(2, ep(m_e1)->tx.psn);
-    EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(2, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(1, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 }
 
 /* retransmit many packets */
@@ -123,13 +123,13 @@ UCS_TEST_P(test_ud_slow_timer, retransmitn) {
     }
     short_progress_loop();
     ep(m_e2)->rx.rx_hook = uct_ud_ep_null_hook;
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(0, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
     twait(500);
     //short_progress_loop();
     
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 }
 
 
@@ -148,8 +148,8 @@ UCS_TEST_P(test_ud_slow_timer, partial_drop) {
     }
     short_progress_loop();
     ep(m_e2)->rx.rx_hook = uct_ud_ep_null_hook;
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(rx_limit, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(rx_limit, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
     orig_avail = iface(m_e1)->tx.available;
     /* allow only 6 outgoing packets. It will allow to get ack
      * from receiver
@@ -159,8 +159,8 @@ UCS_TEST_P(test_ud_slow_timer, partial_drop) {
     iface(m_e1)->tx.available = orig_avail-6;
     short_progress_loop();
     
-    EXPECT_EQ(N+1, ep(m_e1)->tx.psn);
-    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rx.ooo_pkts));
+    EXPECT_EQ(N+1, ep(m_e1)->rel.tx.psn);
+    EXPECT_EQ(N, ucs_frag_list_sn(&ep(m_e2)->rel.rx.ooo_pkts));
 }
 #endif
 
@@ -0,0 +1,308 @@
+/**
+* Copyright (C) Mellanox Technologies Ltd. 2001-2017.  ALL RIGHTS RESERVED.
+*
+* See file LICENSE for terms.
+*/
+
+extern "C" {
+#include <uct/api/uct.h>
+#include <uct/udp/udp.h>
+#include <ucs/time/time.h>
+}
+#include <common/test.h>
+#include "uct_test.h"
+
+class test_uct_udp : public uct_test {
+public:
+    static const uint8_t  AM_ID    = 4;
+    static const size_t   MSG_SIZE = 1024;
+
+    void init() {
+        uct_test::init();
+
+        m_e1 = uct_test::create_entity(0);
+        m_entities.push_back(m_e1);
+
+        m_e2 = uct_test::create_entity(0);
+        m_entities.push_back(m_e2);
+
+        /* the connection requests are sent over the network, unlike the
+         * connections to endpoints in the other tests */
+        m_e1->connect_to_iface(0, *m_e2);
+        m_e2->connect_to_iface(0, *m_e1);
+    }
+
+    typedef struct {
+        uct_pending_req_t uct;
+        test_uct_udp      *test;
+        uint64_t          seq;
+    } pending_send_t;
+
+    /* Records the sequence number at the beginning of the message */
+    static ucs_status_t seq_am_handler(void *arg, void *data, size_t length,
+                                       void *desc) {
+        test_uct_udp *self = reinterpret_cast<test_uct_udp*>(arg);
+        self->m_recvd.push_back(*(uint64_t*)data);
+        return UCS_OK;
+    }
+
+    static size_t pack_seq(void *dest, void *arg) {
+        memset(dest, 0, MSG_SIZE);
+        *(uint64_t*)dest = *(uint64_t*)arg;
+        return MSG_SIZE;
+    }
+
+    ssize_t send_seq(uint64_t seq) {
+        return uct_ep_am_bcopy(m_e1->ep(0), AM_ID, pack_seq, &seq);
+    }
+
+    static ucs_status_t pending_send(uct_pending_req_t *self) {
+        pending_send_t *req = ucs_container_of(self, pending_send_t, uct);
+        ssize_t ret;
+
+        ret = req->test->send_seq(req->seq);
+        return (ret < 0) ? (ucs_status_t)ret : UCS_OK;
+    }
+
+    void set_seq_handler() {
+        ucs_status_t status;
+
+        status = uct_iface_set_am_handler(m_e2->iface(), AM_ID, seq_am_handler,
+                                          this, UCT_AM_CB_FLAG_SYNC);
+        ASSERT_UCS_OK(status);
+    }
+
+    /* Sends the messages as fast as the send window allows */
+    void send_seqs(uint64_t count) {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(30.0);
+        ssize_t ret;
+
+        for (uint64_t seq = 0; seq < count; ++seq) {
+            do {
+                ret = send_seq(seq);
+                if (ret == UCS_ERR_NO_RESOURCE) {
+                    progress();
+                }
+            } while ((ret == UCS_ERR_NO_RESOURCE) &&
+                     (ucs_get_time() < deadline));
+            ASSERT_EQ(ssize_t(MSG_SIZE), ret) << "seq " << seq;
+        }
+    }
+
+    /* Every message is delivered once, in the order it was sent */
+    void check_seqs(uint64_t count) {
+        ucs_time_t deadline = ucs_get_time() + ucs_time_from_sec(30.0);
+
+        while ((m_recvd.size() < count) && (ucs_get_time() < deadline)) {
+            progress();
+        }
+
+        ASSERT_EQ(count, m_recvd.size());
+        for (uint64_t i = 0; i < count; ++i) {
+            EXPECT_EQ(i, m_recvd[i]);
+        }
+    }
+
+    uct_udp_device_addr_t device_addr(entity *e) {
+        uct_udp_device_addr_t addr;
+        ucs_status_t status;
+
+        EXPECT_EQ(sizeof(addr), e->iface_attr().device_addr_len);
+        status = uct_iface_get_device_address(e->iface(),
+                                              (uct_device_addr_t*)&addr);
+        EXPECT_UCS_OK(status);
+        return addr;
+    }
+
+    bool reachable(entity *e, const uct_udp_device_addr_t& addr) {
+        return uct_iface_is_reachable(e->iface(),
+                                      (const uct_device_addr_t*)&addr);
+    }
+
+    void put_short(const mapped_buffer& sendbuf, uint64_t remote_addr,
+                   uct_rkey_t rkey) {
+        ucs_status_t status;
+
+        do {
+            status = uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(),
+                                      sendbuf.length(), remote_addr, rkey);
+            if (status == UCS_ERR_NO_RESOURCE) {
+                progress();
+            }
+        } while (status == UCS_ERR_NO_RESOURCE);
+        ASSERT_UCS_OK(status);
+    }
+
+    static ucs_log_func_rc_t
+    hide_errors(const char *file, unsigned line, const char *function,
+                ucs_log_level_t level, const char *prefix, const char *message,
+                va_list ap) {
+        return (level == UCS_LOG_LEVEL_ERROR) ? UCS_LOG_FUNC_RC_STOP :
+                                                UCS_LOG_FUNC_RC_CONTINUE;
+    }
+
+protected:
+    entity                *m_e1, *m_e2;
+    std::vector<uint64_t> m_recvd;
+};
+
+UCS_TEST_P(test_uct_udp, reachable) {
+    uct_udp_device_addr_t addr = device_addr(m_e1);
+    bool is_loopback = (ntohl(addr.in_addr.s_addr) >> IN_CLASSA_NSHIFT) ==
+                       IN_LOOPBACKNET;
+
+    EXPECT_TRUE(reachable(m_e1, addr));
+    EXPECT_TRUE(reachable(m_e2, addr));
+
+    /* loopback addresses are reachable only on the same host */
+    addr.guid ^= 1;
+    EXPECT_EQ(!is_loopback, reachable(m_e1, addr));
+
+    /* other addresses are reachable only from an interface on their
+     * subnet */
+    addr.in_addr.s_addr ^= htonl(0x80000000);
+    EXPECT_FALSE(reachable(m_e1, addr));
+}
+
+UCS_TEST_P(test_uct_udp, pending_in_order) {
+    static const unsigned num_pending = 8;
+    pending_send_t reqs[num_pending];
+    ucs_status_t status;
+    uint64_t seq;
+    ssize_t ret;
+
+    set_seq_handler();
+
+    /* the send window is closed until the peer replies to the connection,
+     * and then until it acknowledges the packets */
+    seq = 0;
+    do {
+        ret = send_seq(seq);
+        if (ret >= 0) {
+            ++seq;
+        }
+    } while ((ret >= 0) && (seq < 10000));
+
+    /* the acks arrive in async progress, so the window may be open again */
+    for (unsigned i = 0; i < num_pending; ++i) {
+        reqs[i].uct.func = pending_send;
+        reqs[i].test     = this;
+        reqs[i].seq      = seq++;
+        status = uct_ep_pending_add(m_e1->ep(0), &reqs[i].uct);
+        if (status == UCS_ERR_BUSY) {
+            status = pending_send(&reqs[i].uct);
+        }
+        ASSERT_UCS_OK(status);
+    }
+
+    check_seqs(seq);
+
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+}
+
+UCS_TEST_P(test_uct_udp, put_flush) {
+    ucs_status_t status;
+
+    mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e1);
+    mapped_buffer recvbuf(sizeof(uint64_t), 0, *m_e2);
+
+    do {
+        status = uct_ep_put_short(m_e1->ep(0), sendbuf.ptr(), sendbuf.length(),
+                                  recvbuf.addr(), recvbuf.rkey());
+        if (status == UCS_ERR_NO_RESOURCE) {
+            progress();
+        }
+    } while (status == UCS_ERR_NO_RESOURCE);
+    ASSERT_UCS_OK(status);
+
+    /* the put is complete when the peer acknowledges it */
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+    recvbuf.pattern_check(1);
+}
+
+UCS_TEST_P(test_uct_udp, put_outside_region) {
+    mapped_buffer sendbuf(sizeof(uint64_t), 1, *m_e1);
+    mapped_buffer recvbuf(sizeof(uint64_t) * 2, 0, *m_e2);
+
+    ucs_log_push_handler(hide_errors);
+    UCS_TEST_SCOPE_EXIT() { ucs_log_pop_handler(); } UCS_TEST_SCOPE_EXIT_END
+
+    /* the peer acknowledges the put without writing the data, so the
+     * following put is still delivered */
+    put_short(sendbuf, recvbuf.addr() - sendbuf.length(), recvbuf.rkey());
+    put_short(sendbuf, recvbuf.addr() + sendbuf.length(), recvbuf.rkey() ^ 1);
+    put_short(sendbuf, recvbuf.addr(), recvbuf.rkey());
+
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+    EXPECT_EQ(1ul, *(uint64_t*)recvbuf.ptr());
+    EXPECT_EQ(0ul, *((uint64_t*)recvbuf.ptr() + 1));
+}
+
+UCS_TEST_P(test_uct_udp, am_loss, "LOSS_RATE=0.1", "TIMER_TICK=1ms") {
+    static const uint64_t num_sends = 1000;
+
+    set_seq_handler();
+    send_seqs(num_sends);
+    check_seqs(num_sends);
+
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+}
+
+UCS_TEST_P(test_uct_udp, put_loss, "LOSS_RATE=0.1", "TIMER_TICK=1ms") {
+    static const unsigned num_puts = 64;
+    const size_t length = 1024;
+    ucs_status_t status;
+
+    mapped_buffer sendbuf(length * num_puts, 1, *m_e1);
+    mapped_buffer recvbuf(length * num_puts, 0, *m_e2);
+
+    for (unsigned i = 0; i < num_puts; ++i) {
+        do {
+            status = uct_ep_put_short(m_e1->ep(0),
+                                      (char*)sendbuf.ptr() + i * length,
+                                      length, recvbuf.addr() + i * length,
+                                      recvbuf.rkey());
+            if (status == UCS_ERR_NO_RESOURCE) {
+                progress();
+            }
+        } while (status == UCS_ERR_NO_RESOURCE);
+        ASSERT_UCS_OK(status);
+    }
+
+    flush();
+    EXPECT_EQ(UCS_OK, uct_ep_flush(m_e1->ep(0)));
+    recvbuf.pattern_check(1);
+}
+
+UCS_TEST_P(test_uct_udp, connect_to_ep_loss, "LOSS_RATE=0.1",
+           "TIMER_TICK=1ms") {
+    static const uint64_t num_sends = 256;
+    entity *e1, *e2;
+
+    e1 = uct_test::create_entity(0);
+    m_entities.push_back(e1);
+    e2 = uct_test::create_entity(0);
+    m_entities.push_back(e2);
+    e1->connect_to_ep(0, *e2, 0);
+
+    m_e1 = e1;
+    m_e2 = e2;
+    set_seq_handler();
+    send_seqs(num_sends);
+    check_seqs(num_sends);
+}
+
+UCS_TEST_P(test_uct_udp, connect_loss, "LOSS_RATE=0.5", "TIMER_TICK=1ms") {
+    static const uint64_t num_sends = 16;
+
+    /* the connection requests and replies are sent again until they arrive */
+    set_seq_handler();
+    send_seqs(num_sends);
+    check_seqs(num_sends);
+}
+
+_UCT_INSTANTIATE_TEST_CASE(test_uct_udp, udp)
@@ -37,8 +37,11 @@ std::vector<const resource*> uct_p2p_test::enum_resources(const std::string& tl_
             res.tl_name    = (*iter)->tl_name;
             res.dev_name   = (*iter)->dev_name;
 
-            res.loopback = false;
-            all_resources.push_back(res);
+            /* the self transport can reach only its own interface */
+            if (res.tl_name != "self") {
+                res.loopback = false;
+                all_resources.push_back(res);
+            }
 
             res.loopback = true;
             all_resources.push_back(res);
@@ -217,8 +220,9 @@ void uct_p2p_test::blocking_send(send_func_t send, uct_ep_h ep,
         return;
     } else if (status == UCS_INPROGRESS) {
         if (comp() == NULL) {
-            /* implicit non-blocking mode */
-            sender().flush();
+            /* implicit non-blocking mode. the receiver is progressed as well,
+             * since a send may complete only after the receiver reads it */
+            flush();
         } else {
             /* explicit non-blocking mode */
             ++m_completion.uct.count;
@@ -233,7 +237,8 @@ void uct_p2p_test::blocking_send(send_func_t send, uct_ep_h ep,
 }
 
 void uct_p2p_test::wait_for_remote() {
-    sender().flush();
+    /* software transports write remote memory from the receiver progress */
+    flush();
 }
 
 uct_test::entity& uct_p2p_test::sender() {
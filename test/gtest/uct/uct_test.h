@@ -178,6 +178,8 @@ std::ostream& operator<<(std::ostream& os, const resource* resource);
     mm, \
     cma, \
     knem, \
+    tcp, \
+    udp, \
     cuda
 
 #define UCT_TEST_IB_TLS \